@@ -1,6 +1,7 @@
 #include "cmdline.hpp"
 
 #include <aliceVision/system/cpu.hpp>
+#include <aliceVision/system/IOScheduler.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 
 namespace aliceVision {
@@ -62,6 +63,9 @@ bool CmdLine::execute(int argc, char** argv)
     _hContext.setUserMaxCoresAvailable(uca);
     _hContext.displayHardware();
 
+    // files loading threads follow the hardware limits
+    system::IOScheduler::getInstance().setHardwareContext(_hContext);
+
     return true;
 }
 
@@ -0,0 +1,65 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief Depth map estimation computation backend.
+ */
+enum class EDepthMapBackend
+{
+    AUTO = 0,  //< CUDA if a compatible device is available, CPU otherwise
+    CUDA,      //< CUDA device(s)
+    CPU        //< host only, OpenMP
+};
+
+inline std::string EDepthMapBackend_enumToString(EDepthMapBackend backend)
+{
+    switch (backend)
+    {
+        case EDepthMapBackend::AUTO:
+            return "auto";
+        case EDepthMapBackend::CUDA:
+            return "cuda";
+        case EDepthMapBackend::CPU:
+            return "cpu";
+    }
+    throw std::out_of_range("Invalid depth map backend enum: " + std::to_string(int(backend)));
+}
+
+inline EDepthMapBackend EDepthMapBackend_stringToEnum(const std::string& backend)
+{
+    std::string b = backend;
+    std::transform(b.begin(), b.end(), b.begin(), ::tolower);
+
+    if (b == "auto")
+        return EDepthMapBackend::AUTO;
+    if (b == "cuda")
+        return EDepthMapBackend::CUDA;
+    if (b == "cpu")
+        return EDepthMapBackend::CPU;
+    throw std::out_of_range("Invalid depth map backend: " + backend);
+}
+
+inline std::ostream& operator<<(std::ostream& os, EDepthMapBackend e) { return os << EDepthMapBackend_enumToString(e); }
+
+inline std::istream& operator>>(std::istream& in, EDepthMapBackend& backend)
+{
+    std::string token(std::istreambuf_iterator<char>(in), {});
+    backend = EDepthMapBackend_stringToEnum(token);
+    return in;
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -6,7 +6,9 @@
 
 #include "DepthMapEstimator.hpp"
 
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/mvsUtils/fileIO.hpp>
 #include <aliceVision/mvsUtils/mapIO.hpp>
@@ -16,6 +18,10 @@
 #include <aliceVision/depthMap/SgmDepthList.hpp>
 #include <aliceVision/depthMap/Sgm.hpp>
 #include <aliceVision/depthMap/Refine.hpp>
+#include <aliceVision/depthMap/cpu/CpuSgm.hpp>
+#include <aliceVision/depthMap/cpu/CpuRefine.hpp>
+#include <aliceVision/depthMap/cpu/CpuMipmapImage.hpp>
+#include <aliceVision/depthMap/cpu/cpuMapIO.hpp>
 #include <aliceVision/depthMap/cuda/host/utils.hpp>
 #include <aliceVision/depthMap/cuda/host/patchPattern.hpp>
 #include <aliceVision/depthMap/cuda/host/DeviceCache.hpp>
@@ -511,5 +517,285 @@ void DepthMapEstimator::compute(int cudaDeviceId, const std::vector<int>& cams)
     refinePerStream.clear();
 }
 
+int DepthMapEstimator::getNbRcPerCpuBatch(int nbWorkers) const
+{
+    // mipmap image cost
+    // mipmap image should not exceed (1.5 * max_width) * max_height
+    const double mipmapCostMB = ((_mp.getMaxImageWidth() * 1.5) * _mp.getMaxImageHeight() * sizeof(CpuColor)) / (1024.0 * 1024.0);
+
+    // cameras cost per R camera computation
+    // Rc mipmap + Tcs mipmaps
+    const double rcCamsCostMB = mipmapCostMB + _depthMapParams.maxTCams * mipmapCostMB;
+
+    // single worker Sgm + Refine cost
+    double workerCostMB = 0.0;
+    {
+        const bool sgmComputeDepthSimMap = !_depthMapParams.useRefine;
+        const bool sgmComputeNormalMap = _refineParams.useSgmNormalMap;
+        const CpuMipmapImages noMipmapImages;
+
+        workerCostMB += CpuSgm(_mp, _tileParams, _sgmParams, noMipmapImages, sgmComputeDepthSimMap, sgmComputeNormalMap).getMemoryConsumption();
+
+        if (_depthMapParams.useRefine)
+            workerCostMB += CpuRefine(_mp, _tileParams, _refineParams, noMipmapImages).getMemoryConsumption();
+    }
+
+    // final depth/sim map tiles cost per R camera
+    const double rcResultCostMB = (double(_mp.getMaxImageWidth()) * _mp.getMaxImageHeight() * sizeof(Vec2f)) / (1024.0 * 1024.0);
+
+    // available host memory
+    const double hostMemoryMB = (system::getMemoryInfo().availableRam / (1024.0 * 1024.0)) * 0.8;  // available memory margin
+    const double remainingMemoryMB = hostMemoryMB - nbWorkers * workerCostMB;
+
+    const int nbRcPerBatch = std::max(1, static_cast<int>(remainingMemoryMB / (rcCamsCostMB + rcResultCostMB)));
+
+    // log memory information
+    ALICEVISION_LOG_INFO("Host memory:" << std::endl
+                                        << "\t- available: " << hostMemoryMB << " MB" << std::endl
+                                        << "\t- # computation buffers per thread: " << workerCostMB << " MB" << std::endl
+                                        << "\t- # threads: " << nbWorkers << std::endl
+                                        << "\t- # input images (R + " << _depthMapParams.maxTCams << " Ts): " << rcCamsCostMB
+                                        << " MB (single mipmap image size: " << mipmapCostMB << " MB)" << std::endl
+                                        << "\t- # simultaneous depth maps computation: " << nbRcPerBatch);
+
+    if (remainingMemoryMB < rcCamsCostMB)
+        ALICEVISION_LOG_WARNING("Not enough host memory to compute a single depth map safely, try to reduce the number of threads.");
+
+    return nbRcPerBatch;
+}
+
+void DepthMapEstimator::computeOnCpu(const std::vector<int>& cams)
+{
+    if (_sgmParams.useCustomPatchPattern || (_depthMapParams.useRefine && _refineParams.useCustomPatchPattern))
+        ALICEVISION_THROW_ERROR("Custom patch pattern is not available with the CPU backend.");
+
+    // initialize RAM image cache
+    mvsUtils::ImagesCache<image::Image<image::RGBAfColor>> ic(_mp, image::EImageColorSpace::LINEAR);
+
+    // build tile list order by R camera
+    std::vector<Tile> tiles;
+    getTilesList(cams, tiles);
+
+    if (tiles.empty())
+        return;
+
+    const int nbTilesPerCamera = static_cast<int>(_tileRoiList.size());
+
+    // one Sgm / Refine per thread, tiles are computed in parallel
+    const int nbWorkers = std::max(1, std::min(omp_get_max_threads(), static_cast<int>(tiles.size())));
+    const int nbRcPerBatch = std::min(getNbRcPerCpuBatch(nbWorkers), static_cast<int>(cams.size()));
+    const int nbTilesPerBatch = nbRcPerBatch * nbTilesPerCamera;
+
+    // batch mipmap images, indexed by camera
+    CpuMipmapImages mipmapImages(_mp.ncams);
+
+    // allocate Sgm and Refine per thread in host memory
+    std::vector<CpuSgm> sgmPerWorker;
+    std::vector<CpuRefine> refinePerWorker;
+
+    sgmPerWorker.reserve(nbWorkers);
+    refinePerWorker.reserve(_depthMapParams.useRefine ? nbWorkers : 0);
+
+    {
+        const bool sgmComputeDepthSimMap = !_depthMapParams.useRefine;
+        const bool sgmComputeNormalMap = _refineParams.useSgmNormalMap;
+
+        for (int i = 0; i < nbWorkers; ++i)
+            sgmPerWorker.emplace_back(_mp, _tileParams, _sgmParams, mipmapImages, sgmComputeDepthSimMap, sgmComputeNormalMap);
+
+        if (_depthMapParams.useRefine)
+            for (int i = 0; i < nbWorkers; ++i)
+                refinePerWorker.emplace_back(_mp, _tileParams, _refineParams, mipmapImages);
+    }
+
+    // final depth/similarity map tile list per batch R camera
+    std::vector<std::vector<CpuMap<Vec2f>>> depthSimMapTilePerCam(nbRcPerBatch, std::vector<CpuMap<Vec2f>>(nbTilesPerCamera));
+    std::vector<std::vector<std::pair<float, float>>> depthMinMaxTilePerCam(nbRcPerBatch, std::vector<std::pair<float, float>>(nbTilesPerCamera));
+
+    for (auto& depthSimMapTiles : depthSimMapTilePerCam)
+    {
+        for (CpuMap<Vec2f>& depthSimMapTile : depthSimMapTiles)
+        {
+            // final depth/similarity map is Refine or SGM only
+            const CpuMap<Vec2f>& workerDepthSimMap =
+              (_depthMapParams.useRefine) ? refinePerWorker.front().getDepthSimMap() : sgmPerWorker.front().getDepthSimMap();
+            depthSimMapTile.allocate(workerDepthSimMap.width(), workerDepthSimMap.height());
+        }
+    }
+
+    // compute number of batches
+    const int nbBatches = divideRoundUp(static_cast<int>(tiles.size()), nbTilesPerBatch);
+    const int minMipmapDownscale = std::min(_refineParams.scale, _sgmParams.scale);
+    const int maxMipmapDownscale = std::max(_refineParams.scale, _sgmParams.scale) * std::pow(2, 6);  // we add 6 downscale levels
+
+    // compute each batch of R cameras
+    for (int b = 0; b < nbBatches; ++b)
+    {
+        // find first/last tile to compute
+        // note: a batch always contains all the tiles of its R cameras
+        const int firstTileIndex = b * nbTilesPerBatch;
+        const int lastTileIndex = std::min((b + 1) * nbTilesPerBatch, static_cast<int>(tiles.size()));
+
+        // load tile R and corresponding T cameras mipmap images
+        {
+            std::vector<bool> batchCams(_mp.ncams, false);
+
+            for (int i = firstTileIndex; i < lastTileIndex; ++i)
+            {
+                const Tile& tile = tiles.at(i);
+
+                batchCams.at(tile.rc) = true;
+
+                for (const int tc : tile.sgmTCams)
+                    batchCams.at(tc) = true;
+
+                if (_depthMapParams.useRefine)
+                    for (const int tc : tile.refineTCams)
+                        batchCams.at(tc) = true;
+            }
+
+            for (int c = 0; c < _mp.ncams; ++c)
+            {
+                if (!batchCams.at(c))
+                {
+                    // release mipmap image not used in this batch
+                    mipmapImages.at(c).reset();
+                    continue;
+                }
+
+                if (mipmapImages.at(c) != nullptr)
+                    continue;  // already loaded in the previous batch
+
+                const auto img = ic.getImg_sync(c);
+                mipmapImages.at(c) = std::make_unique<CpuMipmapImage>();
+                mipmapImages.at(c)->fill(*img, minMipmapDownscale, maxMipmapDownscale);
+            }
+        }
+
+        // compute each batch tile
+#pragma omp parallel for schedule(dynamic) num_threads(nbWorkers)
+        for (int i = firstTileIndex; i < lastTileIndex; ++i)
+        {
+            Tile tile = tiles.at(i);
+            const int batchCamIndex = (i - firstTileIndex) / nbTilesPerCamera;
+            const int workerIndex = omp_get_thread_num();
+
+            // do not compute empty ROI
+            // some images in the dataset may be smaller than others
+            if (tile.roi.isEmpty())
+                continue;
+
+            // get tile result depth/similarity map
+            CpuMap<Vec2f>& tileDepthSimMap = depthSimMapTilePerCam.at(batchCamIndex).at(tile.id);
+
+            // check T cameras
+            if (tile.sgmTCams.empty() || (_depthMapParams.useRefine && tile.refineTCams.empty()))  // no T camera found
+            {
+                resetDepthSimMap(tileDepthSimMap);
+                continue;
+            }
+
+            // build tile SGM depth list
+            SgmDepthList sgmDepthList(_mp, _sgmParams, tile);
+
+            // compute the R camera depth list
+            sgmDepthList.computeListRc();
+
+            // check number of depths
+            if (sgmDepthList.getDepths().empty())  // no depth found
+            {
+                resetDepthSimMap(tileDepthSimMap);
+                depthMinMaxTilePerCam.at(batchCamIndex).at(tile.id) = {0.f, 0.f};
+                continue;
+            }
+
+            // remove T cameras with no depth found.
+            sgmDepthList.removeTcWithNoDepth(tile);
+
+            // store min/max depth
+            depthMinMaxTilePerCam.at(batchCamIndex).at(tile.id) = sgmDepthList.getMinMaxDepths();
+
+            // log debug camera / depth information
+            sgmDepthList.logRcTcDepthInformation();
+
+            // check if starting and stopping depth are valid
+            sgmDepthList.checkStartingAndStoppingDepth();
+
+            // compute Semi-Global Matching
+            CpuSgm& sgm = sgmPerWorker.at(workerIndex);
+            sgm.sgmRc(tile, sgmDepthList);
+
+            if (_depthMapParams.useRefine)
+            {
+                // smooth SGM thickness map
+                // in order to be a proper Refine input parameter
+                sgm.smoothThicknessMap(tile, _refineParams);
+
+                // compute Refine
+                CpuRefine& refine = refinePerWorker.at(workerIndex);
+                refine.refineRc(tile, sgm.getDepthThicknessMap(), sgm.getNormalMap());
+
+                // copy Refine depth/similarity map
+                tileDepthSimMap = refine.getDepthSimMap();
+            }
+            else
+            {
+                // copy Sgm depth/similarity map
+                tileDepthSimMap = sgm.getDepthSimMap();
+            }
+        }
+
+        // write depth/sim map result
+        for (int i = firstTileIndex; i < lastTileIndex; i += nbTilesPerCamera)
+        {
+            const int c = tiles.at(i).rc;
+            const int batchCamIndex = (i - firstTileIndex) / nbTilesPerCamera;
+
+            if (_depthMapParams.useRefine)
+                writeDepthSimMapFromTileList(
+                  c, _mp, _tileParams, _tileRoiList, depthSimMapTilePerCam.at(batchCamIndex), _refineParams.scale, _refineParams.stepXY);
+            else
+                writeDepthSimMapFromTileList(
+                  c, _mp, _tileParams, _tileRoiList, depthSimMapTilePerCam.at(batchCamIndex), _sgmParams.scale, _sgmParams.stepXY);
+
+            if (_depthMapParams.exportTilePattern)
+                exportDepthSimMapTilePatternObj(c, _mp, _tileRoiList, depthMinMaxTilePerCam.at(batchCamIndex));
+        }
+    }
+
+    // merge intermediate results tiles if needed and desired
+    if (tiles.size() > cams.size())
+    {
+        // merge tiles if needed and desired
+        for (int rc : cams)
+        {
+            if (_sgmParams.exportIntermediateDepthSimMaps)
+            {
+                mergeDepthSimMapTiles(rc, _mp, _sgmParams.scale, _sgmParams.stepXY, "sgm");
+            }
+
+            if (_sgmParams.exportIntermediateNormalMaps)
+            {
+                mergeNormalMapTiles(rc, _mp, _sgmParams.scale, _sgmParams.stepXY, "sgm");
+            }
+
+            if (_depthMapParams.useRefine)
+            {
+                if (_refineParams.exportIntermediateDepthSimMaps)
+                {
+                    mergeDepthPixSizeMapTiles(rc, _mp, _refineParams.scale, _refineParams.stepXY, "sgmUpscaled");
+                    mergeDepthSimMapTiles(rc, _mp, _refineParams.scale, _refineParams.stepXY, "refinedFused");
+                }
+
+                if (_refineParams.exportIntermediateNormalMaps)
+                {
+                    mergeNormalMapTiles(rc, _mp, _refineParams.scale, _refineParams.stepXY, "refinedFused");
+                    mergeNormalMapTiles(rc, _mp, _refineParams.scale, _refineParams.stepXY);
+                }
+            }
+        }
+    }
+}
+
 }  // namespace depthMap
 }  // namespace aliceVision
@@ -57,6 +57,14 @@ class DepthMapEstimator : public IGPUJob
      */
     void compute(int cudaDeviceId, const std::vector<int>& cams) override;
 
+    /**
+     * @brief Compute depth/similarity maps of the given cameras on CPU.
+     * @note Same workflow and results as compute(), without any CUDA device.
+     *       Tiles are computed in parallel, one Sgm/Refine instance per thread.
+     * @param[in] cams the list of cameras
+     */
+    void computeOnCpu(const std::vector<int>& cams);
+
   private:
     // private methods
 
@@ -67,6 +75,14 @@ class DepthMapEstimator : public IGPUJob
      */
     int getNbSimultaneousTiles() const;
 
+    /**
+     * @brief Compute the number of R cameras (all tiles, mipmap images, buffers)
+     *        that fit in host memory and can be computed in the same CPU batch.
+     * @param[in] nbWorkers the number of threads computing tiles simultaneously
+     * @return number of R cameras per batch
+     */
+    int getNbRcPerCpuBatch(int nbWorkers) const;
+
     /**
      * @brief Build tile list from the given cameras.
      * @param[in] cams the list of cameras
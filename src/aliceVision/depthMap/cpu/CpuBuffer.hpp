@@ -0,0 +1,122 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/*
+ * @note CpuSim is the similarity type for volume in host memory (same as TSim).
+ * @note CpuSimAcc is the similarity accumulation type for volume in host memory (same as TSimAcc).
+ * @note CpuSimRefine is the similarity type for volume refinement in host memory (float instead of half).
+ */
+using CpuSim = unsigned char;
+using CpuSimAcc = unsigned int;
+using CpuSimRefine = float;
+
+/**
+ * @class CpuMap
+ * @brief 2d buffer in host memory, row-major (x is the fastest dimension).
+ * @note Same role as CudaDeviceMemoryPitched<T, 2> for the CPU backend.
+ */
+template<typename T>
+class CpuMap
+{
+  public:
+    CpuMap() = default;
+
+    CpuMap(std::size_t width, std::size_t height) { allocate(width, height); }
+
+    void allocate(std::size_t width, std::size_t height)
+    {
+        _width = width;
+        _height = height;
+        _buffer.resize(width * height);
+    }
+
+    void deallocate()
+    {
+        _width = 0;
+        _height = 0;
+        _buffer.clear();
+        _buffer.shrink_to_fit();
+    }
+
+    void fill(const T& value) { std::fill(_buffer.begin(), _buffer.end(), value); }
+
+    inline bool isEmpty() const { return _buffer.empty(); }
+    inline std::size_t width() const { return _width; }
+    inline std::size_t height() const { return _height; }
+    inline std::size_t getBytes() const { return _buffer.size() * sizeof(T); }
+
+    inline T* data() { return _buffer.data(); }
+    inline const T* data() const { return _buffer.data(); }
+
+    inline T* row(std::size_t y) { return _buffer.data() + y * _width; }
+    inline const T* row(std::size_t y) const { return _buffer.data() + y * _width; }
+
+    inline T& operator()(std::size_t x, std::size_t y) { return _buffer[y * _width + x]; }
+    inline const T& operator()(std::size_t x, std::size_t y) const { return _buffer[y * _width + x]; }
+
+  private:
+    std::size_t _width = 0;
+    std::size_t _height = 0;
+    std::vector<T> _buffer;
+};
+
+/**
+ * @class CpuVolume
+ * @brief 3d buffer in host memory.
+ * @note The depth dimension (z) is the fastest one, so the similarity values of a pixel are contiguous.
+ *       It allows vectorized loops over depths and a single cache line per pixel in the aggregation.
+ */
+template<typename T>
+class CpuVolume
+{
+  public:
+    CpuVolume() = default;
+
+    CpuVolume(std::size_t width, std::size_t height, std::size_t depth) { allocate(width, height, depth); }
+
+    void allocate(std::size_t width, std::size_t height, std::size_t depth)
+    {
+        _width = width;
+        _height = height;
+        _depth = depth;
+        _buffer.resize(width * height * depth);
+    }
+
+    void fill(const T& value) { std::fill(_buffer.begin(), _buffer.end(), value); }
+
+    void copyFrom(const CpuVolume<T>& other) { _buffer = other._buffer; }
+
+    inline bool isEmpty() const { return _buffer.empty(); }
+    inline std::size_t width() const { return _width; }
+    inline std::size_t height() const { return _height; }
+    inline std::size_t depth() const { return _depth; }
+    inline std::size_t getBytes() const { return _buffer.size() * sizeof(T); }
+
+    /// similarity values of the given pixel for all depths
+    inline T* column(std::size_t x, std::size_t y) { return _buffer.data() + (y * _width + x) * _depth; }
+    inline const T* column(std::size_t x, std::size_t y) const { return _buffer.data() + (y * _width + x) * _depth; }
+
+    inline T& operator()(std::size_t x, std::size_t y, std::size_t z) { return _buffer[(y * _width + x) * _depth + z]; }
+    inline const T& operator()(std::size_t x, std::size_t y, std::size_t z) const { return _buffer[(y * _width + x) * _depth + z]; }
+
+  private:
+    std::size_t _width = 0;
+    std::size_t _height = 0;
+    std::size_t _depth = 0;
+    std::vector<T> _buffer;
+};
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,121 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+
+#include <cmath>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @struct CpuCameraParams
+ * @brief Camera parameters in host memory for the CPU backend.
+ * @note Same content as DeviceCameraParams, single precision like the device-side structure.
+ */
+struct CpuCameraParams
+{
+    Eigen::Matrix<float, 3, 4> P;  //< projection matrix
+    Eigen::Matrix3f iP;            //< inverse of the projection matrix (without translation)
+    Vec3f C;                       //< camera center
+    Vec3f ZVect;                   //< camera optical axis
+};
+
+/**
+ * @brief Fill the camera parameters of the given camera at the given downscale.
+ * @note Same computation as the DeviceCache camera parameters.
+ * @param[out] cameraParams the output camera parameters
+ * @param[in] camId the camera index in the ImagesCache / MultiViewParams
+ * @param[in] downscale the camera downscale
+ * @param[in] mp the multi-view parameters
+ */
+void fillCpuCameraParams(CpuCameraParams& cameraParams, int camId, int downscale, const mvsUtils::MultiViewParams& mp);
+
+/**
+ * @brief Project a 3d point in the camera image.
+ */
+inline Vec2f cpuProject3DPoint(const CpuCameraParams& cam, const Vec3f& p)
+{
+    const Vec3f pp = cam.P.leftCols<3>() * p + cam.P.col(3);
+    return Vec2f(pp.x() / pp.z(), pp.y() / pp.z());
+}
+
+/**
+ * @brief Get the normalized viewing direction of the given pixel.
+ */
+inline Vec3f cpuGetPixelDirection(const CpuCameraParams& cam, const Vec2f& pix)
+{
+    return (cam.iP * Vec3f(pix.x(), pix.y(), 1.f)).normalized();
+}
+
+/**
+ * @brief Get the 3d point of the given pixel on the given fronto-parallel plane.
+ */
+inline Vec3f cpuGet3DPointForPixelAndFrontoParallelPlane(const CpuCameraParams& cam, const Vec2f& pix, float fpPlaneDepth)
+{
+    const Vec3f planep = cam.C + cam.ZVect * fpPlaneDepth;
+    const Vec3f v = cpuGetPixelDirection(cam, pix);
+    const float k = (planep.dot(cam.ZVect) - cam.ZVect.dot(cam.C)) / cam.ZVect.dot(v);
+    return cam.C + v * k;
+}
+
+/**
+ * @brief Get the 3d point of the given pixel at the given depth.
+ */
+inline Vec3f cpuGet3DPointForPixelAndDepth(const CpuCameraParams& cam, const Vec2f& pix, float depth)
+{
+    return cam.C + cpuGetPixelDirection(cam, pix) * depth;
+}
+
+/**
+ * @brief Get the depth of the given fronto-parallel plane for the given pixel.
+ */
+inline float cpuDepthPlaneToDepth(const CpuCameraParams& cam, float fpPlaneDepth, const Vec2f& pix)
+{
+    return (cam.C - cpuGet3DPointForPixelAndFrontoParallelPlane(cam, pix, fpPlaneDepth)).norm();
+}
+
+/**
+ * @brief Get the size of a pixel at the given 3d point.
+ */
+inline float cpuComputePixSize(const CpuCameraParams& cam, const Vec3f& p)
+{
+    const Vec2f rp = cpuProject3DPoint(cam, p);
+    const Vec3f v = cpuGetPixelDirection(cam, rp + Vec2f(1.f, 0.f));
+    return v.cross(cam.C - p).norm();
+}
+
+/**
+ * @brief Get the closest point of a 3d line to the given point.
+ * @param[in] point the 3d point
+ * @param[in] linePoint a point of the line
+ * @param[in] lineVectNormalized the normalized line direction
+ */
+inline Vec3f cpuClosestPointToLine3D(const Vec3f& point, const Vec3f& linePoint, const Vec3f& lineVectNormalized)
+{
+    return linePoint + lineVectNormalized * lineVectNormalized.dot(point - linePoint);
+}
+
+/**
+ * @brief Get the angle (in degrees) between the vectors AB and AC.
+ */
+inline float cpuAngleBetwABandAC(const Vec3f& A, const Vec3f& B, const Vec3f& C)
+{
+    const Vec3f V1 = (B - A).normalized();
+    const Vec3f V2 = (C - A).normalized();
+
+    const double x = double(V1.dot(V2));
+    double a = std::acos(x);
+    a = std::isinf(a) ? 0.0 : a;
+
+    return float(std::fabs(a) / (M_PI / 180.0));
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,212 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "CpuMipmapImage.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+
+namespace aliceVision {
+namespace depthMap {
+
+namespace {
+
+/**
+ * @brief Linear RGB (0..1) to CIELAB (0..255), same as the device rgb2xyz / xyz2lab functions.
+ */
+inline void rgb2lab(CpuColor& c)
+{
+    constexpr float d = 1 / 255.f;
+    const float r = c.x * d;
+    const float g = c.y * d;
+    const float b = c.z * d;
+
+    // RGB to XYZ, then whitepoint D65 XYZ=(0.95047, 1.00000, 1.08883)
+    const float rx = (0.4124564f * r + 0.3575761f * g + 0.1804375f * b) / 0.95047f;
+    const float ry = (0.2126729f * r + 0.7151522f * g + 0.0721750f * b);
+    const float rz = (0.0193339f * r + 0.1191920f * g + 0.9503041f * b) / 1.08883f;
+
+    const auto f = [](float v) { return (v > 216.0f / 24389.0f) ? std::cbrt(v) : (24389.0f / 27.0f * v + 16.0f) / 116.0f; };
+
+    const float fx = f(rx);
+    const float fy = f(ry);
+    const float fz = f(rz);
+
+    // convert values to fit into 0..255 (could be out-of-range)
+    c.x = (116.0f * fy - 16.0f) * 2.55f;
+    c.y = (500.0f * (fx - fy)) * 2.55f;
+    c.z = (200.0f * (fy - fz)) * 2.55f;
+}
+
+/**
+ * @brief Gaussian kernel weight, same as the device constant gaussian array.
+ */
+inline float gaussianWeight(int x) { return std::exp(-float(x * x) / 2.f); }
+
+}  // namespace
+
+void CpuMipmapImage::fill(const image::Image<image::RGBAfColor>& in_img, int minDownscale, int maxDownscale)
+{
+    _minDownscale = minDownscale;
+    _maxDownscale = maxDownscale;
+    _width = in_img.width();
+    _height = in_img.height();
+
+    const int nbLevels = int(std::log2(maxDownscale / minDownscale)) + 1;
+
+    // full-size image in range (0, 255)
+    Level fullSize;
+    fullSize.width = int(_width);
+    fullSize.height = int(_height);
+    fullSize.pixels.resize(_width * _height);
+
+    for (int y = 0; y < fullSize.height; ++y)
+    {
+        for (int x = 0; x < fullSize.width; ++x)
+        {
+            const image::RGBAfColor& rgba = in_img(y, x);
+            fullSize.pixels[std::size_t(y) * fullSize.width + x] = {rgba.r() * 255.f, rgba.g() * 255.f, rgba.b() * 255.f, rgba.a() * 255.f};
+        }
+    }
+
+    _levels.clear();
+    _levels.resize(nbLevels);
+
+    // downscale full-size input image to min downscale
+    if (minDownscale > 1)
+    {
+        Level& level0 = _levels.front();
+        level0.width = divideRoundUp(int(_width), minDownscale);
+        level0.height = divideRoundUp(int(_height), minDownscale);
+        level0.pixels.resize(std::size_t(level0.width) * level0.height);
+
+        const int gaussRadius = minDownscale;
+        const float s = float(minDownscale) * 0.5f;
+
+#pragma omp parallel for
+        for (int y = 0; y < level0.height; ++y)
+        {
+            for (int x = 0; x < level0.width; ++x)
+            {
+                CpuColor acc;
+                float sumFactor = 0.f;
+
+                for (int i = -gaussRadius; i <= gaussRadius; ++i)
+                {
+                    for (int j = -gaussRadius; j <= gaussRadius; ++j)
+                    {
+                        const CpuColor c = fullSize.fetch(float(x * minDownscale + j) + s, float(y * minDownscale + i) + s);
+                        const float factor = gaussianWeight(i) * gaussianWeight(j);
+
+                        acc.x += c.x * factor;
+                        acc.y += c.y * factor;
+                        acc.z += c.z * factor;
+                        acc.w += c.w * factor;
+                        sumFactor += factor;
+                    }
+                }
+
+                level0.pixels[std::size_t(y) * level0.width + x] = {acc.x / sumFactor, acc.y / sumFactor, acc.z / sumFactor, acc.w / sumFactor};
+            }
+        }
+    }
+    else
+    {
+        _levels.front() = std::move(fullSize);
+    }
+
+    // color conversion into CIELAB
+    for (CpuColor& c : _levels.front().pixels)
+        rgb2lab(c);
+
+    // initialize each level from the previous one
+    for (int l = 1; l < nbLevels; ++l)
+    {
+        const Level& previous = _levels[l - 1];
+        Level& current = _levels[l];
+
+        current.width = std::max(1, previous.width / 2);
+        current.height = std::max(1, previous.height / 2);
+        current.pixels.resize(std::size_t(current.width) * current.height);
+
+        constexpr int radius = 2;
+        const float px = 1.f / float(current.width);
+        const float py = 1.f / float(current.height);
+
+#pragma omp parallel for
+        for (int y = 0; y < current.height; ++y)
+        {
+            for (int x = 0; x < current.width; ++x)
+            {
+                CpuColor acc;
+                float sumFactor = 0.f;
+
+                for (int i = -radius; i <= radius; ++i)
+                {
+                    for (int j = -radius; j <= radius; ++j)
+                    {
+                        const float factor = gaussianWeight(i) * gaussianWeight(j);
+                        const CpuColor c = previous.sample((x + j + 0.5f) * px, (y + i + 0.5f) * py);
+
+                        acc.x += c.x * factor;
+                        acc.y += c.y * factor;
+                        acc.z += c.z * factor;
+                        acc.w += c.w * factor;
+                        sumFactor += factor;
+                    }
+                }
+
+                current.pixels[std::size_t(y) * current.width + x] = {acc.x / sumFactor, acc.y / sumFactor, acc.z / sumFactor, acc.w / sumFactor};
+            }
+        }
+    }
+}
+
+float CpuMipmapImage::getLevel(unsigned int downscale) const
+{
+    // check given downscale
+    if (downscale < _minDownscale || downscale > _maxDownscale)
+        ALICEVISION_THROW_ERROR("Cannot get host mipmap image level (downscale: " << downscale << ")");
+
+    return std::log2(float(downscale) / float(_minDownscale));
+}
+
+std::size_t CpuMipmapImage::getWidth(unsigned int downscale) const
+{
+    // check given downscale
+    if (downscale < _minDownscale || downscale > _maxDownscale)
+        ALICEVISION_THROW_ERROR("Cannot get host mipmap image level width (downscale: " << downscale << ")");
+
+    return std::size_t(divideRoundUp(int(_width), int(downscale)));
+}
+
+std::size_t CpuMipmapImage::getHeight(unsigned int downscale) const
+{
+    // check given downscale
+    if (downscale < _minDownscale || downscale > _maxDownscale)
+        ALICEVISION_THROW_ERROR("Cannot get host mipmap image level height (downscale: " << downscale << ")");
+
+    return std::size_t(divideRoundUp(int(_height), int(downscale)));
+}
+
+std::size_t CpuMipmapImage::getBytes() const
+{
+    std::size_t bytes = 0;
+    for (const Level& level : _levels)
+        bytes += level.pixels.size() * sizeof(CpuColor);
+    return bytes;
+}
+
+const CpuMipmapImage& getCpuMipmapImage(const CpuMipmapImages& mipmapImages, int camId)
+{
+    if (camId < 0 || camId >= int(mipmapImages.size()) || mipmapImages.at(camId) == nullptr)
+        ALICEVISION_THROW_ERROR("Cannot get host mipmap image, camera not loaded (camera id: " << camId << ")");
+
+    return *mipmapImages.at(camId);
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
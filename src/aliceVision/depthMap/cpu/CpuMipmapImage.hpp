@@ -0,0 +1,190 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/pixelTypes.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @struct CpuColor
+ * @brief CIELAB color and alpha in range (0, 255), same content as the device float4 texture fetch.
+ */
+struct CpuColor
+{
+    float x = 0.f;  //< L
+    float y = 0.f;  //< a
+    float z = 0.f;  //< b
+    float w = 0.f;  //< alpha
+};
+
+/**
+ * @class CPU mipmap image
+ * @brief Support class to maintain an image pyramid in host memory.
+ * @note Same content and sampling as DeviceMipmapImage:
+ *       CIELAB color, normalized coordinates, bilinear filtering, linear filtering between levels, clamp addressing.
+ *       Levels are stored in float (the device texture may use half).
+ */
+class CpuMipmapImage
+{
+  public:
+    CpuMipmapImage() = default;
+
+    // this class handles unique data, no copy constructor
+    CpuMipmapImage(CpuMipmapImage const&) = delete;
+
+    // this class handles unique data, no copy operator
+    void operator=(CpuMipmapImage const&) = delete;
+
+    /**
+     * @brief Update the CpuMipmapImage from an image buffer.
+     * @param[in] in_img the input image buffer (linear RGBA in range (0, 1))
+     * @param[in] minDownscale the first downscale level of the mipmap image (level 0)
+     * @param[in] maxDownscale the last downscale level of the mipmap image
+     */
+    void fill(const image::Image<image::RGBAfColor>& in_img, int minDownscale, int maxDownscale);
+
+    /**
+     * @brief Get the corresponding mipmap image level of the given downscale
+     * @note throw if the given downscale is not contained in the mipmap image
+     * @return corresponding mipmap image level
+     */
+    float getLevel(unsigned int downscale) const;
+
+    /**
+     * @brief Get the corresponding mipmap image level width of the given downscale.
+     * @note throw if the given downscale is not contained in the mipmap image
+     * @note Same as DeviceMipmapImage::getDimensions, used to compute normalized coordinates.
+     */
+    std::size_t getWidth(unsigned int downscale) const;
+
+    /**
+     * @brief Get the corresponding mipmap image level height of the given downscale.
+     * @note throw if the given downscale is not contained in the mipmap image
+     */
+    std::size_t getHeight(unsigned int downscale) const;
+
+    /**
+     * @brief Get host mipmap image minimum (first) downscale level.
+     * @return first level downscale factor (must be power of two)
+     */
+    inline unsigned int getMinDownscale() const { return _minDownscale; }
+
+    /**
+     * @brief Get host mipmap image maximum (last) downscale level.
+     * @return last level downscale factor (must be power of two)
+     */
+    inline unsigned int getMaxDownscale() const { return _maxDownscale; }
+
+    /**
+     * @brief Get the memory consumption of the mipmap image.
+     * @return memory consumption (in bytes)
+     */
+    std::size_t getBytes() const;
+
+    /**
+     * @brief Sample the mipmap image, same as tex2DLod<float4> on the device mipmap image texture.
+     * @param[in] u the normalized x coordinate
+     * @param[in] v the normalized y coordinate
+     * @param[in] level the mipmap level
+     * @return the sampled color
+     */
+    inline CpuColor sample(float u, float v, float level) const
+    {
+        const float maxLevel = float(_levels.size() - 1);
+        const float l = std::min(std::max(level, 0.f), maxLevel);
+        const int l0 = int(l);
+        const float fl = l - float(l0);
+
+        const CpuColor c0 = _levels[l0].sample(u, v);
+
+        if (fl <= 0.f || l0 + 1 >= int(_levels.size()))
+            return c0;
+
+        const CpuColor c1 = _levels[l0 + 1].sample(u, v);
+        return {c0.x + (c1.x - c0.x) * fl, c0.y + (c1.y - c0.y) * fl, c0.z + (c1.z - c0.z) * fl, c0.w + (c1.w - c0.w) * fl};
+    }
+
+  private:
+    /**
+     * @struct Level
+     * @brief Single mipmap level, interleaved (L, a, b, alpha) pixels.
+     */
+    struct Level
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<CpuColor> pixels;
+
+        inline const CpuColor& at(int x, int y) const { return pixels[std::size_t(y) * width + x]; }
+
+        /// bilinear fetch with clamp addressing, unnormalized coordinates (texel centers at +0.5)
+        inline CpuColor fetch(float x, float y) const
+        {
+            const float px = x - 0.5f;
+            const float py = y - 0.5f;
+            const float fx0 = std::floor(px);
+            const float fy0 = std::floor(py);
+            const float ax = px - fx0;
+            const float ay = py - fy0;
+
+            const int x0 = std::min(std::max(int(fx0), 0), width - 1);
+            const int y0 = std::min(std::max(int(fy0), 0), height - 1);
+            const int x1 = std::min(std::max(int(fx0) + 1, 0), width - 1);
+            const int y1 = std::min(std::max(int(fy0) + 1, 0), height - 1);
+
+            const CpuColor& c00 = at(x0, y0);
+            const CpuColor& c10 = at(x1, y0);
+            const CpuColor& c01 = at(x0, y1);
+            const CpuColor& c11 = at(x1, y1);
+
+            const float w00 = (1.f - ax) * (1.f - ay);
+            const float w10 = ax * (1.f - ay);
+            const float w01 = (1.f - ax) * ay;
+            const float w11 = ax * ay;
+
+            return {c00.x * w00 + c10.x * w10 + c01.x * w01 + c11.x * w11,
+                    c00.y * w00 + c10.y * w10 + c01.y * w01 + c11.y * w11,
+                    c00.z * w00 + c10.z * w10 + c01.z * w01 + c11.z * w11,
+                    c00.w * w00 + c10.w * w10 + c01.w * w01 + c11.w * w11};
+        }
+
+        /// bilinear fetch with normalized coordinates
+        inline CpuColor sample(float u, float v) const { return fetch(u * float(width), v * float(height)); }
+    };
+
+    std::vector<Level> _levels;       //< mipmap levels, level 0 at min downscale
+    unsigned int _minDownscale = 0;  //< the min downscale factor (must be power of two), first downscale level
+    unsigned int _maxDownscale = 0;  //< the max downscale factor (must be power of two), last downscale level
+    std::size_t _width = 0;          //< original image buffer width (no downscale)
+    std::size_t _height = 0;         //< original image buffer heigh (no downscale)
+};
+
+/**
+ * @brief CPU mipmap images of a batch, indexed by camera index (nullptr if the camera is not loaded).
+ */
+using CpuMipmapImages = std::vector<std::unique_ptr<CpuMipmapImage>>;
+
+/**
+ * @brief Get the CPU mipmap image of the given camera.
+ * @note throw if the camera mipmap image is not loaded
+ * @param[in] mipmapImages the CPU mipmap images of the batch
+ * @param[in] camId the camera index in the ordered list of the SfMData
+ * @return the camera CPU mipmap image
+ */
+const CpuMipmapImage& getCpuMipmapImage(const CpuMipmapImages& mipmapImages, int camId);
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,252 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "CpuRefine.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/depthMap/cpu/cpuMapIO.hpp>
+#include <aliceVision/depthMap/cpu/CpuCameraParams.hpp>
+#include <aliceVision/depthMap/cpu/cpuDepthSimilarityMap.hpp>
+#include <aliceVision/depthMap/cpu/cpuSimilarityVolume.hpp>
+
+namespace aliceVision {
+namespace depthMap {
+
+CpuRefine::CpuRefine(const mvsUtils::MultiViewParams& mp,
+                     const mvsUtils::TileParams& tileParams,
+                     const RefineParams& refineParams,
+                     const CpuMipmapImages& mipmapImages)
+  : _mp(mp),
+    _tileParams(tileParams),
+    _refineParams(refineParams),
+    _mipmapImages(mipmapImages)
+{
+    if (_refineParams.exportIntermediateCrossVolumes || _refineParams.exportIntermediateTopographicCutVolumes ||
+        _refineParams.exportIntermediateVolume9pCsv)
+        ALICEVISION_LOG_WARNING("Refine intermediate volume exports are not available with the CPU backend, ignored.");
+
+    // get tile maximum dimensions
+    const int downscale = _refineParams.scale * _refineParams.stepXY;
+    const int maxTileWidth = divideRoundUp(tileParams.bufferWidth, downscale);
+    const int maxTileHeight = divideRoundUp(tileParams.bufferHeight, downscale);
+
+    // allocate depth/sim maps in host memory
+    _sgmDepthPixSizeMap.allocate(maxTileWidth, maxTileHeight);
+    _refinedDepthSimMap.allocate(maxTileWidth, maxTileHeight);
+    _optimizedDepthSimMap.allocate(maxTileWidth, maxTileHeight);
+
+    // allocate SGM upscaled normal map in host memory
+    if (_refineParams.useSgmNormalMap)
+        _sgmNormalMap.allocate(maxTileWidth, maxTileHeight);
+
+    // allocate normal map in host memory
+    if (_refineParams.exportIntermediateNormalMaps)
+        _normalMap.allocate(maxTileWidth, maxTileHeight);
+
+    // allocate refine volume in host memory
+    const int nbDepthsToRefine = _refineParams.halfNbDepths * 2 + 1;
+    _volumeRefineSim.allocate(maxTileWidth, maxTileHeight, nbDepthsToRefine);
+
+    // allocate depth/sim map optimization buffers
+    if (_refineParams.useColorOptimization)
+    {
+        _optTmpDepthMap.allocate(maxTileWidth, maxTileHeight);
+        _optImgVariance.allocate(maxTileWidth, maxTileHeight);
+    }
+}
+
+double CpuRefine::getMemoryConsumption() const
+{
+    size_t bytes = 0;
+
+    bytes += _sgmDepthPixSizeMap.getBytes();
+    bytes += _refinedDepthSimMap.getBytes();
+    bytes += _optimizedDepthSimMap.getBytes();
+    bytes += _sgmNormalMap.getBytes();
+    bytes += _normalMap.getBytes();
+    bytes += _volumeRefineSim.getBytes();
+    bytes += _optTmpDepthMap.getBytes();
+    bytes += _optImgVariance.getBytes();
+
+    return (double(bytes) / (1024.0 * 1024.0));
+}
+
+void CpuRefine::refineRc(const Tile& tile, const CpuMap<Vec2f>& in_sgmDepthThicknessMap, const CpuMap<Vec3f>& in_sgmNormalMap)
+{
+    const IndexT viewId = _mp.getViewId(tile.rc);
+
+    ALICEVISION_LOG_INFO(tile << "Refine depth/sim map of view id: " << viewId << ", rc: " << tile.rc << " (" << (tile.rc + 1) << " / " << _mp.ncams
+                              << ").");
+
+    // compute upscaled SGM depth/pixSize map
+    // compute upscaled SGM normal map
+    {
+        // downscale the region of interest
+        const ROI downscaledRoi = downscaleROI(tile.roi, _refineParams.scale * _refineParams.stepXY);
+
+        // get R mipmap image
+        const CpuMipmapImage& rcMipmapImage = getCpuMipmapImage(_mipmapImages, tile.rc);
+
+        // compute upscaled SGM depth/pixSize map
+        // - upscale SGM depth/thickness map
+        // - filter masked pixels (alpha)
+        // - compute pixSize from SGM thickness
+        cpu_computeSgmUpscaledDepthPixSizeMap(_sgmDepthPixSizeMap, in_sgmDepthThicknessMap, rcMipmapImage, _refineParams, downscaledRoi);
+
+        // export intermediate depth/pixSize map (if requested by user)
+        if (_refineParams.exportIntermediateDepthSimMaps)
+            writeDepthPixSizeMap(tile.rc, _mp, _tileParams, tile.roi, _sgmDepthPixSizeMap, _refineParams.scale, _refineParams.stepXY, "sgmUpscaled");
+
+        // upscale SGM normal map (if needed)
+        if (_refineParams.useSgmNormalMap && !in_sgmNormalMap.isEmpty())
+        {
+            cpu_normalMapUpscale(_sgmNormalMap, in_sgmNormalMap, downscaledRoi);
+        }
+    }
+
+    // refine and fuse depth/sim map
+    if (_refineParams.useRefineFuse)
+    {
+        // refine and fuse with volume strategy
+        refineAndFuseDepthSimMap(tile);
+    }
+    else
+    {
+        ALICEVISION_LOG_INFO(tile << "Refine and fuse depth/sim map volume disabled.");
+        cpu_depthSimMapCopyDepthOnly(_refinedDepthSimMap, _sgmDepthPixSizeMap, 1.0f);
+    }
+
+    // export intermediate depth/sim map (if requested by user)
+    if (_refineParams.exportIntermediateDepthSimMaps)
+        writeDepthSimMap(tile.rc, _mp, _tileParams, tile.roi, _refinedDepthSimMap, _refineParams.scale, _refineParams.stepXY, "refinedFused");
+
+    // export intermediate normal map (if requested by user)
+    if (_refineParams.exportIntermediateNormalMaps)
+        computeAndWriteNormalMap(tile, _refinedDepthSimMap, "refinedFused");
+
+    // optimize depth/sim map
+    if (_refineParams.useColorOptimization && _refineParams.optimizationNbIterations > 0)
+    {
+        optimizeDepthSimMap(tile);
+    }
+    else
+    {
+        ALICEVISION_LOG_INFO(tile << "Color optimize depth/sim map disabled.");
+        _optimizedDepthSimMap = _refinedDepthSimMap;
+    }
+
+    // export intermediate normal map (if requested by user)
+    if (_refineParams.exportIntermediateNormalMaps)
+        computeAndWriteNormalMap(tile, _optimizedDepthSimMap);
+
+    ALICEVISION_LOG_INFO(tile << "Refine depth/sim map done.");
+}
+
+void CpuRefine::refineAndFuseDepthSimMap(const Tile& tile)
+{
+    ALICEVISION_LOG_INFO(tile << "Refine and fuse depth/sim map volume.");
+
+    // downscale the region of interest
+    const ROI downscaledRoi = downscaleROI(tile.roi, _refineParams.scale * _refineParams.stepXY);
+
+    // get the depth range
+    const Range depthRange(0, _volumeRefineSim.depth());
+
+    // initialize the similarity volume at 0
+    // each tc filtered and inverted similarity value will be summed in this volume
+    _volumeRefineSim.fill(CpuSimRefine(0.f));
+
+    // get R camera parameters
+    CpuCameraParams rcCameraParams;
+    fillCpuCameraParams(rcCameraParams, tile.rc, _refineParams.scale, _mp);
+
+    // get R mipmap image
+    const CpuMipmapImage& rcMipmapImage = getCpuMipmapImage(_mipmapImages, tile.rc);
+
+    // compute for each RcTc each similarity value for each depth to refine
+    // sum the inverted / filtered similarity value, best value is the HIGHEST
+    for (std::size_t tci = 0; tci < tile.refineTCams.size(); ++tci)
+    {
+        const int tc = tile.refineTCams.at(tci);
+
+        // get T camera parameters
+        CpuCameraParams tcCameraParams;
+        fillCpuCameraParams(tcCameraParams, tc, _refineParams.scale, _mp);
+
+        // get T mipmap image
+        const CpuMipmapImage& tcMipmapImage = getCpuMipmapImage(_mipmapImages, tc);
+
+        ALICEVISION_LOG_DEBUG(tile << "Refine similarity volume:" << std::endl
+                                   << "\t- rc: " << tile.rc << std::endl
+                                   << "\t- tc: " << tc << " (" << (tci + 1) << "/" << tile.refineTCams.size() << ")" << std::endl
+                                   << "\t- tile range x: [" << downscaledRoi.x.begin << " - " << downscaledRoi.x.end << "]" << std::endl
+                                   << "\t- tile range y: [" << downscaledRoi.y.begin << " - " << downscaledRoi.y.end << "]" << std::endl);
+
+        cpu_volumeRefineSimilarity(_volumeRefineSim,
+                                   _sgmDepthPixSizeMap,
+                                   (_refineParams.useSgmNormalMap) ? &_sgmNormalMap : nullptr,
+                                   rcCameraParams,
+                                   tcCameraParams,
+                                   rcMipmapImage,
+                                   tcMipmapImage,
+                                   _refineParams,
+                                   depthRange,
+                                   downscaledRoi);
+    }
+
+    // retrieve the best depth/sim in the volume
+    // compute sub-pixel sample using a sliding gaussian
+    cpu_volumeRefineBestDepth(_refinedDepthSimMap, _sgmDepthPixSizeMap, _volumeRefineSim, _refineParams, downscaledRoi);
+
+    ALICEVISION_LOG_INFO(tile << "Refine and fuse depth/sim map volume done.");
+}
+
+void CpuRefine::optimizeDepthSimMap(const Tile& tile)
+{
+    ALICEVISION_LOG_INFO(tile << "Color optimize depth/sim map.");
+
+    // downscale the region of interest
+    const ROI downscaledRoi = downscaleROI(tile.roi, _refineParams.scale * _refineParams.stepXY);
+
+    // get R camera parameters
+    CpuCameraParams rcCameraParams;
+    fillCpuCameraParams(rcCameraParams, tile.rc, _refineParams.scale, _mp);
+
+    // get R mipmap image
+    const CpuMipmapImage& rcMipmapImage = getCpuMipmapImage(_mipmapImages, tile.rc);
+
+    cpu_depthSimMapOptimizeGradientDescent(_optimizedDepthSimMap,  // output depth/sim map optimized
+                                           _optImgVariance,        // image variance buffer pre-allocate
+                                           _optTmpDepthMap,        // temporary depth map buffer pre-allocate
+                                           _sgmDepthPixSizeMap,    // input SGM upscaled depth/pixSize map
+                                           _refinedDepthSimMap,    // input refined and fused depth/sim map
+                                           rcCameraParams,
+                                           rcMipmapImage,
+                                           _refineParams,
+                                           downscaledRoi);
+
+    ALICEVISION_LOG_INFO(tile << "Color optimize depth/sim map done.");
+}
+
+void CpuRefine::computeAndWriteNormalMap(const Tile& tile, const CpuMap<Vec2f>& in_depthSimMap, const std::string& name)
+{
+    // downscale the region of interest
+    const ROI downscaledRoi = downscaleROI(tile.roi, _refineParams.scale * _refineParams.stepXY);
+
+    // get R camera parameters
+    CpuCameraParams rcCameraParams;
+    fillCpuCameraParams(rcCameraParams, tile.rc, _refineParams.scale, _mp);
+
+    ALICEVISION_LOG_INFO(tile << "Refine compute normal map of view id: " << _mp.getViewId(tile.rc) << ", rc: " << tile.rc << " (" << (tile.rc + 1)
+                              << " / " << _mp.ncams << ").");
+
+    cpu_depthSimMapComputeNormal(_normalMap, in_depthSimMap, rcCameraParams, _refineParams.stepXY, downscaledRoi);
+
+    writeNormalMap(tile.rc, _mp, _tileParams, tile.roi, _normalMap, _refineParams.scale, _refineParams.stepXY, name);
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,108 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/ROI.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/TileParams.hpp>
+#include <aliceVision/depthMap/Tile.hpp>
+#include <aliceVision/depthMap/RefineParams.hpp>
+#include <aliceVision/depthMap/cpu/CpuBuffer.hpp>
+#include <aliceVision/depthMap/cpu/CpuMipmapImage.hpp>
+
+#include <string>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @class Depth map estimation Refine on CPU
+ * @brief Manages the calculation of the Refine step in host memory.
+ * @note Same workflow and results as Refine, one instance per worker thread.
+ */
+class CpuRefine
+{
+  public:
+    /**
+     * @brief CpuRefine constructor.
+     * @param[in] mp the multi-view parameters
+     * @param[in] tileParams tile workflow parameters
+     * @param[in] refineParams the Refine parameters
+     * @param[in] mipmapImages the batch CPU mipmap images
+     */
+    CpuRefine(const mvsUtils::MultiViewParams& mp,
+              const mvsUtils::TileParams& tileParams,
+              const RefineParams& refineParams,
+              const CpuMipmapImages& mipmapImages);
+
+    // no default constructor
+    CpuRefine() = delete;
+
+    // default destructor
+    ~CpuRefine() = default;
+
+    // final depth/similarity map getter
+    inline const CpuMap<Vec2f>& getDepthSimMap() const { return _optimizedDepthSimMap; }
+
+    /**
+     * @brief Get memory consumption in host memory.
+     * @return host memory consumption (in MB)
+     */
+    double getMemoryConsumption() const;
+
+    /**
+     * @brief Refine for a single R camera the Semi-Global Matching depth/sim map.
+     * @param[in] tile The given tile for Refine computation
+     * @param[in] in_sgmDepthThicknessMap the SGM result depth/thickness map
+     * @param[in] in_sgmNormalMap the SGM result normal map (or empty)
+     */
+    void refineRc(const Tile& tile, const CpuMap<Vec2f>& in_sgmDepthThicknessMap, const CpuMap<Vec3f>& in_sgmNormalMap);
+
+  private:
+    // private methods
+
+    /**
+     * @brief Refine and fuse the given depth/sim map using volume strategy.
+     * @param[in] tile The given tile for Refine computation
+     */
+    void refineAndFuseDepthSimMap(const Tile& tile);
+
+    /**
+     * @brief Optimize the refined depth/sim maps.
+     * @param[in] tile The given tile for Refine computation
+     */
+    void optimizeDepthSimMap(const Tile& tile);
+
+    /**
+     * @brief Compute and write the normal map from the input depth/sim map.
+     * @param[in] tile The given tile for Refine computation
+     * @param[in] in_depthSimMap the input depth/sim map
+     * @param[in] name the export filename
+     */
+    void computeAndWriteNormalMap(const Tile& tile, const CpuMap<Vec2f>& in_depthSimMap, const std::string& name = "");
+
+    // private members
+
+    const mvsUtils::MultiViewParams& _mp;     //< Multi-view parameters
+    const mvsUtils::TileParams& _tileParams;  //< tile workflow parameters
+    const RefineParams& _refineParams;        //< Refine parameters
+    const CpuMipmapImages& _mipmapImages;     //< batch CPU mipmap images
+
+    // private members in host memory
+
+    CpuMap<Vec2f> _sgmDepthPixSizeMap;         //< rc upscaled SGM depth/pixSize map
+    CpuMap<Vec2f> _refinedDepthSimMap;         //< rc refined and fused depth/sim map
+    CpuMap<Vec2f> _optimizedDepthSimMap;       //< rc optimized depth/sim map
+    CpuMap<Vec3f> _sgmNormalMap;               //< rc upscaled SGM normal map (for experimentation purposes)
+    CpuMap<Vec3f> _normalMap;                  //< rc normal map (for debug / intermediate results purposes)
+    CpuVolume<CpuSimRefine> _volumeRefineSim;  //< rc refine similarity volume
+    CpuMap<float> _optTmpDepthMap;             //< for color optimization: temporary depth map buffer
+    CpuMap<float> _optImgVariance;             //< for color optimization: image variance buffer
+};
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,255 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "CpuSgm.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/depthMap/cpu/cpuMapIO.hpp>
+#include <aliceVision/depthMap/cpu/CpuCameraParams.hpp>
+#include <aliceVision/depthMap/cpu/cpuDepthSimilarityMap.hpp>
+#include <aliceVision/depthMap/cpu/cpuSimilarityVolume.hpp>
+
+namespace aliceVision {
+namespace depthMap {
+
+CpuSgm::CpuSgm(const mvsUtils::MultiViewParams& mp,
+               const mvsUtils::TileParams& tileParams,
+               const SgmParams& sgmParams,
+               const CpuMipmapImages& mipmapImages,
+               bool computeDepthSimMap,
+               bool computeNormalMap)
+  : _mp(mp),
+    _tileParams(tileParams),
+    _sgmParams(sgmParams),
+    _mipmapImages(mipmapImages),
+    _computeDepthSimMap(computeDepthSimMap || sgmParams.exportIntermediateDepthSimMaps),
+    _computeNormalMap(computeNormalMap || sgmParams.exportIntermediateNormalMaps)
+{
+    if (_sgmParams.exportIntermediateVolumes || _sgmParams.exportIntermediateCrossVolumes ||
+        _sgmParams.exportIntermediateTopographicCutVolumes || _sgmParams.exportIntermediateVolume9pCsv)
+        ALICEVISION_LOG_WARNING("SGM intermediate volume exports are not available with the CPU backend, ignored.");
+
+    // get tile maximum dimensions
+    const int downscale = _sgmParams.scale * _sgmParams.stepXY;
+    const int maxTileWidth = divideRoundUp(tileParams.bufferWidth, downscale);
+    const int maxTileHeight = divideRoundUp(tileParams.bufferHeight, downscale);
+
+    // allocate depth thickness map in host memory
+    _depthThicknessMap.allocate(maxTileWidth, maxTileHeight);
+
+    // allocate depth/sim map in host memory
+    if (_computeDepthSimMap)
+        _depthSimMap.allocate(maxTileWidth, maxTileHeight);
+
+    // allocate normal map in host memory
+    if (_computeNormalMap)
+        _normalMap.allocate(maxTileWidth, maxTileHeight);
+
+    // allocate similarity volumes in host memory
+    _volumeBestSim.allocate(maxTileWidth, maxTileHeight, _sgmParams.maxDepths);
+    _volumeSecBestSim.allocate(maxTileWidth, maxTileHeight, _sgmParams.maxDepths);
+}
+
+double CpuSgm::getMemoryConsumption() const
+{
+    size_t bytes = 0;
+
+    bytes += _depthThicknessMap.getBytes();
+    bytes += _depthSimMap.getBytes();
+    bytes += _normalMap.getBytes();
+    bytes += _volumeBestSim.getBytes();
+    bytes += _volumeSecBestSim.getBytes();
+
+    return (double(bytes) / (1024.0 * 1024.0));
+}
+
+void CpuSgm::sgmRc(const Tile& tile, const SgmDepthList& tileDepthList)
+{
+    const IndexT viewId = _mp.getViewId(tile.rc);
+
+    ALICEVISION_LOG_INFO(tile << "SGM depth/thickness map of view id: " << viewId << ", rc: " << tile.rc << " (" << (tile.rc + 1) << " / "
+                              << _mp.ncams << ").");
+
+    // check SGM depth list and T cameras
+    if (tile.sgmTCams.empty() || tileDepthList.getDepths().empty())
+        ALICEVISION_THROW_ERROR(tile << "Cannot compute Semi-Global Matching, no depths or no T cameras (viewId: " << viewId << ").");
+
+    // compute best sim and second best sim volumes
+    computeSimilarityVolumes(tile, tileDepthList);
+
+    // this is here for experimental purposes
+    // to show how SGGC work on non optimized depthmaps
+    // it must equals to true in normal case
+    if (_sgmParams.doSgmOptimizeVolume)
+    {
+        optimizeSimilarityVolume(tile, tileDepthList);
+    }
+    else
+    {
+        // best sim volume is normally reuse to put optimized similarity
+        _volumeBestSim.copyFrom(_volumeSecBestSim);
+    }
+
+    // retrieve best depth
+    retrieveBestDepth(tile, tileDepthList);
+
+    // export intermediate depth/sim map (if requested by user)
+    if (_sgmParams.exportIntermediateDepthSimMaps)
+    {
+        writeDepthSimMap(tile.rc, _mp, _tileParams, tile.roi, _depthSimMap, _sgmParams.scale, _sgmParams.stepXY, "sgm");
+    }
+
+    // compute normal map from depth/sim map if needed
+    if (_computeNormalMap)
+    {
+        // downscale the region of interest
+        const ROI downscaledRoi = downscaleROI(tile.roi, _sgmParams.scale * _sgmParams.stepXY);
+
+        // get R camera parameters
+        CpuCameraParams rcCameraParams;
+        fillCpuCameraParams(rcCameraParams, tile.rc, _sgmParams.scale, _mp);
+
+        ALICEVISION_LOG_INFO(tile << "SGM compute normal map of view id: " << viewId << ", rc: " << tile.rc << " (" << (tile.rc + 1) << " / "
+                                  << _mp.ncams << ").");
+        cpu_depthSimMapComputeNormal(_normalMap, _depthSimMap, rcCameraParams, _sgmParams.stepXY, downscaledRoi);
+
+        // export intermediate normal map (if requested by user)
+        if (_sgmParams.exportIntermediateNormalMaps)
+        {
+            writeNormalMap(tile.rc, _mp, _tileParams, tile.roi, _normalMap, _sgmParams.scale, _sgmParams.stepXY, "sgm");
+        }
+    }
+
+    ALICEVISION_LOG_INFO(tile << "SGM depth/thickness map done.");
+}
+
+void CpuSgm::smoothThicknessMap(const Tile& tile, const RefineParams& refineParams)
+{
+    ALICEVISION_LOG_INFO(tile << "SGM Smooth thickness map.");
+
+    // downscale the region of interest
+    const ROI downscaledRoi = downscaleROI(tile.roi, _sgmParams.scale * _sgmParams.stepXY);
+
+    // in-place result thickness map smoothing with adjacent pixels
+    cpu_depthThicknessSmoothThickness(_depthThicknessMap, _sgmParams, refineParams, downscaledRoi);
+
+    ALICEVISION_LOG_INFO(tile << "SGM Smooth thickness map done.");
+}
+
+void CpuSgm::computeSimilarityVolumes(const Tile& tile, const SgmDepthList& tileDepthList)
+{
+    ALICEVISION_LOG_INFO(tile << "SGM Compute similarity volume.");
+
+    // downscale the region of interest
+    const ROI downscaledRoi = downscaleROI(tile.roi, _sgmParams.scale * _sgmParams.stepXY);
+
+    // initialize the two similarity volumes at 255
+    _volumeBestSim.fill(CpuSim(255));
+    _volumeSecBestSim.fill(CpuSim(255));
+
+    // get R camera parameters
+    CpuCameraParams rcCameraParams;
+    fillCpuCameraParams(rcCameraParams, tile.rc, _sgmParams.scale, _mp);
+
+    // get R mipmap image
+    const CpuMipmapImage& rcMipmapImage = getCpuMipmapImage(_mipmapImages, tile.rc);
+
+    // compute similarity volume per Rc Tc
+    for (std::size_t tci = 0; tci < tile.sgmTCams.size(); ++tci)
+    {
+        const int tc = tile.sgmTCams.at(tci);
+
+        const int firstDepth = tileDepthList.getDepthsTcLimits()[tci].x;
+        const int lastDepth = firstDepth + tileDepthList.getDepthsTcLimits()[tci].y;
+
+        const Range tcDepthRange(firstDepth, lastDepth);
+
+        // get T camera parameters
+        CpuCameraParams tcCameraParams;
+        fillCpuCameraParams(tcCameraParams, tc, _sgmParams.scale, _mp);
+
+        // get T mipmap image
+        const CpuMipmapImage& tcMipmapImage = getCpuMipmapImage(_mipmapImages, tc);
+
+        ALICEVISION_LOG_DEBUG(tile << "Compute similarity volume:" << std::endl
+                                   << "\t- rc: " << tile.rc << std::endl
+                                   << "\t- tc: " << tc << " (" << (tci + 1) << "/" << tile.sgmTCams.size() << ")" << std::endl
+                                   << "\t- tc first depth: " << firstDepth << std::endl
+                                   << "\t- tc last depth: " << lastDepth << std::endl
+                                   << "\t- tile range x: [" << downscaledRoi.x.begin << " - " << downscaledRoi.x.end << "]" << std::endl
+                                   << "\t- tile range y: [" << downscaledRoi.y.begin << " - " << downscaledRoi.y.end << "]" << std::endl);
+
+        cpu_volumeComputeSimilarity(_volumeBestSim,
+                                    _volumeSecBestSim,
+                                    tileDepthList.getDepths(),
+                                    rcCameraParams,
+                                    tcCameraParams,
+                                    rcMipmapImage,
+                                    tcMipmapImage,
+                                    _sgmParams,
+                                    tcDepthRange,
+                                    downscaledRoi);
+    }
+
+    // update second best uninitialized similarity volume values with first best similarity volume values
+    if (_sgmParams.updateUninitializedSim)  // should always be true, false for debug purposes
+    {
+        ALICEVISION_LOG_DEBUG(tile << "SGM Update uninitialized similarity volume values from best similarity volume.");
+
+        cpu_volumeUpdateUninitializedSimilarity(_volumeBestSim, _volumeSecBestSim);
+    }
+
+    ALICEVISION_LOG_INFO(tile << "SGM Compute similarity volume done.");
+}
+
+void CpuSgm::optimizeSimilarityVolume(const Tile& tile, const SgmDepthList& tileDepthList)
+{
+    ALICEVISION_LOG_INFO(tile << "SGM Optimizing volume (filtering axes: " << _sgmParams.filteringAxes << ").");
+
+    // downscale the region of interest
+    const ROI downscaledRoi = downscaleROI(tile.roi, _sgmParams.scale * _sgmParams.stepXY);
+
+    // get R mipmap image
+    const CpuMipmapImage& rcMipmapImage = getCpuMipmapImage(_mipmapImages, tile.rc);
+
+    cpu_volumeOptimize(_volumeBestSim,     // output volume (reuse best sim to put optimized similarity)
+                       _volumeSecBestSim,  // input volume
+                       rcMipmapImage,
+                       _sgmParams,
+                       int(tileDepthList.getDepths().size()),
+                       downscaledRoi);
+
+    ALICEVISION_LOG_INFO(tile << "SGM Optimizing volume done.");
+}
+
+void CpuSgm::retrieveBestDepth(const Tile& tile, const SgmDepthList& tileDepthList)
+{
+    ALICEVISION_LOG_INFO(tile << "SGM Retrieve best depth in volume.");
+
+    // downscale the region of interest
+    const ROI downscaledRoi = downscaleROI(tile.roi, _sgmParams.scale * _sgmParams.stepXY);
+
+    // get depth range
+    const Range depthRange(0, tileDepthList.getDepths().size());
+
+    // get R camera parameters at scale 1
+    CpuCameraParams rcCameraParams;
+    fillCpuCameraParams(rcCameraParams, tile.rc, 1, _mp);
+
+    cpu_volumeRetrieveBestDepth(_depthThicknessMap,  // output depth thickness map
+                                _depthSimMap,        // output depth/sim map (or empty)
+                                tileDepthList.getDepths(),
+                                _volumeBestSim,      // second best sim volume optimized in best sim volume
+                                rcCameraParams,
+                                _sgmParams,
+                                depthRange,
+                                downscaledRoi);
+
+    ALICEVISION_LOG_INFO(tile << "SGM Retrieve best depth in volume done.");
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,125 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/ROI.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/TileParams.hpp>
+#include <aliceVision/depthMap/Tile.hpp>
+#include <aliceVision/depthMap/RefineParams.hpp>
+#include <aliceVision/depthMap/SgmParams.hpp>
+#include <aliceVision/depthMap/SgmDepthList.hpp>
+#include <aliceVision/depthMap/cpu/CpuBuffer.hpp>
+#include <aliceVision/depthMap/cpu/CpuMipmapImage.hpp>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @class Depth map estimation Semi-Global Matching on CPU
+ * @brief Manages the calculation of the Semi-Global Matching step in host memory.
+ * @note Same workflow and results as Sgm, one instance per worker thread.
+ */
+class CpuSgm
+{
+  public:
+    /**
+     * @brief CpuSgm constructor.
+     * @param[in] mp the multi-view parameters
+     * @param[in] tileParams tile workflow parameters
+     * @param[in] sgmParams the Semi Global Matching parameters
+     * @param[in] mipmapImages the batch CPU mipmap images
+     * @param[in] computeDepthSimMap Enable final depth/sim map computation
+     * @param[in] computeNormalMap Enable final normal map computation
+     */
+    CpuSgm(const mvsUtils::MultiViewParams& mp,
+           const mvsUtils::TileParams& tileParams,
+           const SgmParams& sgmParams,
+           const CpuMipmapImages& mipmapImages,
+           bool computeDepthSimMap,
+           bool computeNormalMap);
+
+    // no default constructor
+    CpuSgm() = delete;
+
+    // default destructor
+    ~CpuSgm() = default;
+
+    // final depth/thickness map getter
+    inline const CpuMap<Vec2f>& getDepthThicknessMap() const { return _depthThicknessMap; }
+
+    // final depth/similarity map getter (optional: could be empty)
+    inline const CpuMap<Vec2f>& getDepthSimMap() const { return _depthSimMap; }
+
+    // final normal map getter (optional: could be empty)
+    inline const CpuMap<Vec3f>& getNormalMap() const { return _normalMap; }
+
+    /**
+     * @brief Get memory consumption in host memory.
+     * @return host memory consumption (in MB)
+     */
+    double getMemoryConsumption() const;
+
+    /**
+     * @brief Compute for a single R camera the Semi-Global Matching.
+     * @param[in] tile The given tile for SGM computation
+     * @param[in] tileDepthList the tile SGM depth list
+     */
+    void sgmRc(const Tile& tile, const SgmDepthList& tileDepthList);
+
+    /**
+     * @brief Smooth SGM result thickness map
+     * @note Important to be a proper Refine input parameter.
+     * @param[in] tile The given tile for SGM computation
+     * @param[in] refineParams the Refine parameters
+     */
+    void smoothThicknessMap(const Tile& tile, const RefineParams& refineParams);
+
+  private:
+    // private methods
+
+    /**
+     * @brief Compute for each RcTc the best / second best similarity volumes.
+     * @param[in] tile The given tile for SGM computation
+     * @param[in] tileDepthList the tile SGM depth list
+     */
+    void computeSimilarityVolumes(const Tile& tile, const SgmDepthList& tileDepthList);
+
+    /**
+     * @brief Optimize the given similarity volume.
+     * @param[in] tile The given tile for SGM computation
+     * @param[in] tileDepthList the tile SGM depth list
+     */
+    void optimizeSimilarityVolume(const Tile& tile, const SgmDepthList& tileDepthList);
+
+    /**
+     * @brief Retrieve the best depths in the given similarity volume.
+     * @param[in] tile The given tile for SGM computation
+     * @param[in] tileDepthList the tile SGM depth list
+     */
+    void retrieveBestDepth(const Tile& tile, const SgmDepthList& tileDepthList);
+
+    // private members
+
+    const mvsUtils::MultiViewParams& _mp;     //< Multi-view parameters
+    const mvsUtils::TileParams& _tileParams;  //< tile workflow parameters
+    const SgmParams& _sgmParams;              //< Semi Global Matching parameters
+    const CpuMipmapImages& _mipmapImages;     //< batch CPU mipmap images
+    const bool _computeDepthSimMap;           //< needs to compute a final depth/sim map
+    const bool _computeNormalMap;             //< needs to compute a final normal map
+
+    // private members in host memory
+
+    CpuMap<Vec2f> _depthThicknessMap;     //< rc result depth thickness map
+    CpuMap<Vec2f> _depthSimMap;           //< rc result depth/sim map
+    CpuMap<Vec3f> _normalMap;             //< rc normal map
+    CpuVolume<CpuSim> _volumeBestSim;     //< rc best similarity volume
+    CpuVolume<CpuSim> _volumeSecBestSim;  //< rc second best similarity volume
+};
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,524 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "cpuDepthSimilarityMap.hpp"
+
+#include <aliceVision/depthMap/cpu/cpuPatch.hpp>
+
+#include <Eigen/Eigenvalues>
+
+#include <algorithm>
+#include <cmath>
+
+namespace aliceVision {
+namespace depthMap {
+
+namespace {
+
+/**
+ * @brief Nearest neighbor fetch with clamp addressing, same as a point filtered device texture.
+ */
+template<typename T>
+inline const T& fetchNearest(const CpuMap<T>& map, float x, float y)
+{
+    const int xi = std::min(std::max(int(std::floor(x)), 0), int(map.width()) - 1);
+    const int yi = std::min(std::max(int(std::floor(y)), 0), int(map.height()) - 1);
+    return map(xi, yi);
+}
+
+/**
+ * @brief Get the smoothing step and the energy of the given cell, same as the device getCellSmoothStepEnergy.
+ * @return (smoothStep, energy)
+ */
+inline Vec2f getCellSmoothStepEnergy(const CpuCameraParams& rcCamParams, const CpuMap<float>& in_depthMap, const Vec2f& cell0, const Vec2f& offsetRoi)
+{
+    Vec2f out(0.0f, 180.0f);
+
+    // get pixel depth from the depth map
+    const float d0 = fetchNearest(in_depthMap, cell0.x(), cell0.y());
+
+    // early exit: depth is <= 0
+    if (d0 <= 0.0f)
+        return out;
+
+    // consider the neighbor pixels
+    const Vec2f cellL = cell0 + Vec2f(0.f, -1.f);  // Left
+    const Vec2f cellR = cell0 + Vec2f(0.f, 1.f);   // Right
+    const Vec2f cellU = cell0 + Vec2f(-1.f, 0.f);  // Up
+    const Vec2f cellB = cell0 + Vec2f(1.f, 0.f);   // Bottom
+
+    // get associated depths
+    const float dL = fetchNearest(in_depthMap, cellL.x(), cellL.y());
+    const float dR = fetchNearest(in_depthMap, cellR.x(), cellR.y());
+    const float dU = fetchNearest(in_depthMap, cellU.x(), cellU.y());
+    const float dB = fetchNearest(in_depthMap, cellB.x(), cellB.y());
+
+    // get associated 3D points
+    const Vec3f p0 = cpuGet3DPointForPixelAndDepth(rcCamParams, cell0 + offsetRoi, d0);
+    const Vec3f pL = cpuGet3DPointForPixelAndDepth(rcCamParams, cellL + offsetRoi, dL);
+    const Vec3f pR = cpuGet3DPointForPixelAndDepth(rcCamParams, cellR + offsetRoi, dR);
+    const Vec3f pU = cpuGet3DPointForPixelAndDepth(rcCamParams, cellU + offsetRoi, dU);
+    const Vec3f pB = cpuGet3DPointForPixelAndDepth(rcCamParams, cellB + offsetRoi, dB);
+
+    // compute the average point based on neighbors (cg)
+    Vec3f cg(0.0f, 0.0f, 0.0f);
+    float n = 0.0f;
+
+    if (dL > 0.0f) { cg += pL; n++; }
+    if (dR > 0.0f) { cg += pR; n++; }
+    if (dU > 0.0f) { cg += pU; n++; }
+    if (dB > 0.0f) { cg += pB; n++; }
+
+    if (n > 1.0f)
+    {
+        cg /= n;
+        const Vec3f vcn = (rcCamParams.C - p0).normalized();
+        // pS: projection of cg on the line from p0 to camera
+        const Vec3f pS = cpuClosestPointToLine3D(cg, p0, vcn);
+        // keep the depth difference between pS and p0 as the smoothing step
+        out.x() = (rcCamParams.C - pS).norm() - d0;
+    }
+
+    float e = 0.0f;
+    n = 0.0f;
+
+    if (dL > 0.0f && dR > 0.0f)
+    {
+        // large angle between neighbors == flat area => low energy
+        e = std::max(e, (180.0f - cpuAngleBetwABandAC(p0, pL, pR)));
+        n++;
+    }
+    if (dU > 0.0f && dB > 0.0f)
+    {
+        e = std::max(e, (180.0f - cpuAngleBetwABandAC(p0, pU, pB)));
+        n++;
+    }
+    // the higher the energy, the less flat the area
+    if (n > 0.0f)
+        out.y() = e;
+
+    return out;
+}
+
+}  // namespace
+
+void cpu_depthSimMapCopyDepthOnly(CpuMap<Vec2f>& out_depthSimMap, const CpuMap<Vec2f>& in_depthSimMap, float defaultSim)
+{
+    const int width = int(out_depthSimMap.width());
+    const int height = int(out_depthSimMap.height());
+
+#pragma omp parallel for
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+            out_depthSimMap(x, y) = Vec2f(in_depthSimMap(x, y).x(), defaultSim);
+    }
+}
+
+void cpu_normalMapUpscale(CpuMap<Vec3f>& out_upscaledMap, const CpuMap<Vec3f>& in_map, const ROI& roi)
+{
+    // compute upscale ratio
+    const float ratio = float(in_map.width()) / float(out_upscaledMap.width());
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+
+#pragma omp parallel for
+    for (int y = 0; y < roiHeight; ++y)
+    {
+        for (int x = 0; x < roiWidth; ++x)
+        {
+            const float ox = (float(x) - 0.5f) * ratio;
+            const float oy = (float(y) - 0.5f) * ratio;
+
+            // nearest neighbor, no interpolation
+            const int xp = std::min(int(std::floor(ox + 0.5)), int(roi.width() * ratio) - 1);
+            const int yp = std::min(int(std::floor(oy + 0.5)), int(roi.height() * ratio) - 1);
+
+            out_upscaledMap(x, y) = in_map(xp, yp);
+        }
+    }
+}
+
+void cpu_depthThicknessSmoothThickness(CpuMap<Vec2f>& inout_depthThicknessMap,
+                                       const SgmParams& sgmParams,
+                                       const RefineParams& refineParams,
+                                       const ROI& roi)
+{
+    const int sgmScaleStep = sgmParams.scale * sgmParams.stepXY;
+    const int refineScaleStep = refineParams.scale * refineParams.stepXY;
+
+    // min/max number of Refine samples in SGM thickness area
+    const float minNbRefineSamples = 2.f;
+    const float maxNbRefineSamples = std::max(sgmScaleStep / float(refineScaleStep), minNbRefineSamples);
+
+    // min/max SGM thickness inflate factor
+    const float minThicknessInflate = refineParams.halfNbDepths / maxNbRefineSamples;
+    const float maxThicknessInflate = refineParams.halfNbDepths / minNbRefineSamples;
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+
+    // the device implementation smooths in-place, read the neighbors from a copy to stay deterministic
+    const CpuMap<Vec2f> in_depthThicknessMap = inout_depthThicknessMap;
+
+#pragma omp parallel for
+    for (int roiY = 0; roiY < roiHeight; ++roiY)
+    {
+        for (int roiX = 0; roiX < roiWidth; ++roiX)
+        {
+            const Vec2f& in_depthThickness = in_depthThicknessMap(roiX, roiY);
+
+            // depth invalid or masked
+            if (in_depthThickness.x() <= 0.0f)
+                continue;
+
+            const float minThickness = minThicknessInflate * in_depthThickness.y();
+            const float maxThickness = maxThicknessInflate * in_depthThickness.y();
+
+            // compute average depth distance to the center pixel
+            float sumCenterDepthDist = 0.f;
+            int nbValidPatchPixels = 0;
+
+            // patch 3x3
+            for (int yp = -1; yp <= 1; ++yp)
+            {
+                for (int xp = -1; xp <= 1; ++xp)
+                {
+                    const int roiXp = roiX + xp;
+                    const int roiYp = roiY + yp;
+
+                    if ((xp == 0 && yp == 0) ||                  // avoid pixel center
+                        roiXp < 0 || roiXp >= roiWidth ||        // avoid pixel outside the ROI
+                        roiYp < 0 || roiYp >= roiHeight)         // avoid pixel outside the ROI
+                    {
+                        continue;
+                    }
+
+                    const Vec2f& in_depthThicknessPatch = in_depthThicknessMap(roiXp, roiYp);
+
+                    // patch depth valid
+                    if (in_depthThicknessPatch.x() > 0.0f)
+                    {
+                        const float depthDistance = std::abs(in_depthThickness.x() - in_depthThicknessPatch.x());
+                        sumCenterDepthDist += std::max(minThickness, std::min(maxThickness, depthDistance));
+                        ++nbValidPatchPixels;
+                    }
+                }
+            }
+
+            // we require at least 3 valid patch pixels (over 8)
+            if (nbValidPatchPixels < 3)
+                continue;
+
+            inout_depthThicknessMap(roiX, roiY).y() = sumCenterDepthDist / nbValidPatchPixels;
+        }
+    }
+}
+
+void cpu_computeSgmUpscaledDepthPixSizeMap(CpuMap<Vec2f>& out_upscaledDepthPixSizeMap,
+                                           const CpuMap<Vec2f>& in_sgmDepthThicknessMap,
+                                           const CpuMipmapImage& rcMipmapImage,
+                                           const RefineParams& refineParams,
+                                           const ROI& roi)
+{
+    // compute upscale ratio
+    const float ratio = float(in_sgmDepthThicknessMap.width()) / float(out_upscaledDepthPixSizeMap.width());
+
+    // get R mipmap image level and dimensions
+    const float rcMipmapLevel = rcMipmapImage.getLevel(refineParams.scale);
+    const float rcInvLevelWidth = 1.f / float(rcMipmapImage.getWidth(refineParams.scale));
+    const float rcInvLevelHeight = 1.f / float(rcMipmapImage.getHeight(refineParams.scale));
+
+    const int halfNbDepths = refineParams.halfNbDepths;
+    const bool interpolateMiddleDepth = refineParams.interpolateMiddleDepth;
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+
+#pragma omp parallel for
+    for (int roiY = 0; roiY < roiHeight; ++roiY)
+    {
+        for (int roiX = 0; roiX < roiWidth; ++roiX)
+        {
+            // corresponding image coordinates
+            const float x = float((roi.x.begin + roiX) * refineParams.stepXY);
+            const float y = float((roi.y.begin + roiY) * refineParams.stepXY);
+
+            Vec2f& out_depthPixSize = out_upscaledDepthPixSizeMap(roiX, roiY);
+
+            // filter masked pixels with alpha
+            // note: the device nearest neighbor kernel compares with 0.9 in range (0, 255), kept as is
+            const float alpha = rcMipmapImage.sample((x + 0.5f) * rcInvLevelWidth, (y + 0.5f) * rcInvLevelHeight, rcMipmapLevel).w;
+            if (alpha < (interpolateMiddleDepth ? ALICEVISION_DEPTHMAP_CPU_RC_MIN_ALPHA : 0.9f))
+            {
+                out_depthPixSize = Vec2f(-2.f, 0.f);
+                continue;
+            }
+
+            const float ox = (float(roiX) - 0.5f) * ratio;
+            const float oy = (float(roiY) - 0.5f) * ratio;
+
+            Vec2f out_depthThickness;
+
+            if (interpolateMiddleDepth)
+            {
+                // find adjacent pixels
+                const int xp = std::min(int(std::floor(ox)), int(roi.width() * ratio) - 2);
+                const int yp = std::min(int(std::floor(oy)), int(roi.height() * ratio) - 2);
+
+                const Vec2f& lu = in_sgmDepthThicknessMap(xp, yp);
+                const Vec2f& ru = in_sgmDepthThicknessMap(xp + 1, yp);
+                const Vec2f& rd = in_sgmDepthThicknessMap(xp + 1, yp + 1);
+                const Vec2f& ld = in_sgmDepthThicknessMap(xp, yp + 1);
+
+                if (lu.x() <= 0.0f || ru.x() <= 0.0f || rd.x() <= 0.0f || ld.x() <= 0.0f)
+                {
+                    // at least one corner depth is invalid
+                    // average the other corners to get a proper depth/thickness
+                    Vec2f sumDepthThickness(0.0f, 0.0f);
+                    int count = 0;
+
+                    for (const Vec2f* corner : {&lu, &ru, &rd, &ld})
+                    {
+                        if (corner->x() > 0.0f)
+                        {
+                            sumDepthThickness += *corner;
+                            ++count;
+                        }
+                    }
+
+                    if (count == 0)
+                    {
+                        out_depthPixSize = Vec2f(-1.0f, 1.0f);  // invalid depth
+                        continue;
+                    }
+
+                    out_depthThickness = sumDepthThickness / float(count);
+                }
+                else
+                {
+                    // bilinear interpolation
+                    const float ui = ox - float(xp);
+                    const float vi = oy - float(yp);
+                    const Vec2f u = lu + (ru - lu) * ui;
+                    const Vec2f d = ld + (rd - ld) * ui;
+                    out_depthThickness = u + (d - u) * vi;
+                }
+            }
+            else
+            {
+                // nearest neighbor, no interpolation
+                const int xp = std::min(int(std::floor(ox + 0.5)), int(roi.width() * ratio) - 1);
+                const int yp = std::min(int(std::floor(oy + 0.5)), int(roi.height() * ratio) - 1);
+
+                out_depthThickness = in_sgmDepthThicknessMap(xp, yp);
+            }
+
+            // compute pixSize from depth thickness
+            out_depthPixSize = Vec2f(out_depthThickness.x(), out_depthThickness.y() / halfNbDepths);
+        }
+    }
+}
+
+void cpu_depthSimMapComputeNormal(CpuMap<Vec3f>& out_normalMap,
+                                  const CpuMap<Vec2f>& in_depthSimMap,
+                                  const CpuCameraParams& rcCamParams,
+                                  int stepXY,
+                                  const ROI& roi)
+{
+    constexpr int wsh = 3;
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+    const int mapWidth = int(in_depthSimMap.width());
+    const int mapHeight = int(in_depthSimMap.height());
+
+#pragma omp parallel for
+    for (int roiY = 0; roiY < roiHeight; ++roiY)
+    {
+        for (int roiX = 0; roiX < roiWidth; ++roiX)
+        {
+            // corresponding image coordinates
+            const int x = (roi.x.begin + roiX) * stepXY;
+            const int y = (roi.y.begin + roiY) * stepXY;
+
+            const float in_depth = in_depthSimMap(roiX, roiY).x();
+            Vec3f& out_normal = out_normalMap(roiX, roiY);
+
+            // no depth
+            if (in_depth <= 0.0f)
+            {
+                out_normal = Vec3f(-1.f, -1.f, -1.f);
+                continue;
+            }
+
+            const Vec3f p = cpuGet3DPointForPixelAndDepth(rcCamParams, Vec2f(float(x), float(y)), in_depth);
+            const float pixSize = (p - cpuGet3DPointForPixelAndDepth(rcCamParams, Vec2f(float(x + 1), float(y)), in_depth)).norm();
+
+            // point statistics (double precision, same as device cuda_stat3d)
+            Eigen::Vector3d sum = Eigen::Vector3d::Zero();
+            Eigen::Matrix3d sumSq = Eigen::Matrix3d::Zero();
+            double count = 0.0;
+
+            for (int yp = -wsh; yp <= wsh; ++yp)
+            {
+                const int roiYp = roiY + yp;
+                if (roiYp < 0 || roiYp >= mapHeight)
+                    continue;
+
+                for (int xp = -wsh; xp <= wsh; ++xp)
+                {
+                    const int roiXp = roiX + xp;
+                    if (roiXp < 0 || roiXp >= mapWidth)
+                        continue;
+
+                    const float depthP = in_depthSimMap(roiXp, roiYp).x();
+
+                    if ((depthP > 0.0f) && (std::abs(depthP - in_depth) < 30.0f * pixSize))
+                    {
+                        const Vec3f pP = cpuGet3DPointForPixelAndDepth(rcCamParams, Vec2f(float(x + xp), float(y + yp)), depthP);
+                        const Eigen::Vector3d pd = pP.cast<double>();
+                        sum += pd;
+                        sumSq += pd * pd.transpose();
+                        count += 1.0;
+                    }
+                }
+            }
+
+            if (count < 3.0)
+            {
+                out_normal = Vec3f(-1.f, -1.f, -1.f);
+                continue;
+            }
+
+            // covariance matrix, normal is the eigen vector of the smallest eigen value
+            const Eigen::Vector3d mean = sum / count;
+            const Eigen::Matrix3d A = (sumSq - sum * mean.transpose() - mean * sum.transpose() + mean * mean.transpose() * count) / count;
+            const Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(A);
+
+            Vec3f nn = solver.eigenvectors().col(0).cast<float>().normalized();
+
+            // orient the normal toward the camera
+            const Vec3f nc = (rcCamParams.C - p).normalized();
+            if (nn.dot(nc) < 0.0f)
+                nn = -nn;
+
+            out_normal = nn;
+        }
+    }
+}
+
+void cpu_depthSimMapOptimizeGradientDescent(CpuMap<Vec2f>& out_optimizeDepthSimMap,
+                                            CpuMap<float>& inout_imgVariance,
+                                            CpuMap<float>& inout_tmpOptDepthMap,
+                                            const CpuMap<Vec2f>& in_sgmDepthPixSizeMap,
+                                            const CpuMap<Vec2f>& in_refineDepthSimMap,
+                                            const CpuCameraParams& rcCamParams,
+                                            const CpuMipmapImage& rcMipmapImage,
+                                            const RefineParams& refineParams,
+                                            const ROI& roi)
+{
+    // get R mipmap image level and dimensions
+    const float rcMipmapLevel = rcMipmapImage.getLevel(refineParams.scale);
+    const float invLevelWidth = 1.f / float(rcMipmapImage.getWidth(refineParams.scale));
+    const float invLevelHeight = 1.f / float(rcMipmapImage.getHeight(refineParams.scale));
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+    const Vec2f offsetRoi(float(roi.x.begin), float(roi.y.begin));
+
+    // initialize depth/sim map optimized with SGM depth/pixSize map
+    out_optimizeDepthSimMap = in_sgmDepthPixSizeMap;
+
+    // compute the image gradient size of L
+#pragma omp parallel for
+    for (int roiY = 0; roiY < roiHeight; ++roiY)
+    {
+        for (int roiX = 0; roiX < roiWidth; ++roiX)
+        {
+            const float x = float(roi.x.begin + roiX) * float(refineParams.stepXY);
+            const float y = float(roi.y.begin + roiY) * float(refineParams.stepXY);
+
+            const float xM1 = rcMipmapImage.sample(((x - 1.f) + 0.5f) * invLevelWidth, (y + 0.5f) * invLevelHeight, rcMipmapLevel).x;
+            const float xP1 = rcMipmapImage.sample(((x + 1.f) + 0.5f) * invLevelWidth, (y + 0.5f) * invLevelHeight, rcMipmapLevel).x;
+            const float yM1 = rcMipmapImage.sample((x + 0.5f) * invLevelWidth, ((y - 1.f) + 0.5f) * invLevelHeight, rcMipmapLevel).x;
+            const float yP1 = rcMipmapImage.sample((x + 0.5f) * invLevelWidth, ((y + 1.f) + 0.5f) * invLevelHeight, rcMipmapLevel).x;
+
+            inout_imgVariance(roiX, roiY) = Vec2f(xM1 - xP1, yM1 - yP1).norm();
+        }
+    }
+
+    for (int iter = 0; iter < refineParams.optimizationNbIterations; ++iter)  // default nb iterations is 100
+    {
+        // copy depths values from the optimized depth/sim map to the temporary depth map
+#pragma omp parallel for
+        for (int roiY = 0; roiY < roiHeight; ++roiY)
+        {
+            for (int roiX = 0; roiX < roiWidth; ++roiX)
+                inout_tmpOptDepthMap(roiX, roiY) = out_optimizeDepthSimMap(roiX, roiY).x();
+        }
+
+        // adjust depth/sim by using previously computed depths
+#pragma omp parallel for
+        for (int roiY = 0; roiY < roiHeight; ++roiY)
+        {
+            for (int roiX = 0; roiX < roiWidth; ++roiX)
+            {
+                // SGM upscale (rough) depth/pixSize
+                const Vec2f& sgmDepthPixSize = in_sgmDepthPixSizeMap(roiX, roiY);
+                const float sgmDepth = sgmDepthPixSize.x();
+                const float sgmPixSize = sgmDepthPixSize.y();
+
+                // refined and fused (fine) depth/sim
+                const Vec2f& refineDepthSim = in_refineDepthSimMap(roiX, roiY);
+                const float refineDepth = refineDepthSim.x();
+                const float refineSim = refineDepthSim.y();
+
+                // output optimized depth/sim
+                Vec2f& out_optDepthSimRef = out_optimizeDepthSimMap(roiX, roiY);
+                Vec2f out_optDepthSim = (iter == 0) ? Vec2f(sgmDepth, refineSim) : out_optDepthSimRef;
+                const float depthOpt = out_optDepthSim.x();
+
+                if (depthOpt > 0.0f)
+                {
+                    const Vec2f depthSmoothStepEnergy =
+                      getCellSmoothStepEnergy(rcCamParams, inout_tmpOptDepthMap, Vec2f(float(roiX), float(roiY)), offsetRoi);  // (smoothStep, energy)
+
+                    float stepToSmoothDepth = depthSmoothStepEnergy.x();
+                    stepToSmoothDepth = std::copysign(std::min(std::abs(stepToSmoothDepth), sgmPixSize / 10.0f), stepToSmoothDepth);
+                    const float depthEnergy = depthSmoothStepEnergy.y();  // max angle with neighbors
+                    float stepToFineDM = refineDepth - depthOpt;         // distance to refined/noisy input depth map
+                    stepToFineDM = std::copysign(std::min(std::abs(stepToFineDM), sgmPixSize / 10.0f), stepToFineDM);
+
+                    const float stepToRoughDM = sgmDepth - depthOpt;  // distance to smooth/robust input depth map
+                    const float imgColorVariance = inout_imgVariance(roiX, roiY);
+                    const float colorVarianceThresholdForSmoothing = 20.0f;
+                    const float angleThresholdForSmoothing = 30.0f;
+
+                    const float weightedColorVariance =
+                      cpuSigmoid2(5.0f, angleThresholdForSmoothing, 40.0f, colorVarianceThresholdForSmoothing, imgColorVariance);
+                    const float fineSimWeight = cpuSigmoid(0.0f, 1.0f, 0.7f, -0.7f, refineSim);
+                    const float energyLowerThanVarianceWeight = cpuSigmoid(0.0f, 1.0f, 30.0f, weightedColorVariance, depthEnergy);
+                    const float closeToRoughWeight = 1.0f - cpuSigmoid(0.0f, 1.0f, 10.0f, 17.0f, std::abs(stepToRoughDM / sgmPixSize));
+
+                    const float depthOptStep = closeToRoughWeight * stepToRoughDM +
+                                               (1.0f - closeToRoughWeight) * (energyLowerThanVarianceWeight * fineSimWeight * stepToFineDM +
+                                                                              (1.0f - energyLowerThanVarianceWeight) * stepToSmoothDepth);
+
+                    out_optDepthSim.x() = depthOpt + depthOptStep;
+                    out_optDepthSim.y() = (1.0f - closeToRoughWeight) * (energyLowerThanVarianceWeight * fineSimWeight * refineSim +
+                                                                         (1.0f - energyLowerThanVarianceWeight) * (depthEnergy / 20.0f));
+                }
+
+                out_optDepthSimRef = out_optDepthSim;
+            }
+        }
+    }
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,175 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "cpuMapIO.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/mvsUtils/fileIO.hpp>
+#include <aliceVision/mvsUtils/mapIO.hpp>
+
+namespace aliceVision {
+namespace depthMap {
+
+void copyFloat2Map(image::Image<float>& out_mapX, image::Image<float>& out_mapY, const CpuMap<Vec2f>& in_map, const ROI& roi, int downscale)
+{
+    const ROI downscaledROI = downscaleROI(roi, downscale);
+    const int width = int(downscaledROI.width());
+    const int height = int(downscaledROI.height());
+
+    // resize output images
+    out_mapX.resize(width, height);
+    out_mapY.resize(width, height);
+
+    // copy map from host memory to output images
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const Vec2f& value = in_map(size_t(x), size_t(y));
+            out_mapX(y, x) = value.x();
+            out_mapY(y, x) = value.y();
+        }
+    }
+}
+
+void writeFloat2Map(int rc,
+                    const mvsUtils::MultiViewParams& mp,
+                    const mvsUtils::TileParams& tileParams,
+                    const ROI& roi,
+                    const CpuMap<Vec2f>& in_map,
+                    const mvsUtils::EFileType fileTypeX,
+                    const mvsUtils::EFileType fileTypeY,
+                    int scale,
+                    int step,
+                    const std::string& name)
+{
+    const std::string customSuffix = (name.empty()) ? "" : "_" + name;
+    const int scaleStep = scale * step;
+
+    image::Image<float> mapX;
+    image::Image<float> mapY;
+
+    copyFloat2Map(mapX, mapY, in_map, roi, scaleStep);
+
+    mvsUtils::writeMap(rc, mp, fileTypeX, tileParams, roi, mapX, scale, step, customSuffix);
+    mvsUtils::writeMap(rc, mp, fileTypeY, tileParams, roi, mapY, scale, step, customSuffix);
+}
+
+void writeFloat3Map(int rc,
+                    const mvsUtils::MultiViewParams& mp,
+                    const mvsUtils::TileParams& tileParams,
+                    const ROI& roi,
+                    const CpuMap<Vec3f>& in_map,
+                    const mvsUtils::EFileType fileType,
+                    int scale,
+                    int step,
+                    const std::string& name)
+{
+    const ROI downscaledROI = downscaleROI(roi, scale * step);
+    const int width = int(downscaledROI.width());
+    const int height = int(downscaledROI.height());
+
+    // copy map from host memory to an Image
+    image::Image<image::RGBfColor> map(width, height, true, {0.f, 0.f, 0.f});
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const Vec3f& value = in_map(size_t(x), size_t(y));
+            map(y, x) = image::RGBfColor(value.x(), value.y(), value.z());
+        }
+    }
+
+    // write map from the image buffer
+    mvsUtils::writeMap(rc, mp, fileType, tileParams, roi, map, scale, step, (name.empty()) ? "" : "_" + name);
+}
+
+void writeDepthSimMapFromTileList(int rc,
+                                  const mvsUtils::MultiViewParams& mp,
+                                  const mvsUtils::TileParams& tileParams,
+                                  const std::vector<ROI>& tileRoiList,
+                                  const std::vector<CpuMap<Vec2f>>& in_depthSimMapTiles,
+                                  int scale,
+                                  int step,
+                                  const std::string& name)
+{
+    ALICEVISION_LOG_TRACE("Merge and write depth/similarity map tiles (rc: " << rc << ", view id: " << mp.getViewId(rc) << ").");
+
+    const std::string customSuffix = (name.empty()) ? "" : "_" + name;
+
+    const ROI imageRoi(Range(0, mp.getWidth(rc)), Range(0, mp.getHeight(rc)));
+
+    const int scaleStep = scale * step;
+    const int width = divideRoundUp(mp.getWidth(rc), scaleStep);
+    const int height = divideRoundUp(mp.getHeight(rc), scaleStep);
+
+    image::Image<float> depthMap(width, height, true, 0.0f);  // map should be initialize, additive process
+    image::Image<float> simMap(width, height, true, 0.0f);    // map should be initialize, additive process
+
+    for (size_t i = 0; i < tileRoiList.size(); ++i)
+    {
+        const ROI roi = intersect(tileRoiList.at(i), imageRoi);
+
+        if (roi.isEmpty())
+            continue;
+
+        image::Image<float> tileDepthMap;
+        image::Image<float> tileSimMap;
+
+        // copy tile depth/sim map from host memory
+        copyFloat2Map(tileDepthMap, tileSimMap, in_depthSimMapTiles.at(i), roi, scaleStep);
+
+        // add tile maps to the full-size maps with weighting
+        mvsUtils::addTileMapWeighted(rc, mp, tileParams, roi, scaleStep, tileDepthMap, depthMap);
+        mvsUtils::addTileMapWeighted(rc, mp, tileParams, roi, scaleStep, tileSimMap, simMap);
+    }
+
+    // write fullsize maps on disk
+    mvsUtils::writeMap(rc, mp, mvsUtils::EFileType::depthMap, depthMap, scale, step, customSuffix);  // write the merged depth map
+    mvsUtils::writeMap(rc, mp, mvsUtils::EFileType::simMap, simMap, scale, step, customSuffix);      // write the merged similarity map
+}
+
+void resetDepthSimMap(CpuMap<Vec2f>& inout_depthSimMap, float depth, float sim) { inout_depthSimMap.fill(Vec2f(depth, sim)); }
+
+void writeNormalMap(int rc,
+                    const mvsUtils::MultiViewParams& mp,
+                    const mvsUtils::TileParams& tileParams,
+                    const ROI& roi,
+                    const CpuMap<Vec3f>& in_normalMap,
+                    int scale,
+                    int step,
+                    const std::string& name)
+{
+    writeFloat3Map(rc, mp, tileParams, roi, in_normalMap, mvsUtils::EFileType::normalMap, scale, step, name);
+}
+
+void writeDepthPixSizeMap(int rc,
+                          const mvsUtils::MultiViewParams& mp,
+                          const mvsUtils::TileParams& tileParams,
+                          const ROI& roi,
+                          const CpuMap<Vec2f>& in_depthPixSizeMap,
+                          int scale,
+                          int step,
+                          const std::string& name)
+{
+    writeFloat2Map(rc, mp, tileParams, roi, in_depthPixSizeMap, mvsUtils::EFileType::depthMap, mvsUtils::EFileType::pixSizeMap, scale, step, name);
+}
+
+void writeDepthSimMap(int rc,
+                      const mvsUtils::MultiViewParams& mp,
+                      const mvsUtils::TileParams& tileParams,
+                      const ROI& roi,
+                      const CpuMap<Vec2f>& in_depthSimMap,
+                      int scale,
+                      int step,
+                      const std::string& name)
+{
+    writeFloat2Map(rc, mp, tileParams, roi, in_depthSimMap, mvsUtils::EFileType::depthMap, mvsUtils::EFileType::simMap, scale, step, name);
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
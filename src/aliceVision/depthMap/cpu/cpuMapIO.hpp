@@ -0,0 +1,110 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/ROI.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/TileParams.hpp>
+#include <aliceVision/depthMap/cpu/CpuBuffer.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <vector>
+#include <string>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief Write a normal map (depth map estimation) on disk from host memory (CPU backend).
+ * @param[in] rc the related R camera index
+ * @param[in] mp the multi-view parameters
+ * @param[in] tileParams tile workflow parameters
+ * @param[in] roi the 2d region of interest without any downscale apply
+ * @param[in] in_normalMap the normal map in host memory
+ * @param[in] scale the map downscale factor
+ * @param[in] step the map step factor
+ * @param[in] name the export filename suffix
+ */
+void writeNormalMap(int rc,
+                    const mvsUtils::MultiViewParams& mp,
+                    const mvsUtils::TileParams& tileParams,
+                    const ROI& roi,
+                    const CpuMap<Vec3f>& in_normalMap,
+                    int scale,
+                    int step,
+                    const std::string& name = "");
+
+/**
+ * @brief Write a depth/pixSize map on disk from host memory (CPU backend).
+ * @param[in] rc the related R camera index
+ * @param[in] mp the multi-view parameters
+ * @param[in] tileParams tile workflow parameters
+ * @param[in] roi the 2d region of interest without any downscale apply
+ * @param[in] in_depthPixSizeMap the depth/pixSize map in host memory
+ * @param[in] scale the depth/pixSize map downscale factor
+ * @param[in] step the depth/pixSize map step factor
+ * @param[in] name the export filename suffix
+ */
+void writeDepthPixSizeMap(int rc,
+                          const mvsUtils::MultiViewParams& mp,
+                          const mvsUtils::TileParams& tileParams,
+                          const ROI& roi,
+                          const CpuMap<Vec2f>& in_depthPixSizeMap,
+                          int scale,
+                          int step,
+                          const std::string& name = "");
+
+/**
+ * @brief Write a depth/similarity map on disk from host memory (CPU backend).
+ * @param[in] rc the related R camera index
+ * @param[in] mp the multi-view parameters
+ * @param[in] tileParams tile workflow parameters
+ * @param[in] roi the 2d region of interest without any downscale apply
+ * @param[in] in_depthSimMap the depth/similarity map in host memory
+ * @param[in] scale the depth/similarity map downscale factor
+ * @param[in] step the depth/similarity map step factor
+ * @param[in] name the export filename suffix
+ */
+void writeDepthSimMap(int rc,
+                      const mvsUtils::MultiViewParams& mp,
+                      const mvsUtils::TileParams& tileParams,
+                      const ROI& roi,
+                      const CpuMap<Vec2f>& in_depthSimMap,
+                      int scale,
+                      int step,
+                      const std::string& name = "");
+
+/**
+ * @brief Write a depth/similarity map on disk from a tile list in host memory (CPU backend).
+ * @param[in] rc the related R camera index
+ * @param[in] mp the multi-view parameters
+ * @param[in] tileParams tile workflow parameters
+ * @param[in] tileRoiList the 2d region of interest of each tile
+ * @param[in] in_depthSimMapTiles the depth/similarity map tile list in host memory
+ * @param[in] scale the depth/similarity map downscale factor
+ * @param[in] step the depth/similarity map step factor
+ * @param[in] name the export filename suffix
+ */
+void writeDepthSimMapFromTileList(int rc,
+                                  const mvsUtils::MultiViewParams& mp,
+                                  const mvsUtils::TileParams& tileParams,
+                                  const std::vector<ROI>& tileRoiList,
+                                  const std::vector<CpuMap<Vec2f>>& in_depthSimMapTiles,
+                                  int scale,
+                                  int step,
+                                  const std::string& name = "");
+
+/**
+ * @brief Reset a depth/similarity map in host memory (CPU backend) to the given default depth and similarity.
+ * @param[in,out] inout_depthSimMap the depth/similarity map in host memory
+ * @param[in] depth the depth reset value
+ * @param[in] sim the sim reset value
+ */
+void resetDepthSimMap(CpuMap<Vec2f>& inout_depthSimMap, float depth = -1.f, float sim = 1.f);
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,262 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/depthMap/cpu/CpuCameraParams.hpp>
+#include <aliceVision/depthMap/cpu/CpuMipmapImage.hpp>
+
+#include <cmath>
+#include <limits>
+
+// minimum alpha of the patch center pixel, texture range (0, 255), same as the device implementation
+#define ALICEVISION_DEPTHMAP_CPU_RC_MIN_ALPHA (255.f * 0.9f)
+#define ALICEVISION_DEPTHMAP_CPU_TC_MIN_ALPHA (255.f * 0.4f)
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @struct CpuPatch
+ * @brief Oriented patch in host memory, same as the device Patch.
+ */
+struct CpuPatch
+{
+    Vec3f p;  //< 3d point
+    Vec3f n;  //< normal
+    Vec3f x;  //< x axis
+    Vec3f y;  //< y axis
+    float d;  //< pixel size
+};
+
+/**
+ * @brief Sigmoid function filtering.
+ */
+inline float cpuSigmoid(float zeroVal, float endVal, float sigwidth, float sigMid, float xval)
+{
+    return zeroVal + (endVal - zeroVal) * (1.0f / (1.0f + std::exp(10.0f * ((xval - sigMid) / sigwidth))));
+}
+
+/**
+ * @brief Sigmoid function filtering (inverted).
+ */
+inline float cpuSigmoid2(float zeroVal, float endVal, float sigwidth, float sigMid, float xval)
+{
+    return zeroVal + (endVal - zeroVal) * (1.0f / (1.0f + std::exp(10.0f * ((sigMid - xval) / sigwidth))));
+}
+
+/**
+ * @brief Euclidean distance between two CIELAB colors (alpha is ignored).
+ */
+inline float cpuColorDistance(const CpuColor& c1, const CpuColor& c2)
+{
+    const float dx = c1.x - c2.x;
+    const float dy = c1.y - c2.y;
+    const float dz = c1.z - c2.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/**
+ * @brief Compute the patch axes from the epipolar plane of the R and T cameras.
+ */
+inline void cpuComputeRotCSEpip(CpuPatch& patch, const CpuCameraParams& rcCamParams, const CpuCameraParams& tcCamParams)
+{
+    const Vec3f v1 = (rcCamParams.C - patch.p).normalized();
+    const Vec3f v2 = (tcCamParams.C - patch.p).normalized();
+
+    // y has to be ortogonal to the epipolar plane
+    // n has to be on the epipolar plane
+    // x has to be on the epipolar plane
+    patch.y = v1.cross(v2).normalized();
+    patch.n = ((v1 + v2) / 2.0f).normalized();
+    patch.x = patch.y.cross(patch.n).normalized();
+}
+
+/**
+ * @brief Compute the R and T mipmap image levels for a consistent scale patch comparison.
+ */
+inline void cpuComputeRcTcMipmapLevels(float& out_rcMipmapLevel,
+                                       float& out_tcMipmapLevel,
+                                       float mipmapLevel,
+                                       const CpuCameraParams& rcCamParams,
+                                       const CpuCameraParams& tcCamParams,
+                                       const Vec2f& rp0,
+                                       const Vec2f& tp0,
+                                       const Vec3f& p0)
+{
+    const float rcDepth = (rcCamParams.C - p0).norm();
+    const float tcDepth = (tcCamParams.C - p0).norm();
+
+    const Vec3f prp1 = cpuGet3DPointForPixelAndDepth(rcCamParams, rp0 + Vec2f(1.f, 0.f), rcDepth);
+    const Vec3f ptp1 = cpuGet3DPointForPixelAndDepth(tcCamParams, tp0 + Vec2f(1.f, 0.f), tcDepth);
+
+    const float distFactor = (p0 - prp1).norm() / (p0 - ptp1).norm();
+
+    if (distFactor < 1.f)
+    {
+        // T camera has a lower resolution (1 Rc pixSize < 1 Tc pixSize)
+        out_tcMipmapLevel = mipmapLevel - std::log2(1.f / distFactor);
+
+        if (out_tcMipmapLevel < 0.f)
+        {
+            out_rcMipmapLevel = mipmapLevel + std::abs(out_tcMipmapLevel);
+            out_tcMipmapLevel = 0.f;
+        }
+    }
+    else
+    {
+        // T camera has a higher resolution (1 Rc pixSize > 1 Tc pixSize)
+        out_rcMipmapLevel = mipmapLevel;
+        out_tcMipmapLevel = mipmapLevel + std::log2(distFactor);
+    }
+}
+
+/**
+ * @brief Compute Normalized Cross-Correlation of a full square patch at given half-width.
+ * @note Same computation as the device compNCCby3DptsYK.
+ *       The accumulation over a patch row is written as a reduction loop so it can be vectorized.
+ *
+ * @tparam TInvertAndFilter invert and filter output similarity value
+ *
+ * @param[in] rcCamParams the R camera parameters
+ * @param[in] tcCamParams the T camera parameters
+ * @param[in] rcMipmapImage the R mipmap image
+ * @param[in] tcMipmapImage the T mipmap image
+ * @param[in] rcLevelWidth the R mipmap image level width
+ * @param[in] rcLevelHeight the R mipmap image level height
+ * @param[in] tcLevelWidth the T mipmap image level width
+ * @param[in] tcLevelHeight the T mipmap image level height
+ * @param[in] mipmapLevel the workflow current mipmap image level
+ * @param[in] wsh the half-width of the patch
+ * @param[in] invGammaC the inverted strength of grouping by color similarity
+ * @param[in] invGammaP the inverted strength of grouping by proximity
+ * @param[in] useConsistentScale enable consistent scale patch comparison
+ * @param[in] patch the input patch struct
+ *
+ * @return similarity value in range (-1.f, 0.f) or (0.f, 1.f) if TinvertAndFilter enabled
+ *         special cases:
+ *          -> infinite similarity value: 1
+ *          -> invalid/uninitialized/masked similarity: infinity
+ */
+template<bool TInvertAndFilter>
+inline float cpuCompNCCby3DptsYK(const CpuCameraParams& rcCamParams,
+                                 const CpuCameraParams& tcCamParams,
+                                 const CpuMipmapImage& rcMipmapImage,
+                                 const CpuMipmapImage& tcMipmapImage,
+                                 unsigned int rcLevelWidth,
+                                 unsigned int rcLevelHeight,
+                                 unsigned int tcLevelWidth,
+                                 unsigned int tcLevelHeight,
+                                 float mipmapLevel,
+                                 int wsh,
+                                 float invGammaC,
+                                 float invGammaP,
+                                 bool useConsistentScale,
+                                 const CpuPatch& patch)
+{
+    // get R and T image 2d coordinates from patch center 3d point
+    const Vec2f rp = cpuProject3DPoint(rcCamParams, patch.p);
+    const Vec2f tp = cpuProject3DPoint(tcCamParams, patch.p);
+
+    // image 2d coordinates margin
+    const float dd = wsh + 2.0f;
+
+    // check R and T image 2d coordinates
+    if ((rp.x() < dd) || (rp.x() > float(rcLevelWidth - 1) - dd) || (tp.x() < dd) || (tp.x() > float(tcLevelWidth - 1) - dd) ||
+        (rp.y() < dd) || (rp.y() > float(rcLevelHeight - 1) - dd) || (tp.y() < dd) || (tp.y() > float(tcLevelHeight - 1) - dd))
+    {
+        return std::numeric_limits<float>::infinity();  // uninitialized
+    }
+
+    // compute inverse width / height
+    // note: useful to compute normalized coordinates
+    const float rcInvLevelWidth = 1.f / float(rcLevelWidth);
+    const float rcInvLevelHeight = 1.f / float(rcLevelHeight);
+    const float tcInvLevelWidth = 1.f / float(tcLevelWidth);
+    const float tcInvLevelHeight = 1.f / float(tcLevelHeight);
+
+    // initialize R and T mipmap image level at the given mipmap image level
+    float rcMipmapLevel = mipmapLevel;
+    float tcMipmapLevel = mipmapLevel;
+
+    // update R and T mipmap image level in order to get consistent scale patch comparison
+    if (useConsistentScale)
+        cpuComputeRcTcMipmapLevels(rcMipmapLevel, tcMipmapLevel, mipmapLevel, rcCamParams, tcCamParams, rp, tp, patch.p);
+
+    // compute patch center color (CIELAB) at R and T mipmap image level
+    const CpuColor rcCenterColor = rcMipmapImage.sample((rp.x() + 0.5f) * rcInvLevelWidth, (rp.y() + 0.5f) * rcInvLevelHeight, rcMipmapLevel);
+    const CpuColor tcCenterColor = tcMipmapImage.sample((tp.x() + 0.5f) * tcInvLevelWidth, (tp.y() + 0.5f) * tcInvLevelHeight, tcMipmapLevel);
+
+    // check the alpha values of the patch pixel center of the R and T cameras
+    if (rcCenterColor.w < ALICEVISION_DEPTHMAP_CPU_RC_MIN_ALPHA || tcCenterColor.w < ALICEVISION_DEPTHMAP_CPU_TC_MIN_ALPHA)
+        return std::numeric_limits<float>::infinity();  // masked
+
+    // weighted statistics of the patch (same as device simStat)
+    float xsum = 0.f;
+    float ysum = 0.f;
+    float xxsum = 0.f;
+    float yysum = 0.f;
+    float xysum = 0.f;
+    float wsum = 0.f;
+
+    // compute patch (wsh*2+1)x(wsh*2+1)
+    for (int yp = -wsh; yp <= wsh; ++yp)
+    {
+        // 3d point of the first pixel of the patch row, then step along the patch x axis
+        const Vec3f rowOrigin = patch.p + patch.y * float(patch.d * float(yp));
+        const Vec3f xStep = patch.x * patch.d;
+
+#pragma omp simd reduction(+ : xsum, ysum, xxsum, yysum, xysum, wsum)
+        for (int xp = -wsh; xp <= wsh; ++xp)
+        {
+            // get 3d point
+            const Vec3f p = rowOrigin + xStep * float(xp);
+
+            // get R and T image 2d coordinates from 3d point
+            const Vec2f rpc = cpuProject3DPoint(rcCamParams, p);
+            const Vec2f tpc = cpuProject3DPoint(tcCamParams, p);
+
+            // get R and T image color (CIELAB) from 2d coordinates
+            const CpuColor rcColor = rcMipmapImage.sample((rpc.x() + 0.5f) * rcInvLevelWidth, (rpc.y() + 0.5f) * rcInvLevelHeight, rcMipmapLevel);
+            const CpuColor tcColor = tcMipmapImage.sample((tpc.x() + 0.5f) * tcInvLevelWidth, (tpc.y() + 0.5f) * tcInvLevelHeight, tcMipmapLevel);
+
+            // Yoon & Kweon adaptive support-weight, based on color difference and distance to the patch center
+            const float deltaP = std::sqrt(float(xp * xp + yp * yp)) * invGammaP;
+            const float w = std::exp(-(cpuColorDistance(rcCenterColor, rcColor) * invGammaC + deltaP)) *
+                            std::exp(-(cpuColorDistance(tcCenterColor, tcColor) * invGammaC + deltaP));
+
+            const float x = rcColor.x;
+            const float y = tcColor.x;
+
+            wsum += w;
+            xsum += w * x;
+            ysum += w * y;
+            xxsum += w * x * x;
+            yysum += w * y * y;
+            xysum += w * x * y;
+        }
+    }
+
+    // compute weighted similarity (same as device simStat::computeWSim)
+    const float varXYW = (xysum - xsum * ysum / wsum) / wsum;
+    const float varXW = (xxsum - xsum * xsum / wsum) / wsum;
+    const float varYW = (yysum - ysum * ysum / wsum) / wsum;
+    const float rawSim = varXYW / std::sqrt(varXW * varYW);
+    const float fsim = std::isfinite(rawSim) ? -rawSim : 1.0f;
+
+    if (TInvertAndFilter)
+    {
+        // invert and filter similarity
+        // best similarity value was -1, worst was 0
+        // best similarity value is 1, worst is still 0
+        return cpuSigmoid(0.0f, 1.0f, 0.7f, -0.7f, fsim);
+    }
+
+    return fsim;
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
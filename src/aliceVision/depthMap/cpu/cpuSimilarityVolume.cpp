@@ -0,0 +1,516 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "cpuSimilarityVolume.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/depthMap/cpu/cpuPatch.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+
+namespace aliceVision {
+namespace depthMap {
+
+void cpu_volumeUpdateUninitializedSimilarity(const CpuVolume<CpuSim>& in_volBestSim, CpuVolume<CpuSim>& inout_volSecBestSim)
+{
+    const int volDimX = int(inout_volSecBestSim.width());
+    const int volDimY = int(inout_volSecBestSim.height());
+    const int volDimZ = int(inout_volSecBestSim.depth());
+
+#pragma omp parallel for
+    for (int vy = 0; vy < volDimY; ++vy)
+    {
+        for (int vx = 0; vx < volDimX; ++vx)
+        {
+            const CpuSim* bestSimColumn = in_volBestSim.column(vx, vy);
+            CpuSim* secBestSimColumn = inout_volSecBestSim.column(vx, vy);
+
+            for (int vz = 0; vz < volDimZ; ++vz)
+            {
+                // invalid or uninitialized similarity value
+                if (secBestSimColumn[vz] >= 255)
+                    secBestSimColumn[vz] = bestSimColumn[vz];
+            }
+        }
+    }
+}
+
+void cpu_volumeComputeSimilarity(CpuVolume<CpuSim>& out_volBestSim,
+                                 CpuVolume<CpuSim>& out_volSecBestSim,
+                                 const std::vector<float>& in_depths,
+                                 const CpuCameraParams& rcCamParams,
+                                 const CpuCameraParams& tcCamParams,
+                                 const CpuMipmapImage& rcMipmapImage,
+                                 const CpuMipmapImage& tcMipmapImage,
+                                 const SgmParams& sgmParams,
+                                 const Range& depthRange,
+                                 const ROI& roi)
+{
+    // get mipmap images level and dimensions
+    const float rcMipmapLevel = rcMipmapImage.getLevel(sgmParams.scale);
+    const unsigned int rcLevelWidth = (unsigned int)(rcMipmapImage.getWidth(sgmParams.scale));
+    const unsigned int rcLevelHeight = (unsigned int)(rcMipmapImage.getHeight(sgmParams.scale));
+    const unsigned int tcLevelWidth = (unsigned int)(tcMipmapImage.getWidth(sgmParams.scale));
+    const unsigned int tcLevelHeight = (unsigned int)(tcMipmapImage.getHeight(sgmParams.scale));
+
+    const float invGammaC = 1.f / float(sgmParams.gammaC);
+    const float invGammaP = 1.f / float(sgmParams.gammaP);
+
+    // we do not need positive and filtered similarity values
+    constexpr bool invertAndFilter = false;
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+
+#pragma omp parallel for
+    for (int vy = 0; vy < roiHeight; ++vy)
+    {
+        for (int vx = 0; vx < roiWidth; ++vx)
+        {
+            // corresponding image coordinates
+            const Vec2f pix(float(roi.x.begin + vx) * float(sgmParams.stepXY), float(roi.y.begin + vy) * float(sgmParams.stepXY));
+
+            CpuSim* bestSimColumn = out_volBestSim.column(vx, vy);
+            CpuSim* secBestSimColumn = out_volSecBestSim.column(vx, vy);
+
+            for (int vz = int(depthRange.begin); vz < int(depthRange.end); ++vz)
+            {
+                // compute patch on the fronto-parallel depth plane
+                CpuPatch patch;
+                patch.p = cpuGet3DPointForPixelAndFrontoParallelPlane(rcCamParams, pix, in_depths[vz]);
+                patch.d = cpuComputePixSize(rcCamParams, patch.p);
+                cpuComputeRotCSEpip(patch, rcCamParams, tcCamParams);
+
+                // compute patch similarity
+                float fsim = cpuCompNCCby3DptsYK<invertAndFilter>(rcCamParams,
+                                                                  tcCamParams,
+                                                                  rcMipmapImage,
+                                                                  tcMipmapImage,
+                                                                  rcLevelWidth,
+                                                                  rcLevelHeight,
+                                                                  tcLevelWidth,
+                                                                  tcLevelHeight,
+                                                                  rcMipmapLevel,
+                                                                  sgmParams.wsh,
+                                                                  invGammaC,
+                                                                  invGammaP,
+                                                                  sgmParams.useConsistentScale,
+                                                                  patch);
+
+                if (fsim == std::numeric_limits<float>::infinity())  // invalid similarity
+                {
+                    fsim = 255.0f;  // 255 is the invalid similarity value
+                }
+                else  // valid similarity
+                {
+                    // remap similarity value from (-1, 1) to (0, 254)
+                    // 255 is reserved for the similarity initialization, i.e. undefined values
+                    fsim = std::min(1.0f, std::max(0.0f, (fsim + 1.0f) * 0.5f)) * 254.0f;
+                }
+
+                if (fsim < bestSimColumn[vz])
+                {
+                    secBestSimColumn[vz] = bestSimColumn[vz];
+                    bestSimColumn[vz] = CpuSim(fsim);
+                }
+                else if (fsim < secBestSimColumn[vz])
+                {
+                    secBestSimColumn[vz] = CpuSim(fsim);
+                }
+            }
+        }
+    }
+}
+
+void cpu_volumeRefineSimilarity(CpuVolume<CpuSimRefine>& inout_volSim,
+                                const CpuMap<Vec2f>& in_sgmDepthPixSizeMap,
+                                const CpuMap<Vec3f>* in_sgmNormalMapPtr,
+                                const CpuCameraParams& rcCamParams,
+                                const CpuCameraParams& tcCamParams,
+                                const CpuMipmapImage& rcMipmapImage,
+                                const CpuMipmapImage& tcMipmapImage,
+                                const RefineParams& refineParams,
+                                const Range& depthRange,
+                                const ROI& roi)
+{
+    // get mipmap images level and dimensions
+    const float rcMipmapLevel = rcMipmapImage.getLevel(refineParams.scale);
+    const unsigned int rcLevelWidth = (unsigned int)(rcMipmapImage.getWidth(refineParams.scale));
+    const unsigned int rcLevelHeight = (unsigned int)(rcMipmapImage.getHeight(refineParams.scale));
+    const unsigned int tcLevelWidth = (unsigned int)(tcMipmapImage.getWidth(refineParams.scale));
+    const unsigned int tcLevelHeight = (unsigned int)(tcMipmapImage.getHeight(refineParams.scale));
+
+    const float invGammaC = 1.f / float(refineParams.gammaC);
+    const float invGammaP = 1.f / float(refineParams.gammaP);
+    const int volDimZ = int(inout_volSim.depth());
+
+    // we need positive and filtered similarity values
+    constexpr bool invertAndFilter = true;
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+
+#pragma omp parallel for
+    for (int vy = 0; vy < roiHeight; ++vy)
+    {
+        for (int vx = 0; vx < roiWidth; ++vx)
+        {
+            // corresponding input sgm depth/pixSize (middle depth)
+            const Vec2f& sgmDepthPixSize = in_sgmDepthPixSizeMap(vx, vy);
+
+            // sgm depth (middle depth) invalid or masked
+            if (sgmDepthPixSize.x() <= 0.0f)
+                continue;
+
+            // corresponding image coordinates
+            const Vec2f pix(float(roi.x.begin + vx) * float(refineParams.stepXY), float(roi.y.begin + vy) * float(refineParams.stepXY));
+
+            CpuSimRefine* simColumn = inout_volSim.column(vx, vy);
+
+            for (int vz = int(depthRange.begin); vz < int(depthRange.end); ++vz)
+            {
+                // initialize rc 3d point at sgm depth (middle depth)
+                Vec3f p = cpuGet3DPointForPixelAndDepth(rcCamParams, pix, sgmDepthPixSize.x());
+
+                // compute relative depth index offset from z center
+                const int relativeDepthIndexOffset = vz - ((volDimZ - 1) / 2);
+
+                if (relativeDepthIndexOffset != 0)
+                {
+                    // move rc 3d point by relative depth index offset * sgm pixSize
+                    const float pixSizeOffset = relativeDepthIndexOffset * sgmDepthPixSize.y();
+                    p += (p - rcCamParams.C).normalized() * pixSizeOffset;
+                }
+
+                // compute patch
+                CpuPatch patch;
+                patch.p = p;
+                patch.d = cpuComputePixSize(rcCamParams, p);
+
+                {
+                    const Vec3f v1 = (rcCamParams.C - patch.p).normalized();
+                    const Vec3f v2 = (tcCamParams.C - patch.p).normalized();
+
+                    patch.y = v1.cross(v2).normalized();
+
+                    // initialize patch normal from input normal map or from v1 & v2
+                    patch.n = (in_sgmNormalMapPtr != nullptr) ? (*in_sgmNormalMapPtr)(vx, vy) : Vec3f(((v1 + v2) / 2.0f).normalized());
+                    patch.x = patch.y.cross(patch.n).normalized();
+                }
+
+                const float fsimInvertedFiltered = cpuCompNCCby3DptsYK<invertAndFilter>(rcCamParams,
+                                                                                        tcCamParams,
+                                                                                        rcMipmapImage,
+                                                                                        tcMipmapImage,
+                                                                                        rcLevelWidth,
+                                                                                        rcLevelHeight,
+                                                                                        tcLevelWidth,
+                                                                                        tcLevelHeight,
+                                                                                        rcMipmapLevel,
+                                                                                        refineParams.wsh,
+                                                                                        invGammaC,
+                                                                                        invGammaP,
+                                                                                        refineParams.useConsistentScale,
+                                                                                        patch);
+
+                // invalid similarity, do nothing
+                if (fsimInvertedFiltered == std::numeric_limits<float>::infinity())
+                    continue;
+
+                simColumn[vz] += CpuSimRefine(fsimInvertedFiltered);
+            }
+        }
+    }
+}
+
+void cpu_volumeOptimize(CpuVolume<CpuSim>& out_volSimFiltered,
+                        const CpuVolume<CpuSim>& in_volSim,
+                        const CpuMipmapImage& rcMipmapImage,
+                        const SgmParams& sgmParams,
+                        int lastDepthIndex,
+                        const ROI& roi)
+{
+    // get R mipmap image level and dimensions
+    const float rcMipmapLevel = rcMipmapImage.getLevel(sgmParams.scale);
+    const float rcInvLevelWidth = 1.f / float(rcMipmapImage.getWidth(sgmParams.scale));
+    const float rcInvLevelHeight = 1.f / float(rcMipmapImage.getHeight(sgmParams.scale));
+
+    // override volume depth, use rc depth list last index
+    const std::array<int, 3> volDim = {int(in_volSim.width()), int(in_volSim.height()), lastDepthIndex};
+
+    const float step = float(sgmParams.stepXY);
+    const float P1 = float(sgmParams.p1);
+    const float _P2 = float(sgmParams.p2Weighting);
+
+    // aggregate a single path, same as cuda_volumeAggregatePath
+    // note: each x of the XZ slice is an independent recurrence along the Y axis, so x columns are processed in parallel
+    const auto aggregatePath = [&](const std::array<int, 3>& axisT, bool invY, int filteringIndex) {
+        const int volDimX = volDim[axisT[0]];
+        const int volDimY = volDim[axisT[1]];
+        const int volDimZ = volDim[axisT[2]];
+        const int ySign = (invY ? -1 : 1);
+
+        // find texture offset
+        const int beginX = (axisT[0] == 0) ? roi.x.begin : roi.y.begin;
+        const int beginY = (axisT[0] == 0) ? roi.y.begin : roi.x.begin;
+
+#pragma omp parallel for
+        for (int x = 0; x < volDimX; ++x)
+        {
+            std::vector<CpuSimAcc> sliceForYm1(volDimZ);  // Y-1 slice column
+            std::vector<CpuSimAcc> sliceForY(volDimZ);    // Y slice column
+
+            std::array<int, 3> v;
+            v[axisT[0]] = x;
+
+            // copy the first column (at Y=0) from the input volume and set the output volume to 255
+            v[axisT[1]] = 0;
+            for (int z = 0; z < volDimZ; ++z)
+            {
+                v[axisT[2]] = z;
+                sliceForYm1[z] = CpuSimAcc(in_volSim(v[0], v[1], v[2]));
+                out_volSimFiltered(v[0], v[1], v[2]) = 255;
+            }
+
+            for (int iy = 1; iy < volDimY; ++iy)
+            {
+                const int y = invY ? volDimY - 1 - iy : iy;
+                v[axisT[1]] = y;
+
+                // best score of the previous column
+                const CpuSimAcc bestCostInColM1 = *std::min_element(sliceForYm1.begin(), sliceForYm1.end());
+
+                // compute P2 (does not depend on z)
+                float P2 = 0;
+
+                if (_P2 < 0)
+                {
+                    // _P2 convention: use negative value to skip the use of deltaC.
+                    P2 = std::abs(_P2);
+                }
+                else
+                {
+                    const int imX0 = (beginX + v[0]) * step;  // current
+                    const int imY0 = (beginY + v[1]) * step;
+
+                    const int imX1 = imX0 - ySign * step * (axisT[1] == 0);  // M1
+                    const int imY1 = imY0 - ySign * step * (axisT[1] == 1);
+
+                    const CpuColor gcr0 =
+                      rcMipmapImage.sample((float(imX0) + 0.5f) * rcInvLevelWidth, (float(imY0) + 0.5f) * rcInvLevelHeight, rcMipmapLevel);
+                    const CpuColor gcr1 =
+                      rcMipmapImage.sample((float(imX1) + 0.5f) * rcInvLevelWidth, (float(imY1) + 0.5f) * rcInvLevelHeight, rcMipmapLevel);
+                    const float deltaC = cpuColorDistance(gcr0, gcr1);
+
+                    P2 = cpuSigmoid(80.f, 255.f, 80.f, _P2, deltaC);
+                }
+
+                for (int z = 0; z < volDimZ; ++z)
+                {
+                    v[axisT[2]] = z;
+
+                    float pathCost = 255.0f;
+
+                    if ((z >= 1) && (z < volDimZ - 1))
+                    {
+                        const float minCost = std::min(std::min(float(sliceForYm1[z]), sliceForYm1[z - 1] + P1),
+                                                       std::min(sliceForYm1[z + 1] + P1, bestCostInColM1 + P2));
+
+                        pathCost = float(in_volSim(v[0], v[1], v[2])) + minCost - bestCostInColM1;
+                    }
+
+                    // fill the current slice with the new similarity score
+                    sliceForY[z] = CpuSimAcc(pathCost);
+
+                    // clamp (CpuSim = uchar)
+                    pathCost = std::min(255.0f, std::max(0.0f, pathCost));
+
+                    // aggregate into the final output
+                    CpuSim& volumeXYZ = out_volSimFiltered(v[0], v[1], v[2]);
+                    volumeXYZ = CpuSim((float(volumeXYZ) * float(filteringIndex) + pathCost) / float(filteringIndex + 1));
+                }
+
+                std::swap(sliceForYm1, sliceForY);
+            }
+        }
+    };
+
+    // filtering is done on the last axis
+    const std::map<char, std::array<int, 3>> mapAxes = {
+      {'X', {1, 0, 2}},  // XYZ -> YXZ
+      {'Y', {0, 1, 2}},  // XYZ
+    };
+
+    int npaths = 0;
+
+    for (char axis : sgmParams.filteringAxes)
+    {
+        const std::array<int, 3>& axisT = mapAxes.at(axis);
+        aggregatePath(axisT, false, npaths++);  // without transpose
+        aggregatePath(axisT, true, npaths++);   // with transpose of the last axis
+    }
+}
+
+void cpu_volumeRetrieveBestDepth(CpuMap<Vec2f>& out_sgmDepthThicknessMap,
+                                 CpuMap<Vec2f>& out_sgmDepthSimMap,
+                                 const std::vector<float>& in_depths,
+                                 const CpuVolume<CpuSim>& in_volSim,
+                                 const CpuCameraParams& rcCamParams,
+                                 const SgmParams& sgmParams,
+                                 const Range& depthRange,
+                                 const ROI& roi)
+{
+    const int scaleStep = sgmParams.scale * sgmParams.stepXY;
+    const float thicknessMultFactor = 1.f + float(sgmParams.depthThicknessInflate);
+    const float maxSimilarity = float(sgmParams.maxSimilarity) * 254.f;  // convert from (0, 1) to (0, 254)
+    const int lastDepthIndex = int(in_depths.size()) - 1;
+    const bool computeDepthSimMap = !out_sgmDepthSimMap.isEmpty();
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+
+#pragma omp parallel for
+    for (int vy = 0; vy < roiHeight; ++vy)
+    {
+        for (int vx = 0; vx < roiWidth; ++vx)
+        {
+            // corresponding image coordinates
+            const Vec2f pix(float((roi.x.begin + vx) * scaleStep), float((roi.y.begin + vy) * scaleStep));
+
+            Vec2f& out_bestDepthThickness = out_sgmDepthThicknessMap(vx, vy);
+
+            // find the best depth plane index for the current pixel
+            const CpuSim* simColumn = in_volSim.column(vx, vy);
+
+            float bestSim = 255.f;
+            int bestZIdx = -1;
+
+            for (int vz = int(depthRange.begin); vz < int(depthRange.end); ++vz)
+            {
+                const float simAtZ = simColumn[vz];
+
+                if (simAtZ < bestSim)
+                {
+                    bestSim = simAtZ;
+                    bestZIdx = vz;
+                }
+            }
+
+            // filtering out invalid values and values with a too bad score
+            if ((bestZIdx == -1) || (bestSim > maxSimilarity))
+            {
+                out_bestDepthThickness = Vec2f(-1.f, -1.f);  // invalid depth / thickness
+
+                if (computeDepthSimMap)
+                    out_sgmDepthSimMap(vx, vy) = Vec2f(-1.f, 1.f);  // invalid depth, worst similarity value
+                continue;
+            }
+
+            // best depth plane previous and next indexes
+            // note: the device implementation clamps to the volume buffer depth,
+            //       the depth list last index is used to stay in the depth list
+            const int bestZIdx_m1 = std::max(0, bestZIdx - 1);
+            const int bestZIdx_p1 = std::min(lastDepthIndex, bestZIdx + 1);
+
+            const float bestDepth = cpuDepthPlaneToDepth(rcCamParams, in_depths[bestZIdx], pix);
+            const float bestDepth_m1 = cpuDepthPlaneToDepth(rcCamParams, in_depths[bestZIdx_m1], pix);
+            const float bestDepth_p1 = cpuDepthPlaneToDepth(rcCamParams, in_depths[bestZIdx_p1], pix);
+
+            const float out_bestSim = (bestSim / 255.0f) * 2.0f - 1.0f;  // convert from (0, 255) to (-1, +1)
+            const float out_bestDepthThicknessValue = std::max(bestDepth_p1 - bestDepth, bestDepth - bestDepth_m1) * thicknessMultFactor;
+
+            out_bestDepthThickness = Vec2f(bestDepth, out_bestDepthThicknessValue);
+
+            if (computeDepthSimMap)
+                out_sgmDepthSimMap(vx, vy) = Vec2f(bestDepth, out_bestSim);
+        }
+    }
+}
+
+void cpu_volumeRefineBestDepth(CpuMap<Vec2f>& out_refineDepthSimMap,
+                               const CpuMap<Vec2f>& in_sgmDepthPixSizeMap,
+                               const CpuVolume<CpuSimRefine>& in_volSim,
+                               const RefineParams& refineParams,
+                               const ROI& roi)
+{
+    const int volDimZ = int(in_volSim.depth());
+    const int samplesPerPixSize = refineParams.nbSubsamples;
+    const int halfNbDepths = refineParams.halfNbDepths;
+    const int halfNbSamples = samplesPerPixSize * halfNbDepths;
+    const float twoTimesSigmaPowerTwo = float(2.0 * refineParams.sigma * refineParams.sigma);
+
+    // gaussian weights, indexed by (relative sample offset - sample) + offset
+    // note: (zs - sample) is in range [-(halfNbSamples + zsMax), halfNbSamples + zsMax]
+    const int zsMax = (volDimZ - 1 - halfNbDepths) * samplesPerPixSize;
+    const int zsMin = -halfNbDepths * samplesPerPixSize;
+    const int gaussianOffset = halfNbSamples - zsMin;
+    std::vector<float> gaussianWeights(std::size_t(zsMax + halfNbSamples + gaussianOffset + 1));
+
+    for (std::size_t i = 0; i < gaussianWeights.size(); ++i)
+    {
+        const int d = int(i) - gaussianOffset;
+        gaussianWeights[i] = std::exp(-float(d * d) / twoTimesSigmaPowerTwo);
+    }
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+
+#pragma omp parallel for
+    for (int vy = 0; vy < roiHeight; ++vy)
+    {
+        for (int vx = 0; vx < roiWidth; ++vx)
+        {
+            const Vec2f& sgmDepthPixSize = in_sgmDepthPixSizeMap(vx, vy);
+            Vec2f& out_bestDepthSim = out_refineDepthSimMap(vx, vy);
+
+            // sgm depth (middle depth) invalid or masked
+            if (sgmDepthPixSize.x() <= 0.0f)
+            {
+                out_bestDepthSim = Vec2f(sgmDepthPixSize.x(), 1.0f);  // -1 (invalid) or -2 (masked), similarity between (-1, +1)
+                continue;
+            }
+
+            const CpuSimRefine* simColumn = in_volSim.column(vx, vy);
+
+            // find best z sample per pixel
+            float bestSampleSim = 0.f;      // all sample sim <= 0.f
+            int bestSampleOffsetIndex = 0;  // default is middle depth (SGM)
+
+            // sliding gaussian window
+            for (int sample = -halfNbSamples; sample <= halfNbSamples; ++sample)
+            {
+                float sampleSim = 0.f;
+
+                for (int vz = 0; vz < volDimZ; ++vz)
+                {
+                    const int zs = (vz - halfNbDepths) * samplesPerPixSize;  // relative sample offset
+
+                    // reverse the inverted similarity sum value, best value is the LOWEST
+                    sampleSim += -float(simColumn[vz]) * gaussianWeights[zs - sample + gaussianOffset];
+                }
+
+                if (sampleSim < bestSampleSim)
+                {
+                    bestSampleOffsetIndex = sample;
+                    bestSampleSim = sampleSim;
+                }
+            }
+
+            // input sgm depth (middle depth) + sample size offset from z center
+            const float sampleSize = sgmDepthPixSize.y() / samplesPerPixSize;
+            const float bestDepth = sgmDepthPixSize.x() + bestSampleOffsetIndex * sampleSize;
+
+            out_bestDepthSim = Vec2f(bestDepth, bestSampleSim);
+        }
+    }
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,133 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/ROI.hpp>
+#include <aliceVision/depthMap/SgmParams.hpp>
+#include <aliceVision/depthMap/RefineParams.hpp>
+#include <aliceVision/depthMap/cpu/CpuBuffer.hpp>
+#include <aliceVision/depthMap/cpu/CpuCameraParams.hpp>
+#include <aliceVision/depthMap/cpu/CpuMipmapImage.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/*
+ * CPU implementation of the similarity volume functions (see deviceSimilarityVolume.hpp).
+ * Each function gives the same result as its cuda_ counterpart, up to floating point precision.
+ * Loops are parallelized with OpenMP, nested calls from a parallel region run on the calling thread.
+ */
+
+/**
+ * @brief Update second best similarity volume uninitialized values with first best volume values.
+ * @param[in] in_volBestSim the best similarity volume
+ * @param[out] inout_volSecBestSim the second best similarity volume
+ */
+void cpu_volumeUpdateUninitializedSimilarity(const CpuVolume<CpuSim>& in_volBestSim, CpuVolume<CpuSim>& inout_volSecBestSim);
+
+/**
+ * @brief Compute the best / second best similarity volume for the given RC / TC.
+ * @param[out] out_volBestSim the best similarity volume
+ * @param[out] out_volSecBestSim the second best similarity volume
+ * @param[in] in_depths the R camera depth list
+ * @param[in] rcCamParams the R camera parameters at SGM scale
+ * @param[in] tcCamParams the T camera parameters at SGM scale
+ * @param[in] rcMipmapImage the R mipmap image
+ * @param[in] tcMipmapImage the T mipmap image
+ * @param[in] sgmParams the Semi Global Matching parameters
+ * @param[in] depthRange the volume depth range to compute
+ * @param[in] roi the 2d region of interest
+ */
+void cpu_volumeComputeSimilarity(CpuVolume<CpuSim>& out_volBestSim,
+                                 CpuVolume<CpuSim>& out_volSecBestSim,
+                                 const std::vector<float>& in_depths,
+                                 const CpuCameraParams& rcCamParams,
+                                 const CpuCameraParams& tcCamParams,
+                                 const CpuMipmapImage& rcMipmapImage,
+                                 const CpuMipmapImage& tcMipmapImage,
+                                 const SgmParams& sgmParams,
+                                 const Range& depthRange,
+                                 const ROI& roi);
+
+/**
+ * @brief Refine the best similarity volume for the given RC / TC.
+ * @param[out] inout_volSim the similarity volume
+ * @param[in] in_sgmDepthPixSizeMap the SGM upscaled depth/pixSize map
+ * @param[in] in_sgmNormalMapPtr the SGM upscaled normal map (or nullptr)
+ * @param[in] rcCamParams the R camera parameters at Refine scale
+ * @param[in] tcCamParams the T camera parameters at Refine scale
+ * @param[in] rcMipmapImage the R mipmap image
+ * @param[in] tcMipmapImage the T mipmap image
+ * @param[in] refineParams the Refine parameters
+ * @param[in] depthRange the volume depth range to compute
+ * @param[in] roi the 2d region of interest
+ */
+void cpu_volumeRefineSimilarity(CpuVolume<CpuSimRefine>& inout_volSim,
+                                const CpuMap<Vec2f>& in_sgmDepthPixSizeMap,
+                                const CpuMap<Vec3f>* in_sgmNormalMapPtr,
+                                const CpuCameraParams& rcCamParams,
+                                const CpuCameraParams& tcCamParams,
+                                const CpuMipmapImage& rcMipmapImage,
+                                const CpuMipmapImage& tcMipmapImage,
+                                const RefineParams& refineParams,
+                                const Range& depthRange,
+                                const ROI& roi);
+
+/**
+ * @brief Filter / Optimize the given similarity volume with the Semi-Global Matching paths aggregation.
+ * @param[out] out_volSimFiltered the output similarity volume
+ * @param[in] in_volSim the input similarity volume
+ * @param[in] rcMipmapImage the R mipmap image
+ * @param[in] sgmParams the Semi Global Matching parameters
+ * @param[in] lastDepthIndex the R camera last depth index
+ * @param[in] roi the 2d region of interest
+ */
+void cpu_volumeOptimize(CpuVolume<CpuSim>& out_volSimFiltered,
+                        const CpuVolume<CpuSim>& in_volSim,
+                        const CpuMipmapImage& rcMipmapImage,
+                        const SgmParams& sgmParams,
+                        int lastDepthIndex,
+                        const ROI& roi);
+
+/**
+ * @brief Retrieve the best depth/sim in the given similarity volume.
+ * @param[out] out_sgmDepthThicknessMap the output depth/thickness map
+ * @param[out] out_sgmDepthSimMap the output best depth/sim map (or empty)
+ * @param[in] in_depths the R camera depth list
+ * @param[in] in_volSim the input similarity volume
+ * @param[in] rcCamParams the R camera parameters at scale 1
+ * @param[in] sgmParams the Semi Global Matching parameters
+ * @param[in] depthRange the volume depth range to compute
+ * @param[in] roi the 2d region of interest
+ */
+void cpu_volumeRetrieveBestDepth(CpuMap<Vec2f>& out_sgmDepthThicknessMap,
+                                 CpuMap<Vec2f>& out_sgmDepthSimMap,
+                                 const std::vector<float>& in_depths,
+                                 const CpuVolume<CpuSim>& in_volSim,
+                                 const CpuCameraParams& rcCamParams,
+                                 const SgmParams& sgmParams,
+                                 const Range& depthRange,
+                                 const ROI& roi);
+
+/**
+ * @brief Retrieve the best depth/sim in the given refined similarity volume.
+ * @param[out] out_refineDepthSimMap the output refined and fused depth/sim map
+ * @param[in] in_sgmDepthPixSizeMap the SGM upscaled depth/pixSize map
+ * @param[in] in_volSim the similarity volume
+ * @param[in] refineParams the Refine parameters
+ * @param[in] roi the 2d region of interest
+ */
+void cpu_volumeRefineBestDepth(CpuMap<Vec2f>& out_refineDepthSimMap,
+                               const CpuMap<Vec2f>& in_sgmDepthPixSizeMap,
+                               const CpuVolume<CpuSimRefine>& in_volSim,
+                               const RefineParams& refineParams,
+                               const ROI& roi);
+
+}  // namespace depthMap
+}  // namespace aliceVision
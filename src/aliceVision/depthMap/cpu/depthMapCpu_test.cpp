@@ -0,0 +1,229 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/depthMap/SgmDepthList.hpp>
+#include <aliceVision/depthMap/cpu/CpuSgm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE depthMapCpu
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::depthMap;
+
+namespace {
+
+constexpr int imageWidth = 96;
+constexpr int imageHeight = 72;
+constexpr double focalLength = 100.0;
+constexpr double planeDepth = 5.0;  //< depth of the fronto-parallel plane in the R camera frame
+constexpr double baseline = 0.5;
+
+/**
+ * @brief Random texture of the plane (bilinear value noise, deterministic).
+ */
+class PlaneTexture
+{
+  public:
+    explicit PlaneTexture(unsigned int seed)
+    {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<float> distribution(0.1f, 0.9f);
+        _values.resize(std::size_t(_gridSize) * _gridSize);
+        for (float& v : _values)
+            v = distribution(generator);
+    }
+
+    float operator()(double x, double y) const
+    {
+        const double gx = x / _cellSize + _gridSize * 0.5;
+        const double gy = y / _cellSize + _gridSize * 0.5;
+        const int ix = std::clamp(int(std::floor(gx)), 0, _gridSize - 2);
+        const int iy = std::clamp(int(std::floor(gy)), 0, _gridSize - 2);
+        const float fx = float(std::clamp(gx - ix, 0.0, 1.0));
+        const float fy = float(std::clamp(gy - iy, 0.0, 1.0));
+
+        const float top = value(ix, iy) * (1.f - fx) + value(ix + 1, iy) * fx;
+        const float bottom = value(ix, iy + 1) * (1.f - fx) + value(ix + 1, iy + 1) * fx;
+        return top * (1.f - fy) + bottom * fy;
+    }
+
+  private:
+    float value(int x, int y) const { return _values[std::size_t(y) * _gridSize + x]; }
+
+    const int _gridSize = 256;
+    const double _cellSize = 0.15;  //< about 3 pixels at the plane depth
+    std::vector<float> _values;
+};
+
+/**
+ * @brief Get the ray of the given pixel in camera coordinates (unit depth).
+ */
+Vec3 pixelRay(double x, double y) { return Vec3((x - imageWidth * 0.5) / focalLength, (y - imageHeight * 0.5) / focalLength, 1.0); }
+
+/**
+ * @brief Render the plane seen by a camera of the rig (identity rotation, center on the X axis).
+ */
+void renderPlane(const PlaneTexture& texture, double centerX, image::Image<image::RGBAfColor>& out_image)
+{
+    out_image.resize(imageWidth, imageHeight);
+
+    for (int y = 0; y < imageHeight; ++y)
+    {
+        for (int x = 0; x < imageWidth; ++x)
+        {
+            const Vec3 point = pixelRay(x, y) * planeDepth;
+            const float v = texture(centerX + point.x(), point.y());
+            out_image(y, x) = image::RGBAfColor(v, v, v, 1.f);
+        }
+    }
+}
+
+/**
+ * @brief Build a rig of 3 cameras looking at the plane, the R camera (index 0) in the middle.
+ * Landmarks are spread over the depth range around the plane, they are only used as depth seeds.
+ */
+sfmData::SfMData generateSfm(const std::vector<double>& centersX)
+{
+    sfmData::SfMData sfmData;
+
+    sfmData.getIntrinsics().emplace(0,
+                                    camera::createPinhole(camera::EDISTORTION::DISTORTION_NONE,
+                                                          camera::EUNDISTORTION::UNDISTORTION_NONE,
+                                                          imageWidth,
+                                                          imageHeight,
+                                                          focalLength,
+                                                          focalLength,
+                                                          0.0,
+                                                          0.0));
+
+    for (IndexT i = 0; i < centersX.size(); ++i)
+    {
+        sfmData.getViews().emplace(i, std::make_shared<sfmData::View>("", i, 0, i, imageWidth, imageHeight));
+        sfmData.setPose(*sfmData.getViews().at(i), sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3(centersX[i], 0.0, 0.0))));
+    }
+
+    const int nbLandmarks = 16;
+    for (int l = 0; l < nbLandmarks; ++l)
+    {
+        const double depth = 4.0 + 2.5 * l / (nbLandmarks - 1);
+        const Vec3 ray = pixelRay(16 + (l % 4) * 20, 12 + (l / 4) * 16);
+        const Vec3 X = ray * depth;
+
+        sfmData::Landmark landmark;
+        landmark.X = X;
+        for (IndexT i = 0; i < centersX.size(); ++i)
+        {
+            const Vec3 Xc = X - Vec3(centersX[i], 0.0, 0.0);
+            const Vec2 pt(focalLength * Xc.x() / Xc.z() + imageWidth * 0.5, focalLength * Xc.y() / Xc.z() + imageHeight * 0.5);
+            landmark.getObservations()[i] = sfmData::Observation(pt, l, 0.0);
+        }
+        sfmData.getLandmarks()[l] = landmark;
+    }
+
+    return sfmData;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(depthMapCpu_sgmFrontoParallelPlane)
+{
+    const std::vector<double> centersX = {0.0, -baseline, baseline};
+    const sfmData::SfMData sfmData = generateSfm(centersX);
+
+    mvsUtils::MultiViewParams mp(sfmData, "", "", "", false);
+    BOOST_REQUIRE_EQUAL(mp.getNbCameras(), 3);
+
+    mvsUtils::TileParams tileParams;
+    tileParams.bufferWidth = imageWidth;
+    tileParams.bufferHeight = imageHeight;
+
+    SgmParams sgmParams;
+    sgmParams.scale = 1;
+    sgmParams.stepXY = 1;
+    sgmParams.maxDepths = 200;
+
+    // images of the plane seen by each camera
+    const PlaneTexture texture(42);
+    CpuMipmapImages mipmapImages(mp.ncams);
+
+    for (int c = 0; c < mp.ncams; ++c)
+    {
+        image::Image<image::RGBAfColor> img;
+        renderPlane(texture, centersX.at(mp.getViewId(c)), img);
+
+        mipmapImages.at(c) = std::make_unique<CpuMipmapImage>();
+        mipmapImages.at(c)->fill(img, 1, 64);
+    }
+
+    // single tile of the R camera
+    const int rc = mp.getIndexFromViewId(0);
+
+    Tile tile;
+    tile.id = 0;
+    tile.nbTiles = 1;
+    tile.rc = rc;
+    tile.roi = ROI(Range(0, imageWidth), Range(0, imageHeight));
+    for (int c = 0; c < mp.ncams; ++c)
+    {
+        if (c != rc)
+            tile.sgmTCams.push_back(c);
+    }
+
+    SgmDepthList depthList(mp, sgmParams, tile);
+    depthList.computeListRc();
+    BOOST_REQUIRE(!depthList.getDepths().empty());
+
+    depthList.removeTcWithNoDepth(tile);
+    BOOST_REQUIRE_EQUAL(tile.sgmTCams.size(), std::size_t(2));
+
+    depthList.checkStartingAndStoppingDepth();
+
+    CpuSgm sgm(mp, tileParams, sgmParams, mipmapImages, true, false);
+    sgm.sgmRc(tile, depthList);
+
+    const CpuMap<Vec2f>& depthSimMap = sgm.getDepthSimMap();
+    BOOST_REQUIRE_EQUAL(depthSimMap.width(), std::size_t(imageWidth));
+    BOOST_REQUIRE_EQUAL(depthSimMap.height(), std::size_t(imageHeight));
+
+    // compare the inner pixels (not affected by the patch border) to the ray length to the plane
+    const int margin = 2 * sgmParams.wsh;
+    int nbPixels = 0;
+    int nbValid = 0;
+    int nbInliers = 0;
+
+    for (int y = margin; y < imageHeight - margin; ++y)
+    {
+        for (int x = margin; x < imageWidth - margin; ++x)
+        {
+            ++nbPixels;
+
+            const float depth = depthSimMap(x, y).x();
+            if (depth <= 0.f)
+                continue;
+
+            ++nbValid;
+
+            const double expectedDepth = pixelRay(x, y).norm() * planeDepth;
+            if (std::abs(depth - expectedDepth) < 0.03 * expectedDepth)
+                ++nbInliers;
+        }
+    }
+
+    BOOST_TEST_MESSAGE("valid pixels: " << nbValid << "/" << nbPixels << ", inliers: " << nbInliers);
+
+    BOOST_CHECK_GT(nbValid, 0.9 * nbPixels);
+    BOOST_CHECK_GT(nbInliers, 0.9 * nbValid);
+}
@@ -281,6 +281,33 @@ inline void loadDescsFromBinFile(const std::string& sfileNameDescs, std::vector<
     fileIn.close();
 }
 
+/**
+ * @brief Load descriptors from a memory buffer containing a binary descriptors file (.desc).
+ * @param[in] data The beginning of the binary descriptors data
+ * @param[in] size The size of the buffer in bytes
+ * @param[out] vec_desc A vector of descriptors that stores the loaded descriptors
+ * @param[in] sourceName The name of the data source, used in error messages
+ */
+template<typename DescriptorT>
+inline void loadDescsFromBinBuffer(const char* data, std::size_t size, std::vector<DescriptorT>& vec_desc, const std::string& sourceName)
+{
+    vec_desc.clear();
+
+    std::size_t cardDesc = 0;
+    if (size < sizeof(std::size_t))
+        throw std::runtime_error("Can't load descriptor binary data, '" + sourceName + "' is incorrect !");
+    std::memcpy(&cardDesc, data, sizeof(std::size_t));
+
+    constexpr std::size_t oneDescSize = DescriptorT::static_size * sizeof(typename DescriptorT::bin_type);
+    if (cardDesc > (size - sizeof(std::size_t)) / oneDescSize)
+        throw std::runtime_error("Can't load descriptor binary data, '" + sourceName + "' is truncated !");
+
+    vec_desc.resize(cardDesc);
+    const char* ptr = data + sizeof(std::size_t);
+    for (std::size_t i = 0; i < cardDesc; ++i, ptr += oneDescSize)
+        std::memcpy(vec_desc[i].getData(), ptr, oneDescSize);
+}
+
 /// Write descriptors to file (in binary mode)
 template<typename DescriptorsT>
 inline void saveDescsToBinFile(const std::string& sfileNameDescs, DescriptorsT& vec_desc)
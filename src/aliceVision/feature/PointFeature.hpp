@@ -8,9 +8,14 @@
 #pragma once
 
 #include "aliceVision/numeric/numeric.hpp"
+#include "aliceVision/system/MappedFile.hpp"
+
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 #include <fstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -85,12 +90,148 @@ inline std::istream& operator>>(std::istream& in, PointFeature& obj)
     return in >> obj._coords(0) >> obj._coords(1) >> obj._scale >> obj._orientation;
 }
 
-/// Read feats from file
+/**
+ * @brief Storage format of a features file (.feat).
+ */
+enum class EFeatsFileFormat
+{
+    /// One feature per line: "x y scale orientation"
+    Text = 0,
+    /// Versioned binary container (see FeatsBinaryHeader)
+    Binary
+};
+
+inline std::string EFeatsFileFormat_enumToString(EFeatsFileFormat format)
+{
+    switch (format)
+    {
+        case EFeatsFileFormat::Text:
+            return "text";
+        case EFeatsFileFormat::Binary:
+            return "binary";
+    }
+    throw std::out_of_range("Invalid features file format enum");
+}
+
+inline EFeatsFileFormat EFeatsFileFormat_stringToEnum(const std::string& format)
+{
+    if (format == "text")
+        return EFeatsFileFormat::Text;
+    if (format == "binary")
+        return EFeatsFileFormat::Binary;
+    throw std::out_of_range("Invalid features file format: " + format);
+}
+
+inline std::ostream& operator<<(std::ostream& os, EFeatsFileFormat e) { return os << EFeatsFileFormat_enumToString(e); }
+
+inline std::istream& operator>>(std::istream& in, EFeatsFileFormat& format)
+{
+    std::string token(std::istreambuf_iterator<char>(in), {});
+    format = EFeatsFileFormat_stringToEnum(token);
+    return in;
+}
+
+/**
+ * @brief Header of a binary features file.
+ *
+ * The header is followed by `count` records of `recordSize` bytes.
+ * The version 1 record is 4 little-endian floats: x, y, scale, orientation.
+ * Records are 4-byte aligned so the file can be memory-mapped and read in place.
+ */
+struct FeatsBinaryHeader
+{
+    static constexpr char magicNumber[8] = {'A', 'V', 'F', 'E', 'A', 'T', 'B', '\0'};
+    static constexpr std::uint32_t currentVersion = 1;
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint64_t count;
+};
+static_assert(sizeof(FeatsBinaryHeader) == 24, "FeatsBinaryHeader must not be padded");
+
+/**
+ * @brief Check if a features file is stored in the binary format.
+ * @param[in] sfileNameFeats the features file path
+ * @return true if the file starts with the binary features magic number
+ */
+inline bool isFeatsBinaryFile(const std::string& sfileNameFeats)
+{
+    std::ifstream fileIn(sfileNameFeats, std::ios::in | std::ios::binary);
+    char magic[sizeof(FeatsBinaryHeader::magicNumber)];
+    if (!fileIn.read(magic, sizeof(magic)))
+        return false;
+    return std::memcmp(magic, FeatsBinaryHeader::magicNumber, sizeof(magic)) == 0;
+}
+
+/**
+ * @brief Read feats from a memory buffer in the binary features format.
+ * @param[in] data the beginning of the binary features data (header included)
+ * @param[in] size the size of the buffer in bytes
+ * @param[out] vec_feat the loaded features
+ * @param[in] sourceName the name of the data source, used in error messages
+ */
+template<typename FeaturesT>
+inline void loadFeatsFromBinBuffer(const char* data, std::size_t size, FeaturesT& vec_feat, const std::string& sourceName)
+{
+    vec_feat.clear();
+
+    FeatsBinaryHeader header;
+    if (size < sizeof(FeatsBinaryHeader))
+        throw std::runtime_error("Can't load binary features, '" + sourceName + "' is too small !");
+    std::memcpy(&header, data, sizeof(FeatsBinaryHeader));
+
+    if (std::memcmp(header.magic, FeatsBinaryHeader::magicNumber, sizeof(header.magic)) != 0)
+        throw std::runtime_error("Can't load binary features, '" + sourceName + "' is not a binary features file !");
+    if (header.version != FeatsBinaryHeader::currentVersion)
+        throw std::runtime_error("Can't load binary features, '" + sourceName + "' has an unsupported version (" + std::to_string(header.version) +
+                                 ") !");
+
+    // Records larger than 4 floats are accepted, the trailing bytes of each record are skipped
+    constexpr std::size_t minRecordSize = 4 * sizeof(float);
+    if (header.recordSize < minRecordSize)
+        throw std::runtime_error("Can't load binary features, '" + sourceName + "' has an invalid record size !");
+    if (header.count > (size - sizeof(FeatsBinaryHeader)) / header.recordSize)
+        throw std::runtime_error("Can't load binary features, '" + sourceName + "' is truncated !");
+
+    const char* records = data + sizeof(FeatsBinaryHeader);
+    vec_feat.resize(header.count);
+    for (std::size_t i = 0; i < header.count; ++i)
+    {
+        float values[4];
+        std::memcpy(values, records + i * header.recordSize, minRecordSize);
+        vec_feat[i] = typename FeaturesT::value_type(values[0], values[1], values[2], values[3]);
+    }
+}
+
+/// Read feats from a binary file (memory-mapped)
+template<typename FeaturesT>
+inline void loadFeatsFromBinFile(const std::string& sfileNameFeats, FeaturesT& vec_feat)
+{
+    system::MappedFile file;
+    try
+    {
+        file.open(sfileNameFeats);
+    }
+    catch (const std::exception&)
+    {
+        throw std::runtime_error("Can't load features file, can't open '" + sfileNameFeats + "' !");
+    }
+    loadFeatsFromBinBuffer(file.data(), file.size(), vec_feat, sfileNameFeats);
+}
+
+/// Read feats from file (binary or legacy text format)
 template<typename FeaturesT>
 inline void loadFeatsFromFile(const std::string& sfileNameFeats, FeaturesT& vec_feat)
 {
     vec_feat.clear();
 
+    if (isFeatsBinaryFile(sfileNameFeats))
+    {
+        loadFeatsFromBinFile(sfileNameFeats, vec_feat);
+        return;
+    }
+
     std::ifstream fileIn(sfileNameFeats);
 
     if (!fileIn.is_open())
@@ -104,10 +245,62 @@ inline void loadFeatsFromFile(const std::string& sfileNameFeats, FeaturesT& vec_
     fileIn.close();
 }
 
+/// Write feats to a binary stream
+template<typename FeaturesT>
+inline void saveFeatsToBinStream(std::ostream& file, const FeaturesT& vec_feat)
+{
+    FeatsBinaryHeader header;
+    std::memcpy(header.magic, FeatsBinaryHeader::magicNumber, sizeof(header.magic));
+    header.version = FeatsBinaryHeader::currentVersion;
+    header.recordSize = 4 * sizeof(float);
+    header.count = vec_feat.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(FeatsBinaryHeader));
+
+    // write by blocks to limit the number of calls to the stream
+    constexpr std::size_t blockSize = 4096;
+    std::vector<float> buffer;
+    buffer.reserve(4 * blockSize);
+    for (auto iter = vec_feat.begin(); iter != vec_feat.end();)
+    {
+        buffer.clear();
+        for (std::size_t i = 0; i < blockSize && iter != vec_feat.end(); ++i, ++iter)
+        {
+            buffer.push_back(iter->x());
+            buffer.push_back(iter->y());
+            buffer.push_back(iter->scale());
+            buffer.push_back(iter->orientation());
+        }
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(float));
+    }
+}
+
+/// Write feats to a binary file
+template<typename FeaturesT>
+inline void saveFeatsToBinFile(const std::string& sfileNameFeats, const FeaturesT& vec_feat)
+{
+    std::ofstream file(sfileNameFeats, std::ios::out | std::ios::binary);
+
+    if (!file.is_open())
+        throw std::runtime_error("Can't save features file, can't open '" + sfileNameFeats + "' !");
+
+    saveFeatsToBinStream(file, vec_feat);
+
+    if (!file.good())
+        throw std::runtime_error("Can't save features file, '" + sfileNameFeats + "' is incorrect !");
+
+    file.close();
+}
+
 /// Write feats to file
 template<typename FeaturesT>
-inline void saveFeatsToFile(const std::string& sfileNameFeats, FeaturesT& vec_feat)
+inline void saveFeatsToFile(const std::string& sfileNameFeats, const FeaturesT& vec_feat, EFeatsFileFormat format = EFeatsFileFormat::Text)
 {
+    if (format == EFeatsFileFormat::Binary)
+    {
+        saveFeatsToBinFile(sfileNameFeats, vec_feat);
+        return;
+    }
+
     std::ofstream file(sfileNameFeats);
 
     if (!file.is_open())
@@ -54,6 +54,12 @@ class Regions
   public:
     void LoadFeatures(const std::string& sfileNameFeats) { loadFeatsFromFile(sfileNameFeats, _vec_feats); }
 
+    /// Load features from a memory buffer in the binary features format.
+    void LoadFeaturesFromBuffer(const char* data, std::size_t size, const std::string& sourceName)
+    {
+        loadFeatsFromBinBuffer(data, size, _vec_feats, sourceName);
+    }
+
     PointFeatures GetRegionsPositions() const { return PointFeatures(_vec_feats.begin(), _vec_feats.end()); }
 
     Vec2 GetRegionPosition(std::size_t i) const { return Vec2f(_vec_feats[i].coords()).cast<double>(); }
@@ -75,6 +81,12 @@ class Regions
 
     virtual void SaveDesc(const std::string& sfileNameDescs) const = 0;
 
+    /// Reload only the descriptors (e.g. after clearDescriptors).
+    virtual void LoadDesc(const std::string& sfileNameDescs) = 0;
+
+    /// Load the descriptors from a memory buffer in the binary descriptors format.
+    virtual void LoadDescFromBuffer(const char* data, std::size_t size, const std::string& sourceName) = 0;
+
     //--
     //- Basic description of a descriptor [Type, Length]
     //--
@@ -101,6 +113,12 @@ class Regions
 
     virtual void clearDescriptors() = 0;
 
+    /// Return true if the descriptors are in memory (or if there is no region at all).
+    virtual bool hasDescriptors() const = 0;
+
+    /// Return the memory used by the descriptors array in bytes.
+    virtual std::size_t DescriptorsMemorySize() const = 0;
+
     /// Return the squared distance between two descriptors
     // A default metric is used according the descriptor type:
     // - Scalar: L2,
@@ -170,6 +188,7 @@ class FeatDescRegions : public Regions
     }
 
     /// Export in two separate files the regions and their corresponding descriptors.
+    /// Features are written in the text format readable by all versions, use aliceVision_convertFeatures to opt in to the binary format.
     void Save(const std::string& sfileNameFeats, const std::string& sfileNameDescs) const override
     {
         saveFeatsToFile(sfileNameFeats, this->_vec_feats);
@@ -178,6 +197,13 @@ class FeatDescRegions : public Regions
 
     void SaveDesc(const std::string& sfileNameDescs) const override { saveDescsToBinFile(sfileNameDescs, _vec_descs); }
 
+    void LoadDesc(const std::string& sfileNameDescs) override { loadDescsFromBinFile(sfileNameDescs, _vec_descs); }
+
+    void LoadDescFromBuffer(const char* data, std::size_t size, const std::string& sourceName) override
+    {
+        loadDescsFromBinBuffer(data, size, _vec_descs, sourceName);
+    }
+
     /// Mutable and non-mutable DescriptorT getters.
     inline std::vector<DescriptorT>& Descriptors() { return _vec_descs; }
     inline const std::vector<DescriptorT>& Descriptors() const { return _vec_descs; }
@@ -186,7 +212,11 @@ class FeatDescRegions : public Regions
 
     inline const void* DescriptorRawData() const override { return &_vec_descs[0]; }
 
-    inline void clearDescriptors() override { _vec_descs.clear(); }
+    inline void clearDescriptors() override { DescsT().swap(_vec_descs); }
+
+    inline bool hasDescriptors() const override { return _vec_descs.size() == this->_vec_feats.size(); }
+
+    inline std::size_t DescriptorsMemorySize() const override { return _vec_descs.size() * sizeof(DescriptorT); }
 
     inline void swap(This& other)
     {
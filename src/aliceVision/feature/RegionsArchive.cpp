@@ -0,0 +1,168 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "RegionsArchive.hpp"
+
+#include <aliceVision/system/AlignedStream.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace aliceVision {
+namespace feature {
+
+namespace fs = std::filesystem;
+
+RegionsArchive::RegionsArchive(const std::string& path)
+  : _path(path),
+    _file(path)
+{
+    RegionsArchiveHeader header;
+    if (_file.size() < sizeof(RegionsArchiveHeader))
+        throw std::runtime_error("Can't load regions archive, '" + path + "' is too small !");
+    std::memcpy(&header, _file.data(), sizeof(RegionsArchiveHeader));
+
+    if (std::memcmp(header.magic, RegionsArchiveHeader::magicNumber, sizeof(header.magic)) != 0)
+        throw std::runtime_error("Can't load regions archive, '" + path + "' is not a regions archive !");
+    if (header.version > RegionsArchiveHeader::currentVersion)
+        throw std::runtime_error("Can't load regions archive, '" + path + "' has an unsupported version (" + std::to_string(header.version) + ") !");
+    if (header.entrySize < sizeof(RegionsArchiveEntry) || header.indexOffset > _file.size() ||
+        header.entryCount > (_file.size() - header.indexOffset) / header.entrySize)
+        throw std::runtime_error("Can't load regions archive, '" + path + "' has an invalid index !");
+
+    const char* index = _file.data() + header.indexOffset;
+    for (std::size_t i = 0; i < header.entryCount; ++i)
+    {
+        RegionsArchiveEntry entry;
+        std::memcpy(&entry, index + i * header.entrySize, sizeof(RegionsArchiveEntry));
+
+        if (entry.featOffset + entry.featSize > header.indexOffset || entry.descOffset + entry.descSize > header.indexOffset)
+            throw std::runtime_error("Can't load regions archive, '" + path + "' has an invalid entry for view " + std::to_string(entry.viewId) + " !");
+
+        _entries[EntryKey(entry.viewId, static_cast<EImageDescriberType>(entry.descType))] = entry;
+    }
+}
+
+const RegionsArchiveEntry& RegionsArchive::getEntry(IndexT viewId, EImageDescriberType descType) const
+{
+    const auto it = _entries.find(EntryKey(viewId, descType));
+    if (it == _entries.end())
+        throw std::runtime_error("Can't find view " + std::to_string(viewId) + " " + EImageDescriberType_enumToString(descType) +
+                                 " regions in archive '" + _path + "' !");
+    return it->second;
+}
+
+void RegionsArchive::loadFeatures(IndexT viewId, EImageDescriberType descType, Regions& regions) const
+{
+    const RegionsArchiveEntry& entry = getEntry(viewId, descType);
+    regions.LoadFeaturesFromBuffer(_file.data() + entry.featOffset, entry.featSize, _path + ":" + std::to_string(viewId));
+}
+
+void RegionsArchive::loadDescriptors(IndexT viewId, EImageDescriberType descType, Regions& regions) const
+{
+    const RegionsArchiveEntry& entry = getEntry(viewId, descType);
+    regions.LoadDescFromBuffer(_file.data() + entry.descOffset, entry.descSize, _path + ":" + std::to_string(viewId));
+}
+
+std::size_t writeRegionsArchive(const std::string& featuresFolder, const std::string& archivePath)
+{
+    if (!fs::is_directory(featuresFolder))
+        throw std::invalid_argument("The path '" + featuresFolder + "' is not a valid folder path.");
+
+    std::ofstream file(archivePath, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+        throw std::runtime_error("Can't save regions archive, can't open '" + archivePath + "' !");
+
+    RegionsArchiveHeader header;
+    std::memcpy(header.magic, RegionsArchiveHeader::magicNumber, sizeof(header.magic));
+    header.version = RegionsArchiveHeader::currentVersion;
+    header.entrySize = sizeof(RegionsArchiveEntry);
+    header.entryCount = 0;
+    header.indexOffset = 0;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(RegionsArchiveHeader));
+
+    std::vector<RegionsArchiveEntry> entries;
+
+    for (const auto& pathIt : fs::directory_iterator(featuresFolder))
+    {
+        const fs::path featPath = pathIt.path();
+        if (!fs::is_regular_file(featPath) || featPath.extension() != ".feat")
+            continue;
+
+        // expected filename: <viewId>.<describerType>.feat
+        const fs::path stem = featPath.stem();
+        const std::string viewIdStr = stem.stem().string();
+        const std::string descTypeStr = stem.extension().string();
+        if (viewIdStr.empty() || descTypeStr.size() < 2)
+            continue;
+
+        IndexT viewId;
+        EImageDescriberType descType;
+        try
+        {
+            viewId = static_cast<IndexT>(std::stoul(viewIdStr));
+            descType = EImageDescriberType_stringToEnum(descTypeStr.substr(1));
+        }
+        catch (const std::exception&)
+        {
+            ALICEVISION_LOG_WARNING("Skip unrecognized features file: " << featPath.string());
+            continue;
+        }
+
+        fs::path descPath = featPath;
+        descPath.replace_extension(".desc");
+        if (!fs::is_regular_file(descPath))
+        {
+            ALICEVISION_LOG_WARNING("Skip features file without descriptors: " << featPath.string());
+            continue;
+        }
+
+        RegionsArchiveEntry entry;
+        entry.viewId = viewId;
+        entry.descType = static_cast<std::uint32_t>(descType);
+
+        // features are always stored in the binary format, whatever the format of the input file
+        {
+            PointFeatures features;
+            loadFeatsFromFile(featPath.string(), features);
+            entry.featOffset = system::alignStream(file);
+            saveFeatsToBinStream(file, features);
+            entry.featSize = static_cast<std::uint64_t>(file.tellp()) - entry.featOffset;
+        }
+
+        // descriptors are copied as is
+        {
+            std::ifstream descFile(descPath.string(), std::ios::in | std::ios::binary);
+            if (!descFile.is_open())
+                throw std::runtime_error("Can't load descriptor binary file, can't open '" + descPath.string() + "' !");
+            entry.descOffset = system::alignStream(file);
+            file << descFile.rdbuf();
+            entry.descSize = static_cast<std::uint64_t>(file.tellp()) - entry.descOffset;
+        }
+
+        entries.push_back(entry);
+    }
+
+    header.indexOffset = system::alignStream(file);
+    header.entryCount = entries.size();
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(RegionsArchiveEntry));
+
+    // rewrite the header with the index location
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(RegionsArchiveHeader));
+
+    if (!file.good())
+        throw std::runtime_error("Can't save regions archive, '" + archivePath + "' is incorrect !");
+
+    return entries.size();
+}
+
+}  // namespace feature
+}  // namespace aliceVision
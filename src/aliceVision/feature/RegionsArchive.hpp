@@ -0,0 +1,114 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/Regions.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/system/MappedFile.hpp>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace aliceVision {
+namespace feature {
+
+/**
+ * @brief Header of a regions archive file.
+ *
+ * A regions archive packs the features (.feat) and descriptors (.desc) of all the views
+ * of a features folder in a single file:
+ * [header][feat/desc blobs...][index: entryCount x RegionsArchiveEntry]
+ * Features blobs use the binary features format and descriptors blobs use the binary descriptors format.
+ */
+struct RegionsArchiveHeader
+{
+    static constexpr char magicNumber[8] = {'A', 'V', 'R', 'E', 'G', 'A', 'R', '\0'};
+    static constexpr std::uint32_t currentVersion = 1;
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t entrySize;
+    std::uint64_t entryCount;
+    std::uint64_t indexOffset;
+};
+static_assert(sizeof(RegionsArchiveHeader) == 32, "RegionsArchiveHeader must not be padded");
+
+/**
+ * @brief Index entry of a regions archive: byte ranges of the features and descriptors of one (view, describer).
+ */
+struct RegionsArchiveEntry
+{
+    std::uint32_t viewId;
+    std::uint32_t descType;
+    std::uint64_t featOffset;
+    std::uint64_t featSize;
+    std::uint64_t descOffset;
+    std::uint64_t descSize;
+};
+static_assert(sizeof(RegionsArchiveEntry) == 40, "RegionsArchiveEntry must not be padded");
+
+/**
+ * @brief Read-only access to a regions archive.
+ * The archive is memory-mapped: only the index is parsed at opening and regions
+ * are decoded on demand. Loading functions are thread-safe.
+ */
+class RegionsArchive
+{
+  public:
+    /// Default file name of a regions archive inside a features folder
+    static constexpr const char* defaultFilename = "regions.archive";
+
+    /**
+     * @brief Open a regions archive.
+     * @param[in] path the archive file path
+     * @throw std::runtime_error if the file is not a valid regions archive
+     */
+    explicit RegionsArchive(const std::string& path);
+
+    const std::string& getPath() const { return _path; }
+
+    /// Number of (view, describer) entries in the archive
+    std::size_t size() const { return _entries.size(); }
+
+    bool hasRegions(IndexT viewId, EImageDescriberType descType) const { return _entries.count(EntryKey(viewId, descType)) > 0; }
+
+    /// Load the features of one view into the given regions.
+    void loadFeatures(IndexT viewId, EImageDescriberType descType, Regions& regions) const;
+
+    /// Load the descriptors of one view into the given regions.
+    void loadDescriptors(IndexT viewId, EImageDescriberType descType, Regions& regions) const;
+
+    /// Load the features and the descriptors of one view into the given regions.
+    void loadRegions(IndexT viewId, EImageDescriberType descType, Regions& regions) const
+    {
+        loadFeatures(viewId, descType, regions);
+        loadDescriptors(viewId, descType, regions);
+    }
+
+  private:
+    using EntryKey = std::pair<IndexT, EImageDescriberType>;
+
+    const RegionsArchiveEntry& getEntry(IndexT viewId, EImageDescriberType descType) const;
+
+    std::string _path;
+    system::MappedFile _file;
+    std::map<EntryKey, RegionsArchiveEntry> _entries;
+};
+
+/**
+ * @brief Pack all the regions files (<viewId>.<describer>.feat/.desc) of a features folder in a regions archive.
+ * @param[in] featuresFolder the folder containing the features and descriptors files
+ * @param[in] archivePath the output archive file path
+ * @return the number of (view, describer) entries written in the archive
+ */
+std::size_t writeRegionsArchive(const std::string& featuresFolder, const std::string& archivePath);
+
+}  // namespace feature
+}  // namespace aliceVision
@@ -12,7 +12,11 @@
 #include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 
+#include <condition_variable>
+#include <functional>
+#include <list>
 #include <memory>
+#include <mutex>
 
 namespace aliceVision {
 namespace feature {
@@ -61,10 +65,44 @@ inline std::vector<feature::EImageDescriberType> getCommonDescTypes(const MapFea
 
 /**
  * @brief Container for all Regions (Features and Descriptors) for each View.
+ *
+ * Descriptors can optionally be paged: features stay in memory while descriptors
+ * are loaded on demand through a loader callback and evicted in least-recently-used
+ * order when they exceed a memory budget. Code that reads descriptors must then
+ * hold a DescriptorsLock on the corresponding regions.
  */
 class RegionsPerView
 {
   public:
+    /// Callback used to (re)load the descriptors of the given regions
+    using DescriptorsLoader = std::function<void(IndexT viewId, feature::EImageDescriberType descType, feature::Regions& regions)>;
+
+    /**
+     * @brief RAII helper that keeps the descriptors of one view in memory.
+     * It does nothing if descriptors paging is disabled.
+     */
+    class DescriptorsLock
+    {
+      public:
+        DescriptorsLock(const RegionsPerView& regionsPerView, IndexT viewId, feature::EImageDescriberType descType)
+          : _regionsPerView(regionsPerView),
+            _viewId(viewId),
+            _descType(descType)
+        {
+            _regionsPerView.acquireDescriptors(_viewId, _descType);
+        }
+
+        ~DescriptorsLock() { _regionsPerView.releaseDescriptors(_viewId, _descType); }
+
+        DescriptorsLock(const DescriptorsLock&) = delete;
+        DescriptorsLock& operator=(const DescriptorsLock&) = delete;
+
+      private:
+        const RegionsPerView& _regionsPerView;
+        IndexT _viewId;
+        feature::EImageDescriberType _descType;
+    };
+
     MapRegionsPerView& getData() { return _data; }
 
     const MapRegionsPerView& getData() const { return _data; }
@@ -115,8 +153,159 @@ class RegionsPerView
         }
     }
 
+    /**
+     * @brief Enable the on-demand loading of descriptors.
+     * Descriptors already in memory are accounted in the budget and can be evicted.
+     * @param[in] loader callback used to load the descriptors of one view
+     * @param[in] maxDescriptorsMemory memory budget for the unlocked descriptors in bytes
+     */
+    void enableDescriptorsPaging(DescriptorsLoader loader, std::size_t maxDescriptorsMemory)
+    {
+        std::lock_guard<std::mutex> lock(_pagingMutex);
+        _descriptorsLoader = std::move(loader);
+        _maxDescriptorsMemory = maxDescriptorsMemory;
+        _descriptorsMemory = 0;
+        _pages.clear();
+        _lruPages.clear();
+
+        for (const auto& viewRegions : _data)
+        {
+            for (const auto& descRegions : viewRegions.second)
+            {
+                const std::size_t memory = descRegions.second->DescriptorsMemorySize();
+                if (memory == 0)
+                    continue;
+                const PageKey key(viewRegions.first, descRegions.first);
+                _descriptorsMemory += memory;
+                _lruPages.push_front(key);
+                _pages.emplace(key, Page{0, false, _lruPages.begin()});
+            }
+        }
+        evictDescriptors();
+    }
+
+    bool isDescriptorsPagingEnabled() const { return static_cast<bool>(_descriptorsLoader); }
+
+    /// Memory currently used by the descriptors handled by the paging in bytes.
+    std::size_t getDescriptorsMemory() const
+    {
+        std::lock_guard<std::mutex> lock(_pagingMutex);
+        return _descriptorsMemory;
+    }
+
+    /**
+     * @brief Ensure the descriptors of the given regions are in memory and lock them.
+     * Each call must be balanced by a call to releaseDescriptors (see DescriptorsLock).
+     * The descriptors are loaded outside of the paging mutex, so different views are loaded concurrently.
+     * Threads requesting a view being loaded wait for the end of the loading.
+     */
+    void acquireDescriptors(IndexT viewId, feature::EImageDescriberType descType) const
+    {
+        if (!isDescriptorsPagingEnabled())
+            return;
+
+        feature::Regions& regions = *(_data.at(viewId).at(descType));
+
+        std::unique_lock<std::mutex> lock(_pagingMutex);
+        const PageKey key(viewId, descType);
+        auto pageIt = _pages.find(key);
+        if (pageIt == _pages.end())
+            pageIt = _pages.emplace(key, Page{0, false, _lruPages.end()}).first;
+        Page& page = pageIt->second;
+
+        // a locked page is not in the LRU list, so it cannot be evicted while it is loaded
+        if (page.lockCount == 0 && page.lruIt != _lruPages.end())
+        {
+            _lruPages.erase(page.lruIt);
+            page.lruIt = _lruPages.end();
+        }
+        ++page.lockCount;
+
+        _pagingCondition.wait(lock, [&page]() { return !page.loading; });
+
+        if (regions.hasDescriptors())
+            return;
+
+        page.loading = true;
+        lock.unlock();
+        try
+        {
+            _descriptorsLoader(viewId, descType, regions);
+        }
+        catch (...)
+        {
+            lock.lock();
+            page.loading = false;
+            unlockPage(key, page);
+            _pagingCondition.notify_all();
+            throw;
+        }
+        lock.lock();
+        page.loading = false;
+        _descriptorsMemory += regions.DescriptorsMemorySize();
+        evictDescriptors();
+        _pagingCondition.notify_all();
+    }
+
+    /// Unlock the descriptors of the given regions, they may be evicted afterwards.
+    void releaseDescriptors(IndexT viewId, feature::EImageDescriberType descType) const
+    {
+        if (!isDescriptorsPagingEnabled())
+            return;
+
+        std::lock_guard<std::mutex> lock(_pagingMutex);
+        const PageKey key(viewId, descType);
+        unlockPage(key, _pages.at(key));
+    }
+
   private:
+    using PageKey = std::pair<IndexT, feature::EImageDescriberType>;
+
+    struct Page
+    {
+        int lockCount;
+        /// true while a thread loads the descriptors, outside of the paging mutex
+        bool loading;
+        /// position in the LRU list if the page is resident and unlocked, end() otherwise
+        std::list<PageKey>::iterator lruIt;
+    };
+
+    /// Decrement the lock count of a page and make it evictable when it reaches zero (paging mutex must be held).
+    void unlockPage(const PageKey& key, Page& page) const
+    {
+        assert(page.lockCount > 0);
+        if (--page.lockCount == 0)
+        {
+            _lruPages.push_front(key);
+            page.lruIt = _lruPages.begin();
+            evictDescriptors();
+        }
+    }
+
+    /// Evict the least recently used unlocked descriptors until the budget is respected (paging mutex must be held).
+    void evictDescriptors() const
+    {
+        while (_descriptorsMemory > _maxDescriptorsMemory && !_lruPages.empty())
+        {
+            const PageKey key = _lruPages.back();
+            _lruPages.pop_back();
+            _pages.at(key).lruIt = _lruPages.end();
+
+            feature::Regions& regions = *(_data.at(key.first).at(key.second));
+            _descriptorsMemory -= regions.DescriptorsMemorySize();
+            regions.clearDescriptors();
+        }
+    }
+
     MapRegionsPerView _data;
+
+    DescriptorsLoader _descriptorsLoader;
+    std::size_t _maxDescriptorsMemory = 0;
+    mutable std::size_t _descriptorsMemory = 0;
+    mutable std::mutex _pagingMutex;
+    mutable std::condition_variable _pagingCondition;
+    mutable std::map<PageKey, Page> _pages;
+    mutable std::list<PageKey> _lruPages;
 };
 
 }  // namespace feature
@@ -6,10 +6,16 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "aliceVision/feature/feature.hpp"
+#include "aliceVision/feature/RegionsArchive.hpp"
+#include "aliceVision/feature/RegionsPerView.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <filesystem>
 #include <iostream>
 #include <fstream>
 #include <iterator>
+#include <thread>
 #include <vector>
 
 #define BOOST_TEST_MODULE Feature
@@ -72,6 +78,75 @@ BOOST_AUTO_TEST_CASE(featureIO_ASCII)
     }
 }
 
+BOOST_AUTO_TEST_CASE(featureIO_BINARY)
+{
+    Feats_T vec_feats;
+    for (int i = 0; i < CARD; ++i)
+    {
+        vec_feats.push_back(Feature_T(i + 0.5f, i * 2.25f, i * 3, i * 0.1f));
+    }
+
+    // Save them to a binary file
+    BOOST_CHECK_NO_THROW(saveFeatsToFile("tempFeatsBin.feat", vec_feats, EFeatsFileFormat::Binary));
+    BOOST_CHECK(isFeatsBinaryFile("tempFeatsBin.feat"));
+
+    // The generic loader detects the binary format
+    Feats_T vec_feats_read;
+    BOOST_CHECK_NO_THROW(loadFeatsFromFile("tempFeatsBin.feat", vec_feats_read));
+    BOOST_CHECK_EQUAL(CARD, vec_feats_read.size());
+
+    for (int i = 0; i < CARD; ++i)
+    {
+        BOOST_CHECK_EQUAL(vec_feats[i], vec_feats_read[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(featureIO_BINARY_LEGACY_TEXT)
+{
+    Feats_T vec_feats;
+    for (int i = 0; i < CARD; ++i)
+    {
+        vec_feats.push_back(Feature_T(i, i * 2, i * 3, i * 4));
+    }
+
+    // A legacy text file is still readable
+    BOOST_CHECK_NO_THROW(saveFeatsToFile("tempFeatsText.feat", vec_feats, EFeatsFileFormat::Text));
+    BOOST_CHECK(!isFeatsBinaryFile("tempFeatsText.feat"));
+
+    Feats_T vec_feats_read;
+    BOOST_CHECK_NO_THROW(loadFeatsFromFile("tempFeatsText.feat", vec_feats_read));
+    BOOST_CHECK_EQUAL(CARD, vec_feats_read.size());
+
+    for (int i = 0; i < CARD; ++i)
+    {
+        BOOST_CHECK_EQUAL(vec_feats[i], vec_feats_read[i]);
+    }
+
+    // A truncated binary file is rejected
+    {
+        std::ofstream file("tempFeatsTruncated.feat", std::ios::out | std::ios::binary);
+        FeatsBinaryHeader header;
+        std::memcpy(header.magic, FeatsBinaryHeader::magicNumber, sizeof(header.magic));
+        header.version = FeatsBinaryHeader::currentVersion;
+        header.recordSize = 4 * sizeof(float);
+        header.count = CARD;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    BOOST_CHECK_THROW(loadFeatsFromFile("tempFeatsTruncated.feat", vec_feats_read), std::exception);
+
+    // A binary file with another version than the current one is rejected
+    {
+        std::ofstream file("tempFeatsVersion.feat", std::ios::out | std::ios::binary);
+        FeatsBinaryHeader header;
+        std::memcpy(header.magic, FeatsBinaryHeader::magicNumber, sizeof(header.magic));
+        header.version = 0;
+        header.recordSize = 4 * sizeof(float);
+        header.count = 0;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    BOOST_CHECK_THROW(loadFeatsFromFile("tempFeatsVersion.feat", vec_feats_read), std::runtime_error);
+}
+
 //--
 //-- Descriptors interface test
 //--
@@ -129,3 +204,126 @@ BOOST_AUTO_TEST_CASE(descriptorIO_BINARY)
             BOOST_CHECK_EQUAL(vec_descs[i][j], vec_descs_read[i][j]);
     }
 }
+
+//--
+//-- Regions archive and descriptors paging test
+//--
+BOOST_AUTO_TEST_CASE(regionsArchive_roundTrip_and_paging)
+{
+    namespace fs = std::filesystem;
+    const fs::path folder = fs::path("tempRegionsArchive");
+    fs::create_directories(folder);
+
+    const int nbViews = 4;
+    std::vector<SIFT_Regions> regionsPerView(nbViews);
+    for (int v = 0; v < nbViews; ++v)
+    {
+        for (int i = 0; i < CARD; ++i)
+        {
+            regionsPerView[v].Features().push_back(PointFeature(v + i, i * 2, i * 3, i * 4));
+            SIFT_Regions::DescriptorT desc;
+            for (int j = 0; j < SIFT_Regions::DescriptorT::static_size; ++j)
+                desc[j] = static_cast<unsigned char>(v + i + j);
+            regionsPerView[v].Descriptors().push_back(desc);
+        }
+        const std::string basename = (folder / (std::to_string(v) + ".sift")).string();
+        regionsPerView[v].Save(basename + ".feat", basename + ".desc");
+    }
+
+    const std::string archivePath = (folder / RegionsArchive::defaultFilename).string();
+    BOOST_CHECK_EQUAL(writeRegionsArchive(folder.string(), archivePath), nbViews);
+
+    RegionsArchive archive(archivePath);
+    BOOST_CHECK_EQUAL(archive.size(), nbViews);
+    BOOST_CHECK(!archive.hasRegions(nbViews, EImageDescriberType::SIFT));
+
+    RegionsPerView paged;
+    for (int v = 0; v < nbViews; ++v)
+    {
+        BOOST_CHECK(archive.hasRegions(v, EImageDescriberType::SIFT));
+        SIFT_Regions* regions = new SIFT_Regions();
+        archive.loadFeatures(v, EImageDescriberType::SIFT, *regions);
+        BOOST_CHECK(regions->Features() == regionsPerView[v].Features());
+        BOOST_CHECK(!regions->hasDescriptors());
+        paged.addRegions(v, EImageDescriberType::SIFT, regions);
+    }
+
+    // budget for 2 views of descriptors
+    const std::size_t budget = 2 * regionsPerView[0].DescriptorsMemorySize();
+    paged.enableDescriptorsPaging([&archive](IndexT viewId, EImageDescriberType descType, Regions& regions) {
+        archive.loadDescriptors(viewId, descType, regions);
+    }, budget);
+
+    for (int v = 0; v < nbViews; ++v)
+    {
+        RegionsPerView::DescriptorsLock lock(paged, v, EImageDescriberType::SIFT);
+        const SIFT_Regions& regions = dynamic_cast<const SIFT_Regions&>(paged.getRegions(v, EImageDescriberType::SIFT));
+        BOOST_CHECK(regions.hasDescriptors());
+        for (int i = 0; i < CARD; ++i)
+            BOOST_CHECK(regions.Descriptors()[i] == regionsPerView[v].Descriptors()[i]);
+        BOOST_CHECK_LE(paged.getDescriptorsMemory(), budget);
+    }
+
+    // the oldest descriptors have been evicted
+    BOOST_CHECK(!paged.getRegions(0, EImageDescriberType::SIFT).hasDescriptors());
+    BOOST_CHECK(paged.getRegions(nbViews - 1, EImageDescriberType::SIFT).hasDescriptors());
+
+    fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(regionsPerView_concurrentPaging)
+{
+    const int nbViews = 8;
+    std::vector<SIFT_Regions::DescsT> descriptorsPerView(nbViews);
+
+    RegionsPerView paged;
+    for (int v = 0; v < nbViews; ++v)
+    {
+        SIFT_Regions* regions = new SIFT_Regions();
+        for (int i = 0; i < CARD; ++i)
+        {
+            regions->Features().push_back(PointFeature(v + i, i, i, i));
+            SIFT_Regions::DescriptorT desc;
+            for (int j = 0; j < SIFT_Regions::DescriptorT::static_size; ++j)
+                desc[j] = static_cast<unsigned char>(v + i + j);
+            descriptorsPerView[v].push_back(desc);
+        }
+        paged.addRegions(v, EImageDescriberType::SIFT, regions);
+    }
+
+    // slow loader counting the loads per view and the concurrent loads
+    std::vector<std::atomic<int>> nbLoads(nbViews);
+    std::atomic<int> nbConcurrentLoads(0);
+    std::atomic<int> maxConcurrentLoads(0);
+    paged.enableDescriptorsPaging(
+      [&](IndexT viewId, EImageDescriberType descType, Regions& regions) {
+          const int nbCurrent = ++nbConcurrentLoads;
+          int maxCurrent = maxConcurrentLoads;
+          while (nbCurrent > maxCurrent && !maxConcurrentLoads.compare_exchange_weak(maxCurrent, nbCurrent))
+              ;
+          std::this_thread::sleep_for(std::chrono::milliseconds(20));
+          dynamic_cast<SIFT_Regions&>(regions).Descriptors() = descriptorsPerView[viewId];
+          ++nbLoads[viewId];
+          --nbConcurrentLoads;
+      },
+      nbViews * descriptorsPerView[0].size() * sizeof(SIFT_Regions::DescriptorT));
+
+    // every view is requested by 4 threads at the same time
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4 * nbViews; ++t)
+    {
+        threads.emplace_back([&paged, &descriptorsPerView, t]() {
+            const int v = t % nbViews;
+            RegionsPerView::DescriptorsLock lock(paged, v, EImageDescriberType::SIFT);
+            const SIFT_Regions& regions = dynamic_cast<const SIFT_Regions&>(paged.getRegions(v, EImageDescriberType::SIFT));
+            BOOST_CHECK(regions.Descriptors() == descriptorsPerView[v]);
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    // each view is loaded once, and different views are loaded concurrently
+    for (int v = 0; v < nbViews; ++v)
+        BOOST_CHECK_EQUAL(nbLoads[v], 1);
+    BOOST_CHECK_GT(maxConcurrentLoads, 1);
+}
@@ -9,6 +9,8 @@
 #include <aliceVision/fuseCut/Fuser.hpp>
 #include <aliceVision/fuseCut/PointCloud.hpp>
 #include <aliceVision/fuseCut/GraphFiller.hpp>
+#include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/MaxFlow_CSR.hpp>
 
 #include <boost/math/constants/constants.hpp>
 
@@ -20,6 +22,7 @@
 #include <boost/test/tools/floating_point_comparison.hpp>
 
 #include <filesystem>
+#include <random>
 
 using namespace aliceVision;
 using namespace aliceVision::fuseCut;
@@ -115,6 +118,61 @@ BOOST_AUTO_TEST_CASE(fuseCut_delaunayGraphCut)
     ALICEVISION_LOG_TRACE("CreateGraphCut Done.");
 }
 
+BOOST_AUTO_TEST_CASE(fuseCut_maxFlowCSR)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> pointDistribution(-1.0, 1.0);
+    std::uniform_real_distribution<float> weightDistribution(0.0f, 10.0f);
+
+    std::vector<Point3d> vertices(1000);
+    for (Point3d& v : vertices)
+        v = Point3d(pointDistribution(generator), pointDistribution(generator), pointDistribution(generator));
+
+    const Tetrahedralization tetrahedralization(vertices);
+    const std::size_t nbCells = tetrahedralization.nb_cells();
+
+    MaxFlow_AdjList maxFlowAdjList(nbCells);
+    MaxFlow_CSR maxFlowCSR(tetrahedralization);
+
+    for (CellIndex ci = 0; ci < nbCells; ++ci)
+    {
+        // some cells without terminal capacity
+        const float ws = (generator() % 3 == 0) ? weightDistribution(generator) : 0.0f;
+        const float wt = (generator() % 3 == 0) ? weightDistribution(generator) : 0.0f;
+
+        maxFlowAdjList.addNode(ci, ws, wt);
+        maxFlowCSR.addNode(ci, ws, wt);
+    }
+
+    for (CellIndex ci = 0; ci < nbCells; ++ci)
+    {
+        for (VertexIndex k = 0; k < 4; ++k)
+        {
+            const Facet fu(ci, k);
+            const Facet fv = tetrahedralization.mirrorFacet(fu);
+            if (tetrahedralization.isInvalidOrInfiniteCell(fv.cellIndex))
+                continue;
+
+            const float capacity = weightDistribution(generator);
+            const float reverseCapacity = weightDistribution(generator);
+
+            maxFlowAdjList.addEdge(fu.cellIndex, fv.cellIndex, capacity, reverseCapacity);
+            maxFlowCSR.addEdge(fu.cellIndex, fu.localVertexIndex, capacity, reverseCapacity);
+        }
+    }
+
+    const float flowAdjList = maxFlowAdjList.compute();
+    const float flowCSR = maxFlowCSR.compute();
+
+    BOOST_CHECK_CLOSE(flowAdjList, flowCSR, 0.01);
+
+    for (CellIndex ci = 0; ci < nbCells; ++ci)
+    {
+        BOOST_CHECK_EQUAL(maxFlowAdjList.isTarget(ci), maxFlowCSR.isTarget(ci));
+        BOOST_CHECK_EQUAL(maxFlowAdjList.isSource(ci), maxFlowCSR.isSource(ci));
+    }
+}
+
 /**
  * @brief Generate syntesize dataset with succesion of n(size) alignaed regular thetraedron and two camera on the last thetrahedron.
  *
@@ -10,6 +10,8 @@
 #include <aliceVision/utils/filesIO.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
+#include <aliceVision/mvsData/Matrix3x3.hpp>
+#include <aliceVision/mvsData/Matrix3x4.hpp>
 #include <aliceVision/mvsData/Pixel.hpp>
 #include <aliceVision/mvsData/Point2d.hpp>
 #include <aliceVision/mvsData/Stat3d.hpp>
@@ -22,9 +24,12 @@
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
-
 #include <iostream>
+#include <iterator>
+#include <map>
 
 namespace aliceVision {
 namespace fuseCut {
@@ -44,18 +49,147 @@ unsigned long computeNumberOfAllPoints(const mvsUtils::MultiViewParams& mp, int
     return npts;
 }
 
-Fuser::Fuser(const mvsUtils::MultiViewParams& mp)
-  : _mp(mp)
+namespace {
+
+/**
+ * @brief Back-project a row of a T camera depth map and project the 3d points in the R camera.
+ * @note Structure-of-arrays loop vectorized by the compiler.
+ *       Same computation as the per-point Point3d / Matrix operators and MultiViewParams::getPixelFor3DPoint.
+ * @param[in] depthRow the T camera depth map row
+ * @param[in] width the T camera depth map width
+ * @param[in] y the row index
+ * @param[in] tcC the T camera center
+ * @param[in] tcICam the T camera inverse matrix
+ * @param[in] rcP the R camera projection matrix
+ * @param[out] px, py, pz the back-projected 3d points
+ * @param[out] pixX, pixY the 3d points pixel in the R camera (-1 if behind the camera)
+ */
+void reprojectDepthMapRow(const float* depthRow,
+                          int width,
+                          int y,
+                          const Point3d& tcC,
+                          const Matrix3x3& tcICam,
+                          const Matrix3x4& rcP,
+                          double* px,
+                          double* py,
+                          double* pz,
+                          int* pixX,
+                          int* pixY)
+{
+#pragma omp simd
+    for (int x = 0; x < width; ++x)
+    {
+        const double depth = depthRow[x];
+
+        // pixel ray direction
+        const double dx = tcICam.m11 * x + tcICam.m12 * y + tcICam.m13;
+        const double dy = tcICam.m21 * x + tcICam.m22 * y + tcICam.m23;
+        const double dz = tcICam.m31 * x + tcICam.m32 * y + tcICam.m33;
+        const double d = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+        // 3d point
+        const double X = tcC.x + (dx / d) * depth;
+        const double Y = tcC.y + (dy / d) * depth;
+        const double Z = tcC.z + (dz / d) * depth;
+
+        px[x] = X;
+        py[x] = Y;
+        pz[x] = Z;
+
+        // R camera projection, +0.5 is IMPORTANT
+        const double xt = rcP.m11 * X + rcP.m12 * Y + rcP.m13 * Z + rcP.m14;
+        const double yt = rcP.m21 * X + rcP.m22 * Y + rcP.m23 * Z + rcP.m24;
+        const double zt = rcP.m31 * X + rcP.m32 * Y + rcP.m33 * Z + rcP.m34;
+        const bool inFront = (zt > 0);
+
+        pixX[x] = inFront ? int(std::floor(xt / zt + 0.5)) : -1;
+        pixY[x] = inFront ? int(std::floor(yt / zt + 0.5)) : -1;
+    }
+}
+
+}  // namespace
+
+Fuser::Fuser(const mvsUtils::MultiViewParams& mp, std::size_t mapCacheCapacityMB)
+  : _mp(mp),
+    _mapCache(mp, mapCacheCapacityMB)
 {}
 
 Fuser::~Fuser() {}
 
+std::vector<int> Fuser::getLocalityOrder(const std::vector<int>& cams, int nNearestCams) const
+{
+    const int nbCams = int(cams.size());
+
+    // nearest cameras of each camera, sorted by index
+    std::vector<std::vector<int>> neighbours(nbCams);
+
+#pragma omp parallel for
+    for (int c = 0; c < nbCams; ++c)
+    {
+        neighbours[c] = _mp.findNearestCamsFromLandmarks(cams[c], nNearestCams).getData();
+        std::sort(neighbours[c].begin(), neighbours[c].end());
+    }
+
+    // position of each camera in the input list
+    std::map<int, int> camPositions;
+    for (int c = 0; c < nbCams; ++c)
+        camPositions[cams[c]] = c;
+
+    // greedy chain: the next camera is the unvisited neighbour sharing the most nearest cameras with the current one,
+    // so the depth maps read for a camera are still in the cache for the next one
+    std::vector<bool> visited(nbCams, false);
+    std::vector<int> orderedCams;
+    orderedCams.reserve(nbCams);
+
+    for (int start = 0; start < nbCams; ++start)
+    {
+        int current = start;
+
+        while (current >= 0 && !visited[current])
+        {
+            visited[current] = true;
+            orderedCams.push_back(cams[current]);
+
+            int next = -1;
+            std::size_t bestOverlap = 0;
+
+            for (const int tc : neighbours[current])
+            {
+                const auto it = camPositions.find(tc);
+                if (it == camPositions.end() || visited[it->second])
+                    continue;
+
+                std::vector<int> shared;
+                std::set_intersection(neighbours[current].begin(),
+                                      neighbours[current].end(),
+                                      neighbours[it->second].begin(),
+                                      neighbours[it->second].end(),
+                                      std::back_inserter(shared));
+
+                // the neighbour depth maps are already in the cache, +1
+                const std::size_t overlap = shared.size() + 1;
+
+                if (overlap > bestOverlap)
+                {
+                    bestOverlap = overlap;
+                    next = it->second;
+                }
+            }
+
+            current = next;
+        }
+    }
+
+    return orderedCams;
+}
+
 /**
  * @brief
  *
  * @param[in] pixSizeFactor: pixSize tolerance factor
  * @param[in]
  * @param[in] p: 3d point back projected from tc camera
+ * @param[in] pix: p pixel in rc camera (in image)
  * @param[in]
  * @param[in]
  * @param[out] numOfPtsMap
@@ -63,13 +197,14 @@ Fuser::~Fuser() {}
  * @param[in] simMap
  * @param[in] scale
  */
-bool Fuser::updateInSurr(float pixToleranceFactor,
+void Fuser::updateInSurr(float pixToleranceFactor,
                          int pixSizeBall,
                          int pixSizeBallWSP,
-                         Point3d& p,
+                         const Point3d& p,
+                         const Pixel& pix,
                          int rc,
                          int tc,
-                         StaticVector<int>* numOfPtsMap,
+                         std::vector<int>& numOfPtsMap,
                          const image::Image<float>& depthMap,
                          const image::Image<float>& simMap,
                          int scale)
@@ -77,13 +212,6 @@ bool Fuser::updateInSurr(float pixToleranceFactor,
     int w = _mp.getWidth(rc) / scale;
     int h = _mp.getHeight(rc) / scale;
 
-    Pixel pix;
-    _mp.getPixelFor3DPoint(&pix, p, rc);
-    if (!_mp.isPixelInImage(pix, rc))
-    {
-        return false;
-    }
-
     Pixel cell = pix;
     cell.x /= scale;
     cell.y /= scale;
@@ -106,19 +234,13 @@ bool Fuser::updateInSurr(float pixToleranceFactor,
     {
         for (ncell.y = std::max(0, cell.y - d); ncell.y <= std::min(h - 1, cell.y + d); ncell.y++)
         {
-            // printf("%i %i %i %i %i %i %i %i\n",ncell.x,ncell.y,w,h,w*h,depthMap->size(),cam,scale);
             const float depth = depthMap(ncell.y, ncell.x);
-            // Point3d p1 = _mp.CArr[rc] +
-            // (_mp.iCamArr[rc]*Point2d((float)ncell.x*(float)scale,(float)ncell.y*(float)scale)).normalize()*depth;
-            // if ( (p1-p).size() < pixSize ) {
             if (fabs(pixDepth - depth) < pixSize)
             {
-                (*numOfPtsMap)[ncell.y * w + ncell.x]++;
+                numOfPtsMap[ncell.y * w + ncell.x]++;
             }
         }
     }
-
-    return true;
 }
 
 // minNumOfModals number of other cams including this cam ... minNumOfModals /in 2,3,...
@@ -126,13 +248,18 @@ void Fuser::filterGroups(const std::vector<int>& cams, float pixToleranceFactor,
 {
     ALICEVISION_LOG_INFO("Precomputing groups.");
     long t1 = clock();
-#pragma omp parallel for
-    for (int c = 0; c < cams.size(); c++)
+
+    // process neighbouring cameras together to reuse their depth maps from the cache
+    const std::vector<int> orderedCams = getLocalityOrder(cams, nNearestCams);
+
+#pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < int(orderedCams.size()); c++)
     {
-        int rc = cams[c];
+        int rc = orderedCams[c];
         filterGroupsRC(rc, pixToleranceFactor, pixSizeBall, pixSizeBallWSP, nNearestCams);
     }
 
+    ALICEVISION_LOG_INFO("Depth/sim maps cache: " << _mapCache.getNbHits() << " hits, " << _mapCache.getNbMisses() << " misses.");
     mvsUtils::printfElapsedTime(t1);
 }
 
@@ -148,12 +275,12 @@ bool Fuser::filterGroupsRC(int rc, float pixToleranceFactor, int pixSizeBall, in
     int w = _mp.getWidth(rc);
     int h = _mp.getHeight(rc);
 
-    image::Image<float> depthMap;
-    image::Image<float> simMap;
+    // get depth/sim maps from depthMapEstimation folder (or cache)
+    const mvsUtils::MapCache::MapPtr depthMapPtr = _mapCache.get(rc, mvsUtils::EFileType::depthMap);
+    const mvsUtils::MapCache::MapPtr simMapPtr = _mapCache.get(rc, mvsUtils::EFileType::simMap);
 
-    // read depth/sim maps from depthMapEstimation folder
-    mvsUtils::readMap(rc, _mp, mvsUtils::EFileType::depthMap, depthMap);
-    mvsUtils::readMap(rc, _mp, mvsUtils::EFileType::simMap, simMap);
+    const image::Image<float>& depthMap = *depthMapPtr;
+    const image::Image<float>& simMap = *simMapPtr;
 
     image::Image<unsigned char> numOfModalsMap(w, h, true, 0);
 
@@ -165,41 +292,58 @@ bool Fuser::filterGroupsRC(int rc, float pixToleranceFactor, int pixSizeBall, in
         throw std::runtime_error(s.str());
     }
 
-    StaticVector<int>* numOfPtsMap = new StaticVector<int>();
-    numOfPtsMap->reserve(w * h);
-    numOfPtsMap->resize_with(w * h, 0);
+    // note: the number of points is accumulated over all T cameras
+    std::vector<int> numOfPtsMap(w * h, 0);
 
     StaticVector<int> tcams = _mp.findNearestCamsFromLandmarks(rc, nNearestCams);
 
+    // per row back-projected points and R camera pixels
+    std::vector<double> px, py, pz;
+    std::vector<int> pixX, pixY;
+
     for (int c = 0; c < tcams.size(); c++)
     {
-        numOfPtsMap->resize_with(w * h, 0);
         int tc = tcams[c];
 
-        image::Image<float> tcdepthMap;
-
-        // read Tc depth map from depthMapEstimation folder
-        mvsUtils::readMap(tc, _mp, mvsUtils::EFileType::depthMap, tcdepthMap);
+        // get Tc depth map from depthMapEstimation folder (or cache)
+        const mvsUtils::MapCache::MapPtr tcDepthMapPtr = _mapCache.get(tc, mvsUtils::EFileType::depthMap);
+        const image::Image<float>& tcdepthMap = *tcDepthMapPtr;
 
         if (tcdepthMap.height() > 0 && tcdepthMap.width() > 0)
         {
+            const int tcWidth = tcdepthMap.width();
+
+            px.resize(tcWidth);
+            py.resize(tcWidth);
+            pz.resize(tcWidth);
+            pixX.resize(tcWidth);
+            pixY.resize(tcWidth);
+
             for (int y = 0; y < tcdepthMap.height(); ++y)
             {
-                for (int x = 0; x < tcdepthMap.width(); ++x)
-                {
-                    float depth = tcdepthMap(y, x);
+                const float* depthRow = &tcdepthMap(y, 0);
+
+                reprojectDepthMapRow(
+                  depthRow, tcWidth, y, _mp.CArr[tc], _mp.iCamArr[tc], _mp.camArr[rc], px.data(), py.data(), pz.data(), pixX.data(), pixY.data());
 
-                    if (depth > 0.0f)
+                for (int x = 0; x < tcWidth; ++x)
+                {
+                    if (depthRow[x] > 0.0f)
                     {
-                        Point3d p = _mp.CArr[tc] + (_mp.iCamArr[tc] * Point2d((float)x, (float)y)).normalize() * depth;
-                        updateInSurr(pixToleranceFactor, pixSizeBall, pixSizeBallWSP, p, rc, tc, numOfPtsMap, depthMap, simMap, 1);
+                        const Pixel pix(pixX[x], pixY[x]);
+
+                        if (!_mp.isPixelInImage(pix, rc))
+                            continue;
+
+                        const Point3d p(px[x], py[x], pz[x]);
+                        updateInSurr(pixToleranceFactor, pixSizeBall, pixSizeBallWSP, p, pix, rc, tc, numOfPtsMap, depthMap, simMap, 1);
                     }
                 }
             }
 
             for (int i = 0; i < w * h; i++)
             {
-                numOfModalsMap(i) += static_cast<int>((*numOfPtsMap)[i] > 0);
+                numOfModalsMap(i) += static_cast<int>(numOfPtsMap[i] > 0);
             }
         }
     }
@@ -209,8 +353,6 @@ bool Fuser::filterGroupsRC(int rc, float pixToleranceFactor, int pixSizeBall, in
       numOfModalsMap,
       image::ImageWriteOptions().toColorSpace(image::EImageColorSpace::LINEAR).storageDataType(image::EStorageDataType::Float));
 
-    delete numOfPtsMap;
-
     ALICEVISION_LOG_DEBUG(rc << " solved.");
     mvsUtils::printfElapsedTime(t1);
 
@@ -223,7 +365,7 @@ void Fuser::filterDepthMaps(const std::vector<int>& cams, int minNumOfModals, in
     ALICEVISION_LOG_INFO("Filtering depth maps.");
     long t1 = clock();
 
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic)
     for (int c = 0; c < cams.size(); c++)
     {
         int rc = cams[c];
@@ -238,13 +380,14 @@ bool Fuser::filterDepthMapsRC(int rc, int minNumOfModals, int minNumOfModalsWSP2
 {
     long t1 = clock();
 
-    image::Image<float> depthMap;
-    image::Image<float> simMap;
+    // copy depth/sim maps from depthMapEstimation folder (or cache), modified in place
+    image::Image<float> depthMap = *_mapCache.get(rc, mvsUtils::EFileType::depthMap);
+    image::Image<float> simMap = *_mapCache.get(rc, mvsUtils::EFileType::simMap);
     image::Image<unsigned char> numOfModalsMap;
 
-    // read depth/sim maps from depthMapEstimation folder
-    mvsUtils::readMap(rc, _mp, mvsUtils::EFileType::depthMap, depthMap);
-    mvsUtils::readMap(rc, _mp, mvsUtils::EFileType::simMap, simMap);
+    // the depth/sim maps of this camera are no longer needed
+    _mapCache.invalidate(rc, mvsUtils::EFileType::depthMap);
+    _mapCache.invalidate(rc, mvsUtils::EFileType::simMap);
 
     image::readImage(getFileNameFromIndex(_mp, rc, mvsUtils::EFileType::nmodMap), numOfModalsMap, image::EImageColorSpace::NO_CONVERSION);
 
@@ -7,13 +7,18 @@
 #pragma once
 
 #include <aliceVision/image/Image.hpp>
+#include <aliceVision/mvsUtils/MapCache.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsData/Pixel.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsData/Universe.hpp>
 #include <aliceVision/mvsData/Voxel.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 
+#include <cstddef>
+#include <vector>
+
 namespace aliceVision {
 
 namespace fuseCut {
@@ -23,7 +28,12 @@ class Fuser
   public:
     const mvsUtils::MultiViewParams& _mp;
 
-    Fuser(const mvsUtils::MultiViewParams& mp);
+    /**
+     * @brief Fuser constructor.
+     * @param[in] mp the multi-view parameters
+     * @param[in] mapCacheCapacityMB the maximum memory used to keep depth/sim maps in memory between cameras (in MB)
+     */
+    Fuser(const mvsUtils::MultiViewParams& mp, std::size_t mapCacheCapacityMB = 2048);
     ~Fuser();
 
     // minNumOfModals number of other cams including this cam ... minNumOfModals /in 2,3,... default 3
@@ -41,16 +51,27 @@ class Fuser
     float computeAveragePixelSizeInHexahedron(Point3d* hexah, const sfmData::SfMData& sfmData);
 
   private:
-    bool updateInSurr(float pixToleranceFactor,
+    /**
+     * @brief Get the given cameras ordered to maximize the depth maps reuse between consecutive cameras.
+     * @param[in] cams the cameras to order
+     * @param[in] nNearestCams the number of nearest cameras used per camera
+     * @return the ordered cameras
+     */
+    std::vector<int> getLocalityOrder(const std::vector<int>& cams, int nNearestCams) const;
+
+    void updateInSurr(float pixToleranceFactor,
                       int pixSizeBall,
                       int pixSizeBallWSP,
-                      Point3d& p,
+                      const Point3d& p,
+                      const Pixel& pix,
                       int rc,
                       int tc,
-                      StaticVector<int>* numOfPtsMap,
+                      std::vector<int>& numOfPtsMap,
                       const image::Image<float>& depthMap,
                       const image::Image<float>& simMap,
                       int scale);
+
+    mvsUtils::MapCache _mapCache;  //< fullsize depth/sim maps shared between cameras
 };
 
 unsigned long computeNumberOfAllPoints(const mvsUtils::MultiViewParams& mp, int scale);
@@ -6,16 +6,78 @@
 
 #include "GraphFiller.hpp"
 
+#include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/fuseCut/Intersections.hpp>
-#include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/MaxFlow_CSR.hpp>
 
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/algorithm/string/case_conv.hpp>
 #include <boost/atomic/atomic_ref.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
 
 namespace aliceVision {
 namespace fuseCut {
 
+namespace {
+
+/**
+ * @brief Spread the 21 lower bits of the input, 2 zero bits between each bit.
+ */
+inline std::uint64_t spreadBits(std::uint64_t x)
+{
+    x &= 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffff;
+    x = (x | x << 16) & 0x1f0000ff0000ff;
+    x = (x | x << 8) & 0x100f00f00f00f00f;
+    x = (x | x << 4) & 0x10c30c30c30c30c3;
+    x = (x | x << 2) & 0x1249249249249249;
+    return x;
+}
+
+}  // namespace
+
+std::string EGraphFillerAccumulation_enumToString(EGraphFillerAccumulation accumulation)
+{
+    switch (accumulation)
+    {
+        case EGraphFillerAccumulation::ATOMIC:
+            return "atomic";
+        case EGraphFillerAccumulation::THREAD_BUFFERS:
+            return "threadBuffers";
+    }
+    throw std::out_of_range("Invalid graph filler accumulation enum");
+}
+
+EGraphFillerAccumulation EGraphFillerAccumulation_stringToEnum(const std::string& accumulation)
+{
+    std::string a = accumulation;
+    boost::to_lower(a);
+
+    if (a == "atomic")
+        return EGraphFillerAccumulation::ATOMIC;
+    if (a == "threadbuffers")
+        return EGraphFillerAccumulation::THREAD_BUFFERS;
+    throw std::out_of_range("Invalid graph filler accumulation: " + accumulation);
+}
+
+std::ostream& operator<<(std::ostream& os, EGraphFillerAccumulation accumulation) { return os << EGraphFillerAccumulation_enumToString(accumulation); }
+
+std::istream& operator>>(std::istream& in, EGraphFillerAccumulation& accumulation)
+{
+    std::string token(std::istreambuf_iterator<char>(in), {});
+    accumulation = EGraphFillerAccumulation_stringToEnum(token);
+    return in;
+}
+
 GraphFiller::GraphFiller(mvsUtils::MultiViewParams& mp, 
                         const PointCloud & pc, 
                         const Tetrahedralization & tetrahedralization)
@@ -24,7 +86,8 @@ GraphFiller::GraphFiller(mvsUtils::MultiViewParams& mp,
   _verticesCoords(pc.getVertices()),
   _verticesAttr(pc.getVerticesAttrs()),
   _camsVertexes(pc.getCameraIndices()),
-  _tetrahedralization(tetrahedralization)
+  _tetrahedralization(tetrahedralization),
+  _accumulation(EGraphFillerAccumulation_stringToEnum(mp.userParams.get<std::string>("delaunaycut.accumulation", "threadBuffers")))
 {
     initCells();
 }
@@ -79,23 +142,197 @@ void GraphFiller::addToInfiniteSw(float sW)
     }
 }
 
-void GraphFiller::fillGraph(double nPixelSizeBehind, float fullWeight)
+void GraphFiller::applyCellWeight(GC_cellInfo& c, ECellWeight weight, float value)
+{
+    switch (weight)
+    {
+        case ECellWeight::EMPTINESS_SCORE:
+            c.emptinessScore += value;
+            break;
+        case ECellWeight::GEDGE_VIS_WEIGHT_0:
+        case ECellWeight::GEDGE_VIS_WEIGHT_1:
+        case ECellWeight::GEDGE_VIS_WEIGHT_2:
+        case ECellWeight::GEDGE_VIS_WEIGHT_3:
+            c.gEdgeVisWeight[std::size_t(weight) - std::size_t(ECellWeight::GEDGE_VIS_WEIGHT_0)] += value;
+            break;
+        case ECellWeight::CELL_S_WEIGHT_SET:
+            c.cellSWeight = value;
+            break;
+        case ECellWeight::CELL_T_WEIGHT:
+            c.cellTWeight += value;
+            break;
+        case ECellWeight::ON:
+            c.on += value;
+            break;
+    }
+}
+
+void GraphFiller::addCellWeight(CellIndex ci, ECellWeight weight, float value, CellsWeightsDeltas* deltas)
+{
+    if (deltas != nullptr)
+    {
+        (*deltas)[ci / _cellsPartitionSize].push_back({ci, weight, value});
+        return;
+    }
+
+    GC_cellInfo& c = _cellsAttr[ci];
+
+    switch (weight)
+    {
+        case ECellWeight::EMPTINESS_SCORE:
+            boost::atomic_ref<float>{c.emptinessScore} += value;
+            break;
+        case ECellWeight::GEDGE_VIS_WEIGHT_0:
+        case ECellWeight::GEDGE_VIS_WEIGHT_1:
+        case ECellWeight::GEDGE_VIS_WEIGHT_2:
+        case ECellWeight::GEDGE_VIS_WEIGHT_3:
+            boost::atomic_ref<float>{c.gEdgeVisWeight[std::size_t(weight) - std::size_t(ECellWeight::GEDGE_VIS_WEIGHT_0)]} += value;
+            break;
+        case ECellWeight::CELL_S_WEIGHT_SET:
+            boost::atomic_ref<float>{c.cellSWeight} = value;
+            break;
+        case ECellWeight::CELL_T_WEIGHT:
+            boost::atomic_ref<float>{c.cellTWeight} += value;
+            break;
+        case ECellWeight::ON:
+            boost::atomic_ref<float>{c.on} += value;
+            break;
+    }
+}
+
+std::vector<int> GraphFiller::getVerticesSpatialOrder() const
+{
+    const std::size_t nbVertices = _verticesAttr.size();
+
+    // bounding box
+    Point3d minPt(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    Point3d maxPt(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+
+    for (std::size_t vi = 0; vi < nbVertices; ++vi)
+    {
+        const Point3d& p = _verticesCoords[vi];
+        minPt = Point3d(std::min(minPt.x, p.x), std::min(minPt.y, p.y), std::min(minPt.z, p.z));
+        maxPt = Point3d(std::max(maxPt.x, p.x), std::max(maxPt.y, p.y), std::max(maxPt.z, p.z));
+    }
+
+    const double extent = std::max({maxPt.x - minPt.x, maxPt.y - minPt.y, maxPt.z - minPt.z, std::numeric_limits<double>::min()});
+    const double quantization = double(0x1fffff) / extent;
+
+    // Morton code of each vertex
+    std::vector<std::pair<std::uint64_t, int>> codes(nbVertices);
+
+#pragma omp parallel for
+    for (int vi = 0; vi < int(nbVertices); ++vi)
+    {
+        const Point3d& p = _verticesCoords[vi];
+        const std::uint64_t x = std::uint64_t((p.x - minPt.x) * quantization);
+        const std::uint64_t y = std::uint64_t((p.y - minPt.y) * quantization);
+        const std::uint64_t z = std::uint64_t((p.z - minPt.z) * quantization);
+
+        codes[vi] = {spreadBits(x) | (spreadBits(y) << 1) | (spreadBits(z) << 2), vi};
+    }
+
+    std::sort(codes.begin(), codes.end());
+
+    std::vector<int> verticesIds(nbVertices);
+    for (std::size_t i = 0; i < nbVertices; ++i)
+        verticesIds[i] = codes[i].second;
+
+    return verticesIds;
+}
+
+std::vector<int> GraphFiller::getVerticesProcessingOrder(int batchSize, unsigned int seed) const
+{
+    const std::vector<int> spatialOrder = getVerticesSpatialOrder();
+    const int nbVertices = int(spatialOrder.size());
+    // full batches in random order, the last partial batch at the end (batches stay aligned with the loop chunks)
+    const int nbFullBatches = nbVertices / batchSize;
+    const std::vector<int> batchesRandIds = mvsUtils::createRandomArrayOfIntegers(nbFullBatches, seed);
+
+    std::vector<int> verticesIds;
+    verticesIds.reserve(nbVertices);
+
+    for (const int batchIndex : batchesRandIds)
+    {
+        const int begin = batchIndex * batchSize;
+        verticesIds.insert(verticesIds.end(), spatialOrder.begin() + begin, spatialOrder.begin() + begin + batchSize);
+    }
+    verticesIds.insert(verticesIds.end(), spatialOrder.begin() + nbFullBatches * batchSize, spatialOrder.end());
+
+    return verticesIds;
+}
+
+void GraphFiller::processVertices(const std::function<void(int, CellsWeightsDeltas*)>& processVertex)
 {
-    ALICEVISION_LOG_INFO("Computing s-t graph weights.");
+    // process the camera-vertex rays in batches of spatially close vertices:
+    // rays of a batch traverse the same cells (cache-friendly) and concurrent batches rarely update the same cells
+    const int batchSize = _mp.userParams.get<int>("delaunaycut.rayMarchingBatchSize", 256);
+    if (batchSize <= 0)
+        throw std::invalid_argument("Invalid ray marching batch size: " + std::to_string(batchSize) + " (must be strictly positive).");
 
-    // choose random order to prevent waiting
+    // batches in random order to prevent waiting
     const unsigned int seed = (unsigned int)_mp.userParams.get<unsigned int>("delaunaycut.seed", 0);
-    const std::vector<int> verticesRandIds = mvsUtils::createRandomArrayOfIntegers(_verticesAttr.size(), seed);
+    const std::vector<int> verticesIds = getVerticesProcessingOrder(batchSize, seed);
+    const int nbVertices = int(verticesIds.size());
+
+    if (_accumulation == EGraphFillerAccumulation::ATOMIC)
+    {
+#pragma omp parallel for schedule(dynamic, batchSize)
+        for (int i = 0; i < nbVertices; ++i)
+        {
+            processVertex(verticesIds[i], nullptr);
+        }
+        return;
+    }
+
+    // per-thread deltas, bucketed by cells partition
+    const int nbThreads = omp_get_max_threads();
+    const std::size_t nbPartitions = std::size_t(nbThreads) * 4;
+    _cellsPartitionSize = std::max<std::size_t>(1, divideRoundUp(_cellsAttr.size(), nbPartitions));
+
+    std::vector<CellsWeightsDeltas> threadsDeltas(nbThreads, CellsWeightsDeltas(nbPartitions));
 
-#pragma omp parallel for 
-    for (int i = 0; i < verticesRandIds.size(); i++)
+    // the deltas memory is bounded by the number of vertices processed per round
+    const int roundSize = _mp.userParams.get<int>("delaunaycut.accumulationRoundSize", nbThreads * batchSize * 4);
+    if (roundSize <= 0)
+        throw std::invalid_argument("Invalid accumulation round size: " + std::to_string(roundSize) + " (must be strictly positive).");
+
+    for (int roundStart = 0; roundStart < nbVertices; roundStart += roundSize)
     {
-        const int vertexIndex = verticesRandIds[i];
+        const int roundEnd = std::min(nbVertices, roundStart + roundSize);
+
+#pragma omp parallel for schedule(dynamic, batchSize)
+        for (int i = roundStart; i < roundEnd; ++i)
+        {
+            processVertex(verticesIds[i], &threadsDeltas[omp_get_thread_num()]);
+        }
+
+        // each cells partition is updated by a single thread, no atomics
+#pragma omp parallel for schedule(dynamic)
+        for (int p = 0; p < int(nbPartitions); ++p)
+        {
+            for (CellsWeightsDeltas& deltas : threadsDeltas)
+            {
+                for (const CellWeightDelta& delta : deltas[p])
+                {
+                    applyCellWeight(_cellsAttr[delta.cellIndex], delta.weight, delta.value);
+                }
+                deltas[p].clear();
+            }
+        }
+    }
+}
+
+void GraphFiller::fillGraph(double nPixelSizeBehind, float fullWeight)
+{
+    ALICEVISION_LOG_INFO("Computing s-t graph weights (accumulation: " << _accumulation << ").");
+
+    processVertices([&](int vertexIndex, CellsWeightsDeltas* deltas) {
         const GC_vertexInfo& v = _verticesAttr[vertexIndex];
 
         if (!v.isReal())
         {  
-            continue;
+            return;
         }
         
         float weight = (float)v.nrc;  // number of cameras
@@ -105,15 +342,16 @@ void GraphFiller::fillGraph(double nPixelSizeBehind, float fullWeight)
 
         for (int c = 0; c < v.cams.size(); c++)
         {
-            rayMarchingGraphEmpty(vertexIndex, v.cams[c], weight);
-            rayMarchingGraphFull(vertexIndex, v.cams[c], weight* fullWeight, nPixelSizeBehind);
+            rayMarchingGraphEmpty(vertexIndex, v.cams[c], weight, deltas);
+            rayMarchingGraphFull(vertexIndex, v.cams[c], weight* fullWeight, nPixelSizeBehind, deltas);
         }
-    }
+    });
 }
 
 void GraphFiller::rayMarchingGraphEmpty(int vertexIndex,
                                          int cam,
-                                         float weight)
+                                         float weight,
+                                         CellsWeightsDeltas* deltas)
 {
     const int maxint = std::numeric_limits<int>::max();
 
@@ -159,8 +397,8 @@ void GraphFiller::rayMarchingGraphEmpty(int vertexIndex,
         {
             GeometryIntersection previousGeometry = marching.getPreviousIntersection();
 
-            boost::atomic_ref<float>{_cellsAttr[previousGeometry.facet.cellIndex].emptinessScore} += weight;
-            boost::atomic_ref<float>{_cellsAttr[previousGeometry.facet.cellIndex].gEdgeVisWeight[previousGeometry.facet.localVertexIndex]} += weight;
+            addCellWeight(previousGeometry.facet.cellIndex, ECellWeight::EMPTINESS_SCORE, weight, deltas);
+            addCellWeight(previousGeometry.facet.cellIndex, gEdgeVisWeight(previousGeometry.facet.localVertexIndex), weight, deltas);
 
             
             lastIntersectedFacet = geometry.facet;
@@ -169,7 +407,7 @@ void GraphFiller::rayMarchingGraphEmpty(int vertexIndex,
         {
             if (previousGeometry.type == EGeometryType::Facet)
             {
-                boost::atomic_ref<float>{_cellsAttr[previousGeometry.facet.cellIndex].emptinessScore} += weight;
+                addCellWeight(previousGeometry.facet.cellIndex, ECellWeight::EMPTINESS_SCORE, weight, deltas);
             }
 
             if (geometry.type == EGeometryType::Vertex)
@@ -184,21 +422,22 @@ void GraphFiller::rayMarchingGraphEmpty(int vertexIndex,
         // Declare the last part of the empty path as connected to EMPTY (S node in the graph cut)
         if (lastIntersectedFacet.cellIndex != GEO::NO_CELL && (_mp.CArr[cam] - intersectPt).size() < 0.2 * pointCamDistance)
         {
-            boost::atomic_ref<float>{_cellsAttr[lastIntersectedFacet.cellIndex].cellSWeight} = (float)maxint;
+            addCellWeight(lastIntersectedFacet.cellIndex, ECellWeight::CELL_S_WEIGHT_SET, (float)maxint, deltas);
         }
     }
 
     // Vote for the last intersected facet (close to the cam)
     if (lastIntersectedFacet.cellIndex != GEO::NO_CELL)
     {
-        boost::atomic_ref<float>{_cellsAttr[lastIntersectedFacet.cellIndex].cellSWeight} = (float)maxint;
+        addCellWeight(lastIntersectedFacet.cellIndex, ECellWeight::CELL_S_WEIGHT_SET, (float)maxint, deltas);
     }
 }
 
 void GraphFiller::rayMarchingGraphFull(int vertexIndex,
                                          int cam,
                                          float fullWeight,
-                                         double nPixelSizeBehind)
+                                         double nPixelSizeBehind,
+                                         CellsWeightsDeltas* deltas)
 {
     const int maxint = std::numeric_limits<int>::max();
     const Point3d& originPt = _verticesCoords[vertexIndex];
@@ -242,14 +481,14 @@ void GraphFiller::rayMarchingGraphFull(int vertexIndex,
         if (geometry.type == EGeometryType::Facet)
         {
             lastIntersectedFacet = geometry.facet;
-            boost::atomic_ref<float>{_cellsAttr[geometry.facet.cellIndex].gEdgeVisWeight[geometry.facet.localVertexIndex]} += fullWeight;
+            addCellWeight(geometry.facet.cellIndex, gEdgeVisWeight(geometry.facet.localVertexIndex), fullWeight, deltas);
         }
     }
 
     // found facet Vote for the last intersected facet (farthest from the camera)
     if (lastIntersectedFacet.cellIndex != GEO::NO_CELL)
     {
-        boost::atomic_ref<float>{_cellsAttr[lastIntersectedFacet.cellIndex].cellTWeight} += fullWeight;
+        addCellWeight(lastIntersectedFacet.cellIndex, ECellWeight::CELL_T_WEIGHT, fullWeight, deltas);
     }
 }
 
@@ -263,20 +502,12 @@ void GraphFiller::forceTedgesByGradientIJCV(float nPixelSizeBehind)
     const float nsigmaBackSilentPart = 2.0f;
 
 
-    // choose random order to prevent waiting
-    const unsigned int seed = (unsigned int)_mp.userParams.get<unsigned int>("delaunaycut.seed", 0);
-    const std::vector<int> verticesRandIds = mvsUtils::createRandomArrayOfIntegers(_verticesAttr.size(), seed);
-
-
-#pragma omp parallel for
-    for (int i = 0; i < verticesRandIds.size(); ++i)
-    {
-        const int vertexIndex = verticesRandIds[i];
+    processVertices([&](int vertexIndex, CellsWeightsDeltas* deltas) {
         const GC_vertexInfo& v = _verticesAttr[vertexIndex];
         
         if (v.isVirtual())
         {
-            continue;
+            return;
         }
 
         const Point3d& originPt = _verticesCoords[vertexIndex];
@@ -402,7 +633,7 @@ void GraphFiller::forceTedgesByGradientIJCV(float nPixelSizeBehind)
                             }
                             // the information of first intersected cell can only be found by taking intersection of neighbouring cells for both
                             // geometries
-                            const std::vector<CellIndex> previousNeighbouring = _tetrahedralization.getNeighboringCellsByVertexIndex(previousGeometry.vertexIndex);
+                            const CellsRange previousNeighbouring = _tetrahedralization.getNeighboringCellsByVertexIndex(previousGeometry.vertexIndex);
                             const std::vector<CellIndex> currentNeigbouring = getNeighboringCellsByGeometry(geometry);
 
                             std::vector<CellIndex> neighboringCells;
@@ -443,12 +674,12 @@ void GraphFiller::forceTedgesByGradientIJCV(float nPixelSizeBehind)
                         (maxSilent < maxSilentPartRange))            // g < k_outl                  //// k_outl=100  // 400 in the paper
                                                                      //(maxSilent-minSilent<maxSilentPartRange))
                     {
-                        boost::atomic_ref<float>{_cellsAttr[lastIntersectedFacet.cellIndex].on} += (maxJump - midSilent);
+                        addCellWeight(lastIntersectedFacet.cellIndex, ECellWeight::ON, (maxJump - midSilent), deltas);
                     }
                 }
             }
         }
-    }
+    });
 
     for (GC_cellInfo& c : _cellsAttr)
     {
@@ -466,7 +697,10 @@ std::vector<CellIndex> GraphFiller::getNeighboringCellsByGeometry(const Geometry
         case EGeometryType::Edge:
             return _tetrahedralization.getNeighboringCellsByEdge(g.edge);
         case EGeometryType::Vertex:
-            return _tetrahedralization.getNeighboringCellsByVertexIndex(g.vertexIndex);
+        {
+            const CellsRange neighboringCells = _tetrahedralization.getNeighboringCellsByVertexIndex(g.vertexIndex);
+            return std::vector<CellIndex>(neighboringCells.begin(), neighboringCells.end());
+        }
         case EGeometryType::Facet:
             return _tetrahedralization.getNeighboringCellsByFacet(g.facet);
         case EGeometryType::None:
@@ -480,7 +714,7 @@ void GraphFiller::binarize()
 {
     const std::size_t nbCells = _cellsAttr.size();
 
-    MaxFlow_AdjList maxFlowGraph(nbCells);
+    MaxFlow_CSR maxFlowGraph(_tetrahedralization);
 
     // fill s-t edges
     for (CellIndex ci = 0; ci < nbCells; ++ci)
@@ -521,7 +755,7 @@ void GraphFiller::binarize()
             float wFvFu = _cellsAttr[fu.cellIndex].gEdgeVisWeight[fu.localVertexIndex] * CONSTalphaVIS + a1 * CONSTalphaPHOTO;
             float wFuFv = _cellsAttr[fv.cellIndex].gEdgeVisWeight[fv.localVertexIndex] * CONSTalphaVIS + a2 * CONSTalphaPHOTO;
 
-            maxFlowGraph.addEdge(fu.cellIndex, fv.cellIndex, wFuFv, wFvFu);
+            maxFlowGraph.addEdge(fu.cellIndex, fu.localVertexIndex, wFuFv, wFvFu);
         }
     }
 
@@ -11,10 +11,30 @@
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 #include <aliceVision/fuseCut/Intersections.hpp>
 
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
 
 namespace aliceVision {
 namespace fuseCut {
 
+/**
+ * @brief Accumulation strategy of the ray marching weights in the cells attributes.
+ */
+enum class EGraphFillerAccumulation
+{
+    ATOMIC = 0,     //< atomic float updates in the shared cells attributes
+    THREAD_BUFFERS  //< per-thread deltas merged per cells partition (no atomics, no false sharing)
+};
+
+std::string EGraphFillerAccumulation_enumToString(EGraphFillerAccumulation accumulation);
+EGraphFillerAccumulation EGraphFillerAccumulation_stringToEnum(const std::string& accumulation);
+std::ostream& operator<<(std::ostream& os, EGraphFillerAccumulation accumulation);
+std::istream& operator>>(std::istream& in, EGraphFillerAccumulation& accumulation);
+
 class GraphFiller
 {
 public:
@@ -35,12 +55,71 @@ public:
     void binarize();
 
 private:
+    /// cell weight updated by the ray marching
+    enum class ECellWeight : std::uint8_t
+    {
+        EMPTINESS_SCORE = 0,
+        GEDGE_VIS_WEIGHT_0,
+        GEDGE_VIS_WEIGHT_1,
+        GEDGE_VIS_WEIGHT_2,
+        GEDGE_VIS_WEIGHT_3,
+        CELL_S_WEIGHT_SET,
+        CELL_T_WEIGHT,
+        ON
+    };
+
+    struct CellWeightDelta
+    {
+        CellIndex cellIndex;
+        ECellWeight weight;
+        float value;
+    };
+
+    /// thread deltas, one list per cells partition
+    using CellsWeightsDeltas = std::vector<std::vector<CellWeightDelta>>;
+
+    static inline ECellWeight gEdgeVisWeight(VertexIndex localVertexIndex)
+    {
+        return ECellWeight(std::size_t(ECellWeight::GEDGE_VIS_WEIGHT_0) + localVertexIndex);
+    }
+
+    static void applyCellWeight(GC_cellInfo& c, ECellWeight weight, float value);
+
+    /**
+     * @brief Update a cell weight, directly (atomic) or through the given thread deltas.
+     * @param[in] ci the cell index
+     * @param[in] weight the cell weight to update
+     * @param[in] value the value to add (or set for CELL_S_WEIGHT_SET)
+     * @param[in,out] deltas the thread deltas (nullptr in ATOMIC accumulation)
+     */
+    void addCellWeight(CellIndex ci, ECellWeight weight, float value, CellsWeightsDeltas* deltas);
+
+    /**
+     * @brief Call the given function on all vertices in parallel, using the accumulation strategy.
+     * @param[in] processVertex the function called with a vertex index and the thread deltas (nullptr in ATOMIC accumulation)
+     */
+    void processVertices(const std::function<void(int, CellsWeightsDeltas*)>& processVertex);
+
     void initCells();
     void addToInfiniteSw(float sW);
 
+    /**
+     * @brief Get the vertex indices sorted along a Morton curve (spatially close vertices are consecutive).
+     * @return the sorted vertex indices
+     */
+    std::vector<int> getVerticesSpatialOrder() const;
+
+    /**
+     * @brief Get the vertex indices processing order: batches of spatially close vertices, in random order.
+     * @param[in] batchSize the number of vertices per batch
+     * @param[in] seed the random seed of the batches order (0: random device)
+     * @return the sorted vertex indices
+     */
+    std::vector<int> getVerticesProcessingOrder(int batchSize, unsigned int seed) const;
+
     void fillGraph(double nPixelSizeBehind, float fullWeight);
-    void rayMarchingGraphEmpty(int vertexIndex, int cam, float weight);
-    void rayMarchingGraphFull(int vertexIndex, int cam, float fullWeight, double nPixelSizeBehind);
+    void rayMarchingGraphEmpty(int vertexIndex, int cam, float weight, CellsWeightsDeltas* deltas);
+    void rayMarchingGraphFull(int vertexIndex, int cam, float fullWeight, double nPixelSizeBehind, CellsWeightsDeltas* deltas);
     void forceTedgesByGradientIJCV(float nPixelSizeBehind);
     
     std::vector<CellIndex> getNeighboringCellsByGeometry(const GeometryIntersection& g) const;
@@ -55,6 +134,8 @@ private:
     mvsUtils::MultiViewParams& _mp;
     std::vector<GC_cellInfo> _cellsAttr;
     std::vector<bool> _cellIsFull;
+    EGraphFillerAccumulation _accumulation;  //< ray marching weights accumulation strategy
+    std::size_t _cellsPartitionSize = 1;     //< number of cells per partition (THREAD_BUFFERS accumulation)
 };
 
 }
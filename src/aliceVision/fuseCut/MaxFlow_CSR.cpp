@@ -0,0 +1,447 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MaxFlow_CSR.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <map>
+
+namespace aliceVision {
+namespace fuseCut {
+
+MaxFlow_CSR::MaxFlow_CSR(const Tetrahedralization& tetrahedralization)
+{
+    const std::size_t nbNodes = tetrahedralization.nb_cells();
+
+    _head.resize(nbNodes * 4, GEO::NO_CELL);
+    _mirror.resize(nbNodes * 4, 0);
+    _rCap.resize(nbNodes * 4, 0.f);
+    _trCap.resize(nbNodes, 0.f);
+
+#pragma omp parallel for
+    for (std::int64_t ci = 0; ci < std::int64_t(nbNodes); ++ci)
+    {
+        for (VertexIndex k = 0; k < 4; ++k)
+        {
+            const Facet mirror = tetrahedralization.mirrorFacet(Facet(CellIndex(ci), k));
+
+            if (mirror.cellIndex == GEO::NO_CELL || mirror.localVertexIndex == GEO::NO_VERTEX)
+                continue;
+
+            const ArcIndex a = arcIndex(CellIndex(ci), k);
+            _head[a] = mirror.cellIndex;
+            _mirror[a] = std::uint8_t(mirror.localVertexIndex);
+        }
+    }
+}
+
+void MaxFlow_CSR::printStats() const
+{
+    std::map<int, int> histNbArcs;
+
+    for (std::size_t n = 0; n < _trCap.size(); ++n)
+    {
+        int nbArcs = 0;
+        for (VertexIndex k = 0; k < 4; ++k)
+            nbArcs += (_head[arcIndex(NodeType(n), k)] != GEO::NO_CELL);
+        ++histNbArcs[nbArcs];
+    }
+
+    const std::size_t bytes = _head.capacity() * sizeof(NodeType) + _mirror.capacity() * sizeof(std::uint8_t) +
+                              _rCap.capacity() * sizeof(ValueType) + _trCap.capacity() * sizeof(ValueType) +
+                              _trCap.size() * (sizeof(ArcIndex) + 2 * sizeof(int) + 2 * sizeof(std::uint8_t));
+
+    ALICEVISION_LOG_INFO("# vertices: " << _trCap.size() << ", memory: " << (bytes / (1024 * 1024)) << " MB");
+
+    for (const auto& it : histNbArcs)
+    {
+        ALICEVISION_LOG_INFO("\t- arcs[" << it.first << "]: " << it.second);
+    }
+}
+
+void MaxFlow_CSR::printColorStats() const
+{
+    std::size_t nbSource = 0;
+    std::size_t nbTarget = 0;
+
+    for (std::size_t n = 0; n < _trCap.size(); ++n)
+    {
+        nbSource += isSource(NodeType(n));
+        nbTarget += isTarget(NodeType(n));
+    }
+
+    ALICEVISION_LOG_INFO("\t- full (target): " << nbTarget);
+    ALICEVISION_LOG_INFO("\t- empty (source): " << nbSource);
+    ALICEVISION_LOG_INFO("\t- undefined (free): " << (_trCap.size() - nbSource - nbTarget));
+}
+
+MaxFlow_CSR::ValueType MaxFlow_CSR::compute()
+{
+    printStats();
+    ALICEVISION_LOG_INFO("Compute Boykov-Kolmogorov maxflow (CSR).");
+
+    const std::size_t nbNodes = _trCap.size();
+
+    _parent.assign(nbNodes, NO_PARENT);
+    _timestamp.assign(nbNodes, 0);
+    _dist.assign(nbNodes, 0);
+    _isSink.assign(nbNodes, 0);
+    _isActive.assign(nbNodes, 0);
+    _active.clear();
+    _orphans.clear();
+    _time = 0;
+    _flow = 0;
+
+    // initialize the search trees with the nodes connected to a terminal
+    for (std::size_t n = 0; n < nbNodes; ++n)
+    {
+        if (_trCap[n] == 0)
+            continue;
+
+        _isSink[n] = (_trCap[n] < 0);
+        _parent[n] = TERMINAL;
+        _dist[n] = 1;
+        setActive(NodeType(n));
+    }
+
+    NodeType current = GEO::NO_CELL;
+
+    while (true)
+    {
+        NodeType i = current;
+
+        if (i != GEO::NO_CELL && _parent[i] == NO_PARENT)
+        {
+            _isActive[i] = 0;
+            i = GEO::NO_CELL;
+        }
+
+        if (i == GEO::NO_CELL && !nextActive(i))
+            break;
+
+        // growth
+        ArcIndex middleArc = NO_PARENT;
+
+        if (!_isSink[i])
+        {
+            // grow source tree
+            for (VertexIndex k = 0; k < 4; ++k)
+            {
+                const ArcIndex a = arcIndex(i, k);
+                const NodeType j = _head[a];
+
+                if (j == GEO::NO_CELL || _rCap[a] <= 0)
+                    continue;
+
+                if (_parent[j] == NO_PARENT)
+                {
+                    _isSink[j] = 0;
+                    _parent[j] = sister(a);
+                    _timestamp[j] = _timestamp[i];
+                    _dist[j] = _dist[i] + 1;
+                    setActive(j);
+                }
+                else if (_isSink[j])
+                {
+                    middleArc = a;
+                    break;
+                }
+                else if (_timestamp[j] <= _timestamp[i] && _dist[j] > _dist[i])
+                {
+                    // heuristic: trying to make the distance from j to the source shorter
+                    _parent[j] = sister(a);
+                    _timestamp[j] = _timestamp[i];
+                    _dist[j] = _dist[i] + 1;
+                }
+            }
+        }
+        else
+        {
+            // grow sink tree
+            for (VertexIndex k = 0; k < 4; ++k)
+            {
+                const ArcIndex a = arcIndex(i, k);
+                const NodeType j = _head[a];
+
+                if (j == GEO::NO_CELL)
+                    continue;
+
+                const ArcIndex s = sister(a);
+
+                if (_rCap[s] <= 0)
+                    continue;
+
+                if (_parent[j] == NO_PARENT)
+                {
+                    _isSink[j] = 1;
+                    _parent[j] = s;
+                    _timestamp[j] = _timestamp[i];
+                    _dist[j] = _dist[i] + 1;
+                    setActive(j);
+                }
+                else if (!_isSink[j])
+                {
+                    middleArc = s;
+                    break;
+                }
+                else if (_timestamp[j] <= _timestamp[i] && _dist[j] > _dist[i])
+                {
+                    // heuristic: trying to make the distance from j to the sink shorter
+                    _parent[j] = s;
+                    _timestamp[j] = _timestamp[i];
+                    _dist[j] = _dist[i] + 1;
+                }
+            }
+        }
+
+        ++_time;
+
+        if (middleArc != NO_PARENT)
+        {
+            // keep the node active, it may have other arcs to the other tree
+            _isActive[i] = 1;
+            current = i;
+
+            // augmentation
+            augment(middleArc);
+
+            // adoption
+            while (!_orphans.empty())
+            {
+                const NodeType orphan = _orphans.front();
+                _orphans.pop_front();
+                processOrphan(orphan);
+            }
+        }
+        else
+        {
+            _isActive[i] = 0;
+            current = GEO::NO_CELL;
+        }
+    }
+
+    printColorStats();
+
+    return _flow;
+}
+
+void MaxFlow_CSR::setActive(NodeType n)
+{
+    if (_isActive[n])
+        return;
+
+    _isActive[n] = 1;
+    _active.push_back(n);
+}
+
+bool MaxFlow_CSR::nextActive(NodeType& n)
+{
+    while (!_active.empty())
+    {
+        n = _active.front();
+        _active.pop_front();
+
+        // active nodes stay marked while processed
+        if (_parent[n] != NO_PARENT)
+            return true;
+
+        _isActive[n] = 0;
+    }
+
+    return false;
+}
+
+void MaxFlow_CSR::augment(ArcIndex middleArc)
+{
+    // find the bottleneck capacity
+    ValueType bottleneck = _rCap[middleArc];
+    NodeType i;
+
+    // source tree
+    for (i = tail(middleArc);; i = _head[_parent[i]])
+    {
+        const ArcIndex a = _parent[i];
+        if (a == TERMINAL)
+            break;
+        bottleneck = std::min(bottleneck, _rCap[sister(a)]);
+    }
+    bottleneck = std::min(bottleneck, _trCap[i]);
+
+    // sink tree
+    for (i = _head[middleArc];; i = _head[_parent[i]])
+    {
+        const ArcIndex a = _parent[i];
+        if (a == TERMINAL)
+            break;
+        bottleneck = std::min(bottleneck, _rCap[a]);
+    }
+    bottleneck = std::min(bottleneck, -_trCap[i]);
+
+    // augment along the path
+    _rCap[sister(middleArc)] += bottleneck;
+    _rCap[middleArc] -= bottleneck;
+
+    // source tree
+    for (i = tail(middleArc);;)
+    {
+        const ArcIndex a = _parent[i];
+        if (a == TERMINAL)
+            break;
+
+        const NodeType parent = _head[a];
+        const ArcIndex s = sister(a);
+
+        _rCap[a] += bottleneck;
+        _rCap[s] -= bottleneck;
+
+        if (_rCap[s] <= 0)
+        {
+            _parent[i] = ORPHAN;
+            _orphans.push_front(i);
+        }
+        i = parent;
+    }
+    _trCap[i] -= bottleneck;
+    if (_trCap[i] <= 0)
+    {
+        _parent[i] = ORPHAN;
+        _orphans.push_front(i);
+    }
+
+    // sink tree
+    for (i = _head[middleArc];;)
+    {
+        const ArcIndex a = _parent[i];
+        if (a == TERMINAL)
+            break;
+
+        const NodeType parent = _head[a];
+
+        _rCap[sister(a)] += bottleneck;
+        _rCap[a] -= bottleneck;
+
+        if (_rCap[a] <= 0)
+        {
+            _parent[i] = ORPHAN;
+            _orphans.push_front(i);
+        }
+        i = parent;
+    }
+    _trCap[i] += bottleneck;
+    if (_trCap[i] >= 0)
+    {
+        _parent[i] = ORPHAN;
+        _orphans.push_front(i);
+    }
+
+    _flow += bottleneck;
+}
+
+void MaxFlow_CSR::processOrphan(NodeType i)
+{
+    const bool isSink = _isSink[i];
+
+    ArcIndex bestArc = NO_PARENT;
+    int bestDist = INFINITE_DIST;
+
+    // try to find a new valid parent in the same tree
+    for (VertexIndex k = 0; k < 4; ++k)
+    {
+        const ArcIndex a0 = arcIndex(i, k);
+        NodeType j = _head[a0];
+
+        if (j == GEO::NO_CELL)
+            continue;
+
+        // residual capacity from the parent (source tree) or to the parent (sink tree)
+        const ValueType cap = isSink ? _rCap[a0] : _rCap[sister(a0)];
+
+        if (cap <= 0 || bool(_isSink[j]) != isSink || _parent[j] == NO_PARENT)
+            continue;
+
+        // check the origin of j
+        int d = 0;
+        while (true)
+        {
+            if (_timestamp[j] == _time)
+            {
+                d += _dist[j];
+                break;
+            }
+
+            const ArcIndex a = _parent[j];
+            ++d;
+
+            if (a == TERMINAL)
+            {
+                _timestamp[j] = _time;
+                _dist[j] = 1;
+                break;
+            }
+            if (a == ORPHAN)
+            {
+                d = INFINITE_DIST;
+                break;
+            }
+            j = _head[a];
+        }
+
+        if (d < INFINITE_DIST)
+        {
+            // j originates from the terminal
+            if (d < bestDist)
+            {
+                bestArc = a0;
+                bestDist = d;
+            }
+
+            // set marks along the path
+            for (j = _head[a0]; _timestamp[j] != _time; j = _head[_parent[j]])
+            {
+                _timestamp[j] = _time;
+                _dist[j] = d--;
+            }
+        }
+    }
+
+    _parent[i] = bestArc;
+
+    if (bestArc != NO_PARENT)
+    {
+        _timestamp[i] = _time;
+        _dist[i] = bestDist + 1;
+        return;
+    }
+
+    // no parent found, i becomes free: process its neighbours
+    for (VertexIndex k = 0; k < 4; ++k)
+    {
+        const ArcIndex a0 = arcIndex(i, k);
+        const NodeType j = _head[a0];
+
+        if (j == GEO::NO_CELL || bool(_isSink[j]) != isSink)
+            continue;
+
+        const ArcIndex a = _parent[j];
+        if (a == NO_PARENT)
+            continue;
+
+        const ValueType cap = isSink ? _rCap[a0] : _rCap[sister(a0)];
+        if (cap > 0)
+            setActive(j);
+
+        if (a != TERMINAL && a != ORPHAN && _head[a] == i)
+        {
+            _parent[j] = ORPHAN;
+            _orphans.push_back(j);
+        }
+    }
+}
+
+}  // namespace fuseCut
+}  // namespace aliceVision
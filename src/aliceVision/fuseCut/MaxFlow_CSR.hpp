@@ -0,0 +1,123 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/fuseCut/Tetrahedralization.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Maxflow computation based on a compact graph built from the tetrahedralization cell adjacency.
+ *
+ * Each node is a cell with (at most) 4 neighbour arcs, one per facet. The reverse of an arc is the arc
+ * of the mirror facet, so it is implicit. Terminal arcs are stored as a single signed capacity per node.
+ * The maxflow is computed with the Boykov-Kolmogorov algorithm, as in MaxFlow_AdjList, and gives
+ * the same source/target partition (minimal source set / sink tree).
+ *
+ * @see MaxFlow_AdjList which use more memory.
+ */
+class MaxFlow_CSR
+{
+  public:
+    using NodeType = CellIndex;
+    using ValueType = float;
+
+    /**
+     * @brief MaxFlow_CSR constructor, one node per cell.
+     * @param[in] tetrahedralization the tetrahedralization used for the nodes adjacency
+     */
+    explicit MaxFlow_CSR(const Tetrahedralization& tetrahedralization);
+
+    /**
+     * @brief Add source and sink capacities to a node.
+     * @param[in] n the node index
+     * @param[in] source the capacity from the source (emptiness)
+     * @param[in] sink the capacity to the sink (fullness)
+     */
+    inline void addNode(NodeType n, ValueType source, ValueType sink)
+    {
+        assert(source >= 0 && sink >= 0);
+        _trCap[n] += source - sink;
+    }
+
+    /**
+     * @brief Add capacities to the arcs between a node and its neighbour through the given facet.
+     * @param[in] n the node index
+     * @param[in] localVertexIndex the local index of the vertex opposite to the facet
+     * @param[in] capacity the capacity from n to its neighbour
+     * @param[in] reverseCapacity the capacity from the neighbour to n
+     */
+    inline void addEdge(NodeType n, VertexIndex localVertexIndex, ValueType capacity, ValueType reverseCapacity)
+    {
+        assert(capacity >= 0 && reverseCapacity >= 0);
+
+        const ArcIndex a = arcIndex(n, localVertexIndex);
+        assert(_head[a] != GEO::NO_CELL);
+
+        _rCap[a] += capacity;
+        _rCap[sister(a)] += reverseCapacity;
+    }
+
+    void printStats() const;
+    void printColorStats() const;
+
+    /**
+     * @brief Compute the maxflow.
+     * @return the flow value
+     */
+    ValueType compute();
+
+    /// is empty
+    inline bool isSource(NodeType n) const { return (_parent[n] != NO_PARENT && !_isSink[n]); }
+    /// is full
+    inline bool isTarget(NodeType n) const { return (_parent[n] != NO_PARENT && _isSink[n]); }
+
+  private:
+    /// 64-bit, as the 4 arcs per cell do not fit in 32 bits above 2^30 cells
+    using ArcIndex = std::uint64_t;
+
+    static constexpr ArcIndex NO_PARENT = std::numeric_limits<ArcIndex>::max();
+    static constexpr ArcIndex TERMINAL = NO_PARENT - 1;
+    static constexpr ArcIndex ORPHAN = NO_PARENT - 2;
+    static constexpr int INFINITE_DIST = std::numeric_limits<int>::max();
+
+    inline static ArcIndex arcIndex(NodeType n, VertexIndex k) { return ArcIndex(n) * 4 + ArcIndex(k); }
+    inline static NodeType tail(ArcIndex a) { return NodeType(a / 4); }
+    inline ArcIndex sister(ArcIndex a) const { return arcIndex(_head[a], _mirror[a]); }
+
+    void setActive(NodeType n);
+    bool nextActive(NodeType& n);
+    void augment(ArcIndex middleArc);
+    void processOrphan(NodeType n);
+
+    // graph
+    std::vector<NodeType> _head;        //< per arc, neighbour node (GEO::NO_CELL if none)
+    std::vector<std::uint8_t> _mirror;  //< per arc, local index of the reverse arc in the neighbour node
+    std::vector<ValueType> _rCap;       //< per arc, residual capacity
+    std::vector<ValueType> _trCap;      //< per node, residual terminal capacity (> 0 from source, < 0 to sink)
+
+    // search trees
+    std::vector<ArcIndex> _parent;        //< per node, arc to the parent node, TERMINAL, ORPHAN or NO_PARENT (free node)
+    std::vector<int> _timestamp;          //< per node, time of the last distance update
+    std::vector<int> _dist;               //< per node, distance to the terminal
+    std::vector<std::uint8_t> _isSink;    //< per node, is in the sink tree
+    std::vector<std::uint8_t> _isActive;  //< per node, is in the active queue (or current node)
+    std::deque<NodeType> _active;         //< active nodes
+    std::deque<NodeType> _orphans;        //< orphan nodes
+    int _time = 0;                        //< current time
+    ValueType _flow = 0;                  //< current flow
+};
+
+}  // namespace fuseCut
+}  // namespace aliceVision
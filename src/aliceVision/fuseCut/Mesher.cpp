@@ -565,17 +565,17 @@ void Mesher::cellsStatusFilteringBySolidAngleRatio(int nbSolidAngleFilteringIter
         std::vector<bool> vertexIsOnSurface;
         const int nbSurfaceFacets = computeIsOnSurface(vertexIsOnSurface);
 
-        const auto & neighboringCellsPerVertex = _tetrahedralization.getNeighboringCellsPerVertex();
+        const int nbVertices = int(_tetrahedralization.nb_vertices());
 
 #pragma omp parallel for reduction(+ : toInvertCount)
-        for (int vi = 0; vi < neighboringCellsPerVertex.size(); ++vi)
+        for (int vi = 0; vi < nbVertices; ++vi)
         {
             if (!vertexIsOnSurface[vi])
             {
                 continue;
             }
                 
-            const std::vector<CellIndex>& neighboringCells = neighboringCellsPerVertex[vi];
+            const CellsRange neighboringCells = _tetrahedralization.getNeighboringCellsByVertexIndex(vi);
             std::vector<Facet> neighboringFacets;
             neighboringFacets.reserve(neighboringCells.size());
             bool borderCase = false;
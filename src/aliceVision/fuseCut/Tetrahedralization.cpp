@@ -12,6 +12,11 @@
 #include <geogram/delaunay/delaunay.h>
 #include <geogram/delaunay/delaunay_3d.h>
 
+#include <boost/atomic/atomic_ref.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
 namespace aliceVision {
 namespace fuseCut {
 
@@ -19,62 +24,170 @@ Tetrahedralization::Tetrahedralization(const std::vector<Point3d> & vertices)
 : _vertices(vertices)
 {
     //Use geogram to build tetrahedrons
+    //Parallel Delaunay if available in geogram, sequential otherwise
     GEO::initialize();
-    GEO::Delaunay_var tetrahedralization = GEO::Delaunay::create(3, "BDEL");
+    GEO::Delaunay_var tetrahedralization = GEO::Delaunay::create(3, "PDEL");
+    if (tetrahedralization.is_null())
+    {
+        ALICEVISION_LOG_WARNING("Parallel Delaunay tetrahedralization is not available, use the sequential one.");
+        tetrahedralization = GEO::Delaunay::create(3, "BDEL");
+    }
     tetrahedralization->set_stores_neighbors(true);
     tetrahedralization->set_vertices(_vertices.size(), _vertices.front().m);
 
     //Copy information
     _mesh.clear();
-    _neighboringCellsPerVertex.clear();
     _mesh.resize(tetrahedralization->nb_cells());
-    for (CellIndex ci = 0; ci < tetrahedralization->nb_cells(); ci++)
+
+    const GEO::Delaunay& delaunay = *tetrahedralization;
+
+#pragma omp parallel for
+    for (std::int64_t i = 0; i < std::int64_t(_mesh.size()); i++)
     {
+        const CellIndex ci = CellIndex(i);
         Cell & c = _mesh[ci];
-        c.indices[0] = tetrahedralization->cell_vertex(ci, 0);
-        c.indices[1] = tetrahedralization->cell_vertex(ci, 1);
-        c.indices[2] = tetrahedralization->cell_vertex(ci, 2);
-        c.indices[3] = tetrahedralization->cell_vertex(ci, 3);
-
-        c.adjacent[0] = tetrahedralization->cell_adjacent(ci, 0);
-        c.adjacent[1] = tetrahedralization->cell_adjacent(ci, 1);
-        c.adjacent[2] = tetrahedralization->cell_adjacent(ci, 2);
-        c.adjacent[3] = tetrahedralization->cell_adjacent(ci, 3);
+        c.indices[0] = delaunay.cell_vertex(ci, 0);
+        c.indices[1] = delaunay.cell_vertex(ci, 1);
+        c.indices[2] = delaunay.cell_vertex(ci, 2);
+        c.indices[3] = delaunay.cell_vertex(ci, 3);
+
+        c.adjacent[0] = delaunay.cell_adjacent(ci, 0);
+        c.adjacent[1] = delaunay.cell_adjacent(ci, 1);
+        c.adjacent[2] = delaunay.cell_adjacent(ci, 2);
+        c.adjacent[3] = delaunay.cell_adjacent(ci, 3);
     }
 
     //Remove geogram data
     tetrahedralization.reset();
 
+    //Deterministic cells order
+    sortCells();
+
     updateVertexToCellsCache(_vertices.size());
 }
 
+void Tetrahedralization::sortCells()
+{
+    const std::int64_t nbCells = std::int64_t(_mesh.size());
+
+    // canonical vertices order of each cell, using even permutations only (same orientation)
+    // adjacent[k] is the cell opposite to indices[k], so both arrays are permuted together
+#pragma omp parallel for
+    for (std::int64_t ci = 0; ci < nbCells; ++ci)
+    {
+        Cell& c = _mesh[ci];
+
+        const auto swapLocal = [&c](int a, int b) {
+            std::swap(c.indices[a], c.indices[b]);
+            std::swap(c.adjacent[a], c.adjacent[b]);
+        };
+
+        // smallest vertex index first: double transposition
+        const int m = int(std::min_element(c.indices, c.indices + 4) - c.indices);
+        if (m != 0)
+        {
+            const int a = (m == 1) ? 2 : 1;
+            const int b = 6 - m - a;
+            swapLocal(0, m);
+            swapLocal(a, b);
+        }
+
+        // smallest remaining vertex index second: 3-cycle of the last three vertices
+        const int n = int(std::min_element(c.indices + 1, c.indices + 4) - c.indices);
+        for (int r = 1; r < n; ++r)
+        {
+            // rotate left: (1, 2, 3) -> (2, 3, 1)
+            swapLocal(1, 2);
+            swapLocal(2, 3);
+        }
+    }
+
+    // cells order
+    std::vector<CellIndex> order(_mesh.size());
+    for (std::size_t ci = 0; ci < order.size(); ++ci)
+        order[ci] = CellIndex(ci);
+
+    std::sort(order.begin(), order.end(), [this](CellIndex a, CellIndex b) {
+        return std::lexicographical_compare(_mesh[a].indices, _mesh[a].indices + 4, _mesh[b].indices, _mesh[b].indices + 4);
+    });
+
+    std::vector<CellIndex> newIndices(_mesh.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+        newIndices[order[i]] = CellIndex(i);
+
+    std::vector<Cell> sortedMesh(_mesh.size());
+
+#pragma omp parallel for
+    for (std::int64_t i = 0; i < nbCells; ++i)
+    {
+        Cell& c = sortedMesh[i];
+        c = _mesh[order[i]];
+
+        for (int k = 0; k < 4; ++k)
+        {
+            if (c.adjacent[k] != GEO::NO_CELL)
+                c.adjacent[k] = newIndices[c.adjacent[k]];
+        }
+    }
+
+    _mesh.swap(sortedMesh);
+}
+
 void Tetrahedralization::updateVertexToCellsCache(const size_t verticesCount)
 {
-    _neighboringCellsPerVertex.clear();
+    const std::int64_t nbCells = std::int64_t(nb_cells());
 
-    std::map<VertexIndex, std::set<CellIndex>> neighboringCellsPerVertexTmp;
+    // count the cells of each vertex
+    _vertexCellsOffsets.assign(verticesCount + 1, 0);
 
-    for (CellIndex ci = 0; ci < nb_cells(); ++ci)
+#pragma omp parallel for
+    for (std::int64_t ci = 0; ci < nbCells; ++ci)
     {
         for (VertexIndex k = 0; k < 4; ++k)
         {
-            const VertexIndex vi = cell_vertex(ci, k);
+            const VertexIndex vi = cell_vertex(CellIndex(ci), k);
 
             if (vi == GEO::NO_VERTEX || vi >= verticesCount)
             {
                 continue;
             }
 
-            neighboringCellsPerVertexTmp[vi].insert(ci);
+            boost::atomic_ref<std::size_t>{_vertexCellsOffsets[vi + 1]}.fetch_add(1, boost::memory_order_relaxed);
         }
     }
-    
-    _neighboringCellsPerVertex.resize(verticesCount);
-    for (const auto& it : neighboringCellsPerVertexTmp)
+
+    // offsets
+    for (std::size_t vi = 0; vi < verticesCount; ++vi)
+    {
+        _vertexCellsOffsets[vi + 1] += _vertexCellsOffsets[vi];
+    }
+
+    // fill the cells of each vertex
+    _vertexCells.resize(_vertexCellsOffsets.back());
+    std::vector<std::size_t> cursors(_vertexCellsOffsets.begin(), _vertexCellsOffsets.end() - 1);
+
+#pragma omp parallel for
+    for (std::int64_t ci = 0; ci < nbCells; ++ci)
+    {
+        for (VertexIndex k = 0; k < 4; ++k)
+        {
+            const VertexIndex vi = cell_vertex(CellIndex(ci), k);
+
+            if (vi == GEO::NO_VERTEX || vi >= verticesCount)
+            {
+                continue;
+            }
+
+            const std::size_t pos = boost::atomic_ref<std::size_t>{cursors[vi]}.fetch_add(1, boost::memory_order_relaxed);
+            _vertexCells[pos] = CellIndex(ci);
+        }
+    }
+
+    // sort the cells of each vertex (deterministic order)
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (std::int64_t vi = 0; vi < std::int64_t(verticesCount); ++vi)
     {
-        const std::set<CellIndex>& input = it.second;
-        std::vector<CellIndex>& output = _neighboringCellsPerVertex[it.first];
-        output.assign(input.begin(), input.end());
+        std::sort(_vertexCells.begin() + _vertexCellsOffsets[vi], _vertexCells.begin() + _vertexCellsOffsets[vi + 1]);
     }
 }
 
@@ -84,14 +197,14 @@ void Tetrahedralization::get_neighbors(const VertexIndex & vi, GEO::vector<Verte
 
     
     adjVertices.clear();
-    if (vi >= _mesh.size())
+    if (vi >= nb_vertices())
     {
         return;
     }
     
     //Create unique set of vertices
     std::set<VertexIndex> vertices;
-    const auto & cells = _neighboringCellsPerVertex[vi];
+    const CellsRange cells = getNeighboringCellsByVertexIndex(vi);
     for (const auto & cellId : cells)
     {
         const auto & cell = _mesh[cellId];
@@ -268,8 +381,8 @@ VertexIndex Tetrahedralization::getVertexIndex(const Facet& f, int i) const
 
 std::vector<CellIndex> Tetrahedralization::getNeighboringCellsByEdge(const Edge& e) const
 {
-    const std::vector<CellIndex> & v0ci = getNeighboringCellsPerVertex().at(e.v0);
-    const std::vector<CellIndex> & v1ci = getNeighboringCellsPerVertex().at(e.v1);
+    const CellsRange v0ci = getNeighboringCellsByVertexIndex(e.v0);
+    const CellsRange v1ci = getNeighboringCellsByVertexIndex(e.v1);
 
     std::vector<CellIndex> neighboringCells;
     std::set_intersection(v0ci.begin(), v0ci.end(), v1ci.begin(), v1ci.end(), std::back_inserter(neighboringCells));
@@ -16,6 +16,8 @@
 #include <Eigen/Dense>
 #include <array>
 #include <random>
+#include <stdexcept>
+#include <vector>
 
 namespace aliceVision {
 namespace fuseCut {
@@ -78,6 +80,28 @@ struct Edge
     }
 };
 
+/**
+ * @brief Contiguous range of cell indices, view on the Tetrahedralization vertex to cells index.
+ */
+class CellsRange
+{
+public:
+    CellsRange(const CellIndex* begin, const CellIndex* end)
+        : _begin(begin),
+        _end(end)
+    {}
+
+    const CellIndex* begin() const { return _begin; }
+    const CellIndex* end() const { return _end; }
+    std::size_t size() const { return std::size_t(_end - _begin); }
+    bool empty() const { return _begin == _end; }
+    const CellIndex& operator[](std::size_t i) const { return _begin[i]; }
+
+private:
+    const CellIndex* _begin;
+    const CellIndex* _end;
+};
+
 std::ostream& operator<<(std::ostream& stream, const Facet& facet);
 std::ostream& operator<<(std::ostream& stream, const Edge& edge);
 
@@ -141,9 +165,13 @@ public:
         return _mesh.size();
     }
 
-    const std::vector<std::vector<CellIndex>> & getNeighboringCellsPerVertex() const
+    /**
+     * @brief Get the number of vertices in the vertex to cells index.
+     * @return the number of indexed vertices
+     */
+    size_t nb_vertices() const
     {
-        return _neighboringCellsPerVertex;
+        return _vertexCellsOffsets.empty() ? 0 : _vertexCellsOffsets.size() - 1;
     }
 
     double orient3d(const std::array<Eigen::Vector3d, 4> & points) const
@@ -208,9 +236,21 @@ public:
     
     Facet mirrorFacet(const Facet& f) const;
 
-    inline const std::vector<CellIndex>& getNeighboringCellsByVertexIndex(VertexIndex vi) const
-    { 
-        return getNeighboringCellsPerVertex().at(vi); 
+    /**
+     * @brief Retrieves the sorted global indexes of the cells sharing a vertex.
+     *
+     * @param vi the global vertex index
+     * @return a view on the neighboring cell indices
+     */
+    inline CellsRange getNeighboringCellsByVertexIndex(VertexIndex vi) const
+    {
+        if (vi >= nb_vertices())
+        {
+            throw std::out_of_range("Tetrahedralization: invalid vertex index.");
+        }
+
+        const CellIndex* data = _vertexCells.data();
+        return CellsRange(data + _vertexCellsOffsets[vi], data + _vertexCellsOffsets[vi + 1]);
     }
 
     std::vector<CellIndex> getNeighboringCellsByEdge(const Edge& e) const;
@@ -228,11 +268,20 @@ public:
     Point3d cellCircumScribedSphereCentre(CellIndex ci) const;
 
 private:
+    /**
+     * @brief Sort the cells in a canonical order (the parallel Delaunay cells order depends on the threads scheduling).
+     * The vertices of each cell are rotated with an orientation-preserving permutation so that the smallest
+     * vertex index comes first, then the cells are sorted by vertex indices and the adjacencies are renumbered.
+     */
+    void sortCells();
+
     void updateVertexToCellsCache(size_t verticesCount);
 
 private:
     std::vector<Cell> _mesh;
-    std::vector<std::vector<CellIndex>> _neighboringCellsPerVertex;
+    /// vertex to cells index (CSR): cells of vertex vi are _vertexCells[_vertexCellsOffsets[vi].._vertexCellsOffsets[vi + 1]]
+    std::vector<std::size_t> _vertexCellsOffsets;
+    std::vector<CellIndex> _vertexCells;
     const std::vector<Point3d> & _vertices;
 };
 
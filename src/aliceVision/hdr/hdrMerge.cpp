@@ -5,6 +5,8 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "hdrMerge.hpp"
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <limits>
@@ -41,156 +43,319 @@ inline float sigmoidInv(float zeroVal, float endVal, float sigwidth, float sigMi
     return zeroVal + (endVal - zeroVal) * (1.0f / (1.0f + expf(10.0f * ((sigMid - xval) / sigwidth))));
 }
 
-void hdrMerge::process(const std::vector<image::Image<image::RGBfColor>>& images,
-                       const std::vector<double>& times,
-                       const rgbCurve& weight,
-                       const rgbCurve& response,
-                       image::Image<image::RGBfColor>& radiance,
-                       image::Image<image::RGBfColor>& lowLight,
-                       image::Image<image::RGBfColor>& highLight,
-                       image::Image<image::RGBfColor>& noMidLight,
-                       MergingParams& mergingParams)
-{
-    // checks
-    assert(!response.isEmpty());
-    assert(!images.empty());
-    assert(images.size() == times.size());
+namespace {
 
-    // get images width, height
-    const std::size_t width = images.front().width();
-    const std::size_t height = images.front().height();
-
-    // resize and reset radiance image to 0.0
-    radiance.resize(width, height, true, image::RGBfColor(0.f, 0.f, 0.f));
-
-    ALICEVISION_LOG_TRACE("[hdrMerge] Images to fuse:");
-    for (int i = 0; i < images.size(); ++i)
+/**
+ * @brief Merge kernel working on rows of pixels.
+ *
+ * The response and weight curves are resampled once per bracket group in float lookup tables,
+ * and each row is converted to a structure-of-arrays layout (one array per bracket and channel),
+ * so that all the per pixel operations are vectorized over the row without any allocation.
+ */
+class MergeKernel
+{
+  public:
+    /// Working memory of a thread, allocated once for all its rows
+    struct Buffers
     {
-        ALICEVISION_LOG_TRACE(images[i].width() << "x" << images[i].height() << ", time: " << times[i]);
-    }
+        std::vector<float> values;           //< LDR values, per bracket, channel and pixel
+        std::vector<float> normalizedValues;  //< response divided by the exposure, per bracket and pixel
+        std::vector<float> coeffs;           //< merging weights, per bracket and pixel
+        std::vector<int> firstIndexes;       //< first merged bracket, per pixel
+        std::vector<int> lastIndexes;        //< last merged bracket, per pixel
+        std::vector<float> sums;             //< weighted sum of the normalized values, per pixel
+        std::vector<float> sumCoeffs;        //< sum of the weights, per pixel
+    };
+
+    MergeKernel(const std::vector<double>& times, const rgbCurve& weight, const rgbCurve& response, const MergingParams& mergingParams)
+      : _nbBrackets(times.size()),
+        _scale(response.getSize() - 1.0f),
+        _params(mergingParams)
+    {
+        rgbCurve weightShortestExposure = weight;
+        weightShortestExposure.freezeSecondPartValues();
+        rgbCurve weightLongestExposure = weight;
+        weightLongestExposure.freezeFirstPartValues();
 
-    rgbCurve weightShortestExposure = weight;
-    weightShortestExposure.freezeSecondPartValues();
-    rgbCurve weightLongestExposure = weight;
-    weightLongestExposure.freezeFirstPartValues();
+        assert(weight.getSize() == response.getSize());
 
-    const std::vector<double> v_minValue = {
-      response(mergingParams.minSignificantValue, 0), response(mergingParams.minSignificantValue, 1), response(mergingParams.minSignificantValue, 2)};
-    const std::vector<double> v_maxValue = {
-      response(mergingParams.maxSignificantValue, 0), response(mergingParams.maxSignificantValue, 1), response(mergingParams.maxSignificantValue, 2)};
+        for (std::size_t e = 0; e < _nbBrackets; ++e)
+            _times.push_back(static_cast<float>(times[e]));
 
-    highLight.resize(width, height, true, image::RGBfColor(0.f, 0.f, 0.f));
-    lowLight.resize(width, height, true, image::RGBfColor(0.f, 0.f, 0.f));
-    noMidLight.resize(width, height, true, image::RGBfColor(0.f, 0.f, 0.f));
+        for (std::size_t channel = 0; channel < 3; ++channel)
+        {
+            _responses[channel] = paddedCurve(response.getCurve(channel));
+            _weights[channel][0] = paddedCurve(weightShortestExposure.getCurve(channel));
+            _weights[channel][1] = paddedCurve(weight.getCurve(channel));
+            _weights[channel][2] = paddedCurve(weightLongestExposure.getCurve(channel));
+            _minValues[channel] = response(mergingParams.minSignificantValue, channel);
+            _maxValues[channel] = response(mergingParams.maxSignificantValue, channel);
+        }
+    }
 
-#pragma omp parallel for
-    for (int y = 0; y < height; ++y)
+    /**
+     * @brief Merge a row of pixels.
+     * @param[in] rows the row of each bracket image
+     * @param[in] width the number of pixels of the row
+     * @param[out] radiance, lowLight, highLight, noMidLight the output rows
+     * @param[in,out] buffers the working memory of the thread
+     */
+    void mergeRow(const std::vector<const image::RGBfColor*>& rows,
+                  int width,
+                  image::RGBfColor* radiance,
+                  image::RGBfColor* lowLight,
+                  image::RGBfColor* highLight,
+                  image::RGBfColor* noMidLight,
+                  Buffers& buffers) const
     {
-        for (int x = 0; x < width; ++x)
+        static_assert(sizeof(image::RGBfColor) == 3 * sizeof(float), "RGBfColor must be 3 packed floats");
+
+        const int nbBrackets = _nbBrackets;
+        const int refIndex = _params.refImageIndex;
+        const float targetExposure = _params.targetCameraExposure;
+        const float scale = _scale;
+
+        buffers.values.resize(nbBrackets * 3 * width);
+        buffers.normalizedValues.resize(nbBrackets * width);
+        buffers.coeffs.resize(nbBrackets * width);
+        buffers.firstIndexes.resize(width);
+        buffers.lastIndexes.resize(width);
+        buffers.sums.resize(width);
+        buffers.sumCoeffs.resize(width);
+
+        int* firstIndexes = buffers.firstIndexes.data();
+        int* lastIndexes = buffers.lastIndexes.data();
+        float* sums = buffers.sums.data();
+        float* sumCoeffs = buffers.sumCoeffs.data();
+
+        // Convert the rows to a structure-of-arrays layout
+        for (int e = 0; e < nbBrackets; ++e)
         {
-            // for each pixels
-            image::RGBfColor& radianceColor = radiance(y, x);
-            image::RGBfColor& highLightColor = highLight(y, x);
-            image::RGBfColor& lowLightColor = lowLight(y, x);
-            image::RGBfColor& noMidLightColor = noMidLight(y, x);
+            const float* row = reinterpret_cast<const float*>(rows[e]);
+            for (int channel = 0; channel < 3; ++channel)
+            {
+                float* values = &buffers.values[(e * 3 + channel) * width];
+#pragma omp simd
+                for (int x = 0; x < width; ++x)
+                    values[x] = row[3 * x + channel];
+            }
+        }
 
-            std::vector<std::vector<double>> vv_coeff;
-            std::vector<std::vector<double>> vv_value;
-            std::vector<std::vector<double>> vv_normalizedValue;
+        float* radianceRow = reinterpret_cast<float*>(radiance);
 
-            // Compute merging range
-            std::vector<int> v_firstIndex;
-            std::vector<int> v_lastIndex;
-            for (std::size_t channel = 0; channel < 3; ++channel)
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            const float* responseCurve = _responses[channel].data();
+            const float minValue = _minValues[channel];
+            const float maxValue = _maxValues[channel];
+
+            // Compute merging coeffs and values to be merged
+            for (int e = 0; e < nbBrackets; ++e)
             {
-                int firstIndex = mergingParams.refImageIndex;
-                while (firstIndex > 0 &&
-                       (response(images[firstIndex](y, x)(channel), channel) > v_minValue[channel] || firstIndex == images.size() - 1))
+                const float* values = &buffers.values[(e * 3 + channel) * width];
+                const float* weightCurve = _weights[channel][e == 0 ? 0 : (e == nbBrackets - 1 ? 2 : 1)].data();
+                const float time = _times[e];
+                float* normalizedValues = &buffers.normalizedValues[e * width];
+                float* coeffs = &buffers.coeffs[e * width];
+
+#pragma omp simd
+                for (int x = 0; x < width; ++x)
                 {
-                    firstIndex--;
+                    normalizedValues[x] = lookup(responseCurve, scale, values[x]) / time;
+                    coeffs[x] = std::max(0.001f, lookup(weightCurve, scale, values[x]));
                 }
-                v_firstIndex.push_back(firstIndex);
+            }
 
-                int lastIndex = v_firstIndex[channel] + 1;
-                while (lastIndex < images.size() - 1 && response(images[lastIndex](y, x)(channel), channel) < v_maxValue[channel])
+            // Compute merging range:
+            // from the reference bracket, go down while the response is above the minimum value,
+            // then go up while the response is below the maximum value.
+#pragma omp simd
+            for (int x = 0; x < width; ++x)
+                firstIndexes[x] = refIndex;
+
+            for (int e = refIndex; e > 0; --e)
+            {
+                const float* values = &buffers.values[(e * 3 + channel) * width];
+#pragma omp simd
+                for (int x = 0; x < width; ++x)
                 {
-                    lastIndex++;
+                    if (firstIndexes[x] == e && (lookup(responseCurve, scale, values[x]) > minValue || e == nbBrackets - 1))
+                        firstIndexes[x] = e - 1;
                 }
-                v_lastIndex.push_back(lastIndex);
             }
 
-            // Compute merging coeffs and values to be merged
-            for (std::size_t channel = 0; channel < 3; ++channel)
-            {
-                std::vector<double> v_coeff;
-                std::vector<double> v_normalizedValue;
-                std::vector<double> v_value;
+#pragma omp simd
+            for (int x = 0; x < width; ++x)
+                lastIndexes[x] = firstIndexes[x] + 1;
 
-                for (std::size_t e = 0; e < images.size(); ++e)
+            for (int e = 1; e < nbBrackets - 1; ++e)
+            {
+                const float* values = &buffers.values[(e * 3 + channel) * width];
+#pragma omp simd
+                for (int x = 0; x < width; ++x)
                 {
-                    const double value = images[e](y, x)(channel);
-                    const double resp = response(value, channel);
-                    const double normalizedValue = resp / times[e];
-                    double coeff = std::max(0.001f,
-                                            e == 0 ? weightShortestExposure(value, channel)
-                                                   : (e == images.size() - 1 ? weightLongestExposure(value, channel) : weight(value, channel)));
-
-                    v_value.push_back(value);
-                    v_normalizedValue.push_back(normalizedValue);
-                    v_coeff.push_back(coeff);
+                    if (lastIndexes[x] == e && lookup(responseCurve, scale, values[x]) < maxValue)
+                        lastIndexes[x] = e + 1;
                 }
+            }
 
-                vv_coeff.push_back(v_coeff);
-                vv_normalizedValue.push_back(v_normalizedValue);
-                vv_value.push_back(v_value);
+            // Compute the final result and adjust the exposure to the reference one.
+#pragma omp simd
+            for (int x = 0; x < width; ++x)
+            {
+                sums[x] = 0.0f;
+                sumCoeffs[x] = 0.0f;
             }
 
-            // Compute light masks if required (monitoring and debug purposes)
-            if (mergingParams.computeLightMasks)
+            for (int e = 0; e < nbBrackets; ++e)
             {
-                for (std::size_t channel = 0; channel < 3; ++channel)
+                const float* normalizedValues = &buffers.normalizedValues[e * width];
+                const float* coeffs = &buffers.coeffs[e * width];
+#pragma omp simd
+                for (int x = 0; x < width; ++x)
                 {
-                    int idxMaxValue = 0;
-                    int idxMinValue = 0;
-                    double maxValue = 0.0;
-                    double minValue = 10000.0;
-                    bool jump = true;
-                    for (std::size_t e = 0; e < images.size(); ++e)
-                    {
-                        if (vv_value[channel][e] > maxValue)
-                        {
-                            maxValue = vv_value[channel][e];
-                            idxMaxValue = e;
-                        }
-                        if (vv_value[channel][e] < minValue)
-                        {
-                            minValue = vv_value[channel][e];
-                            idxMinValue = e;
-                        }
-                        jump = jump && ((vv_value[channel][e] < mergingParams.minSignificantValue && e < images.size() - 1) ||
-                                        (vv_value[channel][e] > mergingParams.maxSignificantValue && e > 0));
-                    }
-                    highLightColor(channel) = minValue > mergingParams.maxSignificantValue ? 1.0 : 0.0;
-                    lowLightColor(channel) = maxValue < mergingParams.minSignificantValue ? 1.0 : 0.0;
-                    noMidLightColor(channel) = jump ? 1.0 : 0.0;
+                    const bool isMerged = (e >= firstIndexes[x]) && (e <= lastIndexes[x]);
+                    sums[x] += isMerged ? coeffs[x] * normalizedValues[x] : 0.0f;
+                    sumCoeffs[x] += isMerged ? coeffs[x] : 0.0f;
                 }
             }
 
-            // Compute the final result and adjust the exposure to the reference one.
-            for (std::size_t channel = 0; channel < 3; ++channel)
+            const float* refNormalizedValues = &buffers.normalizedValues[refIndex * width];
+#pragma omp simd
+            for (int x = 0; x < width; ++x)
             {
-                double v = 0.0;
-                double sumCoeff = 0.0;
-                for (std::size_t i = v_firstIndex[channel]; i <= v_lastIndex[channel]; ++i)
+                radianceRow[3 * x + channel] = targetExposure * (sumCoeffs[x] != 0.0f ? sums[x] / sumCoeffs[x] : refNormalizedValues[x]);
+            }
+        }
+
+        // Compute light masks if required (monitoring and debug purposes)
+        if (_params.computeLightMasks)
+            computeLightMasks(buffers, width, lowLight, highLight, noMidLight);
+    }
+
+  private:
+    /// Curve values with the last value repeated, so the interpolation of the last sample stays in the curve
+    static std::vector<float> paddedCurve(const std::vector<float>& curve)
+    {
+        std::vector<float> padded(curve);
+        padded.push_back(curve.back());
+        return padded;
+    }
+
+    /// Same interpolation as rgbCurve::operator()
+    static inline float lookup(const float* curve, float scale, float sample)
+    {
+        const float valueScaled = std::max(0.f, std::min(1.f, sample)) * scale;
+        const int infIndex = static_cast<int>(valueScaled);
+        const float fractionalPart = valueScaled - infIndex;
+        return (1.0f - fractionalPart) * curve[infIndex] + fractionalPart * curve[infIndex + 1];
+    }
+
+    void computeLightMasks(const Buffers& buffers, int width, image::RGBfColor* lowLight, image::RGBfColor* highLight, image::RGBfColor* noMidLight) const
+    {
+        const int nbBrackets = _nbBrackets;
+        const double minSignificantValue = _params.minSignificantValue;
+        const double maxSignificantValue = _params.maxSignificantValue;
+
+        float* lowLightRow = reinterpret_cast<float*>(lowLight);
+        float* highLightRow = reinterpret_cast<float*>(highLight);
+        float* noMidLightRow = reinterpret_cast<float*>(noMidLight);
+
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                float maxValue = 0.0f;
+                float minValue = 10000.0f;
+                bool jump = true;
+                for (int e = 0; e < nbBrackets; ++e)
                 {
-                    v += vv_coeff[channel][i] * vv_normalizedValue[channel][i];
-                    sumCoeff += vv_coeff[channel][i];
+                    const float value = buffers.values[(e * 3 + channel) * width + x];
+                    maxValue = std::max(maxValue, value);
+                    minValue = std::min(minValue, value);
+                    jump = jump && ((value < minSignificantValue && e < nbBrackets - 1) || (value > maxSignificantValue && e > 0));
                 }
-                radianceColor(channel) =
-                  mergingParams.targetCameraExposure * (sumCoeff != 0.0 ? v / sumCoeff : vv_normalizedValue[channel][mergingParams.refImageIndex]);
+                highLightRow[3 * x + channel] = minValue > maxSignificantValue ? 1.0f : 0.0f;
+                lowLightRow[3 * x + channel] = maxValue < minSignificantValue ? 1.0f : 0.0f;
+                noMidLightRow[3 * x + channel] = jump ? 1.0f : 0.0f;
             }
         }
     }
+
+    const std::size_t _nbBrackets;               //< number of images in the bracket group
+    const float _scale;                          //< curves size - 1
+    const MergingParams _params;                 //< merging parameters
+    std::vector<float> _times;                   //< exposure of each bracket
+    std::array<std::vector<float>, 3> _responses;  //< padded response curve, per channel
+    std::array<std::array<std::vector<float>, 3>, 3> _weights;  //< padded weight curves (shortest, middle, longest exposure), per channel
+    std::array<float, 3> _minValues;             //< response of the minimum significant value, per channel
+    std::array<float, 3> _maxValues;             //< response of the maximum significant value, per channel
+};
+
+/**
+ * @brief Merge all the rows of the output images, in parallel.
+ */
+void mergeRows(const MergeKernel& kernel,
+               const std::vector<image::Image<image::RGBfColor>>& images,
+               image::Image<image::RGBfColor>& radiance,
+               image::Image<image::RGBfColor>& lowLight,
+               image::Image<image::RGBfColor>& highLight,
+               image::Image<image::RGBfColor>& noMidLight)
+{
+    const int width = radiance.width();
+
+#pragma omp parallel
+    {
+        MergeKernel::Buffers buffers;
+        std::vector<const image::RGBfColor*> rows(images.size());
+
+#pragma omp for
+        for (int y = 0; y < radiance.height(); ++y)
+        {
+            for (std::size_t e = 0; e < images.size(); ++e)
+                rows[e] = &images[e](y, 0);
+
+            kernel.mergeRow(rows, width, &radiance(y, 0), &lowLight(y, 0), &highLight(y, 0), &noMidLight(y, 0), buffers);
+        }
+    }
+}
+
+}  // namespace
+
+void hdrMerge::process(const std::vector<image::Image<image::RGBfColor>>& images,
+                       const std::vector<double>& times,
+                       const rgbCurve& weight,
+                       const rgbCurve& response,
+                       image::Image<image::RGBfColor>& radiance,
+                       image::Image<image::RGBfColor>& lowLight,
+                       image::Image<image::RGBfColor>& highLight,
+                       image::Image<image::RGBfColor>& noMidLight,
+                       MergingParams& mergingParams)
+{
+    // checks
+    assert(!response.isEmpty());
+    assert(!images.empty());
+    assert(images.size() == times.size());
+
+    // get images width, height
+    const std::size_t width = images.front().width();
+    const std::size_t height = images.front().height();
+
+    // resize and reset radiance image to 0.0
+    radiance.resize(width, height, true, image::RGBfColor(0.f, 0.f, 0.f));
+
+    ALICEVISION_LOG_TRACE("[hdrMerge] Images to fuse:");
+    for (int i = 0; i < images.size(); ++i)
+    {
+        ALICEVISION_LOG_TRACE(images[i].width() << "x" << images[i].height() << ", time: " << times[i]);
+    }
+
+    highLight.resize(width, height, true, image::RGBfColor(0.f, 0.f, 0.f));
+    lowLight.resize(width, height, true, image::RGBfColor(0.f, 0.f, 0.f));
+    noMidLight.resize(width, height, true, image::RGBfColor(0.f, 0.f, 0.f));
+
+    const MergeKernel kernel(times, weight, response, mergingParams);
+    mergeRows(kernel, images, radiance, lowLight, highLight, noMidLight);
 }
 
 void hdrMerge::postProcessHighlight(const std::vector<image::Image<image::RGBfColor>>& images,
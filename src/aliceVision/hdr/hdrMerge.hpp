@@ -25,12 +25,16 @@ class hdrMerge
 {
   public:
     /**
-     * @brief
-     * @param images
-     * @param radiance
-     * @param times
-     * @param targetCameraExposure
-     * @param response
+     * @brief Merge the LDR images of a bracket group into an HDR image.
+     *        The images are merged row by row: each row is converted to a structure-of-arrays float layout
+     *        and the response curve and weights lookups are vectorized over the pixels of the row.
+     * @param[in] images the LDR images of the bracket group, sorted by exposure
+     * @param[in] times the exposure of each image
+     * @param[in] weight the fusion weight curve
+     * @param[in] response the camera response curve
+     * @param[out] radiance the merged HDR image
+     * @param[out] lowLight, highLight, noMidLight the light masks (if computeLightMasks)
+     * @param[in] mergingParams the merging parameters
      */
     void process(const std::vector<image::Image<image::RGBfColor>>& images,
                  const std::vector<double>& times,
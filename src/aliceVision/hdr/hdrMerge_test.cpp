@@ -0,0 +1,129 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#define BOOST_TEST_MODULE hdr_merge
+
+#include "hdrMerge.hpp"
+
+#include <random>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+
+namespace {
+
+/// Reference per pixel merge, in double
+image::RGBfColor referenceMerge(const std::vector<image::Image<image::RGBfColor>>& images,
+                                const std::vector<double>& times,
+                                const hdr::rgbCurve& weight,
+                                const hdr::rgbCurve& response,
+                                const hdr::MergingParams& mergingParams,
+                                int y,
+                                int x)
+{
+    hdr::rgbCurve weightShortestExposure = weight;
+    weightShortestExposure.freezeSecondPartValues();
+    hdr::rgbCurve weightLongestExposure = weight;
+    weightLongestExposure.freezeFirstPartValues();
+
+    const int nbImages = images.size();
+    image::RGBfColor radiance;
+
+    for (int channel = 0; channel < 3; ++channel)
+    {
+        const double minValue = response(mergingParams.minSignificantValue, channel);
+        const double maxValue = response(mergingParams.maxSignificantValue, channel);
+
+        int firstIndex = mergingParams.refImageIndex;
+        while (firstIndex > 0 && (response(images[firstIndex](y, x)(channel), channel) > minValue || firstIndex == nbImages - 1))
+            firstIndex--;
+
+        int lastIndex = firstIndex + 1;
+        while (lastIndex < nbImages - 1 && response(images[lastIndex](y, x)(channel), channel) < maxValue)
+            lastIndex++;
+
+        double v = 0.0;
+        double sumCoeff = 0.0;
+        for (int e = firstIndex; e <= lastIndex; ++e)
+        {
+            const double value = images[e](y, x)(channel);
+            const double coeff = std::max(
+              0.001f,
+              e == 0 ? weightShortestExposure(value, channel) : (e == nbImages - 1 ? weightLongestExposure(value, channel) : weight(value, channel)));
+            v += coeff * response(value, channel) / times[e];
+            sumCoeff += coeff;
+        }
+        radiance(channel) = mergingParams.targetCameraExposure * v / sumCoeff;
+    }
+    return radiance;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(hdrMerge_rowKernel)
+{
+    const int width = 37;
+    const int height = 23;
+    const std::vector<double> times = {1.0 / 400.0, 1.0 / 100.0, 1.0 / 25.0, 1.0 / 6.0, 0.6};
+    const std::size_t quantization = 1024;
+
+    hdr::rgbCurve weight(quantization);
+    weight.setFunction(hdr::EFunctionType::GAUSSIAN);
+    hdr::rgbCurve response(quantization);
+    response.setGamma();
+
+    // LDR images of a random radiance, with saturated and clamped pixels
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> radianceDistribution(0.0f, 30.0f);
+    std::vector<image::Image<image::RGBfColor>> images(times.size(), image::Image<image::RGBfColor>(width, height));
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            for (int channel = 0; channel < 3; ++channel)
+            {
+                const float radiance = radianceDistribution(generator);
+                for (std::size_t e = 0; e < times.size(); ++e)
+                    images[e](y, x)(channel) = std::min(1.0f, std::pow(float(radiance * times[e]), 1.0f / 2.2f));
+            }
+        }
+    }
+
+    hdr::MergingParams mergingParams;
+    mergingParams.targetCameraExposure = 0.05f;
+    mergingParams.refImageIndex = 2;
+    mergingParams.computeLightMasks = true;
+
+    hdr::hdrMerge merge;
+    image::Image<image::RGBfColor> radiance, lowLight, highLight, noMidLight;
+    merge.process(images, times, weight, response, radiance, lowLight, highLight, noMidLight, mergingParams);
+
+    BOOST_CHECK_EQUAL(radiance.width(), width);
+    BOOST_CHECK_EQUAL(radiance.height(), height);
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const image::RGBfColor expected = referenceMerge(images, times, weight, response, mergingParams, y, x);
+            for (int channel = 0; channel < 3; ++channel)
+            {
+                BOOST_CHECK_CLOSE(radiance(y, x)(channel), expected(channel), 1e-3);
+
+                float minValue = 1.0f;
+                float maxValue = 0.0f;
+                for (const auto& image : images)
+                {
+                    minValue = std::min(minValue, image(y, x)(channel));
+                    maxValue = std::max(maxValue, image(y, x)(channel));
+                }
+                BOOST_CHECK_EQUAL(highLight(y, x)(channel), minValue > mergingParams.maxSignificantValue ? 1.0f : 0.0f);
+                BOOST_CHECK_EQUAL(lowLight(y, x)(channel), maxValue < mergingParams.minSignificantValue ? 1.0f : 0.0f);
+            }
+        }
+    }
+}
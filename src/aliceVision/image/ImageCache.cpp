@@ -113,24 +113,324 @@ unsigned long long int CacheValue::memorySize() const
     return 0;
 }
 
-ImageCache::ImageCache(float capacity_MiB, float maxSize_MiB, const ImageReadOptions& options)
+ImageCache::ImageCache(float capacity_MiB, float maxSize_MiB, const ImageReadOptions& options, bool statOnce, int nbPrefetchThreads)
   : _info(capacity_MiB, maxSize_MiB),
-    _options(options)
-{}
+    _options(options),
+    _statOnce(statOnce),
+    _nbPrefetchThreads(nbPrefetchThreads)
+{
+    if (nbPrefetchThreads < 1)
+    {
+        ALICEVISION_THROW_ERROR("[image] ImageCache: the number of prefetch threads must be at least 1, " << nbPrefetchThreads << " given.");
+    }
+}
+
+ImageCache::~ImageCache()
+{
+    {
+        const std::scoped_lock<std::mutex> lock(_mutexPrefetch);
+        _stopPrefetch = true;
+        _prefetchQueue.clear();
+    }
+    _prefetchAvailable.notify_all();
+    for (std::thread& thread : _prefetchThreads)
+    {
+        thread.join();
+    }
+}
+
+ImageCache::CacheEntry* ImageCache::Shard::find(const CacheKey& key)
+{
+    auto it = entries.find(key);
+    return (it == entries.end()) ? nullptr : &it->second;
+}
+
+void ImageCache::Shard::pushMru(CacheEntry* entry)
+{
+    entry->prev = mru;
+    entry->next = nullptr;
+    if (mru)
+    {
+        mru->next = entry;
+    }
+    else
+    {
+        lru = entry;
+    }
+    mru = entry;
+}
+
+void ImageCache::Shard::unlink(CacheEntry* entry)
+{
+    if (entry->prev)
+    {
+        entry->prev->next = entry->next;
+    }
+    else
+    {
+        lru = entry->next;
+    }
+    if (entry->next)
+    {
+        entry->next->prev = entry->prev;
+    }
+    else
+    {
+        mru = entry->prev;
+    }
+    entry->prev = nullptr;
+    entry->next = nullptr;
+}
+
+int ImageCache::getShardIndex(const std::string& filename) const { return std::hash<std::string>()(filename) % nbShards; }
+
+CacheKey ImageCache::makeKey(int shardIndex, const std::string& filename, int nbChannels, oiio::TypeDesc::BASETYPE typeDesc, int downscaleLevel) const
+{
+    if (!_statOnce)
+    {
+        return CacheKey(filename, nbChannels, typeDesc, downscaleLevel, utils::getLastWriteTime(filename));
+    }
+
+    Shard& shard = _shards[shardIndex];
+    {
+        const std::scoped_lock<std::mutex> lock(shard.mutex);
+        const auto it = shard.lastWriteTimes.find(filename);
+        if (it != shard.lastWriteTimes.end())
+        {
+            return CacheKey(filename, nbChannels, typeDesc, downscaleLevel, it->second);
+        }
+    }
+
+    // stat outside of the lock, the first value stored wins
+    const std::time_t lastWriteTime = utils::getLastWriteTime(filename);
+    const std::scoped_lock<std::mutex> lock(shard.mutex);
+    const auto it = shard.lastWriteTimes.emplace(filename, lastWriteTime).first;
+    return CacheKey(filename, nbChannels, typeDesc, downscaleLevel, it->second);
+}
 
-ImageCache::~ImageCache() {}
+ImageCache::CacheEntry* ImageCache::touch(Shard& shard, const CacheKey& key)
+{
+    CacheEntry* entry = shard.find(key);
+    if (entry)
+    {
+        // image becomes MRU
+        shard.unlink(entry);
+        shard.pushMru(entry);
+        entry->lastAccess = ++_accessCounter;
+    }
+    return entry;
+}
+
+ImageCache::CacheEntry* ImageCache::findLru(const std::function<bool(const CacheEntry&)>& visitor) const
+{
+    // merge the LRU lists of the shards, they are sorted by last access
+    std::array<CacheEntry*, nbShards> cursors;
+    for (int i = 0; i < nbShards; ++i)
+    {
+        cursors[i] = _shards[i].lru;
+    }
+
+    while (true)
+    {
+        int best = -1;
+        for (int i = 0; i < nbShards; ++i)
+        {
+            if (cursors[i] && (best < 0 || cursors[i]->lastAccess < cursors[best]->lastAccess))
+            {
+                best = i;
+            }
+        }
+        if (best < 0)
+        {
+            return nullptr;
+        }
+        if (visitor(*cursors[best]))
+        {
+            return cursors[best];
+        }
+        cursors[best] = cursors[best]->next;
+    }
+}
+
+void ImageCache::remove(CacheEntry* entry)
+{
+    Shard& shard = _shards[entry->shardIndex];
+    shard.unlink(entry);
+
+    _info.nbImages--;
+    _info.contentSize -= entry->value.memorySize();
+    _info.nbRemoveUnused++;
+
+    // copy the key as it is owned by the erased node
+    const CacheKey key = *entry->key;
+    shard.entries.erase(key);
+}
+
+bool ImageCache::reserve(unsigned long long int memSize, bool lazyCleaning, bool allowOverCapacity)
+{
+    const std::scoped_lock<std::mutex> lockEviction(_mutexEviction);
+
+    // add image to cache if it fits in capacity
+    if (memSize + _info.contentSize <= _info.capacity)
+    {
+        _info.contentSize += memSize;
+        return true;
+    }
+
+    {
+        // lock all the shards, always in the same order
+        std::array<std::unique_lock<std::mutex>, nbShards> locks;
+        for (int i = 0; i < nbShards; ++i)
+        {
+            locks[i] = std::unique_lock<std::mutex>(_shards[i].mutex);
+        }
+
+        // retrieve missing capacity
+        long long int missingCapacity = memSize + _info.contentSize - _info.capacity;
+
+        // find unused image with size bigger than missing capacity
+        // remove it and add image to cache
+        CacheEntry* entry = nullptr;
+        if (lazyCleaning)
+        {
+            entry = findLru([missingCapacity](const CacheEntry& e) {
+                return e.value.useCount() == 1 && e.value.memorySize() >= static_cast<unsigned long long int>(missingCapacity);
+            });
+            if (entry)
+            {
+                remove(entry);
+                missingCapacity = memSize + _info.contentSize - _info.capacity;
+            }
+        }
+
+        // remove as few unused images as possible
+        while (missingCapacity > 0)
+        {
+            entry = findLru([](const CacheEntry& e) { return e.value.useCount() == 1; });
+            if (!entry)
+            {
+                break;
+            }
+            remove(entry);
+            missingCapacity = memSize + _info.contentSize - _info.capacity;
+        }
+    }
+
+    // add image to cache if it fits in capacity (or maxSize if allowed)
+    if (memSize + _info.contentSize <= (allowOverCapacity ? _info.maxSize : _info.capacity))
+    {
+        _info.contentSize += memSize;
+        return true;
+    }
+    return false;
+}
+
+void ImageCache::insert(int shardIndex, const CacheKey& key, const CacheValue& value, unsigned long long int reservedSize)
+{
+    Shard& shard = _shards[shardIndex];
+    {
+        const std::scoped_lock<std::mutex> lock(shard.mutex);
+
+        shard.loading.erase(key);
+
+        // add to cache as MRU
+        auto it = shard.entries.emplace(key, CacheEntry(value)).first;
+        CacheEntry& entry = it->second;
+        entry.key = &it->first;
+        entry.shardIndex = shardIndex;
+        entry.lastAccess = ++_accessCounter;
+        shard.pushMru(&entry);
+
+        // update memory usage with the actual size of the image
+        _info.nbLoadFromDisk++;
+        _info.nbImages++;
+        _info.contentSize += value.memorySize();
+        _info.contentSize -= reservedSize;
+    }
+    shard.loadDone.notify_all();
+}
+
+void ImageCache::cancelLoading(int shardIndex, const CacheKey& key)
+{
+    Shard& shard = _shards[shardIndex];
+    {
+        const std::scoped_lock<std::mutex> lock(shard.mutex);
+        shard.loading.erase(key);
+    }
+    shard.loadDone.notify_all();
+}
+
+void ImageCache::addPrefetchTasks(std::vector<std::function<void()>>&& tasks)
+{
+    {
+        const std::scoped_lock<std::mutex> lock(_mutexPrefetch);
+        if (_prefetchThreads.empty())
+        {
+            for (int i = 0; i < _nbPrefetchThreads; ++i)
+            {
+                _prefetchThreads.emplace_back(&ImageCache::prefetchWorker, this);
+            }
+        }
+        for (auto& task : tasks)
+        {
+            _prefetchQueue.push_back(std::move(task));
+        }
+    }
+    _prefetchAvailable.notify_all();
+}
+
+void ImageCache::prefetchWorker()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutexPrefetch);
+            _prefetchAvailable.wait(lock, [this]() { return _stopPrefetch || !_prefetchQueue.empty(); });
+            if (_stopPrefetch)
+            {
+                return;
+            }
+            task = std::move(_prefetchQueue.front());
+            _prefetchQueue.pop_front();
+            _nbActivePrefetch++;
+        }
+
+        task();
+
+        {
+            const std::scoped_lock<std::mutex> lock(_mutexPrefetch);
+            _nbActivePrefetch--;
+        }
+        _prefetchDone.notify_all();
+    }
+}
+
+void ImageCache::waitPrefetch()
+{
+    std::unique_lock<std::mutex> lock(_mutexPrefetch);
+    _prefetchDone.wait(lock, [this]() { return _prefetchQueue.empty() && _nbActivePrefetch == 0; });
+}
 
 std::string ImageCache::toString() const
 {
     std::string description = "Image cache content (LRU to MRU): ";
 
-    for (const CacheKey& key : _keys)
     {
-        std::string keyDesc = key.filename + ", nbChannels: " + std::to_string(key.nbChannels) + ", typeDesc: " + std::to_string(key.typeDesc) +
-                              ", downscaleLevel: " + std::to_string(key.downscaleLevel) +
-                              ", usages: " + std::to_string(_imagePtrs.at(key).useCount()) +
-                              ", size: " + std::to_string(_imagePtrs.at(key).memorySize());
-        description += "\n * " + keyDesc;
+        std::array<std::unique_lock<std::mutex>, nbShards> locks;
+        for (int i = 0; i < nbShards; ++i)
+        {
+            locks[i] = std::unique_lock<std::mutex>(_shards[i].mutex);
+        }
+
+        findLru([&description](const CacheEntry& entry) {
+            const CacheKey& key = *entry.key;
+            std::string keyDesc = key.filename + ", nbChannels: " + std::to_string(key.nbChannels) + ", typeDesc: " + std::to_string(key.typeDesc) +
+                                  ", downscaleLevel: " + std::to_string(key.downscaleLevel) +
+                                  ", usages: " + std::to_string(entry.value.useCount()) + ", size: " + std::to_string(entry.value.memorySize());
+            description += "\n * " + keyDesc;
+            return false;
+        });
     }
 
     std::string memUsageDesc = "\nMemory usage: "
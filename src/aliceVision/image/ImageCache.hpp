@@ -16,14 +16,20 @@
 
 #include <boost/functional/hash.hpp>
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
 #include <filesystem>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <functional>
-#include <list>
 #include <mutex>
 #include <thread>
 #include <algorithm>
+#include <vector>
 
 namespace aliceVision {
 namespace image {
@@ -70,6 +76,7 @@ struct CacheKeyHasher
 
 /**
  * @brief A struct to store information about the cache current state and usage.
+ * The counters are updated concurrently by the threads using the cache.
  */
 struct CacheInfo
 {
@@ -78,13 +85,13 @@ struct CacheInfo
     const unsigned long long int maxSize;
 
     /// current state of the cache
-    int nbImages = 0;
-    unsigned long long int contentSize = 0;
+    std::atomic<int> nbImages{0};
+    std::atomic<unsigned long long int> contentSize{0};
 
     /// usage statistics
-    int nbLoadFromDisk = 0;
-    int nbLoadFromCache = 0;
-    int nbRemoveUnused = 0;
+    std::atomic<int> nbLoadFromDisk{0};
+    std::atomic<int> nbLoadFromCache{0};
+    std::atomic<int> nbRemoveUnused{0};
 
     CacheInfo(float capacity_MiB, float maxSize_MiB)
       : capacity(capacity_MiB * 1024 * 1024),
@@ -203,20 +210,32 @@ inline std::shared_ptr<Image<RGBAfColor>> CacheValue::get<RGBAfColor>()
  * or until there is nothing to remove
  * 5. if the image fits in the maximal size, load it, store it and return it
  * 6. the image is too big for the cache, throw an error.
+ *
+ * The cache is split in shards (by filename), each one with its own lock, hash map and LRU list,
+ * so lookups from different threads do not wait for each other and images are decoded in parallel.
+ * Only the removal of images to free some capacity locks the whole cache.
  */
 class ImageCache
 {
   public:
+    /// number of independent parts of the cache
+    static constexpr int nbShards = 16;
+
     /**
      * @brief Create a new image cache by defining memory usage limits and image reading options.
      * @param[in] capacity_MiB the cache capacity (in MiB)
      * @param[in] maxSize_MiB the cache maximal size (in MiB)
      * @param[in] options the reading options that will be used when loading images through this cache
+     * @param[in] statOnce if true, the last write time of a file is only read the first time it is requested,
+     *            the changes of the files on disk during the lifetime of the cache are ignored
+     * @param[in] nbPrefetchThreads the number of background threads loading the prefetched images
+     *            (e.g. HardwareContext::getMaxThreads()), created at the first prefetch request
      */
-    ImageCache(float capacity_MiB, float maxSize_MiB, const ImageReadOptions& options);
+    ImageCache(float capacity_MiB, float maxSize_MiB, const ImageReadOptions& options, bool statOnce = false, int nbPrefetchThreads = 1);
 
     /**
      * @brief Destroy the cache and the unused images it contains.
+     * Pending prefetch requests are discarded.
      */
     ~ImageCache();
 
@@ -247,6 +266,21 @@ class ImageCache
     template<typename TPix>
     bool contains(const std::string& filename, int downscaleLevel = 1) const;
 
+    /**
+     * @brief Load images in the cache in background threads, so that the next calls to get do not wait for the disk.
+     * Images are only prefetched if they fit in the capacity of the cache. Failures are logged and ignored.
+     * @note This method is thread-safe and returns immediately.
+     * @param[in] filenames the images' filenames on disk, in the order they will be loaded
+     * @param[in] downscaleLevel the downscale level
+     */
+    template<typename TPix>
+    void prefetch(const std::vector<std::string>& filenames, int downscaleLevel = 1);
+
+    /**
+     * @brief Wait until all the prefetch requests are done.
+     */
+    void waitPrefetch();
+
     /**
      * @return information on the current cache state and usage
      */
@@ -264,22 +298,120 @@ class ImageCache
     std::string toString() const;
 
   private:
+    /// A cached image, linked in the LRU list of its shard
+    struct CacheEntry
+    {
+        explicit CacheEntry(const CacheValue& v)
+          : value(v)
+        {}
+
+        const CacheKey* key = nullptr;
+        CacheValue value;
+        int shardIndex = 0;
+        /// global access counter value at the last access, to merge the LRU lists of the shards
+        unsigned long long int lastAccess = 0;
+        CacheEntry* prev = nullptr;
+        CacheEntry* next = nullptr;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        /// notified when a load of this shard is done
+        std::condition_variable loadDone;
+        std::unordered_map<CacheKey, CacheEntry, CacheKeyHasher> entries;
+        /// images being loaded by a thread
+        std::unordered_set<CacheKey, CacheKeyHasher> loading;
+        /// last write time of the files (if statOnce)
+        std::unordered_map<std::string, std::time_t> lastWriteTimes;
+        /// intrusive list of the entries, ordered from LRU (Least Recently Used) to MRU (Most Recently Used)
+        CacheEntry* lru = nullptr;
+        CacheEntry* mru = nullptr;
+
+        CacheEntry* find(const CacheKey& key);
+        void pushMru(CacheEntry* entry);
+        void unlink(CacheEntry* entry);
+    };
+
+    int getShardIndex(const std::string& filename) const;
+
+    /**
+     * @brief Get the key of an image in the cache, the shard lock must not be held.
+     */
+    CacheKey makeKey(int shardIndex, const std::string& filename, int nbChannels, oiio::TypeDesc::BASETYPE typeDesc, int downscaleLevel) const;
+
+    /**
+     * @brief Look for an image in a shard and mark it as MRU, the shard lock must be held.
+     * @return the entry or nullptr if the image is not in the cache
+     */
+    CacheEntry* touch(Shard& shard, const CacheKey& key);
+
+    /**
+     * @brief Reserve some memory in the cache for an image that will be loaded, removing unused images if necessary.
+     * @param[in] memSize the memory size of the image
+     * @param[in] lazyCleaning if true, will try lazy cleaning heuristic before LRU cleaning
+     * @param[in] allowOverCapacity if true, the image may be added up to the maximal size
+     * @return false if there is not enough space for the image
+     */
+    bool reserve(unsigned long long int memSize, bool lazyCleaning, bool allowOverCapacity);
+
+    /**
+     * @brief Visit the entries of all the shards from LRU to MRU until the visitor returns true.
+     * All the shard locks must be held.
+     * @return the entry for which the visitor returned true, or nullptr
+     */
+    CacheEntry* findLru(const std::function<bool(const CacheEntry&)>& visitor) const;
+
+    /**
+     * @brief Remove an unused entry from the cache, all the shard locks must be held.
+     */
+    void remove(CacheEntry* entry);
+
+    /**
+     * @brief Add a loaded image to the cache and release the loading state of its key.
+     * @param[in] reservedSize the memory size reserved for this image
+     */
+    void insert(int shardIndex, const CacheKey& key, const CacheValue& value, unsigned long long int reservedSize);
+
+    /**
+     * @brief Release the loading state of a key that could not be loaded.
+     */
+    void cancelLoading(int shardIndex, const CacheKey& key);
+
     /**
      * @brief Load a new image corresponding to the given key and add it as a new entry in the cache.
-     * @param[in] key the key used to identify the entry in the cache
-     * @param[in] lockPeek lock on the peeking mutex, will be released
+     * The key must have been marked as loading by the caller.
+     * @return the image, or nullptr if the image does not fit in the cache
+     * @throws std::runtime_error if the image does not fit in the cache and allowOverCapacity is true
      */
     template<typename TPix>
-    void load(const CacheKey& key, std::unique_lock<std::mutex>& lockPeek);
+    std::shared_ptr<Image<TPix>> load(int shardIndex, const CacheKey& key, bool lazyCleaning, bool allowOverCapacity);
+
+    template<typename TPix>
+    void prefetchImage(const std::string& filename, int downscaleLevel);
+
+    void addPrefetchTasks(std::vector<std::function<void()>>&& tasks);
+
+    void prefetchWorker();
 
     CacheInfo _info;
     ImageReadOptions _options;
-    std::unordered_map<CacheKey, CacheValue, CacheKeyHasher> _imagePtrs;
-    /// ordered from LRU (Least Recently Used) to MRU (Most Recently Used)
-    std::list<CacheKey> _keys;
-
-    mutable std::mutex _mutexGeneral;
-    mutable std::mutex _mutexPeek;
+    const bool _statOnce;
+
+    mutable std::array<Shard, nbShards> _shards;
+    std::atomic<unsigned long long int> _accessCounter{0};
+    /// serializes the memory reservations and the removal of images
+    std::mutex _mutexEviction;
+
+    // background prefetch
+    std::mutex _mutexPrefetch;
+    std::condition_variable _prefetchAvailable;
+    std::condition_variable _prefetchDone;
+    std::deque<std::function<void()>> _prefetchQueue;
+    const int _nbPrefetchThreads;
+    std::vector<std::thread> _prefetchThreads;
+    int _nbActivePrefetch = 0;
+    bool _stopPrefetch = false;
 };
 
 // Since some methods in the ImageCache class are templated
@@ -294,172 +426,163 @@ std::shared_ptr<Image<TPix>> ImageCache::get(const std::string& filename, int do
                                 << "request was made with downscale level " << downscaleLevel);
     }
 
-    std::unique_lock<std::mutex> lockPeek(_mutexPeek);
-
     ALICEVISION_LOG_TRACE("[image] ImageCache: reading " << filename << " with downscale level " << downscaleLevel << " from thread "
                                                          << std::this_thread::get_id());
 
     using TInfo = ColorTypeInfo<TPix>;
 
-    auto lastWriteTime = utils::getLastWriteTime(filename);
-    CacheKey keyReq(filename, TInfo::size, TInfo::typeDesc, downscaleLevel, lastWriteTime);
+    const int shardIndex = getShardIndex(filename);
+    Shard& shard = _shards[shardIndex];
+    const CacheKey keyReq = makeKey(shardIndex, filename, TInfo::size, TInfo::typeDesc, downscaleLevel);
 
     // find the requested image in the cached images
     {
-        auto it = std::find(_keys.begin(), _keys.end(), keyReq);
-        if (it != _keys.end())
-        {
-            // image becomes LRU
-            _keys.erase(it);
-            _keys.push_back(keyReq);
-
-            _info.nbLoadFromCache++;
-
-            ALICEVISION_LOG_TRACE("[image] ImageCache: " << toString());
-            return _imagePtrs.at(keyReq).get<TPix>();
-        }
-        else if (cachedOnly)
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        while (true)
         {
-            return nullptr;
+            if (CacheEntry* entry = touch(shard, keyReq))
+            {
+                _info.nbLoadFromCache++;
+                return entry->value.get<TPix>();
+            }
+            if (cachedOnly)
+            {
+                return nullptr;
+            }
+            if (shard.loading.count(keyReq) == 0)
+            {
+                break;
+            }
+            // the image is being loaded by another thread
+            shard.loadDone.wait(lock);
         }
+        shard.loading.insert(keyReq);
     }
 
-    const std::scoped_lock<std::mutex> lockGeneral(_mutexGeneral);
+    std::shared_ptr<Image<TPix>> img = load<TPix>(shardIndex, keyReq, lazyCleaning, true);
 
-    // retrieve image size
-    int width, height;
-    readImageSize(filename, width, height);
-    unsigned long long int memSize = (width / downscaleLevel) * (height / downscaleLevel) * sizeof(TPix);
+    ALICEVISION_LOG_TRACE("[image] ImageCache: " << toString());
+    return img;
+}
 
-    // add image to cache if it fits in capacity
-    if (memSize + _info.contentSize <= _info.capacity)
+template<typename TPix>
+std::shared_ptr<Image<TPix>> ImageCache::load(int shardIndex, const CacheKey& key, bool lazyCleaning, bool allowOverCapacity)
+{
+    unsigned long long int memSize = 0;
+    std::shared_ptr<Image<TPix>> img;
+    try
     {
-        load<TPix>(keyReq, lockPeek);
-
-        ALICEVISION_LOG_TRACE("[image] ImageCache: " << toString());
-        return _imagePtrs.at(keyReq).get<TPix>();
-    }
+        // retrieve image size
+        int width, height;
+        readImageSize(key.filename, width, height);
+        memSize = (width / key.downscaleLevel) * (height / key.downscaleLevel) * sizeof(TPix);
 
-    // retrieve missing capacity
-    long long int missingCapacity = memSize + _info.contentSize - _info.capacity;
-
-    // find unused image with size bigger than missing capacity
-    // remove it and add image to cache
-    if (lazyCleaning)
-    {
-        auto it = _keys.begin();
-        while (it != _keys.end())
+        if (!reserve(memSize, lazyCleaning, allowOverCapacity))
         {
-            const CacheKey& key = *it;
-            const CacheValue& value = _imagePtrs.at(key);
-            if (value.useCount() == 1 && value.memorySize() >= missingCapacity)
+            cancelLoading(shardIndex, key);
+            if (allowOverCapacity)
             {
-                _info.nbImages--;
-                _info.contentSize -= value.memorySize();
-                _imagePtrs.erase(key);
-                _keys.erase(it);
-
-                _info.nbRemoveUnused++;
-
-                load<TPix>(keyReq, lockPeek);
-
-                ALICEVISION_LOG_TRACE("[image] ImageCache: " << toString());
-                return _imagePtrs.at(keyReq).get<TPix>();
+                ALICEVISION_THROW_ERROR("[image] ImageCache: failed to load image \n" << toString());
             }
-            ++it;
+            return nullptr;
         }
     }
-
-    // remove as few unused images as possible
-    while (missingCapacity > 0)
+    catch (...)
     {
-        auto it = std::find_if(_keys.begin(), _keys.end(), [this](const CacheKey& k) { return _imagePtrs.at(k).useCount() == 1; });
-
-        if (it != _keys.end())
-        {
-            const CacheKey& key = *it;
-            const CacheValue& value = _imagePtrs.at(key);
+        cancelLoading(shardIndex, key);
+        throw;
+    }
 
-            _info.nbImages--;
-            _info.contentSize -= value.memorySize();
-            _imagePtrs.erase(key);
-            _keys.erase(it);
+    try
+    {
+        img = std::make_shared<Image<TPix>>();
 
-            _info.nbRemoveUnused++;
+        // load image from disk
+        readImage(key.filename, *img, _options);
 
-            missingCapacity = memSize + _info.contentSize - _info.capacity;
-        }
-        else
+        // apply downscale
+        if (key.downscaleLevel > 1)
         {
-            break;
+            imageAlgo::resizeImage(key.downscaleLevel, *img);
         }
     }
-
-    // add image to cache if it fits in maxSize
-    if (memSize + _info.contentSize <= _info.maxSize)
+    catch (...)
     {
-        load<TPix>(keyReq, lockPeek);
-
-        ALICEVISION_LOG_TRACE("[image] ImageCache: " << toString());
-        return _imagePtrs.at(keyReq).get<TPix>();
+        _info.contentSize -= memSize;
+        cancelLoading(shardIndex, key);
+        throw;
     }
 
-    ALICEVISION_THROW_ERROR("[image] ImageCache: failed to load image \n" << toString());
-
-    return nullptr;
+    insert(shardIndex, key, CacheValue::wrap(img), memSize);
+    return img;
 }
 
 template<typename TPix>
-void ImageCache::load(const CacheKey& key, std::unique_lock<std::mutex>& lockPeek)
+bool ImageCache::contains(const std::string& filename, int downscaleLevel) const
 {
-    lockPeek.unlock();
-
-    auto img = std::make_shared<Image<TPix>>();
-
-    // load image from disk
-    readImage(key.filename, *img, _options);
-
-    // apply downscale
-    if (key.downscaleLevel > 1)
+    if (downscaleLevel < 1)
     {
-        imageAlgo::resizeImage(key.downscaleLevel, *img);
+        ALICEVISION_THROW_ERROR("[image] ImageCache: cannot contain image with downscale level < 1, "
+                                << "request was made with downscale level " << downscaleLevel);
     }
 
-    lockPeek.lock();
-
-    _info.nbLoadFromDisk++;
-
-    // create wrapper around shared pointer
-    CacheValue value = CacheValue::wrap(img);
+    using TInfo = ColorTypeInfo<TPix>;
 
-    // add to cache as MRU
-    _imagePtrs.insert({key, value});
-    _keys.push_back(key);
+    const int shardIndex = getShardIndex(filename);
+    Shard& shard = _shards[shardIndex];
+    const CacheKey keyReq = makeKey(shardIndex, filename, TInfo::size, TInfo::typeDesc, downscaleLevel);
 
-    // update memory usage
-    _info.nbImages++;
-    _info.contentSize += value.memorySize();
+    const std::scoped_lock<std::mutex> lock(shard.mutex);
+    return shard.entries.count(keyReq) > 0;
 }
 
 template<typename TPix>
-bool ImageCache::contains(const std::string& filename, int downscaleLevel) const
+void ImageCache::prefetch(const std::vector<std::string>& filenames, int downscaleLevel)
 {
     if (downscaleLevel < 1)
     {
-        ALICEVISION_THROW_ERROR("[image] ImageCache: cannot contain image with downscale level < 1, "
+        ALICEVISION_THROW_ERROR("[image] ImageCache: cannot prefetch image with downscale level < 1, "
                                 << "request was made with downscale level " << downscaleLevel);
     }
 
-    const std::scoped_lock<std::mutex> lockPeek(_mutexPeek);
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(filenames.size());
+    for (const std::string& filename : filenames)
+    {
+        tasks.emplace_back([this, filename, downscaleLevel]() { prefetchImage<TPix>(filename, downscaleLevel); });
+    }
+    addPrefetchTasks(std::move(tasks));
+}
 
+template<typename TPix>
+void ImageCache::prefetchImage(const std::string& filename, int downscaleLevel)
+{
     using TInfo = ColorTypeInfo<TPix>;
 
-    auto lastWriteTime = utils::getLastWriteTime(filename);
-    CacheKey keyReq(filename, TInfo::size, TInfo::typeDesc, downscaleLevel, lastWriteTime);
+    const int shardIndex = getShardIndex(filename);
+    Shard& shard = _shards[shardIndex];
+    const CacheKey key = makeKey(shardIndex, filename, TInfo::size, TInfo::typeDesc, downscaleLevel);
 
-    auto it = std::find(_keys.begin(), _keys.end(), keyReq);
+    {
+        const std::scoped_lock<std::mutex> lock(shard.mutex);
+        if (shard.entries.count(key) > 0 || shard.loading.count(key) > 0)
+        {
+            return;
+        }
+        shard.loading.insert(key);
+    }
 
-    return it != _keys.end();
+    try
+    {
+        if (!load<TPix>(shardIndex, key, true, false))
+        {
+            ALICEVISION_LOG_DEBUG("[image] ImageCache: not enough capacity to prefetch " << filename);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        ALICEVISION_LOG_WARNING("[image] ImageCache: failed to prefetch " << filename << ":" << std::endl << e.what());
+    }
 }
 
 }  // namespace image
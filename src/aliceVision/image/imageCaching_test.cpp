@@ -10,6 +10,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <thread>
+#include <vector>
+
 using namespace aliceVision;
 using namespace aliceVision::image;
 
@@ -56,3 +59,63 @@ BOOST_AUTO_TEST_CASE(load_all_pixel_types)
     BOOST_CHECK_EQUAL(cache.info().nbImages, 6);
     BOOST_CHECK_EQUAL(cache.info().nbLoadFromDisk, 6);
 }
+
+BOOST_AUTO_TEST_CASE(load_image_concurrently)
+{
+    ImageCache cache(256, 1024, EImageColorSpace::LINEAR, true);
+    const std::string filename = std::string(THIS_SOURCE_DIR) + "/image_test/lena.png";
+
+    std::vector<std::shared_ptr<Image<RGBfColor>>> images(8);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < images.size(); ++i)
+    {
+        threads.emplace_back([&cache, &images, &filename, i]() { images[i] = cache.get<RGBfColor>(filename); });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const auto& img : images)
+    {
+        BOOST_CHECK_EQUAL(img, images.front());
+    }
+    BOOST_CHECK_EQUAL(cache.info().nbImages, 1);
+    BOOST_CHECK_EQUAL(cache.info().nbLoadFromDisk, 1);
+    BOOST_CHECK_EQUAL(cache.info().nbLoadFromCache, static_cast<int>(images.size()) - 1);
+}
+
+BOOST_AUTO_TEST_CASE(prefetch_images)
+{
+    ImageCache cache(256, 1024, EImageColorSpace::LINEAR, false, 2);
+    const std::string filename = std::string(THIS_SOURCE_DIR) + "/image_test/lena.png";
+    const std::string missingFilename = std::string(THIS_SOURCE_DIR) + "/image_test/missing.png";
+
+    cache.prefetch<RGBAfColor>({filename, missingFilename});
+    cache.prefetch<RGBAfColor>({filename}, 2);
+    cache.waitPrefetch();
+    BOOST_CHECK(cache.contains<RGBAfColor>(filename));
+    BOOST_CHECK(cache.contains<RGBAfColor>(filename, 2));
+    BOOST_CHECK(!cache.contains<RGBAfColor>(missingFilename));
+    BOOST_CHECK_EQUAL(cache.info().nbImages, 2);
+    BOOST_CHECK_EQUAL(cache.info().nbLoadFromDisk, 2);
+
+    auto img = cache.get<RGBAfColor>(filename);
+    BOOST_CHECK_EQUAL(cache.info().nbLoadFromDisk, 2);
+    BOOST_CHECK_EQUAL(cache.info().nbLoadFromCache, 1);
+}
+
+BOOST_AUTO_TEST_CASE(prefetch_without_capacity)
+{
+    ImageCache cache(0, 1024, EImageColorSpace::LINEAR);
+    const std::string filename = std::string(THIS_SOURCE_DIR) + "/image_test/lena.png";
+
+    // prefetched images must fit in the capacity
+    cache.prefetch<RGBAfColor>({filename});
+    cache.waitPrefetch();
+    BOOST_CHECK_EQUAL(cache.info().nbImages, 0);
+
+    // requested images may use the space up to the maximal size
+    auto img = cache.get<RGBAfColor>(filename);
+    BOOST_CHECK_EQUAL(cache.info().nbImages, 1);
+}
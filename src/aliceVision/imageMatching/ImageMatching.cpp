@@ -263,12 +263,13 @@ void generateFromVoctree(PairList& allMatches,
         const IndexT viewIdA = itA->first;
         const std::string featuresPathA = itA->second;
 
-        aliceVision::voctree::SparseHistogram imageSH;
+        aliceVision::voctree::SparseHistogram computedSH;
+        const aliceVision::voctree::SparseHistogram* imageSH = &computedSH;
 
         if (modeMultiSfM != EImageMatchingMode::A_B)
         {
             // sparse histogram of A is already computed in the DB
-            imageSH = db.getSparseHistogramPerImage().at(viewIdA);
+            imageSH = &db.getSparseHistogramPerImage().at(viewIdA);
         }
         else  // mode AB
         {
@@ -276,12 +277,12 @@ void generateFromVoctree(PairList& allMatches,
             std::vector<DescriptorUChar> descriptors;
             // read the descriptors
             loadDescsFromBinFile(featuresPathA, descriptors, false, nbMaxDescriptors);
-            imageSH = tree.quantizeToSparse(descriptors);
+            computedSH = tree.quantizeToSparse(descriptors);
         }
 
         std::vector<aliceVision::voctree::DocMatch> matches;
 
-        db.find(imageSH, numImageQuery, matches);
+        db.find(*imageSH, numImageQuery, matches);
 
         ListOfImageID& imgMatches = allMatches.at(viewIdA);
         imgMatches.reserve(imgMatches.size() + matches.size());
@@ -0,0 +1,189 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/matching/ArrayMatcher.hpp>
+#include <aliceVision/feature/metric.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief Exhaustive L2 matcher computing all the squared distances between a block of queries
+ * and a block of the database as one matrix product: |q|^2 + |d|^2 - 2 q.d
+ *
+ * Descriptors are converted once to the distance type (float for uchar/float descriptors)
+ * and the products are delegated to Eigen, which uses the widest SIMD instruction set enabled
+ * at compile time. Blocks are sized to stay in cache and the N best neighbours are selected
+ * while scanning each block, so the full distance matrix is never stored.
+ *
+ * The result is the same as ArrayMatcher_bruteForce with a squared L2 metric, up to the
+ * floating point rounding of the expansion (exact for SIFT uchar descriptors).
+ */
+template<typename Scalar = float, typename Metric = feature::L2_Vectorized<Scalar>>
+class ArrayMatcher_bruteForceGemm : public ArrayMatcher<Scalar, Metric>
+{
+  public:
+    typedef typename Metric::ResultType DistanceType;
+
+    /// Number of query descriptors processed together
+    static constexpr int queryBlockSize = 256;
+    /// Number of database descriptors processed together
+    static constexpr int databaseBlockSize = 1024;
+
+    ArrayMatcher_bruteForceGemm() {}
+    virtual ~ArrayMatcher_bruteForceGemm() {}
+
+    /**
+     * Build the matching structure
+     *
+     * \param[in] dataset   Input data.
+     * \param[in] nbRows    The number of component.
+     * \param[in] dimension Length of the data contained in the dataset.
+     *
+     * \return True if success.
+     */
+    bool Build(std::mt19937& randomNumberGenerator, const Scalar* dataset, int nbRows, int dimension)
+    {
+        if (nbRows < 1)
+        {
+            _database.resize(0, 0);
+            _databaseSquaredNorms.resize(0);
+            return false;
+        }
+        _database = Eigen::Map<const ScalarMat>(dataset, nbRows, dimension).template cast<DistanceType>();
+        _databaseSquaredNorms = _database.rowwise().squaredNorm();
+        return true;
+    }
+
+    /**
+     * Search the nearest Neighbor of the scalar array query.
+     *
+     * \param[in]   query     The query array
+     * \param[out]  indice    The indice of array in the dataset that
+     *  have been computed as the nearest array.
+     * \param[out]  distance  The distance between the two arrays.
+     *
+     * \return True if success.
+     */
+    bool SearchNeighbour(const Scalar* query, int* indice, DistanceType* distance)
+    {
+        IndMatches indices;
+        std::vector<DistanceType> distances;
+        if (!SearchNeighbours(query, 1, &indices, &distances, 1))
+            return false;
+        *indice = indices.front()._j;
+        *distance = distances.front();
+        return true;
+    }
+
+    /**
+     * Search the N nearest Neighbor of the scalar array query.
+     *
+     * \param[in]   query     The query array
+     * \param[in]   nbQuery   The number of query rows
+     * \param[out]  indices   The corresponding (query, neighbor) indices
+     * \param[out]  distances The distances between the matched arrays.
+     * \param[out]  NN        The number of maximal neighbor that will be searched.
+     *
+     * \return True if success.
+     */
+    bool SearchNeighbours(const Scalar* query, int nbQuery, IndMatches* pvec_indices, std::vector<DistanceType>* pvec_distances, size_t NN)
+    {
+        const int nbRows = static_cast<int>(_database.rows());
+        const int dimension = static_cast<int>(_database.cols());
+
+        if (nbRows == 0 || NN > static_cast<size_t>(nbRows) || nbQuery < 1)
+            return false;
+
+        const Eigen::Map<const ScalarMat> mat_query(query, nbQuery, dimension);
+
+        pvec_distances->resize(nbQuery * NN);
+        pvec_indices->resize(nbQuery * NN);
+
+        const int nbQueryBlocks = (nbQuery + queryBlockSize - 1) / queryBlockSize;
+
+#pragma omp parallel for schedule(dynamic)
+        for (int queryBlock = 0; queryBlock < nbQueryBlocks; ++queryBlock)
+        {
+            const int queryBegin = queryBlock * queryBlockSize;
+            const int queryCount = std::min(queryBlockSize, nbQuery - queryBegin);
+
+            const DistanceMat queries = mat_query.middleRows(queryBegin, queryCount).template cast<DistanceType>();
+            const DistanceVec queriesSquaredNorms = queries.rowwise().squaredNorm();
+
+            // per query sorted list of the NN best (distance, index)
+            std::vector<DistanceType> bestDistances(queryCount * NN, std::numeric_limits<DistanceType>::max());
+            std::vector<int> bestIndices(queryCount * NN, -1);
+
+            DistanceMat products;
+            for (int databaseBegin = 0; databaseBegin < nbRows; databaseBegin += databaseBlockSize)
+            {
+                const int databaseCount = std::min(databaseBlockSize, nbRows - databaseBegin);
+
+                // q.d for all the (query, database) pairs of the two blocks
+                products.noalias() = queries * _database.middleRows(databaseBegin, databaseCount).transpose();
+
+                for (int q = 0; q < queryCount; ++q)
+                {
+                    DistanceType* qBestDistances = &bestDistances[q * NN];
+                    int* qBestIndices = &bestIndices[q * NN];
+                    const DistanceType queryNorm = queriesSquaredNorms(q);
+
+                    for (int d = 0; d < databaseCount; ++d)
+                    {
+                        DistanceType dist = queryNorm + _databaseSquaredNorms(databaseBegin + d) - 2 * products(q, d);
+                        dist = std::max(dist, DistanceType(0));
+
+                        if (dist >= qBestDistances[NN - 1])
+                            continue;
+
+                        // insertion in the sorted list of the best neighbours
+                        std::size_t k = NN - 1;
+                        while (k > 0 && qBestDistances[k - 1] > dist)
+                        {
+                            qBestDistances[k] = qBestDistances[k - 1];
+                            qBestIndices[k] = qBestIndices[k - 1];
+                            --k;
+                        }
+                        qBestDistances[k] = dist;
+                        qBestIndices[k] = databaseBegin + d;
+                    }
+                }
+            }
+
+            for (int q = 0; q < queryCount; ++q)
+            {
+                const int queryIndex = queryBegin + q;
+                for (std::size_t k = 0; k < NN; ++k)
+                {
+                    (*pvec_distances)[queryIndex * NN + k] = bestDistances[q * NN + k];
+                    (*pvec_indices)[queryIndex * NN + k] = IndMatch(queryIndex, bestIndices[q * NN + k]);
+                }
+            }
+        }
+        return true;
+    }
+
+  private:
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> ScalarMat;
+    typedef Eigen::Matrix<DistanceType, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> DistanceMat;
+    typedef Eigen::Matrix<DistanceType, Eigen::Dynamic, 1> DistanceVec;
+
+    /// Database descriptors converted to the distance type
+    DistanceMat _database;
+    /// Squared norm of each database descriptor
+    DistanceVec _databaseSquaredNorms;
+};
+
+}  // namespace matching
+}  // namespace aliceVision
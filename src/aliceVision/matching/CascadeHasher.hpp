@@ -8,35 +8,100 @@
 #pragma once
 
 #include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/feature/metric.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/stl/DynamicBitset.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <random>
 #include <cmath>
+#include <vector>
 
 namespace aliceVision {
 namespace matching {
 
-struct HashedDescription
+/**
+ * Hashed descriptions of a set of descriptors.
+ *
+ * All the data are stored in flat contiguous arrays, so that the index of an image
+ * can be built once and scanned efficiently when it is matched against many images.
+ */
+struct HashedDescriptions
 {
-    // Hash code generated by the primary hashing function.
-    stl::dynamic_bitset hash_code;
+    typedef stl::dynamic_bitset::BlockType BlockType;
+
+    // The number of hashed descriptions.
+    int nb_descriptions = 0;
+    // The number of blocks of a hash code.
+    int nb_hash_code_blocks = 0;
+    // The number of bucket groups.
+    int nb_bucket_groups = 0;
+    // The number of buckets in each group.
+    int nb_buckets_per_group = 0;
+
+    // hash_codes[i * nb_hash_code_blocks + k] is the k-th block of the hash code
+    // generated by the primary hashing function for the description i.
+    std::vector<BlockType> hash_codes;
 
-    // Each bucket_ids[x] = y means the descriptor belongs to bucket y in bucket
-    // group x.
+    // bucket_ids[i * nb_bucket_groups + x] = y means the description i belongs to
+    // bucket y in bucket group x.
     std::vector<uint16_t> bucket_ids;
+
+    // Buckets stored as a compressed sparse row structure: the description ids of
+    // bucket y in bucket group x are bucket_content[bucket_offsets[x * (nb_buckets_per_group + 1) + y]]
+    // up to bucket_content[bucket_offsets[x * (nb_buckets_per_group + 1) + y + 1]].
+    std::vector<int> bucket_offsets;
+    std::vector<int> bucket_content;
+
+    const BlockType* hashCode(int i) const { return &hash_codes[static_cast<std::size_t>(i) * nb_hash_code_blocks]; }
+
+    const uint16_t* bucketIds(int i) const { return &bucket_ids[static_cast<std::size_t>(i) * nb_bucket_groups]; }
+
+    const int* bucketBegin(int bucket_group, uint16_t bucket_id) const
+    {
+        return bucket_content.data() + bucket_offsets[bucket_group * (nb_buckets_per_group + 1) + bucket_id];
+    }
+
+    const int* bucketEnd(int bucket_group, uint16_t bucket_id) const
+    {
+        return bucket_content.data() + bucket_offsets[bucket_group * (nb_buckets_per_group + 1) + bucket_id + 1];
+    }
 };
 
-struct HashedDescriptions
+/**
+ * Working buffers of CascadeHasher::Match_HashedDescriptions.
+ * They can be kept and reused across successive matchings to avoid allocations.
+ */
+struct CascadeHashingMatchBuffers
 {
-    // The hash information.
-    std::vector<HashedDescription> hashed_desc;
+    // The distinct candidate descriptors of the current query and their hamming distances.
+    std::vector<int> candidate_descriptors;
+    std::vector<int> candidate_hamming_distances;
+    // num_descriptors_with_hamming_distance[d] is the number of candidates at hamming distance d.
+    std::vector<int> num_descriptors_with_hamming_distance;
+    // visit_stamps[id] == current_stamp means the descriptor id is already a candidate
+    // of the current query (prevents duplicates without clearing a whole array per query).
+    std::vector<unsigned int> visit_stamps;
+    unsigned int current_stamp = 0;
+
+    void prepare(int nb_descriptions, int nb_hash_code)
+    {
+        if (visit_stamps.size() < static_cast<std::size_t>(nb_descriptions))
+            visit_stamps.resize(nb_descriptions, 0);
+        num_descriptors_with_hamming_distance.resize(nb_hash_code + 1);
+    }
 
-    typedef std::vector<int> Bucket;
-    // buckets[bucket_group][bucket_id] = bucket (container of description ids).
-    std::vector<std::vector<Bucket>> buckets;
+    unsigned int nextStamp()
+    {
+        if (++current_stamp == 0)
+        {
+            std::fill(visit_stamps.begin(), visit_stamps.end(), 0);
+            current_stamp = 1;
+        }
+        return current_stamp;
+    }
 };
 
 /**
@@ -139,67 +204,84 @@ class CascadeHasher
         //   1) Compute hash code and hash buckets (based on the zero_mean_descriptor).
         //   2) Construct buckets.
 
+        typedef HashedDescriptions::BlockType BlockType;
+        const int bits_per_block = stl::dynamic_bitset::bits_per_block;
+
         HashedDescriptions hashed_descriptions;
+        hashed_descriptions.nb_descriptions = static_cast<int>(descriptions.rows());
+        hashed_descriptions.nb_hash_code_blocks = (nb_hash_code_ + bits_per_block - 1) / bits_per_block;
+        hashed_descriptions.nb_bucket_groups = nb_bucket_groups_;
+        hashed_descriptions.nb_buckets_per_group = nb_buckets_per_group_;
+        hashed_descriptions.bucket_offsets.assign(nb_bucket_groups_ * (nb_buckets_per_group_ + 1), 0);
         if (descriptions.rows() == 0)
         {
             return hashed_descriptions;
         }
 
+        const int nbDescriptions = hashed_descriptions.nb_descriptions;
+
         // Create hash codes for each description.
         {
-            // Allocate space for hash codes.
-            const typename MatrixT::Index nbDescriptions = descriptions.rows();
-            hashed_descriptions.hashed_desc.resize(nbDescriptions);
-            Eigen::VectorXf descriptor(descriptions.cols());
-            for (int i = 0; i < nbDescriptions; ++i)
-            {
-                // Allocate space for each bucket id.
-                hashed_descriptions.hashed_desc[i].bucket_ids.resize(nb_bucket_groups_);
+            hashed_descriptions.hash_codes.assign(static_cast<std::size_t>(nbDescriptions) * hashed_descriptions.nb_hash_code_blocks, 0);
+            hashed_descriptions.bucket_ids.resize(static_cast<std::size_t>(nbDescriptions) * nb_bucket_groups_);
 
-                for (int k = 0; k < descriptions.cols(); ++k)
-                {
-                    descriptor(k) = descriptions(i, k);
-                }
-                descriptor -= zero_mean_descriptor;
-
-                auto& hash_code = hashed_descriptions.hashed_desc[i].hash_code;
-                hash_code = stl::dynamic_bitset(descriptions.cols());
+            // Project all the zero mean descriptors at once (one descriptor per column).
+            const Eigen::MatrixXf centered_descriptions =
+              descriptions.template cast<float>().transpose().colwise() - zero_mean_descriptor;
+            const Eigen::MatrixXf primary_projection = primary_hash_projection_ * centered_descriptions;
 
+            for (int i = 0; i < nbDescriptions; ++i)
+            {
                 // Compute hash code.
-                const Eigen::VectorXf primary_projection = primary_hash_projection_ * descriptor;
+                BlockType* hash_code = &hashed_descriptions.hash_codes[static_cast<std::size_t>(i) * hashed_descriptions.nb_hash_code_blocks];
                 for (int j = 0; j < nb_hash_code_; ++j)
                 {
-                    hash_code[j] = primary_projection(j) > 0;
+                    if (primary_projection(j, i) > 0)
+                        hash_code[j / bits_per_block] |= BlockType(1) << (j % bits_per_block);
                 }
+            }
 
-                // Determine the bucket index for each group.
-                Eigen::VectorXf secondary_projection;
-                for (int j = 0; j < nb_bucket_groups_; ++j)
+            // Determine the bucket index for each group.
+            Eigen::MatrixXf secondary_projection;
+            for (int j = 0; j < nb_bucket_groups_; ++j)
+            {
+                secondary_projection.noalias() = secondary_hash_projection_[j] * centered_descriptions;
+                for (int i = 0; i < nbDescriptions; ++i)
                 {
                     uint16_t bucket_id = 0;
-                    secondary_projection = secondary_hash_projection_[j] * descriptor;
-
                     for (int k = 0; k < nb_bits_per_bucket_; ++k)
                     {
-                        bucket_id = (bucket_id << 1) + (secondary_projection(k) > 0 ? 1 : 0);
+                        bucket_id = (bucket_id << 1) + (secondary_projection(k, i) > 0 ? 1 : 0);
                     }
-                    hashed_descriptions.hashed_desc[i].bucket_ids[j] = bucket_id;
+                    hashed_descriptions.bucket_ids[static_cast<std::size_t>(i) * nb_bucket_groups_ + j] = bucket_id;
                 }
             }
         }
         // Build the Buckets
         {
-            hashed_descriptions.buckets.resize(nb_bucket_groups_);
+            hashed_descriptions.bucket_content.resize(static_cast<std::size_t>(nb_bucket_groups_) * nbDescriptions);
             for (int i = 0; i < nb_bucket_groups_; ++i)
             {
-                hashed_descriptions.buckets[i].resize(nb_buckets_per_group_);
+                int* offsets = &hashed_descriptions.bucket_offsets[i * (nb_buckets_per_group_ + 1)];
+                int* content = &hashed_descriptions.bucket_content[static_cast<std::size_t>(i) * nbDescriptions];
+
+                // Count the descriptors of each bucket.
+                for (int j = 0; j < nbDescriptions; ++j)
+                    ++offsets[hashed_descriptions.bucketIds(j)[i] + 1];
+                for (int b = 0; b < nb_buckets_per_group_; ++b)
+                    offsets[b + 1] += offsets[b];
 
                 // Add the descriptor ID to the proper bucket group and id.
-                for (int j = 0; j < hashed_descriptions.hashed_desc.size(); ++j)
+                std::vector<int> fill(offsets, offsets + nb_buckets_per_group_);
+                for (int j = 0; j < nbDescriptions; ++j)
                 {
-                    const uint16_t bucket_id = hashed_descriptions.hashed_desc[j].bucket_ids[i];
-                    hashed_descriptions.buckets[i][bucket_id].push_back(j);
+                    const uint16_t bucket_id = hashed_descriptions.bucketIds(j)[i];
+                    content[fill[bucket_id]++] = j;
                 }
+
+                // Offsets are relative to the whole content array.
+                for (int b = 0; b <= nb_buckets_per_group_; ++b)
+                    offsets[b] += i * nbDescriptions;
             }
         }
         return hashed_descriptions;
@@ -215,87 +297,205 @@ class CascadeHasher
                                   IndMatches* pvec_indices,
                                   std::vector<DistanceType>* pvec_distances,
                                   const int NN = 2) const
+    {
+        CascadeHashingMatchBuffers buffers;
+        Match_HashedDescriptions(hashed_descriptions1, descriptions1, hashed_descriptions2, descriptions2, pvec_indices, pvec_distances, buffers, NN);
+    }
+
+    // Matches two collection of hashed descriptions with a fast matching scheme
+    // based on the hash codes previously generated, using preallocated working buffers.
+    template<typename MatrixT, typename DistanceType>
+    void Match_HashedDescriptions(const HashedDescriptions& hashed_descriptions1,
+                                  const MatrixT& descriptions1,
+                                  const HashedDescriptions& hashed_descriptions2,
+                                  const MatrixT& descriptions2,
+                                  IndMatches* pvec_indices,
+                                  std::vector<DistanceType>* pvec_distances,
+                                  CascadeHashingMatchBuffers& buffers,
+                                  const int NN = 2) const
+    {
+        Match_HashedDescriptionsRange(hashed_descriptions1,
+                                      descriptions1,
+                                      0,
+                                      hashed_descriptions1.nb_descriptions,
+                                      hashed_descriptions2,
+                                      descriptions2,
+                                      pvec_indices,
+                                      pvec_distances,
+                                      buffers,
+                                      NN);
+    }
+
+    // Matches the hashed descriptions of several query images against the same
+    // database image (batched multi-target query of a persistent index).
+    // The query descriptions are split in blocks matched in parallel, so the work is
+    // balanced even with a few large query images, and the database buckets are
+    // shared by all the threads. The matches of each query image are the same as
+    // the ones of Match_HashedDescriptions(query, database).
+    // It must be called outside of an OpenMP parallel region to run in parallel.
+    template<typename MatrixT, typename DistanceType>
+    void Match_HashedDescriptionsBatch(const std::vector<const HashedDescriptions*>& hashed_queries,
+                                       const std::vector<const MatrixT*>& queries,
+                                       const HashedDescriptions& hashed_database,
+                                       const MatrixT& database,
+                                       std::vector<IndMatches>& indices_per_query,
+                                       std::vector<std::vector<DistanceType>>& distances_per_query,
+                                       std::vector<CascadeHashingMatchBuffers>& buffers_per_thread,
+                                       const int NN = 2) const
+    {
+        static const int kBlockSize = 1024;
+
+        const std::size_t nb_queries = hashed_queries.size();
+        indices_per_query.assign(nb_queries, IndMatches());
+        distances_per_query.assign(nb_queries, std::vector<DistanceType>());
+
+        // (query image, first description) of each block
+        std::vector<std::pair<int, int>> blocks;
+        for (std::size_t q = 0; q < nb_queries; ++q)
+        {
+            for (int begin = 0; begin < hashed_queries[q]->nb_descriptions; begin += kBlockSize)
+                blocks.emplace_back(static_cast<int>(q), begin);
+        }
+
+        std::vector<IndMatches> block_indices(blocks.size());
+        std::vector<std::vector<DistanceType>> block_distances(blocks.size());
+
+        const bool parallel = !omp_in_parallel();
+        const std::size_t nb_buffers = parallel ? omp_get_max_threads() : 1;
+        if (buffers_per_thread.size() < nb_buffers)
+            buffers_per_thread.resize(nb_buffers);
+
+#pragma omp parallel for schedule(dynamic) if (parallel)
+        for (int b = 0; b < static_cast<int>(blocks.size()); ++b)
+        {
+            const int q = blocks[b].first;
+            const int begin = blocks[b].second;
+            const int end = std::min(begin + kBlockSize, hashed_queries[q]->nb_descriptions);
+            Match_HashedDescriptionsRange(*hashed_queries[q],
+                                          *queries[q],
+                                          begin,
+                                          end,
+                                          hashed_database,
+                                          database,
+                                          &block_indices[b],
+                                          &block_distances[b],
+                                          buffers_per_thread[parallel ? omp_get_thread_num() : 0],
+                                          NN);
+        }
+
+        // Concatenate the blocks of each query image in order.
+        for (std::size_t b = 0; b < blocks.size(); ++b)
+        {
+            const int q = blocks[b].first;
+            indices_per_query[q].insert(indices_per_query[q].end(), block_indices[b].begin(), block_indices[b].end());
+            distances_per_query[q].insert(distances_per_query[q].end(), block_distances[b].begin(), block_distances[b].end());
+        }
+    }
+
+  private:
+    // Matches the hashed descriptions [begin, end) of the first collection
+    // against the second collection.
+    template<typename MatrixT, typename DistanceType>
+    void Match_HashedDescriptionsRange(const HashedDescriptions& hashed_descriptions1,
+                                       const MatrixT& descriptions1,
+                                       const int begin,
+                                       const int end,
+                                       const HashedDescriptions& hashed_descriptions2,
+                                       const MatrixT& descriptions2,
+                                       IndMatches* pvec_indices,
+                                       std::vector<DistanceType>* pvec_distances,
+                                       CascadeHashingMatchBuffers& buffers,
+                                       const int NN) const
     {
         typedef feature::L2_Vectorized<typename MatrixT::Scalar> MetricT;
         MetricT metric;
 
         static const int kNumTopCandidates = 10;
 
-        // Preallocate the candidate descriptors container.
-        std::vector<int> candidate_descriptors;
-        candidate_descriptors.reserve(hashed_descriptions2.hashed_desc.size());
+        if (hashed_descriptions1.nb_descriptions == 0 || hashed_descriptions2.nb_descriptions == 0)
+            return;
 
-        // Preallocated hamming distances. Each column indicates the hamming distance
-        // and the rows collect the descriptor ids with that
-        // distance. num_descriptors_with_hamming_distance keeps track of how many
-        // descriptors have that distance.
-        Eigen::MatrixXi candidate_hamming_distances(hashed_descriptions2.hashed_desc.size(), nb_hash_code_ + 1);
-        Eigen::VectorXi num_descriptors_with_hamming_distance(nb_hash_code_ + 1);
+        buffers.prepare(hashed_descriptions2.nb_descriptions, nb_hash_code_);
+        std::vector<int>& candidate_descriptors = buffers.candidate_descriptors;
+        std::vector<int>& candidate_hamming_distances = buffers.candidate_hamming_distances;
+        std::vector<int>& num_descriptors_with_hamming_distance = buffers.num_descriptors_with_hamming_distance;
 
         // Preallocate the container for keeping euclidean distances.
         std::vector<std::pair<DistanceType, int>> candidate_euclidean_distances;
         candidate_euclidean_distances.reserve(kNumTopCandidates);
 
-        // A preallocated vector to determine if we have already used a particular
-        // feature for matching (i.e., prevents duplicates).
-        std::vector<bool> used_descriptor(hashed_descriptions2.hashed_desc.size());
-
-        typedef feature::Hamming<stl::dynamic_bitset::BlockType> HammingMetricType;
+        typedef feature::Hamming<HashedDescriptions::BlockType> HammingMetricType;
         static const HammingMetricType metricH = {};
-        for (int i = 0; i < hashed_descriptions1.hashed_desc.size(); ++i)
+        const int nb_hash_code_blocks = hashed_descriptions1.nb_hash_code_blocks;
+
+        for (int i = begin; i < end; ++i)
         {
             candidate_descriptors.clear();
-            num_descriptors_with_hamming_distance.setZero();
+            candidate_hamming_distances.clear();
+            std::fill(num_descriptors_with_hamming_distance.begin(), num_descriptors_with_hamming_distance.end(), 0);
             candidate_euclidean_distances.clear();
 
-            const auto& hashed_desc = hashed_descriptions1.hashed_desc[i];
+            const HashedDescriptions::BlockType* hash_code = hashed_descriptions1.hashCode(i);
+            const uint16_t* bucket_ids = hashed_descriptions1.bucketIds(i);
 
-            // Accumulate all descriptors in each bucket group that are in the same
-            // bucket id as the query descriptor.
+            // Skip matching this descriptor if there are not at least NN candidates
+            // in the buckets of the query descriptor.
+            std::size_t nb_candidates = 0;
             for (int j = 0; j < nb_bucket_groups_; ++j)
             {
-                const uint16_t bucket_id = hashed_desc.bucket_ids[j];
-                for (const auto& feature_id : hashed_descriptions2.buckets[j][bucket_id])
-                {
-                    candidate_descriptors.emplace_back(feature_id);
-                    used_descriptor[feature_id] = false;
-                }
+                nb_candidates += hashed_descriptions2.bucketEnd(j, bucket_ids[j]) - hashed_descriptions2.bucketBegin(j, bucket_ids[j]);
             }
-
-            // Skip matching this descriptor if there are not at least NN candidates.
-            if (candidate_descriptors.size() <= NN)
+            if (nb_candidates <= static_cast<std::size_t>(NN))
             {
                 continue;
             }
 
-            // Compute the hamming distance of all candidates based on the comp hash
-            // code. Put the descriptors into buckets corresponding to their hamming
-            // distance.
-            for (const int candidate_id : candidate_descriptors)
+            // Accumulate all descriptors in each bucket group that are in the same
+            // bucket id as the query descriptor and compute their hamming distance
+            // based on the comp hash code.
+            const unsigned int stamp = buffers.nextStamp();
+            for (int j = 0; j < nb_bucket_groups_; ++j)
             {
-                if (!used_descriptor[candidate_id])  // avoid selecting the same candidate multiple times
+                const int* bucket_end = hashed_descriptions2.bucketEnd(j, bucket_ids[j]);
+                for (const int* it = hashed_descriptions2.bucketBegin(j, bucket_ids[j]); it != bucket_end; ++it)
                 {
-                    used_descriptor[candidate_id] = true;
-
-                    const HammingMetricType::ResultType hamming_distance = metricH(hashed_desc.hash_code.data(),
-                                                                                   hashed_descriptions2.hashed_desc[candidate_id].hash_code.data(),
-                                                                                   hashed_desc.hash_code.num_blocks());
-                    candidate_hamming_distances(num_descriptors_with_hamming_distance(hamming_distance)++, hamming_distance) = candidate_id;
+                    const int candidate_id = *it;
+                    if (buffers.visit_stamps[candidate_id] == stamp)  // avoid selecting the same candidate multiple times
+                        continue;
+                    buffers.visit_stamps[candidate_id] = stamp;
+
+                    const HammingMetricType::ResultType hamming_distance =
+                      metricH(hash_code, hashed_descriptions2.hashCode(candidate_id), nb_hash_code_blocks);
+                    candidate_descriptors.push_back(candidate_id);
+                    candidate_hamming_distances.push_back(hamming_distance);
+                    ++num_descriptors_with_hamming_distance[hamming_distance];
                 }
             }
 
-            // Compute the euclidean distance of the k descriptors with the best hamming
-            // distance.
-            candidate_euclidean_distances.reserve(kNumTopCandidates);
-            for (int j = 0; j < candidate_hamming_distances.cols() && (candidate_euclidean_distances.size() < kNumTopCandidates); ++j)
+            // Find the hamming distance threshold selecting the k descriptors with
+            // the best hamming distance (candidates at the threshold distance are
+            // taken in the order they were collected).
+            int threshold = 0;
+            int nb_below_threshold = 0;
+            while (threshold < static_cast<int>(num_descriptors_with_hamming_distance.size()) &&
+                   nb_below_threshold + num_descriptors_with_hamming_distance[threshold] < kNumTopCandidates)
             {
-                for (int k = 0; k < num_descriptors_with_hamming_distance(j) && (candidate_euclidean_distances.size() < kNumTopCandidates); ++k)
-                {
-                    const int candidate_id = candidate_hamming_distances(k, j);
-                    const DistanceType distance = metric(descriptions2.row(candidate_id).data(), descriptions1.row(i).data(), descriptions1.cols());
+                nb_below_threshold += num_descriptors_with_hamming_distance[threshold];
+                ++threshold;
+            }
+            int nb_at_threshold = kNumTopCandidates - nb_below_threshold;
 
-                    candidate_euclidean_distances.emplace_back(distance, candidate_id);
-                }
+            // Compute the euclidean distance of the selected descriptors.
+            for (std::size_t k = 0; k < candidate_descriptors.size(); ++k)
+            {
+                const int hamming_distance = candidate_hamming_distances[k];
+                if (hamming_distance > threshold || (hamming_distance == threshold && nb_at_threshold-- <= 0))
+                    continue;
+
+                const int candidate_id = candidate_descriptors[k];
+                const DistanceType distance = metric(descriptions2.row(candidate_id).data(), descriptions1.row(i).data(), descriptions1.cols());
+
+                candidate_euclidean_distances.emplace_back(distance, candidate_id);
             }
 
             // Assert that each query is having at least NN retrieved neighbors
@@ -315,7 +515,6 @@ class CascadeHasher
         }
     }
 
-  private:
     // Primary hashing function.
     Eigen::MatrixXf primary_hash_projection_;
 
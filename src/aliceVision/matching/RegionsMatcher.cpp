@@ -8,6 +8,7 @@
 #include "aliceVision/matching/matcherType.hpp"
 #include "aliceVision/matching/RegionsMatcher.hpp"
 #include "aliceVision/matching/ArrayMatcher_bruteForce.hpp"
+#include "aliceVision/matching/ArrayMatcher_bruteForceGemm.hpp"
 #include "aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp"
 #include "aliceVision/matching/ArrayMatcher_cascadeHashing.hpp"
 
@@ -78,6 +79,13 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(std::mt19937& randomNumber
                     out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
                 }
                 break;
+                case BRUTE_FORCE_L2_GEMM:
+                {
+                    typedef feature::L2_Vectorized<unsigned char> MetricT;
+                    typedef ArrayMatcher_bruteForceGemm<unsigned char, MetricT> MatcherT;
+                    out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
+                }
+                break;
                 case ANN_L2:
                 {
                     typedef ArrayMatcher_kdtreeFlann<unsigned char> MatcherT;
@@ -107,6 +115,13 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(std::mt19937& randomNumber
                     out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
                 }
                 break;
+                case BRUTE_FORCE_L2_GEMM:
+                {
+                    typedef feature::L2_Vectorized<float> MetricT;
+                    typedef ArrayMatcher_bruteForceGemm<float, MetricT> MatcherT;
+                    out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
+                }
+                break;
                 case ANN_L2:
                 {
                     typedef ArrayMatcher_kdtreeFlann<float> MatcherT;
@@ -136,6 +151,13 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(std::mt19937& randomNumber
                     out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
                 }
                 break;
+                case BRUTE_FORCE_L2_GEMM:
+                {
+                    typedef feature::L2_Vectorized<double> MetricT;
+                    typedef ArrayMatcher_bruteForceGemm<double, MetricT> MatcherT;
+                    out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
+                }
+                break;
                 case ANN_L2:
                 {
                     typedef ArrayMatcher_kdtreeFlann<double> MatcherT;
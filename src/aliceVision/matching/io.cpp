@@ -8,6 +8,7 @@
 #include "io.hpp"
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/config.hpp>
+#include <aliceVision/system/IOScheduler.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/utils/filesIO.hpp>
 
@@ -17,6 +18,7 @@
 #include <filesystem>
 #include <fstream>
 #include <iterator>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -133,34 +135,32 @@ std::size_t LoadMatchFilePerImage(PairwiseMatches& matches,
                                   const std::string& folder,
                                   const std::string& extension)
 {
-    int nbLoadedMatchFiles = 0;
-// Load one match file per image
-#pragma omp parallel for num_threads(3)
-    for (ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(viewsKeys.size()); ++i)
-    {
-        std::set<IndexT>::const_iterator it = viewsKeys.begin();
-        std::advance(it, i);
-        const IndexT idView = *it;
-        const std::string matchFilename = std::to_string(idView) + "." + extension;
-        PairwiseMatches fileMatches;
-        if (!LoadMatchFile(fileMatches, (fs::path(folder) / matchFilename).string()))
-        {
-#pragma omp critical
-            {
-                ALICEVISION_LOG_DEBUG("Unable to load match file: " << matchFilename << " in: " << folder);
-            }
-            continue;
-        }
-#pragma omp critical
-        {
-            ++nbLoadedMatchFiles;
-            // merge the loaded matches into the output
-            for (const auto& v : fileMatches)
-            {
-                matches[v.first] = v.second;
-            }
-        }
-    }
+    const std::vector<IndexT> viewIds(viewsKeys.begin(), viewsKeys.end());
+    std::size_t nbLoadedMatchFiles = 0;
+
+    // load one match file per image on the I/O threads and merge them on this thread
+    system::IOScheduler::getInstance().forEachOrdered(
+      viewIds.size(),
+      [&](std::size_t i) {
+          const std::string matchFilename = std::to_string(viewIds[i]) + "." + extension;
+          std::unique_ptr<PairwiseMatches> fileMatches = std::make_unique<PairwiseMatches>();
+          if (!LoadMatchFile(*fileMatches, (fs::path(folder) / matchFilename).string()))
+          {
+              ALICEVISION_LOG_DEBUG("Unable to load match file: " << matchFilename << " in: " << folder);
+              fileMatches.reset();
+          }
+          return fileMatches;
+      },
+      [&](std::size_t, std::unique_ptr<PairwiseMatches>&& fileMatches) {
+          if (!fileMatches)
+              return;
+          ++nbLoadedMatchFiles;
+          // merge the loaded matches into the output
+          for (auto& v : *fileMatches)
+          {
+              matches[v.first] = std::move(v.second);
+          }
+      });
     return nbLoadedMatchFiles;
 }
 
@@ -183,36 +183,39 @@ std::size_t loadMatchesFromFolder(PairwiseMatches& matches, const std::string& f
         }
     }
 
-#pragma omp parallel for num_threads(3)
-    for (int i = 0; i < matchFiles.size(); ++i)
-    {
-        const std::string& matchFile = matchFiles[i];
-        PairwiseMatches fileMatches;
-        ALICEVISION_LOG_DEBUG("Loading match file: " << matchFile);
-        if (!LoadMatchFile(fileMatches, matchFile))
-        {
-            ALICEVISION_LOG_WARNING("Unable to load match file: " << matchFile);
-            continue;
-        }
-#pragma omp critical
-        {
-            for (const auto& matchesPerView : fileMatches)
-            {
-                const Pair& pair = matchesPerView.first;
-                const MatchesPerDescType& pairMatches = matchesPerView.second;
-                for (const auto& matchesPerDescType : pairMatches)
-                {
-                    const feature::EImageDescriberType& descType = matchesPerDescType.first;
-                    const auto& pairMatches = matchesPerDescType.second;
-                    // merge in global map
-                    std::copy(std::make_move_iterator(pairMatches.begin()),
-                              std::make_move_iterator(pairMatches.end()),
-                              std::back_inserter(matches[pair][descType]));
-                }
-            }
-            ++nbLoadedMatchFiles;
-        }
-    }
+    // load the match files on the I/O threads and merge them on this thread
+    system::IOScheduler::getInstance().forEachOrdered(
+      matchFiles.size(),
+      [&](std::size_t i) {
+          const std::string& matchFile = matchFiles[i];
+          std::unique_ptr<PairwiseMatches> fileMatches = std::make_unique<PairwiseMatches>();
+          ALICEVISION_LOG_DEBUG("Loading match file: " << matchFile);
+          if (!LoadMatchFile(*fileMatches, matchFile))
+          {
+              ALICEVISION_LOG_WARNING("Unable to load match file: " << matchFile);
+              fileMatches.reset();
+          }
+          return fileMatches;
+      },
+      [&](std::size_t, std::unique_ptr<PairwiseMatches>&& fileMatches) {
+          if (!fileMatches)
+              return;
+          for (auto& matchesPerView : *fileMatches)
+          {
+              const Pair& pair = matchesPerView.first;
+              MatchesPerDescType& pairMatches = matchesPerView.second;
+              for (auto& matchesPerDescType : pairMatches)
+              {
+                  const feature::EImageDescriberType& descType = matchesPerDescType.first;
+                  auto& pairMatches = matchesPerDescType.second;
+                  // merge in global map
+                  std::copy(std::make_move_iterator(pairMatches.begin()),
+                            std::make_move_iterator(pairMatches.end()),
+                            std::back_inserter(matches[pair][descType]));
+              }
+          }
+          ++nbLoadedMatchFiles;
+      });
     if (!nbLoadedMatchFiles)
         ALICEVISION_LOG_WARNING("No matches file loaded in: " << folder);
     return nbLoadedMatchFiles;
@@ -7,6 +7,7 @@
 
 #include "aliceVision/numeric/numeric.hpp"
 #include "aliceVision/matching/ArrayMatcher_bruteForce.hpp"
+#include "aliceVision/matching/ArrayMatcher_bruteForceGemm.hpp"
 #include "aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp"
 #include "aliceVision/matching/ArrayMatcher_cascadeHashing.hpp"
 #include <iostream>
@@ -166,3 +167,193 @@ BOOST_AUTO_TEST_CASE(Matching_Cascade_Hashing_Simple_EmptyArrays)
     float fDistance = -1.0f;
     BOOST_CHECK(!matcher.SearchNeighbour(&array[0], &nIndice, &fDistance));
 }
+
+BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_bruteForceGemm_NN)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    const float array[] = {0, 1, 2, 5, 6};
+    ArrayMatcher_bruteForceGemm<float> matcher;
+    BOOST_CHECK(matcher.Build(gen, array, 5, 1));
+
+    const float query[] = {2};
+    IndMatches vec_nIndice;
+    std::vector<float> vec_fDistance;
+    BOOST_CHECK(matcher.SearchNeighbours(query, 1, &vec_nIndice, &vec_fDistance, 5));
+
+    BOOST_CHECK_EQUAL(5, vec_nIndice.size());
+    BOOST_CHECK_EQUAL(5, vec_fDistance.size());
+
+    // Check distances:
+    BOOST_CHECK_SMALL(static_cast<double>(vec_fDistance[0] - Square(2.0f - 2.0f)), 1e-6);
+    BOOST_CHECK_SMALL(static_cast<double>(vec_fDistance[1] - Square(1.0f - 2.0f)), 1e-6);
+    BOOST_CHECK_SMALL(static_cast<double>(vec_fDistance[2] - Square(0.0f - 2.0f)), 1e-6);
+    BOOST_CHECK_SMALL(static_cast<double>(vec_fDistance[3] - Square(5.0f - 2.0f)), 1e-6);
+    BOOST_CHECK_SMALL(static_cast<double>(vec_fDistance[4] - Square(6.0f - 2.0f)), 1e-6);
+
+    // Check indexes:
+    BOOST_CHECK_EQUAL(IndMatch(0, 2), vec_nIndice[0]);
+    BOOST_CHECK_EQUAL(IndMatch(0, 1), vec_nIndice[1]);
+    BOOST_CHECK_EQUAL(IndMatch(0, 0), vec_nIndice[2]);
+    BOOST_CHECK_EQUAL(IndMatch(0, 3), vec_nIndice[3]);
+    BOOST_CHECK_EQUAL(IndMatch(0, 4), vec_nIndice[4]);
+
+    int nIndice = -1;
+    float fDistance = -1.0f;
+    BOOST_CHECK(matcher.SearchNeighbour(query, &nIndice, &fDistance));
+    BOOST_CHECK_EQUAL(2, nIndice);
+    BOOST_CHECK_SMALL(static_cast<double>(fDistance), 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_bruteForceGemm_Simple_EmptyArrays)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    std::vector<float> array;
+    ArrayMatcher_bruteForceGemm<float> matcher;
+    BOOST_CHECK(!matcher.Build(gen, &array[0], 0, 4));
+
+    int nIndice = -1;
+    float fDistance = -1.0f;
+    BOOST_CHECK(!matcher.SearchNeighbour(&array[0], &nIndice, &fDistance));
+}
+
+BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_bruteForceGemm_vs_bruteForce)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 255);
+
+    // SIFT-like descriptors, sizes not multiple of the block sizes
+    const int dimension = 128;
+    const int nbDatabase = 2500;
+    const int nbQuery = 700;
+    std::vector<unsigned char> database(nbDatabase * dimension);
+    std::vector<unsigned char> queries(nbQuery * dimension);
+    for (unsigned char& v : database)
+        v = static_cast<unsigned char>(dist(gen));
+    for (unsigned char& v : queries)
+        v = static_cast<unsigned char>(dist(gen));
+
+    typedef feature::L2_Vectorized<unsigned char> MetricT;
+    ArrayMatcher_bruteForce<unsigned char, MetricT> matcherRef;
+    ArrayMatcher_bruteForceGemm<unsigned char, MetricT> matcherGemm;
+
+    BOOST_CHECK(matcherRef.Build(gen, database.data(), nbDatabase, dimension));
+    IndMatches indicesRef;
+    std::vector<float> distancesRef;
+    BOOST_CHECK(matcherRef.SearchNeighbours(queries.data(), nbQuery, &indicesRef, &distancesRef, 2));
+
+    BOOST_CHECK(matcherGemm.Build(gen, database.data(), nbDatabase, dimension));
+    IndMatches indicesGemm;
+    std::vector<float> distancesGemm;
+    BOOST_CHECK(matcherGemm.SearchNeighbours(queries.data(), nbQuery, &indicesGemm, &distancesGemm, 2));
+
+    BOOST_REQUIRE_EQUAL(indicesRef.size(), indicesGemm.size());
+    BOOST_REQUIRE_EQUAL(distancesRef.size(), distancesGemm.size());
+
+    // distances are integers below 2^24, so they are exact in float
+    for (std::size_t i = 0; i < distancesRef.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(distancesRef[i], distancesGemm[i]);
+        // indices may only differ between neighbours at the same distance
+        if (distancesRef[i ^ 1] == distancesRef[i])
+            continue;
+        BOOST_CHECK_EQUAL(indicesRef[i], indicesGemm[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Matching_Cascade_Hashing_Duplicates)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 255);
+
+    const int dimension = 128;
+    const int nbDescriptors = 1000;
+    std::vector<unsigned char> database(nbDescriptors * dimension);
+    for (unsigned char& v : database)
+        v = static_cast<unsigned char>(dist(gen));
+
+    typedef feature::L2_Vectorized<unsigned char> MetricT;
+    ArrayMatcher_cascadeHashing<unsigned char, MetricT> matcher;
+    BOOST_CHECK(matcher.Build(gen, database.data(), nbDescriptors, dimension));
+
+    // each query is a database descriptor: it is always in the same buckets as itself
+    IndMatches indices;
+    std::vector<float> distances;
+    BOOST_CHECK(matcher.SearchNeighbours(database.data(), nbDescriptors, &indices, &distances, 2));
+
+    std::size_t nbFound = 0;
+    for (std::size_t i = 0; i < indices.size(); i += 2)
+    {
+        BOOST_CHECK_EQUAL(indices[i]._i, indices[i]._j);
+        BOOST_CHECK_EQUAL(distances[i], 0.f);
+        BOOST_CHECK_LE(distances[i], distances[i + 1]);
+        ++nbFound;
+    }
+    BOOST_CHECK_GT(nbFound, 0);
+}
+
+BOOST_AUTO_TEST_CASE(Matching_Cascade_Hashing_Batch)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::uniform_int_distribution<int> noise(-8, 8);
+
+    typedef Eigen::Matrix<unsigned char, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatT;
+    typedef feature::L2_Vectorized<unsigned char>::ResultType DistanceT;
+
+    const int dimension = 128;
+    MatT database(1500, dimension);
+    for (int i = 0; i < database.size(); ++i)
+        database.data()[i] = static_cast<unsigned char>(dist(gen));
+
+    // queries are noisy database descriptors, the last one is larger than a block of the batch
+    const std::vector<int> nbQueryDescriptors = {0, 700, 2500};
+    std::vector<MatT> queries;
+    for (const int nbDescriptors : nbQueryDescriptors)
+    {
+        MatT query(nbDescriptors, dimension);
+        for (int i = 0; i < nbDescriptors; ++i)
+            for (int j = 0; j < dimension; ++j)
+                query(i, j) = static_cast<unsigned char>(std::clamp(database(i % database.rows(), j) + noise(gen), 0, 255));
+        queries.push_back(query);
+    }
+
+    CascadeHasher hasher;
+    hasher.Init(gen, dimension);
+    const Eigen::VectorXf zeroMean = CascadeHasher::GetZeroMeanDescriptor(database);
+    const HashedDescriptions hashedDatabase = hasher.CreateHashedDescriptions(database, zeroMean);
+
+    std::vector<HashedDescriptions> hashedQueries;
+    std::vector<const HashedDescriptions*> hashedQueriesPtr;
+    std::vector<const MatT*> queriesPtr;
+    for (const MatT& query : queries)
+        hashedQueries.push_back(hasher.CreateHashedDescriptions(query, zeroMean));
+    for (std::size_t q = 0; q < queries.size(); ++q)
+    {
+        hashedQueriesPtr.push_back(&hashedQueries[q]);
+        queriesPtr.push_back(&queries[q]);
+    }
+
+    std::vector<IndMatches> indicesPerQuery;
+    std::vector<std::vector<DistanceT>> distancesPerQuery;
+    std::vector<CascadeHashingMatchBuffers> buffers;
+    hasher.Match_HashedDescriptionsBatch(hashedQueriesPtr, queriesPtr, hashedDatabase, database, indicesPerQuery, distancesPerQuery, buffers);
+
+    BOOST_REQUIRE_EQUAL(indicesPerQuery.size(), queries.size());
+    BOOST_REQUIRE_EQUAL(distancesPerQuery.size(), queries.size());
+
+    // the batch gives the same matches as the pairwise matching
+    for (std::size_t q = 0; q < queries.size(); ++q)
+    {
+        IndMatches indices;
+        std::vector<DistanceT> distances;
+        hasher.Match_HashedDescriptions(hashedQueries[q], queries[q], hashedDatabase, database, &indices, &distances);
+
+        BOOST_CHECK(indicesPerQuery[q] == indices);
+        BOOST_CHECK(distancesPerQuery[q] == distances);
+        BOOST_CHECK_EQUAL(indices.empty(), nbQueryDescriptors[q] == 0);
+    }
+}
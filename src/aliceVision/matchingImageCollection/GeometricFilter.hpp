@@ -15,6 +15,7 @@
 #include <aliceVision/system/ProgressDisplay.hpp>
 
 #include <map>
+#include <memory>
 #include <random>
 #include <vector>
 
@@ -71,6 +72,14 @@ void robustModelEstimation(PairwiseMatches& out_geometricMatches,
             {
                 if (guidedMatching)
                 {
+                    // keep the descriptors of the pair in memory during the guided matching
+                    std::vector<std::unique_ptr<feature::RegionsPerView::DescriptorsLock>> descriptorsLocks;
+                    for (const feature::EImageDescriberType descType : regionsPerView.getCommonDescTypes(imagePair))
+                    {
+                        descriptorsLocks.push_back(std::make_unique<feature::RegionsPerView::DescriptorsLock>(regionsPerView, imagePair.first, descType));
+                        descriptorsLocks.push_back(std::make_unique<feature::RegionsPerView::DescriptorsLock>(regionsPerView, imagePair.second, descType));
+                    }
+
                     MatchesPerDescType guidedGeometricInliers;
                     geometricFilter.Geometry_guided_matching(sfmData, regionsPerView, imagePair, distanceRatio, guidedGeometricInliers);
                     // ALICEVISION_LOG_DEBUG("#before/#after: " << putative_inliers.size() << "/" << guided_geometric_inliers.size());
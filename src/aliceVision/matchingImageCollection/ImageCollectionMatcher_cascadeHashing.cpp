@@ -10,8 +10,11 @@
 #include <aliceVision/matching/IndMatchDecorator.hpp>
 #include <aliceVision/matching/filters.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/config.hpp>
 
+#include <memory>
+
 namespace aliceVision {
 namespace matchingImageCollection {
 
@@ -71,6 +74,7 @@ void Match(std::mt19937& gen,
             std::advance(iter, i);
             const IndexT I = *iter;
             const feature::Regions& regionsI = regionsPerView.getRegions(I, descType);
+            const RegionsPerView::DescriptorsLock descriptorsLockI(regionsPerView, I, descType);
             const ScalarT* tabI = reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
             const size_t dimension = regionsI.DescriptorLength();
             if (i == 0)
@@ -95,6 +99,7 @@ void Match(std::mt19937& gen,
         std::advance(iter, i);
         const IndexT I = *iter;
         const feature::Regions& regionsI = regionsPerView.getRegions(I, descType);
+        const RegionsPerView::DescriptorsLock descriptorsLockI(regionsPerView, I, descType);
         const ScalarT* tabI = reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
         const size_t dimension = regionsI.DescriptorLength();
 
@@ -106,13 +111,23 @@ void Match(std::mt19937& gen,
         }
     }
 
-    // Perform matching between all the pairs
+    // Matching working buffers of each thread, reused for all the batches
+    std::vector<CascadeHashingMatchBuffers> matchBuffers;
+    // Maximum number of views J matched at once against a view I (their descriptors stay locked during the batch)
+    const std::size_t maxBatchSize = 4 * omp_get_max_threads();
+
+    typedef typename Accumulator<ScalarT>::Type ResultType;
+    typedef Eigen::Map<BaseMat> MapMat;
+
+    // Perform matching between all the pairs:
+    // the descriptors of the paired views J are matched against the index of each view I by batches
     for (Map_vectorT::const_iterator iter = map_Pairs.begin(); iter != map_Pairs.end(); ++iter)
     {
         const IndexT I = iter->first;
         const std::vector<IndexT>& indexToCompare = iter->second;
 
         const feature::Regions& regionsI = regionsPerView.getRegions(I, descType);
+        const RegionsPerView::DescriptorsLock descriptorsLockI(regionsPerView, I, descType);
         if (regionsI.RegionCount() == 0)
         {
             progressDisplay += indexToCompare.size();
@@ -122,67 +137,90 @@ void Match(std::mt19937& gen,
         const std::vector<feature::PointFeature> pointFeaturesI = regionsI.GetRegionsPositions();
         const ScalarT* tabI = reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
         const size_t dimension = regionsI.DescriptorLength();
-        Eigen::Map<BaseMat> mat_I((ScalarT*)tabI, regionsI.RegionCount(), dimension);
-#pragma omp parallel for schedule(dynamic)
-        for (int j = 0; j < (int)indexToCompare.size(); ++j)
+        const MapMat mat_I((ScalarT*)tabI, regionsI.RegionCount(), dimension);
+
+        // Views that can be matched with I
+        std::vector<IndexT> viewsJ;
+        viewsJ.reserve(indexToCompare.size());
+        for (const IndexT J : indexToCompare)
         {
-            size_t J = indexToCompare[j];
-            const feature::Regions& regionsJ = regionsPerView.getRegions(I, descType);
+            if (regionsPerView.viewExist(J) && regionsI.Type_id() == regionsPerView.getRegions(J, descType).Type_id())
+                viewsJ.push_back(J);
+            else
+                ++progressDisplay;
+        }
 
-            if (!regionsPerView.viewExist(J) || regionsI.Type_id() != regionsJ.Type_id())
+        for (std::size_t batchBegin = 0; batchBegin < viewsJ.size(); batchBegin += maxBatchSize)
+        {
+            const std::size_t batchSize = std::min(maxBatchSize, viewsJ.size() - batchBegin);
+
+            // Matrix representation of the query input data
+            std::vector<std::unique_ptr<RegionsPerView::DescriptorsLock>> descriptorsLocksJ;
+            std::vector<MapMat> matsJ;
+            matsJ.reserve(batchSize);
+            std::vector<const MapMat*> queries;
+            std::vector<const HashedDescriptions*> hashedQueries;
+            for (std::size_t j = 0; j < batchSize; ++j)
             {
-                ++progressDisplay;
-                continue;
+                const IndexT J = viewsJ[batchBegin + j];
+                const feature::Regions& regionsJ = regionsPerView.getRegions(J, descType);
+                descriptorsLocksJ.emplace_back(new RegionsPerView::DescriptorsLock(regionsPerView, J, descType));
+
+                const ScalarT* tabJ = reinterpret_cast<const ScalarT*>(regionsJ.DescriptorRawData());
+                matsJ.emplace_back((ScalarT*)tabJ, regionsJ.RegionCount(), dimension);
+                queries.push_back(&matsJ.back());
+                hashedQueries.push_back(&hashed_base_.at(J));
             }
 
-            // Matrix representation of the query input data;
-            const ScalarT* tabJ = reinterpret_cast<const ScalarT*>(regionsJ.DescriptorRawData());
-            Eigen::Map<BaseMat> mat_J((ScalarT*)tabJ, regionsJ.RegionCount(), dimension);
-
-            IndMatches pvec_indices;
-            typedef typename Accumulator<ScalarT>::Type ResultType;
-            std::vector<ResultType> pvec_distances;
-            pvec_distances.reserve(regionsJ.RegionCount() * 2);
-            pvec_indices.reserve(regionsJ.RegionCount() * 2);
-
-            // Match the query descriptors to the database
-            cascade_hasher.Match_HashedDescriptions<BaseMat, ResultType>(
-              hashed_base_[J], mat_J, hashed_base_[I], mat_I, &pvec_indices, &pvec_distances);
-
-            std::vector<int> vec_nn_ratio_idx;
-            // Filter the matches using a distance ratio test:
-            //   The probability that a match is correct is determined by taking
-            //   the ratio of distance from the closest neighbor to the distance
-            //   of the second closest.
-            matching::NNdistanceRatio(pvec_distances.begin(),  // distance start
-                                      pvec_distances.end(),    // distance end
-                                      2,                       // Number of neighbor in iterator sequence (minimum required 2)
-                                      vec_nn_ratio_idx,        // output (indices that respect the distance Ratio)
-                                      Square(fDistRatio));
-
-            matching::IndMatches vec_putative_matches;
-            vec_putative_matches.reserve(vec_nn_ratio_idx.size());
-            for (size_t k = 0; k < vec_nn_ratio_idx.size(); ++k)
+            // Match the query descriptors of all the views of the batch to the database
+            std::vector<IndMatches> indicesPerView;
+            std::vector<std::vector<ResultType>> distancesPerView;
+            cascade_hasher.Match_HashedDescriptionsBatch(
+              hashedQueries, queries, hashed_base_.at(I), mat_I, indicesPerView, distancesPerView, matchBuffers);
+
+#pragma omp parallel for schedule(dynamic)
+            for (int j = 0; j < (int)batchSize; ++j)
             {
-                const size_t index = vec_nn_ratio_idx[k];
-                vec_putative_matches.emplace_back(pvec_indices[index * 2]._j, pvec_indices[index * 2]._i);
-            }
+                const IndexT J = viewsJ[batchBegin + j];
+                const feature::Regions& regionsJ = regionsPerView.getRegions(J, descType);
+                const IndMatches& pvec_indices = indicesPerView[j];
+                const std::vector<ResultType>& pvec_distances = distancesPerView[j];
+
+                std::vector<int> vec_nn_ratio_idx;
+                // Filter the matches using a distance ratio test:
+                //   The probability that a match is correct is determined by taking
+                //   the ratio of distance from the closest neighbor to the distance
+                //   of the second closest.
+                matching::NNdistanceRatio(pvec_distances.begin(),  // distance start
+                                          pvec_distances.end(),    // distance end
+                                          2,                       // Number of neighbor in iterator sequence (minimum required 2)
+                                          vec_nn_ratio_idx,        // output (indices that respect the distance Ratio)
+                                          Square(fDistRatio));
 
-            // Remove duplicates
-            matching::IndMatch::getDeduplicated(vec_putative_matches);
+                matching::IndMatches vec_putative_matches;
+                vec_putative_matches.reserve(vec_nn_ratio_idx.size());
+                for (size_t k = 0; k < vec_nn_ratio_idx.size(); ++k)
+                {
+                    const size_t index = vec_nn_ratio_idx[k];
+                    vec_putative_matches.emplace_back(pvec_indices[index * 2]._j, pvec_indices[index * 2]._i);
+                }
+
+                // Remove duplicates
+                matching::IndMatch::getDeduplicated(vec_putative_matches);
 
-            // Remove matches that have the same (X,Y) coordinates
-            const std::vector<feature::PointFeature> pointFeaturesJ = regionsJ.GetRegionsPositions();
-            matching::IndMatchDecorator<float> matchDeduplicator(vec_putative_matches, pointFeaturesI, pointFeaturesJ);
-            matchDeduplicator.getDeduplicated(vec_putative_matches);
+                // Remove matches that have the same (X,Y) coordinates
+                const std::vector<feature::PointFeature> pointFeaturesJ = regionsJ.GetRegionsPositions();
+                matching::IndMatchDecorator<float> matchDeduplicator(vec_putative_matches, pointFeaturesI, pointFeaturesJ);
+                matchDeduplicator.getDeduplicated(vec_putative_matches);
 
 #pragma omp critical
-            {
-                ++progressDisplay;
-                if (!vec_putative_matches.empty())
                 {
-                    assert(map_PutativesMatches.count(std::make_pair(I, J)) == 0);
-                    map_PutativesMatches[std::make_pair(I, J)].emplace(descType, std::move(vec_putative_matches));
+                    ++progressDisplay;
+                    if (!vec_putative_matches.empty())
+                    {
+                        assert(map_PutativesMatches.count(std::make_pair(I, J)) == 0);
+                        map_PutativesMatches[std::make_pair(I, J)].emplace(descType, std::move(vec_putative_matches));
+                    }
                 }
             }
         }
@@ -56,6 +56,7 @@ void ImageCollectionMatcher_generic::Match(std::mt19937& randomNumberGenerator,
         const std::vector<size_t>& indexToCompare = iter->second;
 
         const feature::Regions& regionsI = regionsPerView.getRegions(I, descType);
+        const RegionsPerView::DescriptorsLock descriptorsLockI(regionsPerView, I, descType);
         if (regionsI.RegionCount() == 0)
         {
             progressDisplay += indexToCompare.size();
@@ -71,6 +72,7 @@ void ImageCollectionMatcher_generic::Match(std::mt19937& randomNumberGenerator,
             const size_t J = indexToCompare[j];
 
             const feature::Regions& regionsJ = regionsPerView.getRegions(J, descType);
+            const RegionsPerView::DescriptorsLock descriptorsLockJ(regionsPerView, J, descType);
             if (regionsJ.RegionCount() == 0 || regionsI.Type_id() != regionsJ.Type_id())
             {
                 ++progressDisplay;
@@ -37,6 +37,9 @@ std::unique_ptr<IImageCollectionMatcher> createImageCollectionMatcher(matching::
         case matching::BRUTE_FORCE_HAMMING:
             matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, crossMatching, matching::BRUTE_FORCE_HAMMING));
             break;
+        case matching::BRUTE_FORCE_L2_GEMM:
+            matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, crossMatching, matching::BRUTE_FORCE_L2_GEMM));
+            break;
 
         default:
             throw std::out_of_range("Invalid matcherType enum");
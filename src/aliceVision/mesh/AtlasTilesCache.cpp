@@ -0,0 +1,170 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "AtlasTilesCache.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+namespace aliceVision {
+namespace mesh {
+
+AtlasTilesCache::AtlasTilesCache(const std::filesystem::path& folder, int nbBands, int tileSide, std::size_t capacityMB)
+  : _folder(folder),
+    _nbBands(nbBands),
+    _tileSide(tileSide),
+    _tileBytes(std::size_t(nbBands) * tileSide * tileSide * (sizeof(image::RGBfColor) + sizeof(float))),
+    _capacityBytes(capacityMB * 1024 * 1024)
+{
+    std::filesystem::create_directories(_folder);
+}
+
+AtlasTilesCache::~AtlasTilesCache()
+{
+    std::error_code ec;
+    std::filesystem::remove_all(_folder, ec);
+    if (ec)
+        ALICEVISION_LOG_WARNING("Unable to remove the atlas tiles folder: " << _folder.string() << " (" << ec.message() << ").");
+}
+
+AtlasTilesCache::AccuPyramid& AtlasTilesCache::acquire(std::size_t atlasID, int tileIndex)
+{
+    const Key key(atlasID, tileIndex);
+    Entry& entry = _entries[key];
+
+    if (entry.pyramid == nullptr)
+    {
+        // acquired tiles count against the capacity: make room before loading the tile
+        evict(_tileBytes);
+
+        entry.pyramid = std::make_unique<AccuPyramid>();
+        entry.pyramid->init(_nbBands, _tileSide, _tileSide);
+        _usedBytes += _tileBytes;
+        _peakBytes = std::max(_peakBytes, _usedBytes);
+
+        if (entry.onDisk)
+        {
+            read(key, *entry.pyramid);
+            entry.onDisk = false;
+        }
+
+        _lru.push_front(key);
+        entry.lruIt = _lru.begin();
+    }
+    else
+    {
+        _lru.splice(_lru.begin(), _lru, entry.lruIt);
+    }
+
+    entry.acquired = true;
+    return *entry.pyramid;
+}
+
+void AtlasTilesCache::release()
+{
+    for (auto& it : _entries)
+        it.second.acquired = false;
+
+    evict();
+}
+
+std::unique_ptr<AtlasTilesCache::AccuPyramid> AtlasTilesCache::take(std::size_t atlasID, int tileIndex)
+{
+    const Key key(atlasID, tileIndex);
+
+    auto it = _entries.find(key);
+    if (it == _entries.end())
+        return nullptr;
+
+    std::unique_ptr<AccuPyramid> pyramid = std::move(it->second.pyramid);
+
+    if (it->second.onDisk)
+    {
+        pyramid = std::make_unique<AccuPyramid>();
+        pyramid->init(_nbBands, _tileSide, _tileSide);
+        read(key, *pyramid);
+    }
+    else
+    {
+        _usedBytes -= _tileBytes;
+        _lru.erase(it->second.lruIt);
+    }
+
+    _entries.erase(it);
+    return pyramid;
+}
+
+std::filesystem::path AtlasTilesCache::tilePath(const Key& key) const
+{
+    return _folder / ("tile_" + std::to_string(key.first) + "_" + std::to_string(key.second) + ".bin");
+}
+
+void AtlasTilesCache::write(const Key& key, const AccuPyramid& pyramid) const
+{
+    const std::filesystem::path path = tilePath(key);
+    std::ofstream stream(path, std::ios::binary);
+
+    for (const Texturing::AccuImage& accuImage : pyramid.pyramid)
+    {
+        stream.write(reinterpret_cast<const char*>(accuImage.img.data()), std::streamsize(accuImage.img.size() * sizeof(image::RGBfColor)));
+        stream.write(reinterpret_cast<const char*>(accuImage.imgCount.data()), std::streamsize(accuImage.imgCount.size() * sizeof(float)));
+    }
+
+    if (!stream)
+        ALICEVISION_THROW_ERROR("Unable to write the atlas tile file: " << path.string());
+}
+
+void AtlasTilesCache::read(const Key& key, AccuPyramid& pyramid)
+{
+    const std::filesystem::path path = tilePath(key);
+
+    {
+        std::ifstream stream(path, std::ios::binary);
+
+        for (Texturing::AccuImage& accuImage : pyramid.pyramid)
+        {
+            stream.read(reinterpret_cast<char*>(accuImage.img.data()), std::streamsize(accuImage.img.size() * sizeof(image::RGBfColor)));
+            stream.read(reinterpret_cast<char*>(accuImage.imgCount.data()), std::streamsize(accuImage.imgCount.size() * sizeof(float)));
+        }
+
+        if (!stream)
+            ALICEVISION_THROW_ERROR("Unable to read the atlas tile file: " << path.string());
+    }
+
+    std::filesystem::remove(path);
+    ++_nbReads;
+}
+
+void AtlasTilesCache::evict(std::size_t requiredBytes)
+{
+    auto lruIt = _lru.end();
+
+    while (_usedBytes + requiredBytes > _capacityBytes && lruIt != _lru.begin())
+    {
+        --lruIt;
+
+        Entry& entry = _entries.at(*lruIt);
+
+        // acquired tiles are in use, skip them
+        if (entry.acquired)
+            continue;
+
+        write(*lruIt, *entry.pyramid);
+        ++_nbWrites;
+
+        entry.pyramid.reset();
+        entry.onDisk = true;
+        _usedBytes -= _tileBytes;
+        lruIt = _lru.erase(lruIt);
+    }
+}
+
+}  // namespace mesh
+}  // namespace aliceVision
@@ -0,0 +1,117 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mesh/Texturing.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+
+namespace aliceVision {
+namespace mesh {
+
+/**
+ * @class AtlasTilesCache
+ * @brief Bounded cache of atlas tiles accumulation pyramids (multi-band blending).
+ *        Least recently used tiles are written to disk when the cache exceeds its capacity,
+ *        and read back on the next access. Tiles never accessed are never allocated.
+ * @note Not thread-safe: tiles are acquired before the (parallel) accumulation and released after.
+ */
+class AtlasTilesCache
+{
+  public:
+    using AccuPyramid = Texturing::AccuPyramid;
+
+    /**
+     * @brief AtlasTilesCache constructor.
+     * @param[in] folder the folder for the tiles written to disk (created if needed, removed by the destructor)
+     * @param[in] nbBands the number of frequency bands of the accumulation pyramids
+     * @param[in] tileSide the tile side in pixels
+     * @param[in] capacityMB the maximum memory used by the tiles in memory (in MB), acquired tiles included
+     */
+    AtlasTilesCache(const std::filesystem::path& folder, int nbBands, int tileSide, std::size_t capacityMB);
+
+    ~AtlasTilesCache();
+
+    // no copy constructor
+    AtlasTilesCache(const AtlasTilesCache&) = delete;
+
+    // no copy operator
+    AtlasTilesCache& operator=(const AtlasTilesCache&) = delete;
+
+    /**
+     * @brief Get a tile accumulation pyramid (zero-initialized on first access, read from disk if evicted).
+     *        The tile stays in memory until release. Least recently used tiles not acquired are evicted first
+     *        to fit the loaded tile in the cache capacity, the capacity is exceeded only if all the tiles in memory are acquired.
+     * @param[in] atlasID the atlas index
+     * @param[in] tileIndex the tile index in the atlas
+     * @return the tile accumulation pyramid
+     */
+    AccuPyramid& acquire(std::size_t atlasID, int tileIndex);
+
+    /**
+     * @brief Release all acquired tiles, evict least recently used tiles to fit in the cache capacity.
+     */
+    void release();
+
+    /**
+     * @brief Remove a tile from the cache and give its ownership to the caller.
+     * @param[in] atlasID the atlas index
+     * @param[in] tileIndex the tile index in the atlas
+     * @return the tile accumulation pyramid (nullptr if the tile has never been accessed)
+     */
+    std::unique_ptr<AccuPyramid> take(std::size_t atlasID, int tileIndex);
+
+    /// number of tiles written to disk
+    inline std::size_t getNbWrites() const { return _nbWrites; }
+
+    /// number of tiles read from disk
+    inline std::size_t getNbReads() const { return _nbReads; }
+
+    /// maximum memory used by the tiles in memory (in bytes)
+    inline std::size_t getPeakBytes() const { return _peakBytes; }
+
+  private:
+    using Key = std::pair<std::size_t, int>;
+
+    struct Entry
+    {
+        std::unique_ptr<AccuPyramid> pyramid;  // nullptr if on disk
+        std::list<Key>::iterator lruIt;
+        bool onDisk = false;
+        bool acquired = false;
+    };
+
+    std::filesystem::path tilePath(const Key& key) const;
+    void write(const Key& key, const AccuPyramid& pyramid) const;
+    void read(const Key& key, AccuPyramid& pyramid);
+
+    /**
+     * @brief Write least recently used tiles not acquired to disk until the cache fits in its capacity.
+     * @param[in] requiredBytes the memory required in the cache capacity for the tiles to load
+     */
+    void evict(std::size_t requiredBytes = 0);
+
+    const std::filesystem::path _folder;  //< folder for the tiles written to disk
+    const int _nbBands;                   //< number of frequency bands
+    const int _tileSide;                  //< tile side in pixels
+    const std::size_t _tileBytes;         //< memory used by a tile accumulation pyramid
+    const std::size_t _capacityBytes;     //< maximum memory used by the tiles in memory
+    std::size_t _usedBytes = 0;           //< memory used by the tiles in memory
+    std::size_t _peakBytes = 0;           //< maximum memory used by the tiles in memory
+    std::size_t _nbWrites = 0;            //< tiles written to disk
+    std::size_t _nbReads = 0;             //< tiles read from disk
+    std::map<Key, Entry> _entries;        //< all accessed tiles
+    std::list<Key> _lru;                  //< keys of the tiles in memory, from most to least recently used
+};
+
+}  // namespace mesh
+}  // namespace aliceVision
@@ -0,0 +1,145 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/AtlasTilesCache.hpp>
+
+#include <filesystem>
+#include <string>
+
+#define BOOST_TEST_MODULE meshAtlasTilesCache
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+namespace {
+
+// 2 bands of 181 x 181 texels: about 1 MB per tile
+constexpr int nbBands = 2;
+constexpr int tileSide = 181;
+constexpr std::size_t tileBytes = std::size_t(nbBands) * tileSide * tileSide * (sizeof(image::RGBfColor) + sizeof(float));
+
+std::filesystem::path tilesFolder(const std::string& name) { return std::filesystem::temp_directory_path() / ("atlasTilesCache_test_" + name); }
+
+/**
+ * @brief Fill all the texels of a tile with values depending on the tile index, the band and the texel.
+ */
+void fillTile(AtlasTilesCache::AccuPyramid& pyramid, int tileIndex)
+{
+    for (int level = 0; level < nbBands; ++level)
+    {
+        Texturing::AccuImage& accuImage = pyramid.pyramid[level];
+        for (std::size_t i = 0; i < accuImage.imgCount.size(); ++i)
+        {
+            const float v = float(tileIndex * 1000 + level * 100) + float(i % 97);
+            accuImage.img(i) = image::RGBfColor(v, v + 0.25f, v + 0.5f);
+            accuImage.imgCount[i] = float(tileIndex + level + 1);
+        }
+    }
+}
+
+/**
+ * @brief Check that a tile holds the values written by fillTile.
+ */
+bool checkTile(const AtlasTilesCache::AccuPyramid& pyramid, int tileIndex)
+{
+    if (pyramid.pyramid.size() != nbBands)
+        return false;
+
+    for (int level = 0; level < nbBands; ++level)
+    {
+        const Texturing::AccuImage& accuImage = pyramid.pyramid[level];
+        for (std::size_t i = 0; i < accuImage.imgCount.size(); ++i)
+        {
+            const float v = float(tileIndex * 1000 + level * 100) + float(i % 97);
+            if (accuImage.img(i) != image::RGBfColor(v, v + 0.25f, v + 0.5f) || accuImage.imgCount[i] != float(tileIndex + level + 1))
+                return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(atlasTilesCache_spillAndReload)
+{
+    const std::filesystem::path folder = tilesFolder("spillAndReload");
+    {
+        AtlasTilesCache cache(folder, nbBands, tileSide, 2);  // 2 tiles in memory
+
+        for (int tileIndex = 0; tileIndex < 4; ++tileIndex)
+        {
+            fillTile(cache.acquire(0, tileIndex), tileIndex);
+            cache.release();
+        }
+
+        // tiles 0 and 1 have been written to disk
+        BOOST_CHECK_EQUAL(cache.getNbWrites(), 2);
+        BOOST_CHECK_EQUAL(cache.getNbReads(), 0);
+        BOOST_CHECK_LE(cache.getPeakBytes(), 2 * tileBytes);
+
+        // reload an evicted tile, evicts tile 2
+        BOOST_CHECK(checkTile(cache.acquire(0, 0), 0));
+        BOOST_CHECK_EQUAL(cache.getNbReads(), 1);
+        BOOST_CHECK_EQUAL(cache.getNbWrites(), 3);
+        cache.release();
+
+        // tile in memory
+        BOOST_CHECK(checkTile(cache.acquire(0, 3), 3));
+        cache.release();
+        BOOST_CHECK_EQUAL(cache.getNbReads(), 1);
+
+        // take all tiles, from memory or from disk
+        for (int tileIndex = 0; tileIndex < 4; ++tileIndex)
+        {
+            const std::unique_ptr<AtlasTilesCache::AccuPyramid> tile = cache.take(0, tileIndex);
+            BOOST_REQUIRE(tile != nullptr);
+            BOOST_CHECK(checkTile(*tile, tileIndex));
+        }
+        BOOST_CHECK_EQUAL(cache.getNbReads(), 3);
+
+        // tiles never accessed or already taken
+        BOOST_CHECK(cache.take(0, 0) == nullptr);
+        BOOST_CHECK(cache.take(1, 0) == nullptr);
+
+        BOOST_CHECK_LE(cache.getPeakBytes(), 2 * tileBytes);
+    }
+    BOOST_CHECK(!std::filesystem::exists(folder));
+}
+
+BOOST_AUTO_TEST_CASE(atlasTilesCache_acquiredTilesCountAgainstCapacity)
+{
+    AtlasTilesCache cache(tilesFolder("acquiredTiles"), nbBands, tileSide, 2);  // 2 tiles in memory
+
+    fillTile(cache.acquire(0, 0), 0);
+    fillTile(cache.acquire(0, 1), 1);
+    cache.release();
+    BOOST_CHECK_EQUAL(cache.getNbWrites(), 0);
+
+    // acquired tiles evict the released tiles without waiting for the release
+    fillTile(cache.acquire(1, 0), 10);
+    BOOST_CHECK_EQUAL(cache.getNbWrites(), 1);
+    fillTile(cache.acquire(1, 1), 11);
+    BOOST_CHECK_EQUAL(cache.getNbWrites(), 2);
+    BOOST_CHECK_EQUAL(cache.getPeakBytes(), 2 * tileBytes);
+
+    // all tiles in memory are acquired: the capacity is exceeded
+    fillTile(cache.acquire(1, 2), 12);
+    BOOST_CHECK_EQUAL(cache.getNbWrites(), 2);
+    BOOST_CHECK_EQUAL(cache.getPeakBytes(), 3 * tileBytes);
+
+    // back to the capacity on release
+    cache.release();
+    BOOST_CHECK_EQUAL(cache.getNbWrites(), 3);
+
+    for (int tileIndex = 0; tileIndex < 2; ++tileIndex)
+    {
+        BOOST_CHECK(checkTile(*cache.take(0, tileIndex), tileIndex));
+        BOOST_CHECK(checkTile(*cache.take(1, tileIndex), 10 + tileIndex));
+    }
+    BOOST_CHECK(checkTile(*cache.take(1, 2), 12));
+}
@@ -5,6 +5,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "Texturing.hpp"
+#include "AtlasTilesCache.hpp"
 #include "geoMesh.hpp"
 #include "UVAtlas.hpp"
 
@@ -39,6 +40,8 @@
 
 #include <filesystem>
 #include <map>
+#include <memory>
+#include <numeric>
 #include <set>
 
 // Debug mode: save atlases decomposition in frequency bands and
@@ -132,6 +135,38 @@ std::istream& operator>>(std::istream& in, EBumpMappingType& bumpMappingType)
     return in;
 }
 
+ETexturingScheduling ETexturingScheduling_stringToEnum(const std::string& scheduling)
+{
+    std::string s = scheduling;
+    boost::to_lower(s);
+
+    if (s == "atlasmajor")
+        return ETexturingScheduling::AtlasMajor;
+    if (s == "viewmajor")
+        return ETexturingScheduling::ViewMajor;
+    throw std::out_of_range("Invalid texturing scheduling " + scheduling);
+}
+
+std::string ETexturingScheduling_enumToString(ETexturingScheduling scheduling)
+{
+    switch (scheduling)
+    {
+        case ETexturingScheduling::AtlasMajor:
+            return "AtlasMajor";
+        case ETexturingScheduling::ViewMajor:
+            return "ViewMajor";
+    }
+    throw std::out_of_range("Invalid texturing scheduling enum");
+}
+
+std::ostream& operator<<(std::ostream& os, ETexturingScheduling scheduling) { return os << ETexturingScheduling_enumToString(scheduling); }
+std::istream& operator>>(std::istream& in, ETexturingScheduling& scheduling)
+{
+    std::string token(std::istreambuf_iterator<char>(in), {});
+    scheduling = ETexturingScheduling_stringToEnum(token);
+    return in;
+}
+
 /**
  * @brief Return whether a pixel is contained in or intersected by a 2D triangle.
  * @param[in] triangle the triangle as an array of 3 point2Ds
@@ -167,6 +202,184 @@ Point3d barycentricToCartesian(const Point3d* triangle, const Point2d& coords)
     return triangle[0] + (triangle[2] - triangle[0]) * coords.x + (triangle[1] - triangle[0]) * coords.y;
 }
 
+/**
+ * @brief Get the pixel coordinates of a triangle in its texture atlas and its pixels bounding box.
+ * @param[in] mesh the mesh
+ * @param[in] triangleId the triangle index
+ * @param[in] textureSide the texture side in pixels
+ * @param[out] triPixs the triangle UV coordinates in pixels (3 points)
+ * @param[out] LU the bounding box left-up corner (included)
+ * @param[out] RD the bounding box right-down corner (excluded)
+ */
+void getTriangleAtlasPixels(const Mesh& mesh, unsigned int triangleId, unsigned int textureSide, Point2d* triPixs, Pixel& LU, Pixel& RD)
+{
+    const auto& triangleUvIds = mesh.trisUvIds[triangleId];
+    // compute the Bottom-Left minima of the current UDIM for [0,1] range remapping
+    Point2d udimBL;
+    const StaticVector<Point2d>& uvCoords = mesh.uvCoords;
+    udimBL.x = std::floor(std::min({uvCoords[triangleUvIds.m[0]].x, uvCoords[triangleUvIds.m[1]].x, uvCoords[triangleUvIds.m[2]].x}));
+    udimBL.y = std::floor(std::min({uvCoords[triangleUvIds.m[0]].y, uvCoords[triangleUvIds.m[1]].y, uvCoords[triangleUvIds.m[2]].y}));
+
+    for (int k = 0; k < 3; ++k)
+    {
+        const int uvPointIndex = triangleUvIds.m[k];
+        Point2d uv = uvCoords[uvPointIndex];
+        // UDIM: remap coordinates between [0,1]
+        uv = uv - udimBL;
+
+        triPixs[k] = uv * textureSide;  // UV coordinates
+    }
+
+    // compute triangle bounding box in pixel indexes
+    // min values: floor(value)
+    // max values: ceil(value)
+    LU.x = static_cast<int>(std::floor(std::min({triPixs[0].x, triPixs[1].x, triPixs[2].x})));
+    LU.y = static_cast<int>(std::floor(std::min({triPixs[0].y, triPixs[1].y, triPixs[2].y})));
+    RD.x = static_cast<int>(std::ceil(std::max({triPixs[0].x, triPixs[1].x, triPixs[2].x})));
+    RD.y = static_cast<int>(std::ceil(std::max({triPixs[0].y, triPixs[1].y, triPixs[2].y})));
+
+    // sanity check: clamp values to [0; textureSide]
+    const int texSide = static_cast<int>(textureSide);
+    LU.x = clamp(LU.x, 0, texSide);
+    LU.y = clamp(LU.y, 0, texSide);
+    RD.x = clamp(RD.x, 0, texSide);
+    RD.y = clamp(RD.y, 0, texSide);
+}
+
+/**
+ * @brief Accumulate the contributions of a camera to an atlas (multi-band blending).
+ * @param[in] texturing the texturing (mesh and parameters)
+ * @param[in] mp the multi-view parameters
+ * @param[in] camId the camera index
+ * @param[in] camImg the camera image
+ * @param[in] pyramidL the laplacian pyramid of the camera image
+ * @param[in] contributionsPerBand the camera triangles contributions to the atlas, per frequency band
+ * @param[in] getAccuTexel function returning the accumulation pyramid and the pixel offset of an atlas texel
+ *            (x, y in image coordinates system)
+ */
+template<class GetAccuTexelFunc>
+void accumulateCameraContributions(const Texturing& texturing,
+                                   const mvsUtils::MultiViewParams& mp,
+                                   int camId,
+                                   const image::Image<image::RGBfColor>& camImg,
+                                   const std::vector<image::Image<image::RGBfColor>>& pyramidL,
+                                   const std::vector<Texturing::ScorePerTriangle>& contributionsPerBand,
+                                   GetAccuTexelFunc getAccuTexel)
+{
+    const TexturingParams& texParams = texturing.texParams;
+    const Mesh* mesh = texturing.mesh;
+
+    // for each frequency band
+    for (int band = 0; band < contributionsPerBand.size(); ++band)
+    {
+        const Texturing::ScorePerTriangle& trianglesId = contributionsPerBand[band];
+        ALICEVISION_LOG_INFO("      - band " << band + 1 << ": " << trianglesId.size() << " triangles.");
+
+// for each triangle
+#pragma omp parallel for
+        for (int ti = 0; ti < trianglesId.size(); ++ti)
+        {
+            const unsigned int triangleId = std::get<0>(trianglesId[ti]);
+            const float triangleScore = texParams.useScore ? std::get<1>(trianglesId[ti]) : 1.0f;
+            // retrieve triangle 3D and UV coordinates
+            Point2d triPixs[3];
+            Point3d triPts[3];
+            Pixel LU, RD;
+            getTriangleAtlasPixels(*mesh, triangleId, texParams.textureSide, triPixs, LU, RD);
+
+            for (int k = 0; k < 3; ++k)
+                triPts[k] = mesh->pts[mesh->tris[triangleId].v[k]];  // 3D coordinates
+
+            // iterate over pixels of the triangle's bounding box
+            for (int y = LU.y; y < RD.y; ++y)
+            {
+                for (int x = LU.x; x < RD.x; ++x)
+                {
+                    Pixel pix(x, y);  // top-left corner of the pixel
+                    Point2d barycCoords;
+
+                    // test if the pixel is inside triangle
+                    // and retrieve its barycentric coordinates
+                    if (!isPixelInTriangle(triPixs, pix, barycCoords))
+                    {
+                        continue;
+                    }
+
+                    // remap 'y' to image coordinates system (inverted Y axis)
+                    const unsigned int y_ = (texParams.textureSide - 1) - y;
+                    // get 3D coordinates
+                    Point3d pt3d = barycentricToCartesian(triPts, barycCoords);
+                    // get 2D coordinates in source image
+                    Point2d pixRC;
+                    mp.getPixelFor3DPoint(&pixRC, pt3d, camId);
+                    // exclude out of bounds pixels
+                    if (!mp.isPixelInImage(pixRC, camId))
+                        continue;
+
+                    // If the color is pure zero (ie. no contributions), we consider it as an invalid pixel.
+                    if (getInterpolateColor(camImg, pixRC.y, pixRC.x) == image::RGBfColor(0.f, 0.f, 0.f))
+                        continue;
+
+                    // Fill the accumulated pyramid for this pixel
+                    // each frequency band also contributes to lower frequencies (higher band indexes)
+                    const auto accuTexel = getAccuTexel(x, y_);
+                    Texturing::AccuPyramid& accuPyramid = *accuTexel.first;
+                    const std::size_t xyoffset = accuTexel.second;
+                    for (std::size_t bandContrib = band; bandContrib < pyramidL.size(); ++bandContrib)
+                    {
+                        int downscaleCoef = std::pow(texParams.multiBandDownscale, bandContrib);
+                        Texturing::AccuImage& accuImage = accuPyramid.pyramid[bandContrib];
+
+                        // fill the accumulated color map for this pixel
+                        const auto pixDownscaled = pixRC / downscaleCoef;
+                        accuImage.img(xyoffset) +=
+                          getInterpolateColor(pyramidL[bandContrib], pixDownscaled.y, pixDownscaled.x) * triangleScore;
+                        accuImage.imgCount[xyoffset] += triangleScore;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Average the accumulated colors of each frequency band of an atlas texel.
+ *        Texels without contribution in the first band are left untouched.
+ * @param[in,out] accuPyramid the accumulation pyramid
+ * @param[in] offset the texel offset in the pyramid images
+ */
+void averageFrequencyBands(Texturing::AccuPyramid& accuPyramid, std::size_t offset)
+{
+    Texturing::AccuImage& accuTexture = accuPyramid.pyramid[0];
+
+    // If the imgCount is valid on the first band, it will be valid on all the other bands
+    if (accuTexture.imgCount[offset] == 0)
+        return;
+
+    accuTexture.img(offset) /= accuTexture.imgCount[offset];
+    accuTexture.imgCount[offset] = 1;
+
+    for (std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
+    {
+        Texturing::AccuImage& accuLevelTexture = accuPyramid.pyramid[level];
+        accuLevelTexture.img(offset) /= accuLevelTexture.imgCount[offset];
+    }
+}
+
+/**
+ * @brief Fuse the frequency bands of an atlas texel (after averageFrequencyBands).
+ * @param[in] accuPyramid the accumulation pyramid
+ * @param[in] offset the texel offset in the pyramid images
+ * @return the final color of the texel
+ */
+image::RGBfColor fuseFrequencyBands(const Texturing::AccuPyramid& accuPyramid, std::size_t offset)
+{
+    image::RGBfColor color = accuPyramid.pyramid[0].img(offset);
+    for (std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
+        color += accuPyramid.pyramid[level].img(offset);
+    return color;
+}
+
 void Texturing::generateUVsBasicMethod(mvsUtils::MultiViewParams& mp)
 {
     if (!mesh)
@@ -345,6 +558,22 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
     ALICEVISION_LOG_INFO("Total amount of memory remaining for the computation: " << availableMem << " MB.");
     ALICEVISION_LOG_INFO("Total amount of an image in memory: " << imageMaxMemSize << " MB.");
     ALICEVISION_LOG_INFO("Total amount of an atlas pyramid in memory: " << atlasPyramidMaxMemSize << " MB.");
+
+    if (texParams.scheduling == ETexturingScheduling::ViewMajor)
+    {
+        if (nbAtlasMax < nbAtlas)
+        {
+            // keep memory for the final texture of one atlas, the remaining memory is used by the atlas tiles
+            const std::size_t tilesCapacity = std::max(0, availableMem - int(atlasContribMemSize));
+
+            ALICEVISION_LOG_INFO("Processing " << nbAtlas << " atlases with view-major scheduling (atlas tiles in memory: " << tilesCapacity
+                                               << " MB).");
+            generateTexturesViewMajor(mp, imageCache, outPath, tilesCapacity, textureFileType);
+            return;
+        }
+        ALICEVISION_LOG_INFO("All atlases fit in memory, each source image is read once with the atlas-major scheduling.");
+    }
+
     ALICEVISION_LOG_INFO("Processing " << nbAtlas << " atlases by chunks of " << nbAtlasMax);
 
     // generateTexture for the maximum number of atlases, and iterate
@@ -367,22 +596,10 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
     }
 }
 
-void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
-                                       const std::vector<size_t>& atlasIDs,
-                                       mvsUtils::ImagesCache<image::Image<image::RGBfColor>>& imageCache,
-                                       const fs::path& outPath,
-                                       image::EImageFileType textureFileType)
+std::vector<Texturing::CameraContributions> Texturing::computeContributionsPerCamera(const mvsUtils::MultiViewParams& mp,
+                                                                                    const std::vector<size_t>& atlasIDs) const
 {
-    if (atlasIDs.size() > _atlases.size())
-        throw std::runtime_error("Invalid atlas IDs ");
-
-    unsigned int textureSize = texParams.textureSide * texParams.textureSide;
-
-    // We select the best cameras for each triangle and store it per camera for each output texture files.
-    // Triangles contributions are stored per frequency bands for multi-band blending.
-    using AtlasIndex = size_t;
-    using ScorePerTriangle = std::vector<std::pair<unsigned int, float>>;  // list of <triangleId, score>
-    std::vector<std::map<AtlasIndex, std::vector<ScorePerTriangle>>> contributionsPerCamera(mp.ncams);
+    std::vector<CameraContributions> contributionsPerCamera(mp.ncams);
 
     // for each atlasID, calculate contributionPerCamera
     for (const size_t atlasID : atlasIDs)
@@ -511,6 +728,24 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
         }
     }
 
+    return contributionsPerCamera;
+}
+
+void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
+                                       const std::vector<size_t>& atlasIDs,
+                                       mvsUtils::ImagesCache<image::Image<image::RGBfColor>>& imageCache,
+                                       const fs::path& outPath,
+                                       image::EImageFileType textureFileType)
+{
+    if (atlasIDs.size() > _atlases.size())
+        throw std::runtime_error("Invalid atlas IDs ");
+
+    unsigned int textureSize = texParams.textureSide * texParams.textureSide;
+
+    // We select the best cameras for each triangle and store it per camera for each output texture files.
+    // Triangles contributions are stored per frequency bands for multi-band blending.
+    const std::vector<CameraContributions> contributionsPerCamera = computeContributionsPerCamera(mp, atlasIDs);
+
     ALICEVISION_LOG_INFO("Reading pixel color.");
 
     // pyramid of atlases frequency bands
@@ -544,106 +779,10 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
         {
             AtlasIndex atlasID = c.first;
             ALICEVISION_LOG_INFO("  - Texture file: " << atlasID + 1);
-            // for each frequency band
-            for (int band = 0; band < c.second.size(); ++band)
-            {
-                const ScorePerTriangle& trianglesId = c.second[band];
-                ALICEVISION_LOG_INFO("      - band " << band + 1 << ": " << trianglesId.size() << " triangles.");
-
-// for each triangle
-#pragma omp parallel for
-                for (int ti = 0; ti < trianglesId.size(); ++ti)
-                {
-                    const unsigned int triangleId = std::get<0>(trianglesId[ti]);
-                    const float triangleScore = texParams.useScore ? std::get<1>(trianglesId[ti]) : 1.0f;
-                    // retrieve triangle 3D and UV coordinates
-                    Point2d triPixs[3];
-                    Point3d triPts[3];
-                    auto& triangleUvIds = mesh->trisUvIds[triangleId];
-                    // compute the Bottom-Left minima of the current UDIM for [0,1] range remapping
-                    Point2d udimBL;
-                    StaticVector<Point2d>& uvCoords = mesh->uvCoords;
-                    udimBL.x = std::floor(std::min({uvCoords[triangleUvIds[0]].x, uvCoords[triangleUvIds[1]].x, uvCoords[triangleUvIds[2]].x}));
-                    udimBL.y = std::floor(std::min({uvCoords[triangleUvIds[0]].y, uvCoords[triangleUvIds[1]].y, uvCoords[triangleUvIds[2]].y}));
-
-                    for (int k = 0; k < 3; ++k)
-                    {
-                        const int pointIndex = mesh->tris[triangleId].v[k];
-                        triPts[k] = mesh->pts[pointIndex];  // 3D coordinates
-                        const int uvPointIndex = triangleUvIds.m[k];
-                        Point2d uv = uvCoords[uvPointIndex];
-                        // UDIM: remap coordinates between [0,1]
-                        uv = uv - udimBL;
-
-                        triPixs[k] = uv * texParams.textureSide;  // UV coordinates
-                    }
-
-                    // compute triangle bounding box in pixel indexes
-                    // min values: floor(value)
-                    // max values: ceil(value)
-                    Pixel LU, RD;
-                    LU.x = static_cast<int>(std::floor(std::min({triPixs[0].x, triPixs[1].x, triPixs[2].x})));
-                    LU.y = static_cast<int>(std::floor(std::min({triPixs[0].y, triPixs[1].y, triPixs[2].y})));
-                    RD.x = static_cast<int>(std::ceil(std::max({triPixs[0].x, triPixs[1].x, triPixs[2].x})));
-                    RD.y = static_cast<int>(std::ceil(std::max({triPixs[0].y, triPixs[1].y, triPixs[2].y})));
-
-                    // sanity check: clamp values to [0; textureSide]
-                    int texSide = static_cast<int>(texParams.textureSide);
-                    LU.x = clamp(LU.x, 0, texSide);
-                    LU.y = clamp(LU.y, 0, texSide);
-                    RD.x = clamp(RD.x, 0, texSide);
-                    RD.y = clamp(RD.y, 0, texSide);
-
-                    // iterate over pixels of the triangle's bounding box
-                    for (int y = LU.y; y < RD.y; ++y)
-                    {
-                        for (int x = LU.x; x < RD.x; ++x)
-                        {
-                            Pixel pix(x, y);  // top-left corner of the pixel
-                            Point2d barycCoords;
-
-                            // test if the pixel is inside triangle
-                            // and retrieve its barycentric coordinates
-                            if (!isPixelInTriangle(triPixs, pix, barycCoords))
-                            {
-                                continue;
-                            }
-
-                            // remap 'y' to image coordinates system (inverted Y axis)
-                            const unsigned int y_ = (texParams.textureSide - 1) - y;
-                            // 1D pixel index
-                            unsigned int xyoffset = y_ * texParams.textureSide + x;
-                            // get 3D coordinates
-                            Point3d pt3d = barycentricToCartesian(triPts, barycCoords);
-                            // get 2D coordinates in source image
-                            Point2d pixRC;
-                            mp.getPixelFor3DPoint(&pixRC, pt3d, camId);
-                            // exclude out of bounds pixels
-                            if (!mp.isPixelInImage(pixRC, camId))
-                                continue;
-
-                            // If the color is pure zero (ie. no contributions), we consider it as an invalid pixel.
-                            if (getInterpolateColor(camImg, pixRC.y, pixRC.x) == image::RGBfColor(0.f, 0.f, 0.f))
-                                continue;
-
-                            // Fill the accumulated pyramid for this pixel
-                            // each frequency band also contributes to lower frequencies (higher band indexes)
-                            AccuPyramid& accuPyramid = accuPyramids.at(atlasID);
-                            for (std::size_t bandContrib = band; bandContrib < pyramidL.size(); ++bandContrib)
-                            {
-                                int downscaleCoef = std::pow(texParams.multiBandDownscale, bandContrib);
-                                AccuImage& accuImage = accuPyramid.pyramid[bandContrib];
-
-                                // fill the accumulated color map for this pixel
-                                const auto pixDownscaled = pixRC / downscaleCoef;
-                                accuImage.img(xyoffset) +=
-                                  getInterpolateColor(pyramidL[bandContrib], pixDownscaled.y, pixDownscaled.x) * triangleScore;
-                                accuImage.imgCount[xyoffset] += triangleScore;
-                            }
-                        }
-                    }
-                }
-            }
+            AccuPyramid& accuPyramid = accuPyramids.at(atlasID);
+            accumulateCameraContributions(*this, mp, camId, camImg, pyramidL, c.second, [&](unsigned int x, unsigned int y) {
+                return std::make_pair(&accuPyramid, std::size_t(y) * texParams.textureSide + x);
+            });
         }
     }
 
@@ -698,20 +837,7 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
             unsigned int yoffset = yp * texParams.textureSide;
             for (unsigned int xp = 0; xp < texParams.textureSide; ++xp)
             {
-                unsigned int xyoffset = yoffset + xp;
-
-                // If the imgCount is valid on the first band, it will be valid on all the other bands
-                if (atlasTexture.imgCount[xyoffset] == 0)
-                    continue;
-
-                atlasTexture.img(xyoffset) /= atlasTexture.imgCount[xyoffset];
-                atlasTexture.imgCount[xyoffset] = 1;
-
-                for (std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
-                {
-                    AccuImage& atlasLevelTexture = accuPyramid.pyramid[level];
-                    atlasLevelTexture.img(xyoffset) /= atlasLevelTexture.imgCount[xyoffset];
-                }
+                averageFrequencyBands(accuPyramid, yoffset + xp);
             }
         }
 
@@ -733,13 +859,139 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
             for (unsigned int xp = 0; xp < texParams.textureSide; ++xp)
             {
                 unsigned int xyoffset = yoffset + xp;
-                for (std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
+                atlasTexture.img(xyoffset) = fuseFrequencyBands(accuPyramid, xyoffset);
+            }
+        }
+        writeTexture(atlasTexture, atlasID, outPath, textureFileType, -1);
+    }
+}
+
+void Texturing::generateTexturesViewMajor(const mvsUtils::MultiViewParams& mp,
+                                          mvsUtils::ImagesCache<image::Image<image::RGBfColor>>& imageCache,
+                                          const fs::path& outPath,
+                                          std::size_t tilesCapacityMB,
+                                          image::EImageFileType textureFileType)
+{
+    const int textureSide = static_cast<int>(texParams.textureSide);
+    const int tileSide = clamp(static_cast<int>(texParams.tileSide), 1, textureSide);
+    const int nbTilesPerSide = divideRoundUp(textureSide, tileSide);
+    const int nbTiles = nbTilesPerSide * nbTilesPerSide;
+
+    std::vector<size_t> atlasIDs(_atlases.size());
+    std::iota(atlasIDs.begin(), atlasIDs.end(), 0);
+
+    // We select the best cameras for each triangle and store it per camera for all the output texture files.
+    const std::vector<CameraContributions> contributionsPerCamera = computeContributionsPerCamera(mp, atlasIDs);
+
+    // atlases accumulation pyramids, by tiles
+    AtlasTilesCache tilesCache(fs::temp_directory_path() / utils::generateUniqueFilename(), texParams.nbBand, tileSide, tilesCapacityMB);
+    std::vector<AccuPyramid*> atlasTiles(nbTiles);
+
+    ALICEVISION_LOG_INFO("Reading pixel color (" << nbTiles << " tiles of " << tileSide << "x" << tileSide << " pixels per atlas).");
+
+    // for each camera, read the image once and fill the tiles of all its texture files
+    for (int camId = 0; camId < contributionsPerCamera.size(); ++camId)
+    {
+        const CameraContributions& cameraContributions = contributionsPerCamera[camId];
+
+        if (cameraContributions.empty())
+        {
+            ALICEVISION_LOG_INFO("- camera " << mp.getViewId(camId) << " (" << camId + 1 << "/" << mp.ncams << ") unused.");
+            continue;
+        }
+        ALICEVISION_LOG_INFO("- camera " << mp.getViewId(camId) << " (" << camId + 1 << "/" << mp.ncams << ") with contributions to "
+                                         << cameraContributions.size() << " texture files:");
+
+        // Load camera image from cache
+        auto imgPtr = imageCache.getImg_sync(camId);
+        const image::Image<image::RGBfColor>& camImg = *imgPtr;
+
+        // Calculate laplacianPyramid
+        std::vector<image::Image<image::RGBfColor>> pyramidL;  // laplacian pyramid
+        imageAlgo::laplacianPyramid(pyramidL, camImg, texParams.nbBand, texParams.multiBandDownscale);
+
+        // for each output texture file
+        for (const auto& c : cameraContributions)
+        {
+            const AtlasIndex atlasID = c.first;
+            ALICEVISION_LOG_INFO("  - Texture file: " << atlasID + 1);
+
+            // acquire the tiles covered by the camera triangles
+            std::fill(atlasTiles.begin(), atlasTiles.end(), nullptr);
+            for (const ScorePerTriangle& trianglesId : c.second)
+            {
+                for (const auto& triangleScore : trianglesId)
                 {
-                    AccuImage& atlasLevelTexture = accuPyramid.pyramid[level];
-                    atlasTexture.img(xyoffset) += atlasLevelTexture.img(xyoffset);
+                    Point2d triPixs[3];
+                    Pixel LU, RD;
+                    getTriangleAtlasPixels(*mesh, triangleScore.first, texParams.textureSide, triPixs, LU, RD);
+
+                    if (LU.x >= RD.x || LU.y >= RD.y)
+                        continue;
+
+                    // tiles in image coordinates system (inverted Y axis)
+                    for (int tileY = (textureSide - RD.y) / tileSide; tileY <= (textureSide - 1 - LU.y) / tileSide; ++tileY)
+                    {
+                        for (int tileX = LU.x / tileSide; tileX <= (RD.x - 1) / tileSide; ++tileX)
+                        {
+                            const int tileIndex = tileY * nbTilesPerSide + tileX;
+                            if (atlasTiles[tileIndex] == nullptr)
+                                atlasTiles[tileIndex] = &tilesCache.acquire(atlasID, tileIndex);
+                        }
+                    }
                 }
             }
+
+            accumulateCameraContributions(*this, mp, camId, camImg, pyramidL, c.second, [&](unsigned int x, unsigned int y) {
+                const int tileIndex = (y / tileSide) * nbTilesPerSide + x / tileSide;
+                return std::make_pair(atlasTiles[tileIndex], std::size_t(y % tileSide) * tileSide + x % tileSide);
+            });
+
+            tilesCache.release();
         }
+    }
+
+    ALICEVISION_LOG_INFO("Atlas tiles written to disk: " << tilesCache.getNbWrites() << ", read from disk: " << tilesCache.getNbReads()
+                                                         << ", peak memory: " << tilesCache.getPeakBytes() / (1024 * 1024) << " MB.");
+
+    // calculate the atlas textures from the tiles pyramids
+    for (std::size_t atlasID : atlasIDs)
+    {
+        ALICEVISION_LOG_INFO("Create texture " << atlasID + 1);
+
+        AccuImage atlasTexture;
+        atlasTexture.resize(textureSide, textureSide);
+
+        ALICEVISION_LOG_INFO("  - Computing final (average) color.");
+        for (int tileIndex = 0; tileIndex < nbTiles; ++tileIndex)
+        {
+            std::unique_ptr<AccuPyramid> tile = tilesCache.take(atlasID, tileIndex);
+
+            if (tile == nullptr)
+                continue;
+
+            const int tileX = (tileIndex % nbTilesPerSide) * tileSide;
+            const int tileY = (tileIndex / nbTilesPerSide) * tileSide;
+            const int tileWidth = std::min(tileSide, textureSide - tileX);
+            const int tileHeight = std::min(tileSide, textureSide - tileY);
+            const AccuImage& tileTexture = tile->pyramid[0];
+
+            // same compositing as generateTexturesSubSet, including texels only covered by the lower frequency bands
+#pragma omp parallel for
+            for (int yp = 0; yp < tileHeight; ++yp)
+            {
+                for (int xp = 0; xp < tileWidth; ++xp)
+                {
+                    const std::size_t tileOffset = std::size_t(yp) * tileSide + xp;
+                    const std::size_t xyoffset = std::size_t(tileY + yp) * textureSide + tileX + xp;
+
+                    averageFrequencyBands(*tile, tileOffset);
+                    atlasTexture.img(xyoffset) = fuseFrequencyBands(*tile, tileOffset);
+                    atlasTexture.imgCount[xyoffset] = tileTexture.imgCount[tileOffset];
+                }
+            }
+        }
+
         writeTexture(atlasTexture, atlasID, outPath, textureFileType, -1);
     }
 }
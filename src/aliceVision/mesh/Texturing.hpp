@@ -19,6 +19,9 @@
 #include <aliceVision/stl/bitmask.hpp>
 
 #include <filesystem>
+#include <map>
+#include <utility>
+#include <vector>
 
 namespace fs = std::filesystem;
 
@@ -64,6 +67,19 @@ std::string EBumpMappingType_enumToString(EBumpMappingType type);
 std::istream& operator>>(std::istream& in, EBumpMappingType& meshFileType);
 std::ostream& operator<<(std::ostream& os, EBumpMappingType meshFileType);
 
+/**
+ * @brief Available texture generation schedulings
+ */
+enum class ETexturingScheduling
+{
+    AtlasMajor = 0,  //< atlases processed by chunks fitting in memory, source images are read once per chunk
+    ViewMajor = 1    //< source images read once, contributions accumulated in atlas tiles stored out-of-core if needed
+};
+ETexturingScheduling ETexturingScheduling_stringToEnum(const std::string& scheduling);
+std::string ETexturingScheduling_enumToString(ETexturingScheduling scheduling);
+std::istream& operator>>(std::istream& in, ETexturingScheduling& scheduling);
+std::ostream& operator<<(std::ostream& os, ETexturingScheduling scheduling);
+
 struct BumpMappingParams
 {
     image::EImageFileType bumpMappingFileType = image::EImageFileType::NONE;
@@ -98,6 +114,9 @@ struct TexturingParams
     EVisibilityRemappingMethod visibilityRemappingMethod = EVisibilityRemappingMethod::PullPush;
 
     float subdivisionTargetRatio = 0.8;
+
+    ETexturingScheduling scheduling = ETexturingScheduling::AtlasMajor;
+    unsigned int tileSide = 1024;  //< atlas tile side for the ViewMajor scheduling
 };
 
 struct Texturing
@@ -192,6 +211,18 @@ struct Texturing
         }
     };
 
+    using AtlasIndex = std::size_t;
+    using ScorePerTriangle = std::vector<std::pair<unsigned int, float>>;            // list of <triangleId, score>
+    using CameraContributions = std::map<AtlasIndex, std::vector<ScorePerTriangle>>;  // per atlas, per frequency band
+
+    /**
+     * @brief Select the best cameras for each triangle of the given atlases.
+     * @param[in] mp the multi-view parameters
+     * @param[in] atlasIDs the atlases
+     * @return the triangles contributions per camera, per atlas and per frequency band (multi-band blending)
+     */
+    std::vector<CameraContributions> computeContributionsPerCamera(const mvsUtils::MultiViewParams& mp, const std::vector<size_t>& atlasIDs) const;
+
     /// Generate texture files for all texture atlases
     void generateTextures(const mvsUtils::MultiViewParams& mp,
                           const fs::path& outPath,
@@ -205,6 +236,21 @@ struct Texturing
                                 const fs::path& outPath,
                                 image::EImageFileType textureFileType = image::EImageFileType::PNG);
 
+    /**
+     * @brief Generate texture files for all texture atlases, reading each source image once.
+     *        Contributions are accumulated in atlas tiles, written to disk when exceeding the memory capacity.
+     * @param[in] mp the multi-view parameters
+     * @param[in] imageCache the source images cache
+     * @param[in] outPath the output folder
+     * @param[in] tilesCapacityMB the maximum memory used by the atlas tiles (in MB)
+     * @param[in] textureFileType the output texture file type
+     */
+    void generateTexturesViewMajor(const mvsUtils::MultiViewParams& mp,
+                                   mvsUtils::ImagesCache<image::Image<image::RGBfColor>>& imageCache,
+                                   const fs::path& outPath,
+                                   std::size_t tilesCapacityMB,
+                                   image::EImageFileType textureFileType = image::EImageFileType::PNG);
+
     void generateNormalAndHeightMaps(const mvsUtils::MultiViewParams& mp,
                                      const Mesh& denseMesh,
                                      const fs::path& outPath,
@@ -0,0 +1,378 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "ZBuffer.hpp"
+
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace aliceVision {
+namespace mesh {
+
+namespace {
+
+/// depth of the near clipping plane: triangles are clipped to keep the parts in front of it
+constexpr double nearPlaneDepth = 1e-6;
+
+/// vertex projected in buffer coordinates (pixel centers at integer coordinates)
+struct ProjectedVertex
+{
+    double x;
+    double y;
+    double invZ;  // <= 0 if the vertex is behind the near plane
+};
+
+/// part of a triangle crossing the near plane, in front of it
+struct ClippedTriangle
+{
+    ProjectedVertex v[3];
+    int triId;
+};
+
+/// triangle projected in a buffer, with its clipped bounding box
+struct ProjectedTriangle
+{
+    const ProjectedVertex* v[3];
+    int xMin, xMax, yMin, yMax;
+
+    /// @return false if the triangle is behind the near plane or does not cover any pixel center of the buffer
+    bool setup(const ProjectedVertex* v0, const ProjectedVertex* v1, const ProjectedVertex* v2, int width, int height)
+    {
+        v[0] = v0;
+        v[1] = v1;
+        v[2] = v2;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            if (v[k]->invZ <= 0.0)
+                return false;
+        }
+
+        // clamp before the conversion: vertices close to the near plane can project far outside of the buffer
+        xMin = int(std::clamp(std::ceil(std::min({v[0]->x, v[1]->x, v[2]->x})), 0.0, double(width)));
+        xMax = int(std::clamp(std::floor(std::max({v[0]->x, v[1]->x, v[2]->x})), -1.0, double(width - 1)));
+        yMin = int(std::clamp(std::ceil(std::min({v[0]->y, v[1]->y, v[2]->y})), 0.0, double(height)));
+        yMax = int(std::clamp(std::floor(std::max({v[0]->y, v[1]->y, v[2]->y})), -1.0, double(height - 1)));
+
+        return (xMin <= xMax && yMin <= yMax);
+    }
+};
+
+/// linear function of the buffer coordinates, relative to an origin pixel: a * dx + b * dy + c
+struct PlaneEquation
+{
+    float a;
+    float b;
+    float c;
+};
+
+/**
+ * @brief Project a point in buffer coordinates.
+ * @param[in] xt the point in homogeneous image coordinates (depth as last coordinate)
+ * @param[in] downscale the buffer downscale factor
+ */
+ProjectedVertex projectVertex(const Point3d& xt, int downscale)
+{
+    ProjectedVertex v;
+    v.invZ = (xt.z >= nearPlaneDepth) ? 1.0 / xt.z : 0.0;
+    v.x = (xt.x * v.invZ + 0.5) / downscale - 0.5;
+    v.y = (xt.y * v.invZ + 0.5) / downscale - 0.5;
+    return v;
+}
+
+/**
+ * @brief Clip a triangle crossing the near plane (Sutherland-Hodgman in homogeneous image coordinates).
+ * @param[in] xt the triangle vertices in homogeneous image coordinates (depth as last coordinate)
+ * @param[in] triId the triangle index
+ * @param[in] downscale the buffer downscale factor
+ * @param[out] out_triangles the triangles of the part in front of the near plane (1 or 2)
+ */
+void clipTriangle(const Point3d* xt, int triId, int downscale, std::vector<ClippedTriangle>& out_triangles)
+{
+    // a triangle clipped by a plane has at most 4 vertices
+    ProjectedVertex polygon[4];
+    int nbVertices = 0;
+
+    for (int k = 0; k < 3; ++k)
+    {
+        const Point3d& a = xt[k];
+        const Point3d& b = xt[(k + 1) % 3];
+        const bool aInFront = (a.z >= nearPlaneDepth);
+        const bool bInFront = (b.z >= nearPlaneDepth);
+
+        if (aInFront)
+            polygon[nbVertices++] = projectVertex(a, downscale);
+
+        if (aInFront != bInFront)
+        {
+            // always interpolate from the vertex in front, so that adjacent triangles share the same clipped vertex
+            const Point3d& f = aInFront ? a : b;
+            const Point3d& r = aInFront ? b : a;
+            Point3d p = f + (r - f) * ((nearPlaneDepth - f.z) / (r.z - f.z));
+            p.z = nearPlaneDepth;
+            polygon[nbVertices++] = projectVertex(p, downscale);
+        }
+    }
+
+    // triangle fan
+    for (int k = 1; k + 1 < nbVertices; ++k)
+    {
+        ClippedTriangle tri;
+        tri.v[0] = polygon[0];
+        tri.v[1] = polygon[k];
+        tri.v[2] = polygon[k + 1];
+        tri.triId = triId;
+        out_triangles.push_back(tri);
+    }
+}
+
+}  // namespace
+
+ZBuffer::ZBuffer(int tileSide)
+  : _tileSide(tileSide)
+{
+    if (tileSide <= 0)
+        throw std::invalid_argument("Invalid z-buffer tile side: " + std::to_string(tileSide) + " (must be strictly positive).");
+}
+
+void ZBuffer::rasterize(const Mesh& mesh, const mvsUtils::MultiViewParams& mp, int camId, int downscale)
+{
+    _P = mp.camArr[camId];
+    _downscale = downscale;
+    _width = divideRoundUp(mp.getWidth(camId), downscale);
+    _height = divideRoundUp(mp.getHeight(camId), downscale);
+    _pixelSizeFactor = double(downscale) / mp.KArr[camId].m11;
+    _nbTriangles = mesh.tris.size();
+
+    // inverse depth per pixel during the rasterization (0 if no triangle)
+    _depths.assign(std::size_t(_width) * _height, 0.f);
+    _triangles.assign(std::size_t(_width) * _height, NO_TRIANGLE);
+
+    // project the vertices in buffer coordinates
+    std::vector<ProjectedVertex> vertices(mesh.pts.size());
+
+#pragma omp parallel for
+    for (int vi = 0; vi < mesh.pts.size(); ++vi)
+    {
+        vertices[vi] = projectVertex(_P * mesh.pts[vi], downscale);
+    }
+
+    // clip the triangles crossing the near plane
+    std::vector<ClippedTriangle> clippedTriangles;
+
+    for (int ti = 0; ti < mesh.tris.size(); ++ti)
+    {
+        const Mesh::triangle& t = mesh.tris[ti];
+        const int nbInFront = (vertices[t.v[0]].invZ > 0.0) + (vertices[t.v[1]].invZ > 0.0) + (vertices[t.v[2]].invZ > 0.0);
+
+        if (nbInFront == 1 || nbInFront == 2)
+        {
+            const Point3d xt[3] = {_P * mesh.pts[t.v[0]], _P * mesh.pts[t.v[1]], _P * mesh.pts[t.v[2]]};
+            clipTriangle(xt, ti, downscale, clippedTriangles);
+        }
+    }
+
+    // rasterized triangles: mesh triangles first, then the clipped triangles
+    const int nbRasterTriangles = _nbTriangles + int(clippedTriangles.size());
+
+    const auto setupTriangle = [&](int rasterTriId, ProjectedTriangle& tri) {
+        if (rasterTriId < _nbTriangles)
+        {
+            const Mesh::triangle& t = mesh.tris[rasterTriId];
+            return tri.setup(&vertices[t.v[0]], &vertices[t.v[1]], &vertices[t.v[2]], _width, _height);
+        }
+        const ClippedTriangle& t = clippedTriangles[rasterTriId - _nbTriangles];
+        return tri.setup(&t.v[0], &t.v[1], &t.v[2], _width, _height);
+    };
+
+    // bin the triangles per tile (compact storage: count, prefix sum, fill)
+    const int nbTilesX = divideRoundUp(_width, _tileSide);
+    const int nbTilesY = divideRoundUp(_height, _tileSide);
+    const int nbTiles = nbTilesX * nbTilesY;
+
+    std::vector<std::int64_t> tileOffsets(nbTiles + 1, 0);
+
+#pragma omp parallel for
+    for (int ti = 0; ti < nbRasterTriangles; ++ti)
+    {
+        ProjectedTriangle tri;
+        if (!setupTriangle(ti, tri))
+            continue;
+
+        for (int ty = tri.yMin / _tileSide; ty <= tri.yMax / _tileSide; ++ty)
+        {
+            for (int tx = tri.xMin / _tileSide; tx <= tri.xMax / _tileSide; ++tx)
+            {
+#pragma omp atomic
+                ++tileOffsets[ty * nbTilesX + tx + 1];
+            }
+        }
+    }
+
+    for (int tile = 0; tile < nbTiles; ++tile)
+        tileOffsets[tile + 1] += tileOffsets[tile];
+
+    std::vector<int> tileTriangles(tileOffsets[nbTiles]);
+    std::vector<std::int64_t> tileCursors(tileOffsets.begin(), tileOffsets.end() - 1);
+
+#pragma omp parallel for
+    for (int ti = 0; ti < nbRasterTriangles; ++ti)
+    {
+        ProjectedTriangle tri;
+        if (!setupTriangle(ti, tri))
+            continue;
+
+        for (int ty = tri.yMin / _tileSide; ty <= tri.yMax / _tileSide; ++ty)
+        {
+            for (int tx = tri.xMin / _tileSide; tx <= tri.xMax / _tileSide; ++tx)
+            {
+                std::int64_t cursor;
+#pragma omp atomic capture
+                cursor = tileCursors[ty * nbTilesX + tx]++;
+
+                tileTriangles[cursor] = ti;
+            }
+        }
+    }
+
+    // rasterize each tile independently
+#pragma omp parallel for schedule(dynamic)
+    for (int tile = 0; tile < nbTiles; ++tile)
+    {
+        const int tileX0 = (tile % nbTilesX) * _tileSide;
+        const int tileY0 = (tile / nbTilesX) * _tileSide;
+        const int tileX1 = std::min(_width, tileX0 + _tileSide) - 1;
+        const int tileY1 = std::min(_height, tileY0 + _tileSide) - 1;
+
+        for (std::int64_t i = tileOffsets[tile]; i < tileOffsets[tile + 1]; ++i)
+        {
+            const int rasterTriId = tileTriangles[i];
+            const int triId = (rasterTriId < _nbTriangles) ? rasterTriId : clippedTriangles[rasterTriId - _nbTriangles].triId;
+
+            ProjectedTriangle tri;
+            setupTriangle(rasterTriId, tri);
+
+            const ProjectedVertex& v0 = *tri.v[0];
+            const ProjectedVertex& v1 = *tri.v[1];
+            const ProjectedVertex& v2 = *tri.v[2];
+
+            const double area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+            if (area == 0.0)
+                continue;
+
+            const double invArea = 1.0 / area;
+
+            // origin of the plane equations (small offsets keep the float evaluation accurate)
+            const int ox = tri.xMin;
+            const int oy = tri.yMin;
+
+            // barycentric weight of the vertex opposite to the edge (a, b), positive inside the triangle whatever its orientation
+            const auto edgeEquation = [&](const ProjectedVertex& a, const ProjectedVertex& b) {
+                PlaneEquation e;
+                e.a = float(-(b.y - a.y) * invArea);
+                e.b = float((b.x - a.x) * invArea);
+                e.c = float(((b.x - a.x) * (oy - a.y) - (b.y - a.y) * (ox - a.x)) * invArea);
+                return e;
+            };
+
+            const PlaneEquation e0 = edgeEquation(v1, v2);
+            const PlaneEquation e1 = edgeEquation(v2, v0);
+            const PlaneEquation e2 = edgeEquation(v0, v1);
+
+            // inverse depth is linear in screen space
+            PlaneEquation ez;
+            ez.a = e0.a * float(v0.invZ) + e1.a * float(v1.invZ) + e2.a * float(v2.invZ);
+            ez.b = e0.b * float(v0.invZ) + e1.b * float(v1.invZ) + e2.b * float(v2.invZ);
+            ez.c = e0.c * float(v0.invZ) + e1.c * float(v1.invZ) + e2.c * float(v2.invZ);
+
+            const int xBegin = std::max(tri.xMin, tileX0);
+            const int xEnd = std::min(tri.xMax, tileX1);
+            const int yBegin = std::max(tri.yMin, tileY0);
+            const int yEnd = std::min(tri.yMax, tileY1);
+
+            for (int y = yBegin; y <= yEnd; ++y)
+            {
+                const float dy = float(y - oy);
+                const float w0y = e0.b * dy + e0.c;
+                const float w1y = e1.b * dy + e1.c;
+                const float w2y = e2.b * dy + e2.c;
+                const float zy = ez.b * dy + ez.c;
+
+                float* rowInvZ = &_depths[std::size_t(y) * _width];
+                int* rowTriangles = &_triangles[std::size_t(y) * _width];
+
+#pragma omp simd
+                for (int x = xBegin; x <= xEnd; ++x)
+                {
+                    const float dx = float(x - ox);
+                    const float w0 = e0.a * dx + w0y;
+                    const float w1 = e1.a * dx + w1y;
+                    const float w2 = e2.a * dx + w2y;
+                    const float invZ = ez.a * dx + zy;
+
+                    // closest triangle, ties broken by the smallest index for a deterministic result
+                    const bool inside = (w0 >= 0.f) & (w1 >= 0.f) & (w2 >= 0.f);
+                    const bool closer = (invZ > rowInvZ[x]) | ((invZ == rowInvZ[x]) & (triId < rowTriangles[x]));
+                    const bool write = inside & closer;
+
+                    rowInvZ[x] = write ? invZ : rowInvZ[x];
+                    rowTriangles[x] = write ? triId : rowTriangles[x];
+                }
+            }
+        }
+    }
+
+    // inverse depth to depth
+#pragma omp parallel for
+    for (std::int64_t i = 0; i < std::int64_t(_depths.size()); ++i)
+    {
+        _depths[i] = (_triangles[i] == NO_TRIANGLE) ? std::numeric_limits<float>::infinity() : 1.f / _depths[i];
+    }
+}
+
+bool ZBuffer::isPointVisible(const Point3d& p, float tolerance) const
+{
+    const Point3d xt = _P * p;
+    if (xt.z <= 0.0)
+        return false;
+
+    const int x = int(std::round((xt.x / xt.z + 0.5) / _downscale - 0.5));
+    const int y = int(std::round((xt.y / xt.z + 0.5) / _downscale - 0.5));
+    if (x < 0 || x >= _width || y < 0 || y >= _height)
+        return false;
+
+    const double pixelSize = xt.z * _pixelSizeFactor;
+    return (xt.z <= getDepth(x, y) + tolerance * pixelSize);
+}
+
+void ZBuffer::getVisibleTriangles(StaticVector<int>& out_visTri) const
+{
+    std::vector<std::uint8_t> visible(_nbTriangles, 0);
+
+    for (const int triId : _triangles)
+    {
+        if (triId != NO_TRIANGLE)
+            visible[triId] = 1;
+    }
+
+    out_visTri.clear();
+    out_visTri.reserve(std::count(visible.begin(), visible.end(), 1));
+
+    for (int triId = 0; triId < _nbTriangles; ++triId)
+    {
+        if (visible[triId])
+            out_visTri.push_back(triId);
+    }
+}
+
+}  // namespace mesh
+}  // namespace aliceVision
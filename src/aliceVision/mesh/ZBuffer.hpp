@@ -0,0 +1,96 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mvsData/Matrix3x4.hpp>
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+/**
+ * @class ZBuffer
+ * @brief Depth and triangle index per pixel of a mesh seen from a camera.
+ *        The triangles are binned in square tiles of the image and each tile is rasterized
+ *        by a single thread, with edge functions and a vectorized depth test per row.
+ */
+class ZBuffer
+{
+  public:
+    /// triangle index of the pixels without triangle
+    static constexpr int NO_TRIANGLE = -1;
+
+    /// default depth tolerance of the occlusion test, in number of pixel sizes (see isPointVisible)
+    static constexpr float DEFAULT_DEPTH_TOLERANCE = 6.f;
+
+    /**
+     * @brief ZBuffer constructor.
+     * @param[in] tileSide the rasterization tile side in pixels
+     * @throw std::invalid_argument if the tile side is not strictly positive
+     */
+    explicit ZBuffer(int tileSide = 64);
+
+    /**
+     * @brief Rasterize the mesh triangles in the given camera.
+     *        Triangles crossing the near plane are clipped, only their part in front of the camera is rasterized.
+     * @param[in] mesh the mesh
+     * @param[in] mp the multi-view parameters
+     * @param[in] camId the camera index
+     * @param[in] downscale the buffer downscale factor regarding the camera image size
+     */
+    void rasterize(const Mesh& mesh, const mvsUtils::MultiViewParams& mp, int camId, int downscale = 1);
+
+    inline int getWidth() const { return _width; }
+    inline int getHeight() const { return _height; }
+    inline int getDownscale() const { return _downscale; }
+
+    /// depth along the camera axis at the given buffer pixel (infinity if no triangle)
+    inline float getDepth(int x, int y) const { return _depths[std::size_t(y) * _width + x]; }
+
+    /// triangle index at the given buffer pixel (NO_TRIANGLE if no triangle)
+    inline int getTriangle(int x, int y) const { return _triangles[std::size_t(y) * _width + x]; }
+
+    /// depth per pixel, row major
+    inline const std::vector<float>& getDepths() const { return _depths; }
+
+    /// triangle index per pixel, row major
+    inline const std::vector<int>& getTriangles() const { return _triangles; }
+
+    /**
+     * @brief Check if a 3D point projects in the buffer and is not occluded by the rasterized mesh.
+     * @param[in] p the 3D point (in general a vertex of the rasterized mesh)
+     * @param[in] tolerance the depth tolerance in number of pixel sizes at the point depth
+     * @return true if the point is visible
+     */
+    bool isPointVisible(const Point3d& p, float tolerance = DEFAULT_DEPTH_TOLERANCE) const;
+
+    /**
+     * @brief Get the indexes of the triangles covering at least one pixel of the buffer.
+     * @param[out] out_visTri the sorted visible triangles indexes
+     */
+    void getVisibleTriangles(StaticVector<int>& out_visTri) const;
+
+  private:
+    const int _tileSide;            //< rasterization tile side in pixels
+    Matrix3x4 _P;                   //< camera projection matrix (image scale)
+    int _downscale = 1;             //< buffer downscale factor
+    int _width = 0;                 //< buffer width
+    int _height = 0;                //< buffer height
+    double _pixelSizeFactor = 0.0;  //< pixel size in space per unit of depth
+    int _nbTriangles = 0;           //< number of triangles of the rasterized mesh
+    std::vector<float> _depths;     //< depth per pixel
+    std::vector<int> _triangles;    //< triangle index per pixel
+};
+
+}  // namespace mesh
+}  // namespace aliceVision
@@ -0,0 +1,201 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mesh/ZBuffer.hpp>
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+#define BOOST_TEST_MODULE meshZBuffer
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+namespace {
+
+constexpr int imageWidth = 96;
+constexpr int imageHeight = 72;
+constexpr double focalLength = 100.0;
+
+/**
+ * @brief Single camera at the origin looking along the Z axis.
+ */
+sfmData::SfMData generateSfm()
+{
+    sfmData::SfMData sfmData;
+
+    sfmData.getIntrinsics().emplace(0,
+                                    camera::createPinhole(camera::EDISTORTION::DISTORTION_NONE,
+                                                          camera::EUNDISTORTION::UNDISTORTION_NONE,
+                                                          imageWidth,
+                                                          imageHeight,
+                                                          focalLength,
+                                                          focalLength,
+                                                          0.0,
+                                                          0.0));
+
+    sfmData.getViews().emplace(0, std::make_shared<sfmData::View>("", 0, 0, 0, imageWidth, imageHeight));
+    sfmData.setPose(*sfmData.getViews().at(0), sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3::Zero())));
+
+    return sfmData;
+}
+
+/**
+ * @brief Add a grid of vertices on a plane (2 triangles per cell).
+ * @param[in,out] mesh the mesh
+ * @param[in] origin the position of the first vertex
+ * @param[in] u the step between 2 columns of the grid
+ * @param[in] v the step between 2 rows of the grid
+ * @param[in] nbU the number of columns
+ * @param[in] nbV the number of rows
+ * @return the index of the first vertex
+ */
+int addGrid(Mesh& mesh, const Point3d& origin, const Point3d& u, const Point3d& v, int nbU, int nbV)
+{
+    const int firstVertex = mesh.pts.size();
+
+    for (int j = 0; j < nbV; ++j)
+    {
+        for (int i = 0; i < nbU; ++i)
+            mesh.pts.push_back(origin + u * i + v * j);
+    }
+
+    for (int j = 0; j + 1 < nbV; ++j)
+    {
+        for (int i = 0; i + 1 < nbU; ++i)
+        {
+            const int a = firstVertex + j * nbU + i;
+            mesh.tris.push_back(Mesh::triangle(a, a + 1, a + nbU));
+            mesh.tris.push_back(Mesh::triangle(a + 1, a + nbU + 1, a + nbU));
+        }
+    }
+
+    return firstVertex;
+}
+
+/// column of the projection of a point in the camera
+double projectX(const Point3d& p) { return focalLength * p.x / p.z + imageWidth * 0.5; }
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(zBuffer_occluderInFrontOfBackPlane)
+{
+    const sfmData::SfMData sfmData = generateSfm();
+    const mvsUtils::MultiViewParams mp(sfmData, "", "", "", false);
+
+    // back plane at depth 10, larger than the field of view
+    Mesh mesh;
+    const int nbBackVertices = 13 * 11;
+    addGrid(mesh, Point3d(-6.0, -5.0, 10.0), Point3d(1.0, 0.0, 0.0), Point3d(0.0, 1.0, 0.0), 13, 11);
+    const int nbBackTriangles = mesh.tris.size();
+
+    // occluder at depth 5, covering the left half of the image
+    addGrid(mesh, Point3d(-3.0, -3.0, 5.0), Point3d(1.0, 0.0, 0.0), Point3d(0.0, 1.0, 0.0), 4, 7);
+
+    ZBuffer zBuffer(16);
+    zBuffer.rasterize(mesh, mp, 0);
+
+    BOOST_REQUIRE_EQUAL(zBuffer.getWidth(), imageWidth);
+    BOOST_REQUIRE_EQUAL(zBuffer.getHeight(), imageHeight);
+
+    // the occluder covers the left half, the back plane the right half
+    for (int y = 0; y < imageHeight; ++y)
+    {
+        BOOST_CHECK_CLOSE(zBuffer.getDepth(imageWidth / 4, y), 5.f, 1e-3);
+        BOOST_CHECK_GE(zBuffer.getTriangle(imageWidth / 4, y), nbBackTriangles);
+        BOOST_CHECK_CLOSE(zBuffer.getDepth(3 * imageWidth / 4, y), 10.f, 1e-3);
+        BOOST_CHECK_LT(zBuffer.getTriangle(3 * imageWidth / 4, y), nbBackTriangles);
+    }
+
+    int nbOccluded = 0;
+    int nbVisible = 0;
+
+    for (int vi = 0; vi < mesh.pts.size(); ++vi)
+    {
+        const Point3d& p = mesh.pts[vi];
+        const double x = projectX(p);
+        const double y = focalLength * p.y / p.z + imageHeight * 0.5;
+
+        // outside of the image
+        if (x < 0.0 || x > imageWidth - 1 || y < 0.0 || y > imageHeight - 1)
+        {
+            BOOST_CHECK(!zBuffer.isPointVisible(p));
+            continue;
+        }
+
+        // back plane vertices behind the occluder (away from its border)
+        if (vi < nbBackVertices && x < imageWidth * 0.5 - 3.0)
+        {
+            BOOST_CHECK(!zBuffer.isPointVisible(p));
+            ++nbOccluded;
+        }
+        else if (vi >= nbBackVertices || x > imageWidth * 0.5 + 3.0)
+        {
+            BOOST_CHECK(zBuffer.isPointVisible(p));
+            ++nbVisible;
+        }
+    }
+
+    BOOST_CHECK_GT(nbOccluded, 0);
+    BOOST_CHECK_GT(nbVisible, 0);
+
+    // the rasterization does not depend on the tiles
+    ZBuffer zBufferSingleTile(imageWidth);
+    zBufferSingleTile.rasterize(mesh, mp, 0);
+    BOOST_CHECK(zBufferSingleTile.getTriangles() == zBuffer.getTriangles());
+    BOOST_CHECK(zBufferSingleTile.getDepths() == zBuffer.getDepths());
+}
+
+BOOST_AUTO_TEST_CASE(zBuffer_nearPlaneClipping)
+{
+    const sfmData::SfMData sfmData = generateSfm();
+    const mvsUtils::MultiViewParams mp(sfmData, "", "", "", false);
+
+    // ground plane 1 unit below the camera (Y axis pointing down), extending behind the camera
+    // (off-center, so that no pixel center lies exactly on the diagonal of the quad)
+    Mesh mesh;
+    addGrid(mesh, Point3d(-20.37, 1.0, -5.0), Point3d(40.0, 0.0, 0.0), Point3d(0.0, 0.0, 25.0), 2, 2);
+
+    ZBuffer zBuffer;
+    zBuffer.rasterize(mesh, mp, 0);
+
+    StaticVector<int> visibleTriangles;
+    zBuffer.getVisibleTriangles(visibleTriangles);
+    BOOST_CHECK_EQUAL(visibleTriangles.size(), 2);
+
+    // rows below the horizon see the ground plane at the depth of the ray intersection
+    int nbPixels = 0;
+    for (int y = imageHeight / 2 + 6; y < imageHeight; ++y)
+    {
+        const double expectedDepth = focalLength / (y - imageHeight * 0.5);
+        for (int x = 0; x < imageWidth; ++x)
+        {
+            BOOST_CHECK_NE(zBuffer.getTriangle(x, y), ZBuffer::NO_TRIANGLE);
+            BOOST_CHECK_CLOSE(zBuffer.getDepth(x, y), float(expectedDepth), 1e-2);
+            ++nbPixels;
+        }
+    }
+    BOOST_CHECK_GT(nbPixels, 0);
+
+    // rows above the horizon see nothing
+    for (int y = 0; y < imageHeight / 2; ++y)
+    {
+        for (int x = 0; x < imageWidth; ++x)
+            BOOST_CHECK_EQUAL(zBuffer.getTriangle(x, y), ZBuffer::NO_TRIANGLE);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(zBuffer_invalidTileSide)
+{
+    BOOST_CHECK_THROW(ZBuffer(0), std::invalid_argument);
+    BOOST_CHECK_THROW(ZBuffer(-16), std::invalid_argument);
+}
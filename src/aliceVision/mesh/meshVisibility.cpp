@@ -6,6 +6,7 @@
 
 #include "meshVisibility.hpp"
 #include "geoMesh.hpp"
+#include "ZBuffer.hpp"
 
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
@@ -136,25 +137,12 @@ void remapMeshVisibilities_pushVerticesVisibilityToTriangles(const Mesh& refMesh
     ALICEVISION_LOG_INFO("remapMeshVisibility done.");
 }
 
-void remapMeshVisibilities_meshItself(const mvsUtils::MultiViewParams& mp, Mesh& mesh)
+void remapMeshVisibilities_meshItself(const mvsUtils::MultiViewParams& mp, Mesh& mesh, int downscale, float depthTolerance)
 {
     ALICEVISION_LOG_INFO("remapMeshVisibility based on triangles normals start.");
 
     PointsVisibility& out_ptsVisibilities = mesh.pointsVisibilities;
 
-    GEO::initialize();
-    GEO::Mesh meshG;
-    toGeoMesh(mesh, meshG);
-
-    // MeshFacetAABB will reorder the mesh, so we need to keep indices
-    GEO::Attribute<GEO::index_t> reorderedVerticesAttr(meshG.vertices.attributes(), "reorder");
-    for (int i = 0; i < meshG.vertices.nb(); ++i)
-        reorderedVerticesAttr[i] = i;
-
-    GEO::MeshFacetsAABB meshAABB(meshG);  // warning: mesh_reorder called inside
-
-    GEO::vector<GEO::index_t> reorderedVertices = reorderedVerticesAttr.get_vector();
-
     if (out_ptsVisibilities.size() != mesh.pts.size())
     {
         out_ptsVisibilities.resize(mesh.pts.size());
@@ -164,22 +152,24 @@ void remapMeshVisibilities_meshItself(const mvsUtils::MultiViewParams& mp, Mesh&
     StaticVector<Point3d> normalsPerVertex;
     mesh.computeNormalsForPts(normalsPerVertex);
 
-    ALICEVISION_LOG_INFO("Start checking each vertex: " << mesh.pts.size() << " vertices.");
+    ALICEVISION_LOG_INFO("Start checking each vertex: " << mesh.pts.size() << " vertices, " << nbCameras << " cameras.");
 
-#pragma omp parallel for
-    for (int vi = 0; vi < mesh.pts.size(); ++vi)
+    // one rasterization per camera instead of one occlusion ray per vertex and camera
+    ZBuffer zBuffer;
+
+    for (std::size_t camIndex = 0; camIndex < nbCameras; ++camIndex)
     {
-        const Point3d& v = mesh.pts[vi];
-        PointVisibility& vertexVisibility = out_ptsVisibilities[vi];
-        const Point3d& n = normalsPerVertex[vi];
+        zBuffer.rasterize(mesh, mp, camIndex, downscale);
 
-        // Check by which camera the vertex is visible
-        for (std::size_t camIndex = 0; camIndex < nbCameras; ++camIndex)
+        const Point3d& c = mp.CArr[camIndex];
+
+#pragma omp parallel for
+        for (int vi = 0; vi < mesh.pts.size(); ++vi)
         {
-            const Point3d& c = mp.CArr[camIndex];
+            const Point3d& v = mesh.pts[vi];
 
             // Check if the point is in the camera's frutum.
-            // Project in image space and check that the pixel coordinates are in the image.
+            // Project in image space and check that the pixel coordinates are in the image, with a 1 pixel margin.
             Pixel pix;
             mp.getPixelFor3DPoint(&pix, v, camIndex);
             if (!mp.isPixelInImage(pix, camIndex, 1))
@@ -190,15 +180,11 @@ void remapMeshVisibilities_meshItself(const mvsUtils::MultiViewParams& mp, Mesh&
             if (angle > 90.0)
                 continue;
 
-            const GEO::vec3 gv(v.x, v.y, v.z);
-            const GEO::vec3 gc(c.x, c.y, c.z);
-            const GEO::vec3 vc = gc - gv;
-            // check if there is an occlusion on the segment between the current mesh vertex and the camera
-            const bool occlusion = meshAABB.ray_intersection(GEO::Ray(gv + (vc * 0.00001), vc), 1.0);
-            if (occlusion)
+            // check that the vertex is not occluded by the mesh
+            if (!zBuffer.isPointVisible(v, depthTolerance))
                 continue;
 
-            vertexVisibility.push_back(camIndex);
+            out_ptsVisibilities[vi].push_back(camIndex);
         }
     }
     ALICEVISION_LOG_INFO("remapMeshVisibility based on triangles normals done.");
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/ZBuffer.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 
 namespace aliceVision {
@@ -42,7 +43,20 @@ void remapMeshVisibilities_pullVerticesVisibility(const Mesh& refMesh, Mesh& mes
  */
 void remapMeshVisibilities_pushVerticesVisibilityToTriangles(const Mesh& refMesh, Mesh& mesh);
 
-void remapMeshVisibilities_meshItself(const mvsUtils::MultiViewParams& mp, Mesh& mesh);
+/**
+ * @brief Compute the visibility per vertex from the mesh itself.
+ * A vertex is visible in a camera if it faces the camera and is not occluded in the camera z-buffer.
+ * @note The visibility information is a list of camera IDs seeing the vertex.
+ *
+ * @param[in] mp the multi-view parameters
+ * @param[in,out] mesh the mesh
+ * @param[in] downscale the z-buffer downscale factor regarding the cameras images size
+ * @param[in] depthTolerance the occlusion depth tolerance in number of pixel sizes
+ */
+void remapMeshVisibilities_meshItself(const mvsUtils::MultiViewParams& mp,
+                                      Mesh& mesh,
+                                      int downscale = 1,
+                                      float depthTolerance = ZBuffer::DEFAULT_DEPTH_TOLERANCE);
 
 }  // namespace mesh
 }  // namespace aliceVision
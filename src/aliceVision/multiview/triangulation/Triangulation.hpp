@@ -32,12 +32,38 @@ namespace multiview {
  */
 void TriangulateNView(const Mat2X& x, const std::vector<Mat34>& Ps, Vec4& X, const std::vector<double>* weights = nullptr);
 
+/// maximum number of views triangulated with a fixed-size (stack allocated) design matrix
+constexpr Mat2X::Index TRIANGULATION_FIXED_SIZE_MAX_NB_VIEWS = 8;
+
+/**
+ * @brief TriangulateNViewAlgebraic with a given design matrix type.
+ * @see TriangulateNViewAlgebraic
+ */
+template<class DesignMatT, class ContainerT>
+void TriangulateNViewAlgebraicWithDesign(const ContainerT& x, const std::vector<Mat34>& Ps, Vec4& X, const std::vector<double>* weights)
+{
+    const Mat2X::Index nviews = CountElements(x);
+
+    DesignMatT design(2 * nviews, 4);
+    for (Mat2X::Index i = 0; i < nviews; ++i)
+    {
+        design.template block<2, 4>(2 * i, 0) = SkewMatMinimal(getElement<ContainerT>(x, i)) * Ps[i];
+        if (weights != nullptr)
+        {
+            design.template block<2, 4>(2 * i, 0) *= (*weights)[i];
+        }
+    }
+    Nullspace(design, X);
+}
+
 /**
  * @brief Compute a 3D position of a point from several images of it. In particular,
  * compute the projective point X in R^4 such that x ~ PX.
  * Algorithm is the standard DLT
  * It also allows to specify some (optional) weight for each point (solving the
  * weighted least squared problem)
+ * Up to TRIANGULATION_FIXED_SIZE_MAX_NB_VIEWS views (the common track lengths), the design
+ * matrix and its SVD do not use any heap allocation.
  *
  * @param[in] x are 2D coordinates (x,y) in each image
  * @param[in] Ps is the list of projective matrices for each camera
@@ -51,16 +77,15 @@ void TriangulateNViewAlgebraic(const ContainerT& x, const std::vector<Mat34>& Ps
     Mat2X::Index nviews = CountElements(x);
     assert(static_cast<std::size_t>(nviews) == Ps.size());
 
-    Mat design(2 * nviews, 4);
-    for (Mat2X::Index i = 0; i < nviews; ++i)
+    if (nviews <= TRIANGULATION_FIXED_SIZE_MAX_NB_VIEWS)
     {
-        design.block<2, 4>(2 * i, 0) = SkewMatMinimal(getElement<ContainerT>(x, i)) * Ps[i];
-        if (weights != nullptr)
-        {
-            design.block<2, 4>(2 * i, 0) *= (*weights)[i];
-        }
+        using FixedSizeDesignMat = Eigen::Matrix<double, Eigen::Dynamic, 4, Eigen::ColMajor, 2 * TRIANGULATION_FIXED_SIZE_MAX_NB_VIEWS, 4>;
+        TriangulateNViewAlgebraicWithDesign<FixedSizeDesignMat>(x, Ps, X, weights);
+    }
+    else
+    {
+        TriangulateNViewAlgebraicWithDesign<Mat>(x, Ps, X, weights);
     }
-    Nullspace(design, X);
 }
 
 /**
@@ -0,0 +1,120 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MapCache.hpp"
+
+#include <aliceVision/mvsUtils/mapIO.hpp>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+MapCache::MapCache(const MultiViewParams& mp, std::size_t capacityMB)
+  : MapCache(capacityMB, [&mp](int camId, EFileType fileType, image::Image<float>& out_map) { readMap(camId, mp, fileType, out_map); })
+{}
+
+MapCache::MapCache(std::size_t capacityMB, ReadMapFunction readMapFunction)
+  : _readMapFunction(std::move(readMapFunction)),
+    _capacityBytes(capacityMB * 1024 * 1024)
+{}
+
+MapCache::MapPtr MapCache::get(int camId, EFileType fileType)
+{
+    const Key key(camId, fileType);
+    std::promise<MapPtr> promise;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        auto it = _entries.find(key);
+        if (it != _entries.end())
+        {
+            ++_nbHits;
+            _lru.splice(_lru.begin(), _lru, it->second.lruIt);
+            std::shared_future<MapPtr> map = it->second.map;
+            lock.unlock();
+
+            // wait if the map is being read by another thread
+            return map.get();
+        }
+
+        // register the map as loading, other threads will wait for it
+        ++_nbMisses;
+        _lru.push_front(key);
+
+        Entry& entry = _entries[key];
+        entry.map = promise.get_future().share();
+        entry.lruIt = _lru.begin();
+    }
+
+    std::shared_ptr<image::Image<float>> map = std::make_shared<image::Image<float>>();
+
+    try
+    {
+        _readMapFunction(camId, fileType, *map);
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _entries.find(key);
+            _lru.erase(it->second.lruIt);
+            _entries.erase(it);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        Entry& entry = _entries.at(key);
+        entry.bytes = std::size_t(map->size()) * sizeof(float);
+        entry.loaded = true;
+        _usedBytes += entry.bytes;
+
+        evict();
+    }
+
+    promise.set_value(map);
+    return map;
+}
+
+void MapCache::invalidate(int camId, EFileType fileType)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _entries.find(Key(camId, fileType));
+    if (it == _entries.end() || !it->second.loaded)
+        return;
+
+    _usedBytes -= it->second.bytes;
+    _lru.erase(it->second.lruIt);
+    _entries.erase(it);
+}
+
+void MapCache::evict()
+{
+    auto lruIt = _lru.end();
+
+    while (_usedBytes > _capacityBytes && lruIt != _lru.begin())
+    {
+        --lruIt;
+
+        auto it = _entries.find(*lruIt);
+
+        // maps being read are not accounted yet, skip them
+        if (!it->second.loaded)
+            continue;
+
+        _usedBytes -= it->second.bytes;
+        lruIt = _lru.erase(lruIt);
+        _entries.erase(it);
+        ++_nbEvictions;
+    }
+}
+
+}  // namespace mvsUtils
+}  // namespace aliceVision
@@ -0,0 +1,107 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/image/Image.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+/**
+ * @class MapCache
+ * @brief Bounded, thread-safe LRU cache of fullsize float maps (depth, sim, ...) read with readMap.
+ * @note A map requested by several threads at the same time is read only once.
+ *       Maps in use by a caller stay valid after eviction (shared ownership).
+ */
+class MapCache
+{
+  public:
+    using MapPtr = std::shared_ptr<const image::Image<float>>;
+    using ReadMapFunction = std::function<void(int camId, EFileType fileType, image::Image<float>& out_map)>;
+
+    /**
+     * @brief MapCache constructor, maps are read from the multi-view parameters folders with readMap.
+     * @param[in] mp the multi-view parameters
+     * @param[in] capacityMB the maximum memory used by the cached maps (in MB)
+     */
+    MapCache(const MultiViewParams& mp, std::size_t capacityMB);
+
+    /**
+     * @brief MapCache constructor.
+     * @param[in] capacityMB the maximum memory used by the cached maps (in MB)
+     * @param[in] readMapFunction the function used to read a map not cached (could be called from several threads)
+     */
+    MapCache(std::size_t capacityMB, ReadMapFunction readMapFunction);
+
+    // no copy constructor
+    MapCache(const MapCache&) = delete;
+
+    // no copy operator
+    MapCache& operator=(const MapCache&) = delete;
+
+    /**
+     * @brief Get a fullsize map, read it from file(s) if not cached.
+     * @param[in] camId the camera index
+     * @param[in] fileType the map fileType enum
+     * @return the map (could be empty if the map cannot be read)
+     */
+    MapPtr get(int camId, EFileType fileType);
+
+    /**
+     * @brief Remove a map from the cache (e.g. after its file has been rewritten).
+     * @param[in] camId the camera index
+     * @param[in] fileType the map fileType enum
+     */
+    void invalidate(int camId, EFileType fileType);
+
+    /// number of requests served from the cache
+    inline std::size_t getNbHits() const { return _nbHits; }
+
+    /// number of requests that needed a read from file(s)
+    inline std::size_t getNbMisses() const { return _nbMisses; }
+
+    /// number of maps removed from the cache to fit in its capacity
+    inline std::size_t getNbEvictions() const { return _nbEvictions; }
+
+  private:
+    using Key = std::pair<int, EFileType>;
+
+    struct Entry
+    {
+        std::shared_future<MapPtr> map;
+        std::list<Key>::iterator lruIt;
+        std::size_t bytes = 0;
+        bool loaded = false;
+    };
+
+    /// evict least recently used loaded maps until the cache fits in its capacity (mutex locked)
+    void evict();
+
+    const ReadMapFunction _readMapFunction;    //< reads a map not cached
+    const std::size_t _capacityBytes;          //< maximum memory used by the cached maps
+    std::atomic<std::size_t> _nbHits{0};       //< cache hits
+    std::atomic<std::size_t> _nbMisses{0};     //< cache misses
+    std::atomic<std::size_t> _nbEvictions{0};  //< maps evicted
+    std::size_t _usedBytes = 0;                //< memory used by the cached maps
+    std::map<Key, Entry> _entries;             //< cached maps
+    std::list<Key> _lru;                       //< keys from most to least recently used
+    std::mutex _mutex;                         //< protects _usedBytes, _entries and _lru
+};
+
+}  // namespace mvsUtils
+}  // namespace aliceVision
@@ -0,0 +1,134 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mvsUtils/MapCache.hpp>
+
+#include <atomic>
+#include <stdexcept>
+
+#define BOOST_TEST_MODULE mvsUtilsMapCache
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mvsUtils;
+
+namespace {
+
+// 512 x 512 float map: 1 MB
+constexpr int mapSide = 512;
+
+/**
+ * @brief Map reader counting the reads, the map is filled with the camera index.
+ */
+struct CountingReader
+{
+    std::atomic<int> nbReads{0};
+
+    MapCache::ReadMapFunction function()
+    {
+        return [this](int camId, EFileType fileType, image::Image<float>& out_map) {
+            ++nbReads;
+            if (camId < 0)
+                throw std::runtime_error("Cannot read map.");
+            out_map.resize(mapSide, mapSide, true, float(camId));
+        };
+    }
+};
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(mapCache_hitsAndMisses)
+{
+    CountingReader reader;
+    MapCache cache(8, reader.function());
+
+    const MapCache::MapPtr map0 = cache.get(0, EFileType::depthMap);
+    BOOST_REQUIRE(map0);
+    BOOST_CHECK_EQUAL((*map0)(0, 0), 0.f);
+    BOOST_CHECK_EQUAL(cache.getNbHits(), 0);
+    BOOST_CHECK_EQUAL(cache.getNbMisses(), 1);
+
+    // same map: served from the cache
+    BOOST_CHECK(cache.get(0, EFileType::depthMap) == map0);
+    BOOST_CHECK_EQUAL(cache.getNbHits(), 1);
+    BOOST_CHECK_EQUAL(cache.getNbMisses(), 1);
+
+    // same camera, other file type: read
+    const MapCache::MapPtr simMap0 = cache.get(0, EFileType::simMap);
+    BOOST_CHECK(simMap0 != map0);
+    BOOST_CHECK_EQUAL(cache.getNbMisses(), 2);
+
+    // invalidated map: read again
+    cache.invalidate(0, EFileType::depthMap);
+    BOOST_CHECK(cache.get(0, EFileType::depthMap) != map0);
+    BOOST_CHECK_EQUAL(cache.getNbHits(), 1);
+    BOOST_CHECK_EQUAL(cache.getNbMisses(), 3);
+    BOOST_CHECK_EQUAL(reader.nbReads.load(), 3);
+
+    // read failure: the error is forwarded and nothing is cached
+    BOOST_CHECK_THROW(cache.get(-1, EFileType::depthMap), std::runtime_error);
+    BOOST_CHECK_THROW(cache.get(-1, EFileType::depthMap), std::runtime_error);
+    BOOST_CHECK_EQUAL(reader.nbReads.load(), 5);
+    BOOST_CHECK_EQUAL(cache.getNbEvictions(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(mapCache_lruEviction)
+{
+    CountingReader reader;
+    MapCache cache(2, reader.function());  // 2 maps
+
+    const MapCache::MapPtr map0 = cache.get(0, EFileType::depthMap);
+    cache.get(1, EFileType::depthMap);
+    cache.get(0, EFileType::depthMap);  // 1 is now the least recently used
+
+    cache.get(2, EFileType::depthMap);  // evicts 1
+    BOOST_CHECK_EQUAL(cache.getNbEvictions(), 1);
+    BOOST_CHECK_EQUAL(reader.nbReads.load(), 3);
+
+    BOOST_CHECK(cache.get(0, EFileType::depthMap) == map0);
+    cache.get(2, EFileType::depthMap);
+    BOOST_CHECK_EQUAL(reader.nbReads.load(), 3);
+    BOOST_CHECK_EQUAL(cache.getNbHits(), 3);
+
+    // evicted map: read again, evicts 0
+    const MapCache::MapPtr map1 = cache.get(1, EFileType::depthMap);
+    BOOST_CHECK_EQUAL((*map1)(0, 0), 1.f);
+    BOOST_CHECK_EQUAL(reader.nbReads.load(), 4);
+    BOOST_CHECK_EQUAL(cache.getNbMisses(), 4);
+    BOOST_CHECK_EQUAL(cache.getNbEvictions(), 2);
+
+    // maps held by the caller stay valid after eviction
+    BOOST_CHECK_EQUAL((*map0)(mapSide - 1, mapSide - 1), 0.f);
+    BOOST_CHECK(cache.get(0, EFileType::depthMap) != map0);
+    BOOST_CHECK_EQUAL(reader.nbReads.load(), 5);
+}
+
+BOOST_AUTO_TEST_CASE(mapCache_concurrentRequests)
+{
+    CountingReader reader;
+    MapCache cache(64, reader.function());
+
+    const int nbCams = 4;
+    const int nbRequests = 256;
+    std::atomic<int> nbInvalidMaps{0};
+
+#pragma omp parallel for
+    for (int i = 0; i < nbRequests; ++i)
+    {
+        const int camId = i % nbCams;
+        const MapCache::MapPtr map = cache.get(camId, EFileType::depthMap);
+        if (!map || (*map)(0, 0) != float(camId))
+            ++nbInvalidMaps;
+    }
+
+    BOOST_CHECK_EQUAL(nbInvalidMaps.load(), 0);
+
+    // each map is read once, even if requested by several threads at the same time
+    BOOST_CHECK_EQUAL(reader.nbReads.load(), nbCams);
+    BOOST_CHECK_EQUAL(cache.getNbMisses(), nbCams);
+    BOOST_CHECK_EQUAL(cache.getNbHits(), nbRequests - nbCams);
+}
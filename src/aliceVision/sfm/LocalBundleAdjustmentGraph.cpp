@@ -232,6 +232,59 @@ void LocalBundleAdjustmentGraph::updateGraphWithNewViews(const sfmData::SfMData&
                                                          const track::TracksPerView& map_tracksPerView,
                                                          const std::set<IndexT>& newReconstructedViews,
                                                          const std::size_t minNbOfMatches)
+{
+    ALICEVISION_LOG_DEBUG("Updating the distances graph with newly resected views...");
+
+    const std::set<IndexT> addedViewsId = addNewViewsToTheGraph(sfmData, newReconstructedViews);
+
+    // get landmarks id. of all the reconstructed 3D points (: landmarks)
+    // TODO: avoid copy and use boost::transform_iterator
+    std::set<IndexT> landmarkIds;
+    std::transform(sfmData.getLandmarks().begin(), sfmData.getLandmarks().end(), std::inserter(landmarkIds, landmarkIds.begin()), stl::RetrieveKey());
+
+    std::map<IndexT, std::vector<IndexT>> landmarksPerNewView;
+    for (IndexT viewId : addedViewsId)
+    {
+        // get all the tracks of the new added view
+        const aliceVision::track::TrackIdSet& newViewTrackIds = map_tracksPerView.at(viewId);
+
+        // keep the reconstructed tracks (with an associated landmark)
+        std::vector<IndexT>& newViewLandmarks = landmarksPerNewView[viewId];
+        newViewLandmarks.reserve(newViewTrackIds.size());
+        std::set_intersection(
+          newViewTrackIds.begin(), newViewTrackIds.end(), landmarkIds.begin(), landmarkIds.end(), std::back_inserter(newViewLandmarks));
+    }
+
+    addNewEdgesToTheGraph(sfmData, landmarksPerNewView, minNbOfMatches);
+}
+
+void LocalBundleAdjustmentGraph::updateGraphWithNewViews(const sfmData::SfMData& sfmData,
+                                                         const track::TracksStorage& tracks,
+                                                         const std::set<IndexT>& newReconstructedViews,
+                                                         const std::size_t minNbOfMatches)
+{
+    ALICEVISION_LOG_DEBUG("Updating the distances graph with newly resected views...");
+
+    const std::set<IndexT> addedViewsId = addNewViewsToTheGraph(sfmData, newReconstructedViews);
+    const sfmData::Landmarks& landmarks = sfmData.getLandmarks();
+
+    std::map<IndexT, std::vector<IndexT>> landmarksPerNewView;
+    for (IndexT viewId : addedViewsId)
+    {
+        // keep the reconstructed tracks (with an associated landmark) of the new added view
+        std::vector<IndexT>& newViewLandmarks = landmarksPerNewView[viewId];
+        for (IndexT trackIndex : tracks.getViewTrackIndexes(viewId))
+        {
+            const IndexT trackId = static_cast<IndexT>(tracks.getTrackId(trackIndex));
+            if (landmarks.find(trackId) != landmarks.end())
+                newViewLandmarks.push_back(trackId);
+        }
+    }
+
+    addNewEdgesToTheGraph(sfmData, landmarksPerNewView, minNbOfMatches);
+}
+
+std::set<IndexT> LocalBundleAdjustmentGraph::addNewViewsToTheGraph(const sfmData::SfMData& sfmData, const std::set<IndexT>& newReconstructedViews)
 {
     // identify the views we need to add to the graph:
     // - this is the first Local BA: the graph is still empty, so add all the posed views of the scene
@@ -240,8 +293,6 @@ void LocalBundleAdjustmentGraph::updateGraphWithNewViews(const sfmData::SfMData&
     // - each node represents the posed views
     // - each edge links 2 views if they share at least 'kMinNbOfMatches' matches
 
-    ALICEVISION_LOG_DEBUG("Updating the distances graph with newly resected views...");
-
     // identify the views we need to add to the graph:
     std::set<IndexT> addedViewsId;
 
@@ -282,23 +333,34 @@ void LocalBundleAdjustmentGraph::updateGraphWithNewViews(const sfmData::SfMData&
         ++nbAddedNodes;
     }
 
+    ALICEVISION_LOG_DEBUG("The distances graph has been completed with " << nbAddedNodes << " nodes.");
+    return addedViewsId;
+}
+
+void LocalBundleAdjustmentGraph::addNewEdgesToTheGraph(const sfmData::SfMData& sfmData,
+                                                       const std::map<IndexT, std::vector<IndexT>>& landmarksPerNewView,
+                                                       const std::size_t minNbOfMatches)
+{
     // add edges to the graph
     std::size_t numAddedEdges = 0;
-    if (!addedViewsId.empty())
+    if (!landmarksPerNewView.empty())
     {
         // each new view need to be connected to the graph
         // we create the 'minNbOfEdgesPerView' best edges and all the other with more than 'minNbOfMatches' shared landmarks
         const std::size_t minNbOfEdgesPerView = 10;
-        std::vector<Pair> newEdges = getNewEdges(sfmData, map_tracksPerView, addedViewsId, minNbOfMatches, minNbOfEdgesPerView);
+        std::vector<Pair> newEdges = getNewEdges(sfmData, landmarksPerNewView, minNbOfMatches, minNbOfEdgesPerView);
         numAddedEdges = newEdges.size();
 
         for (const Pair& edge : newEdges)
             _graph.addEdge(_nodePerViewId.at(edge.first), _nodePerViewId.at(edge.second));
 
+        std::set<IndexT> addedViewsId;
+        std::transform(
+          landmarksPerNewView.begin(), landmarksPerNewView.end(), std::inserter(addedViewsId, addedViewsId.begin()), stl::RetrieveKey());
         numAddedEdges += addIntrinsicEdgesToTheGraph(sfmData, addedViewsId);
     }
 
-    ALICEVISION_LOG_DEBUG("The distances graph has been completed with " << nbAddedNodes << " nodes & " << numAddedEdges << " edges.");
+    ALICEVISION_LOG_DEBUG("The distances graph has been completed with " << numAddedEdges << " edges.");
     ALICEVISION_LOG_DEBUG("It contains " << _graph.maxNodeId() + 1 << " nodes & " << _graph.maxEdgeId() + 1 << " edges");
 }
 
@@ -448,31 +510,19 @@ void LocalBundleAdjustmentGraph::convertDistancesToStates(sfmData::SfMData& sfmD
 }
 
 std::vector<Pair> LocalBundleAdjustmentGraph::getNewEdges(const sfmData::SfMData& sfmData,
-                                                          const track::TracksPerView& tracksPerView,
-                                                          const std::set<IndexT>& newViewsId,
+                                                          const std::map<IndexT, std::vector<IndexT>>& landmarksPerNewView,
                                                           const std::size_t minNbOfMatches,
                                                           const std::size_t minNbOfEdgesPerView)
 {
     std::vector<Pair> newEdges;
 
-    // get landmarks id. of all the reconstructed 3D points (: landmarks)
-    // TODO: avoid copy and use boost::transform_iterator
-    std::set<IndexT> landmarkIds;
-    std::transform(sfmData.getLandmarks().begin(), sfmData.getLandmarks().end(), std::inserter(landmarkIds, landmarkIds.begin()), stl::RetrieveKey());
-
-    for (IndexT viewId : newViewsId)
+    for (const auto& newViewLandmarksPair : landmarksPerNewView)
     {
-        std::map<IndexT, std::size_t> sharedLandmarksPerView;
-
-        // get all the tracks of the new added view
-        const aliceVision::track::TrackIdSet& newViewTrackIds = tracksPerView.at(viewId);
+        const IndexT viewId = newViewLandmarksPair.first;
+        // all landmarks (already reconstructed) visible from the new view
+        const std::vector<IndexT>& newViewLandmarks = newViewLandmarksPair.second;
 
-        // keep the reconstructed tracks (with an associated landmark)
-        std::vector<IndexT> newViewLandmarks;  // all landmarks (already reconstructed) visible from the new view
-
-        newViewLandmarks.reserve(newViewTrackIds.size());
-        std::set_intersection(
-          newViewTrackIds.begin(), newViewTrackIds.end(), landmarkIds.begin(), landmarkIds.end(), std::back_inserter(newViewLandmarks));
+        std::map<IndexT, std::size_t> sharedLandmarksPerView;
 
         // retrieve the common track Ids
         for (IndexT landmarkId : newViewLandmarks)
@@ -8,6 +8,7 @@
 
 #include <aliceVision/types.hpp>
 #include <aliceVision/track/TracksBuilder.hpp>
+#include <aliceVision/track/TracksStorage.hpp>
 #include <aliceVision/sfm/bundle/BundleAdjustment.hpp>
 
 #include <lemon/list_graph.h>
@@ -150,6 +151,18 @@ class LocalBundleAdjustmentGraph
                                  const std::set<IndexT>& newImageIndex,
                                  const std::size_t kMinNbOfMatches = 50);
 
+    /**
+     * @brief Complete the graph with the newly resected views or all the posed views if the graph is empty.
+     * @param[in] sfmData contains all the information about the reconstruction
+     * @param[in] tracks the tracks storage, its per-view index gives the tracks for each view
+     * @param[in] newReconstructedViews The list of the newly resected views
+     * @param[in] kMinNbOfMatches The min. number of shared matches to create an edge between two views (nodes)
+     */
+    void updateGraphWithNewViews(const sfmData::SfMData& sfmData,
+                                 const track::TracksStorage& tracks,
+                                 const std::set<IndexT>& newImageIndex,
+                                 const std::size_t kMinNbOfMatches = 50);
+
     /**
      * @brief Compute the intragraph-distance between all the nodes of the graph (posed views) and the newly resected views.
      * @details The graph-distances are computed using a Breadth-first Search (BFS) method.
@@ -249,16 +262,32 @@ class LocalBundleAdjustmentGraph
      */
     void checkFocalLengthsConsistency(const std::size_t windowSize, const double stdevPercentageLimit);
 
+    /**
+     * @brief Add the posed views to the graph: all the posed views of the scene if the graph is empty, the newly resected views otherwise.
+     * @param[in] sfmData contains all the information about the reconstruction
+     * @param[in] newReconstructedViews The list of the newly resected views
+     * @return The views that need to be connected to the graph
+     */
+    std::set<IndexT> addNewViewsToTheGraph(const sfmData::SfMData& sfmData, const std::set<IndexT>& newReconstructedViews);
+
+    /**
+     * @brief Connect the new views to the graph.
+     * @param[in] sfmData contains all the information about the reconstruction
+     * @param[in] landmarksPerNewView The reconstructed landmarks visible in each new view
+     * @param[in] minNbOfMatches The min. number of shared landmarks to create an edge between two views
+     */
+    void addNewEdgesToTheGraph(const sfmData::SfMData& sfmData,
+                               const std::map<IndexT, std::vector<IndexT>>& landmarksPerNewView,
+                               const std::size_t minNbOfMatches);
+
     /**
      * @brief Count the number of shared landmarks between all the new views and each already resected cameras.
      * @param[in] sfmData contains all the information about the reconstruction
-     * @param[in] map_tracksPerView A map giving the tracks for each view
-     * @param[in] newViewsId A set with the views index that we want to count matches with resected cameras.
+     * @param[in] landmarksPerNewView The reconstructed landmarks visible in each new view
      * @return A map giving the number of matches for each images pair.
      */
     static std::vector<Pair> getNewEdges(const sfmData::SfMData& sfmData,
-                                         const track::TracksPerView& map_tracksPerView,
-                                         const std::set<IndexT>& newViewsId,
+                                         const std::map<IndexT, std::vector<IndexT>>& landmarksPerNewView,
                                          const std::size_t minNbOfMatches,
                                          const std::size_t minNbOfEdgesPerView);
 
@@ -16,6 +16,7 @@
 
 #include <ceres/rotation.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <memory>
@@ -364,6 +365,28 @@ ceres::CostFunction* createConstraintsCostFunctionFromIntrinsics(const Intrinsic
     }
 }
 
+/**
+ * @brief Count the number of reconstructed views using each intrinsic
+ * @param[in] sfmData The input SfMData
+ * @return the usage count of each intrinsic referenced by a view
+ */
+std::map<IndexT, std::size_t> countIntrinsicsUsage(const sfmData::SfMData& sfmData)
+{
+    std::map<IndexT, std::size_t> intrinsicsUsage;
+
+    for (const auto& viewPair : sfmData.getViews())
+    {
+        const sfmData::View& view = *(viewPair.second);
+
+        if (intrinsicsUsage.find(view.getIntrinsicId()) == intrinsicsUsage.end())
+            intrinsicsUsage[view.getIntrinsicId()] = 0;
+
+        if (sfmData.isPoseAndIntrinsicDefined(&view))
+            ++intrinsicsUsage.at(view.getIntrinsicId());
+    }
+    return intrinsicsUsage;
+}
+
 void BundleAdjustmentCeres::CeresOptions::setDenseBA()
 {
     // default configuration use a DENSE representation
@@ -541,70 +564,92 @@ void BundleAdjustmentCeres::setSolverOptions(ceres::Solver::Options& solverOptio
     }
 }
 
-void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmData,
-                                                   BundleAdjustment::ERefineOptions refineOptions,
-                                                   ceres::Problem& problem)
+void BundleAdjustmentCeres::setCeresOptions(const CeresOptions& options)
+{
+    // the residual blocks of the persistent problem reference the loss function and the ordering
+    if (!options.persistentProblem || options.lossFunction != _ceresOptions.lossFunction ||
+        options.useParametersOrdering != _ceresOptions.useParametersOrdering)
+    {
+        resetProblem();
+    }
+    _ceresOptions = options;
+}
+
+void BundleAdjustmentCeres::addPoseToProblem(const sfmData::CameraPose& cameraPose,
+                                             bool isConstant,
+                                             ERefineOptions refineOptions,
+                                             std::array<double, 6>& poseBlock,
+                                             ceres::Problem& problem)
 {
     const bool refineTranslation = refineOptions & BundleAdjustment::REFINE_TRANSLATION;
     const bool refineRotation = refineOptions & BundleAdjustment::REFINE_ROTATION;
 
-    const auto addPose = [&](const sfmData::CameraPose& cameraPose, bool isConstant, std::array<double, 6>& poseBlock) {
-        const Mat3& R = cameraPose.getTransform().rotation();
-        const Vec3& t = cameraPose.getTransform().translation();
+    const Mat3& R = cameraPose.getTransform().rotation();
+    const Vec3& t = cameraPose.getTransform().translation();
 
-        double angleAxis[3];
-        ceres::RotationMatrixToAngleAxis(static_cast<const double*>(R.data()), angleAxis);
-        poseBlock.at(0) = angleAxis[0];
-        poseBlock.at(1) = angleAxis[1];
-        poseBlock.at(2) = angleAxis[2];
-        poseBlock.at(3) = t(0);
-        poseBlock.at(4) = t(1);
-        poseBlock.at(5) = t(2);
+    double angleAxis[3];
+    ceres::RotationMatrixToAngleAxis(static_cast<const double*>(R.data()), angleAxis);
+    poseBlock.at(0) = angleAxis[0];
+    poseBlock.at(1) = angleAxis[1];
+    poseBlock.at(2) = angleAxis[2];
+    poseBlock.at(3) = t(0);
+    poseBlock.at(4) = t(1);
+    poseBlock.at(5) = t(2);
 
-        double* poseBlockPtr = poseBlock.data();
-        problem.AddParameterBlock(poseBlockPtr, 6);
+    double* poseBlockPtr = poseBlock.data();
 
-        // add pose parameter to the all parameters blocks pointers list
-        _allParametersBlocks.push_back(poseBlockPtr);
+    // note: no-op if the block is already in a persistent problem
+    problem.AddParameterBlock(poseBlockPtr, 6);
 
-        // keep the camera extrinsics constants
-        if (cameraPose.isLocked() || isConstant || (!refineTranslation && !refineRotation))
-        {
-            // set the whole parameter block as constant.
-            _statistics.addState(EParameter::POSE, EEstimatorParameterState::CONSTANT);
-            problem.SetParameterBlockConstant(poseBlockPtr);
-            return;
-        }
+    // add pose parameter to the all parameters blocks pointers list
+    _allParametersBlocks.push_back(poseBlockPtr);
 
-        // constant parameters
-        std::vector<int> constantExtrinsic;
+    // keep the camera extrinsics constants
+    if (cameraPose.isLocked() || isConstant || (!refineTranslation && !refineRotation))
+    {
+        // set the whole parameter block as constant.
+        _statistics.addState(EParameter::POSE, EEstimatorParameterState::CONSTANT);
+        problem.SetParameterBlockConstant(poseBlockPtr);
+        return;
+    }
 
-        // don't refine rotations
-        if (!refineRotation)
-        {
-            constantExtrinsic.push_back(0);
-            constantExtrinsic.push_back(1);
-            constantExtrinsic.push_back(2);
-        }
+    // the block may have been set as constant in a previous call with a persistent problem
+    problem.SetParameterBlockVariable(poseBlockPtr);
 
-        // don't refine translations
-        if (!refineTranslation)
-        {
-            constantExtrinsic.push_back(3);
-            constantExtrinsic.push_back(4);
-            constantExtrinsic.push_back(5);
-        }
+    // constant parameters
+    std::vector<int> constantExtrinsic;
 
-        // subset parametrization
-        if (!constantExtrinsic.empty())
-        {
-            auto* subsetManifold = new ceres::SubsetManifold(6, constantExtrinsic);
-            problem.SetManifold(poseBlockPtr, subsetManifold);
-        }
+    // don't refine rotations
+    if (!refineRotation)
+    {
+        constantExtrinsic.push_back(0);
+        constantExtrinsic.push_back(1);
+        constantExtrinsic.push_back(2);
+    }
 
-        _statistics.addState(EParameter::POSE, EEstimatorParameterState::REFINED);
-    };
+    // don't refine translations
+    if (!refineTranslation)
+    {
+        constantExtrinsic.push_back(3);
+        constantExtrinsic.push_back(4);
+        constantExtrinsic.push_back(5);
+    }
 
+    // subset parametrization
+    // note: it only depends on the refine options, so it is set once per block
+    if (!constantExtrinsic.empty() && problem.GetManifold(poseBlockPtr) == nullptr)
+    {
+        auto* subsetManifold = new ceres::SubsetManifold(6, constantExtrinsic);
+        problem.SetManifold(poseBlockPtr, subsetManifold);
+    }
+
+    _statistics.addState(EParameter::POSE, EEstimatorParameterState::REFINED);
+}
+
+void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmData,
+                                                   BundleAdjustment::ERefineOptions refineOptions,
+                                                   ceres::Problem& problem)
+{
     // setup poses data
     for (const auto& posePair : sfmData.getPoses())
     {
@@ -620,7 +665,7 @@ void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmDa
 
         const bool isConstant = (pose.getState() == EEstimatorParameterState::CONSTANT);
 
-        addPose(pose, isConstant, _posesBlocks[poseId]);
+        addPoseToProblem(pose, isConstant, refineOptions, _posesBlocks[poseId], problem);
     }
 
     // setup sub-poses data
@@ -639,7 +684,7 @@ void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmDa
 
             const bool isConstant = (rigSubPose.status == sfmData::ERigSubPoseStatus::CONSTANT);
 
-            addPose(sfmData::CameraPose(rigSubPose.pose), isConstant, _rigBlocks[rigId][subPoseId]);
+            addPoseToProblem(sfmData::CameraPose(rigSubPose.pose), isConstant, refineOptions, _rigBlocks[rigId][subPoseId], problem);
         }
     }
 }
@@ -654,19 +699,8 @@ void BundleAdjustmentCeres::addIntrinsicsToProblem(const sfmData::SfMData& sfmDa
     const bool refineIntrinsicsDistortion = refineOptions & REFINE_INTRINSICS_DISTORTION;
     const bool refineIntrinsics = refineIntrinsicsDistortion || refineIntrinsicsFocalLength || refineIntrinsicsOpticalCenter;
 
-    std::map<IndexT, std::size_t> intrinsicsUsage;
-
     // count the number of reconstructed views per intrinsic
-    for (const auto& viewPair : sfmData.getViews())
-    {
-        const sfmData::View& view = *(viewPair.second);
-
-        if (intrinsicsUsage.find(view.getIntrinsicId()) == intrinsicsUsage.end())
-            intrinsicsUsage[view.getIntrinsicId()] = 0;
-
-        if (sfmData.isPoseAndIntrinsicDefined(&view))
-            ++intrinsicsUsage.at(view.getIntrinsicId());
-    }
+    const std::map<IndexT, std::size_t> intrinsicsUsage = countIntrinsicsUsage(sfmData);
 
     for (const auto& intrinsicPair : sfmData.getIntrinsics())
     {
@@ -688,10 +722,17 @@ void BundleAdjustmentCeres::addIntrinsicsToProblem(const sfmData::SfMData& sfmDa
         assert(isValid(intrinsicPtr->getType()));
 
         std::vector<double>& intrinsicBlock = _intrinsicsBlocks[intrinsicId];
-        intrinsicBlock = intrinsicPtr->getParams();
+        const std::vector<double> intrinsicParams = intrinsicPtr->getParams();
+
+        // update the block in place to keep its address in a persistent problem
+        if (intrinsicBlock.size() == intrinsicParams.size())
+            std::copy(intrinsicParams.begin(), intrinsicParams.end(), intrinsicBlock.begin());
+        else
+            intrinsicBlock = intrinsicParams;
 
         double* intrinsicBlockPtr = intrinsicBlock.data();
 
+        // note: no-op if the block is already in a persistent problem
         problem.AddParameterBlock(intrinsicBlockPtr, intrinsicBlock.size());
 
         // add intrinsic parameter to the all parameters blocks pointers list
@@ -706,6 +747,9 @@ void BundleAdjustmentCeres::addIntrinsicsToProblem(const sfmData::SfMData& sfmDa
             continue;
         }
 
+        // the block may have been set as constant in a previous call with a persistent problem
+        problem.SetParameterBlockVariable(intrinsicBlockPtr);
+
         // constant parameters
         bool lockCenter = false;
         bool lockFocal = false;
@@ -791,14 +835,68 @@ void BundleAdjustmentCeres::addIntrinsicsToProblem(const sfmData::SfMData& sfmDa
     }
 }
 
-void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem)
+ceres::ResidualBlockId BundleAdjustmentCeres::addObservationToProblem(const sfmData::SfMData& sfmData,
+                                                                      const sfmData::View& view,
+                                                                      const sfmData::Observation& observation,
+                                                                      double* landmarkBlockPtr,
+                                                                      ceres::Problem& problem)
 {
-    const bool refineStructure = refineOptions & REFINE_STRUCTURE;
-
     // set a LossFunction to be less penalized by false measurements.
     // note: set it to NULL if you don't want use a lossFunction.
     ceres::LossFunction* lossFunction = _ceresOptions.lossFunction.get();
 
+    // each residual block takes a point and a camera as input and outputs a 2
+    // dimensional residual. Internally, the cost function stores the observed
+    // image location and compares the reprojection against the observation.
+    const auto& pose = sfmData.getPose(view);
+    const auto& intrinsic = sfmData.getIntrinsicSharedPtr(view);
+
+    assert(pose.getState() != EEstimatorParameterState::IGNORED);
+    assert(intrinsic->getState() != EEstimatorParameterState::IGNORED);
+
+    // needed parameters to create a residual block (K, pose)
+    double* poseBlockPtr = _posesBlocks.at(view.getPoseId()).data();
+    double* intrinsicBlockPtr = _intrinsicsBlocks.at(view.getIntrinsicId()).data();
+
+    // apply a specific parameter ordering:
+    if (_ceresOptions.useParametersOrdering)
+    {
+        _linearSolverOrdering.AddElementToGroup(landmarkBlockPtr, 0);
+        _linearSolverOrdering.AddElementToGroup(poseBlockPtr, 1);
+        _linearSolverOrdering.AddElementToGroup(intrinsicBlockPtr, 2);
+    }
+
+    if (view.isPartOfRig() && !view.isPoseIndependant())
+    {
+        ceres::CostFunction* costFunction = createRigCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
+
+        double* rigBlockPtr = _rigBlocks.at(view.getRigId()).at(view.getSubPoseId()).data();
+        _linearSolverOrdering.AddElementToGroup(rigBlockPtr, 1);
+
+        return problem.AddResidualBlock(costFunction,
+                                        lossFunction,
+                                        intrinsicBlockPtr,
+                                        poseBlockPtr,
+                                        rigBlockPtr,        // subpose of the cameras rig
+                                        landmarkBlockPtr);  // do we need to copy 3D point to avoid false motion, if failure ?
+    }
+
+    ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
+
+    return problem.AddResidualBlock(costFunction,
+                                    lossFunction,
+                                    intrinsicBlockPtr,
+                                    poseBlockPtr,
+                                    landmarkBlockPtr);  // do we need to copy 3D point to avoid false motion, if failure ?
+}
+
+void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem)
+{
+    const bool refineStructure = refineOptions & REFINE_STRUCTURE;
+
+    // the residual blocks of a persistent problem are kept to be updated by the next calls
+    const bool isPersistentProblem = (&problem == _persistentProblem.get());
+
     // build the residual blocks corresponding to the track observations
     for (const auto& landmarkPair : sfmData.getLandmarks())
     {
@@ -819,72 +917,53 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
 
         double* landmarkBlockPtr = landmarkBlock.data();
 
+        // note: no-op if the block is already in a persistent problem
+        problem.AddParameterBlock(landmarkBlockPtr, 3);
+
         // add landmark parameter to the all parameters blocks pointers list
         _allParametersBlocks.push_back(landmarkBlockPtr);
 
+        const bool isConstant = (!refineStructure || landmark.state == EEstimatorParameterState::CONSTANT);
+
+        // residual blocks already in the persistent problem, sorted by view id
+        std::vector<ObservationResidual>* residuals = isPersistentProblem ? &_landmarksResiduals[landmarkId] : nullptr;
+        const std::size_t nbPreviousResiduals = isPersistentProblem ? residuals->size() : 0;
+        std::size_t previousResidualIndex = 0;
+
         // iterate over 2D observation associated to the 3D landmark
         for (const auto& observationPair : landmark.getObservations())
         {
-            const sfmData::View& view = sfmData.getView(observationPair.first);
+            const IndexT viewId = observationPair.first;
             const sfmData::Observation& observation = observationPair.second;
 
-            // each residual block takes a point and a camera as input and outputs a 2
-            // dimensional residual. Internally, the cost function stores the observed
-            // image location and compares the reprojection against the observation.
-            const auto& pose = sfmData.getPose(view);
-            const auto& intrinsic = sfmData.getIntrinsicSharedPtr(view);
-
-            assert(pose.getState() != EEstimatorParameterState::IGNORED);
-            assert(intrinsic->getState() != EEstimatorParameterState::IGNORED);
-
-            // needed parameters to create a residual block (K, pose)
-            double* poseBlockPtr = _posesBlocks.at(view.getPoseId()).data();
-            double* intrinsicBlockPtr = _intrinsicsBlocks.at(view.getIntrinsicId()).data();
-
-            // apply a specific parameter ordering:
-            if (_ceresOptions.useParametersOrdering)
-            {
-                _linearSolverOrdering.AddElementToGroup(landmarkBlockPtr, 0);
-                _linearSolverOrdering.AddElementToGroup(poseBlockPtr, 1);
-                _linearSolverOrdering.AddElementToGroup(intrinsicBlockPtr, 2);
-            }
-
-            if (view.isPartOfRig() && !view.isPoseIndependant())
-            {
-                ceres::CostFunction* costFunction = createRigCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
+            // set the whole landmark parameter block as constant or refined
+            _statistics.addState(EParameter::LANDMARK, isConstant ? EEstimatorParameterState::CONSTANT : EEstimatorParameterState::REFINED);
 
-                double* rigBlockPtr = _rigBlocks.at(view.getRigId()).at(view.getSubPoseId()).data();
-                _linearSolverOrdering.AddElementToGroup(rigBlockPtr, 1);
+            // keep the residual block if the observation is already in the persistent problem
+            while (previousResidualIndex < nbPreviousResiduals && (*residuals)[previousResidualIndex].viewId < viewId)
+                ++previousResidualIndex;
+            if (previousResidualIndex < nbPreviousResiduals && (*residuals)[previousResidualIndex].viewId == viewId)
+                continue;
 
-                problem.AddResidualBlock(costFunction,
-                                         lossFunction,
-                                         intrinsicBlockPtr,
-                                         poseBlockPtr,
-                                         rigBlockPtr,        // subpose of the cameras rig
-                                         landmarkBlockPtr);  // do we need to copy 3D point to avoid false motion, if failure ?
-            }
-            else
-            {
-                ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
+            const ceres::ResidualBlockId residualBlockId =
+              addObservationToProblem(sfmData, sfmData.getView(viewId), observation, landmarkBlockPtr, problem);
 
-                problem.AddResidualBlock(costFunction,
-                                         lossFunction,
-                                         intrinsicBlockPtr,
-                                         poseBlockPtr,
-                                         landmarkBlockPtr);  // do we need to copy 3D point to avoid false motion, if failure ?
-            }
+            if (isPersistentProblem)
+                residuals->push_back({viewId, observation, residualBlockId});
+        }
 
-            if (!refineStructure || landmark.state == EEstimatorParameterState::CONSTANT)
-            {
-                // set the whole landmark parameter block as constant.
-                _statistics.addState(EParameter::LANDMARK, EEstimatorParameterState::CONSTANT);
-                problem.SetParameterBlockConstant(landmarkBlockPtr);
-            }
-            else
-            {
-                _statistics.addState(EParameter::LANDMARK, EEstimatorParameterState::REFINED);
-            }
+        if (isPersistentProblem)
+        {
+            std::inplace_merge(residuals->begin(),
+                               residuals->begin() + nbPreviousResiduals,
+                               residuals->end(),
+                               [](const ObservationResidual& a, const ObservationResidual& b) { return a.viewId < b.viewId; });
         }
+
+        if (isConstant)
+            problem.SetParameterBlockConstant(landmarkBlockPtr);
+        else
+            problem.SetParameterBlockVariable(landmarkBlockPtr);
     }
 }
 
@@ -921,7 +1000,12 @@ void BundleAdjustmentCeres::addConstraints2DToProblem(const sfmData::SfMData& sf
         ceres::CostFunction* costFunction = createConstraintsCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view_1.getIntrinsicId()),
                                                                                         constraint.ObservationFirst.getCoordinates(),
                                                                                         constraint.ObservationSecond.getCoordinates());
-        problem.AddResidualBlock(costFunction, lossFunction, intrinsicBlockPtr_1, poseBlockPtr_1, poseBlockPtr_2);
+        const ceres::ResidualBlockId residualBlockId =
+          problem.AddResidualBlock(costFunction, lossFunction, intrinsicBlockPtr_1, poseBlockPtr_1, poseBlockPtr_2);
+
+        // keep the residual block to remove it on the next update of a persistent problem
+        if (&problem == _persistentProblem.get())
+            _constraintsResiduals.push_back(residualBlockId);
     }
 }
 
@@ -947,7 +1031,11 @@ void BundleAdjustmentCeres::addRotationPriorsToProblem(const sfmData::SfMData& s
 
         ceres::CostFunction* costFunction =
           new ceres::AutoDiffCostFunction<ResidualErrorRotationPriorFunctor, 3, 6, 6>(new ResidualErrorRotationPriorFunctor(prior._second_R_first));
-        problem.AddResidualBlock(costFunction, lossFunction, poseBlockPtr_1, poseBlockPtr_2);
+        const ceres::ResidualBlockId residualBlockId = problem.AddResidualBlock(costFunction, lossFunction, poseBlockPtr_1, poseBlockPtr_2);
+
+        // keep the residual block to remove it on the next update of a persistent problem
+        if (&problem == _persistentProblem.get())
+            _constraintsResiduals.push_back(residualBlockId);
     }
 }
 
@@ -976,8 +1064,155 @@ void BundleAdjustmentCeres::createProblem(const sfmData::SfMData& sfmData, ERefi
     addRotationPriorsToProblem(sfmData, refineOptions, problem);
 }
 
+void BundleAdjustmentCeres::updatePersistentProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions)
+{
+    // the parametrization of the blocks depends on the refine options
+    if (!_persistentProblem || refineOptions != _persistentRefineOptions)
+    {
+        // clear previously computed data
+        resetProblem();
+
+        // ensure we are not using incompatible options
+        assert(!((refineOptions & REFINE_INTRINSICS_OPTICALOFFSET_ALWAYS) && (refineOptions & REFINE_INTRINSICS_OPTICALOFFSET_IF_ENOUGH_DATA)));
+
+        ceres::Problem::Options problemOptions;
+        problemOptions.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+        // residual blocks are removed one by one when the scene changes
+        problemOptions.enable_fast_removal = true;
+        _persistentProblem.reset(new ceres::Problem(problemOptions));
+        _persistentRefineOptions = refineOptions;
+    }
+
+    ceres::Problem& problem = *_persistentProblem;
+
+    // 2D constraints and rotation priors are few, they are rebuilt on each update
+    for (ceres::ResidualBlockId residualBlockId : _constraintsResiduals)
+        problem.RemoveResidualBlock(residualBlockId);
+    _constraintsResiduals.clear();
+
+    // parameters kept in the problem after the update (same rules as createProblem)
+    const std::map<IndexT, std::size_t> intrinsicsUsage = countIntrinsicsUsage(sfmData);
+
+    const auto isPoseInProblem = [&](IndexT poseId) {
+        const auto poseIt = sfmData.getPoses().find(poseId);
+        return poseIt != sfmData.getPoses().end() && poseIt->second.getState() != EEstimatorParameterState::IGNORED;
+    };
+
+    const auto isSubPoseInProblem = [&](IndexT rigId, IndexT subPoseId) {
+        const auto rigIt = sfmData.getRigs().find(rigId);
+        return rigIt != sfmData.getRigs().end() && subPoseId < rigIt->second.getNbSubPoses() &&
+               rigIt->second.getSubPose(subPoseId).status != sfmData::ERigSubPoseStatus::UNINITIALIZED;
+    };
+
+    const auto isIntrinsicInProblem = [&](IndexT intrinsicId) {
+        const auto usageIt = intrinsicsUsage.find(intrinsicId);
+        const auto intrinsicIt = sfmData.getIntrinsics().find(intrinsicId);
+        return usageIt != intrinsicsUsage.end() && usageIt->second > 0 && intrinsicIt != sfmData.getIntrinsics().end() &&
+               intrinsicIt->second->getState() != EEstimatorParameterState::IGNORED;
+    };
+
+    const auto isViewInProblem = [&](IndexT viewId) {
+        const auto viewIt = sfmData.getViews().find(viewId);
+        if (viewIt == sfmData.getViews().end())
+            return false;
+        const sfmData::View& view = *(viewIt->second);
+        if (!isPoseInProblem(view.getPoseId()) || !isIntrinsicInProblem(view.getIntrinsicId()))
+            return false;
+        return !view.isPartOfRig() || view.isPoseIndependant() || isSubPoseInProblem(view.getRigId(), view.getSubPoseId());
+    };
+
+    // remove the landmarks and the observations that are not in the scene anymore
+    for (auto landmarkIt = _landmarksResiduals.begin(); landmarkIt != _landmarksResiduals.end();)
+    {
+        const IndexT landmarkId = landmarkIt->first;
+        const auto sfmLandmarkIt = sfmData.getLandmarks().find(landmarkId);
+
+        if (sfmLandmarkIt == sfmData.getLandmarks().end() || sfmLandmarkIt->second.state == EEstimatorParameterState::IGNORED)
+        {
+            // removing the parameter block also removes its residual blocks
+            removeParameterBlock(_landmarksBlocks.at(landmarkId).data());
+            _landmarksBlocks.erase(landmarkId);
+            landmarkIt = _landmarksResiduals.erase(landmarkIt);
+            continue;
+        }
+
+        const sfmData::Observations& observations = sfmLandmarkIt->second.getObservations();
+        std::vector<ObservationResidual>& residuals = landmarkIt->second;
+
+        const auto isResidualRemoved = [&](const ObservationResidual& residual) {
+            const auto observationIt = observations.find(residual.viewId);
+            if (observationIt != observations.end() && observationIt->second == residual.observation && isViewInProblem(residual.viewId))
+                return false;
+            problem.RemoveResidualBlock(residual.residualBlockId);
+            return true;
+        };
+        residuals.erase(std::remove_if(residuals.begin(), residuals.end(), isResidualRemoved), residuals.end());
+        ++landmarkIt;
+    }
+
+    // remove the poses, sub-poses and intrinsics that are not in the scene anymore
+    // note: they are not used by any residual block at this point
+    for (auto poseIt = _posesBlocks.begin(); poseIt != _posesBlocks.end();)
+    {
+        if (isPoseInProblem(poseIt->first))
+        {
+            ++poseIt;
+            continue;
+        }
+        removeParameterBlock(poseIt->second.data());
+        poseIt = _posesBlocks.erase(poseIt);
+    }
+
+    for (auto& rigBlocksPair : _rigBlocks)
+    {
+        auto& subPosesBlocks = rigBlocksPair.second;
+        for (auto subPoseIt = subPosesBlocks.begin(); subPoseIt != subPosesBlocks.end();)
+        {
+            if (isSubPoseInProblem(rigBlocksPair.first, subPoseIt->first))
+            {
+                ++subPoseIt;
+                continue;
+            }
+            removeParameterBlock(subPoseIt->second.data());
+            subPoseIt = subPosesBlocks.erase(subPoseIt);
+        }
+    }
+
+    for (auto intrinsicIt = _intrinsicsBlocks.begin(); intrinsicIt != _intrinsicsBlocks.end();)
+    {
+        if (isIntrinsicInProblem(intrinsicIt->first))
+        {
+            ++intrinsicIt;
+            continue;
+        }
+        removeParameterBlock(intrinsicIt->second.data());
+        intrinsicIt = _intrinsicsBlocks.erase(intrinsicIt);
+    }
+
+    // update the values and the states of all the parameters, and add the new blocks
+    _statistics = Statistics();
+    _allParametersBlocks.clear();
+
+    addExtrinsicsToProblem(sfmData, refineOptions, problem);
+    addIntrinsicsToProblem(sfmData, refineOptions, problem);
+    addLandmarksToProblem(sfmData, refineOptions, problem);
+    addConstraints2DToProblem(sfmData, refineOptions, problem);
+    addRotationPriorsToProblem(sfmData, refineOptions, problem);
+}
+
+void BundleAdjustmentCeres::removeParameterBlock(double* parameterBlockPtr)
+{
+    _persistentProblem->RemoveParameterBlock(parameterBlockPtr);
+    _linearSolverOrdering.Remove(parameterBlockPtr);
+}
+
 void BundleAdjustmentCeres::resetProblem()
 {
+    // the persistent problem references the blocks below
+    _persistentProblem.reset();
+    _landmarksResiduals.clear();
+    _constraintsResiduals.clear();
+
     _statistics = Statistics();
 
     _allParametersBlocks.clear();
@@ -1093,7 +1328,7 @@ void BundleAdjustmentCeres::createJacobian(const sfmData::SfMData& sfmData, ERef
     double cost = 0.0;
     ceres::Problem::EvaluateOptions evalOpt;
     evalOpt.parameter_blocks = _allParametersBlocks;
-    evalOpt.num_threads = 8;
+    evalOpt.num_threads = _ceresOptions.nbThreads;
     evalOpt.apply_loss_function = true;
 
     // create Jacobain
@@ -1105,8 +1340,21 @@ bool BundleAdjustmentCeres::adjust(sfmData::SfMData& sfmData, ERefineOptions ref
     // create problem
     ceres::Problem::Options problemOptions;
     problemOptions.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
-    ceres::Problem problem(problemOptions);
-    createProblem(sfmData, refineOptions, problem);
+    ceres::Problem localProblem(problemOptions);
+    ceres::Problem* problemPtr = &localProblem;
+
+    if (_ceresOptions.persistentProblem)
+    {
+        // only update the blocks that changed since the previous call
+        updatePersistentProblem(sfmData, refineOptions);
+        problemPtr = _persistentProblem.get();
+    }
+    else
+    {
+        createProblem(sfmData, refineOptions, localProblem);
+    }
+
+    ceres::Problem& problem = *problemPtr;
 
     // configure a Bundle Adjustment engine and run it
     // make Ceres automatically detect the bundle structure.
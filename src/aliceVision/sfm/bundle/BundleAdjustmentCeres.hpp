@@ -12,15 +12,21 @@
 #include <aliceVision/sfm/bundle/BundleAdjustment.hpp>
 #include <aliceVision/sfm/LocalBundleAdjustmentGraph.hpp>
 #include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/sfmData/Observation.hpp>
 
 #include <ceres/ceres.h>
 
+#include <array>
+#include <map>
 #include <memory>
+#include <vector>
 
 namespace aliceVision {
 
 namespace sfmData {
 class SfMData;
+class CameraPose;
+class View;
 }  // namespace sfmData
 
 namespace sfm {
@@ -53,6 +59,8 @@ class BundleAdjustmentCeres : public BundleAdjustment
         unsigned int nbThreads;
         unsigned int maxNumIterations;
         bool useParametersOrdering = true;
+        /// keep the Ceres problem between the calls to adjust and only update the blocks that changed
+        bool persistentProblem = false;
         bool summary = false;
         bool verbose = true;
     };
@@ -134,6 +142,19 @@ class BundleAdjustmentCeres : public BundleAdjustment
      */
     bool adjust(sfmData::SfMData& sfmData, ERefineOptions refineOptions = REFINE_ALL);
 
+    /**
+     * @brief Get the Ceres options
+     * @return the Ceres options
+     */
+    inline const CeresOptions& getCeresOptions() const { return _ceresOptions; }
+
+    /**
+     * @brief Set the Ceres options used by the next calls to adjust.
+     * The persistent problem is kept if it uses the same loss function.
+     * @param[in] options The user Ceres options
+     */
+    void setCeresOptions(const CeresOptions& options);
+
     /**
      * @brief Get bundle adjustment statistics structure
      * @return statistics structure const ptr
@@ -152,6 +173,35 @@ class BundleAdjustmentCeres : public BundleAdjustment
      */
     void setSolverOptions(ceres::Solver::Options& solverOptions) const;
 
+    /**
+     * @brief Set the values and the parametrization of a pose block and add it to the problem
+     * @param[in] cameraPose The camera pose
+     * @param[in] isConstant Whether the pose is constant in the Local strategy
+     * @param[in] refineOptions The chosen refine flag
+     * @param[in,out] poseBlock The pose block, updated in place if it is already in the problem
+     * @param[out] problem The Ceres bundle adjustement problem
+     */
+    void addPoseToProblem(const sfmData::CameraPose& cameraPose,
+                          bool isConstant,
+                          ERefineOptions refineOptions,
+                          std::array<double, 6>& poseBlock,
+                          ceres::Problem& problem);
+
+    /**
+     * @brief Create the residual block of a landmark observation
+     * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+     * @param[in] view The view of the observation
+     * @param[in] observation The landmark observation
+     * @param[in] landmarkBlockPtr The landmark parameter block
+     * @param[out] problem The Ceres bundle adjustement problem
+     * @return the residual block id
+     */
+    ceres::ResidualBlockId addObservationToProblem(const sfmData::SfMData& sfmData,
+                                                   const sfmData::View& view,
+                                                   const sfmData::Observation& observation,
+                                                   double* landmarkBlockPtr,
+                                                   ceres::Problem& problem);
+
     /**
      * @brief Create a parameter block for each extrinsics according to the Ceres format: [Rx, Ry, Rz, tx, ty, tz]
      * @param[in] sfmData The input SfMData contains all the information about the reconstruction, notably the poses and sub-poses
@@ -202,6 +252,23 @@ class BundleAdjustmentCeres : public BundleAdjustment
      */
     void createProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem);
 
+    /**
+     * @brief Update the persistent Ceres problem to match the SfMData:
+     *  - remove the blocks of the parameters and observations that are not in the scene anymore (or ignored),
+     *  - add the blocks of the new parameters and observations,
+     *  - update the values and the states (refined or constant) of all the parameters.
+     * The problem is created on the first call and rebuilt if the refine options change.
+     * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+     * @param[in] refineOptions The chosen refine flag
+     */
+    void updatePersistentProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions);
+
+    /**
+     * @brief Remove a parameter block (and its residual blocks) from the persistent problem
+     * @param[in] parameterBlockPtr The parameter block
+     */
+    void removeParameterBlock(double* parameterBlockPtr);
+
     /**
      * @brief Update The given SfMData with the solver solution
      * @param[in,out] sfmData The input SfMData contains all the information about the reconstruction, notably the poses and sub-poses
@@ -241,6 +308,25 @@ class BundleAdjustmentCeres : public BundleAdjustment
     /// hinted order for ceres to eliminate blocks when solving.
     /// note: this ceres parameter is built internally and must be reset on each call to the solver.
     ceres::ParameterBlockOrdering _linearSolverOrdering;
+
+    // persistent problem data
+
+    /// residual block of a landmark observation
+    struct ObservationResidual
+    {
+        IndexT viewId;
+        sfmData::Observation observation;
+        ceres::ResidualBlockId residualBlockId;
+    };
+
+    /// Ceres problem kept between the calls to adjust (if CeresOptions::persistentProblem)
+    std::unique_ptr<ceres::Problem> _persistentProblem;
+    /// refine options of the persistent problem
+    ERefineOptions _persistentRefineOptions = REFINE_NONE;
+    /// residual blocks of the observations of each landmark in the persistent problem, sorted by view id
+    std::map<IndexT, std::vector<ObservationResidual>> _landmarksResiduals;
+    /// residual blocks of the 2D constraints and rotation priors
+    std::vector<ceres::ResidualBlockId> _constraintsResiduals;
 };
 
 }  // namespace sfm
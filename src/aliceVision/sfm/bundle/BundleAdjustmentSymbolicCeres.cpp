@@ -768,7 +768,7 @@ void BundleAdjustmentSymbolicCeres::createJacobian(const sfmData::SfMData& sfmDa
     double cost = 0.0;
     ceres::Problem::EvaluateOptions evalOpt;
     evalOpt.parameter_blocks = _allParametersBlocks;
-    evalOpt.num_threads = 8;
+    evalOpt.num_threads = _ceresOptions.nbThreads;
     evalOpt.apply_loss_function = true;
 
     // create Jacobain
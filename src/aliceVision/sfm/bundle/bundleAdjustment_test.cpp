@@ -241,6 +241,76 @@ BOOST_AUTO_TEST_CASE(LOCAL_BUNDLE_ADJUSTMENT_EffectiveMinimization_Pinhole_Camer
     BOOST_CHECK_LT(dResidual_after, dResidual_before);
 }
 
+BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_PersistentProblem_SequentialUpdates)
+{
+    const int nviews = 4;
+    const int npoints = 12;
+    const NViewDatasetConfigurator config;
+    const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+    // Translate the input dataset to a SfMData scene
+    SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA, EDISTORTION::DISTORTION_NONE);
+    const SfMData sfmData_full = sfmData;
+
+    BundleAdjustmentCeres::CeresOptions options;
+    options.setDenseBA();
+    options.persistentProblem = true;
+    BundleAdjustmentCeres persistentBA(options);
+
+    // the solution of the persistent problem must be the same as with a new problem
+    const auto checkSameAsNewProblem = [&](const SfMData& sfmDataBefore) {
+        SfMData sfmDataNew = sfmDataBefore;
+        BundleAdjustmentCeres::CeresOptions newOptions;
+        newOptions.setDenseBA();
+        BundleAdjustmentCeres newBA(newOptions);
+        BOOST_CHECK(newBA.adjust(sfmDataNew));
+
+        BOOST_CHECK_EQUAL(persistentBA.getStatistics().nbResidualBlocks, newBA.getStatistics().nbResidualBlocks);
+        BOOST_CHECK_CLOSE(RMSE(sfmData), RMSE(sfmDataNew), 0.1);
+    };
+
+    // 1. first 3 views only
+    sfmData.getPoses().erase(3);
+    for (auto& landmarkPair : sfmData.getLandmarks())
+        landmarkPair.second.getObservations().erase(3);
+    {
+        const SfMData sfmDataBefore = sfmData;
+        BOOST_CHECK(persistentBA.adjust(sfmData));
+        BOOST_CHECK_LT(RMSE(sfmData), RMSE(sfmDataBefore));
+        checkSameAsNewProblem(sfmDataBefore);
+    }
+
+    // 2. add the last view and its observations
+    sfmData.getPoses()[3] = sfmData_full.getPoses().at(3);
+    for (auto& landmarkPair : sfmData.getLandmarks())
+        landmarkPair.second.getObservations()[3] = sfmData_full.getLandmarks().at(landmarkPair.first).getObservations().at(3);
+    {
+        const SfMData sfmDataBefore = sfmData;
+        BOOST_CHECK(persistentBA.adjust(sfmData));
+        checkSameAsNewProblem(sfmDataBefore);
+    }
+
+    // 3. remove a landmark and some observations (as done by the outliers rejection), lock the first pose
+    sfmData.getLandmarks().erase(0);
+    sfmData.getLandmarks().at(1).getObservations().erase(2);
+    sfmData.getLandmarks().at(2).getObservations().erase(0);
+    sfmData.getPoses().at(0).lock();
+    {
+        const SfMData sfmDataBefore = sfmData;
+        BOOST_CHECK(persistentBA.adjust(sfmData));
+        checkSameAsNewProblem(sfmDataBefore);
+        BOOST_CHECK(sfmData.getPoses().at(0).getTransform() == sfmDataBefore.getPoses().at(0).getTransform());
+    }
+
+    // 4. change the refine options: the problem is rebuilt
+    {
+        const SfMData sfmDataBefore = sfmData;
+        BOOST_CHECK(persistentBA.adjust(sfmData, BundleAdjustment::REFINE_STRUCTURE));
+        for (const auto& posePair : sfmData.getPoses())
+            BOOST_CHECK(posePair.second.getTransform() == sfmDataBefore.getPoses().at(posePair.first).getTransform());
+    }
+}
+
 /// Compute the Root Mean Square Error of the residuals
 double RMSE(const SfMData& sfm_data)
 {
@@ -5,7 +5,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "RigSequence.hpp"
-#include <aliceVision/stl/mapUtils.hpp>
+#include <aliceVision/system/Logger.hpp>
 
 #include <boost/functional/hash.hpp>
 
@@ -24,27 +24,18 @@ IndexT getRigPoseId(IndexT rigId, IndexT frameId)
     return static_cast<IndexT>(rigPoseId);
 }
 
-double computeCameraScore(const SfMData& sfmData, const track::TracksPerView& tracksPerView, IndexT viewId)
+double computeCameraScore(const SfMData& sfmData, const track::TracksStorage& tracks, IndexT viewId)
 {
-    std::set<std::size_t> viewLandmarks;
+    std::vector<IndexT> viewLandmarks;
     {
         // A. Compute 2D/3D matches
-        // A1. list tracks ids used by the view
-        const aliceVision::track::TrackIdSet& tracksIds = tracksPerView.at(static_cast<std::size_t>(viewId));
-
-        // A2. intersects the track list with the reconstructed
-        std::set<std::size_t> reconstructedTrackId;
-        std::transform(sfmData.getLandmarks().begin(),
-                       sfmData.getLandmarks().end(),
-                       std::inserter(reconstructedTrackId, reconstructedTrackId.begin()),
-                       stl::RetrieveKey());
-
-        // Get the ids of the already reconstructed tracks
-        std::set_intersection(tracksIds.begin(),
-                              tracksIds.end(),
-                              reconstructedTrackId.begin(),
-                              reconstructedTrackId.end(),
-                              std::inserter(viewLandmarks, viewLandmarks.begin()));
+        // keep the tracks used by the view that are already reconstructed
+        for (IndexT trackIndex : tracks.getViewTrackIndexes(viewId))
+        {
+            const IndexT trackId = static_cast<IndexT>(tracks.getTrackId(trackIndex));
+            if (sfmData.getLandmarks().find(trackId) != sfmData.getLandmarks().end())
+                viewLandmarks.push_back(trackId);
+        }
 
         if (viewLandmarks.empty())
         {
@@ -62,7 +53,7 @@ double computeCameraScore(const SfMData& sfmData, const track::TracksPerView& tr
 
     for (auto landmarkId : viewLandmarks)
     {
-        const Landmark& landmark = sfmData.getLandmarks().at(static_cast<IndexT>(landmarkId));
+        const Landmark& landmark = sfmData.getLandmarks().at(landmarkId);
 
         sfmData::Observations::const_iterator itObs = landmark.getObservations().find(viewId);
 
@@ -75,7 +66,7 @@ double computeCameraScore(const SfMData& sfmData, const track::TracksPerView& tr
     return score;
 }
 
-void RigSequence::init(const track::TracksPerView& tracksPerView)
+void RigSequence::init(const track::TracksStorage& tracks)
 {
     for (const auto& viewPair : _sfmData.getViews())
     {
@@ -88,7 +79,7 @@ void RigSequence::init(const track::TracksPerView& tracksPerView)
             // compute pose score, sum of inverse reprojection errors
             if (_sfmData.isPoseAndIntrinsicDefined(view.getViewId()))
             {
-                score = computeCameraScore(_sfmData, tracksPerView, view.getViewId());
+                score = computeCameraScore(_sfmData, tracks, view.getViewId());
 
                 // add one to the number of poses for this rig relative sub-pose
                 _rigInfoPerSubPose[view.getSubPoseId()].nbPose++;
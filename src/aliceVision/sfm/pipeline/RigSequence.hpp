@@ -7,7 +7,7 @@
 #pragma once
 
 #include <aliceVision/sfmData/SfMData.hpp>
-#include <aliceVision/track/TracksBuilder.hpp>
+#include <aliceVision/track/TracksStorage.hpp>
 
 namespace aliceVision {
 namespace sfm {
@@ -31,8 +31,9 @@ class RigSequence
     /**
      * @brief RigSequence initialization
      * build internal structures
+     * @param[in] tracks the tracks storage, used to score the posed views of the rig
      */
-    void init(const track::TracksPerView& tracksPerView);
+    void init(const track::TracksStorage& tracks);
 
     /**
      * @brief Calibrate new possible rigs or update independent poses to rig poses
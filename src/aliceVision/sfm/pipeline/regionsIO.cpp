@@ -7,6 +7,8 @@
 
 #include "regionsIO.hpp"
 
+#include <aliceVision/feature/RegionsArchive.hpp>
+#include <aliceVision/system/IOScheduler.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
 #include <aliceVision/utils/filesIO.hpp>
 
@@ -15,6 +17,10 @@
 #include <atomic>
 #include <cassert>
 #include <filesystem>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace fs = std::filesystem;
 
@@ -23,23 +29,73 @@ namespace sfm {
 
 using namespace sfmData;
 
+namespace {
+
+/**
+ * @brief Get the regions archive of a features folder, if any.
+ * Archives are opened once and kept mapped for the lifetime of the process.
+ * @param[in] folder The features folder
+ * @return the regions archive or nullptr if the folder does not contain a valid archive
+ */
+std::shared_ptr<const feature::RegionsArchive> getRegionsArchive(const std::string& folder)
+{
+    static std::mutex archivesMutex;
+    static std::map<std::string, std::shared_ptr<const feature::RegionsArchive>> archives;
+
+    std::lock_guard<std::mutex> lock(archivesMutex);
+
+    const auto it = archives.find(folder);
+    if (it != archives.end())
+        return it->second;
+
+    std::shared_ptr<const feature::RegionsArchive> archive;
+    const fs::path archivePath = fs::path(folder) / feature::RegionsArchive::defaultFilename;
+    if (utils::exists(archivePath))
+    {
+        try
+        {
+            archive = std::make_shared<const feature::RegionsArchive>(archivePath.string());
+            ALICEVISION_LOG_DEBUG("Regions archive: " << archivePath.string() << " (" << archive->size() << " entries)");
+        }
+        catch (const std::exception& e)
+        {
+            ALICEVISION_LOG_WARNING("Ignore invalid regions archive '" << archivePath.string() << "': " << e.what());
+        }
+    }
+    archives.emplace(folder, archive);
+    return archive;
+}
+
+}  // namespace
+
 std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber)
 {
     assert(!folders.empty());
 
-    const std::string imageDescriberTypeName = feature::EImageDescriberType_enumToString(imageDescriber.getDescriberType());
+    const feature::EImageDescriberType imageDescriberType = imageDescriber.getDescriberType();
+    const std::string imageDescriberTypeName = feature::EImageDescriberType_enumToString(imageDescriberType);
     const std::string basename = std::to_string(viewId);
 
     std::string featFilename;
     std::string descFilename;
+    std::shared_ptr<const feature::RegionsArchive> archive;
 
     for (const std::string& folder : folders)
     {
+        const std::shared_ptr<const feature::RegionsArchive> folderArchive = getRegionsArchive(folder);
+        if (folderArchive && folderArchive->hasRegions(viewId, imageDescriberType))
+        {
+            archive = folderArchive;
+            featFilename = descFilename = folderArchive->getPath();
+            continue;
+        }
+
         const fs::path featPath = fs::path(folder) / std::string(basename + "." + imageDescriberTypeName + ".feat");
         const fs::path descPath = fs::path(folder) / std::string(basename + "." + imageDescriberTypeName + ".desc");
 
         if (utils::exists(featPath) && utils::exists(descPath))
         {
+            archive.reset();
             featFilename = featPath.string();
             descFilename = descPath.string();
         }
@@ -59,7 +115,10 @@ std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& fo
 
     try
     {
-        regionsPtr->Load(featFilename, descFilename);
+        if (archive)
+            archive->loadRegions(viewId, imageDescriberType, *regionsPtr);
+        else
+            regionsPtr->Load(featFilename, descFilename);
     }
     catch (const std::exception& e)
     {
@@ -81,10 +140,12 @@ std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& f
 {
     assert(!folders.empty());
 
-    const std::string imageDescriberTypeName = feature::EImageDescriberType_enumToString(imageDescriber.getDescriberType());
+    const feature::EImageDescriberType imageDescriberType = imageDescriber.getDescriberType();
+    const std::string imageDescriberTypeName = feature::EImageDescriberType_enumToString(imageDescriberType);
     const std::string basename = std::to_string(viewId);
 
     std::string featFilename;
+    std::shared_ptr<const feature::RegionsArchive> archive;
 
     // build up a set with normalized paths to remove duplicates
     std::set<std::string> foldersSet;
@@ -98,9 +159,20 @@ std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& f
 
     for (const auto& folder : foldersSet)
     {
+        const std::shared_ptr<const feature::RegionsArchive> folderArchive = getRegionsArchive(folder);
+        if (folderArchive && folderArchive->hasRegions(viewId, imageDescriberType))
+        {
+            archive = folderArchive;
+            featFilename = folderArchive->getPath();
+            continue;
+        }
+
         const fs::path featPath = fs::path(folder) / std::string(basename + "." + imageDescriberTypeName + ".feat");
         if (utils::exists(featPath))
+        {
+            archive.reset();
             featFilename = featPath.string();
+        }
     }
 
     if (featFilename.empty())
@@ -117,7 +189,10 @@ std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& f
 
     try
     {
-        regionsPtr->LoadFeatures(featFilename);
+        if (archive)
+            archive->loadFeatures(viewId, imageDescriberType, *regionsPtr);
+        else
+            regionsPtr->LoadFeatures(featFilename);
     }
     catch (const std::exception& e)
     {
@@ -134,6 +209,48 @@ std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& f
     return regionsPtr;
 }
 
+void loadDescriptors(const std::vector<std::string>& folders, IndexT viewId, feature::EImageDescriberType imageDescriberType, feature::Regions& regions)
+{
+    assert(!folders.empty());
+
+    const std::string imageDescriberTypeName = feature::EImageDescriberType_enumToString(imageDescriberType);
+    const std::string basename = std::to_string(viewId);
+
+    std::string descFilename;
+    std::shared_ptr<const feature::RegionsArchive> archive;
+
+    for (const std::string& folder : folders)
+    {
+        const std::shared_ptr<const feature::RegionsArchive> folderArchive = getRegionsArchive(folder);
+        if (folderArchive && folderArchive->hasRegions(viewId, imageDescriberType))
+        {
+            archive = folderArchive;
+            descFilename = folderArchive->getPath();
+            continue;
+        }
+
+        const fs::path descPath = fs::path(folder) / std::string(basename + "." + imageDescriberTypeName + ".desc");
+        if (utils::exists(descPath))
+        {
+            archive.reset();
+            descFilename = descPath.string();
+        }
+    }
+
+    if (descFilename.empty())
+    {
+        const std::string foldersStr = boost::algorithm::join(folders, ", ");
+        throw std::runtime_error("Can't find view " + basename + " descriptors files in folders " + foldersStr);
+    }
+
+    ALICEVISION_LOG_TRACE("Descriptors filename: " << descFilename);
+
+    if (archive)
+        archive->loadDescriptors(viewId, imageDescriberType, regions);
+    else
+        regions.LoadDesc(descFilename);
+}
+
 bool loadFeaturesPerDescPerView(std::vector<std::vector<std::unique_ptr<feature::Regions>>>& featuresPerDescPerView,
                                 const std::vector<IndexT>& viewIds,
                                 const std::vector<std::string>& folders,
@@ -216,41 +333,115 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
     for (std::size_t i = 0; i < imageDescriberTypes.size(); ++i)
         imageDescribers.at(i) = createImageDescriber(imageDescriberTypes.at(i));
 
-#pragma omp parallel num_threads(3)
-    for (auto iter = sfmData.getViews().begin(); iter != sfmData.getViews().end() && !invalid; ++iter)
+    // (view id, describer index) of each regions file to load
+    std::vector<std::pair<IndexT, std::size_t>> regionsToLoad;
+    for (const auto& viewPair : sfmData.getViews())
     {
-#pragma omp single nowait
+        if (viewIdFilter.empty() || viewIdFilter.find(viewPair.first) != viewIdFilter.end())
         {
             for (std::size_t i = 0; i < imageDescriberTypes.size(); ++i)
-            {
-                if (viewIdFilter.empty() || viewIdFilter.find(iter->second.get()->getViewId()) != viewIdFilter.end())
-                {
-                    std::unique_ptr<feature::Regions> regionsPtr;
-                    try
-                    {
-                        regionsPtr = loadRegions(featuresFolders, iter->second.get()->getViewId(), *(imageDescribers.at(i)));
-                    }
-                    catch (const std::exception& e)
-                    {
-                        invalid = true;
-#pragma omp critical
-                        {
-                            ALICEVISION_LOG_ERROR(e.what());
-                        }
-                        continue;
-                    }
-#pragma omp critical
-                    {
-                        regionsPerView.addRegions(iter->second.get()->getViewId(), imageDescriberTypes.at(i), regionsPtr.release());
-                        ++progressDisplay;
-                    }
-                }
-            }
+                regionsToLoad.emplace_back(viewPair.second->getViewId(), i);
         }
     }
+
+    // load the regions files on the I/O threads and store them on this thread
+    system::IOScheduler::getInstance().forEachOrdered(
+      regionsToLoad.size(),
+      [&](std::size_t r) {
+          std::unique_ptr<feature::Regions> regionsPtr;
+          if (invalid)
+              return regionsPtr;
+          try
+          {
+              regionsPtr = loadRegions(featuresFolders, regionsToLoad[r].first, *(imageDescribers.at(regionsToLoad[r].second)));
+          }
+          catch (const std::exception& e)
+          {
+              invalid = true;
+              ALICEVISION_LOG_ERROR(e.what());
+          }
+          return regionsPtr;
+      },
+      [&](std::size_t r, std::unique_ptr<feature::Regions>&& regionsPtr) {
+          if (!regionsPtr)
+              return;
+          regionsPerView.addRegions(regionsToLoad[r].first, imageDescriberTypes.at(regionsToLoad[r].second), regionsPtr.release());
+          ++progressDisplay;
+      });
+
     return !invalid;
 }
 
+bool loadRegionsPerViewWithDescriptorsPaging(feature::RegionsPerView& regionsPerView,
+                                             const SfMData& sfmData,
+                                             const std::vector<std::string>& folders,
+                                             const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                                             std::size_t maxDescriptorsMemory,
+                                             const std::set<IndexT>& viewIdFilter)
+{
+    std::vector<std::string> featuresFolders = sfmData.getFeaturesFolders();        // add sfm features folders
+    featuresFolders.insert(featuresFolders.end(), folders.begin(), folders.end());  // add user features folders
+    auto last = std::unique(featuresFolders.begin(), featuresFolders.end());
+    featuresFolders.erase(last, featuresFolders.end());
+
+    // (view id, describer index) of each features file to load
+    std::vector<std::pair<IndexT, std::size_t>> featuresToLoad;
+    for (const auto& viewPair : sfmData.getViews())
+    {
+        if (viewIdFilter.empty() || viewIdFilter.find(viewPair.first) != viewIdFilter.end())
+        {
+            for (std::size_t i = 0; i < imageDescriberTypes.size(); ++i)
+                featuresToLoad.emplace_back(viewPair.first, i);
+        }
+    }
+
+    auto progressDisplay = system::createConsoleProgressDisplay(featuresToLoad.size(), std::cout, "Loading features\n");
+
+    std::vector<std::unique_ptr<feature::ImageDescriber>> imageDescribers;
+    imageDescribers.resize(imageDescriberTypes.size());
+
+    for (std::size_t i = 0; i < imageDescriberTypes.size(); ++i)
+        imageDescribers.at(i) = createImageDescriber(imageDescriberTypes.at(i));
+
+    std::atomic_bool invalid(false);
+
+    // only the features are loaded (on the I/O threads, then stored on this thread), descriptors are loaded on demand
+    system::IOScheduler::getInstance().forEachOrdered(
+      featuresToLoad.size(),
+      [&](std::size_t f) {
+          std::unique_ptr<feature::Regions> regionsPtr;
+          if (invalid)
+              return regionsPtr;
+          try
+          {
+              regionsPtr = loadFeatures(featuresFolders, featuresToLoad[f].first, *(imageDescribers.at(featuresToLoad[f].second)));
+          }
+          catch (const std::exception& e)
+          {
+              invalid = true;
+              ALICEVISION_LOG_ERROR(e.what());
+          }
+          return regionsPtr;
+      },
+      [&](std::size_t f, std::unique_ptr<feature::Regions>&& regionsPtr) {
+          if (!regionsPtr)
+              return;
+          regionsPerView.addRegions(featuresToLoad[f].first, imageDescriberTypes.at(featuresToLoad[f].second), regionsPtr.release());
+          ++progressDisplay;
+      });
+
+    if (invalid)
+        return false;
+
+    regionsPerView.enableDescriptorsPaging(
+      [featuresFolders](IndexT viewId, feature::EImageDescriberType descType, feature::Regions& regions) {
+          loadDescriptors(featuresFolders, viewId, descType, regions);
+      },
+      maxDescriptorsMemory);
+
+    return true;
+}
+
 bool loadFeaturesPerView(feature::FeaturesPerView& featuresPerView,
                          const SfMData& sfmData,
                          const std::vector<std::string>& folders,
@@ -37,6 +37,15 @@ std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& fo
  */
 std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber);
 
+/**
+ * @brief Load Descriptors for one view into already allocated Regions.
+ * @param[in] folders The list of featureFolders
+ * @param[in] viewId The view id
+ * @param[in] imageDescriberType The imageDescriber type
+ * @param[in,out] regions The regions in which the descriptors are loaded
+ */
+void loadDescriptors(const std::vector<std::string>& folders, IndexT viewId, feature::EImageDescriberType imageDescriberType, feature::Regions& regions);
+
 /**
  * @brief Load Features for each given view.
  * @param[in,out] featuresPerDescPerView
@@ -65,6 +74,25 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
                         const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
                         const std::set<IndexT>& filter = std::set<IndexT>());
 
+/**
+ * @brief Load Features for each view of the provided SfMData container and enable the on-demand loading of the descriptors.
+ * Descriptors are loaded when they are locked (see feature::RegionsPerView::DescriptorsLock)
+ * and evicted when they exceed the memory budget.
+ * @param[in,out] regionsPerView
+ * @param[in] sfmData The provided SfMData container
+ * @param[in] folders The feature Folders
+ * @param[in] imageDescriberTypes The imageDescriber types
+ * @param[in] maxDescriptorsMemory The memory budget for the descriptors in bytes
+ * @param[in] filter To load Regions only for a sub-set of the views contained in the sfmData
+ * @return true if the features are correctlty loaded
+ */
+bool loadRegionsPerViewWithDescriptorsPaging(feature::RegionsPerView& regionsPerView,
+                                             const sfmData::SfMData& sfmData,
+                                             const std::vector<std::string>& folders,
+                                             const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                                             std::size_t maxDescriptorsMemory,
+                                             const std::set<IndexT>& filter = std::set<IndexT>());
+
 /**
  * @brief Load Features for each view of the provided SfMData container.
  * @param[in,out] featuresPerView
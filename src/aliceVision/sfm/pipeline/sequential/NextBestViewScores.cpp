@@ -0,0 +1,133 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "NextBestViewScores.hpp"
+
+#include <cassert>
+
+namespace aliceVision {
+namespace sfm {
+
+NextBestViewScores::NextBestViewScores(const track::TracksStorage& tracks,
+                                       const std::vector<IndexT>& tracksPyramidCells,
+                                       const std::vector<int>& pyramidWeights,
+                                       std::size_t pyramidNbCells)
+  : _tracks(tracks),
+    _tracksPyramidCells(tracksPyramidCells),
+    _pyramidWeights(pyramidWeights),
+    _pyramidNbCells(pyramidNbCells),
+    _isReconstructed(tracks.nbTracks(), 0),
+    _isCandidate(tracks.nbViews(), 0),
+    _nbReconstructedTracks(tracks.nbViews(), 0),
+    _scores(tracks.nbViews(), 0),
+    _cellsCounts(tracks.nbViews())
+{
+    assert(_tracksPyramidCells.size() == _tracks.nbObservations() * _pyramidWeights.size());
+}
+
+void NextBestViewScores::setCandidateViews(const std::set<IndexT>& viewIds)
+{
+    std::vector<std::uint8_t> isCandidate(_tracks.nbViews(), 0);
+    for (const IndexT viewId : viewIds)
+    {
+        const std::size_t viewIndex = _tracks.getViewIndex(viewId);
+        if (viewIndex != track::TracksStorage::invalidIndex)
+            isCandidate[viewIndex] = 1;
+    }
+
+    for (std::size_t viewIndex = 0; viewIndex < isCandidate.size(); ++viewIndex)
+    {
+        if (isCandidate[viewIndex] == _isCandidate[viewIndex])
+            continue;
+
+        _isCandidate[viewIndex] = isCandidate[viewIndex];
+
+        if (isCandidate[viewIndex])
+        {
+            buildCells(viewIndex);
+        }
+        else
+        {
+            _cellsCounts[viewIndex] = std::vector<std::uint32_t>();
+            _scores[viewIndex] = 0;
+        }
+    }
+}
+
+void NextBestViewScores::setTrackReconstructed(std::size_t trackIndex, bool reconstructed)
+{
+    if (bool(_isReconstructed[trackIndex]) == reconstructed)
+        return;
+
+    _isReconstructed[trackIndex] = reconstructed;
+
+    const int delta = reconstructed ? 1 : -1;
+    const std::size_t obsOffset = _tracks.getObservationsOffset(trackIndex);
+    const auto observations = _tracks.getObservations(trackIndex);
+
+    for (std::size_t i = 0; i < observations.size(); ++i)
+    {
+        const std::size_t viewIndex = _tracks.getViewIndex(observations[i].viewId);
+        _nbReconstructedTracks[viewIndex] += delta;
+
+        if (_isCandidate[viewIndex])
+            updateCells(viewIndex, obsOffset + i, delta);
+    }
+}
+
+std::size_t NextBestViewScores::getNbReconstructedTracks(IndexT viewId) const
+{
+    const std::size_t viewIndex = _tracks.getViewIndex(viewId);
+    return (viewIndex == track::TracksStorage::invalidIndex) ? 0 : _nbReconstructedTracks[viewIndex];
+}
+
+std::size_t NextBestViewScores::getScore(IndexT viewId) const
+{
+    const std::size_t viewIndex = _tracks.getViewIndex(viewId);
+    return (viewIndex == track::TracksStorage::invalidIndex) ? 0 : _scores[viewIndex];
+}
+
+void NextBestViewScores::updateCells(std::size_t viewIndex, std::size_t obsIndex, int delta)
+{
+    std::vector<std::uint32_t>& cellsCounts = _cellsCounts[viewIndex];
+
+    // allocated with the first reconstructed track of the view
+    if (cellsCounts.empty())
+        cellsCounts.resize(_pyramidNbCells, 0);
+
+    const std::size_t pyramidDepth = _pyramidWeights.size();
+    const IndexT* cells = &_tracksPyramidCells[obsIndex * pyramidDepth];
+
+    for (std::size_t level = 0; level < pyramidDepth; ++level)
+    {
+        std::uint32_t& count = cellsCounts[cells[level]];
+
+        if (delta > 0 && count++ == 0)
+            _scores[viewIndex] += _pyramidWeights[level];  // the cell becomes occupied
+        else if (delta < 0 && --count == 0)
+            _scores[viewIndex] -= _pyramidWeights[level];  // the cell becomes empty
+    }
+}
+
+void NextBestViewScores::buildCells(std::size_t viewIndex)
+{
+    _cellsCounts[viewIndex] = std::vector<std::uint32_t>();
+    _scores[viewIndex] = 0;
+
+    if (_nbReconstructedTracks[viewIndex] == 0)
+        return;
+
+    const IndexT viewId = _tracks.getViewId(viewIndex);
+
+    for (const IndexT trackIndex : _tracks.getViewTrackIndexes(viewId))
+    {
+        if (_isReconstructed[trackIndex])
+            updateCells(viewIndex, _tracks.getObservationIndex(trackIndex, viewId), 1);
+    }
+}
+
+}  // namespace sfm
+}  // namespace aliceVision
@@ -0,0 +1,86 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/track/TracksStorage.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Incremental bookkeeping of the next best view scores of the sequential SfM.
+ *
+ * For each view, it keeps the number of its tracks already reconstructed and, for the candidate views,
+ * the occupancy of the pyramid cells by these tracks (number of reconstructed tracks per cell).
+ * The pyramid score of a view is the sum of the weights of its occupied cells.
+ * The sites which add or remove landmarks report each change with setTrackReconstructed, so the cost of an update
+ * is proportional to the landmarks changes instead of the number of views times the number of tracks.
+ */
+class NextBestViewScores
+{
+  public:
+    /**
+     * @brief NextBestViewScores constructor, no track is reconstructed.
+     * @param[in] tracks the putative tracks
+     * @param[in] tracksPyramidCells the pyramid cell index of each track observation (pyramidWeights.size() values per observation)
+     * @param[in] pyramidWeights the weight of each pyramid level
+     * @param[in] pyramidNbCells the total number of cells in all the levels of the pyramid
+     */
+    NextBestViewScores(const track::TracksStorage& tracks,
+                       const std::vector<IndexT>& tracksPyramidCells,
+                       const std::vector<int>& pyramidWeights,
+                       std::size_t pyramidNbCells);
+
+    /**
+     * @brief Set the views which need a pyramid score (the views not reconstructed yet).
+     *        The pyramid occupancy of the other views is released.
+     * @param[in] viewIds the candidate views
+     */
+    void setCandidateViews(const std::set<IndexT>& viewIds);
+
+    /**
+     * @brief Set the reconstructed state of a track and update the counters of its views.
+     *        Nothing is done if the state does not change.
+     * @param[in] trackIndex the track index in the tracks storage
+     * @param[in] reconstructed the new reconstructed state
+     */
+    void setTrackReconstructed(std::size_t trackIndex, bool reconstructed);
+
+    inline bool isTrackReconstructed(std::size_t trackIndex) const { return _isReconstructed[trackIndex]; }
+
+    /// number of reconstructed tracks visible in the view
+    std::size_t getNbReconstructedTracks(IndexT viewId) const;
+
+    /// pyramid score of a candidate view (0 for other views)
+    std::size_t getScore(IndexT viewId) const;
+
+  private:
+    /// add (+1) or remove (-1) a reconstructed track observation in a candidate view pyramid
+    void updateCells(std::size_t viewIndex, std::size_t obsIndex, int delta);
+
+    /// recompute the pyramid occupancy of a view from its reconstructed tracks
+    void buildCells(std::size_t viewIndex);
+
+    const track::TracksStorage& _tracks;                   //< putative tracks
+    const std::vector<IndexT>& _tracksPyramidCells;        //< pyramid cell index per track observation and level
+    const std::vector<int> _pyramidWeights;                //< weight per pyramid level
+    const std::size_t _pyramidNbCells;                     //< number of cells in all the levels of the pyramid
+    std::vector<std::uint8_t> _isReconstructed;            //< per track, is reconstructed
+    std::vector<std::uint8_t> _isCandidate;                //< per view, needs a pyramid score
+    std::vector<std::size_t> _nbReconstructedTracks;       //< per view, number of reconstructed tracks
+    std::vector<std::size_t> _scores;                      //< per view, pyramid score (candidate views only)
+    std::vector<std::vector<std::uint32_t>> _cellsCounts;  //< per view, reconstructed tracks per cell (empty if not needed)
+};
+
+}  // namespace sfm
+}  // namespace aliceVision
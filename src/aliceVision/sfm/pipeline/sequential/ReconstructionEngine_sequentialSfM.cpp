@@ -31,6 +31,7 @@
 #include <aliceVision/track/TracksBuilder.hpp>
 #include <aliceVision/track/tracksUtils.hpp>
 #include <aliceVision/utils/filesIO.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <dependencies/htmlDoc/htmlDoc.hpp>
 
@@ -41,6 +42,8 @@
 #include <tuple>
 #include <iostream>
 #include <algorithm>
+#include <cstdint>
+#include <numeric>
 
 #ifdef _MSC_VER
     #pragma warning(once : 4267)  // warning C4267: 'argument' : conversion from 'size_t' to 'const int', possible loss of data
@@ -59,21 +62,19 @@ using namespace aliceVision::sfmData;
  * @brief Compute indexes of all features in a fixed size pyramid grid.
  * These precomputed values are useful to the next best view selection for incremental SfM.
  *
- * @param[in] tracksPerView: The list of TrackID per view
- * @param[in] map_tracks: All putative tracks
+ * @param[in] tracks: All putative tracks
  * @param[in] views: All views
  * @param[in] featuresProvider: Input features and descriptors
  * @param[in] pyramidDepth: Depth of the pyramid.
- * @param[out] tracksPyramidPerView:
- *             Precomputed list of pyramid cells ID for each track in each view.
+ * @param[out] tracksPyramidCells:
+ *             Precomputed pyramid cells ID for each observation of each track (pyramidDepth values per observation).
  */
-void computeTracksPyramidPerView(const track::TracksPerView& tracksPerView,
-                                 const track::TracksMap& map_tracks,
-                                 const Views& views,
-                                 const feature::FeaturesPerView& featuresProvider,
-                                 const std::size_t pyramidBase,
-                                 const std::size_t pyramidDepth,
-                                 track::TracksPyramidPerView& tracksPyramidPerView)
+void computeTracksPyramidCells(const track::TracksStorage& tracks,
+                               const Views& views,
+                               const feature::FeaturesPerView& featuresProvider,
+                               const std::size_t pyramidBase,
+                               const std::size_t pyramidDepth,
+                               std::vector<IndexT>& tracksPyramidCells)
 {
     std::vector<std::size_t> widthPerLevel(pyramidDepth);
     std::vector<std::size_t> startPerLevel(pyramidDepth);
@@ -85,43 +86,31 @@ void computeTracksPyramidPerView(const track::TracksPerView& tracksPerView,
         start += Square(widthPerLevel[level]);
     }
 
-    tracksPyramidPerView.reserve(tracksPerView.size());
-    for (const auto& viewTracks : tracksPerView)
-    {
-        auto& trackPyramid = tracksPyramidPerView[viewTracks.first];
-        // reserve 500 tracks in each view
-        trackPyramid.reserve(500 * pyramidDepth);
-    }
+    tracksPyramidCells.resize(tracks.nbObservations() * pyramidDepth);
 
-    for (const auto& viewTracks : tracksPerView)
+#pragma omp parallel for
+    for (std::size_t trackIndex = 0; trackIndex < tracks.nbTracks(); ++trackIndex)
     {
-        const auto viewId = viewTracks.first;
-        auto& tracksPyramidIndex = tracksPyramidPerView[viewId];
-        const View& view = *views.at(viewId).get();
-        std::vector<double> cellWidthPerLevel(pyramidDepth);
-        std::vector<double> cellHeightPerLevel(pyramidDepth);
-        for (std::size_t level = 0; level < pyramidDepth; ++level)
-        {
-            cellWidthPerLevel[level] = (double)view.getImage().getWidth() / (double)widthPerLevel[level];
-            cellHeightPerLevel[level] = (double)view.getImage().getHeight() / (double)widthPerLevel[level];
-        }
-        for (std::size_t i = 0; i < viewTracks.second.size(); ++i)
+        const feature::EImageDescriberType descType = tracks.getDescType(trackIndex);
+        IndexT* cells = &tracksPyramidCells[tracks.getObservationsOffset(trackIndex) * pyramidDepth];
+        for (const track::TrackObservation& obs : tracks.getObservations(trackIndex))
         {
-            const std::size_t trackId = viewTracks.second[i];
-            const track::Track& track = map_tracks.at(trackId);
-            const std::size_t featIndex = track.featPerView.at(viewId).featureId;
-            const auto& feature = featuresProvider.getFeatures(viewId, track.descType)[featIndex];
+            const View& view = *views.at(obs.viewId).get();
+            const auto& feature = featuresProvider.getFeatures(obs.viewId, descType)[obs.featureId];
 
             for (std::size_t level = 0; level < pyramidDepth; ++level)
             {
-                std::size_t xCell = std::floor(std::max(feature.x(), 0.0f) / cellWidthPerLevel[level]);
-                std::size_t yCell = std::floor(std::max(feature.y(), 0.0f) / cellHeightPerLevel[level]);
+                const double cellWidth = (double)view.getImage().getWidth() / (double)widthPerLevel[level];
+                const double cellHeight = (double)view.getImage().getHeight() / (double)widthPerLevel[level];
+                std::size_t xCell = std::floor(std::max(feature.x(), 0.0f) / cellWidth);
+                std::size_t yCell = std::floor(std::max(feature.y(), 0.0f) / cellHeight);
                 xCell = std::min(xCell, widthPerLevel[level] - 1);
                 yCell = std::min(yCell, widthPerLevel[level] - 1);
                 const std::size_t levelIndex = xCell + yCell * widthPerLevel[level];
                 assert(levelIndex < Square(widthPerLevel[level]));
-                tracksPyramidIndex[trackId * pyramidDepth + level] = startPerLevel[level] + levelIndex;
+                cells[level] = startPerLevel[level] + levelIndex;
             }
+            cells += pyramidDepth;
         }
     }
 }
@@ -195,7 +184,7 @@ bool ReconstructionEngine_sequentialSfM::process()
             if (!reconstructedViews.empty())
             {
                 // Add the reconstructed views to the LocalBA graph
-                _localStrategyGraph->updateGraphWithNewViews(_sfmData, _map_tracksPerView, reconstructedViews, _params.kMinNbOfMatches);
+                _localStrategyGraph->updateGraphWithNewViews(_sfmData, _tracks, reconstructedViews, _params.kMinNbOfMatches);
                 _localStrategyGraph->updateRigEdgesToTheGraph(_sfmData);
             }
         }
@@ -235,6 +224,7 @@ void ReconstructionEngine_sequentialSfM::initializePyramidScoring()
     if (_pyramidWeights.size() != _params.pyramidDepth)
     {
         _pyramidWeights.resize(_params.pyramidDepth);
+        _pyramidNbCells = 0;
         std::size_t maxWeight = 0;
         for (std::size_t level = 0; level < _params.pyramidDepth; ++level)
         {
@@ -245,6 +235,7 @@ void ReconstructionEngine_sequentialSfM::initializePyramidScoring()
             // w = 2^{L-l} with L the number of levels in the pyramid.
             _pyramidWeights[level] = std::pow(2.0, (_params.pyramidDepth - (level + 1)));
             maxWeight += nbCells * _pyramidWeights[level];
+            _pyramidNbCells += nbCells;
         }
         _pyramidThreshold = maxWeight * 0.2;
     }
@@ -267,36 +258,21 @@ std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
 
         ALICEVISION_LOG_DEBUG("Track export to internal structure");
         // build tracks with STL compliant type
-        tracksBuilder.exportToSTL(_map_tracks);
-        ALICEVISION_LOG_DEBUG("Build tracks per view");
+        track::TracksMap tracks;
+        tracksBuilder.exportToSTL(tracks);
 
-        // Init tracksPerView to have an entry in the map for each view (even if there is no track at all)
-        for (const auto& viewIt : _sfmData.getViews())
-        {
-            // create an entry in the map
-            _map_tracksPerView[viewIt.first];
-        }
-        track::computeTracksPerView(_map_tracks, _map_tracksPerView);
-        ALICEVISION_LOG_DEBUG("Build tracks pyramid per view");
-        computeTracksPyramidPerView(_map_tracksPerView,
-                                    _map_tracks,
-                                    _sfmData.getViews(),
-                                    *_featuresPerView,
-                                    _params.pyramidBase,
-                                    _params.pyramidDepth,
-                                    _map_featsPyramidPerView);
+        ALICEVISION_LOG_DEBUG("Build flat tracks storage");
+        // the TracksMap is released at the end of this scope, only the flat storage is kept
+        _tracks.build(tracks);
 
         // display stats
         {
-            std::set<size_t> imagesId;
-            track::imageIdInTracks(_map_tracksPerView, imagesId);
-
             ALICEVISION_LOG_INFO("Fuse matches into tracks: " << std::endl
-                                                              << "\t- # tracks: " << tracksBuilder.nbTracks() << std::endl
-                                                              << "\t- # images in tracks: " << imagesId.size());
+                                                              << "\t- # tracks: " << _tracks.nbTracks() << std::endl
+                                                              << "\t- # images in tracks: " << _tracks.nbViews());
 
             std::map<size_t, size_t> map_Occurence_TrackLength;
-            track::tracksLength(_map_tracks, map_Occurence_TrackLength);
+            track::tracksLength(tracks, map_Occurence_TrackLength);
             ALICEVISION_LOG_INFO("TrackLength, Occurrence");
             for (const auto& iter : map_Occurence_TrackLength)
             {
@@ -306,7 +282,12 @@ std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
             }
         }
     }
-    return _map_tracks.size();
+
+    ALICEVISION_LOG_DEBUG("Build tracks pyramid per view");
+    computeTracksPyramidCells(_tracks, _sfmData.getViews(), *_featuresPerView, _params.pyramidBase, _params.pyramidDepth, _tracksPyramidCells);
+    _nextBestViewScores = std::make_unique<NextBestViewScores>(_tracks, _tracksPyramidCells, _pyramidWeights, _pyramidNbCells);
+
+    return _tracks.nbTracks();
 }
 
 std::vector<Pair> ReconstructionEngine_sequentialSfM::getInitialImagePairsCandidates()
@@ -365,10 +346,10 @@ void ReconstructionEngine_sequentialSfM::registerChanges(std::set<IndexT>& linke
     const sfmData::Landmarks& landmarks = _sfmData.getLandmarks();
     for (IndexT id : newReconstructedViews)
     {
-        const track::TrackIdSet& setTracks = _map_tracksPerView[id];
-
-        for (auto idTrack : setTracks)
+        for (IndexT trackIndex : _tracks.getViewTrackIndexes(id))
         {
+            const std::size_t idTrack = _tracks.getTrackId(trackIndex);
+
             // Check that this track is indeed a landmark
             if (landmarks.find(idTrack) == landmarks.end())
             {
@@ -382,10 +363,9 @@ void ReconstructionEngine_sequentialSfM::registerChanges(std::set<IndexT>& linke
                 continue;
             }
 
-            const track::Track& track = _map_tracks[idTrack];
-            for (const auto& pairFeat : track.featPerView)
+            for (const track::TrackObservation& obs : _tracks.getObservations(trackIndex))
             {
-                IndexT oview = pairFeat.first;
+                IndexT oview = obs.viewId;
                 if (oview == id)
                 {
                     continue;
@@ -435,26 +415,27 @@ void ReconstructionEngine_sequentialSfM::remapLandmarkIdsToTrackIds()
     ALICEVISION_LOG_DEBUG("Find corresponding landmark id per track id");
 
     // find corresponding landmark id per track id
-    for (const auto& trackPair : _map_tracks)
+    for (std::size_t trackIndex = 0; trackIndex < _tracks.nbTracks(); ++trackIndex)
     {
-        const IndexT trackId = trackPair.first;
-        const Track& track = trackPair.second;
+        const IndexT trackId = _tracks.getTrackId(trackIndex);
+        const feature::EImageDescriberType descType = _tracks.getDescType(trackIndex);
 
-        for (const auto& featView : track.featPerView)
+        for (const TrackObservation& obs : _tracks.getObservations(trackIndex))
         {
-            const ObsToLandmark::const_iterator it = obsToLandmark.find(ObsKey(featView.first, featView.second.featureId, track.descType));
+            const ObsToLandmark::const_iterator it = obsToLandmark.find(ObsKey(obs.viewId, obs.featureId, descType));
 
             if (it != obsToLandmark.end())
             {
                 // re-insert the landmark with the new id
                 _sfmData.getLandmarks().emplace(trackId, landmarks.find(it->second)->second);
+                setLandmarkReconstructed(trackId, true);
                 break;  // one landmark per track
             }
         }
     }
 
     ALICEVISION_LOG_INFO("Landmark ids to track ids remapping: " << std::endl
-                                                                 << "\t- # tracks: " << _map_tracks.size() << std::endl
+                                                                 << "\t- # tracks: " << _tracks.nbTracks() << std::endl
                                                                  << "\t- # input landmarks: " << landmarks.size() << std::endl
                                                                  << "\t- # output landmarks: " << _sfmData.getLandmarks().size());
 }
@@ -738,7 +719,15 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
     ALICEVISION_LOG_INFO("Bundle adjustment start.");
     auto chronoStart = std::chrono::steady_clock::now();
 
-    BundleAdjustmentCeres::CeresOptions options;
+    // keep the same engine (and Ceres problem) between the calls, except for a new initial pair
+    if (!_bundleAdjustment || isInitialPair)
+    {
+        BundleAdjustmentCeres::CeresOptions persistentOptions;
+        persistentOptions.persistentProblem = true;
+        _bundleAdjustment = std::make_shared<BundleAdjustmentCeres>(persistentOptions, _params.minNbCamerasToRefinePrincipalPoint);
+    }
+
+    BundleAdjustmentCeres::CeresOptions options = _bundleAdjustment->getCeresOptions();
     BundleAdjustment::ERefineOptions refineOptions =
       BundleAdjustment::REFINE_ROTATION | BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE;
 
@@ -764,7 +753,7 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
 
     // add the new reconstructed views to the graph
     if (_params.useLocalBundleAdjustment)
-        _localStrategyGraph->updateGraphWithNewViews(_sfmData, _map_tracksPerView, newReconstructedViews, _params.kMinNbOfMatches);
+        _localStrategyGraph->updateGraphWithNewViews(_sfmData, _tracks, newReconstructedViews, _params.kMinNbOfMatches);
 
     if (enableLocalStrategy)
     {
@@ -793,7 +782,8 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
         }
     }
 
-    BundleAdjustmentCeres BA(options, _params.minNbCamerasToRefinePrincipalPoint);
+    _bundleAdjustment->setCeresOptions(options);
+    BundleAdjustmentCeres& BA = *_bundleAdjustment;
 
     // give the local strategy graph is local strategy is enable
     if (!enableLocalStrategy)
@@ -824,10 +814,15 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
             statistics.show();
         }
 
-        nbOutliers = removeOutliers();
+        std::set<IndexT> removedLandmarksIdIteration;
+        nbOutliers = removeOutliers(&removedLandmarksIdIteration);
 
         std::set<IndexT> removedViewsIdIteration;
-        eraseUnstablePosesAndObservations(this->_sfmData, _params.minPointsPerPose, _params.minTrackLength, &removedViewsIdIteration);
+        eraseUnstablePosesAndObservations(
+          this->_sfmData, _params.minPointsPerPose, _params.minTrackLength, &removedViewsIdIteration, &removedLandmarksIdIteration);
+
+        for (IndexT landmarkId : removedLandmarksIdIteration)
+            setLandmarkReconstructed(landmarkId, false);
 
         for (IndexT v : removedViewsIdIteration)
             newReconstructedViews.erase(v);
@@ -983,82 +978,63 @@ void ReconstructionEngine_sequentialSfM::calibrateRigs(std::set<IndexT>& updated
     for (const std::pair<IndexT, Rig>& rigPair : _sfmData.getRigs())
     {
         RigSequence sequence(_sfmData, rigPair.first, _params.rig);
-        sequence.init(_map_tracksPerView);
+        sequence.init(_tracks);
         sequence.updateSfM(updatedViews);
     }
 }
 
 bool ReconstructionEngine_sequentialSfM::findConnectedViews(std::vector<ViewConnectionScore>& out_connectedViews,
-                                                            const std::set<IndexT>& remainingViewIds) const
+                                                            const std::set<IndexT>& remainingViewIds)
 {
     out_connectedViews.clear();
 
     if (remainingViewIds.empty() || _sfmData.getLandmarks().empty())
         return false;
 
-    // Collect tracksIds
-    std::set<size_t> reconstructed_trackId;
-    std::transform(_sfmData.getLandmarks().begin(),
-                   _sfmData.getLandmarks().end(),
-                   std::inserter(reconstructed_trackId, reconstructed_trackId.begin()),
-                   stl::RetrieveKey());
+    // The reconstructed tracks counters are kept up to date by the landmarks changes,
+    // only the pyramid occupancy of the views reconstructed since the last selection is released
+    _nextBestViewScores->setCandidateViews(remainingViewIds);
 
     const std::set<IndexT> reconstructedIntrinsics = _sfmData.getReconstructedIntrinsics();
 
-#pragma omp parallel for
-    for (int i = 0; i < remainingViewIds.size(); ++i)
+    for (const IndexT viewId : remainingViewIds)
     {
-        std::set<IndexT>::const_iterator iter = remainingViewIds.cbegin();
-        std::advance(iter, i);
-        const IndexT viewId = *iter;
-        const IndexT intrinsicId = _sfmData.getViews().at(viewId)->getIntrinsicId();
-        const bool isIntrinsicsReconstructed = reconstructedIntrinsics.count(intrinsicId);
+        const View& view = *_sfmData.getViews().at(viewId);
+        const bool isIntrinsicsReconstructed = reconstructedIntrinsics.count(view.getIntrinsicId());
 
         // Compute 2D - 3D possible content
-        const aliceVision::track::TrackIdSet& set_tracksIds = _map_tracksPerView.at(viewId);
-        if (set_tracksIds.empty())
+        if (!_tracks.hasView(viewId))
             continue;
 
         // Check if the view is part of a rig
+        if (view.isPartOfRig())
         {
-            const View& view = *_sfmData.getViews().at(viewId);
-
-            if (view.isPartOfRig())
+            // Some views can become indirectly localized when the sub-pose becomes defined
+            if (_sfmData.isPoseAndIntrinsicDefined(view.getViewId()))
             {
-                // Some views can become indirectly localized when the sub-pose becomes defined
-                if (_sfmData.isPoseAndIntrinsicDefined(view.getViewId()))
-                {
-                    continue;
-                }
+                continue;
+            }
 
-                // We cannot localize a view if it is part of an initialized RIG with unknown Rig Pose
-                const bool knownPose = _sfmData.existsPose(view);
-                const Rig& rig = _sfmData.getRig(view);
-                const RigSubPose& subpose = rig.getSubPose(view.getSubPoseId());
+            // We cannot localize a view if it is part of an initialized RIG with unknown Rig Pose
+            const bool knownPose = _sfmData.existsPose(view);
+            const Rig& rig = _sfmData.getRig(view);
+            const RigSubPose& subpose = rig.getSubPose(view.getSubPoseId());
 
-                if (rig.isInitialized() && !knownPose && (subpose.status == ERigSubPoseStatus::UNINITIALIZED))
-                {
-                    continue;
-                }
+            if (rig.isInitialized() && !knownPose && (subpose.status == ERigSubPoseStatus::UNINITIALIZED))
+            {
+                continue;
             }
         }
 
-        // Count the common possible putative point
-        //  with the already 3D reconstructed trackId
-        std::vector<std::size_t> vec_trackIdForResection;
-        vec_trackIdForResection.reserve(set_tracksIds.size());
-        std::set_intersection(set_tracksIds.begin(),
-                              set_tracksIds.end(),
-                              reconstructed_trackId.begin(),
-                              reconstructed_trackId.end(),
-                              std::back_inserter(vec_trackIdForResection));
-        // Compute an image score based on the number of matches to the 3D scene
-        // and the repartition of these features in the image.
-        std::size_t score = computeCandidateImageScore(viewId, vec_trackIdForResection);
-#pragma omp critical
-        {
-            out_connectedViews.emplace_back(viewId, vec_trackIdForResection.size(), score, isIntrinsicsReconstructed);
-        }
+        // Number of putative points shared with the already 3D reconstructed tracks,
+        // and image score based on their number and repartition in the image.
+        const std::size_t nbReconstructedTracks = _nextBestViewScores->getNbReconstructedTracks(viewId);
+#ifdef ALICEVISION_NEXTBESTVIEW_WITHOUT_SCORE
+        const std::size_t score = nbReconstructedTracks;
+#else
+        const std::size_t score = _nextBestViewScores->getScore(viewId);
+#endif
+        out_connectedViews.emplace_back(viewId, nbReconstructedTracks, score, isIntrinsicsReconstructed);
     }
 
     // Sort by the image score
@@ -1068,7 +1044,7 @@ bool ReconstructionEngine_sequentialSfM::findConnectedViews(std::vector<ViewConn
     return !out_connectedViews.empty();
 }
 
-bool ReconstructionEngine_sequentialSfM::findNextBestViews(std::vector<IndexT>& out_selectedViewIds, const std::set<IndexT>& remainingViewIds) const
+bool ReconstructionEngine_sequentialSfM::findNextBestViews(std::vector<IndexT>& out_selectedViewIds, const std::set<IndexT>& remainingViewIds)
 {
     out_selectedViewIds.clear();
     auto chrono_start = std::chrono::steady_clock::now();
@@ -1210,7 +1186,7 @@ bool ReconstructionEngine_sequentialSfM::makeInitialPair3D(const Pair& currentPa
     // b. get common features between the two views
     // use the track to have a more dense match correspondence set
     aliceVision::track::TracksMap commonTracks;
-    track::getCommonTracksInImagesFast({I, J}, _map_tracks, _map_tracksPerView, commonTracks);
+    _tracks.getCommonTracks({I, J}, commonTracks);
 
     // copy point to arrays
     const std::size_t n = commonTracks.size();
@@ -1270,6 +1246,8 @@ bool ReconstructionEngine_sequentialSfM::makeInitialPair3D(const Pair& currentPa
                 // because it can failed after multiple iterations
                 // we need to clear poses & rigs & landmarks
                 _sfmData.getPoses().clear();
+                for (const auto& landmarkPair : _sfmData.getLandmarks())
+                    setLandmarkReconstructed(landmarkPair.first, false);
                 _sfmData.getLandmarks().clear();
                 _sfmData.resetRigs();
 
@@ -1398,7 +1376,7 @@ bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pa
 
         aliceVision::track::TracksMap map_tracksCommon;
         const std::set<size_t> set_imageIndex = {I, J};
-        track::getCommonTracksInImagesFast(set_imageIndex, _map_tracks, _map_tracksPerView, map_tracksCommon);
+        _tracks.getCommonTracks(set_imageIndex, map_tracksCommon);
 
         // Copy points correspondences to arrays for relative pose estimation
         const size_t n = map_tracksCommon.size();
@@ -1513,16 +1491,19 @@ std::size_t ReconstructionEngine_sequentialSfM::computeCandidateImageScore(Index
     std::size_t score = 0;
     // The number of cells of the pyramid grid represent the score
     // and ensure a proper repartition of features in images.
-    const auto& featsPyramid = _map_featsPyramidPerView.at(viewId);
-    for (std::size_t level = 0; level < _params.pyramidDepth; ++level)
+    // Cells are numbered contiguously across the levels, so one flag per cell is enough.
+    std::vector<char> isCellUsed(_pyramidNbCells, 0);
+    for (std::size_t trackId : trackIds)
     {
-        std::set<std::size_t> featIndexes;  // Set of grid cell indexes in the pyramid
-        for (IndexT trackId : trackIds)
+        const std::size_t obsIndex = _tracks.getObservationIndex(_tracks.getTrackIndex(trackId), viewId);
+        const IndexT* cells = &_tracksPyramidCells[obsIndex * _params.pyramidDepth];
+        for (int level = 0; level < _params.pyramidDepth; ++level)
         {
-            std::size_t pyramidIndex = featsPyramid.at(trackId * _params.pyramidDepth + level);
-            featIndexes.insert(pyramidIndex);
+            if (isCellUsed[cells[level]])
+                continue;
+            isCellUsed[cells[level]] = 1;
+            score += _pyramidWeights[level];
         }
-        score += featIndexes.size() * _pyramidWeights[level];
     }
     return score;
 #endif
@@ -1542,22 +1523,21 @@ std::size_t ReconstructionEngine_sequentialSfM::computeCandidateImageScore(Index
 bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, ResectionData& resectionData)
 {
     // A. Compute 2D/3D matches
-    // A1. list tracks ids used by the view
-    const aliceVision::track::TrackIdSet& set_tracksIds = _map_tracksPerView.at(viewId);
-
+    // A1. list tracks used by the view
     // A2. intersects the track list with the reconstructed
-    std::set<std::size_t> reconstructed_trackId;
-    std::transform(_sfmData.getLandmarks().begin(),
-                   _sfmData.getLandmarks().end(),
-                   std::inserter(reconstructed_trackId, reconstructed_trackId.begin()),
-                   stl::RetrieveKey());
-
-    // Get the ids of the already reconstructed tracks
-    std::set_intersection(set_tracksIds.begin(),
-                          set_tracksIds.end(),
-                          reconstructed_trackId.begin(),
-                          reconstructed_trackId.end(),
-                          std::inserter(resectionData.tracksId, resectionData.tracksId.begin()));
+    // and get back featId associated to a tracksID already reconstructed.
+    // These 2D/3D associations will be used for the resection.
+    const Landmarks& landmarks = _sfmData.getLandmarks();
+    for (IndexT trackIndex : _tracks.getViewTrackIndexes(viewId))
+    {
+        const std::size_t trackId = _tracks.getTrackId(trackIndex);
+        if (landmarks.find(trackId) == landmarks.end())
+            continue;
+
+        // track indexes are sorted by track id
+        resectionData.tracksId.insert(resectionData.tracksId.end(), trackId);
+        resectionData.featuresId.emplace_back(_tracks.getDescType(trackIndex), _tracks.findObservation(trackIndex, viewId)->featureId);
+    }
 
     if (resectionData.tracksId.empty())
     {
@@ -1566,10 +1546,6 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
         return false;
     }
 
-    // Get back featId associated to a tracksID already reconstructed.
-    // These 2D/3D associations will be used for the resection.
-    getFeatureIdInViewPerTrack(_map_tracks, resectionData.tracksId, viewId, resectionData.featuresId);
-
     // Localize the image inside the SfM reconstruction
     resectionData.pt2D.resize(2, resectionData.tracksId.size());
     resectionData.pt3D.resize(3, resectionData.tracksId.size());
@@ -1679,38 +1655,6 @@ void ReconstructionEngine_sequentialSfM::updateScene(const IndexT viewIndex, con
     }
 }
 
-bool ReconstructionEngine_sequentialSfM::checkChieralities(const Vec3& pt3D, const std::set<IndexT>& viewsId, const SfMData& scene)
-{
-    for (const IndexT& viewId : viewsId)
-    {
-        const View* view = scene.getViews().at(viewId).get();
-        const Pose3 pose = scene.getPose(*view).getTransform();
-        // Check that the point is in front of all the cameras.
-        if (pose.depth(pt3D) < 0)
-            return false;
-    }
-    return true;
-}
-
-bool ReconstructionEngine_sequentialSfM::checkAngles(const Vec3& pt3D, const std::set<IndexT>& viewsId, const SfMData& scene, const double& kMinAngle)
-{
-    for (const std::size_t& viewIdA : viewsId)
-    {
-        for (const std::size_t& viewIdB : viewsId)
-        {
-            if (viewIdA < viewIdB)
-            {
-                double angle_deg = angleBetweenRays(scene.getPose(*scene.getViews().at(viewIdA).get()).getTransform(),
-                                                    scene.getPose(*scene.getViews().at(viewIdB).get()).getTransform(),
-                                                    pt3D);
-                if (angle_deg >= kMinAngle)
-                    return true;
-            }
-        }
-    }
-    return false;
-}
-
 void ReconstructionEngine_sequentialSfM::getTracksToTriangulate(const std::set<IndexT>& previousReconstructedViews,
                                                                 const std::set<IndexT>& newReconstructedViews,
                                                                 std::map<IndexT, std::set<IndexT>>& mapTracksToTriangulate) const
@@ -1719,78 +1663,60 @@ void ReconstructionEngine_sequentialSfM::getTracksToTriangulate(const std::set<I
     allReconstructedViews.insert(previousReconstructedViews.begin(), previousReconstructedViews.end());
     allReconstructedViews.insert(newReconstructedViews.begin(), newReconstructedViews.end());
 
-    std::set<IndexT> allTracksInNewViews;
-    track::getTracksInImagesFast(newReconstructedViews, _map_tracksPerView, allTracksInNewViews);
-
-    std::set<IndexT>::iterator it;
-#pragma omp parallel private(it)
+    // tracks seen by at least one new reconstructed view
+    std::vector<IndexT> tracksInNewViews;
+    for (IndexT viewId : newReconstructedViews)
     {
-        for (it = allTracksInNewViews.begin(); it != allTracksInNewViews.end(); ++it)
-        {
-#pragma omp single nowait
-            {
-                const std::size_t trackId = *it;
-
-                const track::Track& track = _map_tracks.at(trackId);
+        const auto viewTrackIndexes = _tracks.getViewTrackIndexes(viewId);
+        tracksInNewViews.insert(tracksInNewViews.end(), viewTrackIndexes.begin(), viewTrackIndexes.end());
+    }
+    std::sort(tracksInNewViews.begin(), tracksInNewViews.end());
+    tracksInNewViews.erase(std::unique(tracksInNewViews.begin(), tracksInNewViews.end()), tracksInNewViews.end());
 
-                std::set<IndexT> allViewsSharingTheTrack;
-                std::transform(track.featPerView.begin(),
-                               track.featPerView.end(),
-                               std::inserter(allViewsSharingTheTrack, allViewsSharingTheTrack.begin()),
-                               stl::RetrieveKey());
+    // observations per track, each track writes its own slot (no lock)
+    std::vector<std::set<IndexT>> tracksObservations(tracksInNewViews.size());
 
-                std::set<IndexT> allReconstructedViewsSharingTheTrack;
-                std::set_intersection(allViewsSharingTheTrack.begin(),
-                                      allViewsSharingTheTrack.end(),
-                                      allReconstructedViews.begin(),
-                                      allReconstructedViews.end(),
-                                      std::inserter(allReconstructedViewsSharingTheTrack, allReconstructedViewsSharingTheTrack.begin()));
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (std::size_t i = 0; i < tracksInNewViews.size(); ++i)
+    {
+        const IndexT trackIndex = tracksInNewViews[i];
 
-                if (allReconstructedViewsSharingTheTrack.size() >= _params.minNbObservationsForTriangulation)
-                {
-#pragma omp critical
-                    mapTracksToTriangulate[trackId] = allReconstructedViewsSharingTheTrack;
-                }
-            }
+        // observations are sorted by view id
+        std::set<IndexT>& allReconstructedViewsSharingTheTrack = tracksObservations[i];
+        for (const track::TrackObservation& obs : _tracks.getObservations(trackIndex))
+        {
+            if (allReconstructedViews.count(obs.viewId))
+                allReconstructedViewsSharingTheTrack.insert(allReconstructedViewsSharingTheTrack.end(), obs.viewId);
         }
     }
+
+    for (std::size_t i = 0; i < tracksInNewViews.size(); ++i)
+    {
+        if (tracksObservations[i].size() >= _params.minNbObservationsForTriangulation)
+            mapTracksToTriangulate[_tracks.getTrackId(tracksInNewViews[i])] = std::move(tracksObservations[i]);
+    }
 }
 
 namespace {
 
-struct ObservationData
+/// data of a reconstructed view used by the triangulation, computed once per triangulation step
+struct TriangulationView
 {
-    std::shared_ptr<camera::Pinhole> cam;
+    std::shared_ptr<camera::IntrinsicBase> cam;  // nullptr if the camera is not pinhole
     Pose3 pose;
     Mat34 P;
-    Vec2 x;
-    Vec2 xUd;
-
-    bool isEmpty() const { return cam == nullptr; }
+    double acThreshold;
 };
 
-ObservationData getObservationData(const SfMData& scene, feature::FeaturesPerView* featuresPerView, IndexT viewId, const track::Track& track)
+/// per-thread scratch buffers of the multi-view triangulation, reused from one track to the next
+struct TriangulationScratch
 {
-    const View* view = scene.getViews().at(viewId).get();
-
-    std::shared_ptr<camera::IntrinsicBase> cam = scene.getIntrinsics().at(view->getIntrinsicId());
-    std::shared_ptr<camera::Pinhole> camPinHole = std::dynamic_pointer_cast<camera::Pinhole>(cam);
-
-    if (!camPinHole)
-    {
-        ALICEVISION_LOG_ERROR("Camera is not pinhole in triangulateMultiViewsLORANSAC");
-        return {nullptr, {}, {}, {}, {}};
-    }
-
-    Pose3 pose = scene.getPose(*view).getTransform();
-    Mat34 P = camPinHole->getProjectiveEquivalent(pose);
-
-    const auto& feature = featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId).featureId];
-    Vec2 x = feature.coords().cast<double>();
-    Vec2 xUd = cam->getUndistortedPixel(x);  // undistorted 2D point
-
-    return {camPinHole, pose, P, x, xUd};
-}
+    std::vector<IndexT> viewIds;
+    std::vector<Vec2> features;
+    std::vector<Mat34> Ps;
+    std::vector<std::size_t> inliersIndex;
+    std::mt19937 generator;
+};
 
 }  // namespace
 
@@ -1809,20 +1735,75 @@ void ReconstructionEngine_sequentialSfM::triangulateMultiViewsLORANSAC(SfMData&
     std::vector<IndexT> setTracksId;  // <trackId>
     std::transform(mapTracksToTriangulate.begin(), mapTracksToTriangulate.end(), std::inserter(setTracksId, setTracksId.begin()), stl::RetrieveKey());
 
-#pragma omp parallel for
-    for (int i = 0; i < setTracksId.size(); i++)  // each track (already reconstructed or not)
+    // -- Prepare the reconstructed views data once (instead of once per observation)
+    std::map<IndexT, TriangulationView> triangulationViews;
+    {
+        std::set<IndexT> allReconstructedViews = previousReconstructedViews;
+        allReconstructedViews.insert(newReconstructedViews.begin(), newReconstructedViews.end());
+
+        for (const IndexT viewId : allReconstructedViews)
+        {
+            const View& view = scene.getView(viewId);
+            TriangulationView& triangulationView = triangulationViews[viewId];
+
+            std::shared_ptr<camera::IntrinsicBase> cam = scene.getIntrinsics().at(view.getIntrinsicId());
+            std::shared_ptr<camera::Pinhole> camPinHole = std::dynamic_pointer_cast<camera::Pinhole>(cam);
+
+            triangulationView.pose = scene.getPose(view).getTransform();
+            const auto acThresholdIt = _map_ACThreshold.find(viewId);
+            triangulationView.acThreshold = (acThresholdIt != _map_ACThreshold.end()) ? acThresholdIt->second : 4.0;
+
+            if (!camPinHole)
+            {
+                ALICEVISION_LOG_ERROR("Camera is not pinhole in triangulateMultiViewsLORANSAC");
+                continue;
+            }
+
+            triangulationView.cam = cam;
+            triangulationView.P = camPinHole->getProjectiveEquivalent(triangulationView.pose);
+        }
+    }
+
+    // -- Group the tracks by number of observations (longest first) to balance the dynamic scheduling
+    std::vector<int> tracksOrder(setTracksId.size());
+    std::iota(tracksOrder.begin(), tracksOrder.end(), 0);
+    std::stable_sort(tracksOrder.begin(), tracksOrder.end(), [&](int a, int b) {
+        return mapTracksToTriangulate.at(setTracksId[a]).size() > mapTracksToTriangulate.at(setTracksId[b]).size();
+    });
+
+    // -- Triangulate, each track result is written to its own slot (no lock)
+    // a track is seeded from its id, so the LO-RANSAC result does not depend on the threads scheduling
+    const std::mt19937::result_type seed = _randomNumberGenerator();
+
+    std::vector<TriangulationScratch> scratches(omp_get_max_threads());
+    std::vector<Landmark> trackLandmarks(setTracksId.size());
+    std::vector<std::uint8_t> trackStatus(setTracksId.size(), 0);  // 0: skipped, 1: valid, 2: invalid
+
+#pragma omp parallel for schedule(dynamic, 64)
+    for (std::size_t k = 0; k < tracksOrder.size(); ++k)  // each track (already reconstructed or not)
     {
-        const IndexT trackId = setTracksId.at(i);
+        const int i = tracksOrder[k];
+        const IndexT trackId = setTracksId[i];
         bool isValidTrack = true;
-        const track::Track& track = _map_tracks.at(trackId);
-        std::set<IndexT>& observations = mapTracksToTriangulate.at(trackId);  // all the posed views possessing the track
+        const std::size_t trackIndex = _tracks.getTrackIndex(trackId);
+        const feature::EImageDescriberType descType = _tracks.getDescType(trackIndex);
+        const std::set<IndexT>& observations = mapTracksToTriangulate.at(trackId);  // all the posed views possessing the track
 
         // The track needs to be seen by a min. number of views to be triangulated
         if (observations.size() < _params.minNbObservationsForTriangulation)
             continue;
 
+        TriangulationScratch& scratch = scratches[omp_get_thread_num()];
+        scratch.viewIds.clear();
+        scratch.features.clear();
+        scratch.Ps.clear();
+        scratch.inliersIndex.clear();
+
+        const auto getFeature = [&](IndexT viewId) -> const feature::PointFeature& {
+            return _featuresPerView->getFeatures(viewId, descType)[_tracks.findObservation(trackIndex, viewId)->featureId];
+        };
+
         Vec3 X_euclidean = Vec3::Zero();
-        std::set<IndexT> inliers;
 
         if (observations.size() == 2)
         {
@@ -1830,37 +1811,34 @@ void ReconstructionEngine_sequentialSfM::triangulateMultiViewsLORANSAC(SfMData&
              *    2 observations : triangulation using DLT
              * -------------------------------------------- */
 
-            inliers = observations;
-
             // -- Prepare:
-            IndexT I = *(observations.begin());
-            IndexT J = *(observations.rbegin());
+            const IndexT I = *(observations.begin());
+            const IndexT J = *(observations.rbegin());
 
-            const auto oi = getObservationData(scene, _featuresPerView, I, track);
-            const auto oj = getObservationData(scene, _featuresPerView, J, track);
+            const TriangulationView& vi = triangulationViews.at(I);
+            const TriangulationView& vj = triangulationViews.at(J);
 
-            if (oi.isEmpty() || oj.isEmpty())
+            if (!vi.cam || !vj.cam)
             {
                 continue;
             }
 
+            const Vec2 xi = getFeature(I).coords().cast<double>();
+            const Vec2 xj = getFeature(J).coords().cast<double>();
+
+            scratch.viewIds = {I, J};
+
             // -- Triangulate:
-            multiview::TriangulateDLT(oi.P, oi.xUd, oj.P, oj.xUd, X_euclidean);
+            multiview::TriangulateDLT(vi.P, vi.cam->getUndistortedPixel(xi), vj.P, vj.cam->getUndistortedPixel(xj), X_euclidean);
 
             // -- Check:
             //  - angle (small angle leads imprecise triangulation)
             //  - positive depth
             //  - residual values
-            // TODO assert(acThresholdIt != _map_ACThreshold.end());
-            const auto& acThresholdItI = _map_ACThreshold.find(I);
-            const auto& acThresholdItJ = _map_ACThreshold.find(J);
-            const double& acThresholdI = (acThresholdItI != _map_ACThreshold.end()) ? acThresholdItI->second : 4.0;
-            const double& acThresholdJ = (acThresholdItJ != _map_ACThreshold.end()) ? acThresholdItJ->second : 4.0;
-
-            if (angleBetweenRays(oi.pose, oi.cam.get(), oj.pose, oj.cam.get(), oi.x, oj.x) < _params.minAngleForTriangulation ||
-                oi.pose.depth(X_euclidean) < 0 || oj.pose.depth(X_euclidean) < 0 ||
-                oi.cam->residual(oi.pose, X_euclidean.homogeneous(), oi.x).norm() > acThresholdI ||
-                oj.cam->residual(oj.pose, X_euclidean.homogeneous(), oj.x).norm() > acThresholdJ)
+            if (angleBetweenRays(vi.pose, vi.cam.get(), vj.pose, vj.cam.get(), xi, xj) < _params.minAngleForTriangulation ||
+                vi.pose.depth(X_euclidean) < 0 || vj.pose.depth(X_euclidean) < 0 ||
+                vi.cam->residual(vi.pose, X_euclidean.homogeneous(), xi).norm() > vi.acThreshold ||
+                vj.cam->residual(vj.pose, X_euclidean.homogeneous(), xj).norm() > vj.acThreshold)
                 isValidTrack = false;
         }
         else
@@ -1870,75 +1848,96 @@ void ReconstructionEngine_sequentialSfM::triangulateMultiViewsLORANSAC(SfMData&
              * ------------------------------------------------------- */
 
             // -- Prepare:
-            std::vector<Vec2> features;  // undistorted 2D features (one per pose)
-            std::vector<Mat34> Ps;       // projective matrices (one per pose)
+            for (const IndexT viewId : observations)
             {
-                const track::Track& track = _map_tracks.at(trackId);
+                const TriangulationView& v = triangulationViews.at(viewId);
 
-                int i = 0;
-                for (const IndexT& viewId : observations)
+                if (!v.cam)
                 {
-                    const auto o = getObservationData(scene, _featuresPerView, viewId, track);
-
-                    if (o.isEmpty())
-                    {
-                        continue;
-                    }
-
-                    features.push_back(o.xUd);
-                    Ps.push_back(o.P);
-                    i++;
+                    continue;
                 }
+
+                scratch.viewIds.push_back(viewId);
+                scratch.features.push_back(v.cam->getUndistortedPixel(getFeature(viewId).coords().cast<double>()));
+                scratch.Ps.push_back(v.P);
             }
 
             // -- Triangulate:
             Vec4 X_homogeneous = Vec4::Zero();
-            std::vector<std::size_t> inliersIndex;
+            scratch.generator.seed(seed + trackId);
 
-            multiview::TriangulateNViewLORANSAC(features, Ps, _randomNumberGenerator, X_homogeneous, &inliersIndex, 8.0);
+            multiview::TriangulateNViewLORANSAC(scratch.features, scratch.Ps, scratch.generator, X_homogeneous, &scratch.inliersIndex, 8.0);
 
             homogeneousToEuclidean(X_homogeneous, X_euclidean);
 
             // observations = {350, 380, 442} | inliersIndex = [0, 1] | inliers = {350, 380}
-            for (const auto& id : inliersIndex)
-                inliers.insert(*std::next(observations.begin(), id));
+            for (std::size_t j = 0; j < scratch.inliersIndex.size(); ++j)
+                scratch.viewIds[j] = scratch.viewIds[scratch.inliersIndex[j]];
+            scratch.viewIds.resize(scratch.inliersIndex.size());
 
             // -- Check:
             //  - nb of cameras validing the track
             //  - angle (small angle leads imprecise triangulation)
             //  - positive depth (chierality)
-            if (inliers.size() < _params.minNbObservationsForTriangulation ||
-                !checkAngles(X_euclidean, inliers, scene, _params.minAngleForTriangulation) || !checkChieralities(X_euclidean, inliers, scene))
+            const auto checkAngles = [&]() {
+                for (std::size_t a = 0; a < scratch.viewIds.size(); ++a)
+                {
+                    for (std::size_t b = a + 1; b < scratch.viewIds.size(); ++b)
+                    {
+                        const Pose3& poseA = triangulationViews.at(scratch.viewIds[a]).pose;
+                        const Pose3& poseB = triangulationViews.at(scratch.viewIds[b]).pose;
+                        if (angleBetweenRays(poseA, poseB, X_euclidean) >= _params.minAngleForTriangulation)
+                            return true;
+                    }
+                }
+                return false;
+            };
+
+            const auto checkChieralities = [&]() {
+                return std::all_of(scratch.viewIds.begin(), scratch.viewIds.end(), [&](IndexT viewId) {
+                    return triangulationViews.at(viewId).pose.depth(X_euclidean) >= 0;
+                });
+            };
+
+            if (scratch.viewIds.size() < _params.minNbObservationsForTriangulation || !checkAngles() || !checkChieralities())
                 isValidTrack = false;
         }
 
-        // -- Add the tringulated point to the scene
-        if (isValidTrack)
+        if (!isValidTrack)
         {
-            Landmark landmark;
-            landmark.X = X_euclidean;
-            landmark.descType = track.descType;
-            for (const IndexT& viewId : inliers)  // add inliers as observations
-            {
-                const Vec2 x = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId).featureId].coords().cast<double>();
-                const feature::PointFeature& p = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId).featureId];
-                const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : p.scale();
-                landmark.getObservations()[viewId] = Observation(x, track.featPerView.at(viewId).featureId, scale);
-            }
-#pragma omp critical
-            {
-                scene.getLandmarks()[trackId] = landmark;
-            }
+            trackStatus[i] = 2;
+            continue;
         }
-        else
+
+        // -- Build the tringulated point
+        Landmark& landmark = trackLandmarks[i];
+        landmark.X = X_euclidean;
+        landmark.descType = descType;
+        for (const IndexT viewId : scratch.viewIds)  // add inliers as observations
         {
-#pragma omp critical
-            {
-                if (scene.getLandmarks().find(trackId) != scene.getLandmarks().end())
-                    scene.getLandmarks().erase(trackId);
-            }
+            const IndexT featureId = _tracks.findObservation(trackIndex, viewId)->featureId;
+            const feature::PointFeature& p = _featuresPerView->getFeatures(viewId, descType)[featureId];
+            const Vec2 x = p.coords().cast<double>();
+            const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : p.scale();
+            landmark.getObservations()[viewId] = Observation(x, featureId, scale);
         }
+        trackStatus[i] = 1;
     }  // for all shared tracks
+
+    // -- Merge the triangulated points into the scene
+    for (std::size_t i = 0; i < setTracksId.size(); ++i)
+    {
+        if (trackStatus[i] == 1)
+        {
+            scene.getLandmarks()[setTracksId[i]] = std::move(trackLandmarks[i]);
+            setLandmarkReconstructed(setTracksId[i], true);
+        }
+        else if (trackStatus[i] == 2)
+        {
+            scene.getLandmarks().erase(setTracksId[i]);
+            setLandmarkReconstructed(setTracksId[i], false);
+        }
+    }
 }
 
 void ReconstructionEngine_sequentialSfM::triangulate2Views(SfMData& scene,
@@ -1978,7 +1977,7 @@ void ReconstructionEngine_sequentialSfM::triangulate2Views(SfMData& scene,
             // Find track correspondences between I and J
             const std::set<std::size_t> set_viewIndex = {I, J};
             track::TracksMap map_tracksCommonIJ;
-            track::getCommonTracksInImagesFast(set_viewIndex, _map_tracks, _map_tracksPerView, map_tracksCommonIJ);
+            _tracks.getCommonTracks(set_viewIndex, map_tracksCommonIJ);
 
             const View* viewI = scene.getViews().at(I).get();
             const View* viewJ = scene.getViews().at(J).get();
@@ -2100,6 +2099,7 @@ void ReconstructionEngine_sequentialSfM::triangulate2Views(SfMData& scene,
                             const double scaleJ = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : featJ.scale();
                             landmark.getObservations()[I] = Observation(xI, track.featPerView.at(I).featureId, scaleI);
                             landmark.getObservations()[J] = Observation(xJ, track.featPerView.at(J).featureId, scaleJ);
+                            setLandmarkReconstructed(trackId, true);
 
                             ++new_added_track;
                         }  // critical
@@ -2119,11 +2119,11 @@ void ReconstructionEngine_sequentialSfM::triangulate2Views(SfMData& scene,
     }
 }
 
-std::size_t ReconstructionEngine_sequentialSfM::removeOutliers()
+std::size_t ReconstructionEngine_sequentialSfM::removeOutliers(std::set<IndexT>* outRemovedLandmarksId)
 {
     const std::size_t nbOutliersResidualErr =
-      removeOutliersWithPixelResidualError(_sfmData, _params.featureConstraint, _params.maxReprojectionError, 2);
-    const std::size_t nbOutliersAngleErr = removeOutliersWithAngleError(_sfmData, _params.minAngleForLandmark);
+      removeOutliersWithPixelResidualError(_sfmData, _params.featureConstraint, _params.maxReprojectionError, 2, outRemovedLandmarksId);
+    const std::size_t nbOutliersAngleErr = removeOutliersWithAngleError(_sfmData, _params.minAngleForLandmark, outRemovedLandmarksId);
 
     ALICEVISION_LOG_INFO("Remove outliers: " << std::endl
                                              << "\t- # outliers residual error: " << nbOutliersResidualErr << std::endl
@@ -2132,5 +2132,15 @@ std::size_t ReconstructionEngine_sequentialSfM::removeOutliers()
     return nbOutliersResidualErr + nbOutliersAngleErr;
 }
 
+void ReconstructionEngine_sequentialSfM::setLandmarkReconstructed(IndexT landmarkId, bool reconstructed)
+{
+    if (_nextBestViewScores == nullptr)
+        return;
+
+    const std::size_t trackIndex = _tracks.getTrackIndex(landmarkId);
+    if (trackIndex != track::TracksStorage::invalidIndex)
+        _nextBestViewScores->setTrackReconstructed(trackIndex, reconstructed);
+}
+
 }  // namespace sfm
 }  // namespace aliceVision
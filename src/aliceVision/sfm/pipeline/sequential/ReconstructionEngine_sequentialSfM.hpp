@@ -12,15 +12,18 @@
 #include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
 #include <aliceVision/sfm/pipeline/pairwiseMatchesIO.hpp>
 #include <aliceVision/sfm/pipeline/RigSequence.hpp>
+#include <aliceVision/sfm/pipeline/sequential/NextBestViewScores.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/feature/FeaturesPerView.hpp>
 #include <aliceVision/track/TracksBuilder.hpp>
+#include <aliceVision/track/TracksStorage.hpp>
 #include <dependencies/htmlDoc/htmlDoc.hpp>
 #include <aliceVision/utils/Histogram.hpp>
 
 #include <boost/property_tree/ptree.hpp>
 
 #include <filesystem>
+#include <memory>
 
 namespace pt = boost::property_tree;
 
@@ -32,6 +35,8 @@ namespace fs = std::filesystem;
 /// Image score contains <ImageId, NbPutativeCommonPoint, score, isIntrinsicsReconstructed>
 typedef std::tuple<IndexT, std::size_t, std::size_t, bool> ViewConnectionScore;
 
+class BundleAdjustmentCeres;
+
 /**
  * @brief Sequential SfM Pipeline Reconstruction Engine.
  */
@@ -200,12 +205,13 @@ class ReconstructionEngine_sequentialSfM : public ReconstructionEngine
      * @brief Return all the images containing matches with already reconstructed 3D points.
      * The images are sorted by a score based on the number of features id shared with
      * the reconstruction and the repartition of these points in the image.
+     * The scores are updated incrementally with the landmarks changes since the previous call.
      *
      * @param[out] out_connectedViews: output list of view IDs connected with the 3D reconstruction.
      * @param[in] remainingViewIds: input list of remaining view IDs in which we will search for connected views.
      * @return False if there is no view connected.
      */
-    bool findConnectedViews(std::vector<ViewConnectionScore>& out_connectedViews, const std::set<IndexT>& remainingViewIds) const;
+    bool findConnectedViews(std::vector<ViewConnectionScore>& out_connectedViews, const std::set<IndexT>& remainingViewIds);
 
     /**
      * @brief Estimate the best images on which we can compute the resectioning safely.
@@ -216,7 +222,7 @@ class ReconstructionEngine_sequentialSfM : public ReconstructionEngine
      * @param[in] remainingViewIds: input list of remaining view IDs in which we will search for the best ones for resectioning.
      * @return False if there is no possible resection.
      */
-    bool findNextBestViews(std::vector<IndexT>& out_selectedViewIds, const std::set<IndexT>& remainingViewIds) const;
+    bool findNextBestViews(std::vector<IndexT>& out_selectedViewIds, const std::set<IndexT>& remainingViewIds);
 
   private:
     struct ResectionData : ImageLocalizerMatchData
@@ -301,25 +307,6 @@ class ReconstructionEngine_sequentialSfM : public ReconstructionEngine
                                        const std::set<IndexT>& previousReconstructedViews,
                                        const std::set<IndexT>& newReconstructedViews);
 
-    /**
-     * @brief Check if a 3D points is well located in front of a set of views.
-     * @param[in] pt3D A 3D point (euclidian coordinates)
-     * @param[in] viewsId A set of views index
-     * @param[in] scene All the data about the 3D reconstruction.
-     * @return false if the 3D points is located behind one view (or more), else \c true.
-     */
-    bool checkChieralities(const Vec3& pt3D, const std::set<IndexT>& viewsId, const sfmData::SfMData& scene);
-
-    /**
-     * @brief Check if the maximal angle formed by a 3D points and 2 views exceeds a min. angle, among a set of views.
-     * @param[in] pt3D A 3D point (euclidian coordinates)
-     * @param[in] viewsId A set of views index
-     * @param[in] scene All the data about the 3D reconstruction.
-     * @param[in] kMinAngle The angle limit.
-     * @return false if the maximal angle does not exceed the limit, else \c true.
-     */
-    bool checkAngles(const Vec3& pt3D, const std::set<IndexT>& viewsId, const sfmData::SfMData& scene, const double& kMinAngle);
-
     /**
      * @brief Select the candidate tracks for the next triangulation step.
      * @details A track is considered as triangulable if it is visible by at least one new reconsutructed
@@ -346,10 +333,17 @@ class ReconstructionEngine_sequentialSfM : public ReconstructionEngine
      * - too large residual error
      * - too small angular value
      *
-     * @param[in] precision
+     * @param[out] outRemovedLandmarksId the ids of the removed landmarks, if not NULL
      * @return number of removed outliers
      */
-    std::size_t removeOutliers();
+    std::size_t removeOutliers(std::set<IndexT>* outRemovedLandmarksId = NULL);
+
+    /**
+     * @brief Report a landmark added or removed to the next best view scores.
+     * @param[in] landmarkId the landmark id (landmarkId == trackId)
+     * @param[in] reconstructed true if the landmark has been added, false if it has been removed
+     */
+    void setLandmarkReconstructed(IndexT landmarkId, bool reconstructed);
 
   private:
     // Parameters
@@ -368,15 +362,17 @@ class ReconstructionEngine_sequentialSfM : public ReconstructionEngine
     /// internal cache of precomputed values for the weighting of the pyramid levels
     std::vector<int> _pyramidWeights;
     int _pyramidThreshold;
+    /// total number of cells in all the levels of the pyramid
+    std::size_t _pyramidNbCells = 0;
 
     // Temporary data
 
     /// Putative landmark tracks (visibility per potential 3D point)
-    track::TracksMap _map_tracks;
-    /// Putative tracks per view
-    track::TracksPerView _map_tracksPerView;
-    /// Precomputed pyramid index for each trackId of each viewId.
-    track::TracksPyramidPerView _map_featsPyramidPerView;
+    track::TracksStorage _tracks;
+    /// Precomputed pyramid cell index for each track observation (pyramidDepth values per observation of _tracks)
+    std::vector<IndexT> _tracksPyramidCells;
+    /// Per view reconstructed tracks counters and pyramid occupancy, for the next best views selection
+    std::unique_ptr<NextBestViewScores> _nextBestViewScores;
     /// Per camera confidence (A contrario estimated threshold error)
     std::map<IndexT, double> _map_ACThreshold;
 
@@ -385,6 +381,11 @@ class ReconstructionEngine_sequentialSfM : public ReconstructionEngine
     /// Contains all the data used by the Local BA approach
     std::shared_ptr<LocalBundleAdjustmentGraph> _localStrategyGraph;
 
+    // Bundle Adjustment data
+
+    /// Bundle adjustment engine, its Ceres problem is kept between the calls to bundleAdjustment
+    std::shared_ptr<BundleAdjustmentCeres> _bundleAdjustment;
+
     // Log
 
     /// sfm intermediate reconstruction files
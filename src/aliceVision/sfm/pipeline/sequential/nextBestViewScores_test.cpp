@@ -0,0 +1,147 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfm/pipeline/sequential/NextBestViewScores.hpp>
+
+#include <random>
+#include <set>
+#include <vector>
+
+#define BOOST_TEST_MODULE nextBestViewScores
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+
+namespace {
+
+/// reference pyramid score of a view, recomputed from scratch
+std::size_t bruteForceScore(const track::TracksStorage& tracks,
+                            const std::vector<IndexT>& tracksPyramidCells,
+                            const std::vector<int>& pyramidWeights,
+                            std::size_t pyramidNbCells,
+                            const sfmData::Landmarks& landmarks,
+                            IndexT viewId,
+                            std::size_t& out_nbReconstructedTracks)
+{
+    std::vector<char> isCellUsed(pyramidNbCells, 0);
+    std::size_t score = 0;
+    out_nbReconstructedTracks = 0;
+
+    for (const IndexT trackIndex : tracks.getViewTrackIndexes(viewId))
+    {
+        if (!landmarks.count(tracks.getTrackId(trackIndex)))
+            continue;
+
+        ++out_nbReconstructedTracks;
+        const IndexT* cells = &tracksPyramidCells[tracks.getObservationIndex(trackIndex, viewId) * pyramidWeights.size()];
+        for (std::size_t level = 0; level < pyramidWeights.size(); ++level)
+        {
+            if (isCellUsed[cells[level]])
+                continue;
+            isCellUsed[cells[level]] = 1;
+            score += pyramidWeights[level];
+        }
+    }
+    return score;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(NextBestViewScores_incrementalUpdate)
+{
+    const std::size_t nbViews = 8;
+    const std::size_t nbTracks = 500;
+    const std::vector<int> pyramidWeights = {4, 2, 1};
+    const std::vector<std::size_t> pyramidSides = {2, 4, 8};
+    const std::size_t pyramidNbCells = 4 + 16 + 64;
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<std::size_t> viewDistribution(0, nbViews - 1);
+    std::uniform_real_distribution<double> coordDistribution(0.0, 1.0);
+
+    track::TracksMap tracksMap;
+    for (std::size_t trackId = 0; trackId < nbTracks; ++trackId)
+    {
+        track::Track& track = tracksMap[trackId];
+        while (track.featPerView.size() < 3)
+        {
+            track::TrackItem item;
+            item.featureId = trackId;
+            item.coords = Vec2(coordDistribution(generator), coordDistribution(generator));
+            item.scale = 1.0;
+            track.featPerView[viewDistribution(generator)] = item;
+        }
+    }
+
+    const track::TracksStorage tracks(tracksMap);
+
+    // pyramid cells from the normalized coordinates of the observations
+    std::vector<IndexT> tracksPyramidCells;
+    tracksPyramidCells.reserve(tracks.nbObservations() * pyramidWeights.size());
+    for (std::size_t trackIndex = 0; trackIndex < tracks.nbTracks(); ++trackIndex)
+    {
+        for (const track::TrackObservation& obs : tracks.getObservations(trackIndex))
+        {
+            std::size_t levelOffset = 0;
+            for (const std::size_t side : pyramidSides)
+            {
+                const std::size_t cx = std::size_t(obs.x * side);
+                const std::size_t cy = std::size_t(obs.y * side);
+                tracksPyramidCells.push_back(levelOffset + cy * side + cx);
+                levelOffset += side * side;
+            }
+        }
+    }
+
+    NextBestViewScores scores(tracks, tracksPyramidCells, pyramidWeights, pyramidNbCells);
+
+    std::set<IndexT> remainingViewIds;
+    for (IndexT viewId = 0; viewId < nbViews; ++viewId)
+        remainingViewIds.insert(viewId);
+
+    sfmData::Landmarks landmarks;
+    std::uniform_int_distribution<std::size_t> trackDistribution(0, nbTracks - 1);
+
+    for (int iteration = 0; iteration < 20; ++iteration)
+    {
+        // add and remove some landmarks (a track may be added or removed twice)
+        for (int i = 0; i < 40; ++i)
+        {
+            const IndexT trackId = trackDistribution(generator);
+            landmarks[trackId] = sfmData::Landmark();
+            scores.setTrackReconstructed(tracks.getTrackIndex(trackId), true);
+        }
+        for (int i = 0; i < 10; ++i)
+        {
+            const IndexT trackId = trackDistribution(generator);
+            landmarks.erase(trackId);
+            scores.setTrackReconstructed(tracks.getTrackIndex(trackId), false);
+        }
+
+        // a view is reconstructed from time to time
+        if (iteration % 4 == 3)
+            remainingViewIds.erase(remainingViewIds.begin());
+
+        scores.setCandidateViews(remainingViewIds);
+
+        for (IndexT viewId = 0; viewId < nbViews; ++viewId)
+        {
+            std::size_t nbReconstructedTracks = 0;
+            const std::size_t expectedScore =
+              bruteForceScore(tracks, tracksPyramidCells, pyramidWeights, pyramidNbCells, landmarks, viewId, nbReconstructedTracks);
+
+            BOOST_CHECK_EQUAL(scores.getNbReconstructedTracks(viewId), nbReconstructedTracks);
+            BOOST_CHECK_EQUAL(scores.getScore(viewId), remainingViewIds.count(viewId) ? expectedScore : 0);
+        }
+    }
+
+    // the reconstructed state of each track follows the landmarks
+    for (std::size_t trackIndex = 0; trackIndex < tracks.nbTracks(); ++trackIndex)
+        BOOST_CHECK_EQUAL(scores.isTrackReconstructed(trackIndex), landmarks.count(tracks.getTrackId(trackIndex)) > 0);
+}
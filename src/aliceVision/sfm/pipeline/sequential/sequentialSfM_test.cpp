@@ -9,7 +9,9 @@
 #include <aliceVision/sfm/utils/statistics.hpp>
 #include <aliceVision/sfm/utils/syntheticScene.hpp>
 #include <aliceVision/sfm/sfm.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <iostream>
@@ -180,3 +182,79 @@ BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Known_Rig)
     BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getPoses().size(), nbPoses);
     BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getLandmarks().size(), nbPoints);
 }
+
+// Triangulate the tracks of a scene with known poses with one and several threads,
+// the landmarks must be the same (tracks are triangulated in parallel, LO-RANSAC is seeded per track)
+BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Triangulation_Thread_Count_Invariance)
+{
+    const int nviews = 6;
+    const int npoints = 512;
+    const NViewDatasetConfigurator config;
+    const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+    // Translate the input dataset to a SfMData scene
+    const SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA, EDISTORTION::DISTORTION_NONE);
+
+    // Keep the poses, remove the structure
+    SfMData sfmData2 = sfmData;
+    sfmData2.getLandmarks().clear();
+
+    // Add noise in 2D observations, so that the LO-RANSAC result depends on its random samples
+    std::normal_distribution<double> distribution(0.0, 2.0);
+
+    feature::FeaturesPerView featuresPerView;
+    generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+    matching::PairwiseMatches pairwiseMatches;
+    generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+    const std::set<IndexT> viewIds = sfmData2.getValidViews();
+    BOOST_REQUIRE_EQUAL(viewIds.size(), nviews);
+
+    const int maxNbThreads = omp_get_max_threads();
+    std::vector<Landmarks> landmarksPerThreadCount;
+
+    for (const int nbThreads : {1, std::max(4, maxNbThreads)})
+    {
+        omp_set_num_threads(nbThreads);
+
+        ReconstructionEngine_sequentialSfM::Params sfmParams;
+        ReconstructionEngine_sequentialSfM sfmEngine(sfmData2, sfmParams, "./", "./Reconstruction_Report.html");
+        sfmEngine.initRandomSeed(42);
+        sfmEngine.setFeatures(&featuresPerView);
+        sfmEngine.setMatches(&pairwiseMatches);
+        sfmEngine.initializePyramidScoring();
+        BOOST_REQUIRE_GT(sfmEngine.fuseMatchesIntoTracks(), 0);
+
+        // multi-view LO-RANSAC triangulation
+        sfmEngine.triangulate({}, viewIds);
+        landmarksPerThreadCount.push_back(sfmEngine.getSfMData().getLandmarks());
+    }
+
+    omp_set_num_threads(maxNbThreads);
+
+    const Landmarks& landmarks = landmarksPerThreadCount.front();
+    const Landmarks& otherLandmarks = landmarksPerThreadCount.back();
+
+    BOOST_CHECK_GT(landmarks.size(), npoints / 2);
+    BOOST_REQUIRE_EQUAL(landmarks.size(), otherLandmarks.size());
+
+    for (const auto& landmarkPair : landmarks)
+    {
+        const auto otherIt = otherLandmarks.find(landmarkPair.first);
+        BOOST_REQUIRE(otherIt != otherLandmarks.end());
+
+        const Landmark& landmark = landmarkPair.second;
+        const Landmark& otherLandmark = otherIt->second;
+
+        BOOST_CHECK(landmark.X == otherLandmark.X);
+        BOOST_REQUIRE_EQUAL(landmark.getObservations().size(), otherLandmark.getObservations().size());
+
+        for (const auto& observationPair : landmark.getObservations())
+        {
+            const auto otherObservationIt = otherLandmark.getObservations().find(observationPair.first);
+            BOOST_REQUIRE(otherObservationIt != otherLandmark.getObservations().end());
+            BOOST_CHECK_EQUAL(observationPair.second.getFeatureId(), otherObservationIt->second.getFeatureId());
+        }
+    }
+}
@@ -19,7 +19,8 @@ namespace sfm {
 IndexT removeOutliersWithPixelResidualError(sfmData::SfMData& sfmData,
                                             EFeatureConstraint featureConstraint,
                                             const double dThresholdPixel,
-                                            const unsigned int minTrackLength)
+                                            const unsigned int minTrackLength,
+                                            std::set<IndexT>* outRemovedLandmarksId)
 {
     IndexT outlierCount = 0;
     sfmData::Landmarks::iterator iterTracks = sfmData.getLandmarks().begin();
@@ -53,14 +54,18 @@ IndexT removeOutliersWithPixelResidualError(sfmData::SfMData& sfmData,
         }
 
         if (observations.empty() || observations.size() < minTrackLength)
+        {
+            if (outRemovedLandmarksId != NULL)
+                outRemovedLandmarksId->insert(iterTracks->first);
             iterTracks = sfmData.getLandmarks().erase(iterTracks);
+        }
         else
             ++iterTracks;
     }
     return outlierCount;
 }
 
-IndexT removeOutliersWithAngleError(sfmData::SfMData& sfmData, const double dMinAcceptedAngle)
+IndexT removeOutliersWithAngleError(sfmData::SfMData& sfmData, const double dMinAcceptedAngle, std::set<IndexT>* outRemovedLandmarksId)
 {
     // note that smallest accepted angle => largest accepted cos(angle)
     const double dMaxAcceptedCosAngle = std::cos(degreeToRadian(dMinAcceptedAngle));
@@ -149,6 +154,9 @@ IndexT removeOutliersWithAngleError(sfmData::SfMData& sfmData, const double dMin
         sfmData.getLandmarks().erase(key);
     }
 
+    if (outRemovedLandmarksId != NULL)
+        outRemovedLandmarksId->insert(toErase.begin(), toErase.end());
+
     return toErase.size();
 }
 
@@ -213,7 +221,7 @@ bool eraseUnstablePoses(sfmData::SfMData& sfmData, const IndexT minPointsPerPose
     return removedElements > 0;
 }
 
-bool eraseObservationsWithMissingPoses(sfmData::SfMData& sfmData, const IndexT minPointsPerLandmark)
+bool eraseObservationsWithMissingPoses(sfmData::SfMData& sfmData, const IndexT minPointsPerLandmark, std::set<IndexT>* outRemovedLandmarksId)
 {
     IndexT removedElements = 0;
 
@@ -246,7 +254,11 @@ bool eraseObservationsWithMissingPoses(sfmData::SfMData& sfmData, const IndexT m
         }
 
         if (observations.empty() || observations.size() < minPointsPerLandmark)
+        {
+            if (outRemovedLandmarksId != NULL)
+                outRemovedLandmarksId->insert(itLandmarks->first);
             itLandmarks = sfmData.getLandmarks().erase(itLandmarks);
+        }
         else
             ++itLandmarks;
     }
@@ -257,7 +269,8 @@ bool eraseObservationsWithMissingPoses(sfmData::SfMData& sfmData, const IndexT m
 bool eraseUnstablePosesAndObservations(sfmData::SfMData& sfmData,
                                        const IndexT minPointsPerPose,
                                        const IndexT minPointsPerLandmark,
-                                       std::set<IndexT>* outRemovedViewsId)
+                                       std::set<IndexT>* outRemovedViewsId,
+                                       std::set<IndexT>* outRemovedLandmarksId)
 {
     IndexT removeIteration = 0;
     bool removedContent = false;
@@ -269,7 +282,7 @@ bool eraseUnstablePosesAndObservations(sfmData::SfMData& sfmData,
         if (eraseUnstablePoses(sfmData, minPointsPerPose, outRemovedViewsId))
         {
             removedPoses = true;
-            removedContent = eraseObservationsWithMissingPoses(sfmData, minPointsPerLandmark);
+            removedContent = eraseObservationsWithMissingPoses(sfmData, minPointsPerLandmark, outRemovedLandmarksId);
             if (removedContent)
                 removedObservations = true;
             // Erase some observations can make some Poses index disappear so perform the process in a loop
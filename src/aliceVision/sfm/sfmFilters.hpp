@@ -33,24 +33,29 @@ inline PairSet filterPairs(const IterablePairs& pairs, const IterableIndex& inde
 
 /// Remove observations with too large reprojection error.
 /// Return the number of removed tracks.
+/// The ids of the erased landmarks are added to outRemovedLandmarksId if not NULL.
 IndexT removeOutliersWithPixelResidualError(sfmData::SfMData& sfmData,
                                             EFeatureConstraint featureConstraint,
                                             const double dThresholdPixel,
-                                            const unsigned int minTrackLength = 2);
+                                            const unsigned int minTrackLength = 2,
+                                            std::set<IndexT>* outRemovedLandmarksId = NULL);
 
 // Remove tracks that have a small angle (tracks with tiny angle leads to instable 3D points)
 // Return the number of removed tracks
-IndexT removeOutliersWithAngleError(sfmData::SfMData& sfmData, const double dMinAcceptedAngle);
+IndexT removeOutliersWithAngleError(sfmData::SfMData& sfmData, const double dMinAcceptedAngle, std::set<IndexT>* outRemovedLandmarksId = NULL);
 
 bool eraseUnstablePoses(sfmData::SfMData& sfmData, const IndexT minPointsPerPose, std::set<IndexT>* outRemovedViewsId = NULL);
 
-bool eraseObservationsWithMissingPoses(sfmData::SfMData& sfmData, const IndexT minPointsPerLandmark);
+bool eraseObservationsWithMissingPoses(sfmData::SfMData& sfmData,
+                                       const IndexT minPointsPerLandmark,
+                                       std::set<IndexT>* outRemovedLandmarksId = NULL);
 
 /// Remove unstable content from analysis of the sfm_data structure
 bool eraseUnstablePosesAndObservations(sfmData::SfMData& sfmData,
                                        const IndexT minPointsPerPose = 6,
                                        const IndexT minPointsPerLandmark = 2,
-                                       std::set<IndexT>* outRemovedViewsId = NULL);
+                                       std::set<IndexT>* outRemovedViewsId = NULL,
+                                       std::set<IndexT>* outRemovedLandmarksId = NULL);
 
 }  // namespace sfm
 }  // namespace aliceVision
@@ -0,0 +1,238 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LandmarksStorage.hpp"
+#include <aliceVision/system/AlignedStream.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace sfmData {
+
+void LandmarksStorage::build(const Landmarks& landmarks)
+{
+    clear();
+
+    std::size_t nbObservations = 0;
+    for (const auto& landmarkIt : landmarks)
+        nbObservations += landmarkIt.second.getObservations().size();
+
+    _ownedLandmarkIds.reserve(landmarks.size());
+    _ownedPositions.reserve(3 * landmarks.size());
+    _ownedColors.reserve(3 * landmarks.size());
+    _ownedDescTypes.reserve(landmarks.size());
+    _ownedStates.reserve(landmarks.size());
+    _ownedObservationOffsets.reserve(landmarks.size() + 1);
+    _ownedViewIds.reserve(nbObservations);
+    _ownedFeatureIds.reserve(nbObservations);
+    _ownedCoords.reserve(2 * nbObservations);
+    _ownedScales.reserve(nbObservations);
+
+    for (const auto& landmarkIt : landmarks)
+    {
+        const Landmark& landmark = landmarkIt.second;
+
+        _ownedLandmarkIds.push_back(landmarkIt.first);
+        _ownedPositions.insert(_ownedPositions.end(), {landmark.X(0), landmark.X(1), landmark.X(2)});
+        _ownedColors.insert(_ownedColors.end(), {landmark.rgb.r(), landmark.rgb.g(), landmark.rgb.b()});
+        _ownedDescTypes.push_back(static_cast<std::uint32_t>(landmark.descType));
+        _ownedStates.push_back(static_cast<std::uint8_t>(landmark.state));
+
+        for (const auto& obsIt : landmark.getObservations())
+        {
+            _ownedViewIds.push_back(obsIt.first);
+            _ownedFeatureIds.push_back(obsIt.second.getFeatureId());
+            _ownedCoords.push_back(obsIt.second.getX());
+            _ownedCoords.push_back(obsIt.second.getY());
+            _ownedScales.push_back(obsIt.second.getScale());
+        }
+        _ownedObservationOffsets.push_back(_ownedViewIds.size());
+    }
+
+    _nbLandmarks = landmarks.size();
+    _nbObservations = nbObservations;
+    setOwnedColumns();
+}
+
+void LandmarksStorage::open(const std::string& path)
+{
+    clear();
+    _file.open(path);
+
+    LandmarksBinaryHeader header;
+    if (_file.size() < sizeof(LandmarksBinaryHeader))
+        throw std::runtime_error("Can't load landmarks file, '" + path + "' is too small !");
+    std::memcpy(&header, _file.data(), sizeof(LandmarksBinaryHeader));
+
+    if (std::memcmp(header.magic, LandmarksBinaryHeader::magicNumber, sizeof(header.magic)) != 0)
+        throw std::runtime_error("Can't load landmarks file, '" + path + "' is not a binary landmarks file !");
+    if (header.version > LandmarksBinaryHeader::currentVersion)
+        throw std::runtime_error("Can't load landmarks file, '" + path + "' has an unsupported version (" + std::to_string(header.version) +
+                                 ") !");
+
+    // check that all the sections are inside the file
+    // (the counts are bounded by the file size first, so that the section sizes cannot overflow)
+    const std::uint64_t nbLandmarks = header.nbLandmarks;
+    const std::uint64_t nbObservations = header.nbObservations;
+    if (nbLandmarks > _file.size() || nbObservations > _file.size())
+    {
+        clear();
+        throw std::runtime_error("Can't load landmarks file, '" + path + "' is truncated or corrupted !");
+    }
+    const std::uint64_t sectionSizes[LandmarksBinaryHeader::NB_SECTIONS] = {
+      nbLandmarks * sizeof(IndexT),
+      nbLandmarks * 3 * sizeof(double),
+      nbLandmarks * 3 * sizeof(std::uint8_t),
+      nbLandmarks * sizeof(std::uint32_t),
+      nbLandmarks * sizeof(std::uint8_t),
+      (nbLandmarks + 1) * sizeof(std::uint64_t),
+      nbObservations * sizeof(IndexT),
+      nbObservations * sizeof(IndexT),
+      nbObservations * 2 * sizeof(double),
+      nbObservations * sizeof(double),
+    };
+    for (int s = 0; s < LandmarksBinaryHeader::NB_SECTIONS; ++s)
+    {
+        if (header.sectionOffsets[s] % 8 != 0 || header.sectionOffsets[s] > _file.size() ||
+            sectionSizes[s] > _file.size() - header.sectionOffsets[s])
+        {
+            clear();
+            throw std::runtime_error("Can't load landmarks file, '" + path + "' is truncated or corrupted !");
+        }
+    }
+
+    _landmarkIds = section<IndexT>(header, LandmarksBinaryHeader::LANDMARK_IDS);
+    _positions = section<double>(header, LandmarksBinaryHeader::POSITIONS);
+    _colors = section<std::uint8_t>(header, LandmarksBinaryHeader::COLORS);
+    _descTypes = section<std::uint32_t>(header, LandmarksBinaryHeader::DESC_TYPES);
+    _states = section<std::uint8_t>(header, LandmarksBinaryHeader::STATES);
+    _observationOffsets = section<std::uint64_t>(header, LandmarksBinaryHeader::OBSERVATION_OFFSETS);
+    _viewIds = section<IndexT>(header, LandmarksBinaryHeader::VIEW_IDS);
+    _featureIds = section<IndexT>(header, LandmarksBinaryHeader::FEATURE_IDS);
+    _coords = section<double>(header, LandmarksBinaryHeader::COORDS);
+    _scales = section<double>(header, LandmarksBinaryHeader::SCALES);
+
+    // the observation offsets are used without bounds checks by the accessors
+    if (_observationOffsets[0] != 0 || _observationOffsets[nbLandmarks] != nbObservations ||
+        !std::is_sorted(_observationOffsets, _observationOffsets + nbLandmarks + 1))
+    {
+        clear();
+        throw std::runtime_error("Can't load landmarks file, '" + path + "' is truncated or corrupted !");
+    }
+
+    _nbLandmarks = nbLandmarks;
+    _nbObservations = nbObservations;
+}
+
+void LandmarksStorage::save(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+        throw std::runtime_error("Can't save landmarks file, can't open '" + path + "' !");
+
+    LandmarksBinaryHeader header;
+    std::memset(&header, 0, sizeof(LandmarksBinaryHeader));
+    std::memcpy(header.magic, LandmarksBinaryHeader::magicNumber, sizeof(header.magic));
+    header.version = LandmarksBinaryHeader::currentVersion;
+    header.nbLandmarks = _nbLandmarks;
+    header.nbObservations = _nbObservations;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(LandmarksBinaryHeader));
+
+    // an empty storage has no offsets array
+    const std::uint64_t emptyOffsets = 0;
+    const std::uint64_t* observationOffsets = (_observationOffsets != nullptr) ? _observationOffsets : &emptyOffsets;
+
+    system::writeSection(file, header, LandmarksBinaryHeader::LANDMARK_IDS, _landmarkIds, _nbLandmarks);
+    system::writeSection(file, header, LandmarksBinaryHeader::POSITIONS, _positions, 3 * _nbLandmarks);
+    system::writeSection(file, header, LandmarksBinaryHeader::COLORS, _colors, 3 * _nbLandmarks);
+    system::writeSection(file, header, LandmarksBinaryHeader::DESC_TYPES, _descTypes, _nbLandmarks);
+    system::writeSection(file, header, LandmarksBinaryHeader::STATES, _states, _nbLandmarks);
+    system::writeSection(file, header, LandmarksBinaryHeader::OBSERVATION_OFFSETS, observationOffsets, _nbLandmarks + 1);
+    system::writeSection(file, header, LandmarksBinaryHeader::VIEW_IDS, _viewIds, _nbObservations);
+    system::writeSection(file, header, LandmarksBinaryHeader::FEATURE_IDS, _featureIds, _nbObservations);
+    system::writeSection(file, header, LandmarksBinaryHeader::COORDS, _coords, 2 * _nbObservations);
+    system::writeSection(file, header, LandmarksBinaryHeader::SCALES, _scales, _nbObservations);
+    system::alignStream(file);
+
+    // rewrite the header with the sections location
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(LandmarksBinaryHeader));
+
+    if (!file.good())
+        throw std::runtime_error("Can't save landmarks file, '" + path + "' is incorrect !");
+}
+
+void LandmarksStorage::clear()
+{
+    _file.close();
+    _nbLandmarks = 0;
+    _nbObservations = 0;
+
+    _ownedLandmarkIds.clear();
+    _ownedPositions.clear();
+    _ownedColors.clear();
+    _ownedDescTypes.clear();
+    _ownedStates.clear();
+    _ownedObservationOffsets.assign(1, 0);
+    _ownedViewIds.clear();
+    _ownedFeatureIds.clear();
+    _ownedCoords.clear();
+    _ownedScales.clear();
+
+    setOwnedColumns();
+}
+
+std::size_t LandmarksStorage::getLandmarkIndex(IndexT landmarkId) const
+{
+    const IndexT* it = std::lower_bound(_landmarkIds, _landmarkIds + _nbLandmarks, landmarkId);
+    if (it == _landmarkIds + _nbLandmarks || *it != landmarkId)
+        return invalidIndex;
+    return it - _landmarkIds;
+}
+
+Landmark LandmarksStorage::getLandmark(std::size_t index) const
+{
+    Landmark landmark(getPosition(index), getDescType(index), getColor(index));
+    landmark.state = getState(index);
+
+    Observations& observations = landmark.getObservations();
+    observations.reserve(getNbObservations(index));
+
+    // observations are sorted by view id
+    for (std::size_t o = _observationOffsets[index]; o < _observationOffsets[index + 1]; ++o)
+        observations.emplace_hint(observations.end(), _viewIds[o], getObservation(o));
+
+    return landmark;
+}
+
+void LandmarksStorage::exportLandmarks(Landmarks& landmarks) const
+{
+    landmarks.clear();
+
+    // landmarks are sorted by id
+    for (std::size_t index = 0; index < _nbLandmarks; ++index)
+        landmarks.emplace_hint(landmarks.end(), _landmarkIds[index], getLandmark(index));
+}
+
+void LandmarksStorage::setOwnedColumns()
+{
+    _landmarkIds = _ownedLandmarkIds.data();
+    _positions = _ownedPositions.data();
+    _colors = _ownedColors.data();
+    _descTypes = _ownedDescTypes.data();
+    _states = _ownedStates.data();
+    _observationOffsets = _ownedObservationOffsets.data();
+    _viewIds = _ownedViewIds.data();
+    _featureIds = _ownedFeatureIds.data();
+    _coords = _ownedCoords.data();
+    _scales = _ownedScales.data();
+}
+
+}  // namespace sfmData
+}  // namespace aliceVision
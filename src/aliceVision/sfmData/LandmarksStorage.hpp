@@ -0,0 +1,201 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/system/MappedFile.hpp>
+#include <aliceVision/types.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace sfmData {
+
+/**
+ * @brief Header of a binary landmarks file.
+ *
+ * The data are stored by columns, each section starting on an 8-byte boundary:
+ * - per landmark: landmarkIds (uint32, sorted), positions (3 x float64), colors (3 x uint8),
+ *   descTypes (uint32), states (uint8), observation offsets (uint64, nbLandmarks + 1 values)
+ * - per observation: viewIds (uint32, sorted per landmark), featureIds (uint32), coords (2 x float64), scales (float64)
+ * Values are little-endian, so the file can be memory-mapped and read in place.
+ */
+struct LandmarksBinaryHeader
+{
+    static constexpr char magicNumber[8] = {'A', 'V', 'L', 'A', 'N', 'D', 'M', 'K'};
+    static constexpr std::uint32_t currentVersion = 1;
+
+    enum ESection
+    {
+        LANDMARK_IDS = 0,
+        POSITIONS,
+        COLORS,
+        DESC_TYPES,
+        STATES,
+        OBSERVATION_OFFSETS,
+        VIEW_IDS,
+        FEATURE_IDS,
+        COORDS,
+        SCALES,
+        NB_SECTIONS
+    };
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t nbLandmarks;
+    std::uint64_t nbObservations;
+    std::uint64_t sectionOffsets[NB_SECTIONS];
+};
+static_assert(sizeof(LandmarksBinaryHeader) == 112, "LandmarksBinaryHeader must not be padded");
+
+/**
+ * @brief Read-only columnar landmarks container.
+ *
+ * Positions, colors and observations of all the landmarks are stored in contiguous arrays,
+ * the observations being addressed with an offsets array. Compared to Landmarks (one map node
+ * and one observations allocation per landmark), the memory footprint is divided and the container
+ * can be backed by a memory-mapped binary file: only the accessed pages are read from the disk.
+ *
+ * Landmarks are addressed by their index in the container, in increasing landmarkId order.
+ * Landmark objects are built on demand with getLandmark() or exportLandmarks().
+ */
+class LandmarksStorage
+{
+  public:
+    static constexpr std::size_t invalidIndex = std::numeric_limits<std::size_t>::max();
+
+    LandmarksStorage() = default;
+
+    explicit LandmarksStorage(const Landmarks& landmarks) { build(landmarks); }
+
+    // no copy: the columns may point into the owned arrays
+    LandmarksStorage(const LandmarksStorage&) = delete;
+    LandmarksStorage& operator=(const LandmarksStorage&) = delete;
+
+    /**
+     * @brief Fill the storage with the given landmarks (the previous content is discarded).
+     * @param[in] landmarks the input landmarks
+     */
+    void build(const Landmarks& landmarks);
+
+    /**
+     * @brief Memory-map a binary landmarks file (the previous content is discarded).
+     * @param[in] path the binary landmarks file path
+     * @throw std::runtime_error if the file is not a valid binary landmarks file
+     */
+    void open(const std::string& path);
+
+    /**
+     * @brief Save the landmarks in the binary format.
+     * @param[in] path the binary landmarks file path
+     * @throw std::runtime_error if the file cannot be written
+     */
+    void save(const std::string& path) const;
+
+    void clear();
+
+    bool empty() const { return _nbLandmarks == 0; }
+    bool isMapped() const { return _file.isOpen(); }
+    std::size_t nbLandmarks() const { return _nbLandmarks; }
+    std::size_t nbObservations() const { return _nbObservations; }
+
+    // Landmarks
+
+    IndexT getLandmarkId(std::size_t index) const { return _landmarkIds[index]; }
+
+    /// Index of a landmark in the storage, invalidIndex if not found
+    std::size_t getLandmarkIndex(IndexT landmarkId) const;
+
+    bool hasLandmark(IndexT landmarkId) const { return getLandmarkIndex(landmarkId) != invalidIndex; }
+
+    Vec3 getPosition(std::size_t index) const
+    {
+        const double* p = &_positions[3 * index];
+        return Vec3(p[0], p[1], p[2]);
+    }
+
+    image::RGBColor getColor(std::size_t index) const
+    {
+        const std::uint8_t* c = &_colors[3 * index];
+        return image::RGBColor(c[0], c[1], c[2]);
+    }
+
+    feature::EImageDescriberType getDescType(std::size_t index) const { return static_cast<feature::EImageDescriberType>(_descTypes[index]); }
+
+    EEstimatorParameterState getState(std::size_t index) const { return static_cast<EEstimatorParameterState>(_states[index]); }
+
+    // Observations
+
+    /// Position of the first observation of a landmark, in [0, nbObservations()]
+    std::size_t getObservationsOffset(std::size_t index) const { return _observationOffsets[index]; }
+
+    std::size_t getNbObservations(std::size_t index) const { return _observationOffsets[index + 1] - _observationOffsets[index]; }
+
+    IndexT getObservationViewId(std::size_t obsIndex) const { return _viewIds[obsIndex]; }
+
+    Observation getObservation(std::size_t obsIndex) const
+    {
+        return Observation(Vec2(_coords[2 * obsIndex], _coords[2 * obsIndex + 1]), _featureIds[obsIndex], _scales[obsIndex]);
+    }
+
+    // Conversion
+
+    /// Build the Landmark object at the given index
+    Landmark getLandmark(std::size_t index) const;
+
+    /**
+     * @brief Build the Landmark objects of all the stored landmarks.
+     * @param[out] landmarks the output landmarks (the previous content is discarded)
+     */
+    void exportLandmarks(Landmarks& landmarks) const;
+
+  private:
+    template<typename T>
+    const T* section(const LandmarksBinaryHeader& header, LandmarksBinaryHeader::ESection s) const
+    {
+        return reinterpret_cast<const T*>(_file.data() + header.sectionOffsets[s]);
+    }
+
+    /// Point the columns to the owned arrays
+    void setOwnedColumns();
+
+    std::size_t _nbLandmarks = 0;                        //< number of landmarks
+    std::size_t _nbObservations = 0;                     //< number of observations
+    system::MappedFile _file;                            //< backing file, if opened from a file
+
+    // columns, pointing to the owned arrays or to the backing file
+    const IndexT* _landmarkIds = nullptr;                //< landmark ids (sorted)
+    const double* _positions = nullptr;                  //< 3 values per landmark
+    const std::uint8_t* _colors = nullptr;               //< 3 values per landmark
+    const std::uint32_t* _descTypes = nullptr;           //< describer type per landmark
+    const std::uint8_t* _states = nullptr;               //< estimator state per landmark
+    const std::uint64_t* _observationOffsets = nullptr;  //< nbLandmarks + 1 values
+    const IndexT* _viewIds = nullptr;                    //< view id per observation
+    const IndexT* _featureIds = nullptr;                 //< feature id per observation
+    const double* _coords = nullptr;                     //< 2 values per observation
+    const double* _scales = nullptr;                     //< scale per observation
+
+    // owned arrays, if built from landmarks
+    std::vector<IndexT> _ownedLandmarkIds;
+    std::vector<double> _ownedPositions;
+    std::vector<std::uint8_t> _ownedColors;
+    std::vector<std::uint32_t> _ownedDescTypes;
+    std::vector<std::uint8_t> _ownedStates;
+    std::vector<std::uint64_t> _ownedObservationOffsets = {0};
+    std::vector<IndexT> _ownedViewIds;
+    std::vector<IndexT> _ownedFeatureIds;
+    std::vector<double> _ownedCoords;
+    std::vector<double> _ownedScales;
+};
+
+}  // namespace sfmData
+}  // namespace aliceVision
@@ -1,10 +1,12 @@
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/LandmarksStorage.hpp>
 
 #define BOOST_TEST_MODULE sfmData
 
 #include <boost/test/unit_test.hpp>
 
 #include <filesystem>
+#include <fstream>
 
 using namespace aliceVision;
 namespace fs = std::filesystem;
@@ -50,3 +52,72 @@ BOOST_AUTO_TEST_CASE(SfMData_InternalFolders)
     BOOST_CHECK_EQUAL(sfmData.getRelativeFeaturesFolders()[0], fs::relative(refFolder, otherFolder));
     BOOST_CHECK_EQUAL(sfmData.getRelativeMatchesFolders()[0], fs::relative(refFolder, otherFolder));
 }
+
+BOOST_AUTO_TEST_CASE(SfMData_LandmarksStorage)
+{
+    sfmData::Landmarks landmarks;
+    for (IndexT landmarkId = 0; landmarkId < 100; ++landmarkId)
+    {
+        // sparse ids
+        sfmData::Landmark& landmark = landmarks[3 * landmarkId + 1];
+        landmark.X = Vec3(landmarkId, 0.5 * landmarkId, -2.0 * landmarkId);
+        landmark.rgb = image::RGBColor(landmarkId, 255 - landmarkId, 2 * landmarkId);
+        landmark.descType = (landmarkId % 2) ? feature::EImageDescriberType::SIFT : feature::EImageDescriberType::AKAZE;
+        landmark.state = (landmarkId % 3) ? EEstimatorParameterState::REFINED : EEstimatorParameterState::CONSTANT;
+        for (IndexT viewId = 0; viewId < landmarkId % 5; ++viewId)
+            landmark.getObservations()[10 * viewId] = sfmData::Observation(Vec2(viewId, landmarkId), landmarkId + viewId, 1.5 * viewId);
+    }
+
+    const sfmData::LandmarksStorage storage(landmarks);
+    BOOST_CHECK_EQUAL(storage.nbLandmarks(), landmarks.size());
+    BOOST_CHECK(!storage.hasLandmark(0));
+    BOOST_CHECK_EQUAL(storage.getLandmarkIndex(31), 10);
+
+    const std::string filename = "LandmarksStorage.bin";
+    storage.save(filename);
+
+    sfmData::LandmarksStorage mappedStorage;
+    mappedStorage.open(filename);
+    BOOST_CHECK(mappedStorage.isMapped());
+    BOOST_CHECK_EQUAL(mappedStorage.nbObservations(), storage.nbObservations());
+
+    const auto checkStorage = [&landmarks](const sfmData::LandmarksStorage& s) {
+        sfmData::Landmarks exportedLandmarks;
+        s.exportLandmarks(exportedLandmarks);
+        BOOST_CHECK(exportedLandmarks == landmarks);
+
+        for (const auto& landmarkIt : landmarks)
+        {
+            const std::size_t index = s.getLandmarkIndex(landmarkIt.first);
+            BOOST_CHECK(s.getState(index) == landmarkIt.second.state);
+            BOOST_CHECK(s.getColor(index) == landmarkIt.second.rgb);
+        }
+    };
+    checkStorage(storage);
+    checkStorage(mappedStorage);
+    mappedStorage.clear();
+
+    sfmData::LandmarksBinaryHeader header;
+    {
+        std::ifstream file(filename, std::ios::in | std::ios::binary);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    }
+    const auto writeAt = [&filename](std::uint64_t position, const void* data, std::size_t size) {
+        std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(position);
+        file.write(reinterpret_cast<const char*>(data), size);
+    };
+
+    // decreasing observation offsets are rejected
+    const std::uint64_t invalidOffset = storage.nbObservations();
+    writeAt(header.sectionOffsets[sfmData::LandmarksBinaryHeader::OBSERVATION_OFFSETS] + sizeof(std::uint64_t), &invalidOffset, sizeof(invalidOffset));
+    BOOST_CHECK_THROW(mappedStorage.open(filename), std::runtime_error);
+
+    // counts that would overflow the section sizes are rejected
+    sfmData::LandmarksBinaryHeader overflowHeader = header;
+    overflowHeader.nbObservations = std::uint64_t(1) << 62;
+    writeAt(0, &overflowHeader, sizeof(overflowHeader));
+    BOOST_CHECK_THROW(mappedStorage.open(filename), std::runtime_error);
+
+    fs::remove(filename);
+}
@@ -8,6 +8,7 @@
 #include "sfmDataIO.hpp"
 #include <aliceVision/config.hpp>
 #include <aliceVision/stl/mapUtils.hpp>
+#include <aliceVision/sfmData/LandmarksStorage.hpp>
 #include <aliceVision/sfmDataIO/jsonIO.hpp>
 #include <aliceVision/sfmDataIO/plyIO.hpp>
 #include <aliceVision/sfmDataIO/bafIO.hpp>
@@ -128,6 +129,30 @@ bool load(aliceVision::sfmData::SfMData& sfmData, const std::string& filename, E
     {
         status = loadPLY(sfmData, filename);
     }
+    else if (extension == ".landmarks")  // Binary landmarks file (structure only)
+    {
+        if (partFlag & STRUCTURE)
+        {
+            sfmData::LandmarksStorage storage;
+            try
+            {
+                storage.open(filename);
+            }
+            catch (const std::exception& e)
+            {
+                ALICEVISION_LOG_ERROR("Cannot load the landmarks file: '" << filename << "'." << std::endl << e.what());
+                return false;
+            }
+            storage.exportLandmarks(sfmData.getLandmarks());
+
+            if (!(partFlag & (OBSERVATIONS | OBSERVATIONS_WITH_FEATURES)))
+            {
+                for (auto& landmarkPair : sfmData.getLandmarks())
+                    landmarkPair.second.getObservations().clear();
+            }
+        }
+        status = true;
+    }
     else if (fs::is_directory(filename))
     {
         status = readGt(filename, sfmData);
@@ -167,6 +192,19 @@ bool save(const aliceVision::sfmData::SfMData& sfmData, const std::string& filen
     {
         status = saveBAF(sfmData, tmpPath, partFlag);
     }
+    else if (extension == ".landmarks")  // Binary landmarks file (structure only)
+    {
+        const sfmData::LandmarksStorage storage((partFlag & STRUCTURE) ? sfmData.getLandmarks() : sfmData::Landmarks());
+        try
+        {
+            storage.save(tmpPath);
+            status = true;
+        }
+        catch (const std::exception& e)
+        {
+            ALICEVISION_LOG_ERROR("Cannot save the landmarks file: '" << filename << "'." << std::endl << e.what());
+        }
+    }
     else if (extension == ".abc")  // Alembic
     {
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
@@ -189,5 +227,29 @@ bool save(const aliceVision::sfmData::SfMData& sfmData, const std::string& filen
     return status;
 }
 
+bool loadLandmarks(sfmData::LandmarksStorage& storage, const std::string& filename)
+{
+    if (fs::path(filename).extension() == ".landmarks")
+    {
+        try
+        {
+            storage.open(filename);
+        }
+        catch (const std::exception& e)
+        {
+            ALICEVISION_LOG_ERROR("Cannot load the landmarks file: '" << filename << "'." << std::endl << e.what());
+            return false;
+        }
+        return true;
+    }
+
+    sfmData::SfMData sfmData;
+    if (!load(sfmData, filename, ESfMData(STRUCTURE | OBSERVATIONS)))
+        return false;
+
+    storage.build(sfmData.getLandmarks());
+    return true;
+}
+
 }  // namespace sfmDataIO
 }  // namespace aliceVision
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/LandmarksStorage.hpp>
 #include <aliceVision/version.hpp>
 
 #define ALICEVISION_SFMDATAIO_VERSION_MAJOR 1
@@ -49,5 +50,14 @@ bool load(aliceVision::sfmData::SfMData& sfmData, const std::string& filename, E
 /// save SfMData SfM scene to a file
 bool save(const aliceVision::sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag);
 
+/**
+ * @brief Load the landmarks of a SfM scene file in a columnar storage.
+ *        A binary landmarks file (.landmarks) is memory-mapped, the other formats are loaded and converted.
+ * @param[out] storage the landmarks storage
+ * @param[in] filename the SfM scene file path
+ * @return true if the landmarks have been loaded
+ */
+bool loadLandmarks(aliceVision::sfmData::LandmarksStorage& storage, const std::string& filename);
+
 }  // namespace sfmDataIO
 }  // namespace aliceVision
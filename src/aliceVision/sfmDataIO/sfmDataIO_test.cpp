@@ -232,3 +232,35 @@ BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_PLY)
         BOOST_CHECK(fs::is_regular_file(filename));
     }
 }
+
+BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD_LANDMARKS)
+{
+    const std::string filename = "SAVE_LOAD.landmarks";
+    const sfmData::SfMData sfmData = createTestScene(2, 2, true);
+
+    BOOST_CHECK(save(sfmData, filename, ESfMData(STRUCTURE | OBSERVATIONS)));
+    BOOST_CHECK(fs::is_regular_file(filename));
+
+    // structure only
+    sfmData::SfMData sfmDataLoaded;
+    BOOST_CHECK(load(sfmDataLoaded, filename, ALL));
+    BOOST_CHECK(sfmDataLoaded.getViews().empty());
+    BOOST_CHECK(sfmDataLoaded.getLandmarks() == sfmData.getLandmarks());
+
+    // memory-mapped storage
+    sfmData::LandmarksStorage storage;
+    BOOST_CHECK(loadLandmarks(storage, filename));
+    BOOST_CHECK(storage.isMapped());
+
+    sfmData::Landmarks landmarks;
+    storage.exportLandmarks(landmarks);
+    BOOST_CHECK(landmarks == sfmData.getLandmarks());
+
+    // a truncated file is reported as a loading failure
+    fs::resize_file(filename, fs::file_size(filename) / 2);
+    sfmData::SfMData sfmDataTruncated;
+    BOOST_CHECK(!load(sfmDataTruncated, filename, ALL));
+    BOOST_CHECK(!loadLandmarks(storage, filename));
+
+    fs::remove(filename);
+}
@@ -0,0 +1,22 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "AlignedStream.hpp"
+
+namespace aliceVision {
+namespace system {
+
+std::uint64_t alignStream(std::ostream& stream)
+{
+    static const char zeros[8] = {0};
+    const std::uint64_t pos = static_cast<std::uint64_t>(stream.tellp());
+    const std::uint64_t padding = (8 - pos % 8) % 8;
+    stream.write(zeros, padding);
+    return pos + padding;
+}
+
+}  // namespace system
+}  // namespace aliceVision
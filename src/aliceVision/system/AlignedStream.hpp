@@ -0,0 +1,40 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Pad the stream with zeros to the next 8-byte boundary.
+ * The sections of the binary files starting on this boundary can be read in place from a MappedFile.
+ * @param[in,out] stream the output stream
+ * @return the new position
+ */
+std::uint64_t alignStream(std::ostream& stream);
+
+/**
+ * @brief Write a section of a binary file on the next 8-byte boundary and store its position in the header.
+ * @param[in,out] stream the output stream
+ * @param[in,out] header the file header, with a sectionOffsets array indexed by Header::ESection
+ * @param[in] s the section
+ * @param[in] values the values of the section
+ * @param[in] size the number of values
+ */
+template<typename Header, typename T>
+void writeSection(std::ostream& stream, Header& header, typename Header::ESection s, const T* values, std::size_t size)
+{
+    header.sectionOffsets[s] = alignStream(stream);
+    stream.write(reinterpret_cast<const char*>(values), size * sizeof(T));
+}
+
+}  // namespace system
+}  // namespace aliceVision
@@ -0,0 +1,128 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "IOScheduler.hpp"
+
+#include <algorithm>
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+
+thread_local bool isIOSchedulerThread = false;
+
+unsigned int getDefaultNbThreads() { return std::max(1u, HardwareContext().getMaxThreads()); }
+
+}  // namespace
+
+IOScheduler& IOScheduler::getInstance()
+{
+    static IOScheduler scheduler;
+    return scheduler;
+}
+
+IOScheduler::IOScheduler(unsigned int nbThreads)
+  : _nbThreads(nbThreads > 0 ? nbThreads : getDefaultNbThreads())
+{}
+
+IOScheduler::~IOScheduler() { stopWorkers(); }
+
+void IOScheduler::setHardwareContext(const HardwareContext& hContext) { setNbThreads(std::max(1u, hContext.getMaxThreads())); }
+
+void IOScheduler::setNbThreads(unsigned int nbThreads)
+{
+    if (nbThreads == 0)
+        nbThreads = getDefaultNbThreads();
+
+    if (nbThreads == getNbThreads())
+        return;
+
+    // workers are restarted on the next submitted task
+    stopWorkers(nbThreads);
+}
+
+unsigned int IOScheduler::getNbThreads() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _nbThreads;
+}
+
+bool IOScheduler::isWorkerThread() { return isIOSchedulerThread; }
+
+void IOScheduler::push(std::function<void()> task)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    // wait for a free slot in the queue, and for the end of a change of the number of threads
+    _taskTaken.wait(lock, [this] { return !_stop && _tasks.size() < _nbThreads * maxPendingTasksPerThread; });
+
+    if (_workers.empty())
+        startWorkers();
+
+    _tasks.push_back(std::move(task));
+    lock.unlock();
+
+    _taskAvailable.notify_one();
+}
+
+void IOScheduler::startWorkers()
+{
+    // note: called with the mutex locked
+    _workers.reserve(_nbThreads);
+    for (unsigned int i = 0; i < _nbThreads; ++i)
+        _workers.emplace_back(&IOScheduler::workerLoop, this);
+}
+
+void IOScheduler::stopWorkers(unsigned int nbThreads)
+{
+    std::lock_guard<std::mutex> stopLock(_stopMutex);
+
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+        workers.swap(_workers);
+    }
+    _taskAvailable.notify_all();
+
+    for (std::thread& worker : workers)
+        worker.join();
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (nbThreads > 0)
+            _nbThreads = nbThreads;
+        _stop = false;
+    }
+    _taskTaken.notify_all();
+}
+
+void IOScheduler::workerLoop()
+{
+    isIOSchedulerThread = true;
+
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            // the queued tasks are completed before stopping
+            _taskAvailable.wait(lock, [this] { return _stop || !_tasks.empty(); });
+            if (_tasks.empty())
+                return;
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+        _taskTaken.notify_one();
+
+        // exceptions are stored in the future of the task
+        task();
+    }
+}
+
+}  // namespace system
+}  // namespace aliceVision
@@ -0,0 +1,172 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "hardwareContext.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Bounded thread pool dedicated to file loading tasks.
+ *
+ * Loaders submit one task per file (read and decode) and merge the results on the calling thread,
+ * so decoding and merging run in parallel. The number of threads follows the HardwareContext limits
+ * and the number of queued tasks is bounded, so the memory used by loaded but not yet merged data stays limited.
+ *
+ * A task submitted from a thread of the pool is run immediately on this thread, so loaders can be nested.
+ */
+class IOScheduler
+{
+  public:
+    /// Maximum number of queued tasks per thread
+    static constexpr std::size_t maxPendingTasksPerThread = 4;
+
+    /**
+     * @brief Get the process-wide scheduler, configured by the command line with the HardwareContext.
+     */
+    static IOScheduler& getInstance();
+
+    /**
+     * @param[in] nbThreads number of threads, 0 to use the HardwareContext default
+     */
+    explicit IOScheduler(unsigned int nbThreads = 0);
+
+    ~IOScheduler();
+
+    IOScheduler(const IOScheduler&) = delete;
+    IOScheduler& operator=(const IOScheduler&) = delete;
+
+    /**
+     * @brief Use the maximum number of threads of the given HardwareContext.
+     * @param[in] hContext the hardware context
+     */
+    void setHardwareContext(const HardwareContext& hContext);
+
+    /**
+     * @brief Set the number of threads. The queued tasks are completed before the change.
+     * @param[in] nbThreads number of threads, 0 to use the HardwareContext default
+     */
+    void setNbThreads(unsigned int nbThreads);
+
+    unsigned int getNbThreads() const;
+
+    std::size_t getMaxPendingTasks() const { return getNbThreads() * maxPendingTasksPerThread; }
+
+    /// true if the calling thread is a thread of an IOScheduler
+    static bool isWorkerThread();
+
+    /**
+     * @brief Submit a task. Blocks while the queue is full.
+     * @param[in] task the task to run
+     * @return the future result of the task
+     */
+    template<typename Task>
+    std::future<std::invoke_result_t<Task&>> submit(Task&& task)
+    {
+        using Result = std::invoke_result_t<Task&>;
+
+        auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::forward<Task>(task));
+        std::future<Result> result = packagedTask->get_future();
+
+        if (isWorkerThread())
+            (*packagedTask)();
+        else
+            push([packagedTask]() { (*packagedTask)(); });
+
+        return result;
+    }
+
+    /**
+     * @brief Load items on the pool and consume them in order on the calling thread.
+     * At most getMaxPendingTasks() items are loaded ahead of the consumed one.
+     * If a load or consume call throws, the loading tasks in flight are awaited and the exception is rethrown.
+     * @param[in] nbItems the number of items
+     * @param[in] load function (std::size_t index) -> T, called on the pool
+     * @param[in] consume function (std::size_t index, T&& item), called on the calling thread
+     */
+    template<typename Load, typename Consume>
+    void forEachOrdered(std::size_t nbItems, Load&& load, Consume&& consume)
+    {
+        forEachOrdered(nbItems, getMaxPendingTasks(), std::forward<Load>(load), std::forward<Consume>(consume));
+    }
+
+    /**
+     * @brief Load items on the pool and consume them in order on the calling thread.
+     * @param[in] nbItems the number of items
+     * @param[in] maxPendingTasks the maximum number of items loaded ahead of the consumed one (at least 1)
+     * @param[in] load function (std::size_t index) -> T, called on the pool
+     * @param[in] consume function (std::size_t index, T&& item), called on the calling thread
+     */
+    template<typename Load, typename Consume>
+    void forEachOrdered(std::size_t nbItems, std::size_t maxPendingTasks, Load&& load, Consume&& consume)
+    {
+        using Result = std::invoke_result_t<Load&, std::size_t>;
+
+        maxPendingTasks = std::max<std::size_t>(maxPendingTasks, 1);
+        std::deque<std::future<Result>> pending;
+        std::size_t nextItem = 0;
+
+        try
+        {
+            for (std::size_t i = 0; i < nbItems; ++i)
+            {
+                while (nextItem < nbItems && pending.size() < maxPendingTasks)
+                {
+                    const std::size_t item = nextItem++;
+                    pending.push_back(submit([&load, item]() { return load(item); }));
+                }
+
+                std::future<Result> result = std::move(pending.front());
+                pending.pop_front();
+                consume(i, result.get());
+            }
+        }
+        catch (...)
+        {
+            // the tasks reference the load function
+            for (std::future<Result>& result : pending)
+                result.wait();
+            throw;
+        }
+    }
+
+  private:
+    void push(std::function<void()> task);
+    void startWorkers();
+    /**
+     * @brief Complete the queued tasks and stop the threads.
+     * @param[in] nbThreads the number of threads to use on restart, 0 to keep the current one
+     */
+    void stopWorkers(unsigned int nbThreads = 0);
+    void workerLoop();
+
+    mutable std::mutex _mutex;
+    /// serializes the changes of the number of threads
+    std::mutex _stopMutex;
+    std::condition_variable _taskAvailable;
+    std::condition_variable _taskTaken;
+    std::deque<std::function<void()>> _tasks;
+    std::vector<std::thread> _workers;
+    unsigned int _nbThreads = 1;
+    bool _stop = false;
+};
+
+}  // namespace system
+}  // namespace aliceVision
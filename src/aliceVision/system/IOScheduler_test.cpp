@@ -0,0 +1,140 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/IOScheduler.hpp>
+
+#define BOOST_TEST_MODULE IOScheduler
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace aliceVision::system;
+
+BOOST_AUTO_TEST_CASE(IOScheduler_submit)
+{
+    IOScheduler scheduler(4);
+    BOOST_CHECK_EQUAL(scheduler.getNbThreads(), 4);
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100; ++i)
+        results.push_back(scheduler.submit([i]() { return i * i; }));
+
+    for (int i = 0; i < 100; ++i)
+        BOOST_CHECK_EQUAL(results[i].get(), i * i);
+
+    // exceptions are forwarded to the future
+    std::future<int> failure = scheduler.submit([]() -> int { throw std::runtime_error("failure"); });
+    BOOST_CHECK_THROW(failure.get(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(IOScheduler_forEachOrdered)
+{
+    IOScheduler scheduler(3);
+
+    const std::size_t nbItems = 200;
+    std::atomic<std::size_t> nbLoading(0);
+    std::size_t maxLoadedAhead = 0;
+    std::atomic<std::size_t> nbLoaded(0);
+    std::vector<std::size_t> consumed;
+
+    scheduler.forEachOrdered(
+      nbItems,
+      [&](std::size_t i) {
+          ++nbLoading;
+          std::this_thread::sleep_for(std::chrono::microseconds((i * 7) % 50));
+          ++nbLoaded;
+          return std::make_unique<std::size_t>(i);
+      },
+      [&](std::size_t i, std::unique_ptr<std::size_t>&& item) {
+          BOOST_CHECK_EQUAL(*item, i);
+          consumed.push_back(*item);
+          maxLoadedAhead = std::max(maxLoadedAhead, nbLoading - consumed.size());
+      });
+
+    BOOST_CHECK_EQUAL(consumed.size(), nbItems);
+    BOOST_CHECK_EQUAL(nbLoaded.load(), nbItems);
+    // the number of items loaded ahead is bounded
+    BOOST_CHECK_LE(maxLoadedAhead, scheduler.getMaxPendingTasks());
+}
+
+BOOST_AUTO_TEST_CASE(IOScheduler_forEachOrdered_maxPendingTasks)
+{
+    IOScheduler scheduler(4);
+
+    const std::size_t maxPendingTasks = 2;
+    std::atomic<std::size_t> nbLoading(0);
+    std::size_t maxLoadedAhead = 0;
+    std::size_t nbConsumed = 0;
+
+    scheduler.forEachOrdered(
+      50,
+      maxPendingTasks,
+      [&](std::size_t i) {
+          ++nbLoading;
+          return i;
+      },
+      [&](std::size_t i, std::size_t&& item) {
+          BOOST_CHECK_EQUAL(item, i);
+          ++nbConsumed;
+          maxLoadedAhead = std::max(maxLoadedAhead, nbLoading - nbConsumed);
+          std::this_thread::sleep_for(std::chrono::microseconds(100));
+      });
+
+    BOOST_CHECK_EQUAL(nbConsumed, 50);
+    BOOST_CHECK_LE(maxLoadedAhead, maxPendingTasks);
+}
+
+BOOST_AUTO_TEST_CASE(IOScheduler_forEachOrdered_exception)
+{
+    IOScheduler scheduler(2);
+
+    std::atomic<int> nbLoaded(0);
+    const auto load = [&](std::size_t i) {
+        if (i == 10)
+            throw std::runtime_error("Can't load item 10");
+        ++nbLoaded;
+        return i;
+    };
+
+    std::size_t nbConsumed = 0;
+    BOOST_CHECK_THROW(scheduler.forEachOrdered(100, load, [&](std::size_t, std::size_t&&) { ++nbConsumed; }), std::runtime_error);
+    BOOST_CHECK_EQUAL(nbConsumed, 10);
+
+    // the scheduler is still usable
+    BOOST_CHECK_EQUAL(scheduler.submit([]() { return 1; }).get(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(IOScheduler_nested)
+{
+    IOScheduler scheduler(1);
+
+    // a task submitted from a thread of the pool runs immediately instead of waiting for a free thread
+    std::future<int> result = scheduler.submit([&scheduler]() { return scheduler.submit([]() { return 42; }).get(); });
+    BOOST_CHECK_EQUAL(result.get(), 42);
+}
+
+BOOST_AUTO_TEST_CASE(IOScheduler_setNbThreads)
+{
+    IOScheduler scheduler(2);
+
+    std::atomic<int> nbDone(0);
+    std::vector<std::future<void>> results;
+    for (int i = 0; i < 20; ++i)
+        results.push_back(scheduler.submit([&nbDone]() { ++nbDone; }));
+
+    // the queued tasks are completed before the change
+    scheduler.setNbThreads(5);
+    BOOST_CHECK_EQUAL(nbDone.load(), 20);
+    BOOST_CHECK_EQUAL(scheduler.getNbThreads(), 5);
+
+    BOOST_CHECK_EQUAL(scheduler.submit([]() { return 3; }).get(), 3);
+}
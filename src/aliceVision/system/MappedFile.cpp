@@ -0,0 +1,162 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <codecvt>
+    #include <locale>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace aliceVision {
+namespace system {
+
+MappedFile::MappedFile(const std::string& path) { open(path); }
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept { swap(other); }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        swap(other);
+    }
+    return *this;
+}
+
+void MappedFile::swap(MappedFile& other) noexcept
+{
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+    std::swap(_isOpen, other._isOpen);
+#if defined(_WIN32)
+    std::swap(_fileHandle, other._fileHandle);
+    std::swap(_mappingHandle, other._mappingHandle);
+#endif
+}
+
+#if defined(_WIN32)
+
+void MappedFile::open(const std::string& path)
+{
+    close();
+
+    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>, wchar_t> conv;
+    const std::wstring wpath = conv.from_bytes(path);
+
+    HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Can't map file, can't open '" + path + "' !");
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        throw std::runtime_error("Can't map file, can't get the size of '" + path + "' !");
+    }
+
+    _fileHandle = file;
+    _size = static_cast<std::size_t>(fileSize.QuadPart);
+    _isOpen = true;
+
+    if (_size == 0)
+        return;
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        close();
+        throw std::runtime_error("Can't map file '" + path + "' !");
+    }
+    _mappingHandle = mapping;
+
+    _data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (_data == nullptr)
+    {
+        close();
+        throw std::runtime_error("Can't map file '" + path + "' !");
+    }
+}
+
+void MappedFile::close()
+{
+    if (_data != nullptr)
+        UnmapViewOfFile(_data);
+    if (_mappingHandle != nullptr)
+        CloseHandle(static_cast<HANDLE>(_mappingHandle));
+    if (_fileHandle != nullptr)
+        CloseHandle(static_cast<HANDLE>(_fileHandle));
+
+    _data = nullptr;
+    _mappingHandle = nullptr;
+    _fileHandle = nullptr;
+    _size = 0;
+    _isOpen = false;
+}
+
+#else
+
+void MappedFile::open(const std::string& path)
+{
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Can't map file, can't open '" + path + "' !");
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Can't map file, can't get the size of '" + path + "' !");
+    }
+
+    _size = static_cast<std::size_t>(st.st_size);
+    _isOpen = true;
+
+    if (_size > 0)
+    {
+        void* ptr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED)
+        {
+            ::close(fd);
+            _size = 0;
+            _isOpen = false;
+            throw std::runtime_error("Can't map file '" + path + "' !");
+        }
+        _data = static_cast<const char*>(ptr);
+    }
+
+    // the mapping stays valid once the file descriptor is closed
+    ::close(fd);
+}
+
+void MappedFile::close()
+{
+    if (_data != nullptr)
+        munmap(const_cast<char*>(_data), _size);
+
+    _data = nullptr;
+    _size = 0;
+    _isOpen = false;
+}
+
+#endif
+
+}  // namespace system
+}  // namespace aliceVision
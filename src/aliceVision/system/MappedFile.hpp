@@ -0,0 +1,67 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ * The mapping is released when the object is destroyed.
+ * An empty file is valid and gives a null data pointer with a zero size.
+ */
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+
+    /**
+     * @brief Map the given file in memory.
+     * @param[in] path the file path
+     * @throw std::runtime_error if the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief Map the given file in memory, releasing any previous mapping.
+     * @param[in] path the file path
+     * @throw std::runtime_error if the file cannot be opened or mapped
+     */
+    void open(const std::string& path);
+
+    /// Release the mapping.
+    void close();
+
+    bool isOpen() const { return _isOpen; }
+    const char* data() const { return _data; }
+    std::size_t size() const { return _size; }
+
+  private:
+    void swap(MappedFile& other) noexcept;
+
+    const char* _data = nullptr;
+    std::size_t _size = 0;
+    bool _isOpen = false;
+#if defined(_WIN32)
+    void* _fileHandle = nullptr;
+    void* _mappingHandle = nullptr;
+#endif
+};
+
+}  // namespace system
+}  // namespace aliceVision
@@ -7,110 +7,241 @@
 
 #include "TracksBuilder.hpp"
 
-#include <lemon/list_graph.h>
-#include <lemon/unionfind.h>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
 
 namespace aliceVision {
 namespace track {
 
 using namespace aliceVision::matching;
-using namespace lemon;
 
-/// IndexedFeaturePair is: map<viewId, keypointId>
-using IndexedFeaturePair = std::pair<std::size_t, KeypointId>;
-using IndexMap = lemon::ListDigraph::NodeMap<std::size_t>;
-using UnionFindObject = lemon::UnionFindEnum<IndexMap>;
+/// Dense index of a feature: features are numbered by (viewId, descType, featIndex) order
+using DenseIndex = std::uint32_t;
 
-using MapNodeToIndex = stl::flat_map<lemon::ListDigraph::Node, IndexedFeaturePair>;
-using MapIndexToNode = stl::flat_map<IndexedFeaturePair, lemon::ListDigraph::Node>;
+/// Features of one (viewId, descType) occupy a contiguous range of dense indexes
+struct FeaturesBlock
+{
+    std::size_t viewId;
+    feature::EImageDescriberType descType;
+    /// first dense index of the block
+    std::size_t offset;
+};
 
 struct TracksBuilderData
 {
-    /// graph container to create the node
-    lemon::ListDigraph graph;
-    /// node to index map
-    MapNodeToIndex map_nodeToIndex;
-    std::unique_ptr<IndexMap> index;
-    std::unique_ptr<UnionFindObject> tracksUF;
+    /// features blocks sorted by (viewId, descType) and dense index
+    std::vector<FeaturesBlock> blocks;
+    /// tracks stored as a compressed sparse row structure:
+    /// track i is made of the features trackFeatures[trackOffsets[i]] to trackFeatures[trackOffsets[i+1]]
+    std::vector<std::size_t> trackOffsets;
+    std::vector<DenseIndex> trackFeatures;
+
+    std::size_t nbTracks() const { return trackOffsets.empty() ? 0 : trackOffsets.size() - 1; }
+
+    /// Get the block containing the given dense index
+    const FeaturesBlock& getBlock(DenseIndex index) const
+    {
+        const auto it = std::upper_bound(
+          blocks.begin(), blocks.end(), static_cast<std::size_t>(index), [](std::size_t i, const FeaturesBlock& block) { return i < block.offset; });
+        return *(it - 1);
+    }
+};
+
+namespace {
+
+/// Matches of one pair of views for one describer type
+struct MatchesBlock
+{
+    std::size_t I;
+    std::size_t J;
+    feature::EImageDescriberType descType;
+    const IndMatches* matches;
+    std::size_t offsetI = 0;
+    std::size_t offsetJ = 0;
+};
+
+/**
+ * @brief Concurrent union-find over a flat array.
+ * Links always go from the larger index to the smaller one, so the root of a set
+ * is its smallest element and the final sets do not depend on the order of the unions.
+ */
+class ConcurrentUnionFind
+{
+  public:
+    explicit ConcurrentUnionFind(std::size_t size)
+      : _parents(size)
+    {
+#pragma omp parallel for
+        for (std::int64_t i = 0; i < static_cast<std::int64_t>(size); ++i)
+            _parents[i].store(static_cast<DenseIndex>(i), std::memory_order_relaxed);
+    }
+
+    DenseIndex find(DenseIndex x)
+    {
+        while (true)
+        {
+            DenseIndex parent = _parents[x].load(std::memory_order_relaxed);
+            if (parent == x)
+                return x;
+            const DenseIndex grandParent = _parents[parent].load(std::memory_order_relaxed);
+            // path halving: no need to check the result, another thread may only have shortened the path
+            if (parent != grandParent)
+                _parents[x].compare_exchange_weak(parent, grandParent, std::memory_order_relaxed);
+            x = grandParent;
+        }
+    }
+
+    void join(DenseIndex a, DenseIndex b)
+    {
+        while (true)
+        {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return;
+            if (a < b)
+                std::swap(a, b);
+            // link the larger root to the smaller one, retry if it is not a root anymore
+            DenseIndex expected = a;
+            if (_parents[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+                return;
+        }
+    }
+
+    /// Replace each parent by the root of its set (must be called once all the unions are done)
+    void flatten()
+    {
+        // parents are always smaller than their children, so an increasing sweep is enough
+        for (std::size_t i = 0; i < _parents.size(); ++i)
+        {
+            const DenseIndex parent = _parents[i].load(std::memory_order_relaxed);
+            _parents[i].store(_parents[parent].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
 
-    const UnionFindObject& getUnionFindEnum() const { return *tracksUF; }
+    DenseIndex parent(std::size_t i) const { return _parents[i].load(std::memory_order_relaxed); }
 
-    const MapNodeToIndex& getReverseMap() const { return map_nodeToIndex; }
+  private:
+    std::vector<std::atomic<DenseIndex>> _parents;
 };
 
+}  // namespace
+
 TracksBuilder::TracksBuilder() { _d.reset(new TracksBuilderData()); }
 
 TracksBuilder::~TracksBuilder() = default;
 
 void TracksBuilder::build(const PairwiseMatches& pairwiseMatches)
 {
-    typedef std::set<IndexedFeaturePair> SetIndexedPair;
-
-    // set of all features of all images: (imageIndex, featureIndex)
-    SetIndexedPair allFeatures;
+    _d.reset(new TracksBuilderData());
 
-    // for each couple of images make the union according the pair matches
+    std::vector<MatchesBlock> matchesBlocks;
     for (const auto& matchesPerDescIt : pairwiseMatches)
     {
-        const std::size_t& I = matchesPerDescIt.first.first;
-        const std::size_t& J = matchesPerDescIt.first.second;
-        const MatchesPerDescType& matchesPerDesc = matchesPerDescIt.second;
+        for (const auto& matchesIt : matchesPerDescIt.second)
+        {
+            MatchesBlock matchesBlock;
+            matchesBlock.I = matchesPerDescIt.first.first;
+            matchesBlock.J = matchesPerDescIt.first.second;
+            matchesBlock.descType = matchesIt.first;
+            matchesBlock.matches = &matchesIt.second;
+            matchesBlocks.push_back(matchesBlock);
+        }
+    }
+
+    // number of features referenced by the matches of each (viewId, descType)
+    std::vector<std::pair<std::size_t, std::size_t>> nbFeaturesIJ(matchesBlocks.size(), {0, 0});
 
-        for (const auto& matchesIt : matchesPerDesc)
+#pragma omp parallel for schedule(dynamic)
+    for (int b = 0; b < static_cast<int>(matchesBlocks.size()); ++b)
+    {
+        for (const IndMatch& m : *matchesBlocks[b].matches)
         {
-            const feature::EImageDescriberType descType = matchesIt.first;
-            const IndMatches& matches = matchesIt.second;
-            // we have correspondences between I and J image index.
-            for (const IndMatch& m : matches)
-            {
-                IndexedFeaturePair pairI(I, KeypointId(descType, m._i));
-                IndexedFeaturePair pairJ(J, KeypointId(descType, m._j));
-                allFeatures.insert(pairI);
-                allFeatures.insert(pairJ);
-            }
+            nbFeaturesIJ[b].first = std::max(nbFeaturesIJ[b].first, static_cast<std::size_t>(m._i) + 1);
+            nbFeaturesIJ[b].second = std::max(nbFeaturesIJ[b].second, static_cast<std::size_t>(m._j) + 1);
         }
     }
 
-    // build the node indirection for each referenced feature
-    MapIndexToNode map_indexToNode;
-    map_indexToNode.reserve(allFeatures.size());
-    _d->map_nodeToIndex.reserve(allFeatures.size());
+    std::map<std::pair<std::size_t, feature::EImageDescriberType>, std::size_t> nbFeaturesPerBlock;
+    for (std::size_t b = 0; b < matchesBlocks.size(); ++b)
+    {
+        std::size_t& nbFeaturesI = nbFeaturesPerBlock[std::make_pair(matchesBlocks[b].I, matchesBlocks[b].descType)];
+        nbFeaturesI = std::max(nbFeaturesI, nbFeaturesIJ[b].first);
+        std::size_t& nbFeaturesJ = nbFeaturesPerBlock[std::make_pair(matchesBlocks[b].J, matchesBlocks[b].descType)];
+        nbFeaturesJ = std::max(nbFeaturesJ, nbFeaturesIJ[b].second);
+    }
 
-    for (const IndexedFeaturePair& featPair : allFeatures)
+    // flatten (viewId, descType, featIndex) into dense indexes
+    std::size_t nbFeatures = 0;
+    std::map<std::pair<std::size_t, feature::EImageDescriberType>, std::size_t> offsetPerBlock;
+    _d->blocks.reserve(nbFeaturesPerBlock.size());
+    for (const auto& blockIt : nbFeaturesPerBlock)
     {
-        lemon::ListDigraph::Node node = _d->graph.addNode();
-        map_indexToNode.insert(std::make_pair(featPair, node));
-        _d->map_nodeToIndex.insert(std::make_pair(node, featPair));
+        _d->blocks.push_back({blockIt.first.first, blockIt.first.second, nbFeatures});
+        offsetPerBlock[blockIt.first] = nbFeatures;
+        nbFeatures += blockIt.second;
     }
 
-    // add the element of myset to the UnionFind insert method.
-    _d->index.reset(new IndexMap(_d->graph));
-    _d->tracksUF.reset(new UnionFindObject(*_d->index));
+    if (nbFeatures >= std::numeric_limits<DenseIndex>::max())
+        throw std::runtime_error("TracksBuilder: too many features (" + std::to_string(nbFeatures) + ").");
 
-    for (ListDigraph::NodeIt it(_d->graph); it != INVALID; ++it)
+    for (MatchesBlock& matchesBlock : matchesBlocks)
     {
-        _d->tracksUF->insert(it);
+        matchesBlock.offsetI = offsetPerBlock.at(std::make_pair(matchesBlock.I, matchesBlock.descType));
+        matchesBlock.offsetJ = offsetPerBlock.at(std::make_pair(matchesBlock.J, matchesBlock.descType));
     }
 
     // make the union according the pair matches
-    for (const auto& matchesPerDescIt : pairwiseMatches)
+    ConcurrentUnionFind unionFind(nbFeatures);
+    // features referenced by at least one match
+    std::vector<std::atomic<std::uint8_t>> isMatched(nbFeatures);
+
+#pragma omp parallel for schedule(dynamic)
+    for (int b = 0; b < static_cast<int>(matchesBlocks.size()); ++b)
     {
-        const std::size_t& I = matchesPerDescIt.first.first;
-        const std::size_t& J = matchesPerDescIt.first.second;
-        const MatchesPerDescType& matchesPerDesc = matchesPerDescIt.second;
+        const MatchesBlock& matchesBlock = matchesBlocks[b];
+        for (const IndMatch& m : *matchesBlock.matches)
+        {
+            const DenseIndex indexI = static_cast<DenseIndex>(matchesBlock.offsetI + m._i);
+            const DenseIndex indexJ = static_cast<DenseIndex>(matchesBlock.offsetJ + m._j);
+            isMatched[indexI].store(1, std::memory_order_relaxed);
+            isMatched[indexJ].store(1, std::memory_order_relaxed);
+            unionFind.join(indexI, indexJ);
+        }
+    }
+
+    unionFind.flatten();
 
-        for (const auto& matchesIt : matchesPerDesc)
+    // the root of a track is its smallest feature: tracks are numbered in the order of their first feature,
+    // and an increasing sweep visits each root before the other features of its track
+    std::vector<DenseIndex> trackIndexPerRoot(nbFeatures, 0);
+    std::vector<std::size_t> trackSizes;
+    for (std::size_t i = 0; i < nbFeatures; ++i)
+    {
+        if (!isMatched[i].load(std::memory_order_relaxed))
+            continue;
+        const DenseIndex root = unionFind.parent(i);
+        if (root == i)
         {
-            const feature::EImageDescriberType descType = matchesIt.first;
-            const IndMatches& matches = matchesIt.second;
-            // we have correspondences between I and J image index.
-            for (const IndMatch& m : matches)
-            {
-                IndexedFeaturePair pairI(I, KeypointId(descType, m._i));
-                IndexedFeaturePair pairJ(J, KeypointId(descType, m._j));
-                _d->tracksUF->join(map_indexToNode[pairI], map_indexToNode[pairJ]);
-            }
+            trackIndexPerRoot[i] = static_cast<DenseIndex>(trackSizes.size());
+            trackSizes.push_back(0);
         }
+        ++trackSizes[trackIndexPerRoot[root]];
+    }
+
+    _d->trackOffsets.assign(trackSizes.size() + 1, 0);
+    for (std::size_t t = 0; t < trackSizes.size(); ++t)
+        _d->trackOffsets[t + 1] = _d->trackOffsets[t] + trackSizes[t];
+
+    // features of each track, sorted by increasing dense index
+    _d->trackFeatures.resize(_d->trackOffsets.back());
+    std::vector<std::size_t> fillPositions(_d->trackOffsets.begin(), _d->trackOffsets.end() - 1);
+    for (std::size_t i = 0; i < nbFeatures; ++i)
+    {
+        if (isMatched[i].load(std::memory_order_relaxed))
+            _d->trackFeatures[fillPositions[trackIndexPerRoot[unionFind.parent(i)]]++] = static_cast<DenseIndex>(i);
     }
 }
 
@@ -119,51 +250,61 @@ void TracksBuilder::filter(bool clearForks, std::size_t minTrackLength, bool mul
     // remove bad tracks:
     // - track that are too short,
     // - track with id conflicts (many times the same image index)
-    if (!clearForks && minTrackLength == 0)
+    if (_d->trackOffsets.empty() || (!clearForks && minTrackLength == 0))
         return;
 
-    std::set<int> set_classToErase;
+    const std::size_t nbTracks = _d->nbTracks();
+    std::vector<std::uint8_t> keepTrack(nbTracks, 0);
 
-#pragma omp parallel if (multithreaded)
-    for (lemon::UnionFindEnum<IndexMap>::ClassIt cit(*_d->tracksUF); cit != INVALID; ++cit)
+#pragma omp parallel for schedule(dynamic, 1024) if (multithreaded)
+    for (std::int64_t t = 0; t < static_cast<std::int64_t>(nbTracks); ++t)
     {
-#pragma omp single nowait
+        // features are sorted by dense index, hence by view: observations in the same view are consecutive
+        std::size_t nbViews = 0;
+        std::size_t previousViewId = 0;
+        for (std::size_t f = _d->trackOffsets[t]; f < _d->trackOffsets[t + 1]; ++f)
         {
-            std::size_t cpt = 0;
-            std::set<std::size_t> myset;
-            for (lemon::UnionFindEnum<IndexMap>::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
-            {
-                myset.insert(_d->map_nodeToIndex[iit].first);
-                ++cpt;
-            }
-            if ((clearForks && myset.size() != cpt) || myset.size() < minTrackLength)
-            {
-#pragma omp critical
-                set_classToErase.insert(cit.operator int());
-            }
+            const std::size_t viewId = _d->getBlock(_d->trackFeatures[f]).viewId;
+            if (f == _d->trackOffsets[t] || viewId != previousViewId)
+                ++nbViews;
+            previousViewId = viewId;
         }
+        const std::size_t cpt = _d->trackOffsets[t + 1] - _d->trackOffsets[t];
+        keepTrack[t] = !((clearForks && nbViews != cpt) || nbViews < minTrackLength);
     }
 
-    std::for_each(set_classToErase.begin(), set_classToErase.end(), [&](int toErase) { _d->tracksUF->eraseClass(toErase); });
+    // compact the kept tracks
+    std::size_t nbKeptTracks = 0;
+    std::size_t nbKeptFeatures = 0;
+    for (std::size_t t = 0; t < nbTracks; ++t)
+    {
+        const std::size_t begin = _d->trackOffsets[t];
+        const std::size_t end = _d->trackOffsets[t + 1];
+        if (!keepTrack[t])
+            continue;
+        std::copy(_d->trackFeatures.begin() + begin, _d->trackFeatures.begin() + end, _d->trackFeatures.begin() + nbKeptFeatures);
+        _d->trackOffsets[nbKeptTracks] = nbKeptFeatures;
+        nbKeptFeatures += end - begin;
+        ++nbKeptTracks;
+    }
+    _d->trackOffsets[nbKeptTracks] = nbKeptFeatures;
+    _d->trackOffsets.resize(nbKeptTracks + 1);
+    _d->trackFeatures.resize(nbKeptFeatures);
 }
 
 bool TracksBuilder::exportToStream(std::ostream& os)
 {
-    std::size_t cpt = 0;
-    for (lemon::UnionFindEnum<IndexMap>::ClassIt cit(*_d->tracksUF); cit != INVALID; ++cit)
+    for (std::size_t t = 0; t < _d->nbTracks(); ++t)
     {
-        os << "Class: " << cpt++ << std::endl;
-        std::size_t cptTrackLength = 0;
-        for (lemon::UnionFindEnum<IndexMap>::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
-        {
-            ++cptTrackLength;
-        }
+        os << "Class: " << t << std::endl;
         os << "\t"
-           << "track length: " << cptTrackLength << std::endl;
+           << "track length: " << _d->trackOffsets[t + 1] - _d->trackOffsets[t] << std::endl;
 
-        for (lemon::UnionFindEnum<IndexMap>::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
+        for (std::size_t f = _d->trackOffsets[t]; f < _d->trackOffsets[t + 1]; ++f)
         {
-            os << _d->map_nodeToIndex[iit].first << "  " << _d->map_nodeToIndex[iit].second << std::endl;
+            const DenseIndex index = _d->trackFeatures[f];
+            const FeaturesBlock& block = _d->getBlock(index);
+            os << block.viewId << "  " << KeypointId(block.descType, index - block.offset) << std::endl;
         }
     }
     return os.good();
@@ -173,31 +314,31 @@ void TracksBuilder::exportToSTL(TracksMap& allTracks) const
 {
     allTracks.clear();
 
-    std::size_t trackIndex = 0;
-    for (lemon::UnionFindEnum<IndexMap>::ClassIt cit(*_d->tracksUF); cit != INVALID; ++cit, ++trackIndex)
-    {
-        // create the output track
-        std::pair<TracksMap::iterator, bool> ret = allTracks.insert(std::make_pair(trackIndex, Track()));
+    const std::size_t nbTracks = _d->nbTracks();
 
-        Track& outTrack = ret.first->second;
+    // create the output tracks, then fill them in parallel
+    allTracks.reserve(nbTracks);
+    for (std::size_t trackIndex = 0; trackIndex < nbTracks; ++trackIndex)
+        allTracks.emplace_hint(allTracks.end(), trackIndex, Track());
 
-        for (lemon::UnionFindEnum<IndexMap>::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (std::int64_t t = 0; t < static_cast<std::int64_t>(nbTracks); ++t)
+    {
+        Track& outTrack = (allTracks.begin() + t)->second;
+        outTrack.featPerView.reserve(_d->trackOffsets[t + 1] - _d->trackOffsets[t]);
+
+        for (std::size_t f = _d->trackOffsets[t]; f < _d->trackOffsets[t + 1]; ++f)
         {
-            const IndexedFeaturePair& currentPair = _d->map_nodeToIndex.at(iit);
+            const DenseIndex index = _d->trackFeatures[f];
+            const FeaturesBlock& block = _d->getBlock(index);
             // all descType inside the track will be the same
-            outTrack.descType = currentPair.second.descType;
-            outTrack.featPerView[currentPair.first].featureId = currentPair.second.featIndex;
+            outTrack.descType = block.descType;
+            outTrack.featPerView[block.viewId].featureId = index - block.offset;
         }
     }
 }
 
-std::size_t TracksBuilder::nbTracks() const
-{
-    std::size_t cpt = 0;
-    for (lemon::UnionFindEnum<IndexMap>::ClassIt cit(*_d->tracksUF); cit != lemon::INVALID; ++cit)
-        ++cpt;
-    return cpt;
-}
+std::size_t TracksBuilder::nbTracks() const { return _d->nbTracks(); }
 
 }  // namespace track
 }  // namespace aliceVision
@@ -71,6 +71,9 @@ class TracksBuilder
     /**
      * @brief Export tracks as a map (each entry is a sequence of imageId and keypointId):
      *        {TrackIndex => {(imageIndex, keypointId), ... ,(imageIndex, keypointId)}
+     * @note Tracks are numbered in the order of their smallest (viewId, descType, featIndex) observation.
+     *       This order does not depend on the number of threads, but differs from the order of the
+     *       previous lemon based implementation.
      */
     void exportToSTL(TracksMap& allTracks) const;
 
@@ -9,27 +9,24 @@
 #include <aliceVision/track/trackIO.hpp>
 #include <aliceVision/track/tracksUtils.hpp>
 
-#include <fstream>
-
 namespace aliceVision {
 namespace track {
 
 
-bool TracksHandler::load(const std::string & pathJson, const std::set<IndexT> & viewIds)
+bool TracksHandler::load(const std::string & pathTracks, const std::set<IndexT> & viewIds)
 {
-    std::ifstream tracksFile(pathJson);
-    if(tracksFile.is_open() == false)
+    if (!track::loadTracks(pathTracks, _mapTracks))
     {
         return false;
     }
 
-    std::stringstream buffer;
-    buffer << tracksFile.rdbuf();
+    computeTracksPerView(viewIds);
 
-    //Parse json
-    boost::json::value jv = boost::json::parse(buffer.str());
-    _mapTracks = track::TracksMap(track::flat_map_value_to<track::Track>(jv));
+    return true;
+}
 
+void TracksHandler::computeTracksPerView(const std::set<IndexT> & viewIds)
+{
     // Compute tracks per view
     _mapTracksPerView.clear();
     for(const auto& viewId : viewIds)
@@ -38,8 +35,6 @@ bool TracksHandler::load(const std::string & pathJson, const std::set<IndexT> &
         _mapTracksPerView[viewId];
     }
     track::computeTracksPerView(_mapTracks, _mapTracksPerView);
-
-    return true;
 }
 
 
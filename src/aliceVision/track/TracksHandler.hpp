@@ -14,7 +14,13 @@ namespace track {
 class TracksHandler
 {
 public:
-    bool load(const std::string & pathJson, const std::set<IndexT> & viewIds);
+    /**
+     * @brief Load all the tracks of a JSON or binary tracks file.
+     * @param[in] pathTracks the tracks file path
+     * @param[in] viewIds the views to create in the tracks per view (even if they have no track)
+     * @return false if the file cannot be opened
+     */
+    bool load(const std::string & pathTracks, const std::set<IndexT> & viewIds);
 
     const track::TracksMap & getAllTracks() const
     {
@@ -27,9 +33,11 @@ public:
     }
 
 private:
+    void computeTracksPerView(const std::set<IndexT> & viewIds);
+
     track::TracksPerView _mapTracksPerView;
     track::TracksMap _mapTracks;
 };
 
 }
-}
\ No newline at end of file
+}
@@ -0,0 +1,188 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "TracksStorage.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+
+namespace aliceVision {
+namespace track {
+
+void TracksStorage::clear()
+{
+    _contiguousTrackIds = true;
+    _trackIds.clear();
+    _descTypes.clear();
+    _trackOffsets.clear();
+    _observations.clear();
+    _viewIds.clear();
+    _viewOffsets.clear();
+    _viewTrackIndexes.clear();
+}
+
+void TracksStorage::build(const TracksMap& tracks)
+{
+    clear();
+
+    if (tracks.size() >= static_cast<std::size_t>(UndefinedIndexT))
+        throw std::runtime_error("Too many tracks to be stored in a TracksStorage (" + std::to_string(tracks.size()) + ").");
+
+    // tracks and their observations
+    // TracksMap and featPerView are sorted, so tracks are sorted by id and observations by view
+    _trackIds.reserve(tracks.size());
+    _descTypes.reserve(tracks.size());
+    _trackOffsets.reserve(tracks.size() + 1);
+    _trackOffsets.push_back(0);
+
+    std::size_t nbObservations = 0;
+    for (const auto& trackIt : tracks)
+        nbObservations += trackIt.second.featPerView.size();
+    _observations.reserve(nbObservations);
+
+    for (const auto& trackIt : tracks)
+    {
+        if (trackIt.first != _trackIds.size())
+            _contiguousTrackIds = false;
+
+        _trackIds.push_back(trackIt.first);
+        _descTypes.push_back(trackIt.second.descType);
+        for (const auto& featIt : trackIt.second.featPerView)
+        {
+            const TrackItem& item = featIt.second;
+            _observations.push_back({static_cast<IndexT>(featIt.first),
+                                     static_cast<IndexT>(item.featureId),
+                                     static_cast<float>(item.coords.x()),
+                                     static_cast<float>(item.coords.y()),
+                                     static_cast<float>(item.scale)});
+        }
+        _trackOffsets.push_back(_observations.size());
+    }
+
+    // sorted list of the observed views
+    _viewIds.reserve(_observations.size());
+    for (const TrackObservation& obs : _observations)
+        _viewIds.push_back(obs.viewId);
+    std::sort(_viewIds.begin(), _viewIds.end());
+    _viewIds.erase(std::unique(_viewIds.begin(), _viewIds.end()), _viewIds.end());
+    _viewIds.shrink_to_fit();
+
+    // tracks per view, by counting sort of the observations on their view index:
+    // count the observations of each view, then turn the counts into offsets
+    _viewOffsets.assign(_viewIds.size() + 1, 0);
+    for (const TrackObservation& obs : _observations)
+        ++_viewOffsets[getViewIndex(obs.viewId) + 1];
+    for (std::size_t v = 0; v < _viewIds.size(); ++v)
+        _viewOffsets[v + 1] += _viewOffsets[v];
+
+    // tracks are visited in increasing order, so the tracks of each view are sorted
+    _viewTrackIndexes.resize(_observations.size());
+    std::vector<std::size_t> viewFill(_viewOffsets.begin(), _viewOffsets.end() - 1);
+    for (std::size_t trackIndex = 0; trackIndex < _trackIds.size(); ++trackIndex)
+    {
+        for (std::size_t i = _trackOffsets[trackIndex]; i < _trackOffsets[trackIndex + 1]; ++i)
+            _viewTrackIndexes[viewFill[getViewIndex(_observations[i].viewId)]++] = static_cast<IndexT>(trackIndex);
+    }
+}
+
+std::size_t TracksStorage::getTrackIndex(std::size_t trackId) const
+{
+    if (_contiguousTrackIds)
+        return (trackId < _trackIds.size()) ? trackId : invalidIndex;
+
+    const auto it = std::lower_bound(_trackIds.begin(), _trackIds.end(), trackId);
+    if (it == _trackIds.end() || *it != trackId)
+        return invalidIndex;
+    return std::distance(_trackIds.begin(), it);
+}
+
+std::size_t TracksStorage::getObservationIndex(std::size_t trackIndex, IndexT viewId) const
+{
+    const TrackObservation* begin = _observations.data() + _trackOffsets[trackIndex];
+    const TrackObservation* end = _observations.data() + _trackOffsets[trackIndex + 1];
+
+    // tracks are short: a linear scan is faster than a binary search
+    for (const TrackObservation* obs = begin; obs != end; ++obs)
+    {
+        if (obs->viewId == viewId)
+            return obs - _observations.data();
+        if (obs->viewId > viewId)
+            break;
+    }
+    return invalidIndex;
+}
+
+void TracksStorage::getTrack(std::size_t trackIndex, Track& track) const
+{
+    track.descType = _descTypes[trackIndex];
+    track.featPerView.clear();
+    track.featPerView.reserve(getTrackLength(trackIndex));
+    for (const TrackObservation& obs : getObservations(trackIndex))
+    {
+        TrackItem& item = track.featPerView[obs.viewId];
+        item.featureId = obs.featureId;
+        item.coords = Vec2(obs.x, obs.y);
+        item.scale = obs.scale;
+    }
+}
+
+std::size_t TracksStorage::getViewIndex(IndexT viewId) const
+{
+    const auto it = std::lower_bound(_viewIds.begin(), _viewIds.end(), viewId);
+    if (it == _viewIds.end() || *it != viewId)
+        return invalidIndex;
+    return std::distance(_viewIds.begin(), it);
+}
+
+TracksStorage::Range<IndexT> TracksStorage::getViewTrackIndexes(IndexT viewId) const
+{
+    const std::size_t viewIndex = getViewIndex(viewId);
+    if (viewIndex == invalidIndex)
+        return {};
+    return {_viewTrackIndexes.data() + _viewOffsets[viewIndex], _viewTrackIndexes.data() + _viewOffsets[viewIndex + 1]};
+}
+
+bool TracksStorage::getCommonTracks(const std::set<std::size_t>& viewIds, TracksMap& tracksOut) const
+{
+    assert(!viewIds.empty());
+    tracksOut.clear();
+
+    // start from the view with the smallest number of tracks
+    Range<IndexT> smallestView;
+    for (std::size_t viewId : viewIds)
+    {
+        const Range<IndexT> viewTracks = getViewTrackIndexes(static_cast<IndexT>(viewId));
+        if (viewTracks.empty())
+            return false;
+        if (smallestView.empty() || viewTracks.size() < smallestView.size())
+            smallestView = viewTracks;
+    }
+
+    for (IndexT trackIndex : smallestView)
+    {
+        Track track;
+        track.descType = _descTypes[trackIndex];
+        track.featPerView.reserve(viewIds.size());
+        for (std::size_t viewId : viewIds)
+        {
+            const TrackObservation* obs = findObservation(trackIndex, static_cast<IndexT>(viewId));
+            if (obs == nullptr)
+                break;
+            TrackItem& item = track.featPerView[viewId];
+            item.featureId = obs->featureId;
+            item.coords = Vec2(obs->x, obs->y);
+            item.scale = obs->scale;
+        }
+        if (track.featPerView.size() == viewIds.size())
+            tracksOut.emplace_hint(tracksOut.end(), _trackIds[trackIndex], std::move(track));
+    }
+    return !tracksOut.empty();
+}
+
+}  // namespace track
+}  // namespace aliceVision
@@ -0,0 +1,168 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "Track.hpp"
+
+#include <aliceVision/types.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <set>
+#include <vector>
+
+namespace aliceVision {
+namespace track {
+
+/**
+ * @brief Observation of a track in one view, as stored in TracksStorage.
+ */
+struct TrackObservation
+{
+    IndexT viewId;
+    IndexT featureId;
+    float x;
+    float y;
+    float scale;
+};
+
+/**
+ * @brief Read-only tracks container with a flat, CSR-style layout.
+ *
+ * The observations of all the tracks are stored in one contiguous array, sorted by track
+ * and by view inside each track, and addressed with an offsets array. The tracks visible
+ * in each view are stored the same way. Compared to a TracksMap (one flat_map allocation per track),
+ * this divides the memory footprint and keeps the scans over tracks and views cache-friendly.
+ *
+ * Tracks are addressed by their index in the container, in increasing trackId order.
+ * When the trackIds are contiguous from 0 (tracks built by the TracksBuilder), the trackId is the index.
+ */
+class TracksStorage
+{
+  public:
+    static constexpr std::size_t invalidIndex = std::numeric_limits<std::size_t>::max();
+
+    /// Lightweight view on a contiguous part of the storage
+    template<typename T>
+    struct Range
+    {
+        const T* first = nullptr;
+        const T* last = nullptr;
+
+        const T* begin() const { return first; }
+        const T* end() const { return last; }
+        std::size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+        const T& operator[](std::size_t i) const { return first[i]; }
+    };
+
+    TracksStorage() = default;
+
+    explicit TracksStorage(const TracksMap& tracks) { build(tracks); }
+
+    /**
+     * @brief Fill the storage with the given tracks (the previous content is discarded).
+     * @param[in] tracks the input tracks
+     */
+    void build(const TracksMap& tracks);
+
+    void clear();
+
+    bool empty() const { return _trackIds.empty(); }
+    std::size_t nbTracks() const { return _trackIds.size(); }
+    std::size_t nbObservations() const { return _observations.size(); }
+    std::size_t nbViews() const { return _viewIds.size(); }
+
+    // Tracks
+
+    /**
+     * @brief Get the index of a track in the storage.
+     * @param[in] trackId the track id
+     * @return the track index or invalidIndex if the track does not exist
+     */
+    std::size_t getTrackIndex(std::size_t trackId) const;
+
+    bool hasTrack(std::size_t trackId) const { return getTrackIndex(trackId) != invalidIndex; }
+
+    std::size_t getTrackId(std::size_t trackIndex) const { return _trackIds[trackIndex]; }
+
+    feature::EImageDescriberType getDescType(std::size_t trackIndex) const { return _descTypes[trackIndex]; }
+
+    std::size_t getTrackLength(std::size_t trackIndex) const { return _trackOffsets[trackIndex + 1] - _trackOffsets[trackIndex]; }
+
+    /// Observations of a track, sorted by viewId
+    Range<TrackObservation> getObservations(std::size_t trackIndex) const
+    {
+        return {_observations.data() + _trackOffsets[trackIndex], _observations.data() + _trackOffsets[trackIndex + 1]};
+    }
+
+    /// Position of the first observation of a track, in [0, nbObservations()]
+    std::size_t getObservationsOffset(std::size_t trackIndex) const { return _trackOffsets[trackIndex]; }
+
+    /**
+     * @brief Get the position of the observation of a track in a view, in [0, nbObservations()).
+     * This position can be used to index per-observation data stored outside of the container.
+     * @return the observation index or invalidIndex if the track is not visible in the view
+     */
+    std::size_t getObservationIndex(std::size_t trackIndex, IndexT viewId) const;
+
+    /// Get the observation of a track in a view, or nullptr if the track is not visible in the view
+    const TrackObservation* findObservation(std::size_t trackIndex, IndexT viewId) const
+    {
+        const std::size_t obsIndex = getObservationIndex(trackIndex, viewId);
+        return (obsIndex == invalidIndex) ? nullptr : &_observations[obsIndex];
+    }
+
+    const TrackObservation& getObservation(std::size_t obsIndex) const { return _observations[obsIndex]; }
+
+    /// Convert a track back to the Track structure
+    void getTrack(std::size_t trackIndex, Track& track) const;
+
+    // Views
+
+    bool hasView(IndexT viewId) const { return getViewIndex(viewId) != invalidIndex; }
+
+    /**
+     * @brief Get the index of a view in the storage, in [0, nbViews()).
+     * This index can be used to index per-view data stored outside of the container.
+     * @return the view index or invalidIndex if the view has no track
+     */
+    std::size_t getViewIndex(IndexT viewId) const;
+
+    IndexT getViewId(std::size_t viewIndex) const { return _viewIds[viewIndex]; }
+
+    /// Indexes of the tracks visible in a view, in increasing order (empty range for an unknown view)
+    Range<IndexT> getViewTrackIndexes(IndexT viewId) const;
+
+    /**
+     * @brief Get the tracks visible in all the given views, restricted to these views.
+     * Same as getCommonTracksInImagesFast with a TracksMap.
+     * @param[in] viewIds the views
+     * @param[out] tracksOut the common tracks
+     * @return true if there is at least one common track
+     */
+    bool getCommonTracks(const std::set<std::size_t>& viewIds, TracksMap& tracksOut) const;
+
+  private:
+    /// true if _trackIds[i] == i for all tracks
+    bool _contiguousTrackIds = true;
+    /// Sorted track ids
+    std::vector<std::size_t> _trackIds;
+    std::vector<feature::EImageDescriberType> _descTypes;
+    /// Observations of track i: [_trackOffsets[i], _trackOffsets[i+1])
+    std::vector<std::size_t> _trackOffsets;
+    std::vector<TrackObservation> _observations;
+
+    /// Sorted view ids
+    std::vector<IndexT> _viewIds;
+    /// Tracks of view v: [_viewOffsets[v], _viewOffsets[v+1])
+    std::vector<std::size_t> _viewOffsets;
+    std::vector<IndexT> _viewTrackIndexes;
+};
+
+}  // namespace track
+}  // namespace aliceVision
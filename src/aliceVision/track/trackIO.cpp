@@ -6,6 +6,14 @@
 
 #include "trackIO.hpp"
 #include <aliceVision/dataio/json.hpp>
+#include <aliceVision/system/AlignedStream.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
 namespace aliceVision {
 namespace track {
 
@@ -46,5 +54,257 @@ aliceVision::track::Track tag_invoke(boost::json::value_to_tag<aliceVision::trac
     return ret;
 }
 
+TracksBinaryFile::TracksBinaryFile(const std::string& path)
+  : _path(path),
+    _file(path)
+{
+    if (_file.size() < sizeof(TracksBinaryHeader))
+        throw std::runtime_error("Can't load tracks file, '" + path + "' is too small !");
+    std::memcpy(&_header, _file.data(), sizeof(TracksBinaryHeader));
+
+    if (std::memcmp(_header.magic, TracksBinaryHeader::magicNumber, sizeof(_header.magic)) != 0)
+        throw std::runtime_error("Can't load tracks file, '" + path + "' is not a binary tracks file !");
+    if (_header.version > TracksBinaryHeader::currentVersion)
+        throw std::runtime_error("Can't load tracks file, '" + path + "' has an unsupported version (" + std::to_string(_header.version) + ") !");
+
+    // check that all the sections are inside the file
+    // (the counts are bounded by the file size first, so that the section sizes cannot overflow)
+    const std::uint64_t nbTracks = _header.nbTracks;
+    const std::uint64_t nbObservations = _header.nbObservations;
+    const std::uint64_t nbIndexedViews = _header.nbIndexedViews;
+    const std::uint64_t nbIndexEntries = _header.nbIndexEntries;
+    if (nbTracks > _file.size() || nbObservations > _file.size() || nbIndexedViews > _file.size() || nbIndexEntries > _file.size())
+        throw std::runtime_error("Can't load tracks file, '" + path + "' is truncated or corrupted !");
+    const std::uint64_t sectionSizes[TracksBinaryHeader::NB_SECTIONS] = {
+      nbTracks * sizeof(std::uint64_t),
+      nbTracks * sizeof(std::uint32_t),
+      (nbTracks + 1) * sizeof(std::uint64_t),
+      nbObservations * sizeof(std::uint32_t),
+      nbObservations * sizeof(std::uint32_t),
+      nbObservations * 2 * sizeof(double),
+      nbObservations * sizeof(double),
+      nbIndexedViews * sizeof(std::uint32_t),
+      (nbIndexedViews + 1) * sizeof(std::uint64_t),
+      nbIndexEntries * sizeof(std::uint64_t),
+    };
+    for (int s = 0; s < TracksBinaryHeader::NB_SECTIONS; ++s)
+    {
+        if (_header.sectionOffsets[s] % 8 != 0 || _header.sectionOffsets[s] > _file.size() ||
+            sectionSizes[s] > _file.size() - _header.sectionOffsets[s])
+            throw std::runtime_error("Can't load tracks file, '" + path + "' is truncated or corrupted !");
+    }
+
+    // check the offset tables once, so that the loading functions can use them without bounds checks
+    const std::uint64_t* trackOffsets = section<std::uint64_t>(TracksBinaryHeader::TRACK_OFFSETS);
+    if (trackOffsets[0] != 0 || trackOffsets[nbTracks] != nbObservations || !std::is_sorted(trackOffsets, trackOffsets + nbTracks + 1))
+        throw std::runtime_error("Can't load tracks file, '" + path + "' has invalid track offsets !");
+
+    const std::uint32_t* indexViewIds = section<std::uint32_t>(TracksBinaryHeader::INDEX_VIEW_IDS);
+    const std::uint64_t* indexOffsets = section<std::uint64_t>(TracksBinaryHeader::INDEX_OFFSETS);
+    if (indexOffsets[0] != 0 || indexOffsets[nbIndexedViews] != nbIndexEntries || !std::is_sorted(indexOffsets, indexOffsets + nbIndexedViews + 1) ||
+        !std::is_sorted(indexViewIds, indexViewIds + nbIndexedViews))
+        throw std::runtime_error("Can't load tracks file, '" + path + "' has an invalid view index !");
+
+    const std::uint64_t* indexTracks = section<std::uint64_t>(TracksBinaryHeader::INDEX_TRACKS);
+    if (std::any_of(indexTracks, indexTracks + nbIndexEntries, [&](std::uint64_t position) { return position >= nbTracks; }))
+        throw std::runtime_error("Can't load tracks file, '" + path + "' has an invalid view index !");
+}
+
+void TracksBinaryFile::loadTracksAt(const std::vector<std::uint64_t>& positions, TracksMap& tracks) const
+{
+    const std::uint64_t* trackIds = section<std::uint64_t>(TracksBinaryHeader::TRACK_IDS);
+    const std::uint32_t* descTypes = section<std::uint32_t>(TracksBinaryHeader::DESC_TYPES);
+    const std::uint64_t* trackOffsets = section<std::uint64_t>(TracksBinaryHeader::TRACK_OFFSETS);
+    const std::uint32_t* viewIds = section<std::uint32_t>(TracksBinaryHeader::VIEW_IDS);
+    const std::uint32_t* featureIds = section<std::uint32_t>(TracksBinaryHeader::FEATURE_IDS);
+    const double* coords = section<double>(TracksBinaryHeader::COORDS);
+    const double* scales = section<double>(TracksBinaryHeader::SCALES);
+
+    tracks.clear();
+    tracks.reserve(positions.size());
+
+    // track ids are stored in increasing order: create the tracks, then fill them in parallel
+    for (const std::uint64_t position : positions)
+        tracks.emplace_hint(tracks.end(), trackIds[position], Track());
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (std::int64_t i = 0; i < static_cast<std::int64_t>(positions.size()); ++i)
+    {
+        const std::uint64_t position = positions[i];
+        Track& track = (tracks.begin() + i)->second;
+        track.descType = static_cast<feature::EImageDescriberType>(descTypes[position]);
+        track.featPerView.reserve(trackOffsets[position + 1] - trackOffsets[position]);
+        for (std::uint64_t o = trackOffsets[position]; o < trackOffsets[position + 1]; ++o)
+        {
+            TrackItem item;
+            item.featureId = featureIds[o];
+            item.coords = Vec2(coords[2 * o], coords[2 * o + 1]);
+            item.scale = scales[o];
+            track.featPerView.emplace_hint(track.featPerView.end(), viewIds[o], item);
+        }
+    }
+}
+
+void TracksBinaryFile::loadTracks(TracksMap& tracks) const
+{
+    std::vector<std::uint64_t> positions(_header.nbTracks);
+    for (std::size_t i = 0; i < positions.size(); ++i)
+        positions[i] = i;
+    loadTracksAt(positions, tracks);
+}
+
+void TracksBinaryFile::loadTracks(const std::set<IndexT>& viewIds, TracksMap& tracks) const
+{
+    const std::uint32_t* indexViewIds = section<std::uint32_t>(TracksBinaryHeader::INDEX_VIEW_IDS);
+    const std::uint64_t* indexOffsets = section<std::uint64_t>(TracksBinaryHeader::INDEX_OFFSETS);
+    const std::uint64_t* indexTracks = section<std::uint64_t>(TracksBinaryHeader::INDEX_TRACKS);
+    const std::uint32_t* indexViewIdsEnd = indexViewIds + _header.nbIndexedViews;
+
+    // merge the sorted track positions of all the requested views
+    std::vector<std::uint64_t> positions;
+    for (const IndexT viewId : viewIds)
+    {
+        const std::uint32_t* it = std::lower_bound(indexViewIds, indexViewIdsEnd, viewId);
+        if (it == indexViewIdsEnd || *it != viewId)
+            continue;
+        const std::size_t v = it - indexViewIds;
+        const std::size_t previousSize = positions.size();
+        positions.insert(positions.end(), indexTracks + indexOffsets[v], indexTracks + indexOffsets[v + 1]);
+        std::inplace_merge(positions.begin(), positions.begin() + previousSize, positions.end());
+    }
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+    loadTracksAt(positions, tracks);
+}
+
+bool isTracksBinaryFile(const std::string& path)
+{
+    std::ifstream fileIn(path, std::ios::in | std::ios::binary);
+    char magic[sizeof(TracksBinaryHeader::magicNumber)];
+    if (!fileIn.read(magic, sizeof(magic)))
+        return false;
+    return std::memcmp(magic, TracksBinaryHeader::magicNumber, sizeof(magic)) == 0;
+}
+
+bool saveTracksToBinFile(const std::string& path, const TracksMap& tracks)
+{
+    std::vector<std::uint64_t> trackIds;
+    std::vector<std::uint32_t> descTypes;
+    std::vector<std::uint64_t> trackOffsets;
+    std::vector<std::uint32_t> viewIds;
+    std::vector<std::uint32_t> featureIds;
+    std::vector<double> coords;
+    std::vector<double> scales;
+
+    trackIds.reserve(tracks.size());
+    descTypes.reserve(tracks.size());
+    trackOffsets.reserve(tracks.size() + 1);
+    trackOffsets.push_back(0);
+
+    // number of tracks per view, used to build the index
+    std::map<std::size_t, std::uint64_t> nbTracksPerView;
+
+    for (const auto& trackIt : tracks)
+    {
+        trackIds.push_back(trackIt.first);
+        descTypes.push_back(static_cast<std::uint32_t>(trackIt.second.descType));
+        for (const auto& featIt : trackIt.second.featPerView)
+        {
+            if (featIt.first > std::numeric_limits<std::uint32_t>::max() || featIt.second.featureId > std::numeric_limits<std::uint32_t>::max())
+                return false;
+            viewIds.push_back(static_cast<std::uint32_t>(featIt.first));
+            featureIds.push_back(static_cast<std::uint32_t>(featIt.second.featureId));
+            coords.push_back(featIt.second.coords(0));
+            coords.push_back(featIt.second.coords(1));
+            scales.push_back(featIt.second.scale);
+            ++nbTracksPerView[featIt.first];
+        }
+        trackOffsets.push_back(viewIds.size());
+    }
+
+    // per-view index: positions of the tracks observed in each view
+    std::vector<std::uint32_t> indexViewIds;
+    std::vector<std::uint64_t> indexOffsets;
+    indexViewIds.reserve(nbTracksPerView.size());
+    indexOffsets.reserve(nbTracksPerView.size() + 1);
+    indexOffsets.push_back(0);
+    std::map<std::size_t, std::uint64_t> fillPositions;
+    for (const auto& viewIt : nbTracksPerView)
+    {
+        indexViewIds.push_back(static_cast<std::uint32_t>(viewIt.first));
+        fillPositions[viewIt.first] = indexOffsets.back();
+        indexOffsets.push_back(indexOffsets.back() + viewIt.second);
+    }
+    std::vector<std::uint64_t> indexTracks(indexOffsets.back());
+    for (std::size_t t = 0; t < trackIds.size(); ++t)
+    {
+        for (std::uint64_t o = trackOffsets[t]; o < trackOffsets[t + 1]; ++o)
+            indexTracks[fillPositions[viewIds[o]]++] = t;
+    }
+
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    TracksBinaryHeader header;
+    std::memset(&header, 0, sizeof(TracksBinaryHeader));
+    std::memcpy(header.magic, TracksBinaryHeader::magicNumber, sizeof(header.magic));
+    header.version = TracksBinaryHeader::currentVersion;
+    header.nbTracks = trackIds.size();
+    header.nbObservations = viewIds.size();
+    header.nbIndexedViews = indexViewIds.size();
+    header.nbIndexEntries = indexTracks.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(TracksBinaryHeader));
+
+    system::writeSection(file, header, TracksBinaryHeader::TRACK_IDS, trackIds.data(), trackIds.size());
+    system::writeSection(file, header, TracksBinaryHeader::DESC_TYPES, descTypes.data(), descTypes.size());
+    system::writeSection(file, header, TracksBinaryHeader::TRACK_OFFSETS, trackOffsets.data(), trackOffsets.size());
+    system::writeSection(file, header, TracksBinaryHeader::VIEW_IDS, viewIds.data(), viewIds.size());
+    system::writeSection(file, header, TracksBinaryHeader::FEATURE_IDS, featureIds.data(), featureIds.size());
+    system::writeSection(file, header, TracksBinaryHeader::COORDS, coords.data(), coords.size());
+    system::writeSection(file, header, TracksBinaryHeader::SCALES, scales.data(), scales.size());
+    system::writeSection(file, header, TracksBinaryHeader::INDEX_VIEW_IDS, indexViewIds.data(), indexViewIds.size());
+    system::writeSection(file, header, TracksBinaryHeader::INDEX_OFFSETS, indexOffsets.data(), indexOffsets.size());
+    system::writeSection(file, header, TracksBinaryHeader::INDEX_TRACKS, indexTracks.data(), indexTracks.size());
+    system::alignStream(file);
+
+    // rewrite the header with the sections location
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(TracksBinaryHeader));
+
+    return file.good();
+}
+
+bool saveTracks(const std::string& path, const TracksMap& tracks, ETracksFileFormat format)
+{
+    if (format == ETracksFileFormat::Binary)
+        return saveTracksToBinFile(path, tracks);
+
+    std::ofstream file(path);
+    if (!file.is_open())
+        return false;
+    file << boost::json::serialize(boost::json::value_from(tracks));
+    return file.good();
+}
+
+bool loadTracks(const std::string& path, TracksMap& tracks)
+{
+    if (isTracksBinaryFile(path))
+    {
+        TracksBinaryFile(path).loadTracks(tracks);
+        return true;
+    }
+
+    std::ifstream file(path);
+    if (!file.is_open())
+        return false;
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const boost::json::value jv = boost::json::parse(buffer.str());
+    tracks = TracksMap(flat_map_value_to<Track>(jv));
+    return true;
+}
+
 }  // namespace track
 }  // namespace aliceVision
@@ -7,9 +7,15 @@
 #pragma once
 
 #include <aliceVision/track/Track.hpp>
+#include <aliceVision/system/MappedFile.hpp>
 
 #include <boost/json.hpp>
 
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <string>
+
 namespace aliceVision {
 namespace track {
 
@@ -39,5 +45,158 @@ void tag_invoke(const boost::json::value_from_tag&, boost::json::value& jv, alic
  */
 aliceVision::track::Track tag_invoke(boost::json::value_to_tag<aliceVision::track::Track>, boost::json::value const& jv);
 
+/**
+ * @brief Tracks file storage format.
+ */
+enum class ETracksFileFormat
+{
+    /// Array of [trackId, track] JSON values
+    JSON = 0,
+    /// Columnar binary container with a per-view index (see TracksBinaryHeader)
+    Binary
+};
+
+inline std::string ETracksFileFormat_enumToString(ETracksFileFormat format)
+{
+    switch (format)
+    {
+        case ETracksFileFormat::JSON:
+            return "json";
+        case ETracksFileFormat::Binary:
+            return "binary";
+    }
+    throw std::out_of_range("Invalid tracks file format enum");
+}
+
+inline ETracksFileFormat ETracksFileFormat_stringToEnum(const std::string& format)
+{
+    if (format == "json")
+        return ETracksFileFormat::JSON;
+    if (format == "binary")
+        return ETracksFileFormat::Binary;
+    throw std::out_of_range("Invalid tracks file format: " + format);
+}
+
+inline std::ostream& operator<<(std::ostream& os, ETracksFileFormat e) { return os << ETracksFileFormat_enumToString(e); }
+
+inline std::istream& operator>>(std::istream& in, ETracksFileFormat& format)
+{
+    std::string token(std::istreambuf_iterator<char>(in), {});
+    format = ETracksFileFormat_stringToEnum(token);
+    return in;
+}
+
+/**
+ * @brief Header of a binary tracks file.
+ *
+ * The data are stored by columns, each section starting on an 8-byte boundary:
+ * - per track: trackIds (uint64), descTypes (uint32), observation offsets (uint64, nbTracks + 1 values)
+ * - per observation: viewIds (uint32), featureIds (uint32), coords (2 x float64), scales (float64)
+ * - per-view index: indexed viewIds (uint32), offsets (uint64, nbIndexedViews + 1 values),
+ *   positions of the tracks observed in each view (uint64, sorted)
+ * Values are little-endian, so the file can be memory-mapped and read in place.
+ */
+struct TracksBinaryHeader
+{
+    static constexpr char magicNumber[8] = {'A', 'V', 'T', 'R', 'A', 'C', 'K', 'B'};
+    static constexpr std::uint32_t currentVersion = 1;
+
+    enum ESection
+    {
+        TRACK_IDS = 0,
+        DESC_TYPES,
+        TRACK_OFFSETS,
+        VIEW_IDS,
+        FEATURE_IDS,
+        COORDS,
+        SCALES,
+        INDEX_VIEW_IDS,
+        INDEX_OFFSETS,
+        INDEX_TRACKS,
+        NB_SECTIONS
+    };
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t nbTracks;
+    std::uint64_t nbObservations;
+    std::uint64_t nbIndexedViews;
+    std::uint64_t nbIndexEntries;
+    std::uint64_t sectionOffsets[NB_SECTIONS];
+};
+static_assert(sizeof(TracksBinaryHeader) == 128, "TracksBinaryHeader must not be padded");
+
+/**
+ * @brief Read-only access to a binary tracks file.
+ * The file is memory-mapped: tracks are decoded on demand and the per-view index
+ * allows to load only the tracks observed in a subset of views.
+ */
+class TracksBinaryFile
+{
+  public:
+    /**
+     * @brief Open a binary tracks file.
+     * @param[in] path the tracks file path
+     * @throw std::runtime_error if the file is not a valid binary tracks file
+     */
+    explicit TracksBinaryFile(const std::string& path);
+
+    std::size_t nbTracks() const { return _header.nbTracks; }
+    std::size_t nbObservations() const { return _header.nbObservations; }
+
+    /// Load all the tracks.
+    void loadTracks(TracksMap& tracks) const;
+
+    /// Load the tracks observed in at least one of the given views (with all their observations).
+    void loadTracks(const std::set<IndexT>& viewIds, TracksMap& tracks) const;
+
+  private:
+    template<typename T>
+    const T* section(TracksBinaryHeader::ESection s) const
+    {
+        return reinterpret_cast<const T*>(_file.data() + _header.sectionOffsets[s]);
+    }
+
+    /// Load the tracks at the given positions (sorted) in the file
+    void loadTracksAt(const std::vector<std::uint64_t>& positions, TracksMap& tracks) const;
+
+    std::string _path;
+    system::MappedFile _file;
+    TracksBinaryHeader _header;
+};
+
+/**
+ * @brief Check if a tracks file is stored in the binary format.
+ * @param[in] path the tracks file path
+ * @return true if the file starts with the binary tracks magic number
+ */
+bool isTracksBinaryFile(const std::string& path);
+
+/**
+ * @brief Save tracks in the binary format.
+ * @param[in] path the tracks file path
+ * @param[in] tracks the tracks to save
+ * @return false if the file cannot be written or if a view or feature id does not fit in 32 bits
+ */
+bool saveTracksToBinFile(const std::string& path, const TracksMap& tracks);
+
+/**
+ * @brief Save tracks to a file.
+ * @param[in] path the tracks file path
+ * @param[in] tracks the tracks to save
+ * @param[in] format the file format
+ * @return true if the file has been written
+ */
+bool saveTracks(const std::string& path, const TracksMap& tracks, ETracksFileFormat format = ETracksFileFormat::JSON);
+
+/**
+ * @brief Load tracks from a JSON or binary tracks file (the format is detected from the file content).
+ * @param[in] path the tracks file path
+ * @param[out] tracks the loaded tracks
+ * @return false if the file cannot be opened
+ */
+bool loadTracks(const std::string& path, TracksMap& tracks);
+
 }  // namespace track
 }  // namespace aliceVision
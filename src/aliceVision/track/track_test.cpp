@@ -7,8 +7,17 @@
 
 #include "aliceVision/track/TracksBuilder.hpp"
 #include "aliceVision/track/tracksUtils.hpp"
+#include "aliceVision/track/trackIO.hpp"
+#include "aliceVision/track/TracksStorage.hpp"
 #include "aliceVision/matching/IndMatch.hpp"
 
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
 #include <vector>
 #include <utility>
 
@@ -221,3 +230,349 @@ BOOST_AUTO_TEST_CASE(Track_GetCommonTracksInImages)
         BOOST_CHECK_EQUAL(base.size(), set_visibleTracks.size());
     }
 }
+
+namespace {
+
+/**
+ * @brief Generate the matches of a synthetic scene: each 3D point is seen by a random set of views
+ * with a random feature index, and matched between all the pairs of views closer than pairWindow.
+ * Some outlier matches are added between random features to create forks.
+ */
+PairwiseMatches generateSyntheticMatches(std::mt19937& gen,
+                                         std::size_t nbViews,
+                                         std::size_t nbPoints,
+                                         std::size_t nbFeaturesPerView,
+                                         std::size_t pairWindow,
+                                         std::size_t nbOutliersPerPair)
+{
+    std::uniform_real_distribution<double> visibility(0.0, 1.0);
+    std::uniform_int_distribution<std::size_t> randomFeature(0, nbFeaturesPerView - 1);
+
+    // featureIndex[view][point]: index of the observation of the point in the view (-1 if not visible)
+    std::vector<std::vector<int>> featureIndex(nbViews, std::vector<int>(nbPoints, -1));
+    for (std::size_t v = 0; v < nbViews; ++v)
+    {
+        std::vector<int> permutation(nbFeaturesPerView);
+        std::iota(permutation.begin(), permutation.end(), 0);
+        std::shuffle(permutation.begin(), permutation.end(), gen);
+        for (std::size_t p = 0; p < nbPoints; ++p)
+        {
+            if (visibility(gen) < 0.3)
+                featureIndex[v][p] = permutation[p];
+        }
+    }
+
+    PairwiseMatches pairwiseMatches;
+    for (std::size_t I = 0; I < nbViews; ++I)
+    {
+        for (std::size_t J = I + 1; J < std::min(nbViews, I + 1 + pairWindow); ++J)
+        {
+            IndMatches& matches = pairwiseMatches[std::make_pair(I, J)][EImageDescriberType::SIFT];
+            for (std::size_t p = 0; p < nbPoints; ++p)
+            {
+                if (featureIndex[I][p] >= 0 && featureIndex[J][p] >= 0)
+                    matches.emplace_back(featureIndex[I][p], featureIndex[J][p]);
+            }
+            for (std::size_t o = 0; o < nbOutliersPerPair; ++o)
+                matches.emplace_back(randomFeature(gen), randomFeature(gen));
+        }
+    }
+    return pairwiseMatches;
+}
+
+using Observation = std::pair<std::size_t, std::size_t>;
+
+/// Straightforward connected components of the matches, ordered by their smallest observation
+std::vector<std::set<Observation>> computeReferenceTracks(const PairwiseMatches& pairwiseMatches)
+{
+    std::map<Observation, std::vector<Observation>> neighbours;
+    for (const auto& matchesPerDesc : pairwiseMatches)
+    {
+        for (const auto& matches : matchesPerDesc.second)
+        {
+            for (const IndMatch& m : matches.second)
+            {
+                const Observation obsI(matchesPerDesc.first.first, m._i);
+                const Observation obsJ(matchesPerDesc.first.second, m._j);
+                neighbours[obsI].push_back(obsJ);
+                neighbours[obsJ].push_back(obsI);
+            }
+        }
+    }
+
+    std::vector<std::set<Observation>> tracks;
+    std::set<Observation> visited;
+    for (const auto& it : neighbours)
+    {
+        if (visited.count(it.first))
+            continue;
+        std::set<Observation> track;
+        std::vector<Observation> toVisit{it.first};
+        visited.insert(it.first);
+        while (!toVisit.empty())
+        {
+            const Observation obs = toVisit.back();
+            toVisit.pop_back();
+            track.insert(obs);
+            for (const Observation& n : neighbours.at(obs))
+            {
+                if (visited.insert(n).second)
+                    toVisit.push_back(n);
+            }
+        }
+        tracks.push_back(track);
+    }
+    return tracks;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(Track_SyntheticGraph_Reference)
+{
+    std::mt19937 gen(42);
+    const PairwiseMatches pairwiseMatches = generateSyntheticMatches(gen, 30, 5000, 6000, 5, 20);
+
+    TracksBuilder trackBuilder;
+    trackBuilder.build(pairwiseMatches);
+    TracksMap tracks;
+    trackBuilder.exportToSTL(tracks);
+
+    const std::vector<std::set<Observation>> referenceTracks = computeReferenceTracks(pairwiseMatches);
+    BOOST_REQUIRE_EQUAL(referenceTracks.size(), tracks.size());
+    BOOST_CHECK_EQUAL(referenceTracks.size(), trackBuilder.nbTracks());
+
+    std::size_t nbTracksWithForks = 0;
+    for (std::size_t i = 0; i < referenceTracks.size(); ++i)
+    {
+        const Track& track = tracks.at(i);
+        std::set<std::size_t> referenceViews;
+        for (const Observation& obs : referenceTracks[i])
+            referenceViews.insert(obs.first);
+
+        if (referenceViews.size() != referenceTracks[i].size())
+        {
+            // forks: only the views can be compared
+            ++nbTracksWithForks;
+            BOOST_CHECK_EQUAL(referenceViews.size(), track.featPerView.size());
+            continue;
+        }
+
+        std::set<Observation> observations;
+        for (const auto& featIt : track.featPerView)
+            observations.emplace(featIt.first, featIt.second.featureId);
+        BOOST_CHECK(observations == referenceTracks[i]);
+        BOOST_CHECK(track.descType == EImageDescriberType::SIFT);
+    }
+    BOOST_CHECK_GT(nbTracksWithForks, 0);
+
+    // filtering removes exactly the tracks with forks or seen in less than 3 views
+    std::size_t nbValidTracks = 0;
+    for (const std::set<Observation>& referenceTrack : referenceTracks)
+    {
+        std::set<std::size_t> referenceViews;
+        for (const Observation& obs : referenceTrack)
+            referenceViews.insert(obs.first);
+        if (referenceViews.size() == referenceTrack.size() && referenceViews.size() >= 3)
+            ++nbValidTracks;
+    }
+    trackBuilder.filter(true, 3);
+    BOOST_CHECK_EQUAL(nbValidTracks, trackBuilder.nbTracks());
+}
+
+BOOST_AUTO_TEST_CASE(Track_FilterBeforeBuild)
+{
+    TracksBuilder trackBuilder;
+    trackBuilder.filter();
+    BOOST_CHECK_EQUAL(0, trackBuilder.nbTracks());
+
+    TracksMap tracks;
+    trackBuilder.exportToSTL(tracks);
+    BOOST_CHECK(tracks.empty());
+}
+
+BOOST_AUTO_TEST_CASE(Track_BinaryIO)
+{
+    std::mt19937 gen(42);
+    const PairwiseMatches pairwiseMatches = generateSyntheticMatches(gen, 20, 2000, 3000, 4, 0);
+
+    TracksBuilder trackBuilder;
+    trackBuilder.build(pairwiseMatches);
+    trackBuilder.filter(true, 2);
+    TracksMap tracks;
+    trackBuilder.exportToSTL(tracks);
+
+    // remove some tracks to have non contiguous track ids
+    for (std::size_t trackId = 0; trackId < tracks.size(); trackId += 7)
+        tracks.erase(trackId);
+
+    std::uniform_real_distribution<double> dist(0.0, 1000.0);
+    for (auto& trackIt : tracks)
+    {
+        for (auto& featIt : trackIt.second.featPerView)
+        {
+            featIt.second.coords = aliceVision::Vec2(dist(gen), dist(gen));
+            featIt.second.scale = dist(gen);
+        }
+    }
+
+    const std::string path = (std::filesystem::temp_directory_path() / "Track_BinaryIO.tracks").string();
+    BOOST_REQUIRE(saveTracks(path, tracks, ETracksFileFormat::Binary));
+    BOOST_CHECK(isTracksBinaryFile(path));
+
+    auto checkEqual = [](const Track& a, const Track& b) {
+        BOOST_CHECK(a.descType == b.descType);
+        BOOST_REQUIRE_EQUAL(a.featPerView.size(), b.featPerView.size());
+        for (auto itA = a.featPerView.begin(), itB = b.featPerView.begin(); itA != a.featPerView.end(); ++itA, ++itB)
+        {
+            BOOST_CHECK_EQUAL(itA->first, itB->first);
+            BOOST_CHECK_EQUAL(itA->second.featureId, itB->second.featureId);
+            BOOST_CHECK_EQUAL(itA->second.coords(0), itB->second.coords(0));
+            BOOST_CHECK_EQUAL(itA->second.coords(1), itB->second.coords(1));
+            BOOST_CHECK_EQUAL(itA->second.scale, itB->second.scale);
+        }
+    };
+
+    // load everything
+    {
+        TracksMap loadedTracks;
+        BOOST_CHECK(loadTracks(path, loadedTracks));
+        BOOST_REQUIRE_EQUAL(tracks.size(), loadedTracks.size());
+        for (auto it = tracks.begin(), itLoaded = loadedTracks.begin(); it != tracks.end(); ++it, ++itLoaded)
+        {
+            BOOST_CHECK_EQUAL(it->first, itLoaded->first);
+            checkEqual(it->second, itLoaded->second);
+        }
+    }
+
+    // load the tracks of a subset of views through the per-view index
+    {
+        const std::set<aliceVision::IndexT> viewIds{3, 4, 12};
+        TracksMap loadedTracks;
+        TracksBinaryFile(path).loadTracks(viewIds, loadedTracks);
+
+        std::size_t nbExpectedTracks = 0;
+        for (const auto& trackIt : tracks)
+        {
+            bool isObserved = false;
+            for (const aliceVision::IndexT viewId : viewIds)
+                isObserved = isObserved || trackIt.second.featPerView.count(viewId);
+            if (!isObserved)
+                continue;
+            ++nbExpectedTracks;
+            BOOST_REQUIRE(loadedTracks.count(trackIt.first));
+            checkEqual(trackIt.second, loadedTracks.at(trackIt.first));
+        }
+        BOOST_CHECK_EQUAL(nbExpectedTracks, loadedTracks.size());
+    }
+
+    // a truncated file is rejected
+    {
+        const std::string truncatedPath = path + ".truncated";
+        std::filesystem::copy_file(path, truncatedPath, std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::resize_file(truncatedPath, std::filesystem::file_size(path) / 2);
+        TracksMap loadedTracks;
+        BOOST_CHECK_THROW(loadTracks(truncatedPath, loadedTracks), std::runtime_error);
+        std::filesystem::remove(truncatedPath);
+    }
+
+    // a view index pointing outside of the tracks is rejected
+    {
+        const std::string corruptedPath = path + ".corrupted";
+        std::filesystem::copy_file(path, corruptedPath, std::filesystem::copy_options::overwrite_existing);
+        TracksBinaryHeader header;
+        {
+            std::ifstream fileIn(corruptedPath, std::ios::in | std::ios::binary);
+            fileIn.read(reinterpret_cast<char*>(&header), sizeof(TracksBinaryHeader));
+        }
+        {
+            std::fstream file(corruptedPath, std::ios::in | std::ios::out | std::ios::binary);
+            const std::uint64_t invalidPosition = header.nbTracks;
+            file.seekp(header.sectionOffsets[TracksBinaryHeader::INDEX_TRACKS]);
+            file.write(reinterpret_cast<const char*>(&invalidPosition), sizeof(invalidPosition));
+        }
+        BOOST_CHECK_THROW(TracksBinaryFile{corruptedPath}, std::runtime_error);
+        std::filesystem::remove(corruptedPath);
+    }
+
+    std::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(Track_TracksStorage)
+{
+    std::mt19937 gen(42);
+    const PairwiseMatches pairwiseMatches = generateSyntheticMatches(gen, 20, 2000, 3000, 4, 10);
+
+    TracksBuilder trackBuilder;
+    trackBuilder.build(pairwiseMatches);
+    trackBuilder.filter(true, 2);
+    TracksMap tracks;
+    trackBuilder.exportToSTL(tracks);
+
+    // remove some tracks to have non contiguous track ids
+    for (std::size_t trackId = 0; trackId < tracks.size(); trackId += 7)
+        tracks.erase(trackId);
+    BOOST_REQUIRE(!tracks.empty());
+
+    TracksPerView tracksPerView;
+    computeTracksPerView(tracks, tracksPerView);
+
+    const TracksStorage storage(tracks);
+    BOOST_CHECK_EQUAL(storage.nbTracks(), tracks.size());
+    BOOST_CHECK_EQUAL(storage.nbViews(), tracksPerView.size());
+
+    std::size_t nbObservations = 0;
+    for (const auto& trackIt : tracks)
+    {
+        nbObservations += trackIt.second.featPerView.size();
+
+        const std::size_t trackIndex = storage.getTrackIndex(trackIt.first);
+        BOOST_REQUIRE(trackIndex != TracksStorage::invalidIndex);
+        BOOST_CHECK_EQUAL(storage.getTrackId(trackIndex), trackIt.first);
+        BOOST_CHECK_EQUAL(storage.getTrackLength(trackIndex), trackIt.second.featPerView.size());
+
+        Track track;
+        storage.getTrack(trackIndex, track);
+        BOOST_CHECK(track.descType == trackIt.second.descType);
+        BOOST_REQUIRE_EQUAL(track.featPerView.size(), trackIt.second.featPerView.size());
+        for (const auto& featIt : trackIt.second.featPerView)
+        {
+            BOOST_CHECK_EQUAL(track.featPerView.at(featIt.first).featureId, featIt.second.featureId);
+
+            const TrackObservation* obs = storage.findObservation(trackIndex, featIt.first);
+            BOOST_REQUIRE(obs != nullptr);
+            BOOST_CHECK_EQUAL(obs->featureId, featIt.second.featureId);
+        }
+        BOOST_CHECK(storage.findObservation(trackIndex, 1000) == nullptr);
+    }
+    BOOST_CHECK_EQUAL(storage.nbObservations(), nbObservations);
+    BOOST_CHECK(!storage.hasTrack(0));
+    BOOST_CHECK(!storage.hasTrack(tracks.rbegin()->first + 1));
+
+    // tracks per view
+    for (const auto& viewIt : tracksPerView)
+    {
+        std::vector<std::size_t> viewTrackIds;
+        for (aliceVision::IndexT trackIndex : storage.getViewTrackIndexes(viewIt.first))
+            viewTrackIds.push_back(storage.getTrackId(trackIndex));
+        BOOST_CHECK(viewTrackIds == viewIt.second);
+    }
+    BOOST_CHECK(storage.getViewTrackIndexes(1000).empty());
+
+    // common tracks
+    for (std::size_t I = 0; I < 5; ++I)
+    {
+        const std::set<std::size_t> viewIds = {I, I + 1, I + 2};
+        TracksMap expected;
+        getCommonTracksInImagesFast(viewIds, tracks, tracksPerView, expected);
+        TracksMap commonTracks;
+        BOOST_CHECK_EQUAL(storage.getCommonTracks(viewIds, commonTracks), !expected.empty());
+        BOOST_REQUIRE_EQUAL(commonTracks.size(), expected.size());
+        for (const auto& trackIt : expected)
+        {
+            const Track& track = commonTracks.at(trackIt.first);
+            BOOST_REQUIRE_EQUAL(track.featPerView.size(), viewIds.size());
+            for (const auto& featIt : trackIt.second.featPerView)
+                BOOST_CHECK_EQUAL(track.featPerView.at(featIt.first).featureId, featIt.second.featureId);
+        }
+    }
+}
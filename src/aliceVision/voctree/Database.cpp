@@ -5,9 +5,9 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "Database.hpp"
-#include <aliceVision/system/ProgressDisplay.hpp>
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/tail.hpp>
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <stdexcept>
@@ -16,6 +16,79 @@
 namespace aliceVision {
 namespace voctree {
 
+namespace {
+
+/// Distance methods computed from the inverted files
+enum class EInvertedFileMethod
+{
+    CLASSIC,
+    COMMON_POINTS,
+    STRONG_COMMON_POINTS,
+    INVERSED_WEIGHTED_COMMON_POINTS,
+    NONE  // compared with each document
+};
+
+EInvertedFileMethod getInvertedFileMethod(const std::string& distanceMethod)
+{
+    if (distanceMethod == "classic")
+        return EInvertedFileMethod::CLASSIC;
+    if (distanceMethod == "commonPoints")
+        return EInvertedFileMethod::COMMON_POINTS;
+    if (distanceMethod == "strongCommonPoints")
+        return EInvertedFileMethod::STRONG_COMMON_POINTS;
+    if (distanceMethod == "inversedWeightedCommonPoints")
+        return EInvertedFileMethod::INVERSED_WEIGHTED_COMMON_POINTS;
+    if (distanceMethod == "weightedStrongCommonPoints")
+        return EInvertedFileMethod::NONE;
+    throw std::invalid_argument("distance method " + distanceMethod + " unknown!");
+}
+
+/// Best matches first: lowest score, then lowest document id
+inline bool isBetterMatch(const DocMatch& a, const DocMatch& b) { return a.score < b.score || (a.score == b.score && a.id < b.id); }
+
+/**
+ * @brief Keep the N best matches of a sequence of matches in a bounded max-heap.
+ */
+class TopMatches
+{
+  public:
+    TopMatches(std::size_t N, std::size_t nbMatchesMax)
+      : _N(N)
+    {
+        _heap.reserve(std::min(N, nbMatchesMax));
+    }
+
+    void push(const DocMatch& match)
+    {
+        if (_heap.size() < _N)
+        {
+            _heap.push_back(match);
+            std::push_heap(_heap.begin(), _heap.end(), isBetterMatch);
+        }
+        else if (_N > 0 && isBetterMatch(match, _heap.front()))
+        {
+            // replace the worst kept match
+            std::pop_heap(_heap.begin(), _heap.end(), isBetterMatch);
+            _heap.back() = match;
+            std::push_heap(_heap.begin(), _heap.end(), isBetterMatch);
+        }
+    }
+
+    /// Get the kept matches, from best to worst
+    void get(std::vector<DocMatch>& matches)
+    {
+        std::sort_heap(_heap.begin(), _heap.end(), isBetterMatch);
+        matches.swap(_heap);
+        _heap.clear();
+    }
+
+  private:
+    const std::size_t _N;
+    std::vector<DocMatch> _heap;
+};
+
+}  // namespace
+
 std::ostream& operator<<(std::ostream& os, const SparseHistogram& dv)
 {
     for (const auto& e : dv)
@@ -47,18 +120,24 @@ DocId Database::insert(DocId doc_id, const SparseHistogram& document)
     // Ensure that the new document to insert is not already there.
     assert(database_.find(doc_id) == database_.end());
 
+    const uint32_t docIndex = doc_ids_.size();
+    uint32_t docSize = 0;
+
     // For each word, retrieve its inverted file and increment the count for doc_id.
     for (SparseHistogram::const_iterator it = document.begin(), end = document.end(); it != end; ++it)
     {
         Word word = it->first;
         InvertedFile& file = word_files_[word];
-        if (file.empty() || file.back().id != doc_id)
-            file.push_back(WordFrequency(doc_id, it->second.size()));
+        if (file.empty() || file.back().docIndex != docIndex)
+            file.push_back(WordFrequency(docIndex, it->second.size()));
         else
             file.back().count += it->second.size();
+        docSize += it->second.size();
     }
 
     database_[doc_id] = document;
+    doc_ids_.push_back(doc_id);
+    doc_sizes_.push_back(docSize);
 
     return doc_id;
 }
@@ -79,19 +158,19 @@ void Database::sanityCheck(std::size_t N, std::map<std::size_t, DocMatches>& mat
     }
 
     matches.clear();
-    // since we already know the size of the vectors, in order to parallelize the
-    // query allocate the whole memory
-    auto display = system::createConsoleProgressDisplay(database_.size(), std::cout);
 
-    // #pragma omp parallel for default(none) shared(database_)
+    std::vector<const SparseHistogram*> queries;
+    queries.reserve(database_.size());
     for (const auto& doc : database_)
-    {
-        std::vector<DocMatch> m;
-        find(doc.second, N, m);
-        //		matches.emplace_back( m );
-        matches[doc.first] = m;
-        ++display;
-    }
+        queries.push_back(&doc.second);
+
+    // query all the documents in parallel
+    std::vector<DocMatches> queriesMatches;
+    find(queries, N, queriesMatches);
+
+    std::size_t i = 0;
+    for (const auto& doc : database_)
+        matches[doc.first].swap(queriesMatches[i++]);
 }
 
 /**
@@ -115,12 +194,128 @@ void Database::find(const std::vector<Word>& document, std::size_t N, std::vecto
 /**
  * @brief Find the top N matches in the database for the query document.
  *
+ * Only the documents sharing words with the query are visited, through the inverted files of the query words.
+ * The scores are accumulated in increasing word order, so they are identical to the sparseDistance ones.
+ *
  * @param      query The query document, a normalized set of quantized words.
  * @param      N        The number of matches to return.
  * @param[out] matches  IDs and scores for the top N matching database documents.
  * @param[in] distanceMethod the method used to compute distance between histograms.
  */
 void Database::find(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string& distanceMethod) const
+{
+    const EInvertedFileMethod method = getInvertedFileMethod(distanceMethod);
+
+    if (method == EInvertedFileMethod::NONE)
+    {
+        findExhaustive(query, N, matches, distanceMethod);
+        return;
+    }
+
+    const std::size_t nbDocs = doc_ids_.size();
+
+    // accumulate the contributions of the words shared by the query and each document
+    std::vector<float> commonScores(nbDocs, 0.0f);
+    std::vector<char> isTouched(nbDocs, 0);
+    std::vector<uint32_t> touchedDocs;
+    uint32_t querySize = 0;
+
+    for (const auto& wordIt : query)
+    {
+        const uint32_t queryCount = wordIt.second.size();
+        querySize += queryCount;
+
+        if (wordIt.first < 0 || wordIt.first >= static_cast<Word>(word_files_.size()))
+            continue;
+
+        for (const WordFrequency& wordFrequency : word_files_[wordIt.first])
+        {
+            const uint32_t minCount = std::min(queryCount, wordFrequency.count);
+            float& score = commonScores[wordFrequency.docIndex];
+
+            switch (method)
+            {
+                case EInvertedFileMethod::CLASSIC:
+                case EInvertedFileMethod::COMMON_POINTS:
+                    score += minCount;
+                    break;
+                case EInvertedFileMethod::STRONG_COMMON_POINTS:
+                    if (queryCount == 1 && wordFrequency.count == 1)
+                        score += 1;
+                    break;
+                case EInvertedFileMethod::INVERSED_WEIGHTED_COMMON_POINTS:
+                    score += (1.f / static_cast<int>(minCount)) * word_weights_[wordIt.first];
+                    break;
+                case EInvertedFileMethod::NONE:
+                    break;
+            }
+
+            if (!isTouched[wordFrequency.docIndex])
+            {
+                isTouched[wordFrequency.docIndex] = 1;
+                touchedDocs.push_back(wordFrequency.docIndex);
+            }
+        }
+    }
+
+    // distance of a document from its common words score
+    const auto distance = [&](uint32_t docIndex) {
+        if (method == EInvertedFileMethod::CLASSIC)
+        {
+            // L1 distance of the histograms: |Q| + |D| - 2 * sum(min(q_i, d_i))
+            return static_cast<float>(querySize + doc_sizes_[docIndex]) - 2.0f * commonScores[docIndex];
+        }
+        return -commonScores[docIndex];
+    };
+
+    if (method != EInvertedFileMethod::CLASSIC)
+    {
+        // the documents without common words have a null distance,
+        // so the best matches are the documents with a negative distance if there are enough
+        TopMatches topMatches(N, touchedDocs.size());
+        std::size_t nbCandidates = 0;
+        for (const uint32_t docIndex : touchedDocs)
+        {
+            const float docDistance = distance(docIndex);
+            if (docDistance < 0.0f)
+            {
+                topMatches.push(DocMatch(doc_ids_[docIndex], docDistance));
+                ++nbCandidates;
+            }
+        }
+
+        if (nbCandidates >= N)
+        {
+            topMatches.get(matches);
+            return;
+        }
+    }
+
+    // all the documents are needed
+    TopMatches topMatches(N, nbDocs);
+    for (uint32_t docIndex = 0; docIndex < nbDocs; ++docIndex)
+        topMatches.push(DocMatch(doc_ids_[docIndex], distance(docIndex)));
+    topMatches.get(matches);
+}
+
+void Database::find(const std::vector<const SparseHistogram*>& queries,
+                    std::size_t N,
+                    std::vector<DocMatches>& matches,
+                    const std::string& distanceMethod) const
+{
+    // check the distance method before the parallel section
+    getInvertedFileMethod(distanceMethod);
+
+    matches.resize(queries.size());
+
+#pragma omp parallel for schedule(dynamic)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(queries.size()); ++i)
+    {
+        find(*queries[i], N, matches[i], distanceMethod);
+    }
+}
+
+void Database::findExhaustive(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string& distanceMethod) const
 {
     matches.clear();
     matches.reserve(database_.size());
@@ -132,7 +327,7 @@ void Database::find(const SparseHistogram& query, std::size_t N, std::vector<Doc
         matches.emplace_back(document.first, distance);
     }
     const std::size_t nMatches = std::min(N, matches.size());
-    std::partial_sort(matches.begin(), matches.begin() + nMatches, matches.end());
+    std::partial_sort(matches.begin(), matches.begin() + nMatches, matches.end(), isBetterMatch);
     matches.resize(nMatches);
 }
 
@@ -46,6 +46,10 @@ std::ostream& operator<<(std::ostream& os, const DocMatches& matches);
 /**
  * @brief Class for efficiently matching a bag-of-words representation of a document (image) against
  * a database of known documents.
+ *
+ * Queries accumulate the scores over the inverted files (word -> documents) of the query words only,
+ * instead of comparing the query histogram with each document histogram.
+ * The returned matches are sorted by increasing score, ties being broken by increasing document id.
  */
 class Database
 {
@@ -102,6 +106,19 @@ class Database
               std::vector<DocMatch>& matches,
               const std::string& distanceMethod = "strongCommonPoints") const;
 
+    /**
+     * @brief Find the top N matches in the database for each query document, queries are processed in parallel.
+     *
+     * @param[in] queries The query documents, normalized sets of quantized words.
+     * @param[in] N        The number of matches to return per query.
+     * @param[out] matches  IDs and scores for the top N matching database documents, per query.
+     * @param[in] distanceMethod distance method (norm L1, etc.)
+     */
+    void find(const std::vector<const SparseHistogram*>& queries,
+              std::size_t N,
+              std::vector<DocMatches>& matches,
+              const std::string& distanceMethod = "strongCommonPoints") const;
+
     /**
      * @brief Compute the TF-IDF weights of all the words. To be called after inserting a corpus of
      * training examples into the database.
@@ -130,17 +147,17 @@ class Database
   private:
     struct WordFrequency
     {
-        DocId id;
+        uint32_t docIndex;  // index of the document in doc_ids_
         uint32_t count;
 
         WordFrequency() = default;
-        WordFrequency(DocId _id, uint32_t _count)
-          : id(_id),
+        WordFrequency(uint32_t _docIndex, uint32_t _count)
+          : docIndex(_docIndex),
             count(_count)
         {}
     };
 
-    // Stored in increasing order by DocId
+    // Stored in increasing order by document insertion
     typedef std::vector<WordFrequency> InvertedFile;
 
     /// @todo Use sorted vector?
@@ -151,6 +168,14 @@ class Database
     std::vector<InvertedFile> word_files_;
     std::vector<float> word_weights_;
     SparseHistogramPerImage database_;  // Precomputed for inserted documents
+    std::vector<DocId> doc_ids_;        // Document ids, in insertion order
+    std::vector<uint32_t> doc_sizes_;   // Number of words per document, in insertion order
+
+    /**
+     * @brief Find the top N matches by comparing the query with each document of the database.
+     * Used for the distance methods without an inverted file implementation.
+     */
+    void findExhaustive(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string& distanceMethod) const;
 
     /**
      * Normalize a document vector representing the histogram of visual words for a given image
@@ -34,13 +34,24 @@ class MutableVocabularyTree : public VocabularyTree<Feature, Distance>
 
     uint32_t nodes() const { return this->word_start_ + this->num_words_; }
 
-    std::vector<Feature>& centers() { return this->centers_; }
+    /// Mutable access to the centers, the batched quantization is disabled until the tree is loaded again
+    std::vector<Feature>& centers()
+    {
+        this->centers_norms_.clear();
+        return this->centers_;
+    }
 
     const std::vector<Feature>& centers() const { return this->centers_; }
 
     std::vector<uint8_t>& validCenters() { return this->valid_centers_; }
 
     const std::vector<uint8_t>& validCenters() const { return this->valid_centers_; }
+
+    /// Compute the squared norms of the centers after an update, enabling the batched quantization again
+    void updateCentersNorms() { this->computeCentersNorms(); }
+
+    /// Descend the first levels of a tree under construction
+    using BaseClass::descend;
 };
 
 }  // namespace voctree
@@ -16,8 +16,9 @@
 #include <boost/foreach.hpp>
 
 #include <algorithm>
-#include <mutex>
+#include <cstdint>
 #include <numeric>
+#include <random>
 #include <vector>
 #include <limits>
 #include <stdio.h>
@@ -27,20 +28,35 @@
 namespace aliceVision {
 namespace voctree {
 
+/**
+ * @brief Draw an index in [0, n).
+ * @param[in] n the number of indexes
+ * @param[in] generator the random generator, std::rand is used if NULL
+ */
+inline std::size_t randomIndex(std::size_t n, std::mt19937_64* generator)
+{
+    return generator ? std::uniform_int_distribution<std::size_t>(0, n - 1)(*generator) : std::rand() % n;
+}
+
 /**
  * @brief Initializer for K-means that randomly selects k features as the cluster centers.
  */
 struct InitRandom
 {
     template<class Feature, class Distance>
-    void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature>& centers, Distance distance, const int verbose = 0)
+    void operator()(const std::vector<Feature*>& features,
+                    size_t k,
+                    std::vector<Feature>& centers,
+                    Distance distance,
+                    const int verbose = 0,
+                    std::mt19937_64* generator = NULL)
     {
         ALICEVISION_LOG_DEBUG("#\t\tRandom initialization");
         // Construct a random permutation of the features using a Fisher-Yates shuffle
         std::vector<Feature*> features_perm = features;
         for (size_t i = features.size(); i > 1; --i)
         {
-            size_t k = rand() % i;
+            size_t k = randomIndex(i, generator);
             std::swap(features_perm[i - 1], features_perm[k]);
         }
         // Take the first k permuted features as the initial centers
@@ -60,7 +76,12 @@ struct InitRandom
 struct InitKmeanspp
 {
     template<class Feature, class Distance>
-    void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature>& centers, Distance distance, const int verbose = 0)
+    void operator()(const std::vector<Feature*>& features,
+                    size_t k,
+                    std::vector<Feature>& centers,
+                    Distance distance,
+                    const int verbose = 0,
+                    std::mt19937_64* generator = NULL)
     {
         typedef typename Distance::result_type squared_distance_type;
 
@@ -80,22 +101,16 @@ struct InitKmeanspp
         centers.clear();
         centers.resize(k);
 
-        auto threadCount = std::min(numTrials, omp_get_max_threads());
+        // On small problems enabling multithreading does much more harm than good (see clusterOnce).
+        const bool enableMultithreading = features.size() * numTrials > 100000;
 
         std::vector<squared_distance_type> dists(features.size(), std::numeric_limits<squared_distance_type>::max());
-        std::vector<squared_distance_type> distsTempBest(features.size(), std::numeric_limits<squared_distance_type>::max());
-        std::vector<std::vector<squared_distance_type>> threadDistsTemp(threadCount);
-        for (int i = 0; i < threadCount; ++i)
-        {
-            // Data will be overwritten, can be initialized to anything.
-            threadDistsTemp[i].resize(features.size());
-        }
 
         typename std::vector<squared_distance_type>::iterator dstiter;
         typename std::vector<Feature*>::const_iterator featiter;
 
         // 1. Choose a random center
-        size_t randCenter = rand() % features.size();
+        size_t randCenter = randomIndex(features.size(), generator);
 
         // add it to the centers
         centers[0] = *features[randCenter];
@@ -110,9 +125,12 @@ struct InitKmeanspp
             currSum += *dstiter;
         }
 
-        std::mutex bestSumMutex;
+        std::vector<std::size_t> trialCenters(numTrials);
+        std::vector<squared_distance_type> trialSums(numTrials);
 
-        std::vector<float> trialPercs(numTrials);
+        const std::size_t blockSize = 4096;
+        const std::size_t nbBlocks = (features.size() + blockSize - 1) / blockSize;
+        std::vector<squared_distance_type> blockSums(nbBlocks * numTrials);
 
         // iterate k-1 times
         for (int i = 1; i < k; ++i)
@@ -120,28 +138,17 @@ struct InitKmeanspp
             if (verbose > 1)
                 ALICEVISION_LOG_DEBUG("Finding initial center " << i + 1);
 
-            squared_distance_type bestSum = std::numeric_limits<squared_distance_type>::max();
-            std::size_t bestCenter = -1;
-
-            for (auto& perc : trialPercs)
-            {
-                perc = (float)std::rand() / RAND_MAX;
-            }
-
             // make it a little bit more robust and try several guesses
             //  choose the one with the global minimal distance
-#pragma omp parallel for num_threads(threadCount)
             for (int j = 0; j < numTrials; ++j)
             {
-                typename std::vector<squared_distance_type>::iterator dstiter;
-        
                 // draw an element from 0 to currSum
                 // in order to choose a point with a probability proportional to D(x)^2
                 // let's compute the overall sum of D(x)^2 and draw a number between
                 // 0 and this sum, then start compute the sum from the first element again
                 // until the partial sum is greater than the number drawn: the
                 // the previous element is what we are looking for
-                const float perc = trialPercs[j];
+                const float perc = generator ? std::uniform_real_distribution<float>(0.f, 1.f)(*generator) : (float)std::rand() / RAND_MAX;
                 squared_distance_type partial = (squared_distance_type)(currSum * perc);
                 // look for the element that cap the partial sum that has been
                 // drawn
@@ -162,45 +169,58 @@ struct InitKmeanspp
                 }
 
                 // get the index
-                std::size_t featidx;
                 if (dstiter == dists.end())
-                    featidx = features.size() - 1;
+                    trialCenters[j] = features.size() - 1;
                 else
-                    featidx = dstiter - dists.begin();
-
-                // 2. compute the distance of each feature from the current center
-                squared_distance_type distSum = 0;
-
-                auto& distsTemp = threadDistsTemp[omp_get_thread_num()];
+                    trialCenters[j] = dstiter - dists.begin();
+            }
 
-                Feature newCenter = *features[featidx];
-#pragma omp parallel for reduction(+ : distSum) num_threads(omp_get_max_threads() / threadCount)
-                for (ptrdiff_t it = 0; it < static_cast<ptrdiff_t>(features.size()); ++it)
+            // 2. compute the distance of each feature from the current centers, for all the trials at once:
+            // the features are read once, by fixed-size blocks whose partial sums are added in block order,
+            // so that the trial sums do not depend on the number of threads
+#pragma omp parallel for if (enableMultithreading)
+            for (ptrdiff_t b = 0; b < static_cast<ptrdiff_t>(nbBlocks); ++b)
+            {
+                squared_distance_type* sums = &blockSums[b * numTrials];
+                std::fill_n(sums, numTrials, 0);
+                const std::size_t blockEnd = std::min((b + 1) * blockSize, features.size());
+                for (std::size_t it = b * blockSize; it < blockEnd; ++it)
                 {
-                    distsTemp[it] = std::min(distance(*(features[it]), newCenter), dists[it]);
-                    distSum += distsTemp[it];
+                    for (int j = 0; j < numTrials; ++j)
+                        sums[j] += std::min(distance(*(features[it]), *features[trialCenters[j]]), dists[it]);
                 }
-                if (verbose > 2)
-                    ALICEVISION_LOG_DEBUG("trial " << j << " found feat " << featidx << ": " << *features[featidx] << " with sum: " << distSum);
+            }
 
-                {
-                    std::lock_guard<std::mutex> lock(bestSumMutex);
-                    if (distSum < bestSum)
-                    {
-                        // save the best so far
-                        bestSum = distSum;
-                        bestCenter = featidx;
-                        std::swap(distsTemp, distsTempBest);
-                    }
-                }
+            std::fill(trialSums.begin(), trialSums.end(), 0);
+            for (std::size_t b = 0; b < nbBlocks; ++b)
+            {
+                for (int j = 0; j < numTrials; ++j)
+                    trialSums[j] += blockSums[b * numTrials + j];
             }
+
+            int bestTrial = 0;
+            for (int j = 0; j < numTrials; ++j)
+            {
+                if (verbose > 2)
+                    ALICEVISION_LOG_DEBUG("trial " << j << " found feat " << trialCenters[j] << ": " << *features[trialCenters[j]]
+                                                   << " with sum: " << trialSums[j]);
+                if (trialSums[j] < trialSums[bestTrial])
+                    bestTrial = j;
+            }
+            const std::size_t bestCenter = trialCenters[bestTrial];
+
             if (verbose > 2)
                 ALICEVISION_LOG_DEBUG("feature found feat " << bestCenter << ": " << *features[bestCenter]);
 
             // 3. add new data
             centers[i] = *features[bestCenter];
-            currSum = bestSum;
-            std::swap(dists, distsTempBest);
+            currSum = trialSums[bestTrial];
+
+#pragma omp parallel for if (enableMultithreading)
+            for (ptrdiff_t it = 0; it < static_cast<ptrdiff_t>(features.size()); ++it)
+            {
+                dists[it] = std::min(distance(*(features[it]), centers[i]), dists[it]);
+            }
         }
         if (verbose > 1)
             ALICEVISION_LOG_DEBUG("Done!");
@@ -291,7 +311,8 @@ class SimpleKmeans
 {
   public:
     typedef typename Distance::result_type squared_distance_type;
-    typedef boost::function<void(const std::vector<Feature*>&, std::size_t, std::vector<Feature>&, Distance, const int verbose)> Initializer;
+    typedef boost::function<void(const std::vector<Feature*>&, std::size_t, std::vector<Feature>&, Distance, const int verbose, std::mt19937_64*)>
+      Initializer;
 
     /**
      * @brief Constructor
@@ -317,6 +338,17 @@ class SimpleKmeans
 
     void setVerbose(const int verboseLevel) { verbose_ = verboseLevel; }
 
+    /**
+     * @brief Use a random generator initialized with the given seed for each clustering,
+     *        instead of std::rand, so that the result only depends on the seed and on the features.
+     * @param[in] seed the random seed
+     */
+    void setRandomSeed(std::uint64_t seed)
+    {
+        randomSeed_ = seed;
+        useRandomSeed_ = true;
+    }
+
     /**
      * @brief Partition a set of features into k clusters.
      *
@@ -350,7 +382,8 @@ class SimpleKmeans
     squared_distance_type clusterOnce(const std::vector<Feature*>& features,
                                       std::size_t k,
                                       std::vector<Feature>& centers,
-                                      std::vector<unsigned int>& membership) const;
+                                      std::vector<unsigned int>& membership,
+                                      std::mt19937_64* generator) const;
 
     Feature zero_;
     Distance distance_;
@@ -358,6 +391,8 @@ class SimpleKmeans
     std::size_t max_iterations_;
     std::size_t restarts_;
     int verbose_;
+    std::uint64_t randomSeed_ = 0;
+    bool useRandomSeed_ = false;
 };
 
 template<class Feature, class Distance>
@@ -395,14 +430,17 @@ typename SimpleKmeans<Feature, Distance>::squared_distance_type SimpleKmeans<Fea
     new_centers.resize(k);
     std::vector<unsigned int> new_membership(features.size());
 
+    std::mt19937_64 seededGenerator(randomSeed_);
+    std::mt19937_64* generator = useRandomSeed_ ? &seededGenerator : NULL;
+
     squared_distance_type least_sse = std::numeric_limits<squared_distance_type>::max();
     assert(restarts_ > 0);
     for (std::size_t starts = 0; starts < restarts_; ++starts)
     {
         if (verbose_ > 0)
             ALICEVISION_LOG_DEBUG("Trial " << starts + 1 << "/" << restarts_);
-        choose_centers_(features, k, new_centers, distance_, verbose_);
-        squared_distance_type sse = clusterOnce(features, k, new_centers, new_membership);
+        choose_centers_(features, k, new_centers, distance_, verbose_, generator);
+        squared_distance_type sse = clusterOnce(features, k, new_centers, new_membership, generator);
         if (verbose_ > 0)
             ALICEVISION_LOG_DEBUG("End of Trial " << starts + 1 << "/" << restarts_);
         if (sse < least_sse)
@@ -423,14 +461,14 @@ typename SimpleKmeans<Feature, Distance>::squared_distance_type SimpleKmeans<Fea
   const std::vector<Feature*>& features,
   std::size_t k,
   std::vector<Feature>& centers,
-  std::vector<unsigned int>& membership) const
+  std::vector<unsigned int>& membership,
+  std::mt19937_64* generator) const
 {
     typedef typename std::vector<Feature>::value_type centerType;
     typedef typename Distance::value_type feature_value_type;
 
     std::vector<std::size_t> new_center_counts(k);
     std::vector<Feature> new_centers(k);
-    std::vector<std::mutex> centersLocks(k);
     squared_distance_type max_center_shift = std::numeric_limits<squared_distance_type>::max();
 
     if (verbose_ > 0)
@@ -454,7 +492,7 @@ typename SimpleKmeans<Feature, Distance>::squared_distance_type SimpleKmeans<Fea
         bool enableMultithreading = features.size() * k > 1000000;
 
 // Assign data objects to current centers
-#pragma omp parallel for shared(new_centers, new_center_counts, features, centers, membership) if (enableMultithreading)
+#pragma omp parallel for shared(features, centers, membership) if (enableMultithreading)
         for (ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
         {
             squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
@@ -485,19 +523,16 @@ typename SimpleKmeans<Feature, Distance>::squared_distance_type SimpleKmeans<Fea
                 is_stable = false;
                 membership[i] = nearest;
             }
-            // Accumulate the cluster center and its membership count
-            //	  printf("\t nearest %d\n", nearest);
-            //			checkElements(*features[i], "feat");
-            {
-                std::lock_guard<std::mutex> lock{centersLocks[nearest]};
-                new_centers[nearest] += *features[i];
-                //			checkElements(new_centers[nearest], "sum");
-                //	  printf("\t new_centers[nearest] += *features[i];\n");
-                ++new_center_counts[nearest];
-                //	  printf("\taccumulate\n");
-            }
         }  // for
 
+        // Accumulate the cluster centers and their membership counts in the features order,
+        // so that the new centers do not depend on the number of threads
+        for (std::size_t i = 0; i < features.size(); ++i)
+        {
+            new_centers[membership[i]] += *features[i];
+            ++new_center_counts[membership[i]];
+        }
+
         if (is_stable)
             break;
 
@@ -526,7 +561,7 @@ typename SimpleKmeans<Feature, Distance>::squared_distance_type SimpleKmeans<Fea
             {
                 // Choose a new center randomly from the input features
                 // @todo use a better strategy like taking splitting the largest cluster
-                unsigned int index = rand() % features.size();
+                unsigned int index = randomIndex(features.size(), generator);
                 centers[i] = *features[index];
                 ALICEVISION_LOG_DEBUG("Choosing a new center: " << index);
             }
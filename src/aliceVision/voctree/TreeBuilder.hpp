@@ -9,6 +9,9 @@
 #include "MutableVocabularyTree.hpp"
 #include "SimpleKmeans.hpp"
 #include <deque>
+#include <functional>
+#include <numeric>
+#include <random>
 // #include <cstdio> //DEBUG
 
 namespace aliceVision {
@@ -26,6 +29,8 @@ class TreeBuilder
     typedef DistanceT<Feature, Feature> Distance;
     typedef SimpleKmeans<Feature, Distance> Kmeans;
     typedef std::vector<Feature> FeatureVector;
+    /// Function reading all the training features, calling the given function on each chunk of features
+    typedef std::function<void(const std::function<void(const FeatureVector&)>&)> FeatureStream;
 
     /**
      * @brief Constructor
@@ -46,6 +51,33 @@ class TreeBuilder
      */
     void build(const FeatureVector& training_features, uint32_t k, uint32_t levels);
 
+    /**
+     * @brief Build a new vocabulary tree from a stream of training features, with a limited memory.
+     *
+     * The tree is built level by level, each level requiring several passes over the stream:
+     * - a uniform sample of the features of each node of the previous level is drawn (reservoir sampling)
+     *   and the nodes are clustered in parallel from their sample with the k-means clusterer;
+     * - the centers are then refined with mini-batch k-means updates over all the features of the stream
+     *   (Sculley, "Web-scale k-means clustering", WWW 2010).
+     * The features are assigned to the nodes with the batched quantization of the tree.
+     * The result only depends on the features stream and on the random seed: each node draws its sample and
+     * initializes its k-means with its own generator, seeded with the random seed plus the node index.
+     *
+     * @param readFeatures   Function streaming the training features, chunk by chunk (called several times).
+     * @param k              The branching factor, or max children of any node.
+     * @param levels         The number of levels in the tree.
+     * @param maxSampleSize  The number of features kept in memory to cluster the nodes of a level. It is a soft limit:
+     *                       each node keeps at least k + 1 features, so the deep levels may exceed it.
+     * @param nbRefinePasses The number of mini-batch passes over the stream for each level.
+     * @param randomSeed     The base seed of the random generators of the nodes.
+     */
+    void buildStreaming(const FeatureStream& readFeatures,
+                        uint32_t k,
+                        uint32_t levels,
+                        std::size_t maxSampleSize,
+                        uint32_t nbRefinePasses = 1,
+                        std::uint64_t randomSeed = std::mt19937_64::default_seed);
+
     /// Get the built vocabulary tree.
 
     const Tree& tree() const { return tree_; }
@@ -114,13 +146,13 @@ void TreeBuilder<Feature, DistanceT>::build(const FeatureVector& training_featur
         {
             std::vector<Feature*>& subset = subset_queue.front();
             if (verbose_ > 1)
-                printf("#\tClustering subset %lu/%lu of size %lu\n", i + 1, ie, subset.size());
+                printf("#\tClustering subset %zu/%zu of size %zu\n", i + 1, ie, subset.size());
 
             // If the subset already has k or fewer elements, just use those as the centers.
             if (subset.size() <= k)
             {
                 if (verbose_ > 2)
-                    printf("#\tno need to cluster %lu elements\n", subset.size());
+                    printf("#\tno need to cluster %zu elements\n", subset.size());
                 for (std::size_t j = 0; j < subset.size(); ++j)
                 {
                     tree_.centers().push_back(*subset[j]);
@@ -138,7 +170,7 @@ void TreeBuilder<Feature, DistanceT>::build(const FeatureVector& training_featur
             {
                 // Cluster the current subset into k centers.
                 if (verbose_ > 2)
-                    printf("#\tclustering the current subset of %lu elements into %d centers\n", subset.size(), k);
+                    printf("#\tclustering the current subset of %zu elements into %u centers\n", subset.size(), k);
                 kmeans_.clusterPointers(subset, k, centers, membership);
                 // Add the centers and mark them as valid.
                 tree_.centers().insert(tree_.centers().end(), centers.begin(), centers.end());
@@ -158,7 +190,179 @@ void TreeBuilder<Feature, DistanceT>::build(const FeatureVector& training_featur
             }
         }
         if (verbose_)
-            printf("# centers so far = %lu\n", tree_.centers().size());
+            printf("# centers so far = %zu\n", tree_.centers().size());
+    }
+}
+
+template<class Feature, template<typename, typename> class DistanceT>
+void TreeBuilder<Feature, DistanceT>::buildStreaming(const FeatureStream& readFeatures,
+                                                     uint32_t k,
+                                                     uint32_t levels,
+                                                     std::size_t maxSampleSize,
+                                                     uint32_t nbRefinePasses,
+                                                     std::uint64_t randomSeed)
+{
+    // Initial setup and memory allocation for the tree:
+    // all the nodes are allocated, the centers of the nodes without features stay invalid.
+    tree_.clear();
+    tree_.setSize(levels, k);
+    std::vector<Feature>& centers = tree_.centers();
+    std::vector<uint8_t>& validCenters = tree_.validCenters();
+    centers.assign(tree_.nodes(), zero_);
+    validCenters.assign(tree_.nodes(), 0);
+
+    std::vector<int32_t> nodes;     // node reached by each feature of a chunk
+    std::vector<std::size_t> order;  // features of a chunk sorted by node
+
+    std::size_t levelBegin = 0;  // index of the first node of the level
+    std::size_t nbLevelNodes = k;
+
+    for (uint32_t level = 0; level < levels; ++level, levelBegin += nbLevelNodes, nbLevelNodes *= k)
+    {
+        if (verbose_)
+            printf("# Level %u\n", level);
+
+        // The children of the parent node p are the nodes [(p + 1) * k, (p + 2) * k), -1 being the virtual root.
+        const std::size_t nbParents = nbLevelNodes / k;
+        const std::ptrdiff_t parentsBegin = static_cast<std::ptrdiff_t>(levelBegin / k) - 1;
+        const std::size_t sampleSize = std::max<std::size_t>(maxSampleSize / nbParents, k + 1);
+
+        // Random generator of each parent node, seeded with the base seed plus the node index (0 for the root).
+        // A small generator is used, as the deep levels have many nodes.
+        std::vector<std::minstd_rand> generators(nbParents);
+        for (std::size_t parent = 0; parent < nbParents; ++parent)
+        {
+            const std::uint64_t nodeSeed = randomSeed + static_cast<std::uint64_t>(parentsBegin + 1) + parent;
+            std::seed_seq seeds{static_cast<std::uint32_t>(nodeSeed), static_cast<std::uint32_t>(nodeSeed >> 32)};
+            generators[parent].seed(seeds);
+        }
+
+        // Draw a uniform sample of the features of each parent node
+        std::vector<FeatureVector> samples(nbParents);
+        std::vector<std::size_t> nbParentFeatures(nbParents, 0);
+
+        tree_.updateCentersNorms();
+        readFeatures([&](const FeatureVector& features) {
+            tree_.descend(features, level, nodes);
+            for (std::size_t i = 0; i < features.size(); ++i)
+            {
+                const std::size_t parent = nodes[i] - parentsBegin;
+                FeatureVector& sample = samples[parent];
+                const std::size_t nbSeen = nbParentFeatures[parent]++;
+
+                if (sample.size() < sampleSize)
+                {
+                    sample.push_back(features[i]);
+                }
+                else
+                {
+                    // the feature replaces a sample feature with probability sampleSize / (nbSeen + 1)
+                    const std::size_t j = std::uniform_int_distribution<std::size_t>(0, nbSeen)(generators[parent]);
+                    if (j < sampleSize)
+                        sample[j] = features[i];
+                }
+            }
+        });
+
+        // Cluster the parent nodes in parallel, each one from its own sample.
+        // With fewer parents than threads (the root level), the nodes are clustered one after the other
+        // and the k-means parallelizes inside each node instead.
+        std::vector<std::size_t> centerCounts(nbLevelNodes, 0);  // weight of each center in the mini-batch updates
+        const bool parallelizeNodes = nbParents >= static_cast<std::size_t>(omp_get_max_threads());
+
+#pragma omp parallel for schedule(dynamic) if (parallelizeNodes)
+        for (std::ptrdiff_t parent = 0; parent < static_cast<std::ptrdiff_t>(nbParents); ++parent)
+        {
+            FeatureVector& sample = samples[parent];
+            const std::size_t firstChild = levelBegin + parent * k;
+
+            if (sample.empty())
+                continue;
+
+            if (sample.size() <= k)
+            {
+                // The node has k or fewer features, just use those as the centers.
+                std::copy(sample.begin(), sample.end(), centers.begin() + firstChild);
+                std::fill_n(validCenters.begin() + firstChild, sample.size(), 1);
+                std::fill_n(centerCounts.begin() + (firstChild - levelBegin), sample.size(), 1);
+            }
+            else
+            {
+                // the k-means initialization of the node is drawn from the node generator
+                Kmeans nodeKmeans(kmeans_);
+                nodeKmeans.setRandomSeed(generators[parent]());
+
+                FeatureVector nodeCenters;
+                std::vector<unsigned int> membership;
+                nodeKmeans.cluster(sample, k, nodeCenters, membership);
+
+                std::copy(nodeCenters.begin(), nodeCenters.end(), centers.begin() + firstChild);
+                std::fill_n(validCenters.begin() + firstChild, k, 1);
+                for (std::size_t j = 0; j < sample.size(); ++j)
+                    ++centerCounts[firstChild - levelBegin + membership[j]];
+            }
+
+            // release the sample memory
+            FeatureVector().swap(sample);
+        }
+
+        if (verbose_ > 1)
+        {
+            const std::size_t nbValidParents = std::count_if(nbParentFeatures.begin(), nbParentFeatures.end(), [](std::size_t n) { return n > 0; });
+            printf("#\t%zu/%zu nodes clustered\n", nbValidParents, nbParents);
+        }
+
+        // Refine the centers of the level with mini-batch updates:
+        // for each chunk, every center moves to the weighted mean of its previous position and of the chunk features assigned to it.
+        for (uint32_t pass = 0; pass < nbRefinePasses; ++pass)
+        {
+            if (verbose_ > 1)
+                printf("#\tRefinement pass %u/%u\n", pass + 1, nbRefinePasses);
+
+            tree_.updateCentersNorms();
+            readFeatures([&](const FeatureVector& features) {
+                tree_.descend(features, level + 1, nodes);
+
+                // group the features by center, so that each center is updated by a single thread
+                order.resize(features.size());
+                std::iota(order.begin(), order.end(), 0);
+                std::sort(order.begin(), order.end(), [&nodes](std::size_t a, std::size_t b) { return nodes[a] < nodes[b]; });
+
+                std::vector<std::size_t> groupBegins;
+                for (std::size_t i = 0; i < order.size(); ++i)
+                {
+                    if (i == 0 || nodes[order[i]] != nodes[order[i - 1]])
+                        groupBegins.push_back(i);
+                }
+                groupBegins.push_back(order.size());
+
+#pragma omp parallel for schedule(dynamic)
+                for (std::ptrdiff_t g = 0; g < static_cast<std::ptrdiff_t>(groupBegins.size()) - 1; ++g)
+                {
+                    const std::size_t node = nodes[order[groupBegins[g]]];
+                    Feature& center = centers[node];
+                    std::size_t& count = centerCounts[node - levelBegin];
+
+                    std::vector<double> sum(center.size(), 0.0);
+                    for (std::size_t i = groupBegins[g]; i < groupBegins[g + 1]; ++i)
+                    {
+                        const Feature& feature = features[order[i]];
+                        for (std::size_t d = 0; d < sum.size(); ++d)
+                            sum[d] += feature[d];
+                    }
+
+                    const std::size_t nbAssigned = groupBegins[g + 1] - groupBegins[g];
+                    count += nbAssigned;
+                    for (std::size_t d = 0; d < sum.size(); ++d)
+                        center[d] += (sum[d] - nbAssigned * double(center[d])) / count;
+                }
+
+                tree_.updateCentersNorms();
+            });
+        }
+
+        if (verbose_)
+            printf("# centers so far = %zu\n", levelBegin + nbLevelNodes);
     }
 }
 
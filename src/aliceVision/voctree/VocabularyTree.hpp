@@ -19,11 +19,14 @@
 #include <stdint.h>
 #include <vector>
 #include <map>
+#include <algorithm>
 #include <cassert>
 #include <limits>
 #include <fstream>
+#include <numeric>
 #include <stdexcept>
 #include <iostream>
+#include <type_traits>
 
 namespace aliceVision {
 namespace voctree {
@@ -88,6 +91,19 @@ class IVocabularyTree
 
 inline IVocabularyTree::~IVocabularyTree() {}
 
+namespace detail {
+
+/// Descriptors supported by the batched quantization: fixed size arrays of arithmetic values (feature::Descriptor)
+template<class T, class = void>
+struct IsBatchableDescriptor : std::false_type
+{};
+
+template<class T>
+struct IsBatchableDescriptor<T, std::void_t<decltype(T::static_size), typename T::value_type>> : std::is_arithmetic<typename T::value_type>
+{};
+
+}  // namespace detail
+
 /**
  * @brief Optimized vocabulary tree quantizer, templated on feature type and distance metric
  * for maximum efficiency.
@@ -114,7 +130,12 @@ class VocabularyTree : public IVocabularyTree
     template<class DescriptorT>
     Word quantize(const DescriptorT& feature) const;
 
-    /// Quantizes a set of features into visual words.
+    /**
+     * @brief Quantizes a set of features into visual words.
+     * With the L2 distance and fixed size descriptors, blocks of features descend the tree level by level
+     * and the features sharing a node are compared to its children with a float dot product kernel.
+     * The words are identical to the ones of the feature by feature quantization.
+     */
     template<class DescriptorT>
     std::vector<Word> quantize(const std::vector<DescriptorT>& features) const;
 
@@ -152,6 +173,7 @@ class VocabularyTree : public IVocabularyTree
   protected:
     std::vector<Feature> centers_;
     std::vector<uint8_t> valid_centers_;  /// @todo Consider bit-vector
+    std::vector<float> centers_norms_;    // squared norm of each center, for the batched quantization (empty if not computed)
 
     uint32_t k_;  // splits, or branching factor
     uint32_t levels_;
@@ -161,6 +183,26 @@ class VocabularyTree : public IVocabularyTree
     bool initialized() const { return num_words_ != 0; }
 
     void setNodeCounts();
+
+    /// Compute the squared norm of each center, enabling the batched quantization.
+    void computeCentersNorms();
+
+    /// Descends the first nbLevels levels of the tree, returns the reached node (-1, the virtual root, if nbLevels is 0).
+    template<class DescriptorT>
+    int32_t descend(const DescriptorT& feature, uint32_t nbLevels) const;
+
+    /**
+     * @brief Descends the first nbLevels levels of the tree with a set of features.
+     * @param[in] features the features
+     * @param[in] nbLevels the number of levels to descend
+     * @param[out] nodes the node reached by each feature (-1, the virtual root, if nbLevels is 0)
+     */
+    template<class DescriptorT>
+    void descend(const std::vector<DescriptorT>& features, uint32_t nbLevels, std::vector<int32_t>& nodes) const;
+
+    /// Descends a block of features level by level, with the batched distances.
+    template<class DescriptorT>
+    void descendBlock(const DescriptorT* features, std::size_t nbFeatures, uint32_t nbLevels, int32_t* nodes) const;
 };
 
 template<class Feature, template<typename, typename> class Distance>
@@ -185,13 +227,20 @@ template<class Feature, template<typename, typename> class Distance>
 template<class DescriptorT>
 Word VocabularyTree<Feature, Distance>::quantize(const DescriptorT& feature) const
 {
-    typedef typename Distance<Feature, DescriptorT>::result_type distance_type;
-
     //	printf("asserting\n");
     assert(initialized());
     //	printf("initialized\n");
+    return descend(feature, levels_) - word_start_;
+}
+
+template<class Feature, template<typename, typename> class Distance>
+template<class DescriptorT>
+int32_t VocabularyTree<Feature, Distance>::descend(const DescriptorT& feature, uint32_t nbLevels) const
+{
+    typedef typename Distance<Feature, DescriptorT>::result_type distance_type;
+
     int32_t index = -1;  // virtual "root" index, which has no associated center.
-    for (unsigned level = 0; level < levels_; ++level)
+    for (unsigned level = 0; level < nbLevels; ++level)
     {
         // Calculate the offset to the first child of the current index.
         int32_t first_child = (index + 1) * splits();
@@ -212,7 +261,7 @@ Word VocabularyTree<Feature, Distance>::quantize(const DescriptorT& feature) con
         index = best_child;
     }
 
-    return index - word_start_;
+    return index;
 }
 
 template<class Feature, template<typename, typename> class Distance>
@@ -220,20 +269,163 @@ template<class DescriptorT>
 std::vector<Word> VocabularyTree<Feature, Distance>::quantize(const std::vector<DescriptorT>& features) const
 {
     // ALICEVISION_LOG_DEBUG("VocabularyTree quantize: " << features.size());
-    std::vector<Word> imgVisualWords(features.size(), 0);
+    std::vector<int32_t> nodes;
+    descend(features, levels_, nodes);
 
-// quantize the features
-#pragma omp parallel for
-    for (ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(features.size()); ++j)
+    std::vector<Word> imgVisualWords(features.size(), 0);
+    for (std::size_t j = 0; j < features.size(); ++j)
     {
         // store the visual word associated to the feature in the temporary list
-        imgVisualWords[j] = quantize<DescriptorT>(features[j]);
+        imgVisualWords[j] = nodes[j] - word_start_;
     }
 
     // add the vector to the documents
     return imgVisualWords;
 }
 
+template<class Feature, template<typename, typename> class Distance>
+template<class DescriptorT>
+void VocabularyTree<Feature, Distance>::descend(const std::vector<DescriptorT>& features, uint32_t nbLevels, std::vector<int32_t>& nodes) const
+{
+    nodes.assign(features.size(), -1);
+
+    constexpr bool isBatchable = detail::IsBatchableDescriptor<Feature>::value && detail::IsBatchableDescriptor<DescriptorT>::value &&
+                                 std::is_same<Distance<DescriptorT, Feature>, L2<DescriptorT, Feature>>::value;
+
+    if constexpr (isBatchable)
+    {
+        if (!centers_norms_.empty() && centers_norms_.size() == centers_.size())
+        {
+            const std::ptrdiff_t blockSize = 256;
+            const std::ptrdiff_t nbFeatures = features.size();
+
+#pragma omp parallel for
+            for (std::ptrdiff_t begin = 0; begin < nbFeatures; begin += blockSize)
+            {
+                descendBlock<DescriptorT>(&features[begin], std::min(blockSize, nbFeatures - begin), nbLevels, &nodes[begin]);
+            }
+            return;
+        }
+    }
+
+#pragma omp parallel for
+    for (ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(features.size()); ++j)
+    {
+        nodes[j] = descend<DescriptorT>(features[j], nbLevels);
+    }
+}
+
+template<class Feature, template<typename, typename> class Distance>
+template<class DescriptorT>
+void VocabularyTree<Feature, Distance>::descendBlock(const DescriptorT* features, std::size_t nbFeatures, uint32_t nbLevels, int32_t* nodes) const
+{
+    typedef typename Distance<DescriptorT, Feature>::result_type distance_type;
+    constexpr std::size_t dim = DescriptorT::static_size;
+    static_assert(dim == Feature::static_size, "The descriptors and the tree centers must have the same size.");
+
+    // Bound of the rounding errors of the float distances |x|^2 + |c|^2 - 2 x.c, relative to |x|^2 + |c|^2.
+    // Children within this bound of the closest one are compared again with the exact distance.
+    const float toleranceFactor = 8.0f * dim * std::numeric_limits<float>::epsilon();
+
+    // features in float, one row per feature
+    std::vector<float> x(nbFeatures * dim);
+    std::vector<float> xNorms(nbFeatures, 0.0f);
+    for (std::size_t f = 0; f < nbFeatures; ++f)
+    {
+        float* xf = &x[f * dim];
+        for (std::size_t i = 0; i < dim; ++i)
+        {
+            xf[i] = static_cast<float>(features[f][i]);
+            xNorms[f] += xf[i] * xf[i];
+        }
+    }
+
+    std::fill(nodes, nodes + nbFeatures, -1);  // current node of each feature, starting from the virtual root
+    std::vector<uint32_t> order(nbFeatures);   // features sorted by current node
+    std::vector<float> distances(nbFeatures * k_);
+    std::vector<float> center(dim);
+
+    for (unsigned level = 0; level < nbLevels; ++level)
+    {
+        // group the features by node, so the children centers are shared by the group
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [nodes](uint32_t a, uint32_t b) { return nodes[a] < nodes[b]; });
+
+        for (std::size_t groupBegin = 0, groupEnd = 0; groupBegin < nbFeatures; groupBegin = groupEnd)
+        {
+            const int32_t node = nodes[order[groupBegin]];
+            groupEnd = groupBegin + 1;
+            while (groupEnd < nbFeatures && nodes[order[groupEnd]] == node)
+                ++groupEnd;
+
+            // Calculate the offset to the first child of the current node.
+            const int32_t first_child = (node + 1) * splits();
+            uint32_t nbChildren = 0;
+            while (nbChildren < splits() && valid_centers_[first_child + nbChildren])
+                ++nbChildren;  // Fewer than splits() children.
+
+            float maxCenterNorm = 0.0f;
+            for (uint32_t c = 0; c < nbChildren; ++c)
+            {
+                const Feature& childCenter = centers_[first_child + c];
+                const float centerNorm = centers_norms_[first_child + c];
+                maxCenterNorm = std::max(maxCenterNorm, centerNorm);
+
+                for (std::size_t i = 0; i < dim; ++i)
+                    center[i] = static_cast<float>(childCenter[i]);
+
+                // distances of the group features to the child center
+                for (std::size_t g = groupBegin; g < groupEnd; ++g)
+                {
+                    const float* xf = &x[order[g] * dim];
+                    float dot = 0.0f;
+#pragma omp simd reduction(+ : dot)
+                    for (std::size_t i = 0; i < dim; ++i)
+                        dot += xf[i] * center[i];
+                    distances[order[g] * k_ + c] = xNorms[order[g]] + centerNorm - 2.0f * dot;
+                }
+            }
+
+            for (std::size_t g = groupBegin; g < groupEnd; ++g)
+            {
+                const uint32_t f = order[g];
+                const float* featureDistances = &distances[f * k_];
+
+                int32_t best_child = 0;
+                for (uint32_t c = 1; c < nbChildren; ++c)
+                {
+                    if (featureDistances[c] < featureDistances[best_child])
+                        best_child = c;
+                }
+
+                // compare the children that may be the closest one with the exact distance
+                const float maxDistance = featureDistances[best_child] + 2.0f * toleranceFactor * (xNorms[f] + maxCenterNorm);
+                int nbCandidates = 0;
+                for (uint32_t c = 0; c < nbChildren; ++c)
+                    nbCandidates += (featureDistances[c] <= maxDistance);
+
+                if (nbCandidates > 1)
+                {
+                    distance_type best_distance = std::numeric_limits<distance_type>::max();
+                    for (uint32_t c = 0; c < nbChildren; ++c)
+                    {
+                        if (featureDistances[c] > maxDistance)
+                            continue;
+                        const distance_type child_distance = Distance<DescriptorT, Feature>()(features[f], centers_[first_child + c]);
+                        if (child_distance < best_distance)
+                        {
+                            best_child = c;
+                            best_distance = child_distance;
+                        }
+                    }
+                }
+
+                nodes[f] = first_child + best_child;
+            }
+        }
+    }
+}
+
 template<class Feature, template<typename, typename> class Distance>
 template<class DescriptorT>
 SparseHistogram VocabularyTree<Feature, Distance>::quantizeToSparse(const std::vector<DescriptorT>& features) const
@@ -267,6 +459,7 @@ void VocabularyTree<Feature, Distance>::clear()
 {
     centers_.clear();
     valid_centers_.clear();
+    centers_norms_.clear();
     k_ = levels_ = num_words_ = word_start_ = 0;
 }
 
@@ -313,6 +506,31 @@ void VocabularyTree<Feature, Distance>::load(const std::string& file)
 
     setNodeCounts();
     assert(size == num_words_ + word_start_);
+
+    computeCentersNorms();
+}
+
+template<class Feature, template<typename, typename> class Distance>
+void VocabularyTree<Feature, Distance>::computeCentersNorms()
+{
+    centers_norms_.clear();
+
+    if constexpr (detail::IsBatchableDescriptor<Feature>::value)
+    {
+        centers_norms_.resize(centers_.size(), 0.0f);
+
+#pragma omp parallel for
+        for (std::ptrdiff_t c = 0; c < static_cast<std::ptrdiff_t>(centers_.size()); ++c)
+        {
+            float norm = 0.0f;
+            for (std::size_t i = 0; i < Feature::static_size; ++i)
+            {
+                const float value = static_cast<float>(centers_[c][i]);
+                norm += value * value;
+            }
+            centers_norms_[c] = norm;
+        }
+    }
 }
 
 template<class Feature, template<typename, typename> class Distance>
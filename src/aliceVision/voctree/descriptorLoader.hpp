@@ -11,6 +11,7 @@
 #include <aliceVision/voctree/Database.hpp>
 #include <aliceVision/voctree/VocabularyTree.hpp>
 
+#include <functional>
 #include <string>
 
 namespace aliceVision {
@@ -52,6 +53,19 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
                               std::vector<DescriptorT>& descriptors,
                               std::vector<std::size_t>& numFeatures);
 
+/**
+ * @brief Read the descriptors of a list of descriptor files chunk by chunk, so that they never need to fit in memory at once.
+ * The files are read in order and a chunk holds the descriptors of consecutive files (a file is never split).
+ * @param[in] descriptorsFiles The list of descriptor files
+ * @param[in] chunkSize The number of descriptors from which a chunk is processed
+ * @param[in] processChunk The function called on each chunk of descriptors
+ * @return the total number of descriptors read
+ */
+template<class DescriptorT, class FileDescriptorT>
+std::size_t readDescFromFilesByChunks(const std::map<IndexT, std::string>& descriptorsFiles,
+                                      std::size_t chunkSize,
+                                      const std::function<void(const std::vector<DescriptorT>&)>& processChunk);
+
 }  // namespace voctree
 }  // namespace aliceVision
 
@@ -89,5 +89,37 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
   return numDescriptors;
 }
 
+template<class DescriptorT, class FileDescriptorT>
+std::size_t readDescFromFilesByChunks(const std::map<IndexT, std::string>& descriptorsFiles,
+                                      std::size_t chunkSize,
+                                      const std::function<void(const std::vector<DescriptorT>&)>& processChunk)
+{
+  std::size_t numDescriptors = 0;
+  std::vector<DescriptorT> chunk;
+  chunk.reserve(chunkSize);
+
+  for(const auto &currentFile : descriptorsFiles)
+  {
+    // Read the descriptors and append them to the current chunk
+    feature::loadDescsFromBinFile<DescriptorT, FileDescriptorT>(currentFile.second, chunk, true);
+
+    if(chunk.size() >= chunkSize)
+    {
+      numDescriptors += chunk.size();
+      processChunk(chunk);
+      chunk.clear();
+    }
+  }
+
+  // Process the last partial chunk
+  if(!chunk.empty())
+  {
+    numDescriptors += chunk.size();
+    processChunk(chunk);
+  }
+
+  return numDescriptors;
+}
+
 } // namespace voctree
 } // namespace aliceVision
@@ -306,3 +306,41 @@ BOOST_AUTO_TEST_CASE(kmeanVarying)
         }
     }
 }
+
+BOOST_AUTO_TEST_CASE(kmeanThreadInvariance)
+{
+    using namespace aliceVision;
+
+    makeRandomOperationsReproducible();
+
+    // large enough to enable the multithreaded parts of the initialization and of the iterations
+    const std::size_t DIMENSION = 8;
+    const std::size_t FEATURENUMBER = 300000;
+    const std::size_t K = 4;
+
+    typedef Eigen::Matrix<float, 1, DIMENSION> FeatureFloat;
+    typedef std::vector<FeatureFloat> FeatureFloatVector;
+
+    FeatureFloatVector features;
+    features.reserve(FEATURENUMBER);
+    for (std::size_t i = 0; i < FEATURENUMBER; ++i)
+        features.push_back(FeatureFloat::Random(1, DIMENSION));
+
+    voctree::SimpleKmeans<FeatureFloat> kmeans(FeatureFloat::Zero());
+    kmeans.setRandomSeed(42);
+    kmeans.setMaxIterations(10);
+
+    const int nbThreads = omp_get_max_threads();
+    FeatureFloatVector centers;
+    std::vector<unsigned int> membership;
+    kmeans.cluster(features, K, centers, membership);
+
+    omp_set_num_threads(1);
+    FeatureFloatVector singleThreadCenters;
+    std::vector<unsigned int> singleThreadMembership;
+    kmeans.cluster(features, K, singleThreadCenters, singleThreadMembership);
+    omp_set_num_threads(nbThreads);
+
+    BOOST_CHECK(centers == singleThreadCenters);
+    BOOST_CHECK(membership == singleThreadMembership);
+}
@@ -87,3 +87,88 @@ BOOST_AUTO_TEST_CASE(voctreeBuilder)
     }
     //  voctree::printFeatVector( features );
 }
+
+BOOST_AUTO_TEST_CASE(voctreeBuilderStreaming)
+{
+    using namespace aliceVision;
+
+    makeRandomOperationsReproducible();
+
+    const std::size_t DIMENSION = 3;
+    const std::size_t FEATURENUMBER = 100;
+    const std::size_t K = 4;
+    const std::size_t LEVELS = 3;
+    const std::size_t LEAVESNUMBER = std::pow(K, LEVELS);
+    const std::size_t CHUNKSIZE = 1000;
+
+    typedef Eigen::Matrix<float, 1, DIMENSION> FeatureFloat;
+    typedef std::vector<FeatureFloat> FeatureFloatVector;
+
+    // generate hierarchical clusters: the k children of a cluster are spread around it on a smaller scale
+    std::vector<FeatureFloat> leafCenters;
+    for (std::size_t i = 0; i < LEAVESNUMBER; ++i)
+    {
+        FeatureFloat center = FeatureFloat::Zero();
+        float scale = 100.0f;
+        for (std::size_t l = 0, path = i; l < LEVELS; ++l, path /= K, scale /= 10.0f)
+            center(path % K % DIMENSION) += ((path % K) < DIMENSION ? scale : -scale);
+        leafCenters.push_back(center);
+    }
+
+    // features of the different leaves are interleaved in the stream
+    FeatureFloatVector features;
+    features.reserve(FEATURENUMBER * LEAVESNUMBER);
+    for (std::size_t j = 0; j < FEATURENUMBER; ++j)
+    {
+        for (std::size_t i = 0; i < LEAVESNUMBER; ++i)
+            features.push_back(leafCenters[i] + 0.1f * FeatureFloat::Random(1, DIMENSION));
+    }
+
+    std::size_t nbChunks = 0;
+    const auto readFeatures = [&](const std::function<void(const FeatureFloatVector&)>& processChunk) {
+        for (std::size_t begin = 0; begin < features.size(); begin += CHUNKSIZE)
+        {
+            const FeatureFloatVector chunk(features.begin() + begin, features.begin() + std::min(begin + CHUNKSIZE, features.size()));
+            processChunk(chunk);
+            ++nbChunks;
+        }
+    };
+
+    // build the tree with less features in memory than the whole set
+    voctree::TreeBuilder<FeatureFloat> builder(FeatureFloat::Zero());
+    builder.kmeans().setRestarts(5);
+    builder.buildStreaming(readFeatures, K, LEVELS, features.size() / 4, 2);
+
+    // 3 passes per level
+    BOOST_CHECK_EQUAL(nbChunks, 3 * LEVELS * ((features.size() + CHUNKSIZE - 1) / CHUNKSIZE));
+
+    const std::vector<uint8_t>& valid = builder.tree().validCenters();
+    BOOST_CHECK_EQUAL(valid.size(), builder.tree().nodes());
+    for (std::size_t i = 0; i < valid.size(); ++i)
+        BOOST_CHECK(valid[i] != 0);
+
+    // each leaf cluster is quantized to its own word
+    const std::vector<voctree::Word> words = builder.tree().quantize(features);
+    std::vector<voctree::Word> leafWords(LEAVESNUMBER, -1);
+    std::vector<char> isWordUsed(LEAVESNUMBER, 0);
+    for (std::size_t f = 0; f < features.size(); ++f)
+    {
+        const std::size_t leaf = f % LEAVESNUMBER;
+        if (leafWords[leaf] == -1)
+        {
+            leafWords[leaf] = words[f];
+            BOOST_CHECK(!isWordUsed[words[f]]);
+            isWordUsed[words[f]] = 1;
+        }
+        BOOST_CHECK_EQUAL(words[f], leafWords[leaf]);
+    }
+
+    // same seed, same tree, whatever the number of threads
+    const int nbThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    voctree::TreeBuilder<FeatureFloat> singleThreadBuilder(FeatureFloat::Zero());
+    singleThreadBuilder.kmeans().setRestarts(5);
+    singleThreadBuilder.buildStreaming(readFeatures, K, LEVELS, features.size() / 4, 2);
+    omp_set_num_threads(nbThreads);
+    BOOST_CHECK(singleThreadBuilder.tree().centers() == builder.tree().centers());
+}
@@ -5,9 +5,14 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/voctree/Database.hpp>
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
 
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <fstream>
+#include <random>
 #include <vector>
 
 #define BOOST_TEST_MODULE vocabularyTree
@@ -57,3 +62,108 @@ BOOST_AUTO_TEST_CASE(database)
         BOOST_CHECK_SMALL(static_cast<double>(match[0].score), 0.001);
     }
 }
+
+BOOST_AUTO_TEST_CASE(database_invertedFile)
+{
+    const int nbWords = 200;
+    const int nbDocs = 60;
+
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<Word> wordDistribution(0, nbWords - 1);
+    std::uniform_int_distribution<int> sizeDistribution(5, 40);
+
+    // random documents with repeated words, inserted with sparse ids
+    std::vector<SparseHistogram> histograms(nbDocs);
+    Database db(nbWords);
+    for (int i = 0; i < nbDocs; ++i)
+    {
+        std::vector<Word> document(sizeDistribution(generator));
+        for (Word& word : document)
+            word = wordDistribution(generator);
+        computeSparseHistogram(document, histograms[i]);
+        db.insert(3 * (nbDocs - i), histograms[i]);
+    }
+    db.computeTfIdfWeights();
+
+    std::vector<float> wordWeights(nbWords);
+    for (int i = 0; i < nbWords; ++i)
+    {
+        // same weights as computeTfIdfWeights
+        int Ni = 0;
+        for (const auto& doc : db.getSparseHistogramPerImage())
+            Ni += doc.second.count(i);
+        wordWeights[i] = (Ni != 0) ? std::log(float(nbDocs) / Ni) : 1.0f;
+    }
+
+    std::vector<const SparseHistogram*> queries;
+    for (const SparseHistogram& histogram : histograms)
+        queries.push_back(&histogram);
+
+    for (const std::string method : {"classic", "commonPoints", "strongCommonPoints", "inversedWeightedCommonPoints"})
+    {
+        for (const std::size_t N : {std::size_t(1), std::size_t(10), std::size_t(nbDocs)})
+        {
+            std::vector<DocMatches> matches;
+            db.find(queries, N, matches, method);
+
+            for (int i = 0; i < nbDocs; ++i)
+            {
+                // brute force reference, ties broken by document id
+                DocMatches expected;
+                for (const auto& doc : db.getSparseHistogramPerImage())
+                    expected.emplace_back(doc.first, sparseDistance(histograms[i], doc.second, method, wordWeights));
+                std::stable_sort(expected.begin(), expected.end());
+                expected.resize(N);
+
+                BOOST_CHECK(matches[i] == expected);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(vocabularyTree_batchedQuantization)
+{
+    typedef aliceVision::feature::Descriptor<float, 128> CenterT;
+    typedef aliceVision::feature::Descriptor<unsigned char, 128> DescriptorT;
+
+    const uint32_t K = 6;
+    const uint32_t LEVELS = 3;
+
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<int> valueDistribution(0, 255);
+
+    // random tree, with some duplicated centers (exact ties) and some nodes with fewer than K children
+    MutableVocabularyTree<CenterT> mutableTree;
+    mutableTree.setSize(LEVELS, K);
+    const std::size_t nbCenters = mutableTree.nodes();
+    mutableTree.centers().resize(nbCenters);
+    mutableTree.validCenters().assign(nbCenters, 1);
+    for (std::size_t c = 0; c < nbCenters; ++c)
+    {
+        for (std::size_t i = 0; i < CenterT::static_size; ++i)
+            mutableTree.centers()[c][i] = valueDistribution(generator) * 0.5f + 64.0f;
+        if (c % 5 == 1)
+            mutableTree.centers()[c] = mutableTree.centers()[c - 1];
+    }
+    for (std::size_t c = K; c < K + K * K; c += 2 * K)
+        mutableTree.validCenters()[c + K - 1] = 0;
+
+    const std::string treeName = "batchedQuantization.tree";
+    mutableTree.save(treeName);
+    const VocabularyTree<CenterT> tree(treeName);
+    std::remove(treeName.c_str());
+
+    // random descriptors, and descriptors equal to the centers
+    std::vector<DescriptorT> descriptors(1000);
+    for (std::size_t d = 0; d < descriptors.size(); ++d)
+    {
+        for (std::size_t i = 0; i < DescriptorT::static_size; ++i)
+            descriptors[d][i] = (d % 3 == 0) ? static_cast<unsigned char>(mutableTree.centers()[d % nbCenters][i]) : valueDistribution(generator);
+    }
+
+    const std::vector<Word> words = tree.quantize(descriptors);
+
+    BOOST_REQUIRE_EQUAL(words.size(), descriptors.size());
+    for (std::size_t d = 0; d < descriptors.size(); ++d)
+        BOOST_CHECK_EQUAL(words[d], tree.quantize(descriptors[d]));
+}
@@ -0,0 +1,138 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/PointFeature.hpp>
+#include <aliceVision/feature/RegionsArchive.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/cmdline/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/utils/filesIO.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = std::filesystem;
+
+// convert features files (.feat) from one storage format to another
+int aliceVision_main(int argc, char** argv)
+{
+    // command-line parameters
+    std::vector<std::string> featuresFolders;
+    std::string outputFolder;
+
+    // user optional parameters
+    feature::EFeatsFileFormat outputFormat = feature::EFeatsFileFormat::Binary;
+    bool packArchive = false;
+
+    // clang-format off
+    po::options_description requiredParams("Required parameters");
+    requiredParams.add_options()
+        ("featuresFolders,f", po::value<std::vector<std::string>>(&featuresFolders)->multitoken()->required(),
+         "Path to folder(s) containing the features files (*.feat).");
+
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("output,o", po::value<std::string>(&outputFolder)->default_value(outputFolder),
+         "Output folder. If empty, the features files are converted in place.")
+        ("outputFormat", po::value<feature::EFeatsFileFormat>(&outputFormat)->default_value(outputFormat),
+         "Output features file format: binary or text.")
+        ("packArchive", po::value<bool>(&packArchive)->default_value(packArchive),
+         "Pack all the features and descriptors of each folder in a single regions archive file. "
+         "The archive is written in the output folder, or in each features folder if no output folder is given.");
+    // clang-format on
+
+    CmdLine cmdline("AliceVision convertFeatures");
+    cmdline.add(requiredParams);
+    cmdline.add(optionalParams);
+    if (!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (!outputFolder.empty() && !fs::exists(outputFolder))
+        fs::create_directories(outputFolder);
+
+    const std::vector<std::string> featuresPaths =
+      utils::getFilesPathsFromFolders(featuresFolders, [](const fs::path& path) { return path.extension() == ".feat"; });
+
+    ALICEVISION_LOG_INFO("Convert " << featuresPaths.size() << " features file(s) to " << outputFormat << " format.");
+
+    std::atomic<int> nbErrors(0);
+
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < static_cast<int>(featuresPaths.size()); ++i)
+    {
+        const std::string& inputPath = featuresPaths[i];
+        const std::string outputPath = outputFolder.empty() ? inputPath : (fs::path(outputFolder) / fs::path(inputPath).filename()).string();
+
+        try
+        {
+            feature::PointFeatures features;
+            feature::loadFeatsFromFile(inputPath, features);
+            feature::saveFeatsToFile(outputPath, features, outputFormat);
+        }
+        catch (const std::exception& e)
+        {
+            ALICEVISION_LOG_ERROR("Failed to convert features file '" << inputPath << "':" << std::endl << e.what());
+            ++nbErrors;
+        }
+    }
+
+    if (nbErrors > 0)
+    {
+        ALICEVISION_LOG_ERROR(nbErrors << " features file(s) could not be converted.");
+        return EXIT_FAILURE;
+    }
+
+    if (packArchive)
+    {
+        std::vector<std::string> archiveFolders = featuresFolders;
+        if (!outputFolder.empty())
+            archiveFolders = {outputFolder};
+
+        for (const std::string& folder : archiveFolders)
+        {
+            if (!outputFolder.empty())
+            {
+                // descriptors files are needed next to the converted features files
+                for (const std::string& inputFolder : featuresFolders)
+                {
+                    for (const auto& pathIt : fs::directory_iterator(inputFolder))
+                    {
+                        if (pathIt.path().extension() == ".desc")
+                            fs::copy_file(pathIt.path(), fs::path(outputFolder) / pathIt.path().filename(), fs::copy_options::skip_existing);
+                    }
+                }
+            }
+
+            const std::string archivePath = (fs::path(folder) / feature::RegionsArchive::defaultFilename).string();
+            try
+            {
+                const std::size_t nbEntries = feature::writeRegionsArchive(folder, archivePath);
+                ALICEVISION_LOG_INFO("Regions archive '" << archivePath << "' written with " << nbEntries << " entries.");
+            }
+            catch (const std::exception& e)
+            {
+                ALICEVISION_LOG_ERROR("Failed to write regions archive '" << archivePath << "':" << std::endl << e.what());
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
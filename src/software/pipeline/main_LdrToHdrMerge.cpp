@@ -7,6 +7,8 @@
 #include <aliceVision/image/all.hpp>
 #include <aliceVision/image/io.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/IOScheduler.hpp>
+#include <aliceVision/system/Timer.hpp>
 #include <aliceVision/cmdline/cmdline.hpp>
 #include <aliceVision/system/main.hpp>
 #include <OpenImageIO/imageio.h>
@@ -24,14 +26,16 @@
 // Command line parameters
 #include <boost/program_options.hpp>
 
+#include <deque>
 #include <filesystem>
+#include <future>
 #include <sstream>
 #include <iomanip>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 0
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -70,6 +74,114 @@ std::string getHdrMaskPath(const std::string& outputPath, std::size_t g, const s
     return hdrImagePath;
 }
 
+/// Bracket group to merge
+struct GroupToMerge
+{
+    IndexT intrinsicId;                                        //< intrinsic shared by the brackets
+    int pos;                                                   //< output index of the HDR image
+    const std::vector<std::shared_ptr<sfmData::View>>* group;  //< bracket views
+    std::shared_ptr<sfmData::View> targetView;                 //< view giving the target exposure and metadata
+};
+
+/// Decoded LDR images of a bracket group
+struct LoadedGroup
+{
+    std::vector<image::Image<image::RGBfColor>> images;  //< LDR images, one per bracket
+    std::vector<double> exposures;                       //< exposure of each bracket
+    double decodeTime = 0.0;                             //< decoding time in seconds
+};
+
+/// Merged HDR image of a bracket group, ready to be written
+struct MergedGroup
+{
+    std::string hdrImagePath;
+    std::string hdrMaskLowLightPath;
+    std::string hdrMaskHighLightPath;
+    std::string hdrMaskNoMidLightPath;
+    image::Image<image::RGBfColor> HDRimage;
+    image::Image<image::RGBfColor> lowLightMask;
+    image::Image<image::RGBfColor> highLightMask;
+    image::Image<image::RGBfColor> noMidLightMask;
+    oiio::ParamValueList targetMetadata;
+};
+
+/**
+ * @brief Load all the images of a bracket group.
+ * @param[in] group the bracket views
+ * @param[in] workingColorSpace the color space of the loaded images
+ * @return the LDR images and their exposures
+ */
+LoadedGroup loadBracketGroup(const std::vector<std::shared_ptr<sfmData::View>>& group, image::EImageColorSpace workingColorSpace)
+{
+    LoadedGroup loadedGroup;
+    loadedGroup.images.resize(group.size());
+    std::vector<sfmData::ExposureSetting> exposuresSetting(group.size());
+
+    for (std::size_t i = 0; i < group.size(); ++i)
+    {
+        const std::string filepath = group[i]->getImage().getImagePath();
+        ALICEVISION_LOG_INFO("Load " << filepath);
+
+        image::ImageReadOptions options;
+        options.workingColorSpace = workingColorSpace;
+        options.rawColorInterpretation = image::ERawColorInterpretation_stringToEnum(group[i]->getImage().getRawColorInterpretation());
+        options.colorProfileFileName = group[i]->getImage().getColorProfileFileName();
+
+        // Whatever the raw color interpretation mode, the default read processing for raw images is to apply
+        // white balancing in libRaw, before demosaicing.
+        // The DcpMetadata mode allows to not apply color management after demosaicing.
+        // Because if requested after demosaicing, white balancing is done at color management stage, we can
+        // set this option to true to get real raw data, without any white balancing, when the DcpMetadata mode
+        // is selected.
+        if (options.rawColorInterpretation == image::ERawColorInterpretation::DcpMetadata)
+        {
+            options.doWBAfterDemosaicing = true;
+        }
+
+        image::readImage(filepath, loadedGroup.images[i], options);
+
+        exposuresSetting[i] = group[i]->getImage().getCameraExposureSetting();
+    }
+
+    if (!sfmData::hasComparableExposures(exposuresSetting))
+    {
+        ALICEVISION_THROW_ERROR("Camera exposure settings are inconsistent.");
+    }
+
+    loadedGroup.exposures = getExposures(exposuresSetting);
+    return loadedGroup;
+}
+
+/**
+ * @brief Write the HDR image and the light masks of a merged group.
+ * @param[in] mergedGroup the merged group
+ * @param[in] mergedColorSpace the color space of the HDR image
+ * @param[in] storageDataType the storage data type of the HDR image
+ * @param[in] computeLightMasks write the light masks
+ */
+void writeMergedGroup(const MergedGroup& mergedGroup,
+                      image::EImageColorSpace mergedColorSpace,
+                      image::EStorageDataType storageDataType,
+                      bool computeLightMasks)
+{
+    image::ImageWriteOptions writeOptions;
+    writeOptions.fromColorSpace(mergedColorSpace);
+    writeOptions.toColorSpace(mergedColorSpace);
+    writeOptions.storageDataType(storageDataType);
+
+    image::writeImage(mergedGroup.hdrImagePath, mergedGroup.HDRimage, writeOptions, mergedGroup.targetMetadata);
+
+    if (computeLightMasks)
+    {
+        image::ImageWriteOptions maskWriteOptions;
+        maskWriteOptions.exrCompressionMethod(image::EImageExrCompression::None);
+
+        image::writeImage(mergedGroup.hdrMaskLowLightPath, mergedGroup.lowLightMask, maskWriteOptions);
+        image::writeImage(mergedGroup.hdrMaskHighLightPath, mergedGroup.highLightMask, maskWriteOptions);
+        image::writeImage(mergedGroup.hdrMaskNoMidLightPath, mergedGroup.noMidLightMask, maskWriteOptions);
+    }
+}
+
 int aliceVision_main(int argc, char** argv)
 {
     std::string sfmInputDataFilename;
@@ -94,6 +206,7 @@ int aliceVision_main(int argc, char** argv)
 
     int rangeStart = -1;
     int rangeSize = 1;
+    int maxInFlightGroups = 0;
 
     // Command line parameters
     // clang-format off
@@ -143,7 +256,10 @@ int aliceVision_main(int argc, char** argv)
         ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
          "Range image index start.")
         ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
-         "Range size.");
+         "Range size.")
+        ("maxInFlightGroups", po::value<int>(&maxInFlightGroups)->default_value(maxInFlightGroups),
+         "Pipeline the decoding, merging and writing of the bracket groups, with at most this number of groups "
+         "waiting in each stage. It bounds the memory used by the pipeline. 0 processes the groups one after another.");
     // clang-format on
 
     CmdLine cmdline("This program merges LDR images into HDR images.\n"
@@ -415,6 +531,13 @@ int aliceVision_main(int argc, char** argv)
 
     int rangeEnd = rangeStart + rangeSize;
 
+    // Bracket groups to merge, in the output order
+    std::vector<GroupToMerge> groupsToMerge;
+    std::map<IndexT, hdr::rgbCurve> responsePerIntrinsics;
+
+    hdr::rgbCurve fusionWeight(channelQuantization);
+    fusionWeight.setFunction(fusionWeightFunction);
+
     int pos = 0;
     for (const auto& pGroupedViews : groupedViewsPerIntrinsics)
     {
@@ -423,8 +546,6 @@ int aliceVision_main(int argc, char** argv)
         const auto& groupedViews = pGroupedViews.second;
         const auto& targetViews = targetViewsPerIntrinsics.at(intrinsicId);
 
-        hdr::rgbCurve fusionWeight(channelQuantization);
-        fusionWeight.setFunction(fusionWeightFunction);
         hdr::rgbCurve response(channelQuantization);
 
         const std::string baseName = (fs::path(inputResponsePath).parent_path() / std::string("response_")).string();
@@ -433,6 +554,7 @@ int aliceVision_main(int argc, char** argv)
 
         ALICEVISION_LOG_DEBUG("inputResponsePath: " << intrinsicInputResponsePath);
         response.read(intrinsicInputResponsePath);
+        responsePerIntrinsics.emplace(intrinsicId, std::move(response));
 
         for (std::size_t g = 0; g < groupedViews.size(); ++g, ++pos)
         {
@@ -440,125 +562,171 @@ int aliceVision_main(int argc, char** argv)
             {
                 continue;
             }
+            groupsToMerge.push_back({intrinsicId, pos, &groupedViews[g], targetViews[g]});
+        }
+    }
 
-            const std::vector<std::shared_ptr<sfmData::View>>& group = groupedViews[g];
+    const auto mergeGroup = [&](const GroupToMerge& groupToMerge, LoadedGroup& loadedGroup) {
+        std::vector<image::Image<image::RGBfColor>>& images = loadedGroup.images;
+        const std::vector<double>& exposures = loadedGroup.exposures;
+        const hdr::rgbCurve& response = responsePerIntrinsics.at(groupToMerge.intrinsicId);
+        std::shared_ptr<sfmData::View> targetView = groupToMerge.targetView;
 
-            std::vector<image::Image<image::RGBfColor>> images(group.size());
-            std::shared_ptr<sfmData::View> targetView = targetViews[g];
-            std::vector<sfmData::ExposureSetting> exposuresSetting(group.size());
+        auto mergedGroup = std::make_shared<MergedGroup>();
 
-            // Load all images of the group
-            for (std::size_t i = 0; i < group.size(); ++i)
+        // Merge HDR images
+        if (images.size() > 1)
+        {
+            hdr::hdrMerge merge;
+            sfmData::ExposureSetting targetCameraSetting = targetView->getImage().getCameraExposureSetting();
+            hdr::MergingParams mergingParams;
+            mergingParams.targetCameraExposure = targetCameraSetting.getExposure();
+            mergingParams.refImageIndex = targetIndexPerIntrinsics[groupToMerge.intrinsicId];
+            mergingParams.minSignificantValue = minSignificantValue;
+            mergingParams.maxSignificantValue = maxSignificantValue;
+            mergingParams.computeLightMasks = computeLightMasks;
+
+            merge.process(images,
+                          exposures,
+                          fusionWeight,
+                          response,
+                          mergedGroup->HDRimage,
+                          mergedGroup->lowLightMask,
+                          mergedGroup->highLightMask,
+                          mergedGroup->noMidLightMask,
+                          mergingParams);
+            if (highlightCorrectionFactor > 0.0f)
             {
-                const std::string filepath = group[i]->getImage().getImagePath();
-                ALICEVISION_LOG_INFO("Load " << filepath);
-
-                image::ImageReadOptions options;
-                options.workingColorSpace = workingColorSpace;
-                options.rawColorInterpretation = image::ERawColorInterpretation_stringToEnum(group[i]->getImage().getRawColorInterpretation());
-                options.colorProfileFileName = group[i]->getImage().getColorProfileFileName();
-
-                // Whatever the raw color interpretation mode, the default read processing for raw images is to apply
-                // white balancing in libRaw, before demosaicing.
-                // The DcpMetadata mode allows to not apply color management after demosaicing.
-                // Because if requested after demosaicing, white balancing is done at color management stage, we can
-                // set this option to true to get real raw data, without any white balancing, when the DcpMetadata mode
-                // is selected.
-                if (options.rawColorInterpretation == image::ERawColorInterpretation::DcpMetadata)
-                {
-                    options.doWBAfterDemosaicing = true;
-                }
-
-                image::readImage(filepath, images[i], options);
-
-                exposuresSetting[i] = group[i]->getImage().getCameraExposureSetting();
+                merge.postProcessHighlight(images,
+                                           exposures,
+                                           fusionWeight,
+                                           response,
+                                           mergedGroup->HDRimage,
+                                           targetCameraSetting.getExposure(),
+                                           highlightCorrectionFactor,
+                                           highlightTargetLux);
             }
+        }
+        else if (images.size() == 1)
+        {
+            // Nothing to do
+            mergedGroup->HDRimage.swap(images[0]);
+        }
 
-            if (!sfmData::hasComparableExposures(exposuresSetting))
-            {
-                ALICEVISION_THROW_ERROR("Camera exposure settings are inconsistent.");
-            }
+        fs::path p(targetView->getImage().getImagePath());
+        const std::string rootname = keepSourceImageName ? p.stem().string() : "";
+        mergedGroup->hdrImagePath = getHdrImagePath(outputPath, groupToMerge.pos, rootname);
+        if (computeLightMasks)
+        {
+            mergedGroup->hdrMaskLowLightPath = getHdrMaskPath(outputPath, groupToMerge.pos, "lowLight", rootname);
+            mergedGroup->hdrMaskHighLightPath = getHdrMaskPath(outputPath, groupToMerge.pos, "highLight", rootname);
+            mergedGroup->hdrMaskNoMidLightPath = getHdrMaskPath(outputPath, groupToMerge.pos, "noMidLight", rootname);
+        }
 
-            std::vector<double> exposures = getExposures(exposuresSetting);
+        // Write an image with parameters from the target view
+        std::map<std::string, std::string> viewMetadata = targetView->getImage().getMetadata();
 
-            // Merge HDR images
-            image::Image<image::RGBfColor> HDRimage;
-            image::Image<image::RGBfColor> lowLightMask;
-            image::Image<image::RGBfColor> highLightMask;
-            image::Image<image::RGBfColor> noMidLightMask;
-            if (images.size() > 1)
+        for (const auto& meta : viewMetadata)
+        {
+            if (meta.first.compare(0, 3, "raw") == 0)
             {
-                hdr::hdrMerge merge;
-                sfmData::ExposureSetting targetCameraSetting = targetView->getImage().getCameraExposureSetting();
-                hdr::MergingParams mergingParams;
-                mergingParams.targetCameraExposure = targetCameraSetting.getExposure();
-                mergingParams.refImageIndex = targetIndexPerIntrinsics[intrinsicId];
-                mergingParams.minSignificantValue = minSignificantValue;
-                mergingParams.maxSignificantValue = maxSignificantValue;
-                mergingParams.computeLightMasks = computeLightMasks;
-
-                merge.process(images, exposures, fusionWeight, response, HDRimage, lowLightMask, highLightMask, noMidLightMask, mergingParams);
-                if (highlightCorrectionFactor > 0.0f)
-                {
-                    merge.postProcessHighlight(images,
-                                               exposures,
-                                               fusionWeight,
-                                               response,
-                                               HDRimage,
-                                               targetCameraSetting.getExposure(),
-                                               highlightCorrectionFactor,
-                                               highlightTargetLux);
-                }
+                mergedGroup->targetMetadata.add_or_replace(oiio::ParamValue("AliceVision:" + meta.first, meta.second));
             }
-            else if (images.size() == 1)
+            else
             {
-                // Nothing to do
-                HDRimage = images[0];
+                mergedGroup->targetMetadata.add_or_replace(oiio::ParamValue(meta.first, meta.second));
             }
+        }
 
-            fs::path p(targetView->getImage().getImagePath());
-            const std::string hdrImagePath = getHdrImagePath(outputPath, pos, keepSourceImageName ? p.stem().string() : "");
-
-            // Write an image with parameters from the target view
-            std::map<std::string, std::string> viewMetadata = targetView->getImage().getMetadata();
-
-            oiio::ParamValueList targetMetadata;
-            for (const auto& meta : viewMetadata)
-            {
-                if (meta.first.compare(0, 3, "raw") == 0)
-                {
-                    targetMetadata.add_or_replace(oiio::ParamValue("AliceVision:" + meta.first, meta.second));
-                }
-                else
-                {
-                    targetMetadata.add_or_replace(oiio::ParamValue(meta.first, meta.second));
-                }
-            }
-
-            targetMetadata.add_or_replace(oiio::ParamValue("AliceVision:ColorSpace", image::EImageColorSpace_enumToString(mergedColorSpace)));
-
-            image::ImageWriteOptions writeOptions;
-            writeOptions.fromColorSpace(mergedColorSpace);
-            writeOptions.toColorSpace(mergedColorSpace);
-            writeOptions.storageDataType(storageDataType);
-
-            image::writeImage(hdrImagePath, HDRimage, writeOptions, targetMetadata);
-
-            if (computeLightMasks)
-            {
-                const std::string hdrMaskLowLightPath = getHdrMaskPath(outputPath, pos, "lowLight", keepSourceImageName ? p.stem().string() : "");
-                const std::string hdrMaskHighLightPath = getHdrMaskPath(outputPath, pos, "highLight", keepSourceImageName ? p.stem().string() : "");
-                const std::string hdrMaskNoMidLightPath = getHdrMaskPath(outputPath, pos, "noMidLight", keepSourceImageName ? p.stem().string() : "");
-
-                image::ImageWriteOptions maskWriteOptions;
-                maskWriteOptions.exrCompressionMethod(image::EImageExrCompression::None);
-
-                image::writeImage(hdrMaskLowLightPath, lowLightMask, maskWriteOptions);
-                image::writeImage(hdrMaskHighLightPath, highLightMask, maskWriteOptions);
-                image::writeImage(hdrMaskNoMidLightPath, noMidLightMask, maskWriteOptions);
-            }
+        mergedGroup->targetMetadata.add_or_replace(
+          oiio::ParamValue("AliceVision:ColorSpace", image::EImageColorSpace_enumToString(mergedColorSpace)));
+
+        return mergedGroup;
+    };
+
+    // Cumulated time of each stage, in seconds
+    double decodeTime = 0.0;
+    double mergeTime = 0.0;
+    double writeTime = 0.0;
+    std::size_t nbPixels = 0;
+    system::Timer timer;
+
+    const auto loadGroup = [&](std::size_t index) {
+        system::Timer decodeTimer;
+        LoadedGroup loadedGroup = loadBracketGroup(*groupsToMerge[index].group, workingColorSpace);
+        loadedGroup.decodeTime = decodeTimer.elapsed();
+        return loadedGroup;
+    };
+
+    const auto writeGroup = [computeLightMasks, mergedColorSpace, storageDataType](const std::shared_ptr<MergedGroup>& mergedGroup) {
+        system::Timer writeTimer;
+        writeMergedGroup(*mergedGroup, mergedColorSpace, storageDataType, computeLightMasks);
+        return writeTimer.elapsed();
+    };
+
+    const auto consumeGroup = [&](std::size_t index, LoadedGroup& loadedGroup) {
+        decodeTime += loadedGroup.decodeTime;
+
+        system::Timer mergeTimer;
+        std::shared_ptr<MergedGroup> mergedGroup = mergeGroup(groupsToMerge[index], loadedGroup);
+        mergeTime += mergeTimer.elapsed();
+        nbPixels += mergedGroup->HDRimage.size();
+
+        // release the LDR images before the next group is consumed
+        loadedGroup = LoadedGroup();
+        return mergedGroup;
+    };
+
+    if (maxInFlightGroups > 0)
+    {
+        // Pipelined mode: the next groups are decoded on the I/O threads while the current group is merged
+        // and the previous ones are written on a dedicated thread.
+        // At most maxInFlightGroups groups are waiting to be merged and maxInFlightGroups groups are waiting to be written.
+        ALICEVISION_LOG_INFO("Pipelined merge with at most " << maxInFlightGroups << " groups in flight per stage.");
+
+        const std::size_t maxPendingGroups = maxInFlightGroups;
+        system::IOScheduler writer(1);
+        std::deque<std::future<double>> pendingWrites;
+        const auto waitOldestWrite = [&]() {
+            writeTime += pendingWrites.front().get();
+            pendingWrites.pop_front();
+        };
+
+        system::IOScheduler::getInstance().forEachOrdered(
+          groupsToMerge.size(), maxPendingGroups, loadGroup, [&](std::size_t index, LoadedGroup&& loadedGroup) {
+              std::shared_ptr<MergedGroup> mergedGroup = consumeGroup(index, loadedGroup);
+
+              while (pendingWrites.size() >= maxPendingGroups)
+              {
+                  waitOldestWrite();
+              }
+              pendingWrites.push_back(writer.submit([writeGroup, mergedGroup]() { return writeGroup(mergedGroup); }));
+          });
+
+        while (!pendingWrites.empty())
+        {
+            waitOldestWrite();
+        }
+    }
+    else
+    {
+        for (std::size_t index = 0; index < groupsToMerge.size(); ++index)
+        {
+            LoadedGroup loadedGroup = loadGroup(index);
+            writeTime += writeGroup(consumeGroup(index, loadedGroup));
         }
     }
 
+    // Throughput report
+    const double elapsed = timer.elapsed();
+    if (!groupsToMerge.empty() && elapsed > 0.0)
+    {
+        ALICEVISION_LOG_INFO("Merged " << groupsToMerge.size() << " bracket groups in " << system::prettyTime(elapsed * 1000.0) << ": "
+                                       << groupsToMerge.size() / elapsed << " groups/s, " << nbPixels / elapsed / 1.0e6 << " MPixels/s.");
+        ALICEVISION_LOG_INFO("Cumulated time per stage: decode " << system::prettyTime(decodeTime * 1000.0) << ", merge "
+                                                                 << system::prettyTime(mergeTime * 1000.0) << ", write "
+                                                                 << system::prettyTime(writeTime * 1000.0) << ".");
+    }
+
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -11,6 +11,7 @@
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 #include <aliceVision/depthMap/computeOnMultiGPUs.hpp>
+#include <aliceVision/depthMap/DepthMapBackend.hpp>
 #include <aliceVision/depthMap/DepthMapEstimator.hpp>
 #include <aliceVision/depthMap/DepthMapParams.hpp>
 #include <aliceVision/depthMap/SgmParams.hpp>
@@ -22,7 +23,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 4
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -89,6 +90,9 @@ int aliceVision_main(int argc, char* argv[])
     // number of GPUs to use (0 means use all GPUs)
     int nbGPUs = 0;
 
+    // computation backend
+    depthMap::EDepthMapBackend backend = depthMap::EDepthMapBackend::AUTO;
+
     // clang-format off
     po::options_description requiredParams("Required parameters");
     requiredParams.add_options()
@@ -216,7 +220,12 @@ int aliceVision_main(int argc, char* argv[])
         ("exportTilePattern", po::value<bool>(&depthMapParams.exportTilePattern)->default_value(depthMapParams.exportTilePattern),
          "Export workflow tile pattern.")
         ("nbGPUs", po::value<int>(&nbGPUs)->default_value(nbGPUs),
-         "Number of GPUs to use (0 means use all GPUs).");
+         "Number of GPUs to use (0 means use all GPUs).")
+        ("backend", po::value<depthMap::EDepthMapBackend>(&backend)->default_value(backend),
+         "Computation backend:\n"
+         "* auto: CUDA if a compatible GPU is available, CPU otherwise\n"
+         "* cuda: CUDA-Enabled GPU(s)\n"
+         "* cpu: CPU only (slower, no GPU required)");
     // clang-format on
 
     CmdLine cmdline("Dense Reconstruction.\n"
@@ -244,16 +253,31 @@ int aliceVision_main(int argc, char* argv[])
     refineParams.exportIntermediateTopographicCutVolumes = exportIntermediateTopographicCutVolumes;
     refineParams.exportIntermediateVolume9pCsv = exportIntermediateVolume9pCsv;
 
-    // print GPU Information
-    ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
-
-    // check if the gpu suppport CUDA compute capability 2.0
-    if (!gpu::gpuSupportCUDA(2, 0))
+    // choose the computation backend
+    if (backend != depthMap::EDepthMapBackend::CPU)
     {
-        ALICEVISION_LOG_ERROR("This program needs a CUDA-Enabled GPU (with at least compute capability 2.0).");
-        return EXIT_FAILURE;
+        // print GPU Information
+        ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
+
+        // check if the gpu suppport CUDA compute capability 2.0
+        if (gpu::gpuSupportCUDA(2, 0))
+        {
+            backend = depthMap::EDepthMapBackend::CUDA;
+        }
+        else if (backend == depthMap::EDepthMapBackend::CUDA)
+        {
+            ALICEVISION_LOG_ERROR("This program needs a CUDA-Enabled GPU (with at least compute capability 2.0).");
+            return EXIT_FAILURE;
+        }
+        else
+        {
+            ALICEVISION_LOG_WARNING("No CUDA-Enabled GPU (with at least compute capability 2.0) found, fallback to the CPU backend.");
+            backend = depthMap::EDepthMapBackend::CPU;
+        }
     }
 
+    ALICEVISION_LOG_INFO("Depth map estimation backend: " << backend);
+
     // check if the scale is correct
     if (downscale < 1)
     {
@@ -429,7 +453,10 @@ int aliceVision_main(int argc, char* argv[])
     depthMap::DepthMapEstimator depthMapEstimator(mp, tileParams, depthMapParams, sgmParams, refineParams);
 
     // estimate depth maps
-    depthMap::computeOnMultiGPUs(cams, depthMapEstimator, nbGPUs);
+    if (backend == depthMap::EDepthMapBackend::CPU)
+        depthMapEstimator.computeOnCpu(cams);
+    else
+        depthMap::computeOnMultiGPUs(cams, depthMapEstimator, nbGPUs);
 
     ALICEVISION_COMMANDLINE_END
 }
@@ -23,7 +23,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -51,6 +51,7 @@ int aliceVision_main(int argc, char* argv[])
     int pixSizeBall = 0;
     int pixSizeBallWithLowSimilarity = 0;
     int nNearestCams = 10;
+    int mapCacheSize = 2048;
     bool computeNormalMaps = false;
 
     // clang-format off
@@ -85,6 +86,8 @@ int aliceVision_main(int argc, char* argv[])
          "Filter ball size (in px) when the similarity is weak or ambiguous.")
         ("nNearestCams", po::value<int>(&nNearestCams)->default_value(nNearestCams),
          "Number of nearest cameras.")
+        ("mapCacheSize", po::value<int>(&mapCacheSize)->default_value(mapCacheSize),
+         "Maximum memory used to keep depth/sim maps in memory between cameras (in MB).")
         ("computeNormalMaps", po::value<bool>(&computeNormalMaps)->default_value(computeNormalMaps),
          "Compute normal maps per depth map.");
     // clang-format on
@@ -139,7 +142,7 @@ int aliceVision_main(int argc, char* argv[])
     ALICEVISION_LOG_INFO("Filter depth maps.");
 
     {
-        fuseCut::Fuser fs(mp);
+        fuseCut::Fuser fs(mp, std::size_t(std::max(0, mapCacheSize)));
         fs.filterGroups(cams, pixToleranceFactor, pixSizeBall, pixSizeBallWithLowSimilarity, nNearestCams);
         fs.filterDepthMaps(cams, minNumOfConsistentCams, minNumOfConsistentCamsWithLowSimilarity);
     }
@@ -43,7 +43,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -119,6 +119,7 @@ int aliceVision_main(int argc, char** argv)
     const std::string fileExtension = "txt";
     int randomSeed = std::mt19937::default_seed;
     double minRequired2DMotion = -1.0;
+    std::size_t maxDescriptorsMemory = 0;
 
     // clang-format off
     po::options_description requiredParams("Required parameters");
@@ -141,6 +142,7 @@ int aliceVision_main(int argc, char** argv)
         ("photometricMatchingMethod,p", po::value<std::string>(&nearestMatchingMethod)->default_value(nearestMatchingMethod),
          "For Scalar based regions descriptor:\n"
          "* BRUTE_FORCE_L2: L2 BruteForce matching\n"
+         "* BRUTE_FORCE_L2_GEMM: L2 BruteForce matching computed by blocks of matrix products (faster than BRUTE_FORCE_L2)\n"
          "* ANN_L2: L2 Approximate Nearest Neighbor matching\n"
          "* CASCADE_HASHING_L2: L2 Cascade Hashing matching\n"
          "* FAST_CASCADE_HASHING_L2: L2 Cascade Hashing with precomputed hashed regions\n"
@@ -180,6 +182,9 @@ int aliceVision_main(int argc, char** argv)
          "Export debug files (svg, dot).")
         ("maxMatches", po::value<std::size_t>(&numMatchesToKeep)->default_value(numMatchesToKeep),
          "Maximum number pf matches to keep.")
+        ("maxDescriptorsMemory", po::value<std::size_t>(&maxDescriptorsMemory)->default_value(maxDescriptorsMemory),
+         "Maximum memory (in MB) used by the descriptors. If set, descriptors are loaded on demand and evicted "
+         "when this budget is exceeded (0 loads all the descriptors upfront).")
         ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
          "Range image index start.")
         ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
@@ -289,9 +294,19 @@ int aliceVision_main(int argc, char** argv)
 
     ALICEVISION_LOG_INFO("Load features and descriptors");
 
+    if (maxDescriptorsMemory > 0 && matchFromKnownCameraPoses)
+    {
+        ALICEVISION_LOG_WARNING("Descriptors paging is not compatible with matchFromKnownCameraPoses, all descriptors are loaded.");
+        maxDescriptorsMemory = 0;
+    }
+
     // load the corresponding view regions
     RegionsPerView regionPerView;
-    if (!sfm::loadRegionsPerView(regionPerView, sfmData, featuresFolders, describerTypes, filter))
+    const bool regionsLoaded =
+      (maxDescriptorsMemory > 0)
+        ? sfm::loadRegionsPerViewWithDescriptorsPaging(regionPerView, sfmData, featuresFolders, describerTypes, maxDescriptorsMemory * 1024 * 1024, filter)
+        : sfm::loadRegionsPerView(regionPerView, sfmData, featuresFolders, describerTypes, filter);
+    if (!regionsLoaded)
     {
         ALICEVISION_LOG_ERROR("Invalid regions in '" + sfmDataFilename + "'");
         return EXIT_FAILURE;
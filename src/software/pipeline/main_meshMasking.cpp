@@ -12,6 +12,7 @@
 #include <aliceVision/utils/filesIO.hpp>
 #include <aliceVision/cmdline/cmdline.hpp>
 #include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/ZBuffer.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/sfmMvsUtils/visibility.hpp>
 #include <aliceVision/camera/cameraUndistortImage.hpp>
@@ -24,7 +25,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -351,7 +352,8 @@ void meshMasking(const mvsUtils::MultiViewParams& mp,
                  const bool invert,
                  const bool smoothBoundary,
                  const bool undistortMasks,
-                 const bool usePointsVisibilities)
+                 const bool usePointsVisibilities,
+                 const bool checkOcclusions)
 {
     MaskCache maskCache(mp, masksFolders, undistortMasks, maskExtension);
 
@@ -360,6 +362,7 @@ void meshMasking(const mvsUtils::MultiViewParams& mp,
     ALICEVISION_LOG_INFO("Compute vertex visibilities");
     StaticVector<int> vertexVisibilityCounters;
     vertexVisibilityCounters.resize_with(inputMesh.pts.size(), 0);
+    mesh::ZBuffer zBuffer;
     for (int camId = 0; camId < mp.getNbCameras(); ++camId)
     {
         auto* maskPtr = maskCache.lock(camId);
@@ -384,6 +387,11 @@ void meshMasking(const mvsUtils::MultiViewParams& mp,
             continue;
         }
 
+        if (checkOcclusions)
+        {
+            zBuffer.rasterize(inputMesh, mp, camId);
+        }
+
 #pragma omp parallel for
         for (int vertexId = 0; vertexId < inputMesh.pts.size(); ++vertexId)
         {
@@ -400,7 +408,8 @@ void meshMasking(const mvsUtils::MultiViewParams& mp,
             // project vertex on mask
             Pixel projectedPixel;
             mp.getPixelFor3DPoint(&projectedPixel, vertex, camId);
-            if (projectedPixel.x < 0 || projectedPixel.x >= mask.width() || projectedPixel.y < 0 || projectedPixel.y >= mask.height())
+            if (projectedPixel.x < 0 || projectedPixel.x >= mask.width() || projectedPixel.y < 0 || projectedPixel.y >= mask.height() ||
+                (checkOcclusions && !zBuffer.isPointVisible(vertex, mesh::ZBuffer::DEFAULT_DEPTH_TOLERANCE)))
             {
                 if (usePointsVisibilities)
                 {
@@ -507,6 +516,7 @@ int main(int argc, char** argv)
     bool smoothBoundary = false;
     bool undistortMasks = false;
     bool usePointsVisibilities = false;
+    bool checkOcclusions = false;
     std::string maskExtension = "png";
 
     // clang-format off
@@ -534,6 +544,8 @@ int main(int argc, char** argv)
          "Undistort the masks with the same parameters as the matching image. Use it if the masks are drawn on the original images.")
         ("usePointsVisibilities", po::value<bool>(&usePointsVisibilities)->default_value(usePointsVisibilities),
          "Use the points visibilities from the meshing to filter triangles. Example: when they are occluded, back-face, etc.")
+        ("checkOcclusions", po::value<bool>(&checkOcclusions)->default_value(checkOcclusions),
+         "Ignore the vertices occluded by the mesh itself in each camera (z-buffer rasterization of the mesh).")
         ("maskExtension", po::value<std::string>(&maskExtension)->default_value(maskExtension),
          "File extension for the masks to use.");
     // clang-format on
@@ -610,7 +622,17 @@ int main(int argc, char** argv)
     }
 
     ALICEVISION_LOG_INFO("Mask mesh");
-    meshMasking(mp, inputMesh, masksFolders, maskExtension, outputMeshPath, threshold, invert, smoothBoundary, undistortMasks, usePointsVisibilities);
+    meshMasking(mp,
+                inputMesh,
+                masksFolders,
+                maskExtension,
+                outputMeshPath,
+                threshold,
+                invert,
+                smoothBoundary,
+                undistortMasks,
+                usePointsVisibilities,
+                checkOcclusions);
     ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
     return EXIT_SUCCESS;
 }
@@ -29,7 +29,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 3
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -136,7 +136,13 @@ int aliceVision_main(int argc, char* argv[])
          " * PullPush: Combine results from Pull and Push results.'")
         ("subdivisionTargetRatio", po::value<float>(&texParams.subdivisionTargetRatio)->default_value(texParams.subdivisionTargetRatio),
          "Percentage of the density of the reconstruction as the target for the subdivision "
-         "(0: disable subdivision, 0.5: half density of the reconstruction, 1: full density of the reconstruction).");
+         "(0: disable subdivision, 0.5: half density of the reconstruction, 1: full density of the reconstruction).")
+        ("scheduling", po::value<mesh::ETexturingScheduling>(&texParams.scheduling)->default_value(texParams.scheduling),
+         "Texture generation scheduling when all the atlases do not fit in memory.\n"
+         " * AtlasMajor: process the atlases by chunks, the source images are read once per chunk.\n"
+         " * ViewMajor: read each source image once, the atlases are accumulated by tiles stored on disk if needed.")
+        ("tileSide", po::value<unsigned int>(&texParams.tileSide)->default_value(texParams.tileSide),
+         "Atlas tile size for the ViewMajor scheduling.");
     // clang-format on
 
     CmdLine cmdline("AliceVision texturing");
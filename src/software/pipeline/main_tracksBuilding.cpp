@@ -27,7 +27,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -48,6 +48,7 @@ int aliceVision_main(int argc, char** argv)
 
     // user optional parameters
     std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
+    track::ETracksFileFormat outputFormat = track::ETracksFileFormat::JSON;
 
     // clang-format off
     po::options_description requiredParams("Required parameters");
@@ -78,7 +79,9 @@ int aliceVision_main(int argc, char** argv)
          "Matches folders previously added to the SfMData file will be ignored.")
         ("filterTrackForks", po::value<bool>(&filterTrackForks)->default_value(filterTrackForks),
          "Enable/Disable the track forks removal. "
-         "A track contains a fork when incoherent matches leads to multiple features in the same image for a single track.");
+         "A track contains a fork when incoherent matches leads to multiple features in the same image for a single track.")
+        ("outputFormat", po::value<track::ETracksFileFormat>(&outputFormat)->default_value(outputFormat),
+         "Tracks file format: json or binary. The binary format is faster to read and can be partially loaded per view.");
     // clang-format on
 
     CmdLine cmdline("AliceVision tracksBuilding");
@@ -155,14 +158,13 @@ int aliceVision_main(int argc, char** argv)
         }
     }
 
-    // write the json file with the tree
+    // write the tracks file
     ALICEVISION_LOG_INFO("Export to file");
-    std::stringstream ss;
-
-    boost::json::value jv = boost::json::value_from(mapTracks);
-    std::ofstream of(tracksFilename);
-    of << boost::json::serialize(jv);
-    of.close();
+    if (!track::saveTracks(tracksFilename, mapTracks, outputFormat))
+    {
+        ALICEVISION_LOG_ERROR("The output tracks file '" + tracksFilename + "' cannot be written.");
+        return EXIT_FAILURE;
+    }
 
     return EXIT_SUCCESS;
 }
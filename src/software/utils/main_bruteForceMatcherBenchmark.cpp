@@ -0,0 +1,144 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/cmdline/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/matching/ArrayMatcher_bruteForce.hpp>
+#include <aliceVision/matching/ArrayMatcher_bruteForceGemm.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+namespace {
+
+/**
+ * @brief Build the matcher on the database and search the nbNeighbours nearest neighbours of the queries.
+ * @return the elapsed time in milliseconds (build and search)
+ */
+template<typename MatcherT>
+double runMatcher(MatcherT& matcher,
+                  std::mt19937& gen,
+                  const std::vector<unsigned char>& database,
+                  const std::vector<unsigned char>& queries,
+                  int dimension,
+                  std::size_t nbNeighbours,
+                  matching::IndMatches& out_indices,
+                  std::vector<float>& out_distances)
+{
+    system::Timer timer;
+    matcher.Build(gen, database.data(), database.size() / dimension, dimension);
+    matcher.SearchNeighbours(queries.data(), queries.size() / dimension, &out_indices, &out_distances, nbNeighbours);
+    return timer.elapsedMs();
+}
+
+}  // namespace
+
+int aliceVision_main(int argc, char** argv)
+{
+    ALICEVISION_COMMANDLINE_START
+
+    // user optional parameters
+    int nbDatabase = 20000;
+    int nbQueries = 20000;
+    int dimension = 128;
+    std::size_t nbNeighbours = 2;
+    int nbRuns = 3;
+    int randomSeed = 42;
+
+    // clang-format off
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("nbDatabase", po::value<int>(&nbDatabase)->default_value(nbDatabase),
+         "Number of database descriptors.")
+        ("nbQueries", po::value<int>(&nbQueries)->default_value(nbQueries),
+         "Number of query descriptors.")
+        ("dimension", po::value<int>(&dimension)->default_value(dimension),
+         "Dimension of the descriptors (128 for SIFT).")
+        ("nbNeighbours", po::value<std::size_t>(&nbNeighbours)->default_value(nbNeighbours),
+         "Number of nearest neighbours searched for each query.")
+        ("nbRuns", po::value<int>(&nbRuns)->default_value(nbRuns),
+         "Number of runs of each matcher, the best time is kept.")
+        ("randomSeed", po::value<int>(&randomSeed)->default_value(randomSeed),
+         "Seed of the random descriptors generation.");
+    // clang-format on
+
+    CmdLine cmdline("Compare the brute-force matcher and the GEMM-based brute-force matcher on the same random uchar descriptors.\n"
+                    "AliceVision bruteForceMatcherBenchmark");
+    cmdline.add(optionalParams);
+    if (!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (nbDatabase < 1 || nbQueries < 1 || dimension < 1 || nbRuns < 1 || nbNeighbours < 1 || nbNeighbours > static_cast<std::size_t>(nbDatabase))
+    {
+        ALICEVISION_LOG_ERROR("Invalid benchmark parameters: sizes must be strictly positive and nbNeighbours <= nbDatabase.");
+        return EXIT_FAILURE;
+    }
+
+    // SIFT-like descriptors
+    std::mt19937 gen(randomSeed);
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::vector<unsigned char> database(std::size_t(nbDatabase) * dimension);
+    std::vector<unsigned char> queries(std::size_t(nbQueries) * dimension);
+    for (unsigned char& v : database)
+        v = static_cast<unsigned char>(distribution(gen));
+    for (unsigned char& v : queries)
+        v = static_cast<unsigned char>(distribution(gen));
+
+    ALICEVISION_LOG_INFO("Benchmark descriptors: " << nbDatabase << " database, " << nbQueries << " queries, dimension " << dimension << ", "
+                                                    << nbNeighbours << " neighbours.");
+
+    typedef feature::L2_Vectorized<unsigned char> MetricT;
+
+    matching::IndMatches indicesRef;
+    std::vector<float> distancesRef;
+    matching::IndMatches indicesGemm;
+    std::vector<float> distancesGemm;
+    double bruteForceTime = 0.0;
+    double gemmTime = 0.0;
+
+    for (int run = 0; run < nbRuns; ++run)
+    {
+        matching::ArrayMatcher_bruteForce<unsigned char, MetricT> matcherRef;
+        const double refTime = runMatcher(matcherRef, gen, database, queries, dimension, nbNeighbours, indicesRef, distancesRef);
+        bruteForceTime = (run == 0) ? refTime : std::min(bruteForceTime, refTime);
+
+        matching::ArrayMatcher_bruteForceGemm<unsigned char, MetricT> matcherGemm;
+        const double runGemmTime = runMatcher(matcherGemm, gen, database, queries, dimension, nbNeighbours, indicesGemm, distancesGemm);
+        gemmTime = (run == 0) ? runGemmTime : std::min(gemmTime, runGemmTime);
+    }
+
+    // the distances of the uchar descriptors are exact in both matchers
+    std::size_t nbDifferences = 0;
+    for (std::size_t i = 0; i < distancesRef.size(); ++i)
+    {
+        if (i >= distancesGemm.size() || distancesRef[i] != distancesGemm[i])
+            ++nbDifferences;
+    }
+
+    ALICEVISION_LOG_INFO("Brute-force matchers (best of " << nbRuns << " runs):" << std::endl
+                                                           << "\t- brute-force: " << bruteForceTime << " ms" << std::endl
+                                                           << "\t- GEMM brute-force: " << gemmTime << " ms" << std::endl
+                                                           << "\t- speedup: " << (bruteForceTime / gemmTime) << std::endl
+                                                           << "\t- distances differences: " << nbDifferences << "/" << distancesRef.size());
+
+    ALICEVISION_COMMANDLINE_END
+}
@@ -0,0 +1,228 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/cmdline/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/mapIO.hpp>
+#include <aliceVision/depthMap/computeOnMultiGPUs.hpp>
+#include <aliceVision/depthMap/DepthMapEstimator.hpp>
+#include <aliceVision/depthMap/DepthMapParams.hpp>
+#include <aliceVision/depthMap/SgmParams.hpp>
+#include <aliceVision/depthMap/RefineParams.hpp>
+#include <aliceVision/gpu/gpu.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = std::filesystem;
+
+int aliceVision_main(int argc, char** argv)
+{
+    ALICEVISION_COMMANDLINE_START
+
+    std::string sfmDataFilename;
+    std::string imagesFolder;
+    std::string outputFolder;
+
+    // user optional parameters
+    int rangeStart = 0;
+    int rangeSize = 4;
+    int downscale = 2;
+    float tolerance = 0.01f;
+
+    mvsUtils::TileParams tileParams;
+    depthMap::DepthMapParams depthMapParams;
+    depthMap::SgmParams sgmParams;
+    depthMap::RefineParams refineParams;
+
+    // clang-format off
+    po::options_description requiredParams("Required parameters");
+    requiredParams.add_options()
+        ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
+         "SfMData file.")
+        ("imagesFolder", po::value<std::string>(&imagesFolder)->required(),
+         "Images folder. Filename should be the image uid.")
+        ("output,o", po::value<std::string>(&outputFolder)->required(),
+         "Output folder for the depth maps of each backend.");
+
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
+         "Index of the first camera to compute.")
+        ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
+         "Number of cameras to compute.")
+        ("downscale", po::value<int>(&downscale)->default_value(downscale),
+         "Downscale the input images.")
+        ("tileBufferWidth", po::value<int>(&tileParams.bufferWidth)->default_value(tileParams.bufferWidth),
+         "Maximum tile buffer width.")
+        ("tileBufferHeight", po::value<int>(&tileParams.bufferHeight)->default_value(tileParams.bufferHeight),
+         "Maximum tile buffer height.")
+        ("maxTCams", po::value<int>(&depthMapParams.maxTCams)->default_value(depthMapParams.maxTCams),
+         "Maximum number of T cameras.")
+        ("sgmScale", po::value<int>(&sgmParams.scale)->default_value(sgmParams.scale),
+         "Semi Global Matching: Downscale factor used to compute the similarity volume.")
+        ("sgmStepXY", po::value<int>(&sgmParams.stepXY)->default_value(sgmParams.stepXY),
+         "Semi Global Matching: Step used to compute the similarity volume on the X and Y axis.")
+        ("refineUseColorOptimization", po::value<bool>(&refineParams.useColorOptimization)->default_value(refineParams.useColorOptimization),
+         "Refine: Enable depth/similarity map color optimization.")
+        ("tolerance", po::value<float>(&tolerance)->default_value(tolerance),
+         "Maximum relative depth difference for a pixel to be considered identical in both backends.");
+    // clang-format on
+
+    CmdLine cmdline("Compare the CUDA and CPU depth map estimation backends (computation time and depth maps difference).\n"
+                    "AliceVision depthMapBackendBenchmark");
+    cmdline.add(requiredParams);
+    cmdline.add(optionalParams);
+    if (!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // read the input SfM scene
+    sfmData::SfMData sfmData;
+    if (!sfmDataIO::load(sfmData, sfmDataFilename, sfmDataIO::ESfMData::ALL))
+    {
+        ALICEVISION_LOG_ERROR("The input SfMData file '" << sfmDataFilename << "' cannot be read.");
+        return EXIT_FAILURE;
+    }
+
+    const std::string cudaOutputFolder = (fs::path(outputFolder) / "cuda").string();
+    const std::string cpuOutputFolder = (fs::path(outputFolder) / "cpu").string();
+    fs::create_directories(cudaOutputFolder);
+    fs::create_directories(cpuOutputFolder);
+
+    // MultiViewParams initialization, one per backend output folder
+    mvsUtils::MultiViewParams cudaMp(sfmData, imagesFolder, cudaOutputFolder, "", false, downscale);
+    mvsUtils::MultiViewParams cpuMp(sfmData, imagesFolder, cpuOutputFolder, "", false, downscale);
+
+    // camera list
+    std::vector<int> cams;
+    for (int rc = std::max(0, rangeStart); rc < std::min(rangeStart + rangeSize, cpuMp.ncams); ++rc)
+        cams.push_back(rc);
+
+    if (cams.empty())
+    {
+        ALICEVISION_LOG_INFO("No camera to process.");
+        return EXIT_SUCCESS;
+    }
+
+    const int padding = std::max(sgmParams.scale * sgmParams.stepXY, refineParams.scale * refineParams.stepXY);
+    tileParams.padding = (tileParams.padding / padding) * padding;
+
+    // CUDA backend
+    double cudaElapsed = -1.0;
+    if (gpu::gpuSupportCUDA(2, 0))
+    {
+        depthMap::DepthMapEstimator depthMapEstimator(cudaMp, tileParams, depthMapParams, sgmParams, refineParams);
+
+        system::Timer timer;
+        depthMap::computeOnMultiGPUs(cams, depthMapEstimator, 0);
+        cudaElapsed = timer.elapsed();
+    }
+    else
+    {
+        ALICEVISION_LOG_WARNING("No CUDA-Enabled GPU found, only the CPU backend is measured.");
+    }
+
+    // CPU backend
+    double cpuElapsed = 0.0;
+    {
+        depthMap::DepthMapEstimator depthMapEstimator(cpuMp, tileParams, depthMapParams, sgmParams, refineParams);
+
+        system::Timer timer;
+        depthMapEstimator.computeOnCpu(cams);
+        cpuElapsed = timer.elapsed();
+    }
+
+    ALICEVISION_LOG_INFO("Depth map estimation of " << cams.size() << " cameras:" << std::endl
+                                                    << "\t- CUDA: " << ((cudaElapsed < 0.0) ? "n/a" : std::to_string(cudaElapsed) + " s")
+                                                    << std::endl
+                                                    << "\t- CPU: " << cpuElapsed << " s");
+
+    if (cudaElapsed < 0.0)
+        return EXIT_SUCCESS;
+
+    // compare final depth maps
+    const int scale = depthMapParams.useRefine ? refineParams.scale : sgmParams.scale;
+    const int step = depthMapParams.useRefine ? refineParams.stepXY : sgmParams.stepXY;
+
+    std::size_t nbTotalPixels = 0;
+    std::size_t nbTotalMatching = 0;
+
+    for (const int rc : cams)
+    {
+        image::Image<float> cudaDepthMap;
+        image::Image<float> cpuDepthMap;
+
+        mvsUtils::readMap(rc, cudaMp, mvsUtils::EFileType::depthMap, cudaDepthMap, scale, step);
+        mvsUtils::readMap(rc, cpuMp, mvsUtils::EFileType::depthMap, cpuDepthMap, scale, step);
+
+        if (cudaDepthMap.width() != cpuDepthMap.width() || cudaDepthMap.height() != cpuDepthMap.height())
+        {
+            ALICEVISION_LOG_ERROR("Depth map dimensions differ for camera " << rc << ".");
+            return EXIT_FAILURE;
+        }
+
+        std::size_t nbPixels = 0;
+        std::size_t nbMatching = 0;
+        double sumRelativeDiff = 0.0;
+
+        for (std::size_t i = 0; i < std::size_t(cudaDepthMap.size()); ++i)
+        {
+            const float cudaDepth = cudaDepthMap.data()[i];
+            const float cpuDepth = cpuDepthMap.data()[i];
+
+            // pixels invalid in both backends are identical
+            if (cudaDepth <= 0.f && cpuDepth <= 0.f)
+                continue;
+
+            ++nbPixels;
+
+            if (cudaDepth <= 0.f || cpuDepth <= 0.f)
+                continue;
+
+            const float relativeDiff = std::abs(cudaDepth - cpuDepth) / cudaDepth;
+            sumRelativeDiff += relativeDiff;
+
+            if (relativeDiff <= tolerance)
+                ++nbMatching;
+        }
+
+        ALICEVISION_LOG_INFO("Camera " << rc << " (view id: " << cpuMp.getViewId(rc) << "):" << std::endl
+                                       << "\t- valid pixels: " << nbPixels << std::endl
+                                       << "\t- identical pixels: " << ((nbPixels > 0) ? (100.0 * nbMatching / nbPixels) : 100.0) << " %"
+                                       << std::endl
+                                       << "\t- mean relative depth difference: " << ((nbPixels > 0) ? (sumRelativeDiff / nbPixels) : 0.0));
+
+        nbTotalPixels += nbPixels;
+        nbTotalMatching += nbMatching;
+    }
+
+    ALICEVISION_LOG_INFO("CUDA / CPU comparison:" << std::endl
+                                                  << "\t- speed ratio (CPU time / CUDA time): " << (cpuElapsed / cudaElapsed) << std::endl
+                                                  << "\t- identical pixels (tolerance: " << tolerance << "): "
+                                                  << ((nbTotalPixels > 0) ? (100.0 * nbTotalMatching / nbTotalPixels) : 100.0) << " %");
+
+    ALICEVISION_COMMANDLINE_END
+}
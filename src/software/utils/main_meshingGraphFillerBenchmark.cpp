@@ -0,0 +1,180 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/cmdline/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/fuseCut/Fuser.hpp>
+#include <aliceVision/fuseCut/PointCloud.hpp>
+#include <aliceVision/fuseCut/Tetrahedralization.hpp>
+#include <aliceVision/fuseCut/GraphFiller.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+namespace {
+
+/**
+ * @brief Maximum relative difference between two cells weights arrays.
+ */
+double maxRelativeDifference(const std::vector<fuseCut::GC_cellInfo>& a, const std::vector<fuseCut::GC_cellInfo>& b)
+{
+    const auto relDiff = [](double x, double y) { return std::abs(x - y) / std::max(1.0, std::max(std::abs(x), std::abs(y))); };
+
+    double maxDiff = 0.0;
+    for (std::size_t ci = 0; ci < a.size(); ++ci)
+    {
+        maxDiff = std::max(maxDiff, relDiff(a[ci].emptinessScore, b[ci].emptinessScore));
+        maxDiff = std::max(maxDiff, relDiff(a[ci].cellSWeight, b[ci].cellSWeight));
+        maxDiff = std::max(maxDiff, relDiff(a[ci].cellTWeight, b[ci].cellTWeight));
+        maxDiff = std::max(maxDiff, relDiff(a[ci].on, b[ci].on));
+        for (int k = 0; k < 4; ++k)
+            maxDiff = std::max(maxDiff, relDiff(a[ci].gEdgeVisWeight[k], b[ci].gEdgeVisWeight[k]));
+    }
+    return maxDiff;
+}
+
+}  // namespace
+
+int aliceVision_main(int argc, char** argv)
+{
+    ALICEVISION_COMMANDLINE_START
+
+    std::string sfmDataFilename;
+
+    // user optional parameters
+    int maxNbThreads = omp_get_max_threads();
+    int rayMarchingBatchSize = 256;
+    std::size_t estimateSpaceMinObservations = 3;
+    float estimateSpaceMinObservationAngle = 10.0f;
+
+    // clang-format off
+    po::options_description requiredParams("Required parameters");
+    requiredParams.add_options()
+        ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
+         "SfMData file (with landmarks).");
+
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("maxNbThreads", po::value<int>(&maxNbThreads)->default_value(maxNbThreads),
+         "Maximum number of threads, the benchmark runs with 1, 2, 4, ... threads up to this value.")
+        ("rayMarchingBatchSize", po::value<int>(&rayMarchingBatchSize)->default_value(rayMarchingBatchSize),
+         "Number of vertices per ray marching scheduling batch.")
+        ("estimateSpaceMinObservations", po::value<std::size_t>(&estimateSpaceMinObservations)->default_value(estimateSpaceMinObservations),
+         "Minimum number of observations for SfM space estimation.")
+        ("estimateSpaceMinObservationAngle", po::value<float>(&estimateSpaceMinObservationAngle)->default_value(estimateSpaceMinObservationAngle),
+         "Minimum angle between two observations for SfM space estimation.");
+    // clang-format on
+
+    CmdLine cmdline("Compare the GraphFiller ray marching weights accumulation strategies (computation time per number of threads).\n"
+                    "AliceVision meshingGraphFillerBenchmark");
+    cmdline.add(requiredParams);
+    cmdline.add(optionalParams);
+    if (!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // read the input SfM scene
+    sfmData::SfMData sfmData;
+    if (!sfmDataIO::load(sfmData, sfmDataFilename, sfmDataIO::ESfMData::ALL))
+    {
+        ALICEVISION_LOG_ERROR("The input SfMData file '" << sfmDataFilename << "' cannot be read.");
+        return EXIT_FAILURE;
+    }
+
+    if (sfmData.getLandmarks().empty())
+    {
+        ALICEVISION_LOG_ERROR("The input SfMData file '" << sfmDataFilename << "' has no landmarks.");
+        return EXIT_FAILURE;
+    }
+
+    // meshing from the SfM landmarks only
+    mvsUtils::MultiViewParams mp(sfmData, "", "", "", false);
+    mp.userParams.put("delaunaycut.rayMarchingBatchSize", rayMarchingBatchSize);
+
+    std::array<Point3d, 8> hexah;
+    fuseCut::Fuser fs(mp);
+    fs.divideSpaceFromSfM(sfmData, &hexah[0], estimateSpaceMinObservations, estimateSpaceMinObservationAngle);
+
+    StaticVector<int> cams;
+    cams.resize(mp.getNbCameras());
+    for (int i = 0; i < cams.size(); ++i)
+        cams[i] = i;
+
+    fuseCut::PointCloud pc(mp);
+    pc.createDensePointCloud(&hexah[0], cams, &sfmData, nullptr);
+
+    fuseCut::Tetrahedralization tetrahedralization(pc.getVertices());
+
+    ALICEVISION_LOG_INFO("Benchmark scene: " << tetrahedralization.nb_vertices() << " vertices, " << tetrahedralization.nb_cells() << " cells.");
+
+    const std::vector<fuseCut::EGraphFillerAccumulation> accumulations = {fuseCut::EGraphFillerAccumulation::ATOMIC,
+                                                                          fuseCut::EGraphFillerAccumulation::THREAD_BUFFERS};
+
+    std::vector<int> nbThreadsList;
+    for (int nbThreads = 1; nbThreads < maxNbThreads; nbThreads *= 2)
+        nbThreadsList.push_back(nbThreads);
+    nbThreadsList.push_back(std::max(1, maxNbThreads));
+
+    // reference cells weights (first accumulation, single thread)
+    std::vector<fuseCut::GC_cellInfo> referenceCellsAttr;
+
+    for (const fuseCut::EGraphFillerAccumulation accumulation : accumulations)
+    {
+        mp.userParams.put("delaunaycut.accumulation", fuseCut::EGraphFillerAccumulation_enumToString(accumulation));
+
+        double singleThreadElapsed = 0.0;
+
+        for (const int nbThreads : nbThreadsList)
+        {
+            omp_set_num_threads(nbThreads);
+
+            fuseCut::GraphFiller graphFiller(mp, pc, tetrahedralization);
+
+            system::Timer timer;
+            graphFiller.build(cams);
+            const double elapsed = timer.elapsed();
+
+            if (nbThreads == 1)
+                singleThreadElapsed = elapsed;
+
+            double maxDiff = 0.0;
+            if (referenceCellsAttr.empty())
+                referenceCellsAttr = graphFiller.getCellsAttributes();
+            else
+                maxDiff = maxRelativeDifference(referenceCellsAttr, graphFiller.getCellsAttributes());
+
+            ALICEVISION_LOG_INFO("Accumulation: " << accumulation << ", threads: " << nbThreads << std::endl
+                                                  << "\t- time: " << elapsed << " s" << std::endl
+                                                  << "\t- speedup: " << (singleThreadElapsed / elapsed) << std::endl
+                                                  << "\t- max relative weights difference: " << maxDiff);
+        }
+    }
+
+    omp_set_num_threads(maxNbThreads);
+
+    ALICEVISION_COMMANDLINE_END
+}
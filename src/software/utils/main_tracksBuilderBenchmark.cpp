@@ -0,0 +1,177 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/cmdline/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/track/TracksBuilder.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+namespace {
+
+/**
+ * @brief Generate the matches of a synthetic scene: each 3D point is seen by a random set of views
+ * with a random feature index, and matched between all the pairs of views closer than pairWindow.
+ * Some outlier matches are added between random features to create forks.
+ */
+matching::PairwiseMatches generateSyntheticMatches(std::mt19937& gen,
+                                                   std::size_t nbViews,
+                                                   std::size_t nbPoints,
+                                                   std::size_t nbFeaturesPerView,
+                                                   std::size_t pairWindow,
+                                                   std::size_t nbOutliersPerPair)
+{
+    std::uniform_real_distribution<double> visibility(0.0, 1.0);
+    std::uniform_int_distribution<std::size_t> randomFeature(0, nbFeaturesPerView - 1);
+
+    // featureIndex[view][point]: index of the observation of the point in the view (-1 if not visible)
+    std::vector<std::vector<int>> featureIndex(nbViews, std::vector<int>(nbPoints, -1));
+    for (std::size_t v = 0; v < nbViews; ++v)
+    {
+        std::vector<int> permutation(nbFeaturesPerView);
+        std::iota(permutation.begin(), permutation.end(), 0);
+        std::shuffle(permutation.begin(), permutation.end(), gen);
+        for (std::size_t p = 0; p < nbPoints; ++p)
+        {
+            if (visibility(gen) < 0.3)
+                featureIndex[v][p] = permutation[p];
+        }
+    }
+
+    matching::PairwiseMatches pairwiseMatches;
+    for (std::size_t I = 0; I < nbViews; ++I)
+    {
+        for (std::size_t J = I + 1; J < std::min(nbViews, I + 1 + pairWindow); ++J)
+        {
+            matching::IndMatches& matches = pairwiseMatches[std::make_pair(I, J)][feature::EImageDescriberType::SIFT];
+            for (std::size_t p = 0; p < nbPoints; ++p)
+            {
+                if (featureIndex[I][p] >= 0 && featureIndex[J][p] >= 0)
+                    matches.emplace_back(featureIndex[I][p], featureIndex[J][p]);
+            }
+            for (std::size_t o = 0; o < nbOutliersPerPair; ++o)
+                matches.emplace_back(randomFeature(gen), randomFeature(gen));
+        }
+    }
+    return pairwiseMatches;
+}
+
+}  // namespace
+
+int aliceVision_main(int argc, char** argv)
+{
+    ALICEVISION_COMMANDLINE_START
+
+    // user optional parameters
+    int maxNbThreads = omp_get_max_threads();
+    std::size_t nbViews = 100;
+    std::size_t nbPoints = 20000;
+    std::size_t nbFeaturesPerView = 25000;
+    std::size_t pairWindow = 10;
+    std::size_t nbOutliersPerPair = 100;
+    int randomSeed = 42;
+
+    // clang-format off
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("maxNbThreads", po::value<int>(&maxNbThreads)->default_value(maxNbThreads),
+         "Maximum number of threads, the benchmark runs with 1, 2, 4, ... threads up to this value.")
+        ("nbViews", po::value<std::size_t>(&nbViews)->default_value(nbViews),
+         "Number of views of the synthetic scene.")
+        ("nbPoints", po::value<std::size_t>(&nbPoints)->default_value(nbPoints),
+         "Number of 3D points of the synthetic scene, each one is seen by 30% of the views.")
+        ("nbFeaturesPerView", po::value<std::size_t>(&nbFeaturesPerView)->default_value(nbFeaturesPerView),
+         "Number of features per view (must be greater or equal to nbPoints).")
+        ("pairWindow", po::value<std::size_t>(&pairWindow)->default_value(pairWindow),
+         "Each view is matched with the next pairWindow views.")
+        ("nbOutliersPerPair", po::value<std::size_t>(&nbOutliersPerPair)->default_value(nbOutliersPerPair),
+         "Number of random outlier matches per pair of views.")
+        ("randomSeed", po::value<int>(&randomSeed)->default_value(randomSeed),
+         "Seed of the synthetic scene generation.");
+    // clang-format on
+
+    CmdLine cmdline("Measure the tracks building time on a synthetic match graph (computation time per number of threads).\n"
+                    "AliceVision tracksBuilderBenchmark");
+    cmdline.add(optionalParams);
+    if (!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (nbFeaturesPerView < nbPoints || nbFeaturesPerView == 0)
+    {
+        ALICEVISION_LOG_ERROR("The number of features per view must be greater or equal to the number of points.");
+        return EXIT_FAILURE;
+    }
+
+    std::mt19937 gen(randomSeed);
+    const matching::PairwiseMatches pairwiseMatches = generateSyntheticMatches(gen, nbViews, nbPoints, nbFeaturesPerView, pairWindow, nbOutliersPerPair);
+
+    std::size_t nbMatches = 0;
+    for (const auto& matchesPerDesc : pairwiseMatches)
+        for (const auto& matches : matchesPerDesc.second)
+            nbMatches += matches.second.size();
+
+    ALICEVISION_LOG_INFO("Benchmark match graph: " << nbViews << " views, " << pairwiseMatches.size() << " pairs, " << nbMatches << " matches.");
+
+    std::vector<int> nbThreadsList;
+    for (int nbThreads = 1; nbThreads < maxNbThreads; nbThreads *= 2)
+        nbThreadsList.push_back(nbThreads);
+    nbThreadsList.push_back(std::max(1, maxNbThreads));
+
+    double singleThreadElapsed = 0.0;
+
+    for (const int nbThreads : nbThreadsList)
+    {
+        omp_set_num_threads(nbThreads);
+
+        system::Timer timer;
+        track::TracksBuilder tracksBuilder;
+        tracksBuilder.build(pairwiseMatches);
+        const double buildTime = timer.elapsedMs();
+
+        timer.reset();
+        tracksBuilder.filter(true, 2);
+        const double filterTime = timer.elapsedMs();
+
+        timer.reset();
+        track::TracksMap tracks;
+        tracksBuilder.exportToSTL(tracks);
+        const double exportTime = timer.elapsedMs();
+
+        const double elapsed = buildTime + filterTime + exportTime;
+        if (nbThreads == 1)
+            singleThreadElapsed = elapsed;
+
+        ALICEVISION_LOG_INFO("Threads: " << nbThreads << std::endl
+                                         << "\t- build: " << buildTime << " ms" << std::endl
+                                         << "\t- filter: " << filterTime << " ms" << std::endl
+                                         << "\t- export: " << exportTime << " ms" << std::endl
+                                         << "\t- speedup: " << (singleThreadElapsed / elapsed) << std::endl
+                                         << "\t- " << tracks.size() << " tracks");
+    }
+
+    omp_set_num_threads(maxNbThreads);
+
+    ALICEVISION_COMMANDLINE_END
+}
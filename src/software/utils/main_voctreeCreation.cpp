@@ -23,11 +23,13 @@
 #include <fstream>
 #include <string>
 #include <chrono>
+#include <functional>
+#include <random>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 static const int DIMENSION = 128;
 
@@ -53,6 +55,9 @@ int aliceVision_main(int argc, char** argv)
     std::uint32_t restart = 5;
     std::uint32_t LEVELS = 6;
     bool sanityCheck = true;
+    std::size_t maxDescriptorsInMemory = 0;
+    std::uint32_t refinePasses = 1;
+    int randomSeed = std::mt19937_64::default_seed;
 
     // clang-format off
     po::options_description requiredParams("Required parameters");
@@ -76,7 +81,18 @@ int aliceVision_main(int argc, char** argv)
          "Number of levels of the tree.")
         ("sanitycheck,s", po::value<bool>(&sanityCheck)->default_value(sanityCheck),
          "Perform a sanity check at the end of the creation of the vocabulary tree. "
-         "The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree.");
+         "The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree.")
+        ("maxDescriptorsInMemory", po::value<std::size_t>(&maxDescriptorsInMemory)->default_value(maxDescriptorsInMemory),
+         "Number of descriptors kept in memory. If 0, all the descriptors are loaded and clustered in memory. "
+         "Otherwise, the descriptors are streamed from the files by chunks and each level of the tree is clustered "
+         "from a sample of the descriptors, then refined with mini-batch k-means passes over all the descriptors. "
+         "It is a soft limit: each node of the tree keeps at least k+1 descriptors in its sample, so the deep levels may exceed it.")
+        ("refinePasses", po::value<uint32_t>(&refinePasses)->default_value(refinePasses),
+         "Number of mini-batch k-means passes over all the descriptors for each level of the tree "
+         "(only with maxDescriptorsInMemory).")
+        ("randomSeed", po::value<int>(&randomSeed)->default_value(randomSeed),
+         "Base seed of the random generators of the tree nodes, the tree only depends on the descriptors and on this seed "
+         "(only with maxDescriptorsInMemory). Set -1 to use a random seed.");
     // clang-format on
 
     CmdLine cmdline(
@@ -92,6 +108,12 @@ int aliceVision_main(int argc, char** argv)
         return EXIT_FAILURE;
     }
 
+    if (randomSeed < -1)
+    {
+        ALICEVISION_LOG_ERROR("Invalid random seed (" << randomSeed << "), it must be positive or -1 for a random seed.");
+        return EXIT_FAILURE;
+    }
+
     // load SfMData
     sfmData::SfMData sfmData;
     if (!sfmDataIO::load(sfmData, sfmDataFilename, sfmDataIO::ESfMData::ALL))
@@ -101,30 +123,68 @@ int aliceVision_main(int argc, char** argv)
     }
 
     std::vector<DescriptorFloat> descriptors;
-
     std::vector<size_t> descRead;
-    ALICEVISION_COUT("Reading descriptors from " << sfmDataFilename);
+    std::map<IndexT, std::string> descriptorsFiles;
+
+    const bool streaming = (maxDescriptorsInMemory > 0);
+
+    aliceVision::voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
+    builder.setVerbose(tbVerbosity);
+    builder.kmeans().setRestarts(restart);
+
     auto detect_start = std::chrono::steady_clock::now();
-    size_t numTotDescriptors =
-      aliceVision::voctree::readDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolders, descriptors, descRead);
     auto detect_end = std::chrono::steady_clock::now();
     auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-    if (descriptors.empty())
+
+    if (streaming)
     {
-        ALICEVISION_CERR("No descriptors loaded!!");
-        return EXIT_FAILURE;
+        aliceVision::voctree::getListOfDescriptorFiles(sfmData, featuresFolders, descriptorsFiles);
+        if (descriptorsFiles.empty())
+        {
+            ALICEVISION_CERR("No descriptors loaded!!");
+            return EXIT_FAILURE;
+        }
+
+        // half of the memory for the chunks of descriptors, half for the samples of the nodes
+        const std::size_t chunkSize = std::max<std::size_t>(maxDescriptorsInMemory / 2, 1);
+        const auto readDescriptors = [&](const std::function<void(const std::vector<DescriptorFloat>&)>& processChunk) {
+            aliceVision::voctree::readDescFromFilesByChunks<DescriptorFloat, DescriptorUChar>(descriptorsFiles, chunkSize, processChunk);
+        };
+
+        // Create tree
+        ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K << " from the descriptors of "
+                                                 << descriptorsFiles.size() << " files, with about " << maxDescriptorsInMemory
+                                                 << " descriptors in memory");
+        detect_start = std::chrono::steady_clock::now();
+        builder.buildStreaming(readDescriptors,
+                               K,
+                               LEVELS,
+                               maxDescriptorsInMemory - chunkSize,
+                               refinePasses,
+                               randomSeed == -1 ? std::random_device()() : static_cast<std::uint64_t>(randomSeed));
     }
+    else
+    {
+        ALICEVISION_COUT("Reading descriptors from " << sfmDataFilename);
+        detect_start = std::chrono::steady_clock::now();
+        size_t numTotDescriptors =
+          aliceVision::voctree::readDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolders, descriptors, descRead);
+        detect_end = std::chrono::steady_clock::now();
+        detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+        if (descriptors.empty())
+        {
+            ALICEVISION_CERR("No descriptors loaded!!");
+            return EXIT_FAILURE;
+        }
 
-    ALICEVISION_COUT("Done! " << descRead.size() << " sets of descriptors read for a total of " << numTotDescriptors << " features");
-    ALICEVISION_COUT("Reading took " << detect_elapsed.count() << " sec");
+        ALICEVISION_COUT("Done! " << descRead.size() << " sets of descriptors read for a total of " << numTotDescriptors << " features");
+        ALICEVISION_COUT("Reading took " << detect_elapsed.count() << " sec");
 
-    // Create tree
-    aliceVision::voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
-    builder.setVerbose(tbVerbosity);
-    builder.kmeans().setRestarts(restart);
-    ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K);
-    detect_start = std::chrono::steady_clock::now();
-    builder.build(descriptors, K, LEVELS);
+        // Create tree
+        ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K);
+        detect_start = std::chrono::steady_clock::now();
+        builder.build(descriptors, K, LEVELS);
+    }
     detect_end = std::chrono::steady_clock::now();
     detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
     ALICEVISION_COUT("Tree created in " << ((float)detect_elapsed.count()) / 1000 << " sec");
@@ -138,6 +198,16 @@ int aliceVision_main(int argc, char** argv)
     ALICEVISION_COUT("Quantizing the features");
     size_t offset = 0;  ///< this is used to align to the features of a given image in 'feature'
     detect_start = std::chrono::steady_clock::now();
+
+    // in streaming mode, the descriptors are read again file by file
+    size_t i = 0;
+    for (const auto& descriptorsFile : descriptorsFiles)
+    {
+        std::vector<DescriptorFloat> imgDescriptors;
+        aliceVision::feature::loadDescsFromBinFile<DescriptorFloat, DescriptorUChar>(descriptorsFile.second, imgDescriptors);
+        allSparseHistograms[i++] = builder.tree().quantizeToSparse(imgDescriptors);
+    }
+
     // pass each feature through the vocabulary tree to get the associated visual word
     // for each read images, recover the number of features in it from descRead and loop over the features
     for (size_t i = 0; i < descRead.size(); ++i)